@@ -0,0 +1,445 @@
+#include "AssetArchive.h"
+#include "AssetPool.h"
+#include "Hashing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_LAST_LITERALS 5 // The end of a block is always literals, as in LZ4
+#define LZ_MATCH_MARGIN 12 // No match starts this close to the end
+#define LZ_HASH_BITS 16
+
+namespace
+{
+	uint64_t AlignUp(uint64_t a_value, uint64_t a_alignment)
+	{
+		return (a_value + a_alignment - 1) / a_alignment * a_alignment;
+	}
+
+	uint32_t Read32(const uint8_t* a_data)
+	{
+		uint32_t value;
+		std::memcpy(&value, a_data, sizeof(value));
+		return value;
+	}
+
+	uint32_t HashSequence(uint32_t a_sequence)
+	{
+		return (a_sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+	}
+
+	// Lengths past a nibble's 15 continue in bytes of 255 and a final remainder
+	void WriteLength(std::vector<uint8_t>& a_output, size_t a_length)
+	{
+		while (a_length >= 255) {
+			a_output.push_back(255);
+			a_length -= 255;
+		}
+		a_output.push_back((uint8_t)a_length);
+	}
+
+	bool ReadLength(const uint8_t*& a_cursor, const uint8_t* a_end, size_t& a_length)
+	{
+		uint8_t next;
+		do {
+			if (a_cursor == a_end)
+				return false;
+			next = *a_cursor++;
+			a_length += next;
+		} while (next == 255);
+		return true;
+	}
+
+	void WriteSequence(std::vector<uint8_t>& a_output, const uint8_t* a_literals, size_t a_literalCount, size_t a_offset, size_t a_matchLength)
+	{
+		size_t matchCode = a_matchLength >= LZ_MIN_MATCH ? a_matchLength - LZ_MIN_MATCH : 0;
+		a_output.push_back((uint8_t)((std::min<size_t>(a_literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+		if (a_literalCount >= 15)
+			WriteLength(a_output, a_literalCount - 15);
+		a_output.insert(a_output.end(), a_literals, a_literals + a_literalCount);
+		if (a_matchLength == 0)
+			return; // The last sequence has no match
+		a_output.push_back((uint8_t)(a_offset & 0xFF));
+		a_output.push_back((uint8_t)(a_offset >> 8));
+		if (matchCode >= 15)
+			WriteLength(a_output, matchCode - 15);
+	}
+
+	// Relative to a_rootKey, which is AssetKeys::FromPath of the archived folder
+	std::string GetEntryName(const std::filesystem::path& a_file, const std::string& a_rootKey)
+	{
+		std::string key = AssetKeys::FromPath(a_file);
+		return key.compare(0, a_rootKey.size(), a_rootKey) == 0 ? key.substr(a_rootKey.size() + 1) : key;
+	}
+
+	bool ReadWholeFile(const std::filesystem::path& a_fileName, std::vector<uint8_t>& a_data)
+	{
+		std::ifstream file(a_fileName, std::ios::binary | std::ios::ate);
+		if (!file)
+			return false;
+		a_data.resize((size_t)file.tellg());
+		file.seekg(0);
+		return (bool)file.read((char*)a_data.data(), (std::streamsize)a_data.size());
+	}
+}
+
+//-------------------------------------------------------
+// Greedy matching against the last position each 4 byte
+// sequence was seen at. Runs of misses step further
+// ahead, so incompressible data (PNG, BC blocks) passes
+// through quickly
+//-------------------------------------------------------
+void AssetArchive::Compress(const uint8_t* a_data, size_t a_size, std::vector<uint8_t>& a_output)
+{
+	a_output.clear();
+	a_output.reserve(a_size + a_size / 255 + 16);
+	size_t anchor = 0; // Start of the literals not yet written
+	if (a_size > LZ_MATCH_MARGIN) {
+		std::vector<uint32_t> table((size_t)1 << LZ_HASH_BITS, UINT32_MAX);
+		size_t searchEnd = a_size - LZ_MATCH_MARGIN;
+		size_t matchEnd = a_size - LZ_LAST_LITERALS;
+		size_t position = 0;
+		unsigned int misses = 0;
+		while (position < searchEnd) {
+			uint32_t sequence = Read32(a_data + position);
+			uint32_t& slot = table[HashSequence(sequence)];
+			size_t candidate = slot;
+			slot = (uint32_t)position;
+			if (candidate == UINT32_MAX || position - candidate > LZ_MAX_OFFSET || Read32(a_data + candidate) != sequence) {
+				position += 1 + (misses++ >> 6);
+				continue;
+			}
+			misses = 0;
+
+			size_t length = LZ_MIN_MATCH;
+			while (position + length < matchEnd && a_data[candidate + length] == a_data[position + length]) {
+				length++;
+			}
+			WriteSequence(a_output, a_data + anchor, position - anchor, position - candidate, length);
+			position += length;
+			anchor = position;
+		}
+	}
+	WriteSequence(a_output, a_data + anchor, a_size - anchor, 0, 0);
+}
+
+//-------------------------------------------------------
+// Refuses anything that would read or write out of
+// bounds, or that doesn't fill a_output exactly
+//-------------------------------------------------------
+bool AssetArchive::Decompress(const uint8_t* a_data, size_t a_size, uint8_t* a_output, size_t a_outputSize)
+{
+	const uint8_t* cursor = a_data;
+	const uint8_t* end = a_data + a_size;
+	size_t written = 0;
+	while (cursor < end) {
+		uint8_t token = *cursor++;
+		size_t literalCount = token >> 4;
+		if (literalCount == 15 && !ReadLength(cursor, end, literalCount))
+			return false;
+		if (literalCount > (size_t)(end - cursor) || literalCount > a_outputSize - written)
+			return false;
+		if (literalCount > 0)
+			std::memcpy(a_output + written, cursor, literalCount);
+		cursor += literalCount;
+		written += literalCount;
+		if (cursor == end)
+			break; // Last sequence
+
+		if (end - cursor < 2)
+			return false;
+		size_t offset = cursor[0] | ((size_t)cursor[1] << 8);
+		cursor += 2;
+		size_t length = token & 0xF;
+		if (length == 15 && !ReadLength(cursor, end, length))
+			return false;
+		length += LZ_MIN_MATCH;
+		if (offset == 0 || offset > written || length > a_outputSize - written)
+			return false;
+
+		// Matches may overlap what they write, repeating a short run
+		const uint8_t* source = a_output + written - offset;
+		uint8_t* destination = a_output + written;
+		if (offset >= length)
+			std::memcpy(destination, source, length);
+		else {
+			for (size_t i = 0; i < length; i++) {
+				destination[i] = source[i];
+			}
+		}
+		written += length;
+	}
+	return written == a_outputSize;
+}
+
+//-------------------------------------------------------
+// The TOC's size is known once the files are listed, so
+// data is streamed out behind a placeholder table, which
+// is filled in at the end
+//	- Identical contents compress identically, so a
+//	  duplicate is found by hash and confirmed against
+//	  the data already written
+//-------------------------------------------------------
+bool AssetArchive::Build(const std::filesystem::path& a_root, const std::filesystem::path& a_output, const AssetArchiveSettings& a_settings,
+	AssetArchiveBuildResult& a_result)
+{
+	a_result = AssetArchiveBuildResult();
+	std::error_code error;
+	if (!std::filesystem::is_directory(a_root, error))
+		return false;
+
+	struct SourceFile {
+		std::filesystem::path Path;
+		std::string Name;
+	};
+	std::vector<SourceFile> files;
+	std::string rootKey = AssetKeys::FromPath(a_root);
+	std::string outputKey = AssetKeys::FromPath(a_output);
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(a_root, error)) {
+		if (!entry.is_regular_file(error) || AssetKeys::FromPath(entry.path()) == outputKey)
+			continue;
+		files.push_back({ entry.path(), GetEntryName(entry.path(), rootKey) });
+	}
+	if (error)
+		return false;
+	std::sort(files.begin(), files.end(), [](const SourceFile& a_a, const SourceFile& a_b) { return a_a.Name < a_b.Name; });
+	for (size_t i = 0; i < files.size(); i++) {
+		if (files[i].Name.size() > UINT16_MAX || (i > 0 && files[i].Name == files[i - 1].Name))
+			return false; // Names differing only by case can't both be found
+	}
+
+	AssetArchiveHeader header;
+	std::vector<AssetArchiveEntry> entries(files.size());
+	std::string names;
+	for (size_t i = 0; i < files.size(); i++) {
+		entries[i].NameOffset = (uint32_t)names.size();
+		entries[i].NameLength = (uint16_t)files[i].Name.size();
+		names += files[i].Name;
+	}
+	header.EntryCount = (uint32_t)entries.size();
+	header.TocOffset = AlignUp(sizeof(AssetArchiveHeader), ASSET_ARCHIVE_ALIGNMENT);
+	header.NamesOffset = header.TocOffset + entries.size() * sizeof(AssetArchiveEntry);
+	header.NamesSize = names.size();
+
+	std::fstream output(a_output, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+	if (!output)
+		return false;
+	uint64_t offset = AlignUp(header.NamesOffset + header.NamesSize, ASSET_ARCHIVE_ALIGNMENT);
+	output.seekp((std::streamoff)offset);
+
+	std::unordered_multimap<uint64_t, size_t> written; // Content hash to entry
+	std::vector<uint8_t> contents, compressed, existing;
+	static const char s_padding[ASSET_ARCHIVE_ALIGNMENT] = {};
+	for (size_t i = 0; i < files.size(); i++) {
+		AssetArchiveEntry& entry = entries[i];
+		if (!ReadWholeFile(files[i].Path, contents))
+			return false;
+		entry.Size = contents.size();
+		entry.Hash = Hashing::Bytes(contents.data(), contents.size());
+		entry.WriteTime = (int64_t)std::filesystem::last_write_time(files[i].Path, error).time_since_epoch().count();
+		a_result.SourceBytes += contents.size();
+
+		const std::vector<uint8_t>* stored = &contents;
+		if (a_settings.bCompress && !contents.empty()) {
+			Compress(contents.data(), contents.size(), compressed);
+			if (compressed.size() <= contents.size() - (size_t)(contents.size() * a_settings.MinSaving)) {
+				stored = &compressed;
+				entry.Compression = ArchiveCompression::LZ;
+			}
+		}
+		entry.StoredSize = stored->size();
+
+		bool bDuplicate = false;
+		auto range = written.equal_range(entry.Hash);
+		for (auto match = range.first; match != range.second && !bDuplicate; ++match) {
+			const AssetArchiveEntry& other = entries[match->second];
+			if (other.Size != entry.Size || other.StoredSize != entry.StoredSize || other.Compression != entry.Compression)
+				continue;
+			existing.resize((size_t)other.StoredSize);
+			output.seekg((std::streamoff)other.Offset);
+			output.read((char*)existing.data(), (std::streamsize)existing.size());
+			if (output && existing == *stored) {
+				entry.Offset = other.Offset;
+				bDuplicate = true;
+			}
+			output.clear();
+		}
+		output.seekp((std::streamoff)offset);
+		if (bDuplicate) {
+			a_result.Duplicates++;
+			continue;
+		}
+
+		entry.Offset = offset;
+		output.write((const char*)stored->data(), (std::streamsize)stored->size());
+		uint64_t next = AlignUp(offset + stored->size(), ASSET_ARCHIVE_ALIGNMENT);
+		output.write(s_padding, (std::streamsize)(next - offset - stored->size()));
+		offset = next;
+		written.emplace(entry.Hash, i);
+		a_result.Compressed += entry.Compression != ArchiveCompression::None ? 1 : 0;
+	}
+
+	header.TocHash = Hashing::Bytes(entries.data(), entries.size() * sizeof(AssetArchiveEntry));
+	header.TocHash = Hashing::Bytes(names.data(), names.size(), header.TocHash);
+	output.seekp(0);
+	output.write((const char*)&header, sizeof(header));
+	output.write(s_padding, (std::streamsize)(header.TocOffset - sizeof(header)));
+	output.write((const char*)entries.data(), (std::streamsize)(entries.size() * sizeof(AssetArchiveEntry)));
+	output.write(names.data(), (std::streamsize)names.size());
+	output.flush();
+
+	a_result.Entries = (unsigned int)entries.size();
+	a_result.ArchiveBytes = offset;
+	return (bool)output;
+}
+
+AssetArchive::~AssetArchive()
+{
+	Close();
+}
+
+//-------------------------------------------------------
+// The whole file is mapped read only. Pages come in as
+// they're first touched, so only what's read costs I/O
+//-------------------------------------------------------
+bool AssetArchive::Open(const std::filesystem::path& a_fileName)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(a_fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size = {};
+	HANDLE mapping = nullptr;
+	if (GetFileSizeEx(file, &size) && size.QuadPart >= (LONGLONG)sizeof(AssetArchiveHeader))
+		mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+		return false;
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping); // The view keeps the mapping alive
+	if (view == nullptr)
+		return false;
+	m_data = (const uint8_t*)view;
+	m_size = (size_t)size.QuadPart;
+#else
+	int file = open(a_fileName.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+	struct stat status = {};
+	void* view = MAP_FAILED;
+	if (fstat(file, &status) == 0 && status.st_size >= (off_t)sizeof(AssetArchiveHeader))
+		view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (view == MAP_FAILED)
+		return false;
+	m_data = (const uint8_t*)view;
+	m_size = (size_t)status.st_size;
+#endif
+
+	// Everything the TOC points at must lie inside the file
+	const AssetArchiveHeader* header = (const AssetArchiveHeader*)m_data;
+	bool bValid = header->Magic == ASSET_ARCHIVE_MAGIC && header->Version == ASSET_ARCHIVE_VERSION
+		&& header->TocOffset % alignof(AssetArchiveEntry) == 0 && header->TocOffset <= m_size
+		&& header->EntryCount <= (m_size - header->TocOffset) / sizeof(AssetArchiveEntry)
+		&& header->NamesOffset <= m_size && header->NamesSize <= m_size - header->NamesOffset;
+	if (bValid) {
+		m_header = header;
+		m_entries = (const AssetArchiveEntry*)(m_data + header->TocOffset);
+		m_names = (const char*)(m_data + header->NamesOffset);
+		uint64_t hash = Hashing::Bytes(m_entries, (size_t)header->EntryCount * sizeof(AssetArchiveEntry));
+		bValid = Hashing::Bytes(m_names, (size_t)header->NamesSize, hash) == header->TocHash;
+		for (uint32_t i = 0; bValid && i < header->EntryCount; i++) {
+			const AssetArchiveEntry& entry = m_entries[i];
+			bValid = entry.Offset <= m_size && entry.StoredSize <= m_size - entry.Offset
+				&& (uint64_t)entry.NameOffset + entry.NameLength <= header->NamesSize
+				&& (entry.Compression != ArchiveCompression::None || entry.StoredSize == entry.Size);
+		}
+	}
+	if (!bValid)
+		Close();
+	return bValid;
+}
+
+void AssetArchive::Close()
+{
+	if (m_data != nullptr) {
+#ifdef _WIN32
+		UnmapViewOfFile(m_data);
+#else
+		munmap((void*)m_data, m_size);
+#endif
+	}
+	m_data = nullptr;
+	m_size = 0;
+	m_header = nullptr;
+	m_entries = nullptr;
+	m_names = nullptr;
+}
+
+int AssetArchive::Find(const std::string& a_name) const
+{
+	if (m_header == nullptr)
+		return -1;
+	const AssetArchiveEntry* end = m_entries + m_header->EntryCount;
+	const AssetArchiveEntry* found = std::lower_bound(m_entries, end, a_name,
+		[this](const AssetArchiveEntry& a_entry, const std::string& a_name) {
+			return std::string_view(m_names + a_entry.NameOffset, a_entry.NameLength) < a_name;
+		});
+	if (found == end || std::string_view(m_names + found->NameOffset, found->NameLength) != a_name)
+		return -1;
+	return (int)(found - m_entries);
+}
+
+bool AssetArchive::GetView(unsigned int a_entry, const uint8_t*& a_data, size_t& a_size) const
+{
+	if (a_entry >= GetEntryCount() || m_entries[a_entry].Compression != ArchiveCompression::None)
+		return false;
+	a_data = m_data + m_entries[a_entry].Offset;
+	a_size = (size_t)m_entries[a_entry].Size;
+	return true;
+}
+
+bool AssetArchive::Read(unsigned int a_entry, std::vector<uint8_t>& a_output) const
+{
+	if (a_entry >= GetEntryCount())
+		return false;
+	const AssetArchiveEntry& entry = m_entries[a_entry];
+	a_output.resize((size_t)entry.Size);
+	if (entry.Compression == ArchiveCompression::None) {
+		std::copy(m_data + entry.Offset, m_data + entry.Offset + entry.Size, a_output.begin());
+		return true;
+	}
+	return Decompress(m_data + entry.Offset, (size_t)entry.StoredSize, a_output.data(), a_output.size());
+}
+
+bool AssetArchive::Verify(unsigned int a_entry) const
+{
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	if (GetView(a_entry, data, size))
+		return Hashing::Bytes(data, size) == m_entries[a_entry].Hash;
+	std::vector<uint8_t> contents;
+	return Read(a_entry, contents) && Hashing::Bytes(contents.data(), contents.size()) == m_entries[a_entry].Hash;
+}
+
+std::string AssetArchive::GetName(unsigned int a_entry) const
+{
+	return std::string(m_names + m_entries[a_entry].NameOffset, m_entries[a_entry].NameLength);
+}
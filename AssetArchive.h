@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#define ASSET_ARCHIVE_MAGIC 0x43524141 // "AARC"
+#define ASSET_ARCHIVE_VERSION 1
+#define ASSET_ARCHIVE_ALIGNMENT 64 // TOC and every entry's data start on this boundary, for SIMD reads straight from the mapping
+#define ASSET_ARCHIVE_EXTENSION ".pak"
+
+// Start of the file. The TOC follows at TocOffset
+struct AssetArchiveHeader {
+	uint32_t Magic = ASSET_ARCHIVE_MAGIC;
+	uint32_t Version = ASSET_ARCHIVE_VERSION;
+	uint32_t EntryCount = 0;
+	uint32_t Alignment = ASSET_ARCHIVE_ALIGNMENT;
+	uint64_t TocOffset = 0; // EntryCount AssetArchiveEntry records, sorted by name
+	uint64_t NamesOffset = 0; // Entry names, back to back without terminators
+	uint64_t NamesSize = 0;
+	uint64_t TocHash = 0; // Of the entries and names, so a truncated or damaged TOC is refused on open
+	uint64_t Reserved[2] = {};
+};
+
+enum class ArchiveCompression : uint8_t {
+	None, // Stored, so readers get a view straight into the mapping
+	LZ // See AssetArchive::Compress
+};
+
+// One file in the TOC. Fixed size, so the table is read in place
+struct AssetArchiveEntry {
+	uint64_t Offset = 0; // From the start of the file
+	uint64_t StoredSize = 0;
+	uint64_t Size = 0; // Once decompressed
+	uint64_t Hash = 0; // FNV-1a of the decompressed contents
+	int64_t WriteTime = 0; // The source file's last write, as std::filesystem::file_time_type ticks
+	uint32_t NameOffset = 0; // Into the names
+	uint16_t NameLength = 0;
+	ArchiveCompression Compression = ArchiveCompression::None;
+	uint8_t Padding = 0;
+};
+
+static_assert(sizeof(AssetArchiveHeader) == 64, "The header is written as-is");
+static_assert(sizeof(AssetArchiveEntry) == 48, "TOC entries are written as-is");
+
+//-------------------------------------------------------
+// How an archive is built
+//-------------------------------------------------------
+struct AssetArchiveSettings {
+	bool bCompress = true; // Try compressing each entry
+	float MinSaving = 0.125f; // Fraction of an entry compression must save to be kept. PNGs and BC blocks rarely manage it
+};
+
+//-------------------------------------------------------
+// What a build wrote
+//-------------------------------------------------------
+struct AssetArchiveBuildResult {
+	unsigned int Entries = 0;
+	unsigned int Compressed = 0;
+	unsigned int Duplicates = 0; // Entries sharing another's data, having the same contents
+	uint64_t SourceBytes = 0;
+	uint64_t ArchiveBytes = 0;
+};
+
+//-------------------------------------------------------
+// One file holding a whole asset tree, read through a
+// memory mapping
+//	- The header and TOC sit at the front, so opening is
+//	  one mapping and a hash of the table, with nothing
+//	  parsed. Names are relative to the archived folder,
+//	  lower case with forward slashes (as AssetKeys makes
+//	  them), and sorted for binary search
+//	- Entries are stored in name order, so files of one
+//	  folder are read sequentially, and start aligned.
+//	  Stored entries are served as views of the mapping
+//	  without a copy; compressed ones decompress into the
+//	  caller's buffer
+//	- Each entry keeps a hash of its contents, which also
+//	  lets identical files share their data
+//	- Reading is thread safe once open
+//-------------------------------------------------------
+class AssetArchive
+{
+public:
+	AssetArchive() = default;
+	~AssetArchive();
+	AssetArchive(const AssetArchive&) = delete;
+	AssetArchive& operator=(const AssetArchive&) = delete;
+
+	// Archive every file under a_root into a_output
+	static bool Build(const std::filesystem::path& a_root, const std::filesystem::path& a_output, const AssetArchiveSettings& a_settings,
+		AssetArchiveBuildResult& a_result);
+
+	// LZ77 in the style of LZ4's block format: each sequence is a token (literal count and match length nibbles),
+	// the literals, and a 16 bit offset back into the output. Fast to decode, and bounds checked throughout
+	static void Compress(const uint8_t* a_data, size_t a_size, std::vector<uint8_t>& a_output);
+	static bool Decompress(const uint8_t* a_data, size_t a_size, uint8_t* a_output, size_t a_outputSize);
+
+	// Map an archive and check its TOC. Closes any archive already open
+	bool Open(const std::filesystem::path& a_fileName);
+	void Close();
+	bool IsOpen() const { return m_data != nullptr; }
+
+	// Index of the entry named a_name (see above), or -1
+	int Find(const std::string& a_name) const;
+
+	// Stored entries only: the contents in place, valid until Close
+	bool GetView(unsigned int a_entry, const uint8_t*& a_data, size_t& a_size) const;
+
+	// Any entry, decompressed into a_output
+	bool Read(unsigned int a_entry, std::vector<uint8_t>& a_output) const;
+
+	// Read and compare against the entry's hash
+	bool Verify(unsigned int a_entry) const;
+
+	// Getters
+	unsigned int GetEntryCount() const { return m_header ? m_header->EntryCount : 0; }
+	const AssetArchiveEntry& GetEntry(unsigned int a_entry) const { return m_entries[a_entry]; }
+	std::string GetName(unsigned int a_entry) const;
+	size_t GetSize() const { return m_size; }
+
+private:
+	const uint8_t* m_data = nullptr;
+	size_t m_size = 0;
+	const AssetArchiveHeader* m_header = nullptr;
+	const AssetArchiveEntry* m_entries = nullptr;
+	const char* m_names = nullptr;
+};
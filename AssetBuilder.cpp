@@ -0,0 +1,447 @@
+#include "AssetBuilder.h"
+#include "AssetPool.h"
+#include "Cubemap.h"
+#include "DDSFile.h"
+#include "Hashing.h"
+#include "JobSystem.h"
+#include "PngDecoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+
+// The manifest only holds numbers before each name, which needs no buffer size arguments, so the plain version is
+// equivalent off of MSVC
+#ifndef _MSC_VER
+#define sscanf_s sscanf
+#endif
+
+namespace
+{
+	// Sky folder faces in D3D order, as TextureLoader::LoadCube reads them
+	const char* s_skyFaces[CUBEMAP_FACE_COUNT] = { "right.png", "left.png", "up.png", "down.png", "front.png", "back.png" };
+
+	//-------------------------------------------------------
+	// Bake a sky's faces into the prefiltered specular cube
+	// Game loads in place of Sky::CreateSpecularReflectanceMap.
+	// Faces are gamma encoded like albedo, so they're decoded
+	// with pow 2.2 as IBLSpecularPrefilterPS does
+	//-------------------------------------------------------
+	bool BakeSpecular(const std::vector<std::filesystem::path>& a_faces, const std::filesystem::path& a_output, unsigned int a_samples)
+	{
+		float toLinear[256];
+		for (int i = 0; i < 256; i++) {
+			toLinear[i] = std::pow((float)i / 255.f, 2.2f);
+		}
+
+		std::vector<CubemapImage> source(1);
+		for (unsigned int face = 0; face < CUBEMAP_FACE_COUNT; face++) {
+			TextureData image;
+			if (!PngDecoder::LoadFile(a_faces[face], image) || image.Mips.empty())
+				return false;
+			const TextureMip& mip = image.Mips[0];
+			if (face == 0) {
+				source[0].Size = mip.Width;
+				source[0].Texels.resize((size_t)CUBEMAP_FACE_COUNT * mip.Width * mip.Width);
+			}
+			if (mip.Width != source[0].Size || mip.Height != source[0].Size || source[0].Size == 0)
+				return false;
+			size_t faceTexels = (size_t)mip.Width * mip.Height;
+			Vector4* texels = source[0].Texels.data() + face * faceTexels;
+			for (size_t i = 0; i < faceTexels; i++) {
+				const uint8_t* pixel = &mip.Pixels[i * 4];
+				texels[i] = Vector4(toLinear[pixel[0]], toLinear[pixel[1]], toLinear[pixel[2]], 1.f);
+			}
+		}
+
+		Cubemap::BuildMipChain(source, true);
+		IBLBakeSettings settings;
+		settings.Size = std::max(source[0].Size / ASSET_BUILD_SPECULAR_DIVISOR, 1u);
+		settings.SampleCount = a_samples;
+		std::vector<CubemapImage> output;
+		IBLBaker::PrefilterSpecular(source, settings, output, true, true);
+		return DDSFile::WriteCubemap(a_output.string(), output);
+	}
+}
+
+AssetBuilder::AssetBuilder(const std::filesystem::path& a_root, const std::filesystem::path& a_manifest)
+	: m_root(a_root), m_rootKey(AssetKeys::FromPath(a_root)), m_manifest(a_manifest)
+{
+}
+
+//-------------------------------------------------------
+// Steps are queued as their dependencies finish, into
+// the one group the caller waits on, so the JobSystem
+// sees the whole graph without any level by level
+// barriers
+//-------------------------------------------------------
+bool AssetBuilder::Build(const AssetBuildSettings& a_settings, AssetBuildResult& a_result)
+{
+	a_result = AssetBuildResult();
+	LoadManifest(); // Without one, everything builds
+	Scan(a_settings);
+	a_result.Steps = (unsigned int)m_steps.size();
+
+	// Hash every source once up front, as steps sharing one (a sky face, or a roughness map) would race to read it
+	std::set<std::string> names;
+	for (const AssetBuildStep& step : m_steps) {
+		names.insert(GetName(step.Output));
+	}
+	std::vector<std::filesystem::path> sources;
+	for (const AssetBuildStep& step : m_steps) {
+		for (const std::filesystem::path& input : step.Inputs) {
+			if (!input.empty() && names.insert(GetName(input)).second)
+				sources.push_back(input);
+		}
+	}
+	JobSystem& jobs = JobSystem::GetInstance();
+	jobs.ParallelFor((unsigned int)sources.size(), 1, [&](unsigned int a_begin, unsigned int a_end) {
+		for (unsigned int i = a_begin; i < a_end; i++) {
+			uint64_t hash = 0;
+			HashFile(sources[i], hash, a_result);
+		}
+	});
+
+	std::vector<std::vector<unsigned int>> dependents(m_steps.size());
+	std::unique_ptr<std::atomic<unsigned int>[]> pending(new std::atomic<unsigned int>[m_steps.size()]);
+	for (unsigned int i = 0; i < m_steps.size(); i++) {
+		pending[i] = (unsigned int)m_steps[i].Dependencies.size();
+		for (unsigned int dependency : m_steps[i].Dependencies) {
+			dependents[dependency].push_back(i);
+		}
+	}
+
+	JobGroup group;
+	std::function<void(unsigned int)> run = [&](unsigned int a_step) {
+		RunStep(m_steps[a_step], a_settings, a_result);
+		for (unsigned int dependent : dependents[a_step]) {
+			if (--pending[dependent] == 0)
+				jobs.Execute([&run, dependent]() { run(dependent); }, group);
+		}
+	};
+	for (unsigned int i = 0; i < m_steps.size(); i++) {
+		if (pending[i] == 0)
+			jobs.Execute([&run, i]() { run(i); }, group);
+	}
+	jobs.Wait(group);
+
+	for (unsigned int i = 0; i < m_steps.size(); i++) {
+		AssetBuildStep& step = m_steps[i];
+		step.bFailed = step.bFailed || pending[i] != 0; // Never ran
+		a_result.Built += step.bBuilt ? 1 : 0;
+		a_result.Failed += step.bFailed ? 1 : 0;
+	}
+	a_result.UpToDate = a_result.Steps - a_result.Built - a_result.Failed;
+	return SaveManifest() && a_result.Failed == 0;
+}
+
+std::string AssetBuilder::GetName(const std::filesystem::path& a_file) const
+{
+	std::string key = AssetKeys::FromPath(a_file);
+	if (key.size() > m_rootKey.size() + 1 && key.compare(0, m_rootKey.size(), m_rootKey) == 0 && key[m_rootKey.size()] == '/')
+		return key.substr(m_rootKey.size() + 1);
+	return key;
+}
+
+//-------------------------------------------------------
+// Texture steps mirror the texture-cook tool: every PNG,
+// sky faces included, and a packed texture per ORM group.
+// Dependencies are found by matching inputs to outputs
+//-------------------------------------------------------
+void AssetBuilder::Scan(const AssetBuildSettings& a_settings)
+{
+	m_steps.clear();
+	std::string manifestName = GetName(m_manifest);
+	std::string archiveName = a_settings.ArchiveFile.empty() ? std::string() : GetName(a_settings.ArchiveFile);
+	std::vector<std::filesystem::path> files;
+	std::vector<std::filesystem::path> pngs;
+	std::set<std::string> pngNames;
+	std::error_code error;
+	for (std::filesystem::recursive_directory_iterator it(m_root, error), end; !error && it != end; it.increment(error)) {
+		if (!it->is_regular_file())
+			continue;
+		std::string name = GetName(it->path());
+		if (name == manifestName || name == archiveName)
+			continue;
+		files.push_back(it->path());
+		if (it->path().extension() == ".png") {
+			pngs.push_back(it->path());
+			pngNames.insert(name);
+		}
+	}
+	std::sort(files.begin(), files.end());
+	std::sort(pngs.begin(), pngs.end());
+
+	for (const std::filesystem::path& png : pngs) {
+		AssetBuildStep step;
+		step.Type = AssetStepType::Texture;
+		step.Output = TextureCooker::GetCookedPath(png);
+		step.Inputs.push_back(png);
+		m_steps.push_back(step);
+	}
+
+	std::vector<std::array<std::filesystem::path, 3>> groups;
+	TextureCooker::GroupORMSources(pngs, groups);
+	for (const std::array<std::filesystem::path, 3>& group : groups) {
+		AssetBuildStep step;
+		step.Type = AssetStepType::PackedORM;
+		step.Output = TextureCooker::GetPackedPath(group.data());
+		step.Inputs.assign(group.begin(), group.end());
+		m_steps.push_back(step);
+	}
+
+	std::set<std::filesystem::path> folders;
+	for (const std::filesystem::path& png : pngs) {
+		folders.insert(png.parent_path());
+	}
+	for (const std::filesystem::path& folder : folders) {
+		AssetBuildStep step;
+		step.Type = AssetStepType::Specular;
+		step.Output = folder / ASSET_BUILD_SPECULAR_NAME;
+		for (const char* face : s_skyFaces) {
+			if (pngNames.count(GetName(folder / face)) != 0)
+				step.Inputs.push_back(folder / face);
+		}
+		if (step.Inputs.size() == CUBEMAP_FACE_COUNT)
+			m_steps.push_back(step);
+	}
+
+	// Every file, including outputs that don't exist yet. Sorted by name, so the key doesn't change once they do
+	if (!a_settings.ArchiveFile.empty()) {
+		AssetBuildStep step;
+		step.Type = AssetStepType::Archive;
+		step.Output = a_settings.ArchiveFile;
+		std::map<std::string, std::filesystem::path> inputs;
+		for (const std::filesystem::path& file : files) {
+			inputs[GetName(file)] = file;
+		}
+		for (const AssetBuildStep& other : m_steps) {
+			inputs[GetName(other.Output)] = other.Output;
+		}
+		for (const std::pair<const std::string, std::filesystem::path>& input : inputs) {
+			step.Inputs.push_back(input.second);
+		}
+		m_steps.push_back(step);
+	}
+
+	std::unordered_map<std::string, unsigned int> producers;
+	for (unsigned int i = 0; i < m_steps.size(); i++) {
+		producers[GetName(m_steps[i].Output)] = i;
+	}
+	for (AssetBuildStep& step : m_steps) {
+		for (const std::filesystem::path& input : step.Inputs) {
+			std::unordered_map<std::string, unsigned int>::const_iterator producer = input.empty() ? producers.end() : producers.find(GetName(input));
+			if (producer != producers.end())
+				step.Dependencies.push_back(producer->second);
+		}
+	}
+}
+
+void AssetBuilder::RunStep(AssetBuildStep& a_step, const AssetBuildSettings& a_settings, AssetBuildResult& a_result)
+{
+	for (unsigned int dependency : a_step.Dependencies) {
+		if (m_steps[dependency].bFailed) {
+			a_step.bFailed = true;
+			return;
+		}
+	}
+
+	// Clean when the manifest has this key, and the output is still what was written for it
+	std::string outputName = GetName(a_step.Output);
+	a_step.Key = ComputeKey(a_step, a_settings, a_result);
+	bool bClean = false;
+	if (!a_settings.bForce) {
+		StepRecord record;
+		bool bRecorded = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			std::unordered_map<std::string, StepRecord>::const_iterator it = m_outputs.find(outputName);
+			bRecorded = it != m_outputs.end();
+			if (bRecorded)
+				record = it->second;
+		}
+		uint64_t outputHash = 0;
+		bClean = bRecorded && record.Key == a_step.Key && HashFile(a_step.Output, outputHash, a_result) && outputHash == record.OutputHash;
+	}
+
+	if (!bClean) {
+		switch (a_step.Type) {
+		case AssetStepType::Texture: {
+			TextureCookResult result;
+			a_step.bBuilt = TextureCooker::Cook(a_step.Inputs[0], a_settings.Texture, result);
+			break;
+		}
+		case AssetStepType::PackedORM: {
+			std::filesystem::path sources[3] = { a_step.Inputs[0], a_step.Inputs[1], a_step.Inputs[2] };
+			TextureCookResult result;
+			ORMLayout layout;
+			a_step.bBuilt = TextureCooker::CookORM(sources, a_settings.Texture, result, layout);
+			break;
+		}
+		case AssetStepType::Specular:
+			a_step.bBuilt = BakeSpecular(a_step.Inputs, a_step.Output, a_settings.SpecularSamples);
+			break;
+		case AssetStepType::Archive: {
+			AssetArchiveBuildResult result;
+			a_step.bBuilt = AssetArchive::Build(m_root, a_step.Output, a_settings.Archive, result);
+			break;
+		}
+		}
+
+		uint64_t outputHash = 0;
+		a_step.bFailed = !a_step.bBuilt || !HashFile(a_step.Output, outputHash, a_result);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (a_step.bFailed)
+			m_outputs.erase(outputName);
+		else
+			m_outputs[outputName] = { a_step.Key, outputHash };
+	}
+}
+
+//-------------------------------------------------------
+// Settings are hashed field by field, and only those the
+// step's type reads, so changing one doesn't rebuild the
+// steps that ignore it
+//-------------------------------------------------------
+uint64_t AssetBuilder::ComputeKey(const AssetBuildStep& a_step, const AssetBuildSettings& a_settings, AssetBuildResult& a_result)
+{
+	uint64_t key = Hashing::Value((uint32_t)ASSET_BUILD_VERSION);
+	key = Hashing::Value((uint32_t)a_step.Type, key);
+	key = Hashing::String(GetName(a_step.Output), key);
+	switch (a_step.Type) {
+	case AssetStepType::Texture:
+	case AssetStepType::PackedORM:
+		key = Hashing::Value((uint32_t)a_settings.Texture.Filter, key);
+		key = Hashing::Value(a_settings.Texture.bCompress, key);
+		key = Hashing::Value((uint32_t)a_settings.Texture.Quality, key);
+		key = Hashing::Value(a_settings.Texture.bPreferBC7, key);
+		break;
+	case AssetStepType::Specular:
+		key = Hashing::Value(a_settings.SpecularSamples, key);
+		key = Hashing::Value((uint32_t)ASSET_BUILD_SPECULAR_DIVISOR, key);
+		break;
+	case AssetStepType::Archive:
+		key = Hashing::Value(a_settings.Archive.bCompress, key);
+		key = Hashing::Value(a_settings.Archive.MinSaving, key);
+		break;
+	}
+
+	for (const std::filesystem::path& input : a_step.Inputs) {
+		key = Hashing::String(input.empty() ? std::string() : GetName(input), key);
+		uint64_t hash = 0;
+		bool bFound = !input.empty() && HashFile(input, hash, a_result);
+		key = Hashing::Value(bFound, key);
+		key = Hashing::Value(hash, key);
+	}
+	return key;
+}
+
+bool AssetBuilder::HashFile(const std::filesystem::path& a_file, uint64_t& a_hash, AssetBuildResult& a_result)
+{
+	std::error_code error;
+	uint64_t size = (uint64_t)std::filesystem::file_size(a_file, error);
+	if (error)
+		return false;
+	int64_t writeTime = (int64_t)std::filesystem::last_write_time(a_file, error).time_since_epoch().count();
+	if (error)
+		return false;
+
+	std::string name = GetName(a_file);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::unordered_map<std::string, FileRecord>::iterator it = m_files.find(name);
+		if (it != m_files.end() && it->second.Size == size && it->second.WriteTime == writeTime) {
+			it->second.bUsed = true;
+			a_hash = it->second.Hash;
+			return true;
+		}
+	}
+
+	bool bFound = false;
+	a_hash = Hashing::File(a_file.string(), HASH_FNV_OFFSET_BASIS, bFound);
+	if (!bFound)
+		return false;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_files[name] = { size, writeTime, a_hash, true };
+	a_result.HashedFiles++;
+	a_result.HashedBytes += size;
+	return true;
+}
+
+//-------------------------------------------------------
+// One record per line, the name last as it may contain
+// spaces:
+//	"F <hash> <size> <write time> <name>" for each file
+//	"S <key> <output hash> <name>" for each built output
+// A manifest from another version is ignored
+//-------------------------------------------------------
+bool AssetBuilder::LoadManifest()
+{
+	m_files.clear();
+	m_outputs.clear();
+	std::ifstream file(m_manifest);
+	std::string header;
+	unsigned int version = 0;
+	if (!(file >> header >> version) || header != ASSET_BUILD_MANIFEST_HEADER || version != ASSET_BUILD_VERSION)
+		return false;
+
+	std::string line;
+	std::getline(file, line);
+	while (std::getline(file, line)) {
+		unsigned long long first = 0;
+		unsigned long long second = 0;
+		long long third = 0;
+		int nameStart = 0;
+		if (sscanf_s(line.c_str(), "F %llx %llu %lld %n", &first, &second, &third, &nameStart) == 3 && nameStart > 0)
+			m_files[line.substr(nameStart)] = { second, third, first, false };
+		else if (sscanf_s(line.c_str(), "S %llx %llx %n", &first, &second, &nameStart) == 2 && nameStart > 0)
+			m_outputs[line.substr(nameStart)] = { first, second };
+	}
+	return true;
+}
+
+//-------------------------------------------------------
+// Only files this build looked at and outputs of current
+// steps are kept, so deleted assets drop out. Written to
+// a temporary file first, so an interrupted save leaves
+// the last manifest in place
+//-------------------------------------------------------
+bool AssetBuilder::SaveManifest()
+{
+	std::filesystem::path temporary = m_manifest;
+	temporary += ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::trunc);
+		if (!file)
+			return false;
+		file << ASSET_BUILD_MANIFEST_HEADER << " " << ASSET_BUILD_VERSION << "\n";
+		char fields[64];
+		std::map<std::string, FileRecord> files(m_files.begin(), m_files.end()); // Sorted, so manifests diff well
+		for (const std::pair<const std::string, FileRecord>& record : files) {
+			if (!record.second.bUsed)
+				continue;
+			std::snprintf(fields, sizeof(fields), "F %016llx %llu %lld ", (unsigned long long)record.second.Hash,
+				(unsigned long long)record.second.Size, (long long)record.second.WriteTime);
+			file << fields << record.first << "\n";
+		}
+		for (const AssetBuildStep& step : m_steps) {
+			std::unordered_map<std::string, StepRecord>::const_iterator record = m_outputs.find(GetName(step.Output));
+			if (record == m_outputs.end())
+				continue;
+			std::snprintf(fields, sizeof(fields), "S %016llx %016llx ", (unsigned long long)record->second.Key,
+				(unsigned long long)record->second.OutputHash);
+			file << fields << record->first << "\n";
+		}
+		if (!file)
+			return false;
+	}
+	std::error_code error;
+	std::filesystem::rename(temporary, m_manifest, error);
+	return !error;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AssetArchive.h"
+#include "IBLBaker.h"
+#include "TextureCooker.h"
+
+#define ASSET_BUILD_VERSION 1 // Part of every step's key. Bump when a cooker's output changes, so everything rebuilds
+#define ASSET_BUILD_MANIFEST_HEADER "AssetBuildManifest"
+#define ASSET_BUILD_SPECULAR_NAME "specular.dds" // Prefiltered specular cube baked beside a sky's faces, where Game looks for it
+#define ASSET_BUILD_SPECULAR_DIVISOR 8 // Baked face size relative to the sky's, as SKY_SPECULAR_SIZE_DIVISOR
+
+// What a step produces
+enum class AssetStepType {
+	Texture, // TextureCooker::Cook of one PNG
+	PackedORM, // TextureCooker::CookORM of a material's occlusion, roughness and metalness maps
+	Specular, // IBLBaker::PrefilterSpecular of a sky folder's six faces
+	Archive // AssetArchive::Build of the whole tree, once everything else is built
+};
+
+//-------------------------------------------------------
+// How assets are built. Every field that changes an
+// output is part of its step's key
+//-------------------------------------------------------
+struct AssetBuildSettings {
+	TextureCookSettings Texture;
+	unsigned int SpecularSamples = IBL_BAKE_DEFAULT_SAMPLES;
+	std::filesystem::path ArchiveFile; // Also pack the tree here when set. Keep it outside the root
+	AssetArchiveSettings Archive;
+	bool bForce = false; // Rebuild every step, whatever the manifest says
+};
+
+//-------------------------------------------------------
+// One output and everything it's made from
+//-------------------------------------------------------
+struct AssetBuildStep {
+	AssetStepType Type = AssetStepType::Texture;
+	std::filesystem::path Output;
+	std::vector<std::filesystem::path> Inputs; // Packed textures keep an empty path for each missing channel
+	std::vector<unsigned int> Dependencies; // Steps whose output is one of the inputs
+	uint64_t Key = 0; // Of the settings and the inputs' contents, once the step has run
+	bool bBuilt = false;
+	bool bFailed = false; // Also set when a dependency failed, without running
+};
+
+//-------------------------------------------------------
+// What a build did
+//-------------------------------------------------------
+struct AssetBuildResult {
+	unsigned int Steps = 0;
+	unsigned int Built = 0;
+	unsigned int UpToDate = 0;
+	unsigned int Failed = 0;
+	unsigned int HashedFiles = 0; // Read to hash, as the manifest had nothing for their size and write time
+	uint64_t HashedBytes = 0;
+};
+
+//-------------------------------------------------------
+// Incremental build of an asset tree, like a small make
+// that looks at contents instead of timestamps
+//	- Scanning finds every step: a cook per PNG, a packed
+//	  texture per material with ORM maps, a specular bake
+//	  per sky folder and, when asked, the archive, which
+//	  depends on every other step
+//	- A step's key hashes the build version, its settings
+//	  and each input's name and contents. It's clean when
+//	  the manifest recorded the same key and the output is
+//	  still the file written then, so a touched but equal
+//	  source rebuilds nothing and a changed setting
+//	  rebuilds exactly the steps it affects
+//	- File hashes are kept in the manifest by size and
+//	  write time, so a no-op build reads nothing but
+//	  directory entries
+//	- Steps run as jobs, each queued once its last
+//	  dependency finishes, so independent cooks fill every
+//	  core and the archive waits for what it packs
+//-------------------------------------------------------
+class AssetBuilder
+{
+public:
+	// a_manifest keeps what was built between runs. Keep it outside a_root, or it ends up in the archive
+	AssetBuilder(const std::filesystem::path& a_root, const std::filesystem::path& a_manifest);
+
+	// Scan the root, run every step that's out of date and save the manifest. False if any step failed
+	bool Build(const AssetBuildSettings& a_settings, AssetBuildResult& a_result);
+
+	// Getters
+	const std::vector<AssetBuildStep>& GetSteps() const { return m_steps; } // From the last Build
+	std::string GetName(const std::filesystem::path& a_file) const; // Relative to the root, as the manifest records it
+
+private:
+	struct FileRecord {
+		uint64_t Size = 0;
+		int64_t WriteTime = 0; // std::filesystem::file_time_type ticks
+		uint64_t Hash = 0;
+		bool bUsed = false; // Looked at by this build, so saved again
+	};
+
+	struct StepRecord {
+		uint64_t Key = 0;
+		uint64_t OutputHash = 0; // So an output edited or replaced since is rebuilt
+	};
+
+	void Scan(const AssetBuildSettings& a_settings);
+	void RunStep(AssetBuildStep& a_step, const AssetBuildSettings& a_settings, AssetBuildResult& a_result);
+	uint64_t ComputeKey(const AssetBuildStep& a_step, const AssetBuildSettings& a_settings, AssetBuildResult& a_result);
+	bool HashFile(const std::filesystem::path& a_file, uint64_t& a_hash, AssetBuildResult& a_result);
+	bool LoadManifest();
+	bool SaveManifest();
+
+	std::filesystem::path m_root;
+	std::string m_rootKey; // AssetKeys::FromPath of the root
+	std::filesystem::path m_manifest;
+	std::vector<AssetBuildStep> m_steps;
+
+	std::mutex m_mutex; // Steps hash and record from every worker
+	std::unordered_map<std::string, FileRecord> m_files; // By GetName
+	std::unordered_map<std::string, StepRecord> m_outputs; // By GetName of the output
+};
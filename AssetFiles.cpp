@@ -0,0 +1,126 @@
+#include "AssetFiles.h"
+#include "AssetPool.h"
+
+#include <fstream>
+
+namespace
+{
+	AssetArchive s_archive;
+	std::string s_rootKey; // AssetKeys::FromPath of the mounted folder
+
+	// The archive entry for a_fileName, or -1
+	int FindEntry(const std::filesystem::path& a_fileName)
+	{
+		if (!s_archive.IsOpen())
+			return -1;
+		std::string key = AssetKeys::FromPath(a_fileName);
+		if (key.size() <= s_rootKey.size() + 1 || key.compare(0, s_rootKey.size(), s_rootKey) != 0 || key[s_rootKey.size()] != '/')
+			return -1;
+		return s_archive.Find(key.substr(s_rootKey.size() + 1));
+	}
+}
+
+bool AssetFiles::Mount(const std::filesystem::path& a_archive, const std::filesystem::path& a_root)
+{
+	s_rootKey = AssetKeys::FromPath(a_root);
+	return s_archive.Open(a_archive);
+}
+
+void AssetFiles::Unmount()
+{
+	s_archive.Close();
+	s_rootKey.clear();
+}
+
+const AssetArchive& AssetFiles::GetArchive()
+{
+	return s_archive;
+}
+
+bool AssetFiles::Read(const std::filesystem::path& a_fileName, AssetFileView& a_view)
+{
+	a_view.Storage.clear();
+	int entry = FindEntry(a_fileName);
+	a_view.bArchived = entry >= 0;
+	if (a_view.bArchived) {
+		if (s_archive.GetView((unsigned int)entry, a_view.Data, a_view.Size))
+			return true;
+		if (!s_archive.Read((unsigned int)entry, a_view.Storage))
+			return false;
+	}
+	else {
+		std::ifstream file(a_fileName, std::ios::binary | std::ios::ate);
+		if (!file)
+			return false;
+		a_view.Storage.resize((size_t)file.tellg());
+		file.seekg(0);
+		if (!file.read((char*)a_view.Storage.data(), (std::streamsize)a_view.Storage.size()))
+			return false;
+	}
+	a_view.Data = a_view.Storage.data();
+	a_view.Size = a_view.Storage.size();
+	return true;
+}
+
+bool AssetFiles::Exists(const std::filesystem::path& a_fileName)
+{
+	std::error_code error;
+	return FindEntry(a_fileName) >= 0 || std::filesystem::exists(a_fileName, error);
+}
+
+bool AssetFiles::GetWriteTime(const std::filesystem::path& a_fileName, std::filesystem::file_time_type& a_time)
+{
+	int entry = FindEntry(a_fileName);
+	if (entry >= 0) {
+		a_time = std::filesystem::file_time_type(std::filesystem::file_time_type::duration(s_archive.GetEntry((unsigned int)entry).WriteTime));
+		return true;
+	}
+	std::error_code error;
+	a_time = std::filesystem::last_write_time(a_fileName, error);
+	return !error;
+}
+
+//-------------------------------------------------------
+// Fails like an ifstream would when the file is missing
+//-------------------------------------------------------
+AssetFileStream::AssetFileStream(const std::filesystem::path& a_fileName)
+	: std::istream(nullptr)
+{
+	rdbuf(&m_buffer);
+	m_bOpen = AssetFiles::Read(a_fileName, m_view);
+	if (m_bOpen)
+		m_buffer.SetView(m_view.Data, m_view.Size);
+	else
+		setstate(std::ios::failbit);
+}
+
+void AssetFileStream::close()
+{
+	m_buffer.SetView(nullptr, 0);
+	m_view = AssetFileView();
+	m_bOpen = false;
+}
+
+void AssetFileStream::ViewBuffer::SetView(const uint8_t* a_data, size_t a_size)
+{
+	char* begin = (char*)a_data; // Never written through, as there's no put area
+	setg(begin, begin, begin + a_size);
+}
+
+AssetFileStream::ViewBuffer::pos_type AssetFileStream::ViewBuffer::seekoff(off_type a_offset, std::ios_base::seekdir a_direction,
+	std::ios_base::openmode a_mode)
+{
+	if (!(a_mode & std::ios_base::in))
+		return pos_type(off_type(-1));
+	off_type base = a_direction == std::ios_base::beg ? 0 : (a_direction == std::ios_base::cur ? gptr() - eback() : egptr() - eback());
+	off_type position = base + a_offset;
+	if (position < 0 || position > egptr() - eback())
+		return pos_type(off_type(-1));
+	setg(eback(), eback() + position, egptr());
+	return pos_type(position);
+}
+
+AssetFileStream::ViewBuffer::pos_type AssetFileStream::ViewBuffer::seekpos(pos_type a_position, std::ios_base::openmode a_mode)
+{
+	return seekoff(off_type(a_position), std::ios_base::beg, a_mode);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <streambuf>
+#include <vector>
+
+#include "AssetArchive.h"
+
+//-------------------------------------------------------
+// A file's contents, wherever they came from. Data points
+// into the mounted archive's mapping for stored entries,
+// otherwise into Storage
+//-------------------------------------------------------
+struct AssetFileView {
+	const uint8_t* Data = nullptr;
+	size_t Size = 0;
+	std::vector<uint8_t> Storage;
+	bool bArchived = false;
+};
+
+//-------------------------------------------------------
+// Where loaders open asset files, so an archive can stand
+// in for the loose tree
+//	- Once an archive is mounted over a folder, any path
+//	  inside that folder is looked up in the archive first
+//	  and falls back to the loose file when it isn't there
+//	- Mount before loading starts. Reads are thread safe
+//-------------------------------------------------------
+namespace AssetFiles
+{
+	// Serve files under a_root from a_archive (see AssetArchive::Build). Replaces any archive already mounted
+	bool Mount(const std::filesystem::path& a_archive, const std::filesystem::path& a_root);
+	void Unmount();
+	const AssetArchive& GetArchive(); // Closed when nothing is mounted
+
+	// The whole file. Stored archive entries aren't copied
+	bool Read(const std::filesystem::path& a_fileName, AssetFileView& a_view);
+
+	bool Exists(const std::filesystem::path& a_fileName);
+
+	// The archived file's recorded time, or the loose file's
+	bool GetWriteTime(const std::filesystem::path& a_fileName, std::filesystem::file_time_type& a_time);
+}
+
+//-------------------------------------------------------
+// An input stream over an asset file, for loaders written
+// against std::ifstream. Seeks work as they would on the
+// file
+//-------------------------------------------------------
+class AssetFileStream : public std::istream
+{
+public:
+	explicit AssetFileStream(const std::filesystem::path& a_fileName);
+
+	bool is_open() const { return m_bOpen; }
+	void close(); // Frees the contents early
+
+private:
+	class ViewBuffer : public std::streambuf
+	{
+	public:
+		void SetView(const uint8_t* a_data, size_t a_size);
+
+	protected:
+		pos_type seekoff(off_type a_offset, std::ios_base::seekdir a_direction, std::ios_base::openmode a_mode) override;
+		pos_type seekpos(pos_type a_position, std::ios_base::openmode a_mode) override;
+	};
+
+	AssetFileView m_view;
+	ViewBuffer m_buffer;
+	bool m_bOpen = false;
+};
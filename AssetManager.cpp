@@ -0,0 +1,225 @@
+#include "AssetManager.h"
+#include "Hashing.h"
+#include "Helpers.h"
+
+namespace
+{
+	// GPU buffers of every LOD. LOD 0 is the Mesh's own
+	size_t GetMeshBytes(Mesh& a_mesh)
+	{
+		size_t bytes = 0;
+		for (unsigned int i = 0; i < a_mesh.GetLODCount(); i++) {
+			const MeshLOD& lod = a_mesh.GetLOD(i);
+			bytes += (size_t)lod.VertexCount * sizeof(Vertex) + (size_t)lod.IndexCount * sizeof(unsigned int);
+		}
+		return bytes;
+	}
+
+	size_t GetShaderBytes(ISimpleShader& a_shader)
+	{
+		Microsoft::WRL::ComPtr<ID3DBlob> blob = a_shader.GetShaderBlob();
+		return blob ? blob->GetBufferSize() : 0;
+	}
+
+	// Find a loaded shader, or load it once
+	template<typename T>
+	AssetHandle<T> LoadShader(AssetPool<T>& a_pool, Microsoft::WRL::ComPtr<ID3D11Device> a_device,
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, std::shared_ptr<RenderDevice> a_renderDevice, const std::wstring& a_fileName)
+	{
+		std::wstring path = FixPath(a_fileName);
+		std::string key = AssetKeys::FromPath(path);
+		AssetHandle<T> handle = a_pool.Acquire(key);
+		if (a_pool.IsValid(handle))
+			return handle;
+
+		std::shared_ptr<T> shader = std::make_shared<T>(a_device, a_context, a_renderDevice, path.c_str());
+		size_t bytes = GetShaderBytes(*shader);
+		return a_pool.Add(key, shader, bytes);
+	}
+
+	void AddStats(AssetPoolStats& a_total, const AssetPoolStats& a_stats)
+	{
+		a_total.Live += a_stats.Live;
+		a_total.Pending += a_stats.Pending;
+		a_total.Bytes += a_stats.Bytes;
+		a_total.Loads += a_stats.Loads;
+		a_total.Reuses += a_stats.Reuses;
+		a_total.Destroyed += a_stats.Destroyed;
+	}
+}
+
+// --------------------------------------------------------
+// Starts empty. Textures load through a_textureLoader,
+// which the caller keeps updating as before
+// --------------------------------------------------------
+AssetManager::AssetManager(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context,
+	std::shared_ptr<RenderDevice> a_renderDevice, std::shared_ptr<TextureLoader> a_textureLoader)
+	: m_device(a_device), m_context(a_context), m_renderDevice(a_renderDevice), m_textureLoader(a_textureLoader)
+{
+}
+
+// --------------------------------------------------------
+// Meshes with and without Meshlets are different assets,
+// as their buffers are ordered differently
+// --------------------------------------------------------
+MeshHandle AssetManager::LoadMesh(const std::wstring& a_filePath, bool a_bBuildMeshlets)
+{
+	std::wstring path = FixPath(a_filePath);
+	std::string key = AssetKeys::FromPath(path) + (a_bBuildMeshlets ? "|meshlets" : "");
+	MeshHandle handle = m_meshes.Acquire(key);
+	if (m_meshes.IsValid(handle))
+		return handle;
+
+	std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(path.c_str(), m_renderDevice, a_bBuildMeshlets);
+	size_t bytes = GetMeshBytes(*mesh);
+	return m_meshes.Add(key, mesh, bytes);
+}
+
+VertexShaderHandle AssetManager::LoadVertexShader(const std::wstring& a_fileName)
+{
+	return LoadShader(m_vertexShaders, m_device, m_context, m_renderDevice, a_fileName);
+}
+
+PixelShaderHandle AssetManager::LoadPixelShader(const std::wstring& a_fileName)
+{
+	return LoadShader(m_pixelShaders, m_device, m_context, m_renderDevice, a_fileName);
+}
+
+ComputeShaderHandle AssetManager::LoadComputeShader(const std::wstring& a_fileName)
+{
+	return LoadShader(m_computeShaders, m_device, m_context, m_renderDevice, a_fileName);
+}
+
+// --------------------------------------------------------
+// Samplers are keyed by their whole description, which
+// has no padding to hash
+// --------------------------------------------------------
+SamplerHandle AssetManager::CreateSampler(const D3D11_SAMPLER_DESC& a_desc)
+{
+	std::string key = AssetKeys::FromHash(Hashing::Value(a_desc));
+	SamplerHandle handle = m_samplers.Acquire(key);
+	if (m_samplers.IsValid(handle))
+		return handle;
+
+	std::shared_ptr<SamplerAsset> sampler = std::make_shared<SamplerAsset>();
+	m_device->CreateSamplerState(&a_desc, sampler->State.GetAddressOf());
+	return m_samplers.Add(key, sampler, 0);
+}
+
+// --------------------------------------------------------
+// Queue a texture once. Sizes are filled in by EndFrame
+// once it's uploaded
+// --------------------------------------------------------
+TextureHandle AssetManager::LoadTexture(const std::wstring& a_filePath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_placeholder,
+	bool a_bWait)
+{
+	std::string key = AssetKeys::FromPath(FixPath(a_filePath));
+	TextureHandle handle = m_textures.Acquire(key);
+	if (!m_textures.IsValid(handle)) {
+		std::shared_ptr<TextureAsset> texture = std::make_shared<TextureAsset>();
+		texture->Request = m_textureLoader->Load(a_filePath, a_placeholder);
+		handle = m_textures.Add(key, texture, 0);
+	}
+
+	if (a_bWait) {
+		m_textureLoader->Wait(m_textures.Get(handle)->Request);
+		m_textureLoader->ProcessUploads();
+	}
+	return handle;
+}
+
+TextureHandle AssetManager::LoadORM(const std::wstring& a_occlusionPath, const std::wstring& a_roughnessPath, const std::wstring& a_metalnessPath)
+{
+	std::string key = "orm";
+	for (const std::wstring* path : { &a_occlusionPath, &a_roughnessPath, &a_metalnessPath }) {
+		key += "|" + (path->empty() ? std::string() : AssetKeys::FromPath(FixPath(*path)));
+	}
+	TextureHandle handle = m_textures.Acquire(key);
+	if (m_textures.IsValid(handle))
+		return handle;
+
+	std::shared_ptr<TextureAsset> texture = std::make_shared<TextureAsset>();
+	texture->Request = m_textureLoader->LoadORM(a_occlusionPath, a_roughnessPath, a_metalnessPath);
+	return m_textures.Add(key, texture, 0);
+}
+
+void AssetManager::Bind(TextureHandle a_texture, std::shared_ptr<Material> a_material, const std::string& a_name)
+{
+	if (m_textures.IsValid(a_texture))
+		m_textureLoader->Bind(m_textures.Get(a_texture)->Request, a_material, a_name);
+}
+
+void AssetManager::BindORM(TextureHandle a_texture, std::shared_ptr<Material> a_material)
+{
+	if (m_textures.IsValid(a_texture))
+		m_textureLoader->BindORM(m_textures.Get(a_texture)->Request, a_material);
+}
+
+// --------------------------------------------------------
+// Getters
+// --------------------------------------------------------
+std::shared_ptr<Mesh> AssetManager::Get(MeshHandle a_handle)
+{
+	return m_meshes.Get(a_handle);
+}
+
+std::shared_ptr<SimpleVertexShader> AssetManager::Get(VertexShaderHandle a_handle)
+{
+	return m_vertexShaders.Get(a_handle);
+}
+
+std::shared_ptr<SimplePixelShader> AssetManager::Get(PixelShaderHandle a_handle)
+{
+	return m_pixelShaders.Get(a_handle);
+}
+
+std::shared_ptr<SimpleComputeShader> AssetManager::Get(ComputeShaderHandle a_handle)
+{
+	return m_computeShaders.Get(a_handle);
+}
+
+Microsoft::WRL::ComPtr<ID3D11SamplerState> AssetManager::Get(SamplerHandle a_handle)
+{
+	std::shared_ptr<SamplerAsset> sampler = m_samplers.Get(a_handle);
+	return sampler ? sampler->State : nullptr;
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> AssetManager::Get(TextureHandle a_handle)
+{
+	std::shared_ptr<TextureAsset> texture = m_textures.Get(a_handle);
+	return texture ? m_textureLoader->GetSRV(texture->Request) : nullptr;
+}
+
+// --------------------------------------------------------
+// Texture sizes change as uploads finish and mips stream,
+// so they're refreshed here rather than at load
+//	- Destroyed textures are unloaded from the TextureLoader
+//	  too, which holds the actual GPU texture
+// --------------------------------------------------------
+void AssetManager::EndFrame()
+{
+	m_textures.ForEach([this](TextureHandle a_handle) {
+		m_textures.SetBytes(a_handle, m_textureLoader->GetGPUBytes(m_textures.Get(a_handle)->Request));
+	});
+
+	m_meshes.Collect();
+	m_textures.Collect([this](TextureAsset& a_texture) {
+		m_textureLoader->Unload(a_texture.Request);
+	});
+	m_vertexShaders.Collect();
+	m_pixelShaders.Collect();
+	m_computeShaders.Collect();
+	m_samplers.Collect();
+}
+
+AssetManagerStats AssetManager::GetStats()
+{
+	AssetManagerStats stats;
+	stats.Meshes = m_meshes.GetStats();
+	stats.Textures = m_textures.GetStats();
+	AddStats(stats.Shaders, m_vertexShaders.GetStats());
+	AddStats(stats.Shaders, m_pixelShaders.GetStats());
+	AddStats(stats.Shaders, m_computeShaders.GetStats());
+	stats.Samplers = m_samplers.GetStats();
+	return stats;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <wrl/client.h>
+#include <d3d11.h>
+
+#include "AssetPool.h"
+#include "Mesh.h"
+#include "RenderDevice.h"
+#include "TextureLoader.h"
+#include "simpleshader/SimpleShader.h"
+
+// A TextureLoader request, as an asset
+struct TextureAsset {
+	TextureRequest Request;
+};
+
+struct SamplerAsset {
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> State;
+};
+
+typedef AssetHandle<Mesh> MeshHandle;
+typedef AssetHandle<TextureAsset> TextureHandle;
+typedef AssetHandle<SimpleVertexShader> VertexShaderHandle;
+typedef AssetHandle<SimplePixelShader> PixelShaderHandle;
+typedef AssetHandle<SimpleComputeShader> ComputeShaderHandle;
+typedef AssetHandle<SamplerAsset> SamplerHandle;
+
+// Per type counts, for the stats window
+struct AssetManagerStats {
+	AssetPoolStats Meshes;
+	AssetPoolStats Textures;
+	AssetPoolStats Shaders; // Vertex, pixel and compute together
+	AssetPoolStats Samplers;
+};
+
+//-------------------------------------------------------
+// One place that loads and owns meshes, textures, shaders
+// and samplers, so each exists once however many users
+// ask for it
+//	- Files are keyed by their normalized path (see
+//	  AssetKeys), samplers by a hash of their description.
+//	  Asking again returns the same handle with its count
+//	  raised, and users Release what they no longer need
+//	- Unreferenced assets are destroyed a few frames later
+//	  by EndFrame (see AssetPool), so GPU work still in
+//	  flight can finish with them
+//	- Textures go through the TextureLoader, so they load
+//	  in the background as before. Binding goes through
+//	  here so callers only deal in handles
+//	- Memory is tracked per type: GPU buffers for meshes,
+//	  resident texture levels, bytecode for shaders
+//-------------------------------------------------------
+class AssetManager
+{
+public:
+	AssetManager(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context,
+		std::shared_ptr<RenderDevice> a_renderDevice, std::shared_ptr<TextureLoader> a_textureLoader);
+
+	// Paths are fixed using FixPath(). Shaders are .cso names next to the executable
+	MeshHandle LoadMesh(const std::wstring& a_filePath, bool a_bBuildMeshlets = false);
+	VertexShaderHandle LoadVertexShader(const std::wstring& a_fileName);
+	PixelShaderHandle LoadPixelShader(const std::wstring& a_fileName);
+	ComputeShaderHandle LoadComputeShader(const std::wstring& a_fileName);
+	SamplerHandle CreateSampler(const D3D11_SAMPLER_DESC& a_desc);
+
+	// Queue a texture with the TextureLoader (see TextureLoader::Load), unless it's already loaded or loading
+	//	- a_bWait finishes it before returning, along with any other uploads that are ready, for textures that are
+	//	  placeholders for other loads. The placeholder only applies to the first load of a file
+	TextureHandle LoadTexture(const std::wstring& a_filePath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_placeholder,
+		bool a_bWait = false);
+
+	// Occlusion, roughness and metalness packed into one texture (see TextureLoader::LoadORM), keyed by all three
+	TextureHandle LoadORM(const std::wstring& a_occlusionPath, const std::wstring& a_roughnessPath, const std::wstring& a_metalnessPath);
+
+	// TextureLoader::Bind and BindORM, by handle
+	void Bind(TextureHandle a_texture, std::shared_ptr<Material> a_material, const std::string& a_name);
+	void BindORM(TextureHandle a_texture, std::shared_ptr<Material> a_material);
+
+	// The assets themselves. Invalid handles give nullptr
+	std::shared_ptr<Mesh> Get(MeshHandle a_handle);
+	std::shared_ptr<SimpleVertexShader> Get(VertexShaderHandle a_handle);
+	std::shared_ptr<SimplePixelShader> Get(PixelShaderHandle a_handle);
+	std::shared_ptr<SimpleComputeShader> Get(ComputeShaderHandle a_handle);
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> Get(SamplerHandle a_handle);
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> Get(TextureHandle a_handle); // The placeholder until uploaded
+
+	// One more user, or one fewer
+	template<typename T>
+	void AddRef(AssetHandle<T> a_handle) { GetPool<T>().AddRef(a_handle); }
+	template<typename T>
+	void Release(AssetHandle<T> a_handle) { GetPool<T>().Release(a_handle); }
+
+	// Once per frame. Destroys assets unreferenced for long enough and refreshes texture sizes
+	void EndFrame();
+
+	AssetManagerStats GetStats();
+
+private:
+	template<typename T> AssetPool<T>& GetPool();
+
+	Microsoft::WRL::ComPtr<ID3D11Device> m_device;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_context;
+	std::shared_ptr<RenderDevice> m_renderDevice;
+	std::shared_ptr<TextureLoader> m_textureLoader;
+
+	AssetPool<Mesh> m_meshes;
+	AssetPool<TextureAsset> m_textures;
+	AssetPool<SimpleVertexShader> m_vertexShaders;
+	AssetPool<SimplePixelShader> m_pixelShaders;
+	AssetPool<SimpleComputeShader> m_computeShaders;
+	AssetPool<SamplerAsset> m_samplers;
+};
+
+template<> inline AssetPool<Mesh>& AssetManager::GetPool<Mesh>() { return m_meshes; }
+template<> inline AssetPool<TextureAsset>& AssetManager::GetPool<TextureAsset>() { return m_textures; }
+template<> inline AssetPool<SimpleVertexShader>& AssetManager::GetPool<SimpleVertexShader>() { return m_vertexShaders; }
+template<> inline AssetPool<SimplePixelShader>& AssetManager::GetPool<SimplePixelShader>() { return m_pixelShaders; }
+template<> inline AssetPool<SimpleComputeShader>& AssetManager::GetPool<SimpleComputeShader>() { return m_computeShaders; }
+template<> inline AssetPool<SamplerAsset>& AssetManager::GetPool<SamplerAsset>() { return m_samplers; }
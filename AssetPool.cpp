@@ -0,0 +1,26 @@
+#include "AssetPool.h"
+
+#include <cstdio>
+#include <cwctype>
+
+//-------------------------------------------------------
+// Paths that name the same file give the same key, so
+// "../a/b.png" and "A\\B.png" don't load twice
+//-------------------------------------------------------
+std::string AssetKeys::FromPath(const std::filesystem::path& a_path)
+{
+	std::error_code error;
+	std::filesystem::path absolute = std::filesystem::absolute(a_path, error);
+	std::wstring key = (error ? a_path : absolute).lexically_normal().generic_wstring();
+	for (wchar_t& character : key) {
+		character = (wchar_t)std::towlower(character);
+	}
+	return std::filesystem::path(key).generic_u8string();
+}
+
+std::string AssetKeys::FromHash(uint64_t a_hash)
+{
+	char key[24];
+	std::snprintf(key, sizeof(key), "#%016llx", (unsigned long long)a_hash);
+	return key;
+}
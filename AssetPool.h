@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define ASSET_DESTROY_DELAY_FRAMES 3 // Frames an unreferenced asset lives on, covering any GPU work still using it
+
+//-------------------------------------------------------
+// Identifies one asset in an AssetPool<T>. The Generation
+// tells a handle to a destroyed asset apart from whatever
+// later reuses its slot, so stale handles just miss
+//-------------------------------------------------------
+template<typename T>
+struct AssetHandle {
+	uint32_t Index = 0;
+	uint32_t Generation = 0; // 0 is never issued, so a default handle is always invalid
+
+	bool operator==(const AssetHandle& a_other) const { return Index == a_other.Index && Generation == a_other.Generation; }
+	bool operator!=(const AssetHandle& a_other) const { return !(*this == a_other); }
+};
+
+//-------------------------------------------------------
+// Counts for one pool, for the stats window and tests
+//-------------------------------------------------------
+struct AssetPoolStats {
+	unsigned int Live = 0; // Referenced
+	unsigned int Pending = 0; // Unreferenced, waiting out ASSET_DESTROY_DELAY_FRAMES
+	size_t Bytes = 0; // Over live and pending assets
+	unsigned int Loads = 0; // Assets created
+	unsigned int Reuses = 0; // Acquires that found the asset already loaded
+	unsigned int Destroyed = 0;
+};
+
+//-------------------------------------------------------
+// Keys that make the same asset compare equal however it
+// was asked for
+//-------------------------------------------------------
+namespace AssetKeys
+{
+	// Absolute, lexically normal, forward slashes and (as Windows paths ignore case) lower case
+	std::string FromPath(const std::filesystem::path& a_path);
+
+	// For assets without a file, such as sampler descriptions or generated data
+	std::string FromHash(uint64_t a_hash);
+}
+
+//-------------------------------------------------------
+// Load-once storage for one type of asset
+//	- Assets are found by key. Acquire hands back the
+//	  existing asset with its count raised, so each file
+//	  or description exists once no matter how many users
+//	  ask for it
+//	- Release drops a reference. Unreferenced assets stay
+//	  for ASSET_DESTROY_DELAY_FRAMES more Collect calls
+//	  (one per frame), so frames in flight can finish with
+//	  them and anything reacquired meanwhile is revived
+//	  instead of loaded again
+//	- Each asset carries its size in bytes, summed for
+//	  the pool's stats
+//	- Not thread safe. Owned by the render thread
+//-------------------------------------------------------
+template<typename T>
+class AssetPool
+{
+public:
+	typedef AssetHandle<T> Handle;
+
+	// The asset for a_key with one more reference, or an invalid handle when it isn't loaded
+	Handle Acquire(const std::string& a_key)
+	{
+		auto found = m_keys.find(a_key);
+		if (found == m_keys.end())
+			return Handle();
+		Entry& entry = m_entries[found->second];
+		entry.RefCount++;
+		m_stats.Reuses++;
+		return Handle{ found->second, entry.Generation };
+	}
+
+	// Store a newly loaded asset under a_key, with one reference. a_key must not be loaded already
+	Handle Add(const std::string& a_key, std::shared_ptr<T> a_asset, size_t a_bytes)
+	{
+		uint32_t index;
+		if (!m_freeSlots.empty()) {
+			index = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else {
+			index = (uint32_t)m_entries.size();
+			m_entries.emplace_back();
+		}
+
+		Entry& entry = m_entries[index];
+		entry.Asset = std::move(a_asset);
+		entry.Key = a_key;
+		entry.Bytes = a_bytes;
+		entry.RefCount = 1;
+		m_keys[a_key] = index;
+		m_stats.Bytes += a_bytes;
+		m_stats.Loads++;
+		return Handle{ index, entry.Generation };
+	}
+
+	void AddRef(Handle a_handle)
+	{
+		if (IsValid(a_handle))
+			m_entries[a_handle.Index].RefCount++;
+	}
+
+	// Drop a reference. The last one schedules the asset's destruction
+	void Release(Handle a_handle)
+	{
+		if (!IsValid(a_handle) || m_entries[a_handle.Index].RefCount == 0)
+			return;
+		Entry& entry = m_entries[a_handle.Index];
+		if (--entry.RefCount == 0)
+			entry.ReleaseFrame = m_frame;
+	}
+
+	// Advance a frame and destroy what has been unreferenced for ASSET_DESTROY_DELAY_FRAMES. Returns how many went
+	unsigned int Collect()
+	{
+		return Collect([](T&) {});
+	}
+
+	// Collect, calling a_onDestroy(T&) on each asset first, for assets something else also holds on to
+	template<typename Function>
+	unsigned int Collect(Function a_onDestroy)
+	{
+		m_frame++;
+		unsigned int destroyed = 0;
+		for (uint32_t i = 0; i < (uint32_t)m_entries.size(); i++) {
+			Entry& entry = m_entries[i];
+			if (!entry.Asset || entry.RefCount > 0 || m_frame - entry.ReleaseFrame < ASSET_DESTROY_DELAY_FRAMES)
+				continue;
+			a_onDestroy(*entry.Asset);
+			m_keys.erase(entry.Key);
+			m_stats.Bytes -= entry.Bytes;
+			uint32_t generation = entry.Generation + 1;
+			entry = Entry();
+			entry.Generation = generation != 0 ? generation : 1;
+			m_freeSlots.push_back(i);
+			destroyed++;
+		}
+		m_stats.Destroyed += destroyed;
+		return destroyed;
+	}
+
+	// Replace an asset's size, for assets whose memory changes after loading (streamed textures)
+	void SetBytes(Handle a_handle, size_t a_bytes)
+	{
+		if (!IsValid(a_handle))
+			return;
+		Entry& entry = m_entries[a_handle.Index];
+		m_stats.Bytes = m_stats.Bytes - entry.Bytes + a_bytes;
+		entry.Bytes = a_bytes;
+	}
+
+	// Loaded and not yet destroyed, referenced or not
+	bool IsValid(Handle a_handle) const
+	{
+		return a_handle.Generation != 0 && a_handle.Index < m_entries.size()
+			&& m_entries[a_handle.Index].Generation == a_handle.Generation && m_entries[a_handle.Index].Asset;
+	}
+
+	// Getters. Invalid handles give nullptr and 0
+	std::shared_ptr<T> Get(Handle a_handle) const { return IsValid(a_handle) ? m_entries[a_handle.Index].Asset : nullptr; }
+	unsigned int GetRefCount(Handle a_handle) const { return IsValid(a_handle) ? m_entries[a_handle.Index].RefCount : 0; }
+	size_t GetBytes(Handle a_handle) const { return IsValid(a_handle) ? m_entries[a_handle.Index].Bytes : 0; }
+
+	AssetPoolStats GetStats() const
+	{
+		AssetPoolStats stats = m_stats;
+		for (const Entry& entry : m_entries) {
+			if (entry.Asset) {
+				stats.Live += entry.RefCount > 0 ? 1 : 0;
+				stats.Pending += entry.RefCount == 0 ? 1 : 0;
+			}
+		}
+		return stats;
+	}
+
+	// Every loaded asset's handle, for walking the pool
+	template<typename Function>
+	void ForEach(Function a_function) const
+	{
+		for (uint32_t i = 0; i < (uint32_t)m_entries.size(); i++) {
+			if (m_entries[i].Asset)
+				a_function(Handle{ i, m_entries[i].Generation });
+		}
+	}
+
+private:
+	struct Entry {
+		std::shared_ptr<T> Asset; // Null for a free slot
+		std::string Key;
+		size_t Bytes = 0;
+		unsigned int RefCount = 0;
+		uint64_t ReleaseFrame = 0; // Collect count when the last reference went
+		uint32_t Generation = 1;
+	};
+
+	std::vector<Entry> m_entries;
+	std::vector<uint32_t> m_freeSlots;
+	std::unordered_map<std::string, uint32_t> m_keys;
+	AssetPoolStats m_stats; // Live and Pending are counted on request
+	uint64_t m_frame = 0;
+};
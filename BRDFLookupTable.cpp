@@ -0,0 +1,432 @@
+#include "BRDFLookupTable.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// SSE is baseline on every x64 target, and on x86 when building with /arch:SSE2 or -msse2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BRDF_LUT_SSE 1
+#include <emmintrin.h>
+#else
+#define BRDF_LUT_SSE 0
+#endif
+
+#define BRDF_LUT_PI 3.14159265358979f
+#define BRDF_LUT_VALUES_PER_LINE 16 // Header formatting
+
+namespace
+{
+	//---------------------------------------------------
+	// Half vector of one GGX sample in the shader's world
+	// frame. With N = +Z, ImportanceSampleGGX's tangent
+	// frame maps (x, y, z) to (y, -x, z), and V has no y,
+	// so only world x and z matter
+	//---------------------------------------------------
+	struct HalfVector {
+		float X;
+		float Z;
+	};
+
+	// Hammersley.hlsli radicalInverse_VdC
+	float RadicalInverse(unsigned int a_bits)
+	{
+		a_bits = (a_bits << 16u) | (a_bits >> 16u);
+		a_bits = ((a_bits & 0x55555555u) << 1u) | ((a_bits & 0xAAAAAAAAu) >> 1u);
+		a_bits = ((a_bits & 0x33333333u) << 2u) | ((a_bits & 0xCCCCCCCCu) >> 2u);
+		a_bits = ((a_bits & 0x0F0F0F0Fu) << 4u) | ((a_bits & 0xF0F0F0F0u) >> 4u);
+		a_bits = ((a_bits & 0x00FF00FFu) << 8u) | ((a_bits & 0xFF00FF00u) >> 8u);
+		return (float)a_bits * 2.3283064365386963e-10f;
+	}
+
+	// Hammersley2d + ImportanceSampleGGX, shared by a whole row
+	void BuildHalfVectors(float a_roughness, unsigned int a_sampleCount, std::vector<HalfVector>& a_halfVectors)
+	{
+		float alpha = a_roughness * a_roughness;
+		float alphaSquared = alpha * alpha;
+		a_halfVectors.resize(a_sampleCount);
+		for (unsigned int i = 0; i < a_sampleCount; i++) {
+			float phi = 2.f * BRDF_LUT_PI * ((float)i / a_sampleCount);
+			float xi = RadicalInverse(i);
+			float cosTheta = std::sqrt((1.f - xi) / (1.f + (alphaSquared - 1.f) * xi));
+			float sinTheta = std::sqrt(1.f - cosTheta * cosTheta);
+			a_halfVectors[i].X = sinTheta * std::sin(phi);
+			a_halfVectors[i].Z = cosTheta;
+		}
+	}
+
+	// G1_Schlick's k, which uses roughness rather than alpha
+	inline float SchlickK(float a_roughness)
+	{
+		return a_roughness * a_roughness * 0.5f;
+	}
+
+	inline float Saturate(float a_value)
+	{
+		return a_value < 0.f ? 0.f : (a_value > 1.f ? 1.f : a_value);
+	}
+
+	Vector2 IntegrateScalar(const std::vector<HalfVector>& a_halfVectors, float a_roughness, float a_NdotV)
+	{
+		float sinV = std::sqrt(1.f - a_NdotV * a_NdotV);
+		float k = SchlickK(a_roughness);
+		float g1View = a_NdotV / (a_NdotV * (1.f - k) + k);
+
+		float a = 0.f;
+		float b = 0.f;
+		for (const HalfVector& h : a_halfVectors) {
+			float VdotH = Saturate(sinV * h.X + a_NdotV * h.Z);
+			float NdotL = Saturate(2.f * VdotH * h.Z - a_NdotV);
+			float NdotH = Saturate(h.Z);
+			if (NdotL > 0.f) {
+				float g = g1View * (NdotL / (NdotL * (1.f - k) + k));
+				float gVis = g * VdotH / (NdotH * a_NdotV);
+				float oneMinusVdotH = 1.f - VdotH;
+				float squared = oneMinusVdotH * oneMinusVdotH;
+				float fc = squared * squared * oneMinusVdotH;
+				a += (1.f - fc) * gVis;
+				b += fc * gVis;
+			}
+		}
+		return Vector2(a / a_halfVectors.size(), b / a_halfVectors.size());
+	}
+
+#if BRDF_LUT_SSE
+	//---------------------------------------------------
+	// IntegrateScalar for 4 NdotV values of one row.
+	// Samples below the horizon are masked out rather
+	// than branched on
+	//---------------------------------------------------
+	void IntegrateSIMD(const std::vector<HalfVector>& a_halfVectors, float a_roughness, const float a_NdotV[4], Vector2 a_results[4])
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 k = _mm_set1_ps(SchlickK(a_roughness));
+		const __m128 oneMinusK = _mm_sub_ps(one, k);
+
+		__m128 NdotV = _mm_loadu_ps(a_NdotV);
+		__m128 sinV = _mm_sqrt_ps(_mm_sub_ps(one, _mm_mul_ps(NdotV, NdotV)));
+		__m128 g1View = _mm_div_ps(NdotV, _mm_add_ps(_mm_mul_ps(NdotV, oneMinusK), k));
+		__m128 visScale = _mm_div_ps(g1View, NdotV); // G1(V) / NdotV is constant over the samples
+
+		__m128 a = zero;
+		__m128 b = zero;
+		for (const HalfVector& h : a_halfVectors) {
+			__m128 hx = _mm_set1_ps(h.X);
+			__m128 hz = _mm_set1_ps(h.Z);
+			__m128 VdotH = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(sinV, hx), _mm_mul_ps(NdotV, hz)), zero), one);
+			__m128 NdotL = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(_mm_add_ps(VdotH, VdotH), hz), NdotV), zero), one);
+			__m128 mask = _mm_cmpgt_ps(NdotL, zero);
+
+			__m128 g1Light = _mm_div_ps(NdotL, _mm_add_ps(_mm_mul_ps(NdotL, oneMinusK), k));
+			__m128 gVis = _mm_div_ps(_mm_mul_ps(_mm_mul_ps(visScale, g1Light), VdotH), hz);
+			gVis = _mm_and_ps(gVis, mask);
+
+			__m128 oneMinusVdotH = _mm_sub_ps(one, VdotH);
+			__m128 squared = _mm_mul_ps(oneMinusVdotH, oneMinusVdotH);
+			__m128 fc = _mm_mul_ps(_mm_mul_ps(squared, squared), oneMinusVdotH);
+			__m128 fcVis = _mm_mul_ps(fc, gVis);
+			a = _mm_add_ps(a, _mm_sub_ps(gVis, fcVis));
+			b = _mm_add_ps(b, fcVis);
+		}
+
+		float inverseCount = 1.f / a_halfVectors.size();
+		float aValues[4];
+		float bValues[4];
+		_mm_storeu_ps(aValues, _mm_mul_ps(a, _mm_set1_ps(inverseCount)));
+		_mm_storeu_ps(bValues, _mm_mul_ps(b, _mm_set1_ps(inverseCount)));
+		for (int i = 0; i < 4; i++) {
+			a_results[i] = Vector2(aValues[i], bValues[i]);
+		}
+	}
+#endif
+
+	void GenerateRow(const BRDFLookupSettings& a_settings, unsigned int a_row, std::vector<Vector2>& a_table, bool a_bUseSIMD)
+	{
+		unsigned int size = a_settings.Size;
+		float roughness = (a_row + 0.5f) / size;
+		Vector2* row = &a_table[(size_t)a_row * size];
+		if (a_settings.bAnalyticFit) {
+			for (unsigned int x = 0; x < size; x++) {
+				row[x] = BRDFLookupTable::EvaluateAnalytic(roughness, (x + 0.5f) / size);
+			}
+			return;
+		}
+
+		std::vector<HalfVector> halfVectors;
+		BuildHalfVectors(roughness, a_settings.SampleCount, halfVectors);
+
+		unsigned int x = 0;
+#if BRDF_LUT_SSE
+		if (a_bUseSIMD) {
+			for (; x + 4 <= size; x += 4) {
+				float NdotV[4] = { (x + 0.5f) / size, (x + 1.5f) / size, (x + 2.5f) / size, (x + 3.5f) / size };
+				IntegrateSIMD(halfVectors, roughness, NdotV, &row[x]);
+			}
+		}
+#endif
+		for (; x < size; x++) {
+			row[x] = IntegrateScalar(halfVectors, roughness, (x + 0.5f) / size);
+		}
+	}
+
+	inline unsigned short ToUNorm16(float a_value)
+	{
+		return (unsigned short)(Saturate(a_value) * 65535.f + 0.5f);
+	}
+
+	inline unsigned char ToUNorm8(float a_value)
+	{
+		return (unsigned char)(Saturate(a_value) * 255.f + 0.5f);
+	}
+
+	//---------------------------------------------------
+	// Round to nearest half. Table values are saturated
+	// first, so only zero, subnormals and normals below
+	// 1 ever show up
+	//---------------------------------------------------
+	unsigned short ToHalf(float a_value)
+	{
+		float value = Saturate(a_value);
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+		uint32_t mantissa = bits & 0x7FFFFF;
+		if (exponent <= 0) {
+			if (exponent < -10)
+				return 0;
+			mantissa |= 0x800000;
+			unsigned int shift = (unsigned int)(14 - exponent);
+			return (unsigned short)((mantissa + (1u << (shift - 1))) >> shift);
+		}
+		// A mantissa rounding up carries into the exponent, which is still the right half
+		return (unsigned short)((((uint32_t)exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+	}
+
+	float FromHalf(unsigned short a_half)
+	{
+		unsigned int exponent = (a_half >> 10) & 0x1F;
+		unsigned int mantissa = a_half & 0x3FF;
+		if (exponent == 0)
+			return std::ldexp((float)mantissa, -24);
+		return std::ldexp((float)(mantissa | 0x400), (int)exponent - 25);
+	}
+}
+
+//-------------------------------------------------------
+// Integrates one (roughness, NdotV) pair
+//-------------------------------------------------------
+Vector2 BRDFLookupTable::Integrate(float a_roughness, float a_NdotV, unsigned int a_sampleCount)
+{
+	std::vector<HalfVector> halfVectors;
+	BuildHalfVectors(a_roughness, a_sampleCount, halfVectors);
+	return IntegrateScalar(halfVectors, a_roughness, a_NdotV);
+}
+
+//-------------------------------------------------------
+// Polynomial fit of the same integral - no table at all,
+// at the cost of a few percent error at grazing angles
+//-------------------------------------------------------
+Vector2 BRDFLookupTable::EvaluateAnalytic(float a_roughness, float a_NdotV)
+{
+	const float c0[4] = { -1.f, -0.0275f, -0.572f, 0.022f };
+	const float c1[4] = { 1.f, 0.0425f, 1.04f, -0.04f };
+	float r[4];
+	for (int i = 0; i < 4; i++) {
+		r[i] = a_roughness * c0[i] + c1[i];
+	}
+	float a004 = std::fmin(r[0] * r[0], std::exp2(-9.28f * a_NdotV)) * r[0] + r[1];
+	return Vector2(a004 * -1.04f + r[2], a004 * 1.04f + r[3]);
+}
+
+//-------------------------------------------------------
+// Fills a_table with Size x Size texels
+//-------------------------------------------------------
+void BRDFLookupTable::Generate(const BRDFLookupSettings& a_settings, std::vector<Vector2>& a_table, bool a_bMultithreaded, bool a_bUseSIMD)
+{
+	a_table.assign((size_t)a_settings.Size * a_settings.Size, Vector2(0.f, 0.f));
+	if (a_settings.Size == 0 || (a_settings.SampleCount == 0 && !a_settings.bAnalyticFit))
+		return;
+
+	if (a_bMultithreaded) {
+		JobSystem::GetInstance().ParallelFor(a_settings.Size, 1, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int row = a_begin; row < a_end; row++) {
+				GenerateRow(a_settings, row, a_table, a_bUseSIMD);
+			}
+		});
+	}
+	else {
+		for (unsigned int row = 0; row < a_settings.Size; row++) {
+			GenerateRow(a_settings, row, a_table, a_bUseSIMD);
+		}
+	}
+
+	if (a_settings.Format != BRDFLookupFormat::R32G32_FLOAT) {
+		for (Vector2& texel : a_table) {
+			texel = Vector2(Quantize(texel.x, a_settings.Format), Quantize(texel.y, a_settings.Format));
+		}
+	}
+}
+
+//-------------------------------------------------------
+// UNORM formats and halves both saturate, as the table
+// only holds values in [0, 1]
+//-------------------------------------------------------
+float BRDFLookupTable::Quantize(float a_value, BRDFLookupFormat a_format)
+{
+	switch (a_format) {
+	case BRDFLookupFormat::R16G16_UNORM: return ToUNorm16(a_value) / 65535.f;
+	case BRDFLookupFormat::R8G8_UNORM: return ToUNorm8(a_value) / 255.f;
+	case BRDFLookupFormat::R16G16_FLOAT: return FromHalf(ToHalf(a_value));
+	default: return a_value;
+	}
+}
+
+unsigned int BRDFLookupTable::GetBytesPerTexel(BRDFLookupFormat a_format)
+{
+	switch (a_format) {
+	case BRDFLookupFormat::R8G8_UNORM: return 2;
+	case BRDFLookupFormat::R32G32_FLOAT: return 8;
+	default: return 4;
+	}
+}
+
+const char* BRDFLookupTable::GetFormatName(BRDFLookupFormat a_format)
+{
+	switch (a_format) {
+	case BRDFLookupFormat::R8G8_UNORM: return "R8G8_UNORM";
+	case BRDFLookupFormat::R16G16_FLOAT: return "R16G16_FLOAT";
+	case BRDFLookupFormat::R32G32_FLOAT: return "R32G32_FLOAT";
+	default: return "R16G16_UNORM";
+	}
+}
+
+//-------------------------------------------------------
+// Reads the table the way the pixel shader does
+//-------------------------------------------------------
+Vector2 BRDFLookupTable::Sample(const std::vector<Vector2>& a_table, unsigned int a_size, float a_roughness, float a_NdotV)
+{
+	float maxCoordinate = (float)(a_size - 1);
+	float texelX = a_NdotV * a_size - 0.5f;
+	float texelY = a_roughness * a_size - 0.5f;
+	texelX = texelX < 0.f ? 0.f : (texelX > maxCoordinate ? maxCoordinate : texelX);
+	texelY = texelY < 0.f ? 0.f : (texelY > maxCoordinate ? maxCoordinate : texelY);
+
+	unsigned int x0 = (unsigned int)texelX;
+	unsigned int y0 = (unsigned int)texelY;
+	unsigned int x1 = x0 + 1 < a_size ? x0 + 1 : x0;
+	unsigned int y1 = y0 + 1 < a_size ? y0 + 1 : y0;
+	float fractionX = texelX - x0;
+	float fractionY = texelY - y0;
+
+	const Vector2& t00 = a_table[(size_t)y0 * a_size + x0];
+	const Vector2& t10 = a_table[(size_t)y0 * a_size + x1];
+	const Vector2& t01 = a_table[(size_t)y1 * a_size + x0];
+	const Vector2& t11 = a_table[(size_t)y1 * a_size + x1];
+	float w00 = (1.f - fractionX) * (1.f - fractionY);
+	float w10 = fractionX * (1.f - fractionY);
+	float w01 = (1.f - fractionX) * fractionY;
+	float w11 = fractionX * fractionY;
+	return Vector2(
+		t00.x * w00 + t10.x * w10 + t01.x * w01 + t11.x * w11,
+		t00.y * w00 + t10.y * w10 + t01.y * w01 + t11.y * w11);
+}
+
+//-------------------------------------------------------
+// Error of a_table at the reference's texel centres
+//-------------------------------------------------------
+BRDFLookupErrorReport BRDFLookupTable::Compare(const std::vector<Vector2>& a_table, unsigned int a_size,
+	const std::vector<Vector2>& a_reference, unsigned int a_referenceSize)
+{
+	BRDFLookupErrorReport report;
+	if (a_size == 0 || a_referenceSize == 0)
+		return report;
+
+	std::vector<float> allErrors;
+	allErrors.reserve(2 * (size_t)a_referenceSize * a_referenceSize);
+	double sum = 0.0;
+	double sumSquared = 0.0;
+	for (unsigned int y = 0; y < a_referenceSize; y++) {
+		float roughness = (y + 0.5f) / a_referenceSize;
+		for (unsigned int x = 0; x < a_referenceSize; x++) {
+			float NdotV = (x + 0.5f) / a_referenceSize;
+			Vector2 value = Sample(a_table, a_size, roughness, NdotV);
+			const Vector2& reference = a_reference[(size_t)y * a_referenceSize + x];
+			float errors[2] = { std::fabs(value.x - reference.x), std::fabs(value.y - reference.y) };
+			for (float error : errors) {
+				allErrors.push_back(error);
+				sum += error;
+				sumSquared += (double)error * error;
+				if (error > report.MaxError) {
+					report.MaxError = error;
+					report.MaxErrorNdotV = NdotV;
+					report.MaxErrorRoughness = roughness;
+				}
+			}
+		}
+	}
+
+	std::vector<float>::iterator percentile = allErrors.begin() + (allErrors.size() * 99) / 100;
+	std::nth_element(allErrors.begin(), percentile, allErrors.end());
+	report.Percentile99Error = *percentile;
+
+	double count = 2.0 * a_referenceSize * a_referenceSize;
+	report.MeanError = (float)(sum / count);
+	report.RMSError = (float)std::sqrt(sumSquared / count);
+	return report;
+}
+
+//-------------------------------------------------------
+// Emits the table as a C++ array for embedding
+//	- Halves are written as their bits, and 32 bit floats
+//	  with enough digits to read back exactly
+//-------------------------------------------------------
+bool BRDFLookupTable::WriteHeader(const std::string& a_fileName, const std::vector<Vector2>& a_table, unsigned int a_size, BRDFLookupFormat a_format,
+	const std::string& a_comment)
+{
+	if (a_size == 0 || a_table.size() != (size_t)a_size * a_size)
+		return false;
+
+	std::ofstream file(a_fileName, std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	file << "#pragma once\n\n";
+	size_t lineStart = 0;
+	while (lineStart < a_comment.size()) {
+		size_t lineEnd = a_comment.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+			lineEnd = a_comment.size();
+		file << "// " << a_comment.substr(lineStart, lineEnd - lineStart) << "\n";
+		lineStart = lineEnd + 1;
+	}
+	const char* formatName = GetFormatName(a_format);
+	const char* typeName = a_format == BRDFLookupFormat::R8G8_UNORM ? "unsigned char"
+		: a_format == BRDFLookupFormat::R32G32_FLOAT ? "float" : "unsigned short";
+	file << "\n#define BRDF_LUT_DATA_SIZE " << a_size << "\n";
+	file << "#define BRDF_LUT_DATA_FORMAT DXGI_FORMAT_" << formatName << "\n\n";
+	file << "// " << formatName << " (scale, bias) texels, row-major, x = NdotV and y = roughness\n";
+	file << "static const " << typeName << " c_brdfLookupTableData[BRDF_LUT_DATA_SIZE * BRDF_LUT_DATA_SIZE * 2] = {\n";
+	size_t valueCount = a_table.size() * 2;
+	for (size_t i = 0; i < valueCount; i++) {
+		const Vector2& texel = a_table[i / 2];
+		float channel = i % 2 == 0 ? texel.x : texel.y;
+		char value[24];
+		switch (a_format) {
+		case BRDFLookupFormat::R8G8_UNORM: snprintf(value, sizeof(value), "%u", (unsigned int)ToUNorm8(channel)); break;
+		case BRDFLookupFormat::R16G16_FLOAT: snprintf(value, sizeof(value), "%u", (unsigned int)ToHalf(channel)); break;
+		case BRDFLookupFormat::R32G32_FLOAT: snprintf(value, sizeof(value), "%.9gf", channel); break;
+		default: snprintf(value, sizeof(value), "%u", (unsigned int)ToUNorm16(channel)); break;
+		}
+		if (i % BRDF_LUT_VALUES_PER_LINE == 0)
+			file << "\t";
+		file << value << ",";
+		file << ((i % BRDF_LUT_VALUES_PER_LINE == BRDF_LUT_VALUES_PER_LINE - 1 || i + 1 == valueCount) ? "\n" : " ");
+	}
+	file << "};\n";
+	return (bool)file;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Types.h"
+
+#define BRDF_LUT_DEFAULT_SIZE 64
+#define BRDF_LUT_REFERENCE_SIZE 1024 // What Game::CreateIBLBRDFLookupTable renders on the GPU
+#define BRDF_LUT_DEFAULT_SAMPLES 1024 // MAX_IBL_SAMPLES in ShaderHelpers.hlsli
+
+// Texel formats a table can be stored in. Generated tables are rounded to their format, so errors include it
+enum class BRDFLookupFormat {
+	R16G16_UNORM, // What IBLBRDFIntegrateMapPS renders into
+	R8G8_UNORM, // Half the size, at 1/255 steps
+	R16G16_FLOAT, // Finer than R16G16_UNORM near 0, coarser near 1
+	R32G32_FLOAT // Not rounded at all
+};
+
+//-------------------------------------------------------
+// Options for generating the split-sum BRDF table
+//-------------------------------------------------------
+struct BRDFLookupSettings {
+	unsigned int Size = BRDF_LUT_DEFAULT_SIZE; // Texels per side
+	unsigned int SampleCount = BRDF_LUT_DEFAULT_SAMPLES; // GGX samples per texel
+	bool bAnalyticFit = false; // Karis' polynomial fit instead of integrating
+	BRDFLookupFormat Format = BRDFLookupFormat::R16G16_UNORM;
+};
+
+//-------------------------------------------------------
+// How far a table is from a reference, sampled the way
+// the pixel shader reads it (bilinear, clamped)
+//	- The integral changes steeply at grazing angles on
+//	  near-mirror surfaces (NdotV < ~0.02), which no small
+//	  table resolves, so MaxError always lands there. The
+//	  99th percentile describes the rest of the table
+//-------------------------------------------------------
+struct BRDFLookupErrorReport {
+	float MaxError = 0.f; // Largest absolute difference in either channel
+	float Percentile99Error = 0.f;
+	float MeanError = 0.f;
+	float RMSError = 0.f;
+	float MaxErrorNdotV = 0.f; // Where MaxError happened
+	float MaxErrorRoughness = 0.f;
+};
+
+//-------------------------------------------------------
+// CPU version of IBLBRDFIntegrateMapPS, the (scale, bias)
+// applied to F0 in the split-sum specular approximation
+//	- Tables are row-major Vector2s, x = NdotV and
+//	  y = roughness at texel centres, the same layout the
+//	  GPU table has
+//	- The function is smooth, so a 64x64 table is close
+//	  to the 1024x1024 one at a tiny fraction of its size
+//	  (BRDFLookupTableData.h is generated from this)
+//	- Integration runs 4 NdotV values at a time with SSE,
+//	  one row per job
+//-------------------------------------------------------
+namespace BRDFLookupTable
+{
+	// IntegrateBRDF for one texel
+	Vector2 Integrate(float a_roughness, float a_NdotV, unsigned int a_sampleCount);
+
+	// EnvBRDFApprox from "Physically Based Shading on Mobile" (Karis 2014)
+	Vector2 EvaluateAnalytic(float a_roughness, float a_NdotV);
+
+	void Generate(const BRDFLookupSettings& a_settings, std::vector<Vector2>& a_table, bool a_bMultithreaded, bool a_bUseSIMD);
+
+	// Round a value to what a_format stores
+	float Quantize(float a_value, BRDFLookupFormat a_format);
+
+	// Size of one texel, and the format's DXGI name without the prefix ("R16G16_UNORM")
+	unsigned int GetBytesPerTexel(BRDFLookupFormat a_format);
+	const char* GetFormatName(BRDFLookupFormat a_format);
+
+	// Bilinear with clamp to edge, like ClampSampler
+	Vector2 Sample(const std::vector<Vector2>& a_table, unsigned int a_size, float a_roughness, float a_NdotV);
+
+	// Samples a_table at every texel centre of a_reference
+	BRDFLookupErrorReport Compare(const std::vector<Vector2>& a_table, unsigned int a_size,
+		const std::vector<Vector2>& a_reference, unsigned int a_referenceSize);
+
+	// Writes a header with the table as a_format texels, and BRDF_LUT_DATA_FORMAT naming the DXGI format. a_comment
+	// lines go at the top
+	bool WriteHeader(const std::string& a_fileName, const std::vector<Vector2>& a_table, unsigned int a_size, BRDFLookupFormat a_format,
+		const std::string& a_comment);
+}
@@ -0,0 +1,569 @@
+#include "BVH.h"
+
+#include <cmath>
+
+namespace
+{
+	AABB Union(const AABB& a_a, const AABB& a_b)
+	{
+		AABB box;
+		box.Min = Vector3(std::fmin(a_a.Min.x, a_b.Min.x), std::fmin(a_a.Min.y, a_b.Min.y), std::fmin(a_a.Min.z, a_b.Min.z));
+		box.Max = Vector3(std::fmax(a_a.Max.x, a_b.Max.x), std::fmax(a_a.Max.y, a_b.Max.y), std::fmax(a_a.Max.z, a_b.Max.z));
+		return box;
+	}
+
+	AABB Expand(const AABB& a_box, float a_margin)
+	{
+		AABB box;
+		box.Min = Vector3(a_box.Min.x - a_margin, a_box.Min.y - a_margin, a_box.Min.z - a_margin);
+		box.Max = Vector3(a_box.Max.x + a_margin, a_box.Max.y + a_margin, a_box.Max.z + a_margin);
+		return box;
+	}
+
+	float SurfaceArea(const AABB& a_box)
+	{
+		float x = a_box.Max.x - a_box.Min.x, y = a_box.Max.y - a_box.Min.y, z = a_box.Max.z - a_box.Min.z;
+		return 2.f * (x * y + y * z + z * x);
+	}
+
+	bool Contains(const AABB& a_outer, const AABB& a_inner)
+	{
+		return a_outer.Min.x <= a_inner.Min.x && a_outer.Min.y <= a_inner.Min.y && a_outer.Min.z <= a_inner.Min.z
+			&& a_outer.Max.x >= a_inner.Max.x && a_outer.Max.y >= a_inner.Max.y && a_outer.Max.z >= a_inner.Max.z;
+	}
+
+	bool Overlaps(const AABB& a_a, const AABB& a_b)
+	{
+		return a_a.Min.x <= a_b.Max.x && a_a.Min.y <= a_b.Max.y && a_a.Min.z <= a_b.Max.z
+			&& a_a.Max.x >= a_b.Min.x && a_a.Max.y >= a_b.Min.y && a_a.Max.z >= a_b.Min.z;
+	}
+
+	bool OverlapsSphere(const AABB& a_box, const Vector3& a_center, float a_radius)
+	{
+		float x = std::fmax(a_box.Min.x - a_center.x, std::fmax(0.f, a_center.x - a_box.Max.x));
+		float y = std::fmax(a_box.Min.y - a_center.y, std::fmax(0.f, a_center.y - a_box.Max.y));
+		float z = std::fmax(a_box.Min.z - a_center.z, std::fmax(0.f, a_center.z - a_box.Max.z));
+		return x * x + y * y + z * z <= a_radius * a_radius;
+	}
+
+	// -1 outside, 0 intersecting, 1 fully inside every plane. Same test as Culling::IntersectsBox
+	int ClassifyBox(const Frustum& a_frustum, const AABB& a_box)
+	{
+		float centerX = (a_box.Min.x + a_box.Max.x) * 0.5f, extentX = (a_box.Max.x - a_box.Min.x) * 0.5f;
+		float centerY = (a_box.Min.y + a_box.Max.y) * 0.5f, extentY = (a_box.Max.y - a_box.Min.y) * 0.5f;
+		float centerZ = (a_box.Min.z + a_box.Max.z) * 0.5f, extentZ = (a_box.Max.z - a_box.Min.z) * 0.5f;
+		int result = 1;
+		for (int plane = 0; plane < CULLING_PLANE_COUNT; plane++) {
+			const Vector4& p = a_frustum.Planes[plane];
+			float distance = p.x * centerX + p.y * centerY + p.z * centerZ + p.w;
+			float radius = std::fabs(p.x) * extentX + std::fabs(p.y) * extentY + std::fabs(p.z) * extentZ;
+			if (distance < -radius)
+				return -1;
+			if (distance < radius)
+				result = 0;
+		}
+		return result;
+	}
+
+	// Distance the ray enters the box at (0 when starting inside), or -1 for a miss
+	float RayEnterDistance(const AABB& a_box, const Vector3& a_origin, const Vector3& a_inverseDirection, float a_maxDistance)
+	{
+		float x0 = (a_box.Min.x - a_origin.x) * a_inverseDirection.x, x1 = (a_box.Max.x - a_origin.x) * a_inverseDirection.x;
+		float y0 = (a_box.Min.y - a_origin.y) * a_inverseDirection.y, y1 = (a_box.Max.y - a_origin.y) * a_inverseDirection.y;
+		float z0 = (a_box.Min.z - a_origin.z) * a_inverseDirection.z, z1 = (a_box.Max.z - a_origin.z) * a_inverseDirection.z;
+		float enter = std::fmax(std::fmax(std::fmin(x0, x1), std::fmin(y0, y1)), std::fmax(std::fmin(z0, z1), 0.f));
+		float exit = std::fmin(std::fmin(std::fmax(x0, x1), std::fmax(y0, y1)), std::fmin(std::fmax(z0, z1), a_maxDistance));
+		return enter <= exit ? enter : -1.f;
+	}
+
+	float SafeInverse(float a_value)
+	{
+		return std::fabs(a_value) > 1e-20f ? 1.f / a_value : (a_value < 0.f ? -1e30f : 1e30f);
+	}
+}
+
+BVH::BVH()
+	: m_root(BVH_NULL_NODE)
+	, m_freeList(BVH_NULL_NODE)
+	, m_proxyCount(0)
+{
+}
+
+//-------------------------------------------------------
+// Adds a leaf for a_box, padded by BVH_AABB_MARGIN
+//	- The returned proxy is what MoveProxy and
+//	  DestroyProxy take
+//-------------------------------------------------------
+int BVH::CreateProxy(const AABB& a_box, unsigned int a_userData)
+{
+	int proxy = AllocateNode();
+	m_nodes[proxy].Box = Expand(a_box, BVH_AABB_MARGIN);
+	m_nodes[proxy].UserData = a_userData;
+	m_nodes[proxy].Height = 0;
+	InsertLeaf(proxy);
+	m_proxyCount++;
+	return proxy;
+}
+
+void BVH::DestroyProxy(int a_proxy)
+{
+	RemoveLeaf(a_proxy);
+	FreeNode(a_proxy);
+	m_proxyCount--;
+}
+
+//-------------------------------------------------------
+// Reinserts the proxy only when a_box escaped its fat
+// box, or shrank so much the fat box is mostly empty
+//-------------------------------------------------------
+bool BVH::MoveProxy(int a_proxy, const AABB& a_box)
+{
+	const AABB& fatBox = m_nodes[a_proxy].Box;
+	if (Contains(fatBox, a_box) && Contains(Expand(a_box, 4.f * BVH_AABB_MARGIN), fatBox))
+		return false;
+
+	RemoveLeaf(a_proxy);
+	m_nodes[a_proxy].Box = Expand(a_box, BVH_AABB_MARGIN);
+	InsertLeaf(a_proxy);
+	return true;
+}
+
+void BVH::Clear()
+{
+	m_nodes.clear();
+	m_root = BVH_NULL_NODE;
+	m_freeList = BVH_NULL_NODE;
+	m_proxyCount = 0;
+}
+
+//-------------------------------------------------------
+// Stack based walks of every overlapping node
+//-------------------------------------------------------
+void BVH::QueryAABB(const AABB& a_box, std::vector<unsigned int>& a_results) const
+{
+	if (m_root == BVH_NULL_NODE)
+		return;
+
+	int stack[BVH_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = m_root;
+	while (stackCount > 0) {
+		const BVHNode& node = m_nodes[stack[--stackCount]];
+		if (!Overlaps(node.Box, a_box))
+			continue;
+
+		if (node.Child1 == BVH_NULL_NODE) {
+			a_results.push_back(node.UserData);
+		}
+		else {
+			stack[stackCount++] = node.Child1;
+			stack[stackCount++] = node.Child2;
+		}
+	}
+}
+
+void BVH::QuerySphere(const Vector3& a_center, float a_radius, std::vector<unsigned int>& a_results) const
+{
+	if (m_root == BVH_NULL_NODE)
+		return;
+
+	int stack[BVH_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = m_root;
+	while (stackCount > 0) {
+		const BVHNode& node = m_nodes[stack[--stackCount]];
+		if (!OverlapsSphere(node.Box, a_center, a_radius))
+			continue;
+
+		if (node.Child1 == BVH_NULL_NODE) {
+			a_results.push_back(node.UserData);
+		}
+		else {
+			stack[stackCount++] = node.Child1;
+			stack[stackCount++] = node.Child2;
+		}
+	}
+}
+
+//-------------------------------------------------------
+// Subtrees entirely inside the frustum are gathered
+// without testing any more boxes
+//-------------------------------------------------------
+void BVH::QueryFrustum(const Frustum& a_frustum, std::vector<unsigned int>& a_results) const
+{
+	if (m_root == BVH_NULL_NODE)
+		return;
+
+	struct Entry {
+		int Node;
+		bool bInside;
+	};
+	Entry stack[BVH_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = { m_root, false };
+	while (stackCount > 0) {
+		Entry entry = stack[--stackCount];
+		const BVHNode& node = m_nodes[entry.Node];
+		bool bInside = entry.bInside;
+		if (!bInside) {
+			int classification = ClassifyBox(a_frustum, node.Box);
+			if (classification < 0)
+				continue;
+			bInside = classification > 0;
+		}
+
+		if (node.Child1 == BVH_NULL_NODE) {
+			a_results.push_back(node.UserData);
+		}
+		else {
+			stack[stackCount++] = { node.Child1, bInside };
+			stack[stackCount++] = { node.Child2, bInside };
+		}
+	}
+}
+
+//-------------------------------------------------------
+// One walk for every view. Each stack entry carries the
+// views still being tested and the views that already
+// contain the whole subtree
+//-------------------------------------------------------
+void BVH::QueryFrustums(const std::vector<Frustum>& a_views, std::vector<uint64_t>& a_masks) const
+{
+	if (m_root == BVH_NULL_NODE || a_views.empty())
+		return;
+
+	unsigned int viewCount = a_views.size() < CULLING_MAX_VIEWS ? (unsigned int)a_views.size() : CULLING_MAX_VIEWS;
+	struct Entry {
+		int Node;
+		uint64_t Testing;
+		uint64_t Inside;
+	};
+	Entry stack[BVH_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = { m_root, viewCount == 64 ? ~0ull : (1ull << viewCount) - 1, 0ull };
+	while (stackCount > 0) {
+		Entry entry = stack[--stackCount];
+		const BVHNode& node = m_nodes[entry.Node];
+		for (unsigned int view = 0; view < viewCount && entry.Testing; view++) {
+			uint64_t bit = 1ull << view;
+			if (!(entry.Testing & bit))
+				continue;
+
+			int classification = ClassifyBox(a_views[view], node.Box);
+			if (classification != 0)
+				entry.Testing &= ~bit;
+			if (classification > 0)
+				entry.Inside |= bit;
+		}
+		if (!(entry.Testing | entry.Inside))
+			continue;
+
+		if (node.Child1 == BVH_NULL_NODE) {
+			a_masks[node.UserData] |= entry.Testing | entry.Inside;
+		}
+		else {
+			stack[stackCount++] = { node.Child1, entry.Testing, entry.Inside };
+			stack[stackCount++] = { node.Child2, entry.Testing, entry.Inside };
+		}
+	}
+}
+
+//-------------------------------------------------------
+// Nearer children are visited first, and the search
+// distance shrinks with every hit, so most of the tree
+// behind the first hit is never reached
+//-------------------------------------------------------
+unsigned int BVH::RayCast(const Vector3& a_origin, const Vector3& a_direction, float a_maxDistance,
+	const std::function<float(unsigned int)>& a_hitTest, float& a_hitDistance) const
+{
+	unsigned int closest = BVH_NO_HIT;
+	if (m_root == BVH_NULL_NODE)
+		return closest;
+
+	Vector3 inverseDirection(SafeInverse(a_direction.x), SafeInverse(a_direction.y), SafeInverse(a_direction.z));
+	float maxDistance = a_maxDistance;
+	int stack[BVH_STACK_SIZE];
+	int stackCount = 0;
+	stack[stackCount++] = m_root;
+	while (stackCount > 0) {
+		const BVHNode& node = m_nodes[stack[--stackCount]];
+		if (RayEnterDistance(node.Box, a_origin, inverseDirection, maxDistance) < 0.f)
+			continue;
+
+		if (node.Child1 == BVH_NULL_NODE) {
+			float distance = a_hitTest(node.UserData);
+			if (distance >= 0.f && distance <= maxDistance) {
+				maxDistance = distance;
+				closest = node.UserData;
+			}
+			continue;
+		}
+
+		// Push the farther child first so the nearer one pops next
+		float distance1 = RayEnterDistance(m_nodes[node.Child1].Box, a_origin, inverseDirection, maxDistance);
+		float distance2 = RayEnterDistance(m_nodes[node.Child2].Box, a_origin, inverseDirection, maxDistance);
+		bool bFirstIsNear = distance2 < 0.f || (distance1 >= 0.f && distance1 <= distance2);
+		int nearChild = bFirstIsNear ? node.Child1 : node.Child2;
+		int farChild = bFirstIsNear ? node.Child2 : node.Child1;
+		if ((bFirstIsNear ? distance2 : distance1) >= 0.f)
+			stack[stackCount++] = farChild;
+		if ((bFirstIsNear ? distance1 : distance2) >= 0.f)
+			stack[stackCount++] = nearChild;
+	}
+
+	a_hitDistance = maxDistance;
+	return closest;
+}
+
+//-------------------------------------------------------
+// Sum of every node's area over the root's. Grows as the
+// tree degrades, so it shows how well inserts and
+// rotations are working
+//-------------------------------------------------------
+float BVH::GetAreaRatio() const
+{
+	if (m_root == BVH_NULL_NODE)
+		return 0.f;
+
+	float rootArea = SurfaceArea(m_nodes[m_root].Box);
+	float totalArea = 0.f;
+	for (unsigned int i = 0; i < (unsigned int)m_nodes.size(); i++) {
+		if (m_nodes[i].Height > 0 && (int)i != m_root)
+			totalArea += SurfaceArea(m_nodes[i].Box);
+	}
+	return rootArea > 0.f ? totalArea / rootArea : 0.f;
+}
+
+//-------------------------------------------------------
+// Walks the whole tree checking the structure
+//-------------------------------------------------------
+bool BVH::Validate() const
+{
+	unsigned int leafCount = 0;
+	if (m_root != BVH_NULL_NODE && !ValidateNode(m_root, BVH_NULL_NODE, leafCount))
+		return false;
+
+	unsigned int freeCount = 0;
+	for (int node = m_freeList; node != BVH_NULL_NODE; node = m_nodes[node].Parent) {
+		freeCount++;
+	}
+	unsigned int nodeCount = m_root == BVH_NULL_NODE ? 0 : 2 * leafCount - 1;
+	return leafCount == m_proxyCount && nodeCount + freeCount == m_nodes.size();
+}
+
+bool BVH::ValidateNode(int a_node, int a_parent, unsigned int& a_leafCount) const
+{
+	const BVHNode& node = m_nodes[a_node];
+	if (node.Parent != a_parent)
+		return false;
+
+	if (node.Child1 == BVH_NULL_NODE) {
+		a_leafCount++;
+		return node.Child2 == BVH_NULL_NODE && node.Height == 0;
+	}
+
+	const BVHNode& child1 = m_nodes[node.Child1];
+	const BVHNode& child2 = m_nodes[node.Child2];
+	int height = 1 + (child1.Height > child2.Height ? child1.Height : child2.Height);
+	AABB box = Union(child1.Box, child2.Box);
+	if (node.Height != height || !Contains(node.Box, box) || !Contains(box, node.Box))
+		return false;
+
+	return ValidateNode(node.Child1, a_node, a_leafCount) && ValidateNode(node.Child2, a_node, a_leafCount);
+}
+
+//-------------------------------------------------------
+// Nodes are recycled through a free list threaded
+// through Parent, so indices (proxies) stay stable
+//-------------------------------------------------------
+int BVH::AllocateNode()
+{
+	int node = m_freeList;
+	if (node == BVH_NULL_NODE) {
+		node = (int)m_nodes.size();
+		m_nodes.push_back(BVHNode());
+	}
+	else {
+		m_freeList = m_nodes[node].Parent;
+	}
+
+	BVHNode& allocated = m_nodes[node];
+	allocated.Parent = BVH_NULL_NODE;
+	allocated.Child1 = BVH_NULL_NODE;
+	allocated.Child2 = BVH_NULL_NODE;
+	allocated.Height = 0;
+	allocated.UserData = 0;
+	return node;
+}
+
+void BVH::FreeNode(int a_node)
+{
+	m_nodes[a_node].Parent = m_freeList;
+	m_nodes[a_node].Height = -1;
+	m_freeList = a_node;
+}
+
+//-------------------------------------------------------
+// Surface area heuristic descent: at each level, stop
+// and pair with the current node, or continue into the
+// child whose box grows the least. Ancestors are then
+// refit and rebalanced on the way back up
+//-------------------------------------------------------
+void BVH::InsertLeaf(int a_leaf)
+{
+	if (m_root == BVH_NULL_NODE) {
+		m_root = a_leaf;
+		m_nodes[a_leaf].Parent = BVH_NULL_NODE;
+		return;
+	}
+
+	AABB leafBox = m_nodes[a_leaf].Box;
+	int index = m_root;
+	while (m_nodes[index].Child1 != BVH_NULL_NODE) {
+		const BVHNode& node = m_nodes[index];
+		float area = SurfaceArea(node.Box);
+		float combinedArea = SurfaceArea(Union(node.Box, leafBox));
+
+		// Cost of a new parent for this node and the leaf, and the growth pushed onto descendants
+		float cost = 2.f * combinedArea;
+		float inheritanceCost = 2.f * (combinedArea - area);
+
+		float childCosts[2];
+		int children[2] = { node.Child1, node.Child2 };
+		for (int i = 0; i < 2; i++) {
+			const BVHNode& child = m_nodes[children[i]];
+			float unionArea = SurfaceArea(Union(leafBox, child.Box));
+			childCosts[i] = (child.Child1 == BVH_NULL_NODE ? unionArea : unionArea - SurfaceArea(child.Box)) + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+			break;
+		index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+	int sibling = index;
+
+	// New parent for the sibling and the leaf. Allocating can grow m_nodes, so no references are held across it
+	int oldParent = m_nodes[sibling].Parent;
+	int newParent = AllocateNode();
+	m_nodes[newParent].Parent = oldParent;
+	m_nodes[newParent].Box = Union(leafBox, m_nodes[sibling].Box);
+	m_nodes[newParent].Height = m_nodes[sibling].Height + 1;
+	m_nodes[newParent].Child1 = sibling;
+	m_nodes[newParent].Child2 = a_leaf;
+	if (oldParent != BVH_NULL_NODE) {
+		if (m_nodes[oldParent].Child1 == sibling)
+			m_nodes[oldParent].Child1 = newParent;
+		else
+			m_nodes[oldParent].Child2 = newParent;
+	}
+	else {
+		m_root = newParent;
+	}
+	m_nodes[sibling].Parent = newParent;
+	m_nodes[a_leaf].Parent = newParent;
+
+	for (index = m_nodes[a_leaf].Parent; index != BVH_NULL_NODE; index = m_nodes[index].Parent) {
+		index = Balance(index);
+		BVHNode& node = m_nodes[index];
+		const BVHNode& child1 = m_nodes[node.Child1];
+		const BVHNode& child2 = m_nodes[node.Child2];
+		node.Height = 1 + (child1.Height > child2.Height ? child1.Height : child2.Height);
+		node.Box = Union(child1.Box, child2.Box);
+	}
+}
+
+//-------------------------------------------------------
+// The leaf's parent is removed and its sibling takes its
+// place, then ancestors are refit and rebalanced
+//-------------------------------------------------------
+void BVH::RemoveLeaf(int a_leaf)
+{
+	if (a_leaf == m_root) {
+		m_root = BVH_NULL_NODE;
+		return;
+	}
+
+	int parent = m_nodes[a_leaf].Parent;
+	int grandParent = m_nodes[parent].Parent;
+	int sibling = m_nodes[parent].Child1 == a_leaf ? m_nodes[parent].Child2 : m_nodes[parent].Child1;
+	FreeNode(parent);
+	if (grandParent == BVH_NULL_NODE) {
+		m_root = sibling;
+		m_nodes[sibling].Parent = BVH_NULL_NODE;
+		return;
+	}
+
+	if (m_nodes[grandParent].Child1 == parent)
+		m_nodes[grandParent].Child1 = sibling;
+	else
+		m_nodes[grandParent].Child2 = sibling;
+	m_nodes[sibling].Parent = grandParent;
+
+	for (int index = grandParent; index != BVH_NULL_NODE; index = m_nodes[index].Parent) {
+		index = Balance(index);
+		BVHNode& node = m_nodes[index];
+		const BVHNode& child1 = m_nodes[node.Child1];
+		const BVHNode& child2 = m_nodes[node.Child2];
+		node.Height = 1 + (child1.Height > child2.Height ? child1.Height : child2.Height);
+		node.Box = Union(child1.Box, child2.Box);
+	}
+}
+
+//-------------------------------------------------------
+// If one child of a_node is 2+ levels taller than the
+// other, rotate that child up into a_node's place. Its
+// taller grandchild stays with it and the shorter one
+// moves under a_node. Returns the subtree's new root
+//-------------------------------------------------------
+int BVH::Balance(int a_node)
+{
+	BVHNode& a = m_nodes[a_node];
+	if (a.Child1 == BVH_NULL_NODE || a.Height < 2)
+		return a_node;
+
+	int b = a.Child1;
+	int c = a.Child2;
+	int balance = m_nodes[c].Height - m_nodes[b].Height;
+	if (balance >= -1 && balance <= 1)
+		return a_node;
+
+	// Rotate the taller child (up) into a's place, keeping a's other child (kept)
+	int up = balance > 1 ? c : b;
+	int kept = balance > 1 ? b : c;
+	BVHNode& upNode = m_nodes[up];
+	int upChild1 = upNode.Child1;
+	int upChild2 = upNode.Child2;
+
+	upNode.Child1 = a_node;
+	upNode.Parent = a.Parent;
+	a.Parent = up;
+	if (upNode.Parent != BVH_NULL_NODE) {
+		if (m_nodes[upNode.Parent].Child1 == a_node)
+			m_nodes[upNode.Parent].Child1 = up;
+		else
+			m_nodes[upNode.Parent].Child2 = up;
+	}
+	else {
+		m_root = up;
+	}
+
+	// The taller grandchild stays under up, the shorter one replaces up under a
+	bool bFirstIsTaller = m_nodes[upChild1].Height > m_nodes[upChild2].Height;
+	int taller = bFirstIsTaller ? upChild1 : upChild2;
+	int shorter = bFirstIsTaller ? upChild2 : upChild1;
+	upNode.Child2 = taller;
+	if (balance > 1)
+		a.Child2 = shorter;
+	else
+		a.Child1 = shorter;
+	m_nodes[shorter].Parent = a_node;
+
+	const BVHNode& keptNode = m_nodes[kept];
+	const BVHNode& shorterNode = m_nodes[shorter];
+	const BVHNode& tallerNode = m_nodes[taller];
+	a.Box = Union(keptNode.Box, shorterNode.Box);
+	a.Height = 1 + (keptNode.Height > shorterNode.Height ? keptNode.Height : shorterNode.Height);
+	upNode.Box = Union(a.Box, tallerNode.Box);
+	upNode.Height = 1 + (a.Height > tallerNode.Height ? a.Height : tallerNode.Height);
+	return up;
+}
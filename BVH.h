@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Types.h"
+#include "Culling.h"
+
+#define BVH_NULL_NODE -1
+#define BVH_NO_HIT 0xFFFFFFFFu // RayCast found nothing
+#define BVH_AABB_MARGIN 0.1f // World units added around each leaf, so small moves don't touch the tree
+#define BVH_STACK_SIZE 256 // Traversal stack. Balanced trees of 2^32 leaves stay under 50 levels
+
+struct BVHNode {
+	AABB Box; // Fattened for leaves
+	int Parent; // Next free node while on the free list
+	int Child1;
+	int Child2;
+	int Height; // 0 for leaves, -1 while free
+	unsigned int UserData; // Leaves only, usually an entity index
+};
+
+//-------------------------------------------------------
+// Incremental dynamic AABB tree (as in Box2D's
+// b2DynamicTree) over entity bounds
+//	- Proxies are leaf node indices and stay valid until
+//	  destroyed. Leaves store a box fattened by
+//	  BVH_AABB_MARGIN, and MoveProxy only reinserts once
+//	  the real bounds leave it, so most frames only
+//	  objects that actually moved far cost anything
+//	- Inserts pick the sibling with the least surface area
+//	  growth, then refit up to the root with AVL-style
+//	  rotations that keep the height O(log n)
+//	- Queries only visit overlapping nodes, so they cost
+//	  O(results log n) rather than a walk of everything.
+//	  Subtrees fully inside a frustum are gathered without
+//	  testing further
+//-------------------------------------------------------
+class BVH
+{
+public:
+	BVH();
+
+	int CreateProxy(const AABB& a_box, unsigned int a_userData);
+	void DestroyProxy(int a_proxy);
+	bool MoveProxy(int a_proxy, const AABB& a_box); // True if the proxy was reinserted
+	void Clear();
+
+	// Leaf user data of every overlapping proxy, appended to a_results in no particular order
+	void QueryAABB(const AABB& a_box, std::vector<unsigned int>& a_results) const;
+	void QuerySphere(const Vector3& a_center, float a_radius, std::vector<unsigned int>& a_results) const;
+	void QueryFrustum(const Frustum& a_frustum, std::vector<unsigned int>& a_results) const;
+
+	// Multi-view version of QueryFrustum, matching Culling::CullSpheres. Sets bit v of a_masks[userData]
+	// for every proxy touching view v. a_masks must already be sized past the largest user data
+	void QueryFrustums(const std::vector<Frustum>& a_views, std::vector<uint64_t>& a_masks) const;
+
+	// Closest hit along a ray (a_direction unit length). a_hitTest gets the user data of each leaf box the ray
+	// reaches and returns the exact hit distance, or a negative value for a miss. Returns BVH_NO_HIT if nothing is hit
+	unsigned int RayCast(const Vector3& a_origin, const Vector3& a_direction, float a_maxDistance,
+		const std::function<float(unsigned int)>& a_hitTest, float& a_hitDistance) const;
+
+	// Getters
+	const AABB& GetFatAABB(int a_proxy) const { return m_nodes[a_proxy].Box; }
+	unsigned int GetUserData(int a_proxy) const { return m_nodes[a_proxy].UserData; }
+	unsigned int GetProxyCount() const { return m_proxyCount; }
+	int GetHeight() const { return m_root == BVH_NULL_NODE ? 0 : m_nodes[m_root].Height; }
+	float GetAreaRatio() const; // Total node area / root area, a quality measure (lower is better)
+
+	// Checks every link, height and box. Slow, for tools and debugging
+	bool Validate() const;
+
+private:
+	std::vector<BVHNode> m_nodes;
+	int m_root;
+	int m_freeList;
+	unsigned int m_proxyCount;
+
+	int AllocateNode();
+	void FreeNode(int a_node);
+	void InsertLeaf(int a_leaf);
+	void RemoveLeaf(int a_leaf);
+	int Balance(int a_node);
+	bool ValidateNode(int a_node, int a_parent, unsigned int& a_leafCount) const;
+};
@@ -0,0 +1,1352 @@
+#include "BlockCompression.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// SSE is baseline on every x64 target, and on x86 when building with /arch:SSE2 or -msse2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BC_SSE 1
+#include <emmintrin.h>
+#else
+#define BC_SSE 0
+#endif
+
+namespace
+{
+	//-------------------------------------------
+	// Blocks, palettes and matching, shared by
+	// every format
+	//-------------------------------------------
+
+	// One 4x4 block of texels, in the layouts the searches use
+	struct Block {
+		int Texels[16][4]; // RGBA. Channels the format doesn't store are 0
+		alignas(16) int16_t RG[32]; // (r, g) per texel, so _mm_madd_epi16 sums r² + g² in one step
+		alignas(16) int16_t BA[32]; // (b, a) per texel
+	};
+
+	// The colors a block's indices pick from
+	struct Palette {
+		int Colors[16][4];
+		unsigned int Count = 0;
+	};
+
+	// Each texel's nearest palette entry, and its squared error
+	struct Match {
+		uint32_t Errors[16];
+		uint8_t Indices[16];
+	};
+
+	// Where each of a Block's channels comes from in the image, or -1 for none
+	const int s_rgbChannels[4] = { 0, 1, 2, -1 };
+	const int s_rgbaChannels[4] = { 0, 1, 2, 3 };
+	const int s_redChannel[4] = { 0, -1, -1, -1 };
+	const int s_greenChannel[4] = { 1, -1, -1, -1 };
+
+	void LoadBlock(const uint8_t* a_pixels, unsigned int a_width, unsigned int a_height, unsigned int a_blockX, unsigned int a_blockY,
+		const int a_channels[4], Block& a_block)
+	{
+		for (unsigned int y = 0; y < 4; y++) {
+			unsigned int sourceY = std::min(a_blockY * 4 + y, a_height - 1);
+			for (unsigned int x = 0; x < 4; x++) {
+				unsigned int sourceX = std::min(a_blockX * 4 + x, a_width - 1);
+				const uint8_t* texel = a_pixels + ((size_t)sourceY * a_width + sourceX) * 4;
+				int* out = a_block.Texels[y * 4 + x];
+				for (unsigned int c = 0; c < 4; c++) {
+					out[c] = a_channels[c] >= 0 ? texel[a_channels[c]] : 0;
+				}
+			}
+		}
+		for (unsigned int i = 0; i < 16; i++) {
+			a_block.RG[i * 2] = (int16_t)a_block.Texels[i][0];
+			a_block.RG[i * 2 + 1] = (int16_t)a_block.Texels[i][1];
+			a_block.BA[i * 2] = (int16_t)a_block.Texels[i][2];
+			a_block.BA[i * 2 + 1] = (int16_t)a_block.Texels[i][3];
+		}
+	}
+
+	uint32_t MatchPaletteScalar(const Block& a_block, const Palette& a_palette, Match& a_match)
+	{
+		uint32_t total = 0;
+		for (unsigned int i = 0; i < 16; i++) {
+			uint32_t best = std::numeric_limits<uint32_t>::max();
+			unsigned int bestIndex = 0;
+			for (unsigned int entry = 0; entry < a_palette.Count; entry++) {
+				uint32_t error = 0;
+				for (unsigned int c = 0; c < 4; c++) {
+					int difference = a_block.Texels[i][c] - a_palette.Colors[entry][c];
+					error += (uint32_t)(difference * difference);
+				}
+				if (error < best) {
+					best = error;
+					bestIndex = entry;
+				}
+			}
+			a_match.Errors[i] = best;
+			a_match.Indices[i] = (uint8_t)bestIndex;
+			total += best;
+		}
+		return total;
+	}
+
+#if BC_SSE
+	// Four texels per register. Errors are exact 32 bit sums and ties keep the lower index, as in the scalar path
+	uint32_t MatchPaletteSSE(const Block& a_block, const Palette& a_palette, Match& a_match)
+	{
+		__m128i entryRG[16];
+		__m128i entryBA[16];
+		for (unsigned int entry = 0; entry < a_palette.Count; entry++) {
+			const int* color = a_palette.Colors[entry];
+			entryRG[entry] = _mm_set1_epi32((int)((uint32_t)color[0] | ((uint32_t)color[1] << 16)));
+			entryBA[entry] = _mm_set1_epi32((int)((uint32_t)color[2] | ((uint32_t)color[3] << 16)));
+		}
+
+		__m128i total = _mm_setzero_si128();
+		for (unsigned int group = 0; group < 4; group++) {
+			__m128i rg = _mm_load_si128((const __m128i*)(a_block.RG + group * 8));
+			__m128i ba = _mm_load_si128((const __m128i*)(a_block.BA + group * 8));
+			__m128i best = _mm_set1_epi32(std::numeric_limits<int32_t>::max());
+			__m128i bestIndex = _mm_setzero_si128();
+			for (unsigned int entry = 0; entry < a_palette.Count; entry++) {
+				__m128i differenceRG = _mm_sub_epi16(rg, entryRG[entry]);
+				__m128i differenceBA = _mm_sub_epi16(ba, entryBA[entry]);
+				__m128i error = _mm_add_epi32(_mm_madd_epi16(differenceRG, differenceRG), _mm_madd_epi16(differenceBA, differenceBA));
+				__m128i closer = _mm_cmplt_epi32(error, best);
+				best = _mm_or_si128(_mm_and_si128(closer, error), _mm_andnot_si128(closer, best));
+				bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32((int)entry)), _mm_andnot_si128(closer, bestIndex));
+			}
+			_mm_storeu_si128((__m128i*)(a_match.Errors + group * 4), best);
+			alignas(16) int32_t indices[4];
+			_mm_store_si128((__m128i*)indices, bestIndex);
+			for (unsigned int i = 0; i < 4; i++) {
+				a_match.Indices[group * 4 + i] = (uint8_t)indices[i];
+			}
+			total = _mm_add_epi32(total, best);
+		}
+		total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(1, 0, 3, 2)));
+		total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(2, 3, 0, 1)));
+		return (uint32_t)_mm_cvtsi128_si32(total);
+	}
+#endif
+
+	// Match every texel to its nearest palette entry, returning the total squared error
+	uint32_t MatchPalette(const Block& a_block, const Palette& a_palette, Match& a_match, bool a_bUseSIMD)
+	{
+#if BC_SSE
+		if (a_bUseSIMD)
+			return MatchPaletteSSE(a_block, a_palette, a_match);
+#else
+		(void)a_bUseSIMD;
+#endif
+		return MatchPaletteScalar(a_block, a_palette, a_match);
+	}
+
+	uint32_t SumErrors(const Match& a_match, uint16_t a_mask)
+	{
+		uint32_t total = 0;
+		for (unsigned int i = 0; i < 16; i++) {
+			if (a_mask & (1u << i))
+				total += a_match.Errors[i];
+		}
+		return total;
+	}
+
+	//-------------------------------------------
+	// Endpoint fitting
+	//-------------------------------------------
+
+	float Clamp255(float a_value)
+	{
+		return a_value < 0.f ? 0.f : (a_value > 255.f ? 255.f : a_value);
+	}
+
+	int Round255(float a_value)
+	{
+		return (int)(Clamp255(a_value) + 0.5f);
+	}
+
+	// End points of the line through the texels in a_mask along their principal axis, over the first a_channels
+	// channels. The axis comes from power iteration on the covariance, starting from the channel that varies most
+	void FitEndpoints(const Block& a_block, uint16_t a_mask, unsigned int a_channels, float a_endpoint0[4], float a_endpoint1[4])
+	{
+		float mean[4] = {};
+		float count = 0.f;
+		for (unsigned int i = 0; i < 16; i++) {
+			if (!(a_mask & (1u << i)))
+				continue;
+			for (unsigned int c = 0; c < a_channels; c++) {
+				mean[c] += (float)a_block.Texels[i][c];
+			}
+			count += 1.f;
+		}
+		for (unsigned int c = 0; c < 4; c++) {
+			mean[c] = count > 0.f && c < a_channels ? mean[c] / count : 0.f;
+		}
+
+		float covariance[4][4] = {};
+		for (unsigned int i = 0; i < 16; i++) {
+			if (!(a_mask & (1u << i)))
+				continue;
+			float offset[4];
+			for (unsigned int c = 0; c < a_channels; c++) {
+				offset[c] = (float)a_block.Texels[i][c] - mean[c];
+			}
+			for (unsigned int row = 0; row < a_channels; row++) {
+				for (unsigned int column = 0; column < a_channels; column++) {
+					covariance[row][column] += offset[row] * offset[column];
+				}
+			}
+		}
+
+		unsigned int largest = 0;
+		for (unsigned int c = 1; c < a_channels; c++) {
+			if (covariance[c][c] > covariance[largest][largest])
+				largest = c;
+		}
+		float axis[4] = {};
+		for (unsigned int c = 0; c < a_channels; c++) {
+			axis[c] = covariance[largest][c];
+		}
+		for (unsigned int iteration = 0; iteration < 8; iteration++) {
+			float next[4] = {};
+			float scale = 0.f;
+			for (unsigned int row = 0; row < a_channels; row++) {
+				for (unsigned int column = 0; column < a_channels; column++) {
+					next[row] += covariance[row][column] * axis[column];
+				}
+				scale = std::max(scale, std::fabs(next[row]));
+			}
+			if (scale < 1e-9f)
+				break;
+			for (unsigned int c = 0; c < a_channels; c++) {
+				axis[c] = next[c] / scale;
+			}
+		}
+		float length = 0.f;
+		for (unsigned int c = 0; c < a_channels; c++) {
+			length += axis[c] * axis[c];
+		}
+		length = std::sqrt(length);
+
+		float minimum = 0.f;
+		float maximum = 0.f;
+		if (length > 1e-9f) {
+			for (unsigned int c = 0; c < a_channels; c++) {
+				axis[c] /= length;
+			}
+			minimum = std::numeric_limits<float>::max();
+			maximum = -std::numeric_limits<float>::max();
+			for (unsigned int i = 0; i < 16; i++) {
+				if (!(a_mask & (1u << i)))
+					continue;
+				float t = 0.f;
+				for (unsigned int c = 0; c < a_channels; c++) {
+					t += ((float)a_block.Texels[i][c] - mean[c]) * axis[c];
+				}
+				minimum = std::min(minimum, t);
+				maximum = std::max(maximum, t);
+			}
+		}
+		for (unsigned int c = 0; c < 4; c++) {
+			a_endpoint0[c] = Clamp255(mean[c] + axis[c] * minimum);
+			a_endpoint1[c] = Clamp255(mean[c] + axis[c] * maximum);
+		}
+	}
+
+	// Least squares endpoints for the indices in a_match, where palette entry i sits a_weights[i] of the way from
+	// endpoint 0 to endpoint 1. Fails when the texels all use the same weight
+	bool SolveEndpoints(const Block& a_block, uint16_t a_mask, const Match& a_match, const float* a_weights, unsigned int a_channels,
+		float a_endpoint0[4], float a_endpoint1[4])
+	{
+		float a = 0.f;
+		float b = 0.f;
+		float c = 0.f;
+		float toEndpoint0[4] = {};
+		float toEndpoint1[4] = {};
+		for (unsigned int i = 0; i < 16; i++) {
+			if (!(a_mask & (1u << i)))
+				continue;
+			float weight = a_weights[a_match.Indices[i]];
+			float inverse = 1.f - weight;
+			a += inverse * inverse;
+			b += inverse * weight;
+			c += weight * weight;
+			for (unsigned int channel = 0; channel < a_channels; channel++) {
+				toEndpoint0[channel] += inverse * (float)a_block.Texels[i][channel];
+				toEndpoint1[channel] += weight * (float)a_block.Texels[i][channel];
+			}
+		}
+
+		float determinant = a * c - b * b;
+		if (std::fabs(determinant) < 1e-6f)
+			return false;
+		for (unsigned int channel = 0; channel < 4; channel++) {
+			a_endpoint0[channel] = channel < a_channels ? Clamp255((c * toEndpoint0[channel] - b * toEndpoint1[channel]) / determinant) : 0.f;
+			a_endpoint1[channel] = channel < a_channels ? Clamp255((a * toEndpoint1[channel] - b * toEndpoint0[channel]) / determinant) : 0.f;
+		}
+		return true;
+	}
+
+	unsigned int GetRefinementCount(CompressionQuality a_quality)
+	{
+		return a_quality == CompressionQuality::Fast ? 0 : (a_quality == CompressionQuality::Normal ? 2 : 4);
+	}
+
+	//-------------------------------------------
+	// Bit packing, least significant bit first
+	//-------------------------------------------
+
+	struct BitWriter {
+		uint8_t* Output; // Must start zeroed
+		unsigned int Position = 0;
+
+		void Write(uint32_t a_value, unsigned int a_count)
+		{
+			for (unsigned int i = 0; i < a_count; i++, Position++) {
+				if ((a_value >> i) & 1u)
+					Output[Position >> 3] |= (uint8_t)(1u << (Position & 7));
+			}
+		}
+	};
+
+	struct BitReader {
+		const uint8_t* Input;
+		unsigned int Position = 0;
+
+		uint32_t Read(unsigned int a_count)
+		{
+			uint32_t value = 0;
+			for (unsigned int i = 0; i < a_count; i++, Position++) {
+				value |= (uint32_t)((Input[Position >> 3] >> (Position & 7)) & 1u) << i;
+			}
+			return value;
+		}
+	};
+
+	//-------------------------------------------
+	// BC1
+	//-------------------------------------------
+
+	struct BC1Tables {
+		int Expand5[32];
+		int Expand6[64];
+		uint8_t Nearest5[256]; // Closest 5 and 6 bit values to each 8 bit one
+		uint8_t Nearest6[256];
+		uint8_t Solid5[256][2]; // Endpoints whose 2/3 palette entry comes closest to each 8 bit value
+		uint8_t Solid6[256][2];
+
+		BC1Tables()
+		{
+			for (int i = 0; i < 32; i++) {
+				Expand5[i] = (i << 3) | (i >> 2);
+			}
+			for (int i = 0; i < 64; i++) {
+				Expand6[i] = (i << 2) | (i >> 4);
+			}
+			Build(Expand5, 32, Nearest5, Solid5);
+			Build(Expand6, 64, Nearest6, Solid6);
+		}
+
+		static void Build(const int* a_expand, int a_count, uint8_t* a_nearest, uint8_t (*a_solid)[2])
+		{
+			for (int value = 0; value < 256; value++) {
+				int bestError = 256;
+				for (int i = 0; i < a_count; i++) {
+					if (std::abs(a_expand[i] - value) < bestError) {
+						bestError = std::abs(a_expand[i] - value);
+						a_nearest[value] = (uint8_t)i;
+					}
+				}
+
+				// Least error first, then the closest pair of endpoints
+				int bestSpread = 256;
+				bestError = 256;
+				for (int high = 0; high < a_count; high++) {
+					for (int low = 0; low < a_count; low++) {
+						int error = std::abs((2 * a_expand[high] + a_expand[low]) / 3 - value);
+						int spread = std::abs(a_expand[high] - a_expand[low]);
+						if (error < bestError || (error == bestError && spread < bestSpread)) {
+							bestError = error;
+							bestSpread = spread;
+							a_solid[value][0] = (uint8_t)high;
+							a_solid[value][1] = (uint8_t)low;
+						}
+					}
+				}
+			}
+		}
+	};
+
+	const BC1Tables& GetBC1Tables()
+	{
+		static const BC1Tables s_tables;
+		return s_tables;
+	}
+
+	uint16_t PackBC1(const int a_color[3])
+	{
+		return (uint16_t)((a_color[0] << 11) | (a_color[1] << 5) | a_color[2]);
+	}
+
+	void BuildBC1Palette(uint16_t a_color0, uint16_t a_color1, Palette& a_palette)
+	{
+		const BC1Tables& tables = GetBC1Tables();
+		int* color0 = a_palette.Colors[0];
+		int* color1 = a_palette.Colors[1];
+		color0[0] = tables.Expand5[a_color0 >> 11];
+		color0[1] = tables.Expand6[(a_color0 >> 5) & 63];
+		color0[2] = tables.Expand5[a_color0 & 31];
+		color1[0] = tables.Expand5[a_color1 >> 11];
+		color1[1] = tables.Expand6[(a_color1 >> 5) & 63];
+		color1[2] = tables.Expand5[a_color1 & 31];
+		color0[3] = color1[3] = 0;
+
+		if (a_color0 > a_color1) {
+			for (unsigned int c = 0; c < 4; c++) {
+				a_palette.Colors[2][c] = (2 * color0[c] + color1[c]) / 3;
+				a_palette.Colors[3][c] = (color0[c] + 2 * color1[c]) / 3;
+			}
+			a_palette.Count = 4;
+		}
+		else {
+			// 3 color mode. Index 3 is transparent black, which opaque blocks never use
+			for (unsigned int c = 0; c < 4; c++) {
+				a_palette.Colors[2][c] = (color0[c] + color1[c]) / 2;
+			}
+			a_palette.Count = 3;
+		}
+	}
+
+	// Put a candidate in 4 color order and match the block against it
+	uint32_t EvaluateBC1(const Block& a_block, const int a_endpoints[2][3], bool a_bUseSIMD, Match& a_match, uint16_t& a_color0, uint16_t& a_color1)
+	{
+		a_color0 = PackBC1(a_endpoints[0]);
+		a_color1 = PackBC1(a_endpoints[1]);
+		if (a_color0 < a_color1)
+			std::swap(a_color0, a_color1);
+		Palette palette;
+		BuildBC1Palette(a_color0, a_color1, palette);
+		if (a_color0 == a_color1)
+			palette.Count = 1; // Every index has to be 0, as 3 color mode's index 3 would be transparent
+		return MatchPalette(a_block, palette, a_match, a_bUseSIMD);
+	}
+
+	void QuantizeBC1(const float a_endpoint[4], int a_output[3])
+	{
+		const BC1Tables& tables = GetBC1Tables();
+		a_output[0] = tables.Nearest5[Round255(a_endpoint[0])];
+		a_output[1] = tables.Nearest6[Round255(a_endpoint[1])];
+		a_output[2] = tables.Nearest5[Round255(a_endpoint[2])];
+	}
+
+	void EncodeBC1(const Block& a_block, CompressionQuality a_quality, bool a_bUseSIMD, uint8_t* a_output)
+	{
+		static const float s_weights[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+		const BC1Tables& tables = GetBC1Tables();
+
+		int endpoints[2][3];
+		bool bSolid = true;
+		for (unsigned int i = 1; i < 16 && bSolid; i++) {
+			bSolid = std::memcmp(a_block.Texels[i], a_block.Texels[0], sizeof(a_block.Texels[0])) == 0;
+		}
+		if (bSolid) {
+			// Solid blocks use the endpoint pair whose 2/3 entry is closest, beating any single 565 color
+			const int* color = a_block.Texels[0];
+			for (unsigned int e = 0; e < 2; e++) {
+				endpoints[e][0] = tables.Solid5[color[0]][e];
+				endpoints[e][1] = tables.Solid6[color[1]][e];
+				endpoints[e][2] = tables.Solid5[color[2]][e];
+			}
+		}
+		else {
+			float endpoint0[4];
+			float endpoint1[4];
+			FitEndpoints(a_block, 0xFFFF, 3, endpoint0, endpoint1);
+			QuantizeBC1(endpoint1, endpoints[0]);
+			QuantizeBC1(endpoint0, endpoints[1]);
+		}
+
+		Match match;
+		uint16_t color0;
+		uint16_t color1;
+		uint32_t error = EvaluateBC1(a_block, endpoints, a_bUseSIMD, match, color0, color1);
+
+		unsigned int refinements = bSolid ? 0 : GetRefinementCount(a_quality);
+		for (unsigned int pass = 0; pass < refinements && error > 0; pass++) {
+			float endpoint0[4];
+			float endpoint1[4];
+			if (!SolveEndpoints(a_block, 0xFFFF, match, s_weights, 3, endpoint0, endpoint1))
+				break;
+			int candidate[2][3];
+			QuantizeBC1(endpoint0, candidate[0]);
+			QuantizeBC1(endpoint1, candidate[1]);
+			Match candidateMatch;
+			uint16_t candidate0;
+			uint16_t candidate1;
+			uint32_t candidateError = EvaluateBC1(a_block, candidate, a_bUseSIMD, candidateMatch, candidate0, candidate1);
+			if (candidateError >= error)
+				break;
+			std::memcpy(endpoints, candidate, sizeof(endpoints));
+			match = candidateMatch;
+			color0 = candidate0;
+			color1 = candidate1;
+			error = candidateError;
+		}
+
+		// Nudge each endpoint channel a step either way while that keeps helping
+		if (a_quality == CompressionQuality::High && !bSolid) {
+			static const int s_limits[3] = { 31, 63, 31 };
+			bool bImproved = true;
+			for (unsigned int pass = 0; pass < 8 && bImproved && error > 0; pass++) {
+				bImproved = false;
+				for (unsigned int step = 0; step < 12; step++) {
+					int candidate[2][3];
+					std::memcpy(candidate, endpoints, sizeof(candidate));
+					int& value = candidate[step / 6][(step / 2) % 3];
+					value += (step & 1) ? 1 : -1;
+					if (value < 0 || value > s_limits[(step / 2) % 3])
+						continue;
+					Match candidateMatch;
+					uint16_t candidate0;
+					uint16_t candidate1;
+					uint32_t candidateError = EvaluateBC1(a_block, candidate, a_bUseSIMD, candidateMatch, candidate0, candidate1);
+					if (candidateError < error) {
+						std::memcpy(endpoints, candidate, sizeof(endpoints));
+						match = candidateMatch;
+						color0 = candidate0;
+						color1 = candidate1;
+						error = candidateError;
+						bImproved = true;
+					}
+				}
+			}
+		}
+
+		uint32_t indices = 0;
+		for (unsigned int i = 0; i < 16; i++) {
+			indices |= (uint32_t)match.Indices[i] << (i * 2);
+		}
+		a_output[0] = (uint8_t)(color0 & 0xFF);
+		a_output[1] = (uint8_t)(color0 >> 8);
+		a_output[2] = (uint8_t)(color1 & 0xFF);
+		a_output[3] = (uint8_t)(color1 >> 8);
+		for (unsigned int i = 0; i < 4; i++) {
+			a_output[4 + i] = (uint8_t)(indices >> (i * 8));
+		}
+	}
+
+	//-------------------------------------------
+	// BC4, with BC5 as two of them
+	//-------------------------------------------
+
+	// Red only. Red 0 > red 1 selects 6 interpolated values between them, otherwise 4 plus 0 and 255
+	void BuildBC4Palette(int a_red0, int a_red1, Palette& a_palette)
+	{
+		std::memset(a_palette.Colors, 0, sizeof(a_palette.Colors));
+		a_palette.Colors[0][0] = a_red0;
+		a_palette.Colors[1][0] = a_red1;
+		if (a_red0 > a_red1) {
+			for (int i = 1; i <= 6; i++) {
+				a_palette.Colors[i + 1][0] = ((7 - i) * a_red0 + i * a_red1) / 7;
+			}
+		}
+		else {
+			for (int i = 1; i <= 4; i++) {
+				a_palette.Colors[i + 1][0] = ((5 - i) * a_red0 + i * a_red1) / 5;
+			}
+			a_palette.Colors[6][0] = 0;
+			a_palette.Colors[7][0] = 255;
+		}
+		a_palette.Count = 8;
+	}
+
+	uint32_t EvaluateBC4(const Block& a_block, int a_red0, int a_red1, bool a_bUseSIMD, Match& a_match)
+	{
+		Palette palette;
+		BuildBC4Palette(a_red0, a_red1, palette);
+		return MatchPalette(a_block, palette, a_match, a_bUseSIMD);
+	}
+
+	// Encodes the block's red channel
+	void EncodeBC4(const Block& a_block, CompressionQuality a_quality, bool a_bUseSIMD, uint8_t* a_output)
+	{
+		static const float s_weights[8] = { 0.f, 1.f, 1.f / 7.f, 2.f / 7.f, 3.f / 7.f, 4.f / 7.f, 5.f / 7.f, 6.f / 7.f };
+
+		int minimum = 255;
+		int maximum = 0;
+		for (unsigned int i = 0; i < 16; i++) {
+			minimum = std::min(minimum, a_block.Texels[i][0]);
+			maximum = std::max(maximum, a_block.Texels[i][0]);
+		}
+
+		int red0 = maximum;
+		int red1 = minimum;
+		Match match;
+		uint32_t error = EvaluateBC4(a_block, red0, red1, a_bUseSIMD, match);
+
+		if (a_quality != CompressionQuality::Fast && error > 0) {
+			// Refine the end points of the fully interpolated mode
+			for (unsigned int pass = 0; pass < GetRefinementCount(a_quality) && red0 > red1; pass++) {
+				float endpoint0[4];
+				float endpoint1[4];
+				if (!SolveEndpoints(a_block, 0xFFFF, match, s_weights, 1, endpoint0, endpoint1))
+					break;
+				int candidate0 = std::max(Round255(endpoint0[0]), Round255(endpoint1[0]));
+				int candidate1 = std::min(Round255(endpoint0[0]), Round255(endpoint1[0]));
+				if (candidate0 == candidate1)
+					break;
+				Match candidateMatch;
+				uint32_t candidateError = EvaluateBC4(a_block, candidate0, candidate1, a_bUseSIMD, candidateMatch);
+				if (candidateError >= error)
+					break;
+				red0 = candidate0;
+				red1 = candidate1;
+				match = candidateMatch;
+				error = candidateError;
+			}
+
+			// Blocks touching 0 or 255 can get those exactly and spend the interpolated values on the rest
+			if (minimum == 0 || maximum == 255) {
+				int innerMinimum = 255;
+				int innerMaximum = 0;
+				for (unsigned int i = 0; i < 16; i++) {
+					int value = a_block.Texels[i][0];
+					if (value != 0 && value != 255) {
+						innerMinimum = std::min(innerMinimum, value);
+						innerMaximum = std::max(innerMaximum, value);
+					}
+				}
+				if (innerMinimum > innerMaximum)
+					innerMinimum = innerMaximum = 0; // Nothing but 0 and 255
+				Match candidateMatch;
+				uint32_t candidateError = EvaluateBC4(a_block, innerMinimum, innerMaximum, a_bUseSIMD, candidateMatch);
+				if (candidateError < error) {
+					red0 = innerMinimum;
+					red1 = innerMaximum;
+					match = candidateMatch;
+					error = candidateError;
+				}
+			}
+		}
+
+		// Nudge the end points, staying in the same mode
+		if (a_quality == CompressionQuality::High) {
+			bool bInterpolatedOnly = red0 > red1;
+			bool bImproved = true;
+			for (unsigned int pass = 0; pass < 8 && bImproved && error > 0; pass++) {
+				bImproved = false;
+				for (unsigned int step = 0; step < 4; step++) {
+					int candidate0 = red0 + (step == 0 ? -1 : step == 1 ? 1 : 0);
+					int candidate1 = red1 + (step == 2 ? -1 : step == 3 ? 1 : 0);
+					if (candidate0 < 0 || candidate0 > 255 || candidate1 < 0 || candidate1 > 255 || (candidate0 > candidate1) != bInterpolatedOnly)
+						continue;
+					Match candidateMatch;
+					uint32_t candidateError = EvaluateBC4(a_block, candidate0, candidate1, a_bUseSIMD, candidateMatch);
+					if (candidateError < error) {
+						red0 = candidate0;
+						red1 = candidate1;
+						match = candidateMatch;
+						error = candidateError;
+						bImproved = true;
+					}
+				}
+			}
+		}
+
+		std::memset(a_output, 0, 8);
+		a_output[0] = (uint8_t)red0;
+		a_output[1] = (uint8_t)red1;
+		BitWriter writer{ a_output + 2 };
+		for (unsigned int i = 0; i < 16; i++) {
+			writer.Write(match.Indices[i], 3);
+		}
+	}
+
+	//-------------------------------------------
+	// BC7 modes 6 and 1
+	//-------------------------------------------
+
+	const int s_bc7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+	const int s_bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Two subset partitions. Bit i is set when texel i belongs to subset 1
+	const uint16_t s_bc7Partitions2[64] = {
+		0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+		0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+		0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+		0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+		0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+		0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+		0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+		0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+	};
+
+	// The texel whose index drops its top bit in subset 1 of each partition. Subset 0's is always texel 0
+	const uint8_t s_bc7Anchors2[64] = {
+		15, 15, 15, 15, 15, 15, 15, 15,
+		15, 15, 15, 15, 15, 15, 15, 15,
+		15, 2, 8, 2, 2, 8, 8, 15,
+		2, 8, 2, 2, 8, 8, 2, 2,
+		15, 15, 6, 8, 2, 8, 15, 15,
+		2, 8, 2, 2, 2, 15, 15, 6,
+		6, 2, 6, 8, 15, 15, 2, 2,
+		15, 15, 15, 15, 15, 2, 2, 15
+	};
+
+	// Mode 6: one subset, 7 bit RGBA end points plus a p-bit each, 4 bit indices
+	struct BC7Mode6 {
+		int Endpoints[2][4];
+		int PBits[2];
+	};
+
+	// Mode 1: two subsets, 6 bit RGB end points plus a p-bit shared per subset, 3 bit indices
+	struct BC7Mode1 {
+		unsigned int Partition;
+		int Endpoints[2][2][3]; // [subset][endpoint][channel]
+		int PBits[2];
+	};
+
+	int ExpandMode1(int a_value, int a_pBit)
+	{
+		int value = (a_value << 1) | a_pBit;
+		return (value << 1) | (value >> 6);
+	}
+
+	struct BC7Tables {
+		uint8_t NearestMode1[2][256]; // Closest 6 bit value to each 8 bit one, per p-bit
+
+		BC7Tables()
+		{
+			for (int pBit = 0; pBit < 2; pBit++) {
+				for (int value = 0; value < 256; value++) {
+					int bestError = 256;
+					for (int i = 0; i < 64; i++) {
+						int error = std::abs(ExpandMode1(i, pBit) - value);
+						if (error < bestError) {
+							bestError = error;
+							NearestMode1[pBit][value] = (uint8_t)i;
+						}
+					}
+				}
+			}
+		}
+	};
+
+	const BC7Tables& GetBC7Tables()
+	{
+		static const BC7Tables s_tables;
+		return s_tables;
+	}
+
+	void BuildInterpolatedPalette(const int a_endpoint0[4], const int a_endpoint1[4], const int* a_weights, unsigned int a_count, Palette& a_palette)
+	{
+		for (unsigned int i = 0; i < a_count; i++) {
+			for (unsigned int c = 0; c < 4; c++) {
+				a_palette.Colors[i][c] = ((64 - a_weights[i]) * a_endpoint0[c] + a_weights[i] * a_endpoint1[c] + 32) >> 6;
+			}
+		}
+		a_palette.Count = a_count;
+	}
+
+	void BuildMode6Palette(const BC7Mode6& a_mode, Palette& a_palette)
+	{
+		int endpoints[2][4];
+		for (unsigned int e = 0; e < 2; e++) {
+			for (unsigned int c = 0; c < 4; c++) {
+				endpoints[e][c] = (a_mode.Endpoints[e][c] << 1) | a_mode.PBits[e];
+			}
+		}
+		BuildInterpolatedPalette(endpoints[0], endpoints[1], s_bc7Weights4, 16, a_palette);
+	}
+
+	void BuildMode1Palette(const int a_endpoints[2][3], int a_pBit, Palette& a_palette)
+	{
+		int endpoints[2][4];
+		for (unsigned int e = 0; e < 2; e++) {
+			for (unsigned int c = 0; c < 3; c++) {
+				endpoints[e][c] = ExpandMode1(a_endpoints[e][c], a_pBit);
+			}
+			endpoints[e][3] = 255;
+		}
+		BuildInterpolatedPalette(endpoints[0], endpoints[1], s_bc7Weights3, 8, a_palette);
+	}
+
+	// 7 bit values for one end point with a given p-bit, returning the squared error
+	float QuantizeMode6(const float a_endpoint[4], int a_pBit, int a_output[4])
+	{
+		float error = 0.f;
+		for (unsigned int c = 0; c < 4; c++) {
+			int value = (int)std::floor((a_endpoint[c] - (float)a_pBit) * 0.5f + 0.5f);
+			a_output[c] = std::min(std::max(value, 0), 127);
+			float difference = (float)((a_output[c] << 1) | a_pBit) - a_endpoint[c];
+			error += difference * difference;
+		}
+		return error;
+	}
+
+	uint32_t EvaluateMode6(const Block& a_block, const BC7Mode6& a_mode, bool a_bUseSIMD, Match& a_match)
+	{
+		Palette palette;
+		BuildMode6Palette(a_mode, palette);
+		return MatchPalette(a_block, palette, a_match, a_bUseSIMD);
+	}
+
+	// Quantize float end points, picking each p-bit on its own, or (a_bAllPBits) by trying all four combinations
+	uint32_t QuantizeAndEvaluateMode6(const Block& a_block, const float a_endpoints[2][4], bool a_bAllPBits, bool a_bUseSIMD,
+		BC7Mode6& a_mode, Match& a_match)
+	{
+		if (!a_bAllPBits) {
+			for (unsigned int e = 0; e < 2; e++) {
+				int withZero[4];
+				int withOne[4];
+				bool bOne = QuantizeMode6(a_endpoints[e], 1, withOne) < QuantizeMode6(a_endpoints[e], 0, withZero);
+				std::memcpy(a_mode.Endpoints[e], bOne ? withOne : withZero, sizeof(withOne));
+				a_mode.PBits[e] = bOne ? 1 : 0;
+			}
+			return EvaluateMode6(a_block, a_mode, a_bUseSIMD, a_match);
+		}
+
+		uint32_t bestError = std::numeric_limits<uint32_t>::max();
+		for (int combination = 0; combination < 4; combination++) {
+			BC7Mode6 candidate;
+			candidate.PBits[0] = combination & 1;
+			candidate.PBits[1] = combination >> 1;
+			QuantizeMode6(a_endpoints[0], candidate.PBits[0], candidate.Endpoints[0]);
+			QuantizeMode6(a_endpoints[1], candidate.PBits[1], candidate.Endpoints[1]);
+			Match candidateMatch;
+			uint32_t error = EvaluateMode6(a_block, candidate, a_bUseSIMD, candidateMatch);
+			if (error < bestError) {
+				bestError = error;
+				a_mode = candidate;
+				a_match = candidateMatch;
+			}
+		}
+		return bestError;
+	}
+
+	uint32_t SearchMode6(const Block& a_block, CompressionQuality a_quality, bool a_bUseSIMD, BC7Mode6& a_mode, Match& a_match)
+	{
+		static const float s_weights[16] = {
+			0.f / 64.f, 4.f / 64.f, 9.f / 64.f, 13.f / 64.f, 17.f / 64.f, 21.f / 64.f, 26.f / 64.f, 30.f / 64.f,
+			34.f / 64.f, 38.f / 64.f, 43.f / 64.f, 47.f / 64.f, 51.f / 64.f, 55.f / 64.f, 60.f / 64.f, 64.f / 64.f
+		};
+		bool bAllPBits = a_quality == CompressionQuality::High;
+
+		float endpoints[2][4];
+		FitEndpoints(a_block, 0xFFFF, 4, endpoints[0], endpoints[1]);
+		uint32_t error = QuantizeAndEvaluateMode6(a_block, endpoints, bAllPBits, a_bUseSIMD, a_mode, a_match);
+
+		unsigned int refinements = GetRefinementCount(a_quality) + 1;
+		for (unsigned int pass = 0; pass < refinements && error > 0; pass++) {
+			if (!SolveEndpoints(a_block, 0xFFFF, a_match, s_weights, 4, endpoints[0], endpoints[1]))
+				break;
+			BC7Mode6 candidate;
+			Match candidateMatch;
+			uint32_t candidateError = QuantizeAndEvaluateMode6(a_block, endpoints, bAllPBits, a_bUseSIMD, candidate, candidateMatch);
+			if (candidateError >= error)
+				break;
+			a_mode = candidate;
+			a_match = candidateMatch;
+			error = candidateError;
+		}
+
+		if (a_quality == CompressionQuality::High) {
+			bool bImproved = true;
+			for (unsigned int pass = 0; pass < 8 && bImproved && error > 0; pass++) {
+				bImproved = false;
+				for (unsigned int step = 0; step < 16; step++) {
+					BC7Mode6 candidate = a_mode;
+					int& value = candidate.Endpoints[step / 8][(step / 2) % 4];
+					value += (step & 1) ? 1 : -1;
+					if (value < 0 || value > 127)
+						continue;
+					Match candidateMatch;
+					uint32_t candidateError = EvaluateMode6(a_block, candidate, a_bUseSIMD, candidateMatch);
+					if (candidateError < error) {
+						a_mode = candidate;
+						a_match = candidateMatch;
+						error = candidateError;
+						bImproved = true;
+					}
+				}
+			}
+		}
+		return error;
+	}
+
+	// Squared distance of a subset's texels from the line through them, before any quantization
+	float EstimateSubsetError(const float a_sums[3], const float a_products[6], float a_count)
+	{
+		if (a_count < 2.f)
+			return 0.f;
+		// a_products holds xx, xy, xz, yy, yz, zz
+		float xy = a_products[1] - a_sums[0] * a_sums[1] / a_count;
+		float xz = a_products[2] - a_sums[0] * a_sums[2] / a_count;
+		float yz = a_products[4] - a_sums[1] * a_sums[2] / a_count;
+		float covariance[3][3] = {
+			{ a_products[0] - a_sums[0] * a_sums[0] / a_count, xy, xz },
+			{ xy, a_products[3] - a_sums[1] * a_sums[1] / a_count, yz },
+			{ xz, yz, a_products[5] - a_sums[2] * a_sums[2] / a_count }
+		};
+		float trace = covariance[0][0] + covariance[1][1] + covariance[2][2];
+
+		// The variance along the principal axis, estimated by the Rayleigh quotient of the covariance's row with the
+		// largest diagonal (one power iteration from that channel's axis). Ranking partitions needs no better
+		unsigned int largest = covariance[0][0] >= covariance[1][1] ? 0 : 1;
+		largest = covariance[largest][largest] >= covariance[2][2] ? largest : 2;
+		const float* axis = covariance[largest];
+		float lengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+		if (lengthSquared < 1e-9f)
+			return trace;
+		float alongAxis = 0.f;
+		for (unsigned int row = 0; row < 3; row++) {
+			alongAxis += axis[row] * (covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2]);
+		}
+		return std::max(trace - alongAxis / lengthSquared, 0.f);
+	}
+
+	// Fit one subset of mode 1, trying both shared p-bits. Returns the subset's error
+	uint32_t FitMode1Subset(const Block& a_block, uint16_t a_mask, CompressionQuality a_quality, bool a_bUseSIMD,
+		int a_endpoints[2][3], int& a_pBit, Match& a_match)
+	{
+		static const float s_weights[8] = { 0.f / 64.f, 9.f / 64.f, 18.f / 64.f, 27.f / 64.f, 37.f / 64.f, 46.f / 64.f, 55.f / 64.f, 64.f / 64.f };
+		const BC7Tables& tables = GetBC7Tables();
+
+		float endpoints[2][4];
+		FitEndpoints(a_block, a_mask, 3, endpoints[0], endpoints[1]);
+		uint32_t error = std::numeric_limits<uint32_t>::max();
+		for (unsigned int pass = 0; pass <= GetRefinementCount(a_quality) / 2; pass++) {
+			if (pass > 0 && !SolveEndpoints(a_block, a_mask, a_match, s_weights, 3, endpoints[0], endpoints[1]))
+				break;
+			bool bImproved = false;
+			for (int pBit = 0; pBit < 2; pBit++) {
+				int candidate[2][3];
+				for (unsigned int e = 0; e < 2; e++) {
+					for (unsigned int c = 0; c < 3; c++) {
+						candidate[e][c] = tables.NearestMode1[pBit][Round255(endpoints[e][c])];
+					}
+				}
+				Palette palette;
+				BuildMode1Palette(candidate, pBit, palette);
+				Match candidateMatch;
+				MatchPalette(a_block, palette, candidateMatch, a_bUseSIMD);
+				uint32_t candidateError = SumErrors(candidateMatch, a_mask);
+				if (candidateError < error) {
+					std::memcpy(a_endpoints, candidate, sizeof(candidate));
+					a_pBit = pBit;
+					a_match = candidateMatch;
+					error = candidateError;
+					bImproved = true;
+				}
+			}
+			if (!bImproved || error == 0)
+				break;
+		}
+		return error;
+	}
+
+	uint32_t SearchMode1(const Block& a_block, CompressionQuality a_quality, bool a_bUseSIMD, BC7Mode1& a_mode, Match& a_match)
+	{
+		// Rank every partition by how well a line fits each subset, using sums built once per texel
+		float texelSums[16][3];
+		float texelProducts[16][6];
+		float totalSums[3] = {};
+		float totalProducts[6] = {};
+		for (unsigned int i = 0; i < 16; i++) {
+			float r = (float)a_block.Texels[i][0];
+			float g = (float)a_block.Texels[i][1];
+			float b = (float)a_block.Texels[i][2];
+			float sums[3] = { r, g, b };
+			float products[6] = { r * r, r * g, r * b, g * g, g * b, b * b };
+			for (unsigned int c = 0; c < 3; c++) {
+				texelSums[i][c] = sums[c];
+				totalSums[c] += sums[c];
+			}
+			for (unsigned int c = 0; c < 6; c++) {
+				texelProducts[i][c] = products[c];
+				totalProducts[c] += products[c];
+			}
+		}
+
+		std::pair<float, unsigned int> ranking[64];
+		for (unsigned int partition = 0; partition < 64; partition++) {
+			float sums[3] = {};
+			float products[6] = {};
+			float count = 0.f;
+			for (unsigned int i = 0; i < 16; i++) {
+				if (s_bc7Partitions2[partition] & (1u << i)) {
+					for (unsigned int c = 0; c < 3; c++) {
+						sums[c] += texelSums[i][c];
+					}
+					for (unsigned int c = 0; c < 6; c++) {
+						products[c] += texelProducts[i][c];
+					}
+					count += 1.f;
+				}
+			}
+			float otherSums[3];
+			float otherProducts[6];
+			for (unsigned int c = 0; c < 3; c++) {
+				otherSums[c] = totalSums[c] - sums[c];
+			}
+			for (unsigned int c = 0; c < 6; c++) {
+				otherProducts[c] = totalProducts[c] - products[c];
+			}
+			ranking[partition] = { EstimateSubsetError(sums, products, count) + EstimateSubsetError(otherSums, otherProducts, 16.f - count), partition };
+		}
+		unsigned int candidates = a_quality == CompressionQuality::High ? 8 : 2;
+		std::partial_sort(ranking, ranking + candidates, ranking + 64);
+
+		uint32_t bestError = std::numeric_limits<uint32_t>::max();
+		for (unsigned int candidate = 0; candidate < candidates; candidate++) {
+			BC7Mode1 mode;
+			mode.Partition = ranking[candidate].second;
+			uint16_t subsetMasks[2] = { (uint16_t)~s_bc7Partitions2[mode.Partition], s_bc7Partitions2[mode.Partition] };
+			Match subsetMatches[2];
+			uint32_t error = 0;
+			for (unsigned int subset = 0; subset < 2 && error < bestError; subset++) {
+				error += FitMode1Subset(a_block, subsetMasks[subset], a_quality, a_bUseSIMD, mode.Endpoints[subset], mode.PBits[subset], subsetMatches[subset]);
+			}
+			if (error < bestError) {
+				bestError = error;
+				a_mode = mode;
+				for (unsigned int i = 0; i < 16; i++) {
+					const Match& subsetMatch = subsetMatches[(subsetMasks[1] >> i) & 1u];
+					a_match.Errors[i] = subsetMatch.Errors[i];
+					a_match.Indices[i] = subsetMatch.Indices[i];
+				}
+			}
+		}
+		return bestError;
+	}
+
+	void WriteMode6(BC7Mode6 a_mode, Match& a_match, uint8_t* a_output)
+	{
+		// Texel 0's index is stored without its top bit, so it has to be below 8. Swapping the ends gets there
+		if (a_match.Indices[0] >= 8) {
+			std::swap(a_mode.Endpoints[0], a_mode.Endpoints[1]);
+			std::swap(a_mode.PBits[0], a_mode.PBits[1]);
+			for (unsigned int i = 0; i < 16; i++) {
+				a_match.Indices[i] = (uint8_t)(15 - a_match.Indices[i]);
+			}
+		}
+
+		std::memset(a_output, 0, 16);
+		BitWriter writer{ a_output };
+		writer.Write(1u << 6, 7);
+		for (unsigned int c = 0; c < 4; c++) {
+			writer.Write((uint32_t)a_mode.Endpoints[0][c], 7);
+			writer.Write((uint32_t)a_mode.Endpoints[1][c], 7);
+		}
+		writer.Write((uint32_t)a_mode.PBits[0], 1);
+		writer.Write((uint32_t)a_mode.PBits[1], 1);
+		for (unsigned int i = 0; i < 16; i++) {
+			writer.Write(a_match.Indices[i], i == 0 ? 3 : 4);
+		}
+	}
+
+	void WriteMode1(BC7Mode1 a_mode, Match& a_match, uint8_t* a_output)
+	{
+		uint16_t partition = s_bc7Partitions2[a_mode.Partition];
+		unsigned int anchors[2] = { 0, s_bc7Anchors2[a_mode.Partition] };
+		for (unsigned int subset = 0; subset < 2; subset++) {
+			if (a_match.Indices[anchors[subset]] < 4)
+				continue;
+			std::swap(a_mode.Endpoints[subset][0], a_mode.Endpoints[subset][1]);
+			for (unsigned int i = 0; i < 16; i++) {
+				if (((partition >> i) & 1u) == subset)
+					a_match.Indices[i] = (uint8_t)(7 - a_match.Indices[i]);
+			}
+		}
+
+		std::memset(a_output, 0, 16);
+		BitWriter writer{ a_output };
+		writer.Write(1u << 1, 2);
+		writer.Write(a_mode.Partition, 6);
+		for (unsigned int c = 0; c < 3; c++) {
+			for (unsigned int subset = 0; subset < 2; subset++) {
+				writer.Write((uint32_t)a_mode.Endpoints[subset][0][c], 6);
+				writer.Write((uint32_t)a_mode.Endpoints[subset][1][c], 6);
+			}
+		}
+		writer.Write((uint32_t)a_mode.PBits[0], 1);
+		writer.Write((uint32_t)a_mode.PBits[1], 1);
+		for (unsigned int i = 0; i < 16; i++) {
+			writer.Write(a_match.Indices[i], (i == anchors[0] || i == anchors[1]) ? 2 : 3);
+		}
+	}
+
+	void EncodeBC7(const Block& a_block, CompressionQuality a_quality, bool a_bUseSIMD, uint8_t* a_output)
+	{
+		BC7Mode6 mode6;
+		Match match6;
+		uint32_t error6 = SearchMode6(a_block, a_quality, a_bUseSIMD, mode6, match6);
+
+		// Mode 1 has no alpha, so it's only an option for opaque blocks
+		bool bOpaque = true;
+		for (unsigned int i = 0; i < 16 && bOpaque; i++) {
+			bOpaque = a_block.Texels[i][3] == 255;
+		}
+		if (a_quality != CompressionQuality::Fast && bOpaque && error6 > 0) {
+			BC7Mode1 mode1;
+			Match match1;
+			if (SearchMode1(a_block, a_quality, a_bUseSIMD, mode1, match1) < error6) {
+				WriteMode1(mode1, match1, a_output);
+				return;
+			}
+		}
+		WriteMode6(mode6, match6, a_output);
+	}
+
+	//-------------------------------------------
+	// Decoding
+	//-------------------------------------------
+
+	void DecodeBC1(const uint8_t* a_block, uint8_t a_texels[16][4])
+	{
+		uint16_t color0 = (uint16_t)(a_block[0] | (a_block[1] << 8));
+		uint16_t color1 = (uint16_t)(a_block[2] | (a_block[3] << 8));
+		Palette palette;
+		BuildBC1Palette(color0, color1, palette);
+		for (unsigned int i = 0; i < 16; i++) {
+			unsigned int index = (a_block[4 + i / 4] >> ((i % 4) * 2)) & 3u;
+			bool bTransparent = index >= palette.Count;
+			for (unsigned int c = 0; c < 3; c++) {
+				a_texels[i][c] = bTransparent ? 0 : (uint8_t)palette.Colors[index][c];
+			}
+			a_texels[i][3] = bTransparent ? 0 : 255;
+		}
+	}
+
+	void DecodeBC4(const uint8_t* a_block, uint8_t a_texels[16][4], unsigned int a_channel)
+	{
+		Palette palette;
+		BuildBC4Palette(a_block[0], a_block[1], palette);
+		BitReader reader{ a_block + 2 };
+		for (unsigned int i = 0; i < 16; i++) {
+			a_texels[i][a_channel] = (uint8_t)palette.Colors[reader.Read(3)][0];
+		}
+	}
+
+	void DecodeBC7(const uint8_t* a_block, uint8_t a_texels[16][4])
+	{
+		BitReader reader{ a_block };
+		unsigned int mode = 0;
+		while (mode < 8 && reader.Read(1) == 0) {
+			mode++;
+		}
+
+		if (mode == 6) {
+			BC7Mode6 mode6;
+			for (unsigned int c = 0; c < 4; c++) {
+				mode6.Endpoints[0][c] = (int)reader.Read(7);
+				mode6.Endpoints[1][c] = (int)reader.Read(7);
+			}
+			mode6.PBits[0] = (int)reader.Read(1);
+			mode6.PBits[1] = (int)reader.Read(1);
+			Palette palette;
+			BuildMode6Palette(mode6, palette);
+			for (unsigned int i = 0; i < 16; i++) {
+				const int* color = palette.Colors[reader.Read(i == 0 ? 3 : 4)];
+				for (unsigned int c = 0; c < 4; c++) {
+					a_texels[i][c] = (uint8_t)color[c];
+				}
+			}
+		}
+		else if (mode == 1) {
+			BC7Mode1 mode1;
+			mode1.Partition = reader.Read(6);
+			for (unsigned int c = 0; c < 3; c++) {
+				for (unsigned int subset = 0; subset < 2; subset++) {
+					mode1.Endpoints[subset][0][c] = (int)reader.Read(6);
+					mode1.Endpoints[subset][1][c] = (int)reader.Read(6);
+				}
+			}
+			mode1.PBits[0] = (int)reader.Read(1);
+			mode1.PBits[1] = (int)reader.Read(1);
+			Palette palettes[2];
+			BuildMode1Palette(mode1.Endpoints[0], mode1.PBits[0], palettes[0]);
+			BuildMode1Palette(mode1.Endpoints[1], mode1.PBits[1], palettes[1]);
+			unsigned int anchor = s_bc7Anchors2[mode1.Partition];
+			for (unsigned int i = 0; i < 16; i++) {
+				unsigned int subset = (s_bc7Partitions2[mode1.Partition] >> i) & 1u;
+				const int* color = palettes[subset].Colors[reader.Read((i == 0 || i == anchor) ? 2 : 3)];
+				for (unsigned int c = 0; c < 4; c++) {
+					a_texels[i][c] = (uint8_t)color[c];
+				}
+			}
+		}
+		else {
+			std::memset(a_texels, 0, 16 * 4); // A mode Compress never writes
+		}
+	}
+}
+
+//-----------------------------------------------
+// Sizes
+//-----------------------------------------------
+unsigned int BlockCompression::GetBlockBytes(TextureFormat a_format)
+{
+	switch (a_format) {
+	case TextureFormat::BC1:
+	case TextureFormat::BC4:
+		return 8;
+	case TextureFormat::BC5:
+	case TextureFormat::BC7:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+size_t BlockCompression::GetRowPitch(TextureFormat a_format, unsigned int a_width)
+{
+	unsigned int blockBytes = GetBlockBytes(a_format);
+	return blockBytes == 0 ? (size_t)a_width * 4 : (size_t)((a_width + 3) / 4) * blockBytes;
+}
+
+unsigned int BlockCompression::GetRowCount(TextureFormat a_format, unsigned int a_height)
+{
+	return GetBlockBytes(a_format) == 0 ? a_height : (a_height + 3) / 4;
+}
+
+size_t BlockCompression::GetLevelSize(TextureFormat a_format, unsigned int a_width, unsigned int a_height)
+{
+	return GetRowPitch(a_format, a_width) * GetRowCount(a_format, a_height);
+}
+
+//-----------------------------------------------
+// Encode rows of blocks, spread across the pool
+//-----------------------------------------------
+void BlockCompression::Compress(const uint8_t* a_pixels, unsigned int a_width, unsigned int a_height, TextureFormat a_format,
+	CompressionQuality a_quality, uint8_t* a_output, bool a_bUseSIMD, bool a_bThreaded)
+{
+	if (a_format == TextureFormat::RGBA8) {
+		std::memcpy(a_output, a_pixels, (size_t)a_width * a_height * 4);
+		return;
+	}
+
+	unsigned int blocksWide = (a_width + 3) / 4;
+	unsigned int blocksHigh = (a_height + 3) / 4;
+	unsigned int blockBytes = GetBlockBytes(a_format);
+	auto encodeRows = [&](unsigned int a_begin, unsigned int a_end) {
+		Block block;
+		for (unsigned int blockY = a_begin; blockY < a_end; blockY++) {
+			for (unsigned int blockX = 0; blockX < blocksWide; blockX++) {
+				uint8_t* output = a_output + ((size_t)blockY * blocksWide + blockX) * blockBytes;
+				switch (a_format) {
+				case TextureFormat::BC1:
+					LoadBlock(a_pixels, a_width, a_height, blockX, blockY, s_rgbChannels, block);
+					EncodeBC1(block, a_quality, a_bUseSIMD, output);
+					break;
+				case TextureFormat::BC4:
+					LoadBlock(a_pixels, a_width, a_height, blockX, blockY, s_redChannel, block);
+					EncodeBC4(block, a_quality, a_bUseSIMD, output);
+					break;
+				case TextureFormat::BC5:
+					LoadBlock(a_pixels, a_width, a_height, blockX, blockY, s_redChannel, block);
+					EncodeBC4(block, a_quality, a_bUseSIMD, output);
+					LoadBlock(a_pixels, a_width, a_height, blockX, blockY, s_greenChannel, block);
+					EncodeBC4(block, a_quality, a_bUseSIMD, output + 8);
+					break;
+				default:
+					LoadBlock(a_pixels, a_width, a_height, blockX, blockY, s_rgbaChannels, block);
+					EncodeBC7(block, a_quality, a_bUseSIMD, output);
+					break;
+				}
+			}
+		}
+	};
+
+	if (a_bThreaded)
+		JobSystem::GetInstance().ParallelFor(blocksHigh, BC_BLOCK_ROWS_PER_JOB, encodeRows);
+	else
+		encodeRows(0, blocksHigh);
+}
+
+//-----------------------------------------------
+// Decode every block, dropping texels past the
+// image's edges
+//-----------------------------------------------
+void BlockCompression::Decompress(const uint8_t* a_blocks, unsigned int a_width, unsigned int a_height, TextureFormat a_format, uint8_t* a_pixels)
+{
+	if (a_format == TextureFormat::RGBA8) {
+		std::memcpy(a_pixels, a_blocks, (size_t)a_width * a_height * 4);
+		return;
+	}
+
+	unsigned int blocksWide = (a_width + 3) / 4;
+	unsigned int blocksHigh = (a_height + 3) / 4;
+	unsigned int blockBytes = GetBlockBytes(a_format);
+	for (unsigned int blockY = 0; blockY < blocksHigh; blockY++) {
+		for (unsigned int blockX = 0; blockX < blocksWide; blockX++) {
+			const uint8_t* block = a_blocks + ((size_t)blockY * blocksWide + blockX) * blockBytes;
+			uint8_t texels[16][4] = {};
+			switch (a_format) {
+			case TextureFormat::BC1:
+				DecodeBC1(block, texels);
+				break;
+			case TextureFormat::BC4:
+				DecodeBC4(block, texels, 0);
+				break;
+			case TextureFormat::BC5:
+				DecodeBC4(block, texels, 0);
+				DecodeBC4(block + 8, texels, 1);
+				break;
+			default:
+				DecodeBC7(block, texels);
+				break;
+			}
+			if (a_format == TextureFormat::BC4 || a_format == TextureFormat::BC5) {
+				for (unsigned int i = 0; i < 16; i++) {
+					texels[i][3] = 255;
+				}
+			}
+
+			for (unsigned int y = 0; y < 4 && blockY * 4 + y < a_height; y++) {
+				for (unsigned int x = 0; x < 4 && blockX * 4 + x < a_width; x++) {
+					std::memcpy(a_pixels + ((size_t)(blockY * 4 + y) * a_width + blockX * 4 + x) * 4, texels[y * 4 + x], 4);
+				}
+			}
+		}
+	}
+}
+
+//-----------------------------------------------
+// Compress each level in turn. Each one is still
+// spread across the pool
+//-----------------------------------------------
+void BlockCompression::CompressTexture(TextureData& a_texture, TextureFormat a_format, CompressionQuality a_quality)
+{
+	if (a_texture.Format != TextureFormat::RGBA8 || a_format == TextureFormat::RGBA8)
+		return;
+
+	for (TextureMip& mip : a_texture.Mips) {
+		std::vector<uint8_t> blocks(GetLevelSize(a_format, mip.Width, mip.Height));
+		Compress(mip.Pixels.data(), mip.Width, mip.Height, a_format, a_quality, blocks.data());
+		mip.Pixels.swap(blocks);
+	}
+	a_texture.Format = a_format;
+}
+
+//-----------------------------------------------
+// 10 log10(255² / mean squared error)
+//-----------------------------------------------
+double BlockCompression::ComputePSNR(const uint8_t* a_reference, const uint8_t* a_pixels, size_t a_pixelCount, TextureFormat a_format)
+{
+	unsigned int channels = a_format == TextureFormat::BC4 ? 1 : a_format == TextureFormat::BC5 ? 2 : a_format == TextureFormat::BC1 ? 3 : 4;
+	double squaredError = 0.0;
+	for (size_t i = 0; i < a_pixelCount; i++) {
+		for (unsigned int c = 0; c < channels; c++) {
+			double difference = (double)a_reference[i * 4 + c] - (double)a_pixels[i * 4 + c];
+			squaredError += difference * difference;
+		}
+	}
+	if (squaredError == 0.0)
+		return std::numeric_limits<double>::infinity();
+	double meanSquaredError = squaredError / ((double)a_pixelCount * channels);
+	return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TextureMips.h"
+
+#define BC_BLOCK_ROWS_PER_JOB 4 // Rows of blocks each job encodes
+
+// Speed/quality presets, each a superset of the searches before it
+enum class CompressionQuality {
+	Fast, // A single principal axis fit. BC7 only tries mode 6
+	Normal, // Least squares refinement of the fit. BC4 also tries its 0/255 mode, BC7 also tries mode 1's best partitions
+	High // More refinement, every p-bit combination and a local search around the endpoints
+};
+
+//-------------------------------------------------------
+// CPU block compression for the texture cooker, so
+// compressed textures don't depend on any Windows tools
+//	- BC1 (opaque RGB), BC4 (R), BC5 (RG) and BC7 (RGBA,
+//	  using modes 6 and 1) from 8 bit RGBA images. Channels
+//	  a format doesn't store are ignored
+//	- Endpoints start from the block's principal axis and
+//	  are refined by least squares against the indices
+//	  they produced. Every candidate is scored by matching
+//	  each texel to its nearest palette entry, which SSE2
+//	  runs four texels at a time in exact integer math, so
+//	  both paths produce identical blocks
+//	- Rows of blocks are encoded in parallel on the
+//	  JobSystem
+//	- Partial blocks at the right and bottom edges repeat
+//	  the last column and row
+//-------------------------------------------------------
+namespace BlockCompression
+{
+	// Bytes per 4x4 block, or 0 for RGBA8
+	unsigned int GetBlockBytes(TextureFormat a_format);
+
+	// Bytes per row of texels (RGBA8) or of blocks, and how many such rows a level has
+	size_t GetRowPitch(TextureFormat a_format, unsigned int a_width);
+	unsigned int GetRowCount(TextureFormat a_format, unsigned int a_height);
+
+	// Bytes a whole level takes
+	size_t GetLevelSize(TextureFormat a_format, unsigned int a_width, unsigned int a_height);
+
+	// Encode an RGBA8 image into a_output, which must hold GetLevelSize bytes
+	//	- a_bUseSIMD = false forces the scalar palette matching, a_bThreaded = false encodes on this thread only
+	void Compress(const uint8_t* a_pixels, unsigned int a_width, unsigned int a_height, TextureFormat a_format,
+		CompressionQuality a_quality, uint8_t* a_output, bool a_bUseSIMD = true, bool a_bThreaded = true);
+
+	// Decode blocks back to RGBA8, for measuring quality. Channels the format doesn't store come back as 0
+	// (alpha as 255). BC7 decoding covers the modes Compress writes
+	void Decompress(const uint8_t* a_blocks, unsigned int a_width, unsigned int a_height, TextureFormat a_format, uint8_t* a_pixels);
+
+	// Replace every RGBA8 level of a_texture with its compressed form
+	void CompressTexture(TextureData& a_texture, TextureFormat a_format, CompressionQuality a_quality);
+
+	// Peak signal to noise ratio in dB between two RGBA8 images, over the channels a_format stores. Identical
+	// images return infinity
+	double ComputePSNR(const uint8_t* a_reference, const uint8_t* a_pixels, size_t a_pixelCount, TextureFormat a_format);
+}
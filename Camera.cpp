@@ -19,6 +19,7 @@ Camera::Camera(Transform a_initialTransform, DirectX::XMINT2 a_aspectRatio)
 {
 	m_viewMatrix = CalculateViewMatrix();
 	m_projectionMatrix = CalculateProjectionMatrix();
+	m_previousViewProjectionMatrix = GetViewProjectionMatrix();
 }
 
 // ----------------------------------------------------------
@@ -34,6 +35,7 @@ Camera::~Camera()
 // ----------------------------------------------------------
 void Camera::Update(float deltaTime)
 {
+	m_previousViewProjectionMatrix = GetViewProjectionMatrix(); // Last frame's matrices, before anything moves
 	UpdateInput(deltaTime); // Must happen before View Matrix is updated
 	UpdateViewMatrix(); // Happens every frame, important
 }
@@ -224,6 +226,26 @@ DirectX::XMFLOAT4X4 Camera::GetProjectionMatrix()
 	return m_projectionMatrix;
 }
 
+// ----------------------------------------------------------
+// Retrieves the combined View and Projection Matrix
+// ----------------------------------------------------------
+DirectX::XMFLOAT4X4 Camera::GetViewProjectionMatrix()
+{
+	Matrix4 viewProjection;
+	XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(XMLoadFloat4x4(&m_viewMatrix), XMLoadFloat4x4(&m_projectionMatrix)));
+	return viewProjection;
+}
+
+// ----------------------------------------------------------
+// Retrieves the View * Projection Matrix the Camera had
+// before its most recent Update
+//	- Used to reproject screen positions into the last frame
+// ----------------------------------------------------------
+DirectX::XMFLOAT4X4 Camera::GetPreviousViewProjectionMatrix()
+{
+	return m_previousViewProjectionMatrix;
+}
+
 // ----------------------------------------------------------
 // Retrieves the Camera's Transform as a pointer
 // ----------------------------------------------------------
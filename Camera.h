@@ -56,6 +56,8 @@ public:
 
 	Matrix4 GetViewMatrix();
 	Matrix4 GetProjectionMatrix();
+	Matrix4 GetViewProjectionMatrix(); // View * Projection for this frame
+	Matrix4 GetPreviousViewProjectionMatrix(); // View * Projection as of the start of the last Update, for reprojection
 	Transform* GetTransform();
 
 protected:
@@ -63,6 +65,7 @@ protected:
 
 	Matrix4 m_viewMatrix;
 	Matrix4 m_projectionMatrix;
+	Matrix4 m_previousViewProjectionMatrix;
 	
 	ProjectionType m_projectionType;
 
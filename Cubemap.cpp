@@ -0,0 +1,215 @@
+#include "Cubemap.h"
+#include "JobSystem.h"
+
+#include <cmath>
+
+namespace
+{
+	const CubemapFaceAxes s_faceAxes[CUBEMAP_FACE_COUNT] = {
+		{ Vector3(0.f, 0.f, -1.f), Vector3(0.f, -1.f, 0.f), Vector3(1.f, 0.f, 0.f) },
+		{ Vector3(0.f, 0.f, 1.f), Vector3(0.f, -1.f, 0.f), Vector3(-1.f, 0.f, 0.f) },
+		{ Vector3(1.f, 0.f, 0.f), Vector3(0.f, 0.f, 1.f), Vector3(0.f, 1.f, 0.f) },
+		{ Vector3(1.f, 0.f, 0.f), Vector3(0.f, 0.f, -1.f), Vector3(0.f, -1.f, 0.f) },
+		{ Vector3(1.f, 0.f, 0.f), Vector3(0.f, -1.f, 0.f), Vector3(0.f, 0.f, 1.f) },
+		{ Vector3(-1.f, 0.f, 0.f), Vector3(0.f, -1.f, 0.f), Vector3(0.f, 0.f, -1.f) },
+	};
+
+	inline Vector3 Normalize(const Vector3& a_vector)
+	{
+		float inverseLength = 1.f / std::sqrt(a_vector.x * a_vector.x + a_vector.y * a_vector.y + a_vector.z * a_vector.z);
+		return Vector3(a_vector.x * inverseLength, a_vector.y * inverseLength, a_vector.z * inverseLength);
+	}
+}
+
+//-------------------------------------------------------
+// Axes for one face, 0-5
+//-------------------------------------------------------
+const CubemapFaceAxes& Cubemap::GetFaceAxes(unsigned int a_face)
+{
+	return s_faceAxes[a_face];
+}
+
+//-------------------------------------------------------
+// Face direction for a 0-1 UV
+//-------------------------------------------------------
+Vector3 Cubemap::CubeDirectionFromUV(unsigned int a_face, float a_u, float a_v)
+{
+	const CubemapFaceAxes& axes = s_faceAxes[a_face];
+	float u = a_u * 2.f - 1.f;
+	float v = a_v * 2.f - 1.f;
+	return Normalize(Vector3(
+		axes.U.x * u + axes.V.x * v + axes.N.x,
+		axes.U.y * u + axes.V.y * v + axes.N.y,
+		axes.U.z * u + axes.V.z * v + axes.N.z));
+}
+
+//-------------------------------------------------------
+// Major axis face selection, the inverse of the face axes
+//-------------------------------------------------------
+void Cubemap::DirectionToFace(const Vector3& a_direction, unsigned int& a_face, float& a_u, float& a_v)
+{
+	float absX = std::fabs(a_direction.x);
+	float absY = std::fabs(a_direction.y);
+	float absZ = std::fabs(a_direction.z);
+	float major;
+	if (absX >= absY && absX >= absZ) {
+		a_face = a_direction.x > 0.f ? 0 : 1;
+		major = absX;
+	}
+	else if (absY >= absZ) {
+		a_face = a_direction.y > 0.f ? 2 : 3;
+		major = absY;
+	}
+	else {
+		a_face = a_direction.z > 0.f ? 4 : 5;
+		major = absZ;
+	}
+
+	// The axes are orthonormal, so projecting onto U and V recovers the face coordinates
+	const CubemapFaceAxes& axes = s_faceAxes[a_face];
+	a_u = (a_direction.x * axes.U.x + a_direction.y * axes.U.y + a_direction.z * axes.U.z) / major;
+	a_v = (a_direction.x * axes.V.x + a_direction.y * axes.V.y + a_direction.z * axes.V.z) / major;
+}
+
+//-------------------------------------------------------
+// Bilinear sample within the face the direction hits
+//	- No filtering across face edges, which is close enough
+//	  for a low frequency reference
+//-------------------------------------------------------
+Vector3 Cubemap::Sample(const CubemapImage& a_cube, const Vector3& a_direction)
+{
+	unsigned int face;
+	float u, v;
+	DirectionToFace(a_direction, face, u, v);
+
+	float maxCoordinate = (float)(a_cube.Size - 1);
+	float texelX = (u * 0.5f + 0.5f) * a_cube.Size - 0.5f;
+	float texelY = (v * 0.5f + 0.5f) * a_cube.Size - 0.5f;
+	texelX = texelX < 0.f ? 0.f : (texelX > maxCoordinate ? maxCoordinate : texelX);
+	texelY = texelY < 0.f ? 0.f : (texelY > maxCoordinate ? maxCoordinate : texelY);
+
+	unsigned int x0 = (unsigned int)texelX;
+	unsigned int y0 = (unsigned int)texelY;
+	unsigned int x1 = x0 + 1 < a_cube.Size ? x0 + 1 : x0;
+	unsigned int y1 = y0 + 1 < a_cube.Size ? y0 + 1 : y0;
+	float fractionX = texelX - x0;
+	float fractionY = texelY - y0;
+
+	const Vector4* texels = &a_cube.Texels[(size_t)face * a_cube.Size * a_cube.Size];
+	const Vector4& t00 = texels[(size_t)y0 * a_cube.Size + x0];
+	const Vector4& t10 = texels[(size_t)y0 * a_cube.Size + x1];
+	const Vector4& t01 = texels[(size_t)y1 * a_cube.Size + x0];
+	const Vector4& t11 = texels[(size_t)y1 * a_cube.Size + x1];
+	float w00 = (1.f - fractionX) * (1.f - fractionY);
+	float w10 = fractionX * (1.f - fractionY);
+	float w01 = (1.f - fractionX) * fractionY;
+	float w11 = fractionX * fractionY;
+	return Vector3(
+		t00.x * w00 + t10.x * w10 + t01.x * w01 + t11.x * w11,
+		t00.y * w00 + t10.y * w10 + t01.y * w01 + t11.y * w11,
+		t00.z * w00 + t10.z * w10 + t01.z * w01 + t11.z * w11);
+}
+
+//-------------------------------------------------------
+// Blend bilinear samples of the two nearest mips
+//-------------------------------------------------------
+Vector3 Cubemap::SampleLevel(const std::vector<CubemapImage>& a_mips, const Vector3& a_direction, float a_level)
+{
+	float maxLevel = (float)(a_mips.size() - 1);
+	a_level = a_level < 0.f ? 0.f : (a_level > maxLevel ? maxLevel : a_level);
+	unsigned int level0 = (unsigned int)a_level;
+	float fraction = a_level - level0;
+
+	Vector3 first = Sample(a_mips[level0], a_direction);
+	if (fraction <= 0.f || level0 + 1 >= a_mips.size())
+		return first;
+
+	Vector3 second = Sample(a_mips[level0 + 1], a_direction);
+	return Vector3(
+		first.x + (second.x - first.x) * fraction,
+		first.y + (second.y - first.y) * fraction,
+		first.z + (second.z - first.z) * fraction);
+}
+
+//-------------------------------------------------------
+// Average 2x2 blocks into each smaller level. Odd sizes
+// round down (and repeat the last row / column), which
+// only happens for non power of 2 skies
+//-------------------------------------------------------
+void Cubemap::BuildMipChain(std::vector<CubemapImage>& a_mips, bool a_bMultithreaded)
+{
+	a_mips.resize(1);
+	while (a_mips.back().Size > 1) {
+		const CubemapImage& source = a_mips.back();
+		CubemapImage mip;
+		mip.Size = source.Size / 2;
+		mip.Texels.resize((size_t)CUBEMAP_FACE_COUNT * mip.Size * mip.Size);
+
+		auto downsampleRows = [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int row = a_begin; row < a_end; row++) {
+				unsigned int face = row / mip.Size;
+				unsigned int y = row % mip.Size;
+				unsigned int sourceY0 = y * 2;
+				unsigned int sourceY1 = sourceY0 + 1 < source.Size ? sourceY0 + 1 : sourceY0;
+				const Vector4* sourceFace = &source.Texels[(size_t)face * source.Size * source.Size];
+				for (unsigned int x = 0; x < mip.Size; x++) {
+					unsigned int sourceX0 = x * 2;
+					unsigned int sourceX1 = sourceX0 + 1 < source.Size ? sourceX0 + 1 : sourceX0;
+					const Vector4& t00 = sourceFace[(size_t)sourceY0 * source.Size + sourceX0];
+					const Vector4& t10 = sourceFace[(size_t)sourceY0 * source.Size + sourceX1];
+					const Vector4& t01 = sourceFace[(size_t)sourceY1 * source.Size + sourceX0];
+					const Vector4& t11 = sourceFace[(size_t)sourceY1 * source.Size + sourceX1];
+					mip.Texels[((size_t)face * mip.Size + y) * mip.Size + x] = Vector4(
+						(t00.x + t10.x + t01.x + t11.x) * 0.25f,
+						(t00.y + t10.y + t01.y + t11.y) * 0.25f,
+						(t00.z + t10.z + t01.z + t11.z) * 0.25f,
+						(t00.w + t10.w + t01.w + t11.w) * 0.25f);
+				}
+			}
+		};
+
+		unsigned int rowCount = mip.Size * CUBEMAP_FACE_COUNT;
+		if (a_bMultithreaded)
+			JobSystem::GetInstance().ParallelFor(rowCount, 16, downsampleRows);
+		else
+			downsampleRows(0, rowCount);
+		a_mips.push_back(std::move(mip));
+	}
+}
+
+//-------------------------------------------------------
+// Gradient sky over a darker ground with a broad sun
+//-------------------------------------------------------
+void Cubemap::GenerateSyntheticSky(unsigned int a_size, CubemapImage& a_cube)
+{
+	a_cube.Size = a_size;
+	a_cube.Texels.resize((size_t)CUBEMAP_FACE_COUNT * a_size * a_size);
+
+	const Vector3 zenith(0.25f, 0.45f, 0.85f);
+	const Vector3 horizon(0.8f, 0.85f, 0.9f);
+	const Vector3 ground(0.3f, 0.25f, 0.2f);
+	const Vector3 sunColor(6.f, 5.5f, 4.5f);
+	const Vector3 sunDirection = Normalize(Vector3(0.4f, 0.6f, 0.3f));
+
+	for (unsigned int face = 0; face < CUBEMAP_FACE_COUNT; face++) {
+		for (unsigned int y = 0; y < a_size; y++) {
+			for (unsigned int x = 0; x < a_size; x++) {
+				Vector3 direction = CubeDirectionFromUV(face, (x + 0.5f) / a_size, (y + 0.5f) / a_size);
+
+				// Sky fades from horizon to zenith, and blends into ground over a narrow band below the horizon
+				float up = direction.y > 0.f ? std::sqrt(direction.y) : 0.f;
+				float skyAmount = direction.y > -0.1f ? 1.f : 0.f;
+				if (direction.y > -0.1f && direction.y < 0.f)
+					skyAmount = 1.f + direction.y * 10.f;
+				float sun = direction.x * sunDirection.x + direction.y * sunDirection.y + direction.z * sunDirection.z;
+				sun = sun > 0.f ? std::pow(sun, 16.f) : 0.f;
+
+				Vector4& texel = a_cube.Texels[((size_t)face * a_size + y) * a_size + x];
+				texel.x = (horizon.x + (zenith.x - horizon.x) * up) * skyAmount + ground.x * (1.f - skyAmount) + sunColor.x * sun;
+				texel.y = (horizon.y + (zenith.y - horizon.y) * up) * skyAmount + ground.y * (1.f - skyAmount) + sunColor.y * sun;
+				texel.z = (horizon.z + (zenith.z - horizon.z) * up) * skyAmount + ground.z * (1.f - skyAmount) + sunColor.z * sun;
+				texel.w = 1.f;
+			}
+		}
+	}
+}
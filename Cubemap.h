@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+#include "Types.h"
+
+#define CUBEMAP_FACE_COUNT 6
+
+//-------------------------------------------------------
+// CPU copy of one mip of a cubemap
+//	- Faces are in D3D order (+X, -X, +Y, -Y, +Z, -Z) and
+//	  texels row-major within a face, so Texels holds
+//	  6 * Size * Size values
+//	- Values are linear radiance (gamma already removed),
+//	  w is ignored
+//-------------------------------------------------------
+struct CubemapImage {
+	unsigned int Size = 0;
+	std::vector<Vector4> Texels;
+};
+
+//-------------------------------------------------------
+// Axes of a face such that a texel's direction is
+// U * u + V * v + N, with u and v in [-1, 1]. Matches the
+// cases of CubeDirectionFromUV in ShaderHelpers.hlsli
+//-------------------------------------------------------
+struct CubemapFaceAxes {
+	Vector3 U;
+	Vector3 V;
+	Vector3 N;
+};
+
+//-------------------------------------------------------
+// Direction mapping and filtering for CubemapImages,
+// shared by the CPU IBL tools (SphericalHarmonics,
+// IBLBaker)
+//-------------------------------------------------------
+namespace Cubemap
+{
+	const CubemapFaceAxes& GetFaceAxes(unsigned int a_face);
+
+	// ShaderHelpers.hlsli CubeDirectionFromUV, normalized. UV is 0-1 across the face
+	Vector3 CubeDirectionFromUV(unsigned int a_face, float a_u, float a_v);
+
+	// Face a direction hits, and its coordinates on that face in [-1, 1]
+	void DirectionToFace(const Vector3& a_direction, unsigned int& a_face, float& a_u, float& a_v);
+
+	// Bilinear sample, clamped at face edges
+	Vector3 Sample(const CubemapImage& a_cube, const Vector3& a_direction);
+
+	// Trilinear sample of a mip chain (a_mips[0] is the most detailed), a_level clamped to the chain
+	Vector3 SampleLevel(const std::vector<CubemapImage>& a_mips, const Vector3& a_direction, float a_level);
+
+	// Box filter a_mips[0] down to 1x1, replacing any other entries
+	void BuildMipChain(std::vector<CubemapImage>& a_mips, bool a_bMultithreaded);
+
+	// Smooth sky / ground gradient with a soft sun lobe, for benchmarks without a real sky
+	void GenerateSyntheticSky(unsigned int a_size, CubemapImage& a_cube);
+}
@@ -0,0 +1,205 @@
+#include "Culling.h"
+#include "JobSystem.h"
+
+#include <cmath>
+
+// SSE is baseline on every x64 target, and on x86 when building with /arch:SSE2 or -msse2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULLING_SSE 1
+#include <emmintrin.h>
+#else
+#define CULLING_SSE 0
+#endif
+
+#define CULLING_JOB_GRAIN 1024 // Spheres per job
+
+namespace
+{
+	Vector4 NormalizePlane(float a_a, float a_b, float a_c, float a_d)
+	{
+		float length = std::sqrt(a_a * a_a + a_b * a_b + a_c * a_c);
+		float inverseLength = length > 0.f ? 1.f / length : 0.f;
+		return Vector4(a_a * inverseLength, a_b * inverseLength, a_c * inverseLength, a_d * inverseLength);
+	}
+
+	uint64_t CullSphereScalar(const Vector4& a_sphere, const std::vector<Frustum>& a_views, unsigned int a_viewCount)
+	{
+		uint64_t mask = 0;
+		for (unsigned int view = 0; view < a_viewCount; view++) {
+			bool bVisible = true;
+			for (int plane = 0; plane < CULLING_PLANE_COUNT && bVisible; plane++) {
+				const Vector4& p = a_views[view].Planes[plane];
+				bVisible = p.x * a_sphere.x + p.y * a_sphere.y + p.z * a_sphere.z + p.w >= -a_sphere.w;
+			}
+			mask |= bVisible ? (1ull << view) : 0ull;
+		}
+		return mask;
+	}
+
+	void CullRange(const std::vector<Vector4>& a_spheres, const std::vector<Frustum>& a_views, unsigned int a_viewCount,
+		std::vector<uint64_t>& a_masks, size_t a_begin, size_t a_end, bool a_bUseSIMD)
+	{
+		size_t i = a_begin;
+#if CULLING_SSE
+		if (a_bUseSIMD) {
+			for (; i + 4 <= a_end; i += 4) {
+				// Transpose 4 spheres into x, y, z, radius registers
+				__m128 x = _mm_loadu_ps(&a_spheres[i].x);
+				__m128 y = _mm_loadu_ps(&a_spheres[i + 1].x);
+				__m128 z = _mm_loadu_ps(&a_spheres[i + 2].x);
+				__m128 r = _mm_loadu_ps(&a_spheres[i + 3].x);
+				_MM_TRANSPOSE4_PS(x, y, z, r);
+				__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), r);
+
+				uint64_t masks[4] = {};
+				for (unsigned int view = 0; view < a_viewCount; view++) {
+					const Vector4* planes = a_views[view].Planes;
+					__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+					for (int plane = 0; plane < CULLING_PLANE_COUNT; plane++) {
+						__m128 distance = _mm_add_ps(
+							_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(planes[plane].x)), _mm_mul_ps(y, _mm_set1_ps(planes[plane].y))),
+							_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(planes[plane].z)), _mm_set1_ps(planes[plane].w)));
+						inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+					}
+					int bits = _mm_movemask_ps(inside);
+					for (int lane = 0; lane < 4; lane++) {
+						masks[lane] |= (uint64_t)((bits >> lane) & 1) << view;
+					}
+				}
+				for (int lane = 0; lane < 4; lane++) {
+					a_masks[i + lane] = masks[lane];
+				}
+			}
+		}
+#endif
+		for (; i < a_end; i++) {
+			a_masks[i] = CullSphereScalar(a_spheres[i], a_views, a_viewCount);
+		}
+	}
+}
+
+//-------------------------------------------------------
+// Gribb-Hartmann plane extraction. With row vectors,
+// clip = p * M, so each plane is a sum of columns
+//-------------------------------------------------------
+Frustum Culling::ExtractFrustum(const Matrix4& a_viewProjection)
+{
+	const Matrix4& m = a_viewProjection;
+	Frustum frustum;
+	frustum.Planes[0] = NormalizePlane(m._14 + m._11, m._24 + m._21, m._34 + m._31, m._44 + m._41); // Left
+	frustum.Planes[1] = NormalizePlane(m._14 - m._11, m._24 - m._21, m._34 - m._31, m._44 - m._41); // Right
+	frustum.Planes[2] = NormalizePlane(m._14 + m._12, m._24 + m._22, m._34 + m._32, m._44 + m._42); // Bottom
+	frustum.Planes[3] = NormalizePlane(m._14 - m._12, m._24 - m._22, m._34 - m._32, m._44 - m._42); // Top
+	frustum.Planes[4] = NormalizePlane(m._13, m._23, m._33, m._43); // Near, z >= 0
+	frustum.Planes[5] = NormalizePlane(m._14 - m._13, m._24 - m._23, m._34 - m._33, m._44 - m._43); // Far
+	return frustum;
+}
+
+//-------------------------------------------------------
+// Row-vector transform of the centre. Non-uniform scale
+// takes the largest axis so the sphere still contains
+// the mesh
+//-------------------------------------------------------
+Vector4 Culling::TransformSphere(const Vector4& a_sphere, const Matrix4& a_world)
+{
+	const Matrix4& m = a_world;
+	float x = a_sphere.x * m._11 + a_sphere.y * m._21 + a_sphere.z * m._31 + m._41;
+	float y = a_sphere.x * m._12 + a_sphere.y * m._22 + a_sphere.z * m._32 + m._42;
+	float z = a_sphere.x * m._13 + a_sphere.y * m._23 + a_sphere.z * m._33 + m._43;
+	float scaleX = m._11 * m._11 + m._12 * m._12 + m._13 * m._13;
+	float scaleY = m._21 * m._21 + m._22 * m._22 + m._23 * m._23;
+	float scaleZ = m._31 * m._31 + m._32 * m._32 + m._33 * m._33;
+	float scale = std::sqrt(std::fmax(scaleX, std::fmax(scaleY, scaleZ)));
+	return Vector4(x, y, z, a_sphere.w * scale);
+}
+
+//-------------------------------------------------------
+// Box around a sphere
+//-------------------------------------------------------
+AABB Culling::SphereToAABB(const Vector4& a_sphere)
+{
+	AABB box;
+	box.Min = Vector3(a_sphere.x - a_sphere.w, a_sphere.y - a_sphere.w, a_sphere.z - a_sphere.w);
+	box.Max = Vector3(a_sphere.x + a_sphere.w, a_sphere.y + a_sphere.w, a_sphere.z + a_sphere.w);
+	return box;
+}
+
+//-------------------------------------------------------
+// The box is outside a plane when its projected radius
+// onto the plane normal can't reach it
+//-------------------------------------------------------
+bool Culling::IntersectsBox(const Frustum& a_frustum, const AABB& a_box)
+{
+	float centerX = (a_box.Min.x + a_box.Max.x) * 0.5f, extentX = (a_box.Max.x - a_box.Min.x) * 0.5f;
+	float centerY = (a_box.Min.y + a_box.Max.y) * 0.5f, extentY = (a_box.Max.y - a_box.Min.y) * 0.5f;
+	float centerZ = (a_box.Min.z + a_box.Max.z) * 0.5f, extentZ = (a_box.Max.z - a_box.Min.z) * 0.5f;
+	for (int plane = 0; plane < CULLING_PLANE_COUNT; plane++) {
+		const Vector4& p = a_frustum.Planes[plane];
+		float distance = p.x * centerX + p.y * centerY + p.z * centerZ + p.w;
+		float radius = std::fabs(p.x) * extentX + std::fabs(p.y) * extentY + std::fabs(p.z) * extentZ;
+		if (distance < -radius)
+			return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------
+// Centre of the bounding box, radius to the farthest
+// point. Not minimal, but close for typical meshes
+//	- a_stride is the byte distance between points, so
+//	  positions can be read straight out of vertices
+//-------------------------------------------------------
+Vector4 Culling::ComputeBoundingSphere(const Vector3* a_points, unsigned int a_count, unsigned int a_stride)
+{
+	if (a_count == 0)
+		return Vector4(0.f, 0.f, 0.f, 0.f);
+
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(a_points);
+	Vector3 minimum = *a_points;
+	Vector3 maximum = *a_points;
+	for (unsigned int i = 1; i < a_count; i++) {
+		const Vector3& point = *reinterpret_cast<const Vector3*>(bytes + (size_t)i * a_stride);
+		minimum = Vector3(std::fmin(minimum.x, point.x), std::fmin(minimum.y, point.y), std::fmin(minimum.z, point.z));
+		maximum = Vector3(std::fmax(maximum.x, point.x), std::fmax(maximum.y, point.y), std::fmax(maximum.z, point.z));
+	}
+
+	Vector3 center((minimum.x + maximum.x) * 0.5f, (minimum.y + maximum.y) * 0.5f, (minimum.z + maximum.z) * 0.5f);
+	float radiusSquared = 0.f;
+	for (unsigned int i = 0; i < a_count; i++) {
+		const Vector3& point = *reinterpret_cast<const Vector3*>(bytes + (size_t)i * a_stride);
+		float x = point.x - center.x, y = point.y - center.y, z = point.z - center.z;
+		radiusSquared = std::fmax(radiusSquared, x * x + y * y + z * z);
+	}
+	return Vector4(center.x, center.y, center.z, std::sqrt(radiusSquared));
+}
+
+//-------------------------------------------------------
+// Tests every sphere against every view in one pass
+//-------------------------------------------------------
+void Culling::CullSpheres(const std::vector<Vector4>& a_spheres, const std::vector<Frustum>& a_views, std::vector<uint64_t>& a_masks,
+	bool a_bMultithreaded, bool a_bUseSIMD)
+{
+	a_masks.resize(a_spheres.size());
+	unsigned int viewCount = a_views.size() < CULLING_MAX_VIEWS ? (unsigned int)a_views.size() : CULLING_MAX_VIEWS;
+	if (a_bMultithreaded) {
+		JobSystem::GetInstance().ParallelFor((unsigned int)a_spheres.size(), CULLING_JOB_GRAIN, [&](unsigned int a_begin, unsigned int a_end) {
+			CullRange(a_spheres, a_views, viewCount, a_masks, a_begin, a_end, a_bUseSIMD);
+		});
+	}
+	else {
+		CullRange(a_spheres, a_views, viewCount, a_masks, 0, a_spheres.size(), a_bUseSIMD);
+	}
+}
+
+//-------------------------------------------------------
+// Expands one bit of the masks into an index list
+//-------------------------------------------------------
+void Culling::GatherVisible(const std::vector<uint64_t>& a_masks, unsigned int a_view, std::vector<unsigned int>& a_visible)
+{
+	a_visible.clear();
+	uint64_t bit = 1ull << a_view;
+	for (unsigned int i = 0; i < (unsigned int)a_masks.size(); i++) {
+		if (a_masks[i] & bit)
+			a_visible.push_back(i);
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Types.h"
+
+#define CULLING_MAX_VIEWS 64 // One bit per view in a visibility mask
+#define CULLING_PLANE_COUNT 6
+
+//-------------------------------------------------------
+// Six inward facing planes (a, b, c, d), normalized so
+// dot(abc, p) + d is the signed distance of p
+//-------------------------------------------------------
+struct Frustum {
+	Vector4 Planes[CULLING_PLANE_COUNT];
+};
+
+//-------------------------------------------------------
+// Axis aligned box, Min <= Max on every axis
+//-------------------------------------------------------
+struct AABB {
+	Vector3 Min;
+	Vector3 Max;
+};
+
+//-------------------------------------------------------
+// Multi-view frustum culling
+//	- Bounds are world space spheres (xyz centre, w
+//	  radius) and views are Frustums, at most
+//	  CULLING_MAX_VIEWS per pass (main camera, every probe
+//	  face being rendered, shadow cascades...)
+//	- CullSpheres writes one mask per sphere, bit v set if
+//	  it touches view v. Each sphere is loaded once and
+//	  tested against every view while in registers, 4
+//	  spheres at a time with SSE, spread over the JobSystem
+//	- Conservative: spheres near frustum corners can pass
+//	  without being visible, never the other way around
+//-------------------------------------------------------
+namespace Culling
+{
+	// Planes of a row-vector View * Projection matrix (DirectXMath convention, D3D 0-1 depth)
+	Frustum ExtractFrustum(const Matrix4& a_viewProjection);
+
+	// Local bounding sphere into world space, radius scaled by the largest axis scale
+	Vector4 TransformSphere(const Vector4& a_sphere, const Matrix4& a_world);
+
+	// Box around a world space sphere
+	AABB SphereToAABB(const Vector4& a_sphere);
+
+	// Conservative box test, same convention as the sphere test in CullSpheres
+	bool IntersectsBox(const Frustum& a_frustum, const AABB& a_box);
+
+	// Smallest box-centred sphere around some points
+	Vector4 ComputeBoundingSphere(const Vector3* a_points, unsigned int a_count, unsigned int a_stride);
+
+	// a_masks is resized to a_spheres.size(). Views past CULLING_MAX_VIEWS are ignored
+	void CullSpheres(const std::vector<Vector4>& a_spheres, const std::vector<Frustum>& a_views, std::vector<uint64_t>& a_masks,
+		bool a_bMultithreaded, bool a_bUseSIMD);
+
+	// Indices of the spheres visible in one view, in order
+	void GatherVisible(const std::vector<uint64_t>& a_masks, unsigned int a_view, std::vector<unsigned int>& a_visible);
+}
@@ -0,0 +1,244 @@
+#include "D3D11RenderDevice.h"
+
+#include <cstring>
+
+//-----------------------------------------------
+// Store the device and context that every call
+// will be forwarded to
+//-----------------------------------------------
+D3D11RenderDevice::D3D11RenderDevice(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context)
+	: m_device(a_device)
+	, m_context(a_context)
+	, m_boundVertexBuffer(INVALID_RENDER_HANDLE)
+	, m_boundIndexBuffer(INVALID_RENDER_HANDLE)
+	, m_boundTopology(PrimitiveTopology::TriangleList)
+	, m_bTopologyKnown(false)
+{
+}
+
+//-----------------------------------------------
+// ComPtrs release all buffers
+//-----------------------------------------------
+D3D11RenderDevice::~D3D11RenderDevice()
+{
+}
+
+//-----------------------------------------------
+// Create a D3D buffer and hand back a handle to it
+//	- Immutable buffers MUST have initial data
+//	- Constant buffers are rounded up to a multiple of 16 bytes,
+//	  since D3D refuses to create them otherwise
+//-----------------------------------------------
+RenderHandle D3D11RenderDevice::CreateBuffer(BufferType a_type, BufferUsage a_usage, const void* a_data, unsigned int a_byteSize)
+{
+	if (a_byteSize == 0 || (a_usage == BufferUsage::Immutable && a_data == nullptr))
+		return INVALID_RENDER_HANDLE;
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.ByteWidth = a_byteSize;
+	switch (a_type) {
+	case BufferType::Vertex: desc.BindFlags = D3D11_BIND_VERTEX_BUFFER; break;
+	case BufferType::Index: desc.BindFlags = D3D11_BIND_INDEX_BUFFER; break;
+	case BufferType::Constant:
+		desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		desc.ByteWidth = (a_byteSize + 15) / 16 * 16;
+		break;
+	}
+	if (a_usage == BufferUsage::Dynamic) {
+		desc.Usage = D3D11_USAGE_DYNAMIC;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	}
+	else {
+		desc.Usage = D3D11_USAGE_IMMUTABLE;
+	}
+
+	D3D11_SUBRESOURCE_DATA initialData = {};
+	initialData.pSysMem = a_data;
+
+	// A Dynamic constant buffer rounded up past the caller's data can't be initialized from that data
+	bool bCanInitialize = a_data != nullptr && desc.ByteWidth == a_byteSize;
+
+	Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+	if (FAILED(m_device->CreateBuffer(&desc, bCanInitialize ? &initialData : nullptr, buffer.GetAddressOf())))
+		return INVALID_RENDER_HANDLE;
+
+	RenderHandle handle;
+	if (!m_freeHandles.empty()) {
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		m_buffers[handle - 1] = buffer;
+		m_bufferUsages[handle - 1] = a_usage;
+	}
+	else {
+		m_buffers.push_back(buffer);
+		m_bufferUsages.push_back(a_usage);
+		handle = (RenderHandle)m_buffers.size();
+	}
+
+	if (a_data != nullptr && !bCanInitialize)
+		UpdateBuffer(handle, a_data, a_byteSize);
+
+	m_frameStats.BuffersCreated++;
+	return handle;
+}
+
+//-----------------------------------------------
+// Overwrite a Dynamic buffer's contents (Map with
+// discard, so the GPU never stalls on it)
+//-----------------------------------------------
+void D3D11RenderDevice::UpdateBuffer(RenderHandle a_buffer, const void* a_data, unsigned int a_byteSize)
+{
+	ID3D11Buffer* buffer = GetD3DBuffer(a_buffer);
+	if (buffer == nullptr || m_bufferUsages[a_buffer - 1] != BufferUsage::Dynamic)
+		return;
+
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (FAILED(m_context->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		return;
+	std::memcpy(mapped.pData, a_data, a_byteSize);
+	m_context->Unmap(buffer, 0);
+
+	m_frameStats.BufferUpdates++;
+	m_frameStats.BytesUploaded += a_byteSize;
+}
+
+//-----------------------------------------------
+// Free a buffer and recycle its handle
+//-----------------------------------------------
+void D3D11RenderDevice::ReleaseBuffer(RenderHandle a_buffer)
+{
+	if (GetD3DBuffer(a_buffer) == nullptr)
+		return;
+
+	m_buffers[a_buffer - 1].Reset();
+	m_freeHandles.push_back(a_buffer);
+	if (m_boundVertexBuffer == a_buffer)
+		m_boundVertexBuffer = INVALID_RENDER_HANDLE;
+	if (m_boundIndexBuffer == a_buffer)
+		m_boundIndexBuffer = INVALID_RENDER_HANDLE;
+	m_frameStats.BuffersReleased++;
+}
+
+//-----------------------------------------------
+// Bind a single vertex buffer to slot 0
+//-----------------------------------------------
+void D3D11RenderDevice::SetVertexBuffer(RenderHandle a_buffer, unsigned int a_stride)
+{
+	if (a_buffer == m_boundVertexBuffer) {
+		m_frameStats.RedundantBindsSkipped++;
+		return;
+	}
+
+	ID3D11Buffer* buffer = GetD3DBuffer(a_buffer);
+	UINT stride = a_stride;
+	UINT offset = 0;
+	m_context->IASetVertexBuffers(0, 1, &buffer, &stride, &offset);
+	m_boundVertexBuffer = a_buffer;
+	m_frameStats.VertexBufferBinds++;
+}
+
+//-----------------------------------------------
+// Bind an index buffer. All indices are 32 bit
+//-----------------------------------------------
+void D3D11RenderDevice::SetIndexBuffer(RenderHandle a_buffer)
+{
+	if (a_buffer == m_boundIndexBuffer) {
+		m_frameStats.RedundantBindsSkipped++;
+		return;
+	}
+
+	m_context->IASetIndexBuffer(GetD3DBuffer(a_buffer), DXGI_FORMAT_R32_UINT, 0);
+	m_boundIndexBuffer = a_buffer;
+	m_frameStats.IndexBufferBinds++;
+}
+
+//-----------------------------------------------
+// Set how vertices are assembled into primitives
+//-----------------------------------------------
+void D3D11RenderDevice::SetPrimitiveTopology(PrimitiveTopology a_topology)
+{
+	if (m_bTopologyKnown && a_topology == m_boundTopology) {
+		m_frameStats.RedundantBindsSkipped++;
+		return;
+	}
+
+	D3D11_PRIMITIVE_TOPOLOGY topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	switch (a_topology) {
+	case PrimitiveTopology::TriangleList: topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST; break;
+	case PrimitiveTopology::TriangleStrip: topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP; break;
+	case PrimitiveTopology::LineList: topology = D3D11_PRIMITIVE_TOPOLOGY_LINELIST; break;
+	case PrimitiveTopology::PointList: topology = D3D11_PRIMITIVE_TOPOLOGY_POINTLIST; break;
+	}
+	m_context->IASetPrimitiveTopology(topology);
+	m_boundTopology = a_topology;
+	m_bTopologyKnown = true;
+}
+
+//-----------------------------------------------
+// Bind a constant buffer to one stage's slot
+//-----------------------------------------------
+void D3D11RenderDevice::SetConstantBuffer(ShaderStage a_stage, unsigned int a_slot, RenderHandle a_buffer)
+{
+	ID3D11Buffer* buffer = GetD3DBuffer(a_buffer);
+	switch (a_stage) {
+	case ShaderStage::Vertex: m_context->VSSetConstantBuffers(a_slot, 1, &buffer); break;
+	case ShaderStage::Pixel: m_context->PSSetConstantBuffers(a_slot, 1, &buffer); break;
+	case ShaderStage::Domain: m_context->DSSetConstantBuffers(a_slot, 1, &buffer); break;
+	case ShaderStage::Hull: m_context->HSSetConstantBuffers(a_slot, 1, &buffer); break;
+	case ShaderStage::Geometry: m_context->GSSetConstantBuffers(a_slot, 1, &buffer); break;
+	case ShaderStage::Compute: m_context->CSSetConstantBuffers(a_slot, 1, &buffer); break;
+	}
+	m_frameStats.ConstantBufferBinds++;
+}
+
+//-----------------------------------------------
+// Non-indexed draw (fullscreen triangles, etc.)
+//-----------------------------------------------
+void D3D11RenderDevice::Draw(unsigned int a_vertexCount, unsigned int a_startVertex)
+{
+	m_context->Draw(a_vertexCount, a_startVertex);
+	m_frameStats.DrawCalls++;
+	m_frameStats.PrimitivesSubmitted += CountPrimitives(m_boundTopology, a_vertexCount);
+}
+
+//-----------------------------------------------
+// Indexed draw with the currently bound buffers
+//-----------------------------------------------
+void D3D11RenderDevice::DrawIndexed(unsigned int a_indexCount, unsigned int a_startIndex, int a_baseVertex)
+{
+	m_context->DrawIndexed(a_indexCount, a_startIndex, a_baseVertex);
+	m_frameStats.IndexedDrawCalls++;
+	m_frameStats.PrimitivesSubmitted += CountPrimitives(m_boundTopology, a_indexCount);
+}
+
+//-----------------------------------------------
+// Compute dispatch with whatever CS is bound
+//-----------------------------------------------
+void D3D11RenderDevice::Dispatch(unsigned int a_groupsX, unsigned int a_groupsY, unsigned int a_groupsZ)
+{
+	m_context->Dispatch(a_groupsX, a_groupsY, a_groupsZ);
+	m_frameStats.Dispatches++;
+}
+
+//-----------------------------------------------
+// Other code (ImGui especially) binds its own
+// buffers straight through the context, so the
+// cache has to be dropped at frame boundaries
+//-----------------------------------------------
+void D3D11RenderDevice::InvalidateState()
+{
+	m_boundVertexBuffer = INVALID_RENDER_HANDLE;
+	m_boundIndexBuffer = INVALID_RENDER_HANDLE;
+	m_bTopologyKnown = false;
+}
+
+//-----------------------------------------------
+// Look up the D3D buffer behind a handle. Returns
+// nullptr for invalid or released handles
+//-----------------------------------------------
+ID3D11Buffer* D3D11RenderDevice::GetD3DBuffer(RenderHandle a_buffer)
+{
+	if (a_buffer == INVALID_RENDER_HANDLE || a_buffer > m_buffers.size())
+		return nullptr;
+	return m_buffers[a_buffer - 1].Get();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <vector>
+
+#include "RenderDevice.h"
+
+//-------------------------------------------------------
+// RenderDevice backend on top of a D3D11 device and
+// immediate context
+//	- Handles index into a vector of buffers, with released
+//	  slots being reused
+//	- Still exposes the raw device and context for code that
+//	  has not been moved behind the interface (SimpleShader's
+//	  shader objects and resource binds, texture loading, Sky's
+//	  IBL passes, post processing)
+//-------------------------------------------------------
+class D3D11RenderDevice : public RenderDevice
+{
+public:
+	D3D11RenderDevice(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context);
+	~D3D11RenderDevice();
+
+	const char* GetName() const override { return "D3D11"; }
+
+	RenderHandle CreateBuffer(BufferType a_type, BufferUsage a_usage, const void* a_data, unsigned int a_byteSize) override;
+	void UpdateBuffer(RenderHandle a_buffer, const void* a_data, unsigned int a_byteSize) override;
+	void ReleaseBuffer(RenderHandle a_buffer) override;
+
+	void SetVertexBuffer(RenderHandle a_buffer, unsigned int a_stride) override;
+	void SetIndexBuffer(RenderHandle a_buffer) override;
+	void SetPrimitiveTopology(PrimitiveTopology a_topology) override;
+	void SetConstantBuffer(ShaderStage a_stage, unsigned int a_slot, RenderHandle a_buffer) override;
+
+	void Draw(unsigned int a_vertexCount, unsigned int a_startVertex) override;
+	void DrawIndexed(unsigned int a_indexCount, unsigned int a_startIndex, int a_baseVertex) override;
+	void Dispatch(unsigned int a_groupsX, unsigned int a_groupsY, unsigned int a_groupsZ) override;
+
+	void InvalidateState() override;
+
+	// Escape hatches for D3D-bound code
+	Microsoft::WRL::ComPtr<ID3D11Device> GetD3DDevice() { return m_device; }
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> GetD3DContext() { return m_context; }
+	ID3D11Buffer* GetD3DBuffer(RenderHandle a_buffer);
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Device> m_device;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_context;
+
+	std::vector<Microsoft::WRL::ComPtr<ID3D11Buffer>> m_buffers; // Handle N lives at index N - 1
+	std::vector<BufferUsage> m_bufferUsages;
+	std::vector<RenderHandle> m_freeHandles;
+
+	// Cached IA state, to skip redundant binds between draws of the same Mesh
+	RenderHandle m_boundVertexBuffer;
+	RenderHandle m_boundIndexBuffer;
+	PrimitiveTopology m_boundTopology;
+	bool m_bTopologyKnown;
+};
@@ -0,0 +1,521 @@
+#include "DDSFile.h"
+#include "BlockCompression.h"
+#include "AssetFiles.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#define DDS_MAGIC 0x20534444u // "DDS "
+#define DDS_FOURCC_DX10 0x30315844u // "DX10"
+#define DDS_FOURCC_RGBA16F 113u // D3DFMT_A16B16G16R16F
+#define DDS_FOURCC_RGBA32F 116u // D3DFMT_A32B32G32R32F
+#define DDS_FOURCC_DXT1 0x31545844u // "DXT1"
+#define DDS_FOURCC_ATI1 0x31495441u // "ATI1", BC4
+#define DDS_FOURCC_BC4U 0x55344342u // "BC4U"
+#define DDS_FOURCC_ATI2 0x32495441u // "ATI2", BC5
+#define DDS_FOURCC_BC5U 0x55354342u // "BC5U"
+
+// Header flags
+#define DDSD_CAPS 0x1u
+#define DDSD_HEIGHT 0x2u
+#define DDSD_WIDTH 0x4u
+#define DDSD_PITCH 0x8u
+#define DDSD_LINEARSIZE 0x80000u
+#define DDSD_PIXELFORMAT 0x1000u
+#define DDSD_MIPMAPCOUNT 0x20000u
+#define DDPF_ALPHAPIXELS 0x1u
+#define DDPF_FOURCC 0x4u
+#define DDPF_RGB 0x40u
+#define DDSCAPS_COMPLEX 0x8u
+#define DDSCAPS_TEXTURE 0x1000u
+#define DDSCAPS_MIPMAP 0x400000u
+#define DDSCAPS2_CUBEMAP_ALL_FACES 0xFE00u // CUBEMAP | all six face bits
+#define DDS_RESOURCE_MISC_TEXTURECUBE 0x4u
+#define DDS_DIMENSION_TEXTURE2D 3u
+
+// DXGI_FORMAT values, so this file doesn't need dxgiformat.h
+#define DDS_DXGI_R32G32B32A32_FLOAT 2u
+#define DDS_DXGI_R16G16B16A16_FLOAT 10u
+#define DDS_DXGI_R8G8B8A8_UNORM 28u
+#define DDS_DXGI_R8G8B8A8_UNORM_SRGB 29u
+#define DDS_DXGI_B8G8R8A8_UNORM 87u
+#define DDS_DXGI_B8G8R8A8_UNORM_SRGB 91u
+#define DDS_DXGI_BC1_UNORM 71u
+#define DDS_DXGI_BC1_UNORM_SRGB 72u
+#define DDS_DXGI_BC4_UNORM 80u
+#define DDS_DXGI_BC5_UNORM 83u
+#define DDS_DXGI_BC7_UNORM 98u
+#define DDS_DXGI_BC7_UNORM_SRGB 99u
+
+#define DDS_MAX_DIMENSION 16384 // Sanity limit so a corrupt header can't request gigabytes
+
+namespace
+{
+	struct DDSPixelFormat {
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t FourCC;
+		uint32_t RGBBitCount;
+		uint32_t RBitMask;
+		uint32_t GBitMask;
+		uint32_t BBitMask;
+		uint32_t ABitMask;
+	};
+
+	struct DDSHeader {
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t Height;
+		uint32_t Width;
+		uint32_t PitchOrLinearSize;
+		uint32_t Depth;
+		uint32_t MipMapCount;
+		uint32_t Reserved1[11];
+		DDSPixelFormat PixelFormat;
+		uint32_t Caps;
+		uint32_t Caps2;
+		uint32_t Caps3;
+		uint32_t Caps4;
+		uint32_t Reserved2;
+	};
+
+	struct DDSHeaderDX10 {
+		uint32_t DXGIFormat;
+		uint32_t ResourceDimension;
+		uint32_t MiscFlag;
+		uint32_t ArraySize;
+		uint32_t MiscFlags2;
+	};
+
+	static_assert(sizeof(DDSHeader) == 124, "DDS header must match the file layout");
+	static_assert(sizeof(DDSHeaderDX10) == 20, "DX10 header must match the file layout");
+
+	// Texel layouts ReadCubemap understands
+	enum TexelLayout {
+		TEXEL_RGBA8,
+		TEXEL_BGRA8,
+		TEXEL_RGBA16F,
+		TEXEL_RGBA32F,
+		TEXEL_BC1,
+		TEXEL_BC4,
+		TEXEL_BC5,
+		TEXEL_BC7,
+		TEXEL_UNSUPPORTED
+	};
+
+	float HalfToFloat(uint16_t a_half)
+	{
+		uint32_t sign = (uint32_t)(a_half & 0x8000u) << 16;
+		uint32_t exponent = (a_half >> 10) & 0x1Fu;
+		uint32_t mantissa = a_half & 0x3FFu;
+		float value;
+		if (exponent == 0)
+			value = std::ldexp((float)mantissa, -24); // Subnormal
+		else if (exponent == 31)
+			value = mantissa == 0 ? INFINITY : NAN;
+		else
+			value = std::ldexp((float)(mantissa | 0x400u), (int)exponent - 25);
+
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		bits |= sign;
+		std::memcpy(&value, &bits, sizeof(bits));
+		return value;
+	}
+
+	unsigned char EncodeChannel(float a_value)
+	{
+		float encoded = std::pow(a_value > 0.f ? a_value : 0.f, 1.f / 2.2f);
+		encoded = encoded < 1.f ? encoded : 1.f;
+		return (unsigned char)(encoded * 255.f + 0.5f);
+	}
+
+	float DecodeChannel(float a_value)
+	{
+		return std::pow(std::fabs(a_value), 2.2f);
+	}
+
+	// Legacy header for uncompressed R8G8B8A8_UNORM with a full set of mips
+	DDSHeader MakeRGBA8Header(unsigned int a_width, unsigned int a_height, unsigned int a_mipCount)
+	{
+		DDSHeader header = {};
+		header.Size = sizeof(DDSHeader);
+		header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PITCH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT;
+		header.Height = a_height;
+		header.Width = a_width;
+		header.PitchOrLinearSize = a_width * 4;
+		header.MipMapCount = a_mipCount;
+		header.PixelFormat.Size = sizeof(DDSPixelFormat);
+		header.PixelFormat.Flags = DDPF_RGB | DDPF_ALPHAPIXELS;
+		header.PixelFormat.RGBBitCount = 32;
+		header.PixelFormat.RBitMask = 0x000000FFu;
+		header.PixelFormat.GBitMask = 0x0000FF00u;
+		header.PixelFormat.BBitMask = 0x00FF0000u;
+		header.PixelFormat.ABitMask = 0xFF000000u;
+		header.Caps = DDSCAPS_TEXTURE | (a_mipCount > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+		return header;
+	}
+
+	// Read the magic, header and any DX10 extension, working out the texel layout from whichever describes it
+	bool ReadHeader(std::istream& a_file, DDSHeader& a_header, TexelLayout& a_layout, bool& a_bIsCube)
+	{
+		uint32_t magic = 0;
+		a_file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		a_file.read(reinterpret_cast<char*>(&a_header), sizeof(a_header));
+		if (!a_file || magic != DDS_MAGIC || a_header.Size != sizeof(DDSHeader))
+			return false;
+		if (a_header.Width == 0 || a_header.Height == 0 || a_header.Width > DDS_MAX_DIMENSION || a_header.Height > DDS_MAX_DIMENSION)
+			return false;
+
+		a_layout = TEXEL_UNSUPPORTED;
+		a_bIsCube = (a_header.Caps2 & DDSCAPS2_CUBEMAP_ALL_FACES) == DDSCAPS2_CUBEMAP_ALL_FACES;
+		const DDSPixelFormat& format = a_header.PixelFormat;
+		if ((format.Flags & DDPF_FOURCC) && format.FourCC == DDS_FOURCC_DX10) {
+			DDSHeaderDX10 extension = {};
+			a_file.read(reinterpret_cast<char*>(&extension), sizeof(extension));
+			if (!a_file || extension.ArraySize != 1)
+				return false;
+			a_bIsCube = (extension.MiscFlag & DDS_RESOURCE_MISC_TEXTURECUBE) != 0;
+			switch (extension.DXGIFormat) {
+			case DDS_DXGI_R8G8B8A8_UNORM:
+			case DDS_DXGI_R8G8B8A8_UNORM_SRGB:
+				a_layout = TEXEL_RGBA8;
+				break;
+			case DDS_DXGI_B8G8R8A8_UNORM:
+			case DDS_DXGI_B8G8R8A8_UNORM_SRGB:
+				a_layout = TEXEL_BGRA8;
+				break;
+			case DDS_DXGI_R16G16B16A16_FLOAT:
+				a_layout = TEXEL_RGBA16F;
+				break;
+			case DDS_DXGI_R32G32B32A32_FLOAT:
+				a_layout = TEXEL_RGBA32F;
+				break;
+			case DDS_DXGI_BC1_UNORM:
+			case DDS_DXGI_BC1_UNORM_SRGB:
+				a_layout = TEXEL_BC1;
+				break;
+			case DDS_DXGI_BC4_UNORM:
+				a_layout = TEXEL_BC4;
+				break;
+			case DDS_DXGI_BC5_UNORM:
+				a_layout = TEXEL_BC5;
+				break;
+			case DDS_DXGI_BC7_UNORM:
+			case DDS_DXGI_BC7_UNORM_SRGB:
+				a_layout = TEXEL_BC7;
+				break;
+			}
+		}
+		else if (format.Flags & DDPF_FOURCC) {
+			if (format.FourCC == DDS_FOURCC_RGBA16F)
+				a_layout = TEXEL_RGBA16F;
+			else if (format.FourCC == DDS_FOURCC_RGBA32F)
+				a_layout = TEXEL_RGBA32F;
+			else if (format.FourCC == DDS_FOURCC_DXT1)
+				a_layout = TEXEL_BC1;
+			else if (format.FourCC == DDS_FOURCC_ATI1 || format.FourCC == DDS_FOURCC_BC4U)
+				a_layout = TEXEL_BC4;
+			else if (format.FourCC == DDS_FOURCC_ATI2 || format.FourCC == DDS_FOURCC_BC5U)
+				a_layout = TEXEL_BC5;
+		}
+		else if ((format.Flags & DDPF_RGB) && format.RGBBitCount == 32) {
+			if (format.RBitMask == 0x000000FFu && format.GBitMask == 0x0000FF00u && format.BBitMask == 0x00FF0000u)
+				a_layout = TEXEL_RGBA8;
+			else if (format.RBitMask == 0x00FF0000u && format.GBitMask == 0x0000FF00u && format.BBitMask == 0x000000FFu)
+				a_layout = TEXEL_BGRA8;
+		}
+		return a_layout != TEXEL_UNSUPPORTED;
+	}
+
+	// Open a 2D texture up to its first level, checking its mip count and working out its TextureFormat
+	bool OpenTexture(std::istream& a_file, DDSHeader& a_header, TexelLayout& a_layout, TextureFormat& a_format, unsigned int& a_mipCount)
+	{
+		bool bIsCube = false;
+		if (!ReadHeader(a_file, a_header, a_layout, bIsCube) || bIsCube)
+			return false;
+		switch (a_layout) {
+		case TEXEL_RGBA8:
+		case TEXEL_BGRA8:
+			a_format = TextureFormat::RGBA8;
+			break;
+		case TEXEL_BC1:
+			a_format = TextureFormat::BC1;
+			break;
+		case TEXEL_BC4:
+			a_format = TextureFormat::BC4;
+			break;
+		case TEXEL_BC5:
+			a_format = TextureFormat::BC5;
+			break;
+		case TEXEL_BC7:
+			a_format = TextureFormat::BC7;
+			break;
+		default:
+			return false;
+		}
+
+		a_mipCount = (a_header.Flags & DDSD_MIPMAPCOUNT) && a_header.MipMapCount > 0 ? a_header.MipMapCount : 1;
+		return a_mipCount <= TextureMips::GetMipCount(a_header.Width, a_header.Height);
+	}
+
+	// Read a_mipCount levels starting at a_firstMip, seeking past the finer ones
+	bool ReadLevels(std::istream& a_file, const DDSHeader& a_header, TexelLayout a_layout, unsigned int a_firstMip, unsigned int a_mipCount, TextureData& a_texture)
+	{
+		unsigned int width = a_header.Width;
+		unsigned int height = a_header.Height;
+		size_t skipped = 0;
+		for (unsigned int mip = 0; mip < a_firstMip; mip++) {
+			skipped += BlockCompression::GetLevelSize(a_texture.Format, width, height);
+			width = (width > 1) ? width / 2 : 1;
+			height = (height > 1) ? height / 2 : 1;
+		}
+		if (skipped > 0)
+			a_file.seekg((std::streamoff)skipped, std::ios::cur);
+
+		a_texture.Mips.resize(a_mipCount);
+		for (TextureMip& mip : a_texture.Mips) {
+			mip.Width = width;
+			mip.Height = height;
+			mip.Pixels.resize(BlockCompression::GetLevelSize(a_texture.Format, width, height));
+			a_file.read(reinterpret_cast<char*>(mip.Pixels.data()), mip.Pixels.size());
+			if (!a_file)
+				return false;
+			if (a_layout == TEXEL_BGRA8) {
+				for (size_t i = 0; i < mip.Pixels.size(); i += 4) {
+					std::swap(mip.Pixels[i], mip.Pixels[i + 2]);
+				}
+			}
+			width = (width > 1) ? width / 2 : 1;
+			height = (height > 1) ? height / 2 : 1;
+		}
+		return true;
+	}
+}
+
+//-------------------------------------------------------
+// Face-major layout: every mip of +X, then every mip of
+// -X, and so on
+//-------------------------------------------------------
+bool DDSFile::WriteCubemap(const std::string& a_fileName, const std::vector<CubemapImage>& a_mips)
+{
+	if (a_mips.empty() || a_mips[0].Size == 0)
+		return false;
+	for (size_t mip = 0; mip < a_mips.size(); mip++) {
+		unsigned int expectedSize = a_mips[0].Size >> mip;
+		if (a_mips[mip].Size != expectedSize || a_mips[mip].Texels.size() != (size_t)CUBEMAP_FACE_COUNT * expectedSize * expectedSize)
+			return false;
+	}
+
+	std::ofstream file(a_fileName, std::ios::binary);
+	if (!file)
+		return false;
+
+	DDSHeader header = MakeRGBA8Header(a_mips[0].Size, a_mips[0].Size, (unsigned int)a_mips.size());
+	header.Caps |= DDSCAPS_COMPLEX; // Set for cubes even without mips
+	header.Caps2 = DDSCAPS2_CUBEMAP_ALL_FACES;
+
+	uint32_t magic = DDS_MAGIC;
+	file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	std::vector<unsigned char> row;
+	for (unsigned int face = 0; face < CUBEMAP_FACE_COUNT; face++) {
+		for (const CubemapImage& mip : a_mips) {
+			row.resize((size_t)mip.Size * 4);
+			for (unsigned int y = 0; y < mip.Size; y++) {
+				const Vector4* texels = &mip.Texels[((size_t)face * mip.Size + y) * mip.Size];
+				for (unsigned int x = 0; x < mip.Size; x++) {
+					row[x * 4] = EncodeChannel(texels[x].x);
+					row[x * 4 + 1] = EncodeChannel(texels[x].y);
+					row[x * 4 + 2] = EncodeChannel(texels[x].z);
+					row[x * 4 + 3] = 255;
+				}
+				file.write(reinterpret_cast<const char*>(row.data()), row.size());
+			}
+		}
+	}
+	return (bool)file;
+}
+
+//-------------------------------------------------------
+// Reads a single uncompressed cube, all mips
+//-------------------------------------------------------
+bool DDSFile::ReadCubemap(const std::string& a_fileName, std::vector<CubemapImage>& a_mips)
+{
+	AssetFileStream file(a_fileName);
+	if (!file)
+		return false;
+
+	DDSHeader header = {};
+	TexelLayout layout = TEXEL_UNSUPPORTED;
+	bool bIsCube = false;
+	if (!ReadHeader(file, header, layout, bIsCube) || !bIsCube || header.Width != header.Height || layout >= TEXEL_BC1)
+		return false;
+
+	unsigned int texelBytes = layout == TEXEL_RGBA32F ? 16 : (layout == TEXEL_RGBA16F ? 8 : 4);
+	unsigned int mipCount = (header.Flags & DDSD_MIPMAPCOUNT) && header.MipMapCount > 0 ? header.MipMapCount : 1;
+	if ((header.Width >> (mipCount - 1)) == 0)
+		return false;
+
+	a_mips.assign(mipCount, CubemapImage());
+	for (unsigned int mip = 0; mip < mipCount; mip++) {
+		a_mips[mip].Size = header.Width >> mip;
+		a_mips[mip].Texels.resize((size_t)CUBEMAP_FACE_COUNT * a_mips[mip].Size * a_mips[mip].Size);
+	}
+
+	std::vector<unsigned char> row;
+	for (unsigned int face = 0; face < CUBEMAP_FACE_COUNT; face++) {
+		for (CubemapImage& mip : a_mips) {
+			row.resize((size_t)mip.Size * texelBytes);
+			for (unsigned int y = 0; y < mip.Size; y++) {
+				file.read(reinterpret_cast<char*>(row.data()), row.size());
+				if (!file)
+					return false;
+
+				Vector4* texels = &mip.Texels[((size_t)face * mip.Size + y) * mip.Size];
+				for (unsigned int x = 0; x < mip.Size; x++) {
+					const unsigned char* texel = &row[(size_t)x * texelBytes];
+					float r, g, b;
+					if (layout == TEXEL_RGBA32F) {
+						float channels[3];
+						std::memcpy(channels, texel, sizeof(channels));
+						r = channels[0];
+						g = channels[1];
+						b = channels[2];
+					}
+					else if (layout == TEXEL_RGBA16F) {
+						uint16_t channels[3];
+						std::memcpy(channels, texel, sizeof(channels));
+						r = HalfToFloat(channels[0]);
+						g = HalfToFloat(channels[1]);
+						b = HalfToFloat(channels[2]);
+					}
+					else {
+						bool bIsBGRA = layout == TEXEL_BGRA8;
+						r = texel[bIsBGRA ? 2 : 0] / 255.f;
+						g = texel[1] / 255.f;
+						b = texel[bIsBGRA ? 0 : 2] / 255.f;
+					}
+					texels[x] = Vector4(DecodeChannel(r), DecodeChannel(g), DecodeChannel(b), 1.f);
+				}
+			}
+		}
+	}
+	return true;
+}
+
+//-------------------------------------------------------
+// Every mip in order, rows tightly packed. RGBA8 uses the
+// legacy header and block compressed formats the DX10
+// one, which is the only way to name BC7
+//-------------------------------------------------------
+bool DDSFile::WriteTexture(const std::filesystem::path& a_fileName, const TextureData& a_texture, const uint32_t* a_userData)
+{
+	if (a_texture.Mips.empty() || a_texture.Mips[0].Width == 0 || a_texture.Mips[0].Height == 0)
+		return false;
+	unsigned int width = a_texture.Mips[0].Width;
+	unsigned int height = a_texture.Mips[0].Height;
+	for (const TextureMip& mip : a_texture.Mips) {
+		if (mip.Width != width || mip.Height != height || mip.Pixels.size() != BlockCompression::GetLevelSize(a_texture.Format, width, height))
+			return false;
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+
+	std::ofstream file(a_fileName, std::ios::binary);
+	if (!file)
+		return false;
+
+	uint32_t magic = DDS_MAGIC;
+	DDSHeader header = MakeRGBA8Header(a_texture.Mips[0].Width, a_texture.Mips[0].Height, (unsigned int)a_texture.Mips.size());
+	if (a_userData != nullptr)
+		std::copy(a_userData, a_userData + DDS_USER_DATA_COUNT, header.Reserved1);
+	DDSHeaderDX10 extension = {};
+	bool bCompressed = a_texture.Format != TextureFormat::RGBA8;
+	if (bCompressed) {
+		header.Flags = (header.Flags & ~DDSD_PITCH) | DDSD_LINEARSIZE;
+		header.PitchOrLinearSize = (uint32_t)a_texture.Mips[0].Pixels.size();
+		header.PixelFormat = {};
+		header.PixelFormat.Size = sizeof(DDSPixelFormat);
+		header.PixelFormat.Flags = DDPF_FOURCC;
+		header.PixelFormat.FourCC = DDS_FOURCC_DX10;
+		extension.DXGIFormat = a_texture.Format == TextureFormat::BC1 ? DDS_DXGI_BC1_UNORM
+			: a_texture.Format == TextureFormat::BC4 ? DDS_DXGI_BC4_UNORM
+			: a_texture.Format == TextureFormat::BC5 ? DDS_DXGI_BC5_UNORM
+			: DDS_DXGI_BC7_UNORM;
+		extension.ResourceDimension = DDS_DIMENSION_TEXTURE2D;
+		extension.ArraySize = 1;
+	}
+	file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (bCompressed)
+		file.write(reinterpret_cast<const char*>(&extension), sizeof(extension));
+	for (const TextureMip& mip : a_texture.Mips) {
+		file.write(reinterpret_cast<const char*>(mip.Pixels.data()), mip.Pixels.size());
+	}
+	return (bool)file;
+}
+
+//-------------------------------------------------------
+// Reads each mip straight into its TextureMip, only
+// swizzling when the file is BGRA
+//-------------------------------------------------------
+bool DDSFile::ReadTexture(const std::filesystem::path& a_fileName, TextureData& a_texture, uint32_t* a_userData)
+{
+	AssetFileStream file(a_fileName);
+	if (!file)
+		return false;
+
+	DDSHeader header = {};
+	TexelLayout layout = TEXEL_UNSUPPORTED;
+	unsigned int mipCount = 0;
+	if (!OpenTexture(file, header, layout, a_texture.Format, mipCount))
+		return false;
+	if (a_userData != nullptr)
+		std::copy(header.Reserved1, header.Reserved1 + DDS_USER_DATA_COUNT, a_userData);
+	return ReadLevels(file, header, layout, 0, mipCount, a_texture);
+}
+
+//-------------------------------------------------------
+// Header only, so streaming can size a texture before
+// deciding which levels to read
+//-------------------------------------------------------
+bool DDSFile::ReadTextureInfo(const std::filesystem::path& a_fileName, DDSTextureInfo& a_info)
+{
+	AssetFileStream file(a_fileName);
+	if (!file)
+		return false;
+
+	DDSHeader header = {};
+	TexelLayout layout = TEXEL_UNSUPPORTED;
+	if (!OpenTexture(file, header, layout, a_info.Format, a_info.MipCount))
+		return false;
+	a_info.Width = header.Width;
+	a_info.Height = header.Height;
+	return true;
+}
+
+//-------------------------------------------------------
+// Levels are stored finest first, so this seeks past the
+// levels before a_firstMip and reads only those asked for
+//-------------------------------------------------------
+bool DDSFile::ReadTextureMips(const std::filesystem::path& a_fileName, unsigned int a_firstMip, unsigned int a_mipCount, TextureData& a_texture)
+{
+	AssetFileStream file(a_fileName);
+	if (!file)
+		return false;
+
+	DDSHeader header = {};
+	TexelLayout layout = TEXEL_UNSUPPORTED;
+	unsigned int mipCount = 0;
+	if (!OpenTexture(file, header, layout, a_texture.Format, mipCount))
+		return false;
+	if (a_mipCount == 0 || a_firstMip >= mipCount || a_mipCount > mipCount - a_firstMip)
+		return false;
+	return ReadLevels(file, header, layout, a_firstMip, a_mipCount, a_texture);
+}
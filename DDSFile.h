@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Cubemap.h"
+#include "TextureMips.h"
+
+#define DDS_USER_DATA_COUNT 4 // 32 bit values a texture can carry in the header's reserved space, for its cooker
+
+// Size and layout of a 2D texture file, without its data
+struct DDSTextureInfo {
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+	unsigned int MipCount = 0;
+	TextureFormat Format = TextureFormat::RGBA8;
+};
+
+//-------------------------------------------------------
+// Minimal DDS reading and writing for CPU baked cubemaps
+// and cooked textures
+//	- Writes use the legacy header with R8G8B8A8_UNORM
+//	  masks, which DDSTextureLoader maps straight to that
+//	  format without any conversion
+//	- Cubes are gamma encoded (pow 1/2.2) on write, the
+//	  same encoding the GPU IBL passes produce, so the
+//	  existing shaders take the file as-is
+//	- Cube reads accept uncompressed RGBA8 / BGRA8 /
+//	  RGBA16F / RGBA32F (legacy or DX10 header) and decode
+//	  with pow 2.2, as the IBL shaders do when sampling
+//	- 2D textures are stored and read back byte for byte,
+//	  every mip included: RGBA8 (BGRA8 is swizzled on
+//	  read), or BC1/BC4/BC5/BC7 blocks with a DX10 header
+//	- Reads go through AssetFiles, so they're served from
+//	  a mounted archive when the file is in it
+//-------------------------------------------------------
+namespace DDSFile
+{
+	// a_mips[0] is the most detailed level. Every level must be a valid cube, each half the size of the last
+	bool WriteCubemap(const std::string& a_fileName, const std::vector<CubemapImage>& a_mips);
+
+	// Fills a_mips with every level stored in the file
+	bool ReadCubemap(const std::string& a_fileName, std::vector<CubemapImage>& a_mips);
+
+	// a_texture.Mips[0] is the most detailed level. Every level must halve the last, down to any size
+	//	- a_userData, when given, holds DDS_USER_DATA_COUNT values stored with the texture
+	bool WriteTexture(const std::filesystem::path& a_fileName, const TextureData& a_texture, const uint32_t* a_userData = nullptr);
+
+	// Fills a_texture with every level of an 8 bit or block compressed 2D texture
+	//	- a_userData, when given, receives the DDS_USER_DATA_COUNT values the file carries (zeros from other tools)
+	bool ReadTexture(const std::filesystem::path& a_fileName, TextureData& a_texture, uint32_t* a_userData = nullptr);
+
+	// Just the header of a texture ReadTexture would accept
+	bool ReadTextureInfo(const std::filesystem::path& a_fileName, DDSTextureInfo& a_info);
+
+	// a_mipCount levels from a_firstMip on, which become a_texture.Mips[0] onwards. For streaming mips in
+	bool ReadTextureMips(const std::filesystem::path& a_fileName, unsigned int a_firstMip, unsigned int a_mipCount, TextureData& a_texture);
+}
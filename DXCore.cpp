@@ -50,11 +50,8 @@ DXCore::DXCore(
 	dxFeatureLevel(D3D_FEATURE_LEVEL_11_0),
 	fpsTimeElapsed(0),
 	fpsFrameCount(0),
-	previousTime(0),
-	currentTime(0),
 	hasFocus(true),
 	deltaTime(0),
-	startTime(0),
 	totalTime(0),
 	hWnd(0)
 {
@@ -63,11 +60,6 @@ DXCore::DXCore(
 	//    it won't be able to directly interact with our DXCore object otherwise.
 	//  - (Yes, a singleton might be a safer choice here).
 	DXCoreInstance = this;
-
-	// Query performance counter for accurate timing information
-	__int64 perfFreq = 0;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&perfFreq);
-	perfCounterSeconds = 1.0 / (double)perfFreq;
 }
 
 // --------------------------------------------------------
@@ -394,11 +386,7 @@ HRESULT DXCore::Run()
 {
 	// Grab the start time now that
 	// the game loop is running
-	__int64 now = 0;
-	QueryPerformanceCounter((LARGE_INTEGER*)&now);
-	startTime = now;
-	currentTime = now;
-	previousTime = now;
+	frameClock.Reset();
 
 	// Give subclass a chance to initialize
 	Init();
@@ -451,26 +439,17 @@ void DXCore::Quit()
 
 
 // --------------------------------------------------------
-// Uses high resolution time stamps to get very accurate
-// timing information, and calculates useful time stats
+// Uses high resolution time stamps (through FrameClock) to get
+// very accurate timing information, and calculates useful time stats
+//  - FrameClock handles clamping negative deltas, which can
+//    happen if the CPU goes into power save mode or the process
+//    itself gets moved to another core
 // --------------------------------------------------------
 void DXCore::UpdateTimer()
 {
-	// Grab the current time
-	__int64 now = 0;
-	QueryPerformanceCounter((LARGE_INTEGER*)&now);
-	currentTime = now;
-
-	// Calculate delta time and clamp to zero
-	//  - Could go negative if CPU goes into power save mode 
-	//    or the process itself gets moved to another core
-	deltaTime = max((float)((currentTime - previousTime) * perfCounterSeconds), 0.0f);
-
-	// Calculate the total time from start to now
-	totalTime = (float)((currentTime - startTime) * perfCounterSeconds);
-
-	// Save current time for next frame
-	previousTime = currentTime;
+	frameClock.Tick();
+	deltaTime = frameClock.GetDeltaTime();
+	totalTime = frameClock.GetTotalTime();
 }
 
 
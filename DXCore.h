@@ -5,6 +5,8 @@
 #include <string>
 #include <wrl/client.h> // Used for ComPtr - a smart pointer for COM objects
 
+#include "FrameClock.h"
+
 // We can include the correct library files here
 // instead of in Visual Studio settings if we want
 #pragma comment(lib, "d3d11.lib")
@@ -80,12 +82,11 @@ protected:
 
 private:
 	// Timing related data
-	double perfCounterSeconds;
+	//	- FrameClock wraps the high resolution timer so the same
+	//	  timing code can drive headless (non-Windows) runs
+	FrameClock frameClock;
 	float totalTime;
 	float deltaTime;
-	__int64 startTime;
-	__int64 currentTime;
-	__int64 previousTime;
 
 	// FPS calculation
 	int fpsFrameCount;
@@ -49,7 +49,8 @@ void Entity::Update(float deltaTime)
 //    Shaders SHOULD be done through the Material,
 //    but it is easier to access the data here
 //-----------------------------------------------
-void Entity::Draw(Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, std::shared_ptr<Camera> a_mainCamera)
+void Entity::Draw(Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, std::shared_ptr<Camera> a_mainCamera,
+	const std::vector<MeshletDrawRange>* a_meshletRanges)
 {
 	std::shared_ptr<SimpleVertexShader> vertexShader = m_material->GetVertexShader();
 	std::shared_ptr<SimplePixelShader> pixelShader = m_material->GetPixelShader();
@@ -78,7 +79,11 @@ void Entity::Draw(Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, std:
 	vertexShader->CopyAllBufferData();
 	pixelShader->CopyAllBufferData();
 
-	m_mesh->Draw(); // Draws the Mesh with set data
+	// Draws the Mesh with set data
+	if (a_meshletRanges)
+		m_mesh->DrawRanges(*a_meshletRanges);
+	else
+		m_mesh->Draw(m_lod);
 }
 
 //-----------------------------------------------
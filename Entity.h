@@ -26,21 +26,29 @@ public:
 
 	// Core Functions
 	virtual void Update(float deltaTime);
-	virtual void Draw(Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, std::shared_ptr<Camera> a_mainCamera);
+	// a_meshletRanges draws only those parts of LOD 0 (see Meshlets::Cull), nullptr draws the current LOD whole
+	virtual void Draw(Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, std::shared_ptr<Camera> a_mainCamera,
+		const std::vector<MeshletDrawRange>* a_meshletRanges = nullptr);
 
 	// Setters (The internal Mesh is not intended to be reset at this time)
 	void SetTransform(Transform a_newTransform);
 	void SetMaterial(std::shared_ptr<Material> a_material);
+	void SetOccluder(bool a_bIsOccluder) { m_bIsOccluder = a_bIsOccluder; }
+	void SetLOD(unsigned int a_lod) { m_lod = a_lod; }
 
 	// Getters for internal data
 	Transform* GetTransform();
 	std::shared_ptr<Mesh> GetMesh();
 	std::shared_ptr<Material> GetMaterial();
+	bool IsOccluder() { return m_bIsOccluder; }
+	unsigned int GetLOD() { return m_lod; }
 
 protected:
 	float m_timeSinceCreation; // Recorded as an "object lifetime"
 	Transform m_transform;
 	std::shared_ptr<Mesh> m_mesh;
 	std::shared_ptr<Material> m_material;
+	bool m_bIsOccluder = false; // Rasterized into the CPU occlusion buffer. Best for large, solid, simple Meshes
+	unsigned int m_lod = 0; // Mesh LOD to draw, picked by the Renderer each frame. Kept so LOD changes can use hysteresis
 };
 
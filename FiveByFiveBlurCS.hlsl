@@ -16,11 +16,12 @@ cbuffer BlurData : register(b0)
 Texture2D BlurTarget : register(t0);
 RWTexture2D<unorm float4> BlurResult : register(u0);
 
-// Compute function to run a simple 4x4 box blur across the screen
+// Compute function to run a simple 5x5 box blur across the screen
 [numthreads(32, 32, 1)] // product of all dimensions must be <= 1024
 void main( uint3 DTid : SV_DispatchThreadID )
 {
 	float4 blur = float4(0.f, 0.f, 0.f, 0.f);
+	float sampleCount = 0.f; // Fewer than 25 near the edges of the screen
 	
 	// 5x5 loop around this pixel
 	for (int x = (int)DTid.x - 2; x <= (int)DTid.x + 2; x++) {
@@ -31,9 +32,10 @@ void main( uint3 DTid : SV_DispatchThreadID )
 			if (y < 0 || y >= c_windowDimensions.y) continue;
 
 			blur += BlurTarget[int2(x, y)]; // Blurs all channels. Greyscale images (like SSAO result) are not affected
+			sampleCount += 1.f;
 		}
 	}
 
-	blur /= 16.f; // Average from 16 samples
+	blur /= sampleCount; // Average of the samples actually taken
 	BlurResult[DTid.xy] = float4(blur.rgb, 1.f); // Cut alpha
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "FrameClock.h"
+
+//-----------------------------------------------
+// Clock starts in variable timestep mode
+//-----------------------------------------------
+FrameClock::FrameClock()
+	: m_fixedTimestep(0.0)
+	, m_deltaTime(0.0)
+	, m_totalTime(0.0)
+	, m_wallFrameSeconds(0.0)
+	, m_frameCount(0)
+{
+	Reset();
+}
+
+//-----------------------------------------------
+// Restart timing from right now. Called when the
+// game loop actually starts, so that loading time
+// is not counted as the first frame's delta
+//-----------------------------------------------
+void FrameClock::Reset()
+{
+	m_startTime = Clock::now();
+	m_previousTime = m_startTime;
+	m_deltaTime = 0.0;
+	m_totalTime = 0.0;
+	m_wallFrameSeconds = 0.0;
+	m_frameCount = 0;
+}
+
+//-----------------------------------------------
+// Advance the clock by one frame
+//	- Variable mode: delta is the wall-clock time since
+//	  the last Tick, clamped to zero (can go negative if
+//	  the process gets moved to another core)
+//	- Fixed mode: delta is always the fixed timestep
+//-----------------------------------------------
+void FrameClock::Tick()
+{
+	Clock::time_point now = Clock::now();
+	m_wallFrameSeconds = std::chrono::duration<double>(now - m_previousTime).count();
+	if (m_wallFrameSeconds < 0.0)
+		m_wallFrameSeconds = 0.0;
+	m_previousTime = now;
+
+	if (IsFixedTimestep()) {
+		m_deltaTime = m_fixedTimestep;
+		m_totalTime += m_fixedTimestep;
+	}
+	else {
+		m_deltaTime = m_wallFrameSeconds;
+		m_totalTime = std::chrono::duration<double>(now - m_startTime).count();
+	}
+	m_frameCount++;
+}
+
+//-----------------------------------------------
+// Switch between fixed and variable timesteps.
+// Negative values are treated as variable
+//-----------------------------------------------
+void FrameClock::SetFixedTimestep(double a_seconds)
+{
+	m_fixedTimestep = (a_seconds > 0.0) ? a_seconds : 0.0;
+}
+
+//-----------------------------------------------
+// Real elapsed time since the clock was reset
+//-----------------------------------------------
+double FrameClock::GetWallSecondsSinceReset() const
+{
+	return std::chrono::duration<double>(Clock::now() - m_startTime).count();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+
+//-------------------------------------------------------
+// Portable frame timer, replacing the raw QueryPerformanceCounter
+// timer that used to live directly in DXCore.
+//	- Built on std::chrono::steady_clock, so it runs on any
+//	  platform (including headless Linux builds)
+//	- Supports a fixed-timestep mode, where every Tick()
+//	  advances time by exactly the same amount regardless of
+//	  the wall clock. This makes headless runs deterministic,
+//	  which matters for regression-testing CPU frame cost
+//	- The wall-clock duration of the last frame is always
+//	  tracked, even in fixed mode, since that is what gets profiled
+//-------------------------------------------------------
+class FrameClock
+{
+public:
+	FrameClock();
+
+	void Reset();
+	void Tick();
+
+	// A timestep of 0 (the default) means variable, wall-clock driven time
+	void SetFixedTimestep(double a_seconds);
+	double GetFixedTimestep() const { return m_fixedTimestep; }
+	bool IsFixedTimestep() const { return m_fixedTimestep > 0.0; }
+
+	float GetDeltaTime() const { return (float)m_deltaTime; }
+	float GetTotalTime() const { return (float)m_totalTime; }
+	double GetWallFrameSeconds() const { return m_wallFrameSeconds; }
+	unsigned long long GetFrameCount() const { return m_frameCount; }
+
+	// Wall-clock time since Reset(), independent of fixed-timestep simulation time
+	double GetWallSecondsSinceReset() const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point m_startTime;
+	Clock::time_point m_previousTime;
+
+	double m_fixedTimestep;
+	double m_deltaTime;
+	double m_totalTime;
+	double m_wallFrameSeconds;
+	unsigned long long m_frameCount;
+};
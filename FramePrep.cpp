@@ -0,0 +1,130 @@
+#include "FramePrep.h"
+
+//----------------------------------------------------
+// Sort Lights by type (passed around as a single array
+// to minimize parameters)
+//----------------------------------------------------
+void FramePrep::BinLightsByType(const std::vector<BasicLight>& a_allLights,
+	std::vector<BasicLight>& a_directionalLights, std::vector<BasicLight>& a_pointLights)
+{
+	a_directionalLights.clear();
+	a_pointLights.clear();
+	for (const BasicLight& light : a_allLights) {
+		if (light.Type == LightType::Directional) {
+			a_directionalLights.push_back(light);
+		}
+		else if (light.Type == LightType::Point) {
+			a_pointLights.push_back(light);
+		}
+		// else do nothing (all other types) - no spot lights have been implemented YET
+	}
+}
+
+//----------------------------------------------------
+// Pack state ids and quantized depth into one key
+//----------------------------------------------------
+unsigned long long FramePrep::MakeOpaqueSortKey(unsigned int a_shaderId, unsigned int a_materialId, unsigned int a_meshId,
+	float a_viewDepth, float a_farPlane)
+{
+	const unsigned long long depthMax = (1ull << SORT_KEY_DEPTH_BITS) - 1;
+	float normalizedDepth = a_farPlane > 0.f ? a_viewDepth / a_farPlane : 0.f;
+	if (!(normalizedDepth > 0.f)) // Also catches NaN
+		normalizedDepth = 0.f;
+	if (normalizedDepth > 1.f)
+		normalizedDepth = 1.f;
+	unsigned long long depth = (unsigned long long)(normalizedDepth * (float)depthMax);
+
+	unsigned long long key = a_shaderId & ((1u << SORT_KEY_SHADER_BITS) - 1);
+	key = (key << SORT_KEY_MATERIAL_BITS) | (a_materialId & ((1u << SORT_KEY_MATERIAL_BITS) - 1));
+	key = (key << SORT_KEY_MESH_BITS) | (a_meshId & ((1u << SORT_KEY_MESH_BITS) - 1));
+	key = (key << SORT_KEY_DEPTH_BITS) | depth;
+	return key;
+}
+
+//----------------------------------------------------
+// Radix sort draw items by key
+//	- Counting pass gathers all 8 histograms at once, then
+//	  each pass that actually has more than one bucket in
+//	  use scatters between the two arrays
+//----------------------------------------------------
+void FramePrep::SortDrawItems(std::vector<DrawItem>& a_items, std::vector<DrawItem>& a_scratch)
+{
+	const size_t count = a_items.size();
+	if (count < 2)
+		return;
+
+	unsigned int histograms[8][256] = {};
+	for (const DrawItem& item : a_items) {
+		for (int pass = 0; pass < 8; pass++) {
+			histograms[pass][(item.SortKey >> (pass * 8)) & 0xFF]++;
+		}
+	}
+
+	a_scratch.resize(count);
+	DrawItem* source = a_items.data();
+	DrawItem* destination = a_scratch.data();
+	for (int pass = 0; pass < 8; pass++) {
+		unsigned int* histogram = histograms[pass];
+
+		// Skip the pass if every key lands in the same bucket
+		bool bIsTrivial = false;
+		for (int bucket = 0; bucket < 256; bucket++) {
+			if (histogram[bucket] != 0) {
+				bIsTrivial = histogram[bucket] == count;
+				break;
+			}
+		}
+		if (bIsTrivial)
+			continue;
+
+		// Exclusive prefix sum into bucket offsets
+		unsigned int offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++) {
+			unsigned int bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			unsigned int bucket = (source[i].SortKey >> (pass * 8)) & 0xFF;
+			destination[histogram[bucket]++] = source[i];
+		}
+
+		DrawItem* swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	// An odd number of real passes leaves the result in scratch
+	if (source != a_items.data())
+		a_items.swap(a_scratch);
+}
+
+//----------------------------------------------------
+// Step one LOD at a time from the current one, with
+// the threshold widened in the direction of travel
+//----------------------------------------------------
+unsigned int FramePrep::SelectLOD(const float* a_lodErrors, unsigned int a_lodCount, float a_worldScale, float a_distance,
+	float a_pixelsPerUnit, float a_pixelThreshold, float a_hysteresis, unsigned int a_currentLOD)
+{
+	if (a_lodCount <= 1)
+		return 0;
+
+	// Inside the bounds (or behind the camera) always gets full detail
+	if (!(a_distance > 0.f))
+		return 0;
+
+	float pixelsPerError = a_worldScale * a_pixelsPerUnit / a_distance;
+	unsigned int lod = a_currentLOD < a_lodCount ? a_currentLOD : a_lodCount - 1;
+
+	// Coarser while the next LOD is comfortably under the threshold
+	while (lod + 1 < a_lodCount && a_lodErrors[lod + 1] * pixelsPerError <= a_pixelThreshold * (1.f - a_hysteresis)) {
+		lod++;
+	}
+
+	// Finer while the current LOD is clearly over it
+	while (lod > 0 && a_lodErrors[lod] * pixelsPerError > a_pixelThreshold * (1.f + a_hysteresis)) {
+		lod--;
+	}
+	return lod;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include "Lights.h"
+
+//-------------------------------------------------------
+// CPU-side frame preparation that is shared by the D3D11
+// Renderer and the headless driver
+//	- Nothing in here touches a graphics API, so the cost of
+//	  these steps can be profiled on any machine
+//-------------------------------------------------------
+
+// One entry in a draw list. Index refers back into whatever array the caller built the list from
+struct DrawItem {
+	unsigned long long SortKey;
+	unsigned int Index;
+};
+
+// Bits per field of an opaque sort key, most significant first
+//	- Shader changes are the most expensive, then Material (textures/constants), then Mesh (buffers)
+//	- Depth is last, front to back within identical state, to help early-z
+#define SORT_KEY_SHADER_BITS	12
+#define SORT_KEY_MATERIAL_BITS	16
+#define SORT_KEY_MESH_BITS		16
+#define SORT_KEY_DEPTH_BITS		20
+
+namespace FramePrep
+{
+	// Split lights by type, as the shaders take separate arrays for each
+	//	- Spot lights are not implemented yet, so they are dropped
+	//	- Output vectors are cleared first, but keep their capacity between frames
+	void BinLightsByType(const std::vector<BasicLight>& a_allLights,
+		std::vector<BasicLight>& a_directionalLights, std::vector<BasicLight>& a_pointLights);
+
+	// Build a key that sorts opaque draws by state, then front to back
+	//	- Ids wrap if they exceed their bit width, which only costs sort quality
+	//	- a_viewDepth is normalized against a_farPlane and clamped
+	unsigned long long MakeOpaqueSortKey(unsigned int a_shaderId, unsigned int a_materialId, unsigned int a_meshId,
+		float a_viewDepth, float a_farPlane);
+
+	// Stable LSD radix sort on the full 64-bit key (8 bits per pass)
+	//	- Passes where every key has the same byte are skipped, which
+	//	  is most of them for small scenes
+	//	- a_scratch is resized as needed and can be reused between frames
+	void SortDrawItems(std::vector<DrawItem>& a_items, std::vector<DrawItem>& a_scratch);
+
+	// Coarsest LOD whose error, projected to pixels, stays under a_pixelThreshold
+	//	- a_lodErrors are object space and non-decreasing, with LOD 0 first
+	//	- a_pixelsPerUnit is screen height / (2 * tan(fov / 2)), the pixels covered by one unit at distance one
+	//	- a_hysteresis is a fraction of the threshold. Moving to a coarser LOD needs the error to fit under
+	//	  (1 - a_hysteresis) of it and moving to a finer one needs the current LOD to exceed (1 + a_hysteresis),
+	//	  so objects sitting right on a boundary don't flicker between LODs
+	unsigned int SelectLOD(const float* a_lodErrors, unsigned int a_lodCount, float a_worldScale, float a_distance,
+		float a_pixelsPerUnit, float a_pixelThreshold, float a_hysteresis, unsigned int a_currentLOD);
+}
@@ -2,6 +2,10 @@
 #include "Vertex.h"
 #include "Input.h"
 #include "Helpers.h"
+#include "Hashing.h"
+#include "AssetFiles.h"
+#include "IBLCacheD3D11.h"
+#include "BRDFLookupTableData.h"
 
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_win32.h"
@@ -11,6 +15,8 @@
 #pragma comment(lib, "d3dcompiler.lib")
 #include <d3dcompiler.h>
 #include <ctime> // For seeding C Random generator with current time
+#include <algorithm>
+#include <cmath>
 
 #include "WICTextureLoader.h"
 #include "DDSTextureLoader.h"
@@ -18,6 +24,11 @@
 // For the DirectX Math library
 using namespace DirectX;
 
+#define IBL_CACHE_DIRECTORY L"IBLCache" // Next to the executable. Safe to delete, and to share between instances
+#define IBL_BRDF_LUT_SIZE 1024 // Reasonable size (used in Cascioli sample code)
+#define IBL_BRDF_LUT_EMBEDDED 1 // Use BRDFLookupTableData.h instead of rendering the table at IBL_BRDF_LUT_SIZE
+#define GAME_TEXTURE_BUDGET_BYTES (64ull << 20) // Streamed material textures. Far more than the demo scene needs at 1K
+
 // --------------------------------------------------------
 // Constructor
 //
@@ -56,6 +67,8 @@ Game::~Game()
 	// Call Release() on any Direct3D objects made within this class
 	// - Note: this is unnecessary for D3D objects stored in ComPtrs
 
+	ReleaseAssets();
+
 	// Clean up ImGUI
 	ImGui_ImplDX11_Shutdown();
 	ImGui_ImplWin32_Shutdown();
@@ -77,6 +90,9 @@ void Game::Init()
 	//	- Moved here to be set before the Skybox is generated, for Irradiance calculation
 	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
+	// Wrap the device and context for anything that only needs to submit geometry (Meshes)
+	m_renderDevice = std::make_shared<D3D11RenderDevice>(device, context);
+
 	// Set up ImGUI
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -84,6 +100,21 @@ void Game::Init()
 	ImGui_ImplDX11_Init(device.Get(), context.Get());
 	ImGui::StyleColorsClassic(); // Or Dark or Light
 
+	// Serve meshes and textures from a packed archive of the assets folder when one has been built (see the archive
+	// headless command). Anything not in it, or everything when there is none, is read loose
+	AssetFiles::Mount(FixPath(L"../../assets" ASSET_ARCHIVE_EXTENSION), FixPath(L"../../assets"));
+
+	// Start decoding textures as early as possible. The sky goes first, since the IBL bake needs it during setup
+	//	- Cooked material textures stream their mips in as they get close enough to need them
+	m_textureLoader = std::make_shared<TextureLoader>(device);
+	TextureStreamerSettings streamingSettings;
+	streamingSettings.BudgetBytes = GAME_TEXTURE_BUDGET_BYTES;
+	m_textureLoader->EnableStreaming(streamingSettings);
+	skyTextureRequest = m_textureLoader->LoadCube(L"../../assets/materials/skies/Clouds Blue", nullptr);
+
+	// Meshes, shaders, samplers and material textures are loaded through here, once each
+	m_assets = std::make_shared<AssetManager>(device, context, m_renderDevice, m_textureLoader);
+
 	// Helper methods for loading shaders, creating some basic
 	// geometry to draw and some simple camera matrices.
 	//  - You'll be expanding and/or replacing these later
@@ -93,13 +124,20 @@ void Game::Init()
 	GenerateEntities();
 	CreateLights();
 
+	// Index every Entity's bounds for culling, picking and proximity queries
+	for (unsigned int i = 0; i < entities.size(); i++) {
+		entityProxies.push_back(entityTree.CreateProxy(GetEntityBounds(i), i));
+	}
+	occlusionBuffer.Resize(OCCLUSION_DEFAULT_WIDTH, OCCLUSION_DEFAULT_WIDTH * windowHeight / windowWidth);
+
 	// Create Renderer (MUST be done after LoadShaders so BRDF Texture is loaded
-	m_renderer = std::make_shared<Renderer>(device, context, swapChain, backBufferRTV, 
-		depthBufferDSV, iblBRDFLookupTexture, fullscreenTriangleVertexShader, windowWidth, windowHeight);
+	m_renderer = std::make_shared<Renderer>(device, context, m_renderDevice, swapChain, backBufferRTV, 
+		depthBufferDSV, iblBRDFLookupTexture, m_assets->Get(fullscreenTriangleVertexShader), windowWidth, windowHeight);
 
 	// Test a Reflection Probe
-	//std::shared_ptr<ReflectionProbe> probe = std::make_shared<ReflectionProbe>(100.f, Vector3(0.f, 0.f, -10.f), vertexShader, fullscreenTriangleVertexShader, pixelShader, envPrefilterPixelShader, device);
+	//std::shared_ptr<ReflectionProbe> probe = std::make_shared<ReflectionProbe>(100.f, Vector3(0.f, 0.f, -10.f), m_assets->Get(vertexShader), m_assets->Get(fullscreenTriangleVertexShader), m_assets->Get(pixelShader), m_assets->Get(envPrefilterPixelShader), device);
 	//reflectionProbes.push_back(probe);
+	//probeScheduler.AddProbe(probe->GetPostiion(), probe->GetRadius(), probe->GetMipCount());
 	
 	// Create Camera some units behind the origin
 	Transform cameraTransform = Transform::ZeroTransform;
@@ -120,15 +158,15 @@ void Game::Init()
 // --------------------------------------------------------
 void Game::LoadShaders()
 {
-	vertexShader = std::make_shared<SimpleVertexShader>(device, context, FixPath(L"VertexShader.cso").c_str());
-	pixelShader = std::make_shared<SimplePixelShader>(device, context, FixPath(L"PixelShader.cso").c_str());
-	customPixelShader = std::make_shared<SimplePixelShader>(device, context, FixPath(L"ProceduralPixelShader.cso").c_str());
-	skyVertexShader = std::make_shared<SimpleVertexShader>(device, context, FixPath(L"SkyVertexShader.cso").c_str());
-	skyPixelShader = std::make_shared<SimplePixelShader>(device, context, FixPath(L"SkyPixelShader.cso").c_str());
-	fullscreenTriangleVertexShader = std::make_shared<SimpleVertexShader>(device, context, FixPath(L"FullscreenTriangleVS.cso").c_str());
-	irradiancePixelShader = std::make_shared<SimplePixelShader>(device, context, FixPath(L"IBLIrradianceMapPS.cso").c_str());
-	envPrefilterPixelShader = std::make_shared<SimplePixelShader>(device, context, FixPath(L"IBLSpecularPrefilterPS.cso").c_str());
-	brdfLookupMapPixelShader = std::make_shared<SimplePixelShader>(device, context, FixPath(L"IBlBRDFIntegrateMapPS.cso").c_str());
+	vertexShader = m_assets->LoadVertexShader(L"VertexShader.cso");
+	pixelShader = m_assets->LoadPixelShader(L"PixelShader.cso");
+	customPixelShader = m_assets->LoadPixelShader(L"ProceduralPixelShader.cso");
+	skyVertexShader = m_assets->LoadVertexShader(L"SkyVertexShader.cso");
+	skyPixelShader = m_assets->LoadPixelShader(L"SkyPixelShader.cso");
+	fullscreenTriangleVertexShader = m_assets->LoadVertexShader(L"FullscreenTriangleVS.cso");
+	irradiancePixelShader = m_assets->LoadPixelShader(L"IBLIrradianceMapPS.cso");
+	envPrefilterPixelShader = m_assets->LoadPixelShader(L"IBLSpecularPrefilterPS.cso");
+	brdfLookupMapPixelShader = m_assets->LoadPixelShader(L"IBlBRDFIntegrateMapPS.cso");
 
 	// Create Shader resources univeral to the Game
 	CreateIBLBRDFLookupTable();
@@ -140,13 +178,14 @@ void Game::LoadShaders()
 void Game::LoadGeometry()
 {
 	// Load default files provided in A6
-	geometry.push_back(std::make_shared<Mesh>(FixPath(L"../../assets/meshes/cube.obj").c_str(), device, context));
-	geometry.push_back(std::make_shared<Mesh>(FixPath(L"../../assets/meshes/cylinder.obj").c_str(), device, context));
-	geometry.push_back(std::make_shared<Mesh>(FixPath(L"../../assets/meshes/helix.obj").c_str(), device, context));
-	geometry.push_back(std::make_shared<Mesh>(FixPath(L"../../assets/meshes/sphere.obj").c_str(), device, context));
-	geometry.push_back(std::make_shared<Mesh>(FixPath(L"../../assets/meshes/torus.obj").c_str(), device, context));
-	geometry.push_back(std::make_shared<Mesh>(FixPath(L"../../assets/meshes/quad.obj").c_str(), device, context));
-	geometry.push_back(std::make_shared<Mesh>(FixPath(L"../../assets/meshes/quad_double_sided.obj").c_str(), device, context));
+	geometry.push_back(m_assets->LoadMesh(L"../../assets/meshes/cube.obj"));
+	geometry.push_back(m_assets->LoadMesh(L"../../assets/meshes/cylinder.obj"));
+	// The denser Meshes are split into Meshlets for per-cluster culling
+	geometry.push_back(m_assets->LoadMesh(L"../../assets/meshes/helix.obj", true));
+	geometry.push_back(m_assets->LoadMesh(L"../../assets/meshes/sphere.obj", true));
+	geometry.push_back(m_assets->LoadMesh(L"../../assets/meshes/torus.obj", true));
+	geometry.push_back(m_assets->LoadMesh(L"../../assets/meshes/quad.obj"));
+	geometry.push_back(m_assets->LoadMesh(L"../../assets/meshes/quad_double_sided.obj"));
 }
 
 // --------------------------------------------------------
@@ -163,20 +202,38 @@ void Game::GenerateEntities()
 	desc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
 	desc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
 	desc.MaxLOD = D3D11_FLOAT32_MAX;
-	Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState;
-	device->CreateSamplerState(&desc, samplerState.GetAddressOf());
+	samplerHandles.push_back(m_assets->CreateSampler(desc));
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState = m_assets->Get(samplerHandles.back());
+	m_textureLoader->Wait(skyTextureRequest); // Just the sky faces. The materials keep loading behind the first frames
+	m_textureLoader->ProcessUploads();
 	sky = std::make_shared<Sky>(
 		device,
-		geometry[0],
-		LoadTextureCube(L"../../assets/materials/skies/Clouds Blue"),
+		m_assets->Get(geometry[0]),
+		m_textureLoader->GetSRV(skyTextureRequest),
 		samplerState,
-		skyVertexShader,
-		skyPixelShader);
-	sky->CreateEnvironmentMap(device, context, fullscreenTriangleVertexShader, irradiancePixelShader);
-	sky->CreateSpecularReflectanceMap(device, context, fullscreenTriangleVertexShader, envPrefilterPixelShader);
+		m_assets->Get(skyVertexShader),
+		m_assets->Get(skyPixelShader));
+
+	// Skip IBL generation entirely when a previous run cached the products for this exact sky and shaders
+	std::wstring bakedSpecularFile = FixPath(L"../../assets/materials/skies/Clouds Blue/specular.dds");
+	std::vector<std::string> iblDependencies = {
+		WideToNarrow(FixPath(L"IBLIrradianceMapPS.cso")),
+		WideToNarrow(FixPath(L"IBLSpecularPrefilterPS.cso")),
+		WideToNarrow(bakedSpecularFile) };
+	bool bIsCacheable = false;
+	uint64_t skyKey = sky->ComputeIBLCacheKey(device, context, iblDependencies, bIsCacheable);
+	std::string skyCacheFile = IBLCache::GetFileName(WideToNarrow(FixPath(IBL_CACHE_DIRECTORY)), "sky", skyKey);
+	if (!bIsCacheable || !sky->LoadIBLCache(device, skyCacheFile, skyKey)) {
+		sky->CreateIrradianceSH(device, context, m_assets->Get(fullscreenTriangleVertexShader), m_assets->Get(irradiancePixelShader));
+		// Prefer a reflectance map baked offline by the headless tool - prefiltering on the GPU takes seconds
+		if (!sky->LoadSpecularReflectanceMap(device, bakedSpecularFile))
+			sky->CreateSpecularReflectanceMap(device, context, m_assets->Get(fullscreenTriangleVertexShader), m_assets->Get(envPrefilterPixelShader));
+		if (bIsCacheable)
+			sky->SaveIBLCache(device, context, skyCacheFile, skyKey);
+	}
 
 	// Generate a fancy cube just above world origin
-	//entities.push_back(std::make_shared<Entity>(geometry[0], materials[materials.size()-1]));
+	//entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[0]), materials[materials.size()-1]));
 	//entities[0]->GetTransform()->AddAbsolutePosition(0.f, 3.f, 0.f);
 	//entities[0]->GetTransform()->SetAbsoluteRotation(0.f, XM_PIDIV4, XM_PIDIV4);
 
@@ -188,23 +245,24 @@ void Game::GenerateEntities()
 		xPosition += entityOffset; // Increment position for the line
 	
 		// Create and edit entity
-		//std::shared_ptr<Entity> entity = std::make_shared<Entity>(geometry[i], materials[(UINT)GenerateRandomFloat(0.f, (float)materials.size()-1.f)]);
-		std::shared_ptr<Entity> entity = std::make_shared<Entity>(geometry[3], materials[i]);
+		//std::shared_ptr<Entity> entity = std::make_shared<Entity>(m_assets->Get(geometry[i]), materials[(UINT)GenerateRandomFloat(0.f, (float)materials.size()-1.f)]);
+		std::shared_ptr<Entity> entity = std::make_shared<Entity>(m_assets->Get(geometry[3]), materials[i]);
 		entity->GetTransform()->SetAbsolutePosition(xPosition, 0.f, 0.f); // Offset down so planes are visible from origin camera
+		entity->SetOccluder(true); // The front row hides the IBL rows from side-on views
 		entities.push_back(entity);
 	}
 	// Create upper and lower rows of IBL Demo spheres
 	xPosition = 6.f * -(entityOffset / 2.f) - (entityOffset / 2.f);
 	for (size_t i = materials.size() - 13; i < materials.size() - 7; i++) {
 		xPosition += entityOffset;
-		std::shared_ptr<Entity> entity = std::make_shared<Entity>(geometry[3], materials[i]);
+		std::shared_ptr<Entity> entity = std::make_shared<Entity>(m_assets->Get(geometry[3]), materials[i]);
 		entity->GetTransform()->SetAbsolutePosition(xPosition, entityOffset, 0.f);
 		entities.push_back(entity);
 	}
 	xPosition = 6.f * -(entityOffset / 2.f) - (entityOffset / 2.f);
 	for (size_t i = materials.size() - 7; i < materials.size() - 1; i++) {
 		xPosition += entityOffset;
-		std::shared_ptr<Entity> entity = std::make_shared<Entity>(geometry[3], materials[i]);
+		std::shared_ptr<Entity> entity = std::make_shared<Entity>(m_assets->Get(geometry[3]), materials[i]);
 		entity->GetTransform()->SetAbsolutePosition(xPosition, -entityOffset, 0.f);
 		entities.push_back(entity);
 	}
@@ -214,65 +272,65 @@ void Game::GenerateEntities()
 	{
 		int counter = 0; // Counter for current Entity
 		// Floor
-		entities.push_back(std::make_shared<Entity>(geometry[3], materials[3]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[3]), materials[3]));
 		entities[counter]->GetTransform()->AddAbsolutePosition(0.f, -1.f, 0.f);
 		entities[counter]->GetTransform()->SetAbsoluteScale(3.25f, 1.f, 4.25f);
 
 		// Columns
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[1], materials[5]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[1]), materials[5]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.2f, 1.25f, .2f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(3.f, .25f, -4.f);
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[1], materials[5]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[1]), materials[5]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.2f, 1.25f, .2f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(-3.f, .25f, -4.f);
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[1], materials[5]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[1]), materials[5]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.2f, 1.25f, .2f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(3.f, .25f, 4.f);
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[1], materials[5]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[1]), materials[5]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.2f, 1.25f, .2f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(-3.f, .25f, 4.f);
 
 		// Spheres
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[2], materials[4]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[2]), materials[4]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.4f, .4f, .4f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(3.f, 1.75f, -4.f);
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[2], materials[4]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[2]), materials[4]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.4f, .4f, .4f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(-3.f, 1.75f, -4.f);
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[2], materials[4]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[2]), materials[4]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.4f, .4f, .4f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(3.f, 1.75f, 4.f);
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[2], materials[4]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[2]), materials[4]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.4f, .4f, .4f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(-3.f, 1.75f, 4.f);
 
 		// Table
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[1], materials[1]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[1]), materials[1]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.1f, .25f, .1f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(1.f, -.75f, -1.5f);
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[1], materials[1]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[1]), materials[1]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.1f, .25f, .1f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(-1.f, -.75f, -1.5f);
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[1], materials[1]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[1]), materials[1]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.1f, .25f, .1f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(1.f, -.75f, 1.5f);
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[1], materials[1]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[1]), materials[1]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(.1f, .25f, .1f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(-1.f, -.75f, 1.5f);
 		counter++;
-		entities.push_back(std::make_shared<Entity>(geometry[0], materials[0]));
+		entities.push_back(std::make_shared<Entity>(m_assets->Get(geometry[0]), materials[0]));
 		entities[counter]->GetTransform()->SetAbsoluteScale(1.3f, .03f, 1.8f);
 		entities[counter]->GetTransform()->SetAbsolutePosition(0.f, -.5f, 0.f);
 	}
@@ -285,89 +343,94 @@ void Game::GenerateEntities()
 void Game::CreateMaterials()
 {
 	// Default Textures
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> defaultNormalSRV =
-		LoadTexture(L"../../assets/materials/flat_normals.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> fullNonMetalSRV =
-		LoadTexture(L"../../assets/materials/no_metal.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> fullMetalSRV =
-		LoadTexture(L"../../assets/materials/full_metal.png");
+	textureHandles.push_back(m_assets->LoadTexture(L"../../assets/materials/flat_normals.png", nullptr, true));
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> defaultNormalSRV = m_assets->Get(textureHandles.back());
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> whiteSRV = m_textureLoader->CreateSolidColor(XMFLOAT4(1.f, 1.f, 1.f, 1.f));
+
+	// Everything else decodes in the background. Materials show these placeholders until their uploads
+	//	- Default textures double as the placeholders for their channel, so a missing file simply keeps the default
+	//	- Roughness and metalness (and occlusion, had any set one) are packed into one texture per Material. Sets
+	//	  without a metalness map, and maps holding one value, become Material constants instead
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> albedoPlaceholderSRV =
+		m_textureLoader->CreateSolidColor(XMFLOAT4(.5f, .5f, .5f, 1.f));
 
 	// Textures from AmbientCG.com
 	// - They have 2 normal maps - GL and DX. I assume that is OpenGL vs. DirectX for handedness, since the normals appear inverted
 	// - Surface color is NOT gamma-corrected, so "reversing" the auto gamma correction in the PS after sampling just makes the
 	//	 texture darker
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> marbleSRV =
-		LoadTexture(L"../../assets/materials/Marble023_1K/Marble023_1K_Color.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> marbleNormalSRV =
-		LoadTexture(L"../../assets/materials/Marble023_1K/Marble023_1K_NormalDX.png"); 
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> marbleRoughnessSRV =
-		LoadTexture(L"../../assets/materials/Marble023_1K/Marble023_1K_Roughness.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> marbleMetalnessSRV =
-		LoadTexture(L"../../assets/materials/Marble023_1K/Marble023_1K_Metalness.png");
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalPlatesSRV =
-		LoadTexture(L"../../assets/materials/MetalPlates006_1K/MetalPlates006_1K_Color.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalPlatesNormalSRV =
-		LoadTexture(L"../../assets/materials/MetalPlates006_1K/MetalPlates006_1K_NormalDX.png"); 
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalPlatesRoughnessSRV =
-		LoadTexture(L"../../assets/materials/MetalPlates006_1K/MetalPlates006_1K_Roughness.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalPlatesMetalnessSRV =
-		LoadTexture(L"../../assets/materials/MetalPlates006_1K/MetalPlates006_1K_Metalness.png");
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodSRV = 
-		LoadTexture(L"../../assets/materials/Wood058_1K/Wood058_1K_Color.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodNormalSRV =
-		LoadTexture(L"../../assets/materials/Wood058_1K/Wood058_1K_NormalDX.png"); 
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodRoughnessSRV =
-		LoadTexture(L"../../assets/materials/Wood058_1K/Wood058_1K_Roughness.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodMetalnessSRV =
-		LoadTexture(L"../../assets/materials/Wood058_1K/Wood058_1K_Metalness.png");
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalSRV =
-		LoadTexture(L"../../assets/materials/Metal032_1K/Metal032_1K_Color.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalNormalSRV =
-		LoadTexture(L"../../assets/materials/Metal032_1K/Metal032_1K_NormalDX.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalRoughnessSRV =
-		LoadTexture(L"../../assets/materials/Metal032_1K/Metal032_1K_Roughness.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalMetalnessSRV =
-		LoadTexture(L"../../assets/materials/Metal032_1K/Metal032_1K_Metalness.png");
+	TextureHandle marbleTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Marble023_1K/Marble023_1K_Color.png", albedoPlaceholderSRV);
+	TextureHandle marbleNormalTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Marble023_1K/Marble023_1K_NormalDX.png", defaultNormalSRV); 
+	TextureHandle marbleORMTexture =
+		m_assets->LoadORM(L"", L"../../assets/materials/Marble023_1K/Marble023_1K_Roughness.png",
+			L"../../assets/materials/Marble023_1K/Marble023_1K_Metalness.png");
+
+	TextureHandle metalPlatesTexture =
+		m_assets->LoadTexture(L"../../assets/materials/MetalPlates006_1K/MetalPlates006_1K_Color.png", albedoPlaceholderSRV);
+	TextureHandle metalPlatesNormalTexture =
+		m_assets->LoadTexture(L"../../assets/materials/MetalPlates006_1K/MetalPlates006_1K_NormalDX.png", defaultNormalSRV); 
+	TextureHandle metalPlatesORMTexture =
+		m_assets->LoadORM(L"", L"../../assets/materials/MetalPlates006_1K/MetalPlates006_1K_Roughness.png",
+			L"../../assets/materials/MetalPlates006_1K/MetalPlates006_1K_Metalness.png");
+
+	TextureHandle woodTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Wood058_1K/Wood058_1K_Color.png", albedoPlaceholderSRV);
+	TextureHandle woodNormalTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Wood058_1K/Wood058_1K_NormalDX.png", defaultNormalSRV); 
+	TextureHandle woodORMTexture =
+		m_assets->LoadORM(L"", L"../../assets/materials/Wood058_1K/Wood058_1K_Roughness.png",
+			L"../../assets/materials/Wood058_1K/Wood058_1K_Metalness.png");
+
+	TextureHandle metalTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Metal032_1K/Metal032_1K_Color.png", albedoPlaceholderSRV);
+	TextureHandle metalNormalTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Metal032_1K/Metal032_1K_NormalDX.png", defaultNormalSRV);
+	TextureHandle metalORMTexture =
+		m_assets->LoadORM(L"", L"../../assets/materials/Metal032_1K/Metal032_1K_Roughness.png",
+			L"../../assets/materials/Metal032_1K/Metal032_1K_Metalness.png");
 
 	// Provided PBR textures
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cobbleSRV =
-		LoadTexture(L"../../assets/materials/Cobblestone/cobblestone_albedo.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cobbleNormalSRV =
-		LoadTexture(L"../../assets/materials/Cobblestone/cobblestone_normals.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cobbleRoughnessSRV =
-		LoadTexture(L"../../assets/materials/Cobblestone/cobblestone_roughness.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> cobbleMetalnessSRV =
-		LoadTexture(L"../../assets/materials/Cobblestone/cobblestone_metal.png");
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeSRV =
-		LoadTexture(L"../../assets/materials/Bronze/bronze_albedo.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeNormalsSRV =
-		LoadTexture(L"../../assets/materials/Bronze/bronze_normals.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeRoughnessSRV =
-		LoadTexture(L"../../assets/materials/Bronze/bronze_roughness.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeMetalnessSRV =
-		LoadTexture(L"../../assets/materials/Bronze/bronze_metal.png");
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> paintSRV =
-		LoadTexture(L"../../assets/materials/Scratched/scratched_albedo.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> paintNormalsSRV =
-		LoadTexture(L"../../assets/materials/Scratched/scratched_normals.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> paintRoughnessSRV =
-		LoadTexture(L"../../assets/materials/Scratched/scratched_roughness.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> paintMetalnessSRV =
-		LoadTexture(L"../../assets/materials/Scratched/scratched_metal.png");
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> floorSRV =
-		LoadTexture(L"../../assets/materials/Floor/floor_albedo.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> floorNormalSRV =
-		LoadTexture(L"../../assets/materials/Floor/floor_normals.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> floorRoughnessSRV =
-		LoadTexture(L"../../assets/materials/Floor/floor_roughness.png");
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> floorMetalnessSRV =
-		LoadTexture(L"../../assets/materials/Floor/floor_metal.png");
+	TextureHandle cobbleTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Cobblestone/cobblestone_albedo.png", albedoPlaceholderSRV);
+	TextureHandle cobbleNormalTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Cobblestone/cobblestone_normals.png", defaultNormalSRV);
+	TextureHandle cobbleORMTexture =
+		m_assets->LoadORM(L"", L"../../assets/materials/Cobblestone/cobblestone_roughness.png",
+			L"../../assets/materials/Cobblestone/cobblestone_metal.png");
+
+	TextureHandle bronzeTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Bronze/bronze_albedo.png", albedoPlaceholderSRV);
+	TextureHandle bronzeNormalsTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Bronze/bronze_normals.png", defaultNormalSRV);
+	TextureHandle bronzeORMTexture =
+		m_assets->LoadORM(L"", L"../../assets/materials/Bronze/bronze_roughness.png",
+			L"../../assets/materials/Bronze/bronze_metal.png");
+
+	TextureHandle paintTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Scratched/scratched_albedo.png", albedoPlaceholderSRV);
+	TextureHandle paintNormalsTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Scratched/scratched_normals.png", defaultNormalSRV);
+	TextureHandle paintORMTexture =
+		m_assets->LoadORM(L"", L"../../assets/materials/Scratched/scratched_roughness.png",
+			L"../../assets/materials/Scratched/scratched_metal.png");
+
+	TextureHandle floorTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Floor/floor_albedo.png", albedoPlaceholderSRV);
+	TextureHandle floorNormalTexture =
+		m_assets->LoadTexture(L"../../assets/materials/Floor/floor_normals.png", defaultNormalSRV);
+	TextureHandle floorORMTexture =
+		m_assets->LoadORM(L"", L"../../assets/materials/Floor/floor_roughness.png",
+			L"../../assets/materials/Floor/floor_metal.png");
+	textureHandles.insert(textureHandles.end(), {
+		marbleTexture, marbleNormalTexture, marbleORMTexture,
+		metalPlatesTexture, metalPlatesNormalTexture, metalPlatesORMTexture,
+		woodTexture, woodNormalTexture, woodORMTexture,
+		metalTexture, metalNormalTexture, metalORMTexture,
+		cobbleTexture, cobbleNormalTexture, cobbleORMTexture,
+		bronzeTexture, bronzeNormalsTexture, bronzeORMTexture,
+		paintTexture, paintNormalsTexture, paintORMTexture,
+		floorTexture, floorNormalTexture, floorORMTexture });
 
 	// Create a Sampler state
 	D3D11_SAMPLER_DESC desc = {};
@@ -377,98 +440,90 @@ void Game::CreateMaterials()
 	desc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
 	desc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
 	desc.MaxLOD = D3D11_FLOAT32_MAX;
-	Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState;
-	device->CreateSamplerState(&desc, samplerState.GetAddressOf());
+	samplerHandles.push_back(m_assets->CreateSampler(desc));
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState = m_assets->Get(samplerHandles.back());
 
 	// Create a Clamped version as well
 	desc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
 	desc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
 	desc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
-	Microsoft::WRL::ComPtr<ID3D11SamplerState> clampState;
-	device->CreateSamplerState(&desc, clampState.GetAddressOf());
+	samplerHandles.push_back(m_assets->CreateSampler(desc));
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> clampState = m_assets->Get(samplerHandles.back());
 
 	// Basic Pixel and Vertex Shader Materials (basic white color tint)
 	size_t counter = materials.size(); // Counter to access the materials vector at the new slot
 
 	// Marble
-	materials.push_back(std::make_shared<Material>(vertexShader, pixelShader, XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
-	materials[counter]->AddTextureSRV("AlbedoTexture", marbleSRV);
-	materials[counter]->AddTextureSRV("NormalTexture", marbleNormalSRV);
-	materials[counter]->AddTextureSRV("RoughnessTexture", marbleRoughnessSRV);
-	materials[counter]->AddTextureSRV("MetalnessTexture", (marbleMetalnessSRV != nullptr) ? marbleMetalnessSRV : fullNonMetalSRV);
+	materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(pixelShader), XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
+	m_assets->Bind(marbleTexture, materials[counter], "AlbedoTexture");
+	m_assets->Bind(marbleNormalTexture, materials[counter], "NormalTexture");
+	m_assets->BindORM(marbleORMTexture, materials[counter]);
 	materials[counter]->AddSampler("BasicSampler", samplerState);
 	materials[counter]->AddSampler("ClampSampler", clampState);
 	counter++; // Increment counter to be in next Material's position
 	
 	// Metal Plates - possibly the only texture without gamma correction built in
-	//materials.push_back(std::make_shared<Material>(vertexShader, pixelShader, XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
-	//materials[counter]->AddTextureSRV("AlbedoTexture", metalPlatesSRV);
-	//materials[counter]->AddTextureSRV("NormalTexture", metalPlatesNormalSRV);
-	//materials[counter]->AddTextureSRV("RoughnessTexture", metalPlatesRoughnessSRV);
-	//materials[counter]->AddTextureSRV("MetalnessTexture", metalPlatesMetalnessSRV);
+	//materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(pixelShader), XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
+	//m_assets->Bind(metalPlatesTexture, materials[counter], "AlbedoTexture");
+	//m_assets->Bind(metalPlatesNormalTexture, materials[counter], "NormalTexture");
+	//m_assets->BindORM(metalPlatesORMTexture, materials[counter]);
 	//materials[counter]->AddSampler("BasicSampler", samplerState);
 	//materials[counter]->AddSampler("ClampSampler", clampState);
 	////materials[counter]->SetUVScale(.5f);
 	//counter++;
 	
 	// Wood
-	materials.push_back(std::make_shared<Material>(vertexShader, pixelShader, XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
-	materials[counter]->AddTextureSRV("AlbedoTexture", woodSRV);
-	materials[counter]->AddTextureSRV("NormalTexture", woodNormalSRV);
-	materials[counter]->AddTextureSRV("RoughnessTexture", woodRoughnessSRV);
-	materials[counter]->AddTextureSRV("MetalnessTexture", (woodMetalnessSRV != nullptr) ? woodMetalnessSRV : fullNonMetalSRV);
+	materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(pixelShader), XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
+	m_assets->Bind(woodTexture, materials[counter], "AlbedoTexture");
+	m_assets->Bind(woodNormalTexture, materials[counter], "NormalTexture");
+	m_assets->BindORM(woodORMTexture, materials[counter]);
 	materials[counter]->AddSampler("BasicSampler", samplerState);
 	materials[counter]->AddSampler("ClampSampler", clampState);
 	counter++;
 	
 	// Metal
-	materials.push_back(std::make_shared<Material>(vertexShader, pixelShader, XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
-	materials[counter]->AddTextureSRV("AlbedoTexture", metalSRV);
-	materials[counter]->AddTextureSRV("NormalTexture", metalNormalSRV);
-	materials[counter]->AddTextureSRV("RoughnessTexture", metalRoughnessSRV);
-	materials[counter]->AddTextureSRV("MetalnessTexture", (metalMetalnessSRV != nullptr) ? metalMetalnessSRV :  fullNonMetalSRV);
+	materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(pixelShader), XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
+	m_assets->Bind(metalTexture, materials[counter], "AlbedoTexture");
+	m_assets->Bind(metalNormalTexture, materials[counter], "NormalTexture");
+	m_assets->BindORM(metalORMTexture, materials[counter]);
 	materials[counter]->AddSampler("BasicSampler", samplerState);
 	materials[counter]->AddSampler("ClampSampler", clampState);
 	counter++;
 
 	// Cobblestone
-	materials.push_back(std::make_shared<Material>(vertexShader, pixelShader, XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
-	materials[counter]->AddTextureSRV("AlbedoTexture", cobbleSRV);
-	materials[counter]->AddTextureSRV("NormalTexture", cobbleNormalSRV);
-	materials[counter]->AddTextureSRV("RoughnessTexture", cobbleRoughnessSRV);
-	materials[counter]->AddTextureSRV("MetalnessTexture", cobbleMetalnessSRV);
+	materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(pixelShader), XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
+	m_assets->Bind(cobbleTexture, materials[counter], "AlbedoTexture");
+	m_assets->Bind(cobbleNormalTexture, materials[counter], "NormalTexture");
+	m_assets->BindORM(cobbleORMTexture, materials[counter]);
 	materials[counter]->AddSampler("BasicSampler", samplerState);
 	materials[counter]->AddSampler("ClampSampler", clampState);
 	materials[counter]->SetUVScale(.25f); // .5 looks good. .25 for Final Demo scene
 	counter++;
 	 
 	// Bronze
-	materials.push_back(std::make_shared<Material>(vertexShader, pixelShader, XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
-	materials[counter]->AddTextureSRV("AlbedoTexture", bronzeSRV);
-	materials[counter]->AddTextureSRV("NormalTexture", bronzeNormalsSRV);
-	materials[counter]->AddTextureSRV("RoughnessTexture", bronzeRoughnessSRV);
-	materials[counter]->AddTextureSRV("MetalnessTexture", bronzeMetalnessSRV);
+	materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(pixelShader), XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
+	m_assets->Bind(bronzeTexture, materials[counter], "AlbedoTexture");
+	m_assets->Bind(bronzeNormalsTexture, materials[counter], "NormalTexture");
+	m_assets->BindORM(bronzeORMTexture, materials[counter]);
 	materials[counter]->AddSampler("BasicSampler", samplerState);
 	materials[counter]->AddSampler("ClampSampler", clampState);
 	counter++;
 
 	// Scratched Paint
-	materials.push_back(std::make_shared<Material>(vertexShader, pixelShader, XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
-	materials[counter]->AddTextureSRV("AlbedoTexture", paintSRV);
-	materials[counter]->AddTextureSRV("NormalTexture", paintNormalsSRV);
-	materials[counter]->AddTextureSRV("RoughnessTexture", paintRoughnessSRV);
-	materials[counter]->AddTextureSRV("MetalnessTexture", paintMetalnessSRV);
+	materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(pixelShader), XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
+	m_assets->Bind(paintTexture, materials[counter], "AlbedoTexture");
+	m_assets->Bind(paintNormalsTexture, materials[counter], "NormalTexture");
+	m_assets->BindORM(paintORMTexture, materials[counter]);
 	materials[counter]->AddSampler("BasicSampler", samplerState);
 	materials[counter]->AddSampler("ClampSampler", clampState);
 	materials[counter]->SetUVScale(.75); // Set for Final Demo scene
 	counter++;
 
 	// Metallic Casing
-	materials.push_back(std::make_shared<Material>(vertexShader, pixelShader, XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
-	materials[counter]->AddTextureSRV("AlbedoTexture", floorSRV);
-	materials[counter]->AddTextureSRV("NormalTexture", floorNormalSRV);
-	materials[counter]->AddTextureSRV("RoughnessTexture", floorRoughnessSRV);
-	materials[counter]->AddTextureSRV("MetalnessTexture", floorMetalnessSRV);
+	materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(pixelShader), XMFLOAT4(1.f, 1.f, 1.f, 1.f), 0.f));
+	m_assets->Bind(floorTexture, materials[counter], "AlbedoTexture");
+	m_assets->Bind(floorNormalTexture, materials[counter], "NormalTexture");
+	m_assets->BindORM(floorORMTexture, materials[counter]);
 	materials[counter]->AddSampler("BasicSampler", samplerState);
 	materials[counter]->AddSampler("ClampSampler", clampState);
 	materials[counter]->SetUVScale(.5f);
@@ -476,11 +531,10 @@ void Game::CreateMaterials()
 
 	// Pure Metal Materials
 	for (int i = 0; i < 6; i++) {
-		materials.push_back(std::make_shared<Material>(vertexShader, pixelShader, XMFLOAT4(1.f, 1.f, 1.f, 1.f), 1.f-((float)i / 5.f)));
-		materials[counter]->AddTextureSRV("AlbedoTexture", fullMetalSRV);
+		materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(pixelShader), XMFLOAT4(1.f, 1.f, 1.f, 1.f), 1.f-((float)i / 5.f)));
+		materials[counter]->AddTextureSRV("AlbedoTexture", whiteSRV);
 		materials[counter]->AddTextureSRV("NormalTexture", defaultNormalSRV);
-		materials[counter]->AddTextureSRV("RoughnessTexture", fullMetalSRV);
-		materials[counter]->AddTextureSRV("MetalnessTexture", fullMetalSRV);
+		materials[counter]->SetORMChannels(Vector3(1.f, 1.f, 1.f), Vector3(0.f, 0.f, 0.f)); // Constant, so no ORM texture at all
 		materials[counter]->AddSampler("BasicSampler", samplerState);
 		materials[counter]->AddSampler("ClampSampler", clampState);
 		counter++;
@@ -488,11 +542,10 @@ void Game::CreateMaterials()
 
 	// Pure Non-Metal Materials
 	for (int i = 0; i < 6; i++) {
-		materials.push_back(std::make_shared<Material>(vertexShader, pixelShader, XMFLOAT4(1.f, 1.f, 1.f, 1.f), 1.f - ((float)i / 5.f)));
-		materials[counter]->AddTextureSRV("AlbedoTexture", fullMetalSRV);
+		materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(pixelShader), XMFLOAT4(1.f, 1.f, 1.f, 1.f), 1.f - ((float)i / 5.f)));
+		materials[counter]->AddTextureSRV("AlbedoTexture", whiteSRV);
 		materials[counter]->AddTextureSRV("NormalTexture", defaultNormalSRV);
-		materials[counter]->AddTextureSRV("RoughnessTexture", fullMetalSRV);
-		materials[counter]->AddTextureSRV("MetalnessTexture", fullNonMetalSRV);
+		materials[counter]->SetORMChannels(Vector3(1.f, 1.f, 0.f), Vector3(0.f, 0.f, 0.f)); // Constant, so no ORM texture at all
 		materials[counter]->AddSampler("BasicSampler", samplerState);
 		materials[counter]->AddSampler("ClampSampler", clampState);
 		counter++;
@@ -500,7 +553,7 @@ void Game::CreateMaterials()
 	// No need to increment counter
 
 	// Procedural Pixel Shader
-	materials.push_back(std::make_shared<Material>(vertexShader, customPixelShader));
+	materials.push_back(std::make_shared<Material>(m_assets->Get(vertexShader), m_assets->Get(customPixelShader)));
 }
 
 // --------------------------------------------------------
@@ -541,7 +594,7 @@ void Game::CreateLights()
 	//pointLight1.Color = Vector3(1.f, 1.f, 1.f);
 	//pointLight1.Intensity = 1.f;
 	//pointLights.push_back(pointLight1);
-	//std::shared_ptr<Entity> l1 = std::make_shared<Entity>(geometry[0], materials[materials.size() - 1]);
+	//std::shared_ptr<Entity> l1 = std::make_shared<Entity>(m_assets->Get(geometry[0]), materials[materials.size() - 1]);
 	//l1->GetTransform()->SetAbsolutePosition(pointLight1.Position);
 	//l1->GetTransform()->SetAbsoluteScale(.1f, .1f, .1f);
 	//entities.push_back(l1);
@@ -553,23 +606,157 @@ void Game::CreateLights()
 	//pointLight2.Range = 10.f;
 	//pointLight2.Color = Vector3(1.f, 1.f, 1.f);
 	//pointLight2.Intensity = 1.f;
-	//pointLights.push_back(pointLight2);	std::shared_ptr<Entity> l2 = std::make_shared<Entity>(geometry[0], materials[materials.size() - 1]);
+	//pointLights.push_back(pointLight2);	std::shared_ptr<Entity> l2 = std::make_shared<Entity>(m_assets->Get(geometry[0]), materials[materials.size() - 1]);
 	//l2->GetTransform()->SetAbsolutePosition(pointLight2.Position);
 	//l2->GetTransform()->SetAbsoluteScale(.1f, .1f, .1f);
 	//entities.push_back(l2);
 }
 
+// ----------------------------------------------------------
+// Hash of everything a Reflection Probe would see: the
+// transforms of Entities inside its radius, and the lights.
+// The scheduler redraws the probe when this changes
+// ----------------------------------------------------------
+uint64_t Game::ComputeProbeSceneSignature(std::shared_ptr<ReflectionProbe> a_probe)
+{
+	Vector3 center = a_probe->GetPostiion();
+	float radius = a_probe->GetRadius();
+	uint64_t signature = HASH_FNV_OFFSET_BASIS;
+
+	// Entities whose bounds reach into the probe. Sorted, since tree order changes whenever anything moves
+	queryResults.clear();
+	entityTree.QuerySphere(center, radius, queryResults);
+	std::sort(queryResults.begin(), queryResults.end());
+	for (unsigned int i : queryResults) {
+		signature = Hashing::Value(i, signature);
+		signature = Hashing::Value(entities[i]->GetTransform()->GetWorldTransformMatrix(), signature);
+	}
+	signature = Hashing::Bytes(directionalLights.data(), directionalLights.size() * sizeof(BasicLight), signature);
+	signature = Hashing::Bytes(pointLights.data(), pointLights.size() * sizeof(BasicLight), signature);
+	return signature;
+}
+
+// ----------------------------------------------------------
+// World space box around an Entity's Mesh
+// ----------------------------------------------------------
+AABB Game::GetEntityBounds(unsigned int a_entity)
+{
+	Matrix4 world = entities[a_entity]->GetTransform()->GetWorldTransformMatrix();
+	return Culling::SphereToAABB(Culling::TransformSphere(entities[a_entity]->GetMesh()->GetBoundingSphere(), world));
+}
+
+// ----------------------------------------------------------
+// Tells the TextureLoader how much of each Material the
+// main camera sees, so the streamer knows which mips are
+// worth their memory
+//	- Coverage is the Entity's bounding sphere projected
+//	  to pixels, assuming its UVs span the texture once.
+//	  The pixel shader divides UVs by the UV scale, so a
+//	  scale below 1 tiles the texture and needs fewer
+//	  texels per pixel
+// ----------------------------------------------------------
+void Game::ReportTextureCoverage()
+{
+	Vector3 cameraPosition = camera->GetTransform()->GetPosition();
+	float pixelsPerUnit = (float)windowHeight / (2.f * tanf(camera->GetFieldOfView() * 0.5f));
+	for (unsigned int i = 0; i < entities.size(); i++) {
+		if (!(visibilityMasks[i] & 1ull))
+			continue;
+
+		Matrix4 world = entities[i]->GetTransform()->GetWorldTransformMatrix();
+		Vector4 sphere = Culling::TransformSphere(entities[i]->GetMesh()->GetBoundingSphere(), world);
+		float dx = sphere.x - cameraPosition.x;
+		float dy = sphere.y - cameraPosition.y;
+		float dz = sphere.z - cameraPosition.z;
+		float pixels = TextureStreamer::ProjectSphereArea(sphere.w, sqrtf(dx * dx + dy * dy + dz * dz), pixelsPerUnit);
+
+		std::shared_ptr<Material> material = entities[i]->GetMaterial();
+		float uvScale = material->GetUVScale();
+		m_textureLoader->ReportCoverage(material.get(), pixels * uvScale * uvScale);
+	}
+	m_textureLoader->UpdateStreaming();
+}
+
+// ----------------------------------------------------------
+// Casts a ray from the Camera through a pixel and returns
+// the index of the closest Entity whose bounding sphere it
+// hits, or -1
+//	- The tree only tests Entities whose boxes the ray
+//	  reaches, nearest first
+// ----------------------------------------------------------
+int Game::PickEntity(int a_mouseX, int a_mouseY)
+{
+	// Unproject the pixel onto the near and far planes
+	Matrix4 viewProjection = camera->GetViewProjectionMatrix();
+	XMMATRIX inverseViewProjection = XMMatrixInverse(nullptr, XMLoadFloat4x4(&viewProjection));
+	float x = 2.f * (a_mouseX + 0.5f) / windowWidth - 1.f;
+	float y = 1.f - 2.f * (a_mouseY + 0.5f) / windowHeight;
+	XMVECTOR nearPoint = XMVector3TransformCoord(XMVectorSet(x, y, 0.f, 1.f), inverseViewProjection);
+	XMVECTOR farPoint = XMVector3TransformCoord(XMVectorSet(x, y, 1.f, 1.f), inverseViewProjection);
+	Vector3 origin;
+	Vector3 direction;
+	XMStoreFloat3(&origin, nearPoint);
+	XMStoreFloat3(&direction, XMVector3Normalize(XMVectorSubtract(farPoint, nearPoint)));
+	float length = XMVectorGetX(XMVector3Length(XMVectorSubtract(farPoint, nearPoint)));
+
+	float hitDistance = 0.f;
+	unsigned int hit = entityTree.RayCast(origin, direction, length, [&](unsigned int a_entity) {
+		Matrix4 world = entities[a_entity]->GetTransform()->GetWorldTransformMatrix();
+		Vector4 sphere = Culling::TransformSphere(entities[a_entity]->GetMesh()->GetBoundingSphere(), world);
+		float ox = origin.x - sphere.x, oy = origin.y - sphere.y, oz = origin.z - sphere.z;
+		float b = ox * direction.x + oy * direction.y + oz * direction.z;
+		float c = ox * ox + oy * oy + oz * oz - sphere.w * sphere.w;
+		float discriminant = b * b - c;
+		if (discriminant < 0.f)
+			return -1.f;
+		float distance = -b - std::sqrt(discriminant);
+		return distance >= 0.f ? distance : (c <= 0.f ? 0.f : -1.f);
+	}, hitDistance);
+	return hit == BVH_NO_HIT ? -1 : (int)hit;
+}
+
 // ----------------------------------------------------------
 // Create a texture representing the BRDF Lookup Table for IBL
 // lighting. Since this is not object or material dependant, it
 // can be created once and used for everything
+//	- By default the table is the small one generated
+//	  offline (headless "brdf-lut") and embedded in the exe
+//	- Otherwise it is rendered, or loaded from the IBL
+//	  cache when a previous run made it with the same size,
+//	  format and shader
 // ----------------------------------------------------------
 void Game::CreateIBLBRDFLookupTable()
 {
+#if IBL_BRDF_LUT_EMBEDDED
+	// 64x64 is 16 KB instead of 4 MB, and within a fraction of a percent of the 1024x1024 table
+	IBLCacheTexture embeddedTable;
+	embeddedTable.Format = BRDF_LUT_DATA_FORMAT;
+	embeddedTable.Width = BRDF_LUT_DATA_SIZE;
+	embeddedTable.Height = BRDF_LUT_DATA_SIZE;
+	embeddedTable.MipLevels = 1;
+	embeddedTable.ArraySize = 1;
+	const unsigned char* tableBytes = reinterpret_cast<const unsigned char*>(c_brdfLookupTableData);
+	embeddedTable.Data.assign(tableBytes, tableBytes + sizeof(c_brdfLookupTableData));
+	if (IBLCacheD3D11::CreateShaderResourceView(device, embeddedTable, iblBRDFLookupTexture))
+		return;
+#endif
+
+	// Key only depends on what the table is rendered with - it is the same for every sky
+	bool bShaderFound = false;
+	uint64_t key = Hashing::String("brdf");
+	key = Hashing::Value(IBL_BRDF_LUT_SIZE, key);
+	key = Hashing::Value((uint32_t)DXGI_FORMAT_R16G16_UNORM, key);
+	key = Hashing::File(WideToNarrow(FixPath(L"IBlBRDFIntegrateMapPS.cso")), key, bShaderFound);
+	std::string cacheFile = IBLCache::GetFileName(WideToNarrow(FixPath(IBL_CACHE_DIRECTORY)), "brdf", key);
+	IBLCacheEntry entry;
+	if (IBLCache::Load(cacheFile, key, entry) && entry.Textures.size() == 1 &&
+		IBLCacheD3D11::CreateShaderResourceView(device, entry.Textures[0], iblBRDFLookupTexture))
+		return;
+
 	// Create Texture2D resource
 	Microsoft::WRL::ComPtr<ID3D11Texture2D> brdfTableTex;
 	D3D11_TEXTURE2D_DESC brdfTableDesc = {};
-	brdfTableDesc.Height = 1024; // Hardcoded for now, but this is a reasonable size (used in Cascioli sample code)
+	brdfTableDesc.Height = IBL_BRDF_LUT_SIZE;
 	brdfTableDesc.Width = brdfTableDesc.Height;
 	brdfTableDesc.MipLevels = 1;
 	brdfTableDesc.ArraySize = 1;
@@ -625,32 +812,52 @@ void Game::CreateIBLBRDFLookupTable()
 	context->OMSetRenderTargets(1, tableRTV.GetAddressOf(), nullptr);
 
 	// Set shaders and draw
-	brdfLookupMapPixelShader->SetShader();
-	fullscreenTriangleVertexShader->SetShader();
+	m_assets->Get(brdfLookupMapPixelShader)->SetShader();
+	m_assets->Get(fullscreenTriangleVertexShader)->SetShader();
 	context->Draw(3, 0);
 	//context->Flush(); probably not necessary on this, but could be useful on the TexCube creations
 
 	// Reset cached resources
 	context->OMSetRenderTargets(1, backBufferRTV.GetAddressOf(), depthBufferDSV.Get());
 	context->RSSetViewports(viewportCount, &cachedViewport);
+
+	// Save for the next run
+	entry = IBLCacheEntry();
+	entry.Key = key;
+	entry.Textures.resize(1);
+	if (IBLCacheD3D11::ReadBackTexture(device, context, brdfTableTex, entry.Textures[0]))
+		IBLCache::Save(cacheFile, entry);
 }
 
-// ----------------------------------------------------------
-// Loads a Texture from a given filepath using the Game's
-// Device and DeviceContext and the WICTextureLoader. Returns
-// a ShaderResourceView and does not create an ID3D11Resource
-//	- a_filePath: Relative filepath. Fixed using FixPath()
-// ----------------------------------------------------------
-Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> Game::LoadTexture(std::wstring a_filePath)
+// --------------------------------------------------------
+// Hands back every asset Game loaded. Materials, Entities,
+// the Sky and the Renderer keep their resolved copies for
+// as long as they live
+// --------------------------------------------------------
+void Game::ReleaseAssets()
 {
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> textureResourceView;
-	CreateWICTextureFromFile(
-		device.Get(),
-		context.Get(),
-		FixPath(a_filePath).c_str(),
-		nullptr,
-		textureResourceView.GetAddressOf());
-	return textureResourceView;
+	if (!m_assets)
+		return;
+
+	for (VertexShaderHandle shader : { vertexShader, skyVertexShader, fullscreenTriangleVertexShader }) {
+		m_assets->Release(shader);
+	}
+	for (PixelShaderHandle shader : { pixelShader, customPixelShader, skyPixelShader, irradiancePixelShader, envPrefilterPixelShader,
+		brdfLookupMapPixelShader }) {
+		m_assets->Release(shader);
+	}
+	for (MeshHandle mesh : geometry) {
+		m_assets->Release(mesh);
+	}
+	for (TextureHandle texture : textureHandles) {
+		m_assets->Release(texture);
+	}
+	for (SamplerHandle sampler : samplerHandles) {
+		m_assets->Release(sampler);
+	}
+	geometry.clear();
+	textureHandles.clear();
+	samplerHandles.clear();
 }
 
 // --------------------------------------------------------
@@ -794,7 +1001,7 @@ void Game::UpdateUI(float deltaTime)
 	// Show windows
 	//ImGui::ShowDemoWindow();
 	UIStatsWindow();
-	//UIEditorWindow(); Easier to comment out the whole window than to update it to ignore the now-missing point lights
+	UIEditorWindow();
 }
 
 // --------------------------------------------------------
@@ -825,6 +1032,27 @@ void Game::UIStatsWindow()
 	ImGui::Text("FPS: %.3f", ImGui::GetIO().Framerate);
 	ImGui::Text("Frame Time (MS): %.3f", ImGui::GetIO().DeltaTime * 1000);
 
+	// Submission counters from the last full frame
+	const RenderDeviceStats& deviceStats = m_renderDevice->GetFrameStats();
+	ImGui::Text("Draw Calls: %u", deviceStats.DrawCalls + deviceStats.IndexedDrawCalls);
+	ImGui::Text("Triangles: %llu", deviceStats.PrimitivesSubmitted);
+	ImGui::Text("Buffer Uploads: %u (%llu bytes)", deviceStats.BufferUpdates, deviceStats.BytesUploaded);
+	ImGui::Text("Constant Buffer Binds: %u", deviceStats.ConstantBufferBinds);
+	ImGui::Text("Redundant Binds Skipped: %u", deviceStats.RedundantBindsSkipped);
+	ImGui::Text("Occluded Entities: %u (%u occluder triangles)", occludedEntityCount, occlusionBuffer.GetTriangleCount());
+	ImGui::Text("Textures Loading: %u", m_textureLoader->GetPendingCount());
+	const TextureStreamerStats& streamStats = m_textureLoader->GetStreamer().GetStats();
+	ImGui::Text("Texture Memory: %.1f / %.1f MB (%u of %u visible at full detail)",
+		(streamStats.ResidentBytes + streamStats.LoadingBytes) / (1024.f * 1024.f),
+		m_textureLoader->GetStreamer().GetSettings().BudgetBytes / (1024.f * 1024.f),
+		streamStats.VisibleAtWanted, streamStats.VisibleTextures);
+	AssetManagerStats assetStats = m_assets->GetStats();
+	ImGui::Text("Assets: %u meshes (%.1f MB), %u textures (%.1f MB), %u shaders (%.1f MB), %u samplers",
+		assetStats.Meshes.Live, assetStats.Meshes.Bytes / (1024.f * 1024.f),
+		assetStats.Textures.Live, assetStats.Textures.Bytes / (1024.f * 1024.f),
+		assetStats.Shaders.Live, assetStats.Shaders.Bytes / (1024.f * 1024.f),
+		assetStats.Samplers.Live);
+
 	ImGui::End();
 }
 
@@ -833,6 +1061,7 @@ void Game::UIStatsWindow()
 // updated
 //	- original goal was to get a dropdown to edit various
 //	  Entities in the scene, but that caused assertion errors
+//	- Entities are selected by clicking on them instead
 // --------------------------------------------------------
 void Game::UIEditorWindow()
 {
@@ -856,6 +1085,18 @@ void Game::UIEditorWindow()
 	//	ImGui::EndCombo();
 	//}
 
+	// Click in the scene to select an Entity (presses over UI windows are captured by ImGui first)
+	Input& input = Input::GetInstance();
+	if (input.MouseLeftPress())
+		selectedEntity = PickEntity(input.GetMouseX(), input.GetMouseY());
+	if (selectedEntity >= 0) {
+		Vector3 position = entities[selectedEntity]->GetTransform()->GetPosition();
+		ImGui::Text("Selected Entity: %d (%.2f, %.2f, %.2f)", selectedEntity + 1, position.x, position.y, position.z);
+	}
+	else {
+		ImGui::Text("Selected Entity: none (click to pick)");
+	}
+
 	// Edit Camera's values
 	float fov = camera->GetFieldOfView();
 	if (ImGui::SliderFloat("Camera Field Of View", &fov, XM_PIDIV4, XM_PIDIV4 * 3)) {
@@ -869,8 +1110,21 @@ void Game::UIEditorWindow()
 	if (ImGui::SliderFloat("Camera Rotation Speed", &rotSpeed, 0.f, 10.f)) {
 		camera->SetLookAtSpeed(rotSpeed);
 	}
+	ImGui::Checkbox("Occlusion Culling", &bOcclusionCulling);
+	float lodPixelError = m_renderer->GetLODPixelError();
+	if (ImGui::SliderFloat("LOD Pixel Error", &lodPixelError, 0.f, 8.f)) {
+		m_renderer->SetLODPixelError(lodPixelError);
+	}
+	bool bMeshletCulling = m_renderer->GetMeshletCulling();
+	if (ImGui::Checkbox("Meshlet Culling", &bMeshletCulling)) {
+		m_renderer->SetMeshletCulling(bMeshletCulling);
+	}
 
-	// Edit Point Light positions
+	// Edit Point Light positions, if the scene still has the two lights this was written for
+	if (pointLights.size() < 2) {
+		ImGui::End();
+		return;
+	}
 	float pointLight1Pos[3] = { pointLights[0].Position.x, pointLights[0].Position.y, pointLights[0].Position.z };
 	if (ImGui::SliderFloat3("Point Light 1 Position", &pointLight1Pos[0], -10, 10)) {
 		pointLights[0].Position = Vector3(pointLight1Pos[0], pointLight1Pos[1], pointLight1Pos[2]);
@@ -905,6 +1159,10 @@ void Game::OnResize()
 	if (camera != nullptr) {
 		camera->SetAspectRatio(XMINT2(this->windowWidth, this->windowHeight));
 	}
+
+	// Keep the occlusion buffer's aspect ratio matching the window
+	if (windowWidth > 0)
+		occlusionBuffer.Resize(OCCLUSION_DEFAULT_WIDTH, OCCLUSION_DEFAULT_WIDTH * windowHeight / windowWidth);
 }
 
 // --------------------------------------------------------
@@ -919,11 +1177,22 @@ void Game::Update(float deltaTime, float totalTime)
 	// Update UI immediately after checking to quit
 	UpdateUI(deltaTime);
 
+	// Swap in any textures that finished decoding since last frame, then drop assets nothing has used for a while
+	m_textureLoader->ProcessUploads();
+	m_assets->EndFrame();
+
 	// Update all entities with the deltaTime
 	for (std::shared_ptr<Entity> entity : entities) {
 		entity->Update(deltaTime);
 	}
 
+	// Refit moved Entities in the tree. The dirty flag is cleared once the world matrix is rebuilt, so this must
+	// run before anything reads the matrices this frame
+	for (unsigned int i = 0; i < entities.size(); i++) {
+		if (entities[i]->GetTransform()->IsTransformDirty())
+			entityTree.MoveProxy(entityProxies[i], GetEntityBounds(i));
+	}
+
 	// Update Camera
 	if (camera != nullptr) {
 		camera->Update(deltaTime);
@@ -936,11 +1205,81 @@ void Game::Update(float deltaTime, float totalTime)
 void Game::Draw(float deltaTime, float totalTime)
 {
 	// Update Reflection Probes BEFORE clearing back buffer (not incredibly important, but they are a "pre-process" of sorts)
-	//	- This results in a noticeable slowdown, even before convolution is done. ~45fps just rendering the scene cubemap
-	//	  at 512x512 resolution per face
-	//for (std::shared_ptr<ReflectionProbe> probe : reflectionProbes) {
-	//	probe->Draw(device, context, entities, directionalLights, pointLights, sky, iblBRDFLookupTexture);
-	//}
+	//	- Redrawing every probe in full each frame was a noticeable slowdown, even before convolution was done. ~45fps
+	//	  just rendering the scene cubemap at 512x512 resolution per face. The scheduler spreads updates over frames
+	//	  within a fixed budget of faces and mips, and only redraws probes whose surroundings changed
+	for (unsigned int i = 0; i < reflectionProbes.size(); i++) {
+		probeScheduler.SetProbeBounds(i, reflectionProbes[i]->GetPostiion(), reflectionProbes[i]->GetRadius());
+		probeScheduler.SetSceneSignature(i, ComputeProbeSceneSignature(reflectionProbes[i]));
+	}
+	const std::vector<ProbeUpdateStep>& probeSteps = probeScheduler.Schedule(camera->GetTransform()->GetPosition());
+
+	// Cull once for every view drawn this frame - the main camera is view 0, and each probe face rendered is the
+	// next view in step order. One walk of the Entity tree tests every view together, skipping whole subtrees
+	cullViews.clear();
+	cullViews.push_back(Culling::ExtractFrustum(camera->GetViewProjectionMatrix()));
+	for (const ProbeUpdateStep& step : probeSteps) {
+		if (step.Type == ProbeUpdateStepType::RenderFace)
+			cullViews.push_back(Culling::ExtractFrustum(reflectionProbes[step.Probe]->GetFaceViewProjectionMatrix(step.Index)));
+	}
+	visibilityMasks.assign(entities.size(), 0ull);
+	entityTree.QueryFrustums(cullViews, visibilityMasks);
+
+	// Occlusion culling for the main view - rasterize the occluders the camera sees into the CPU depth buffer, then
+	// clear the view 0 bit of every Entity whose bounds are entirely behind it
+	occludedEntityCount = 0;
+	if (bOcclusionCulling) {
+		Matrix4 viewProjection = camera->GetViewProjectionMatrix();
+		XMMATRIX viewProjectionMatrix = XMLoadFloat4x4(&viewProjection);
+		occlusionBuffer.Clear();
+		occlusionCandidates.clear();
+		occlusionBoxes.clear();
+		for (unsigned int i = 0; i < entities.size(); i++) {
+			if (!(visibilityMasks[i] & 1ull))
+				continue;
+
+			if (entities[i]->IsOccluder()) {
+				std::shared_ptr<Mesh> mesh = entities[i]->GetMesh();
+				Matrix4 world = entities[i]->GetTransform()->GetWorldTransformMatrix();
+				Matrix4 worldViewProjection;
+				XMStoreFloat4x4(&worldViewProjection, XMMatrixMultiply(XMLoadFloat4x4(&world), viewProjectionMatrix));
+				occlusionBuffer.AddOccluder(mesh->GetPositions().data(), (unsigned int)mesh->GetPositions().size(), sizeof(Vector3),
+					mesh->GetIndices().data(), (unsigned int)mesh->GetIndices().size(), worldViewProjection);
+			}
+			occlusionCandidates.push_back(i);
+			occlusionBoxes.push_back(entityTree.GetFatAABB(entityProxies[i]));
+		}
+		occlusionBuffer.Rasterize(true, true);
+		occlusionBuffer.TestBoxes(occlusionBoxes, viewProjection, occlusionVisible, true, true);
+		for (unsigned int i = 0; i < occlusionCandidates.size(); i++) {
+			if (!occlusionVisible[i]) {
+				visibilityMasks[occlusionCandidates[i]] &= ~1ull;
+				occludedEntityCount++;
+			}
+		}
+	}
+
+	// Stream texture mips for what the main camera can actually see
+	ReportTextureCoverage();
+
+	unsigned int faceView = 1;
+	for (const ProbeUpdateStep& step : probeSteps) {
+		std::shared_ptr<ReflectionProbe> probe = reflectionProbes[step.Probe];
+		switch (step.Type) {
+		case ProbeUpdateStepType::RenderFace:
+			// Faces past CULLING_MAX_VIEWS have no mask bit, and draw everything
+			probe->RenderFace(device, context, m_renderDevice, step.Index, entities, directionalLights, pointLights, sky, iblBRDFLookupTexture,
+				faceView < CULLING_MAX_VIEWS ? &visibilityMasks : nullptr, faceView);
+			faceView++;
+			break;
+		case ProbeUpdateStepType::PrefilterMip:
+			probe->PrefilterMip(device, context, m_renderDevice, step.Index, sky->GetSamplerState());
+			break;
+		case ProbeUpdateStepType::Publish:
+			probe->Publish();
+			break;
+		}
+	}
 
 	//Microsoft::WRL::ComPtr<ID3D11RasterizerState> rsState;
 	//D3D11_RASTERIZER_DESC rsDesc = {};
@@ -956,7 +1295,7 @@ void Game::Draw(float deltaTime, float totalTime)
 	std::vector<BasicLight> allLights = std::vector<BasicLight>(directionalLights);
 	allLights.insert(allLights.end(), pointLights.begin(), pointLights.end());
 
-	m_renderer->Render(entities, allLights, camera, sky);
+	m_renderer->Render(entities, allLights, camera, sky, &visibilityMasks, 0);
 
 	m_renderer->PostProcess(camera);
 
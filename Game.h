@@ -9,6 +9,13 @@
 #include "Sky.h"
 #include "Renderer.h"
 #include "ReflectionProbe.h" // oh boy
+#include "ReflectionProbeScheduler.h"
+#include "Culling.h"
+#include "BVH.h"
+#include "OcclusionCulling.h"
+#include "D3D11RenderDevice.h"
+#include "TextureLoader.h"
+#include "AssetManager.h"
 
 #include "simpleshader/SimpleShader.h"
 
@@ -40,8 +47,12 @@ private:
 	void CreateMaterials();
 	void CreateLights();
 	void CreateIBLBRDFLookupTable();
+	void ReleaseAssets(); // Every handle Game holds, on teardown
+	uint64_t ComputeProbeSceneSignature(std::shared_ptr<ReflectionProbe> a_probe);
+	AABB GetEntityBounds(unsigned int a_entity);
+	void ReportTextureCoverage(); // Main view coverage of each Material, for texture streaming
+	int PickEntity(int a_mouseX, int a_mouseY); // Closest Entity under the cursor, or -1
 
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> LoadTexture(std::wstring a_filePath);
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> LoadTextureCube(std::wstring a_filePath);
 
 	// Updating Helper methods
@@ -59,28 +70,60 @@ private:
 	// separate thread for each, operating completely independently
 	std::shared_ptr<Renderer> m_renderer;
 
+	// Submission backend wrapping the DXCore device and context. Meshes create and draw through this
+	std::shared_ptr<D3D11RenderDevice> m_renderDevice;
+
+	// Background texture decoding, uploaded once per frame in Update
+	std::shared_ptr<TextureLoader> m_textureLoader;
+	TextureRequest skyTextureRequest = 0;
+
+	// Deduplicated meshes, shaders, samplers and material textures. Game keeps the handles it loaded and resolves them
+	// where they're used. Materials and Entities get the resolved assets, and every handle is released on teardown
+	std::shared_ptr<AssetManager> m_assets;
+	std::vector<TextureHandle> textureHandles; // Material textures, held for as long as the Materials
+	std::vector<SamplerHandle> samplerHandles;
+
 	// Core object storage
-	std::vector<std::shared_ptr<Mesh>> geometry;
+	std::vector<MeshHandle> geometry;
 	std::vector<std::shared_ptr<Entity>> entities; // Shared Pointers for consistency, safety, and stack avoidance
 	std::vector<std::shared_ptr<Material>> materials;
 	std::vector<BasicLight> directionalLights; // Pointer is really not needed for these structs, at least not now
 	std::vector<BasicLight> pointLights;
 	std::shared_ptr<Sky> sky;
 	std::vector<std::shared_ptr<ReflectionProbe>> reflectionProbes; // Real-time probes, so should be SMALL
+	ReflectionProbeScheduler probeScheduler; // Indices match reflectionProbes
+
+	// Spatial index of Entity bounds, refit from Transform dirty flags in Update
+	BVH entityTree; // User data is the index into entities
+	std::vector<int> entityProxies; // Indices match entities
+	std::vector<unsigned int> queryResults; // Scratch for tree queries
+	int selectedEntity = -1; // Picked in the Editor window
+
+	// Per-frame culling scratch, kept to avoid reallocating
+	std::vector<Frustum> cullViews; // Main camera, then each probe face rendered this frame
+	std::vector<uint64_t> visibilityMasks; // One bit per cullViews entry, indices match entities
+
+	// CPU occlusion culling of the main view
+	OcclusionBuffer occlusionBuffer;
+	bool bOcclusionCulling = true;
+	unsigned int occludedEntityCount = 0; // Last frame, for the Stats window
+	std::vector<unsigned int> occlusionCandidates; // Entity indices visible to the main camera
+	std::vector<AABB> occlusionBoxes; // Their bounds, matching occlusionCandidates
+	std::vector<unsigned char> occlusionVisible;
 
 	// Camera
 	std::shared_ptr<Camera> camera;
 	
 	// Shaders and shader-related constructs
-	std::shared_ptr<SimpleVertexShader> vertexShader;
-	std::shared_ptr<SimplePixelShader> pixelShader;
-	std::shared_ptr<SimplePixelShader> customPixelShader;
-	std::shared_ptr<SimpleVertexShader> skyVertexShader; 
-	std::shared_ptr<SimplePixelShader> skyPixelShader;
-	std::shared_ptr<SimpleVertexShader> fullscreenTriangleVertexShader;
-	std::shared_ptr<SimplePixelShader> irradiancePixelShader;
-	std::shared_ptr<SimplePixelShader> envPrefilterPixelShader;
-	std::shared_ptr<SimplePixelShader> brdfLookupMapPixelShader;
+	VertexShaderHandle vertexShader;
+	PixelShaderHandle pixelShader;
+	PixelShaderHandle customPixelShader;
+	VertexShaderHandle skyVertexShader; 
+	PixelShaderHandle skyPixelShader;
+	VertexShaderHandle fullscreenTriangleVertexShader;
+	PixelShaderHandle irradiancePixelShader;
+	PixelShaderHandle envPrefilterPixelShader;
+	PixelShaderHandle brdfLookupMapPixelShader;
 
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> iblBRDFLookupTexture;
 };
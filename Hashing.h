@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+#define HASH_FNV_OFFSET_BASIS 14695981039346656037ull
+#define HASH_FNV_PRIME 1099511628211ull
+
+//-------------------------------------------------------
+// 64 bit FNV-1a hashing for content-addressed caches
+//	- Not cryptographic - only meant to tell generated data
+//	  apart, and cheap enough to run over whole textures
+//	- Chain calls by passing the previous result as a_hash
+//-------------------------------------------------------
+namespace Hashing
+{
+	inline uint64_t Bytes(const void* a_data, size_t a_size, uint64_t a_hash = HASH_FNV_OFFSET_BASIS)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(a_data);
+		for (size_t i = 0; i < a_size; i++) {
+			a_hash ^= bytes[i];
+			a_hash *= HASH_FNV_PRIME;
+		}
+		return a_hash;
+	}
+
+	// Plain values (ints, floats, POD structs). Structs with padding should be hashed field by field
+	template<typename T>
+	inline uint64_t Value(const T& a_value, uint64_t a_hash = HASH_FNV_OFFSET_BASIS)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be hashed by their bytes");
+		return Bytes(&a_value, sizeof(T), a_hash);
+	}
+
+	inline uint64_t String(const std::string& a_string, uint64_t a_hash = HASH_FNV_OFFSET_BASIS)
+	{
+		a_hash = Value((uint64_t)a_string.size(), a_hash);
+		return Bytes(a_string.data(), a_string.size(), a_hash);
+	}
+
+	// Contents of a file, or a_hash unchanged (with a_bFound false) if it can't be opened
+	inline uint64_t File(const std::string& a_fileName, uint64_t a_hash, bool& a_bFound)
+	{
+		std::ifstream file(a_fileName, std::ios::binary);
+		a_bFound = file.is_open();
+		char buffer[4096];
+		while (file) {
+			file.read(buffer, sizeof(buffer));
+			a_hash = Bytes(buffer, (size_t)file.gcount(), a_hash);
+		}
+		return a_hash;
+	}
+}
@@ -0,0 +1,301 @@
+#include "HeadlessGame.h"
+#include "NullRenderDevice.h"
+
+#include <DirectXMath.h>
+#include <chrono>
+#include <random>
+#include <cstring>
+
+using namespace DirectX;
+
+// Milliseconds between a stage's start and now
+static double MillisecondsSince(std::chrono::steady_clock::time_point a_start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - a_start).count();
+}
+
+//-----------------------------------------------
+// Store the scene description. Nothing is created
+// until Init(), same as Game
+//-----------------------------------------------
+HeadlessGame::HeadlessGame(std::shared_ptr<RenderDevice> a_device, const HeadlessSceneDesc& a_sceneDesc)
+	: m_device(a_device)
+	, m_sceneDesc(a_sceneDesc)
+	, m_farClipDistance(1000.f)
+	, m_vertexConstantBuffer(INVALID_RENDER_HANDLE)
+	, m_lightingConstantBuffer(INVALID_RENDER_HANDLE)
+	, m_lightingConstants(new LightingConstants())
+	, m_lastTimings()
+{
+	if (m_sceneDesc.MeshCount == 0)
+		m_sceneDesc.MeshCount = 1;
+	if (m_sceneDesc.MaterialCount == 0)
+		m_sceneDesc.MaterialCount = 1;
+	if (m_sceneDesc.ShaderCount == 0)
+		m_sceneDesc.ShaderCount = 1;
+}
+
+//-----------------------------------------------
+// Constant buffers belong to the device
+//-----------------------------------------------
+HeadlessGame::~HeadlessGame()
+{
+	m_device->ReleaseBuffer(m_vertexConstantBuffer);
+	m_device->ReleaseBuffer(m_lightingConstantBuffer);
+}
+
+//-----------------------------------------------
+// Build the scene and the buffers it draws with
+//-----------------------------------------------
+void HeadlessGame::Init()
+{
+	m_vertexConstantBuffer = m_device->CreateBuffer(BufferType::Constant, BufferUsage::Dynamic, nullptr, sizeof(VertexConstants));
+	m_lightingConstantBuffer = m_device->CreateBuffer(BufferType::Constant, BufferUsage::Dynamic, nullptr, sizeof(LightingConstants));
+
+	CreateGeometry();
+	CreateEntities();
+	CreateLights();
+	UpdateCamera();
+}
+
+//-----------------------------------------------
+// Same work Entities do in Game::Update: advance
+// every Transform, which dirties its matrices so
+// they get rebuilt during Draw
+//-----------------------------------------------
+void HeadlessGame::Update(float deltaTime, float totalTime)
+{
+	for (HeadlessEntity& entity : m_entities) {
+		entity.EntityTransform.AddAbsoluteRotation(0.f, 0.f, entity.SpinSpeed * deltaTime);
+		entity.EntityTransform.AddAbsolutePosition(0.f, sinf(totalTime + entity.SpinSpeed) * deltaTime, 0.f);
+	}
+}
+
+//-----------------------------------------------
+// CPU half of Renderer::Render
+//	- Lights are binned and packed once per frame
+//	- Draws are sorted by shader/material/mesh/depth
+//	- Constant buffers are bound where PixelShader.hlsl and
+//	  VertexShader.hlsl declare them, as SimpleShader's
+//	  SetShader does
+//	- Each draw packs and uploads its vertex constants,
+//	  then submits its Mesh
+//-----------------------------------------------
+void HeadlessGame::Draw()
+{
+	std::chrono::steady_clock::time_point stageStart = std::chrono::steady_clock::now();
+
+	// Light binning and packing
+	FramePrep::BinLightsByType(m_lights, m_directionalLights, m_pointLights);
+	LightingConstants& lighting = *m_lightingConstants;
+	lighting.AmbientLight = Vector4(0.1f, 0.1f, 0.1f, 1.f);
+	lighting.DirectionalLightCount = (int)(m_directionalLights.size() < HEADLESS_MAX_LIGHTS_OF_SINGLE_TYPE ? m_directionalLights.size() : HEADLESS_MAX_LIGHTS_OF_SINGLE_TYPE);
+	lighting.PointLightCount = (int)(m_pointLights.size() < HEADLESS_MAX_LIGHTS_OF_SINGLE_TYPE ? m_pointLights.size() : HEADLESS_MAX_LIGHTS_OF_SINGLE_TYPE);
+	if (lighting.DirectionalLightCount > 0)
+		std::memcpy(lighting.DirectionalLights, m_directionalLights.data(), sizeof(BasicLight) * lighting.DirectionalLightCount);
+	if (lighting.PointLightCount > 0)
+		std::memcpy(lighting.PointLights, m_pointLights.data(), sizeof(BasicLight) * lighting.PointLightCount);
+	m_device->UpdateBuffer(m_lightingConstantBuffer, &lighting, sizeof(LightingConstants));
+	m_lastTimings.PackLights = MillisecondsSince(stageStart);
+
+	// Draw list
+	stageStart = std::chrono::steady_clock::now();
+	XMMATRIX view = XMLoadFloat4x4(&m_viewMatrix);
+	m_drawItems.clear();
+	for (unsigned int i = 0; i < (unsigned int)m_entities.size(); i++) {
+		HeadlessEntity& entity = m_entities[i];
+		Vector3 position = entity.EntityTransform.GetPosition();
+		float viewDepth = XMVectorGetZ(XMVector3Transform(XMLoadFloat3(&position), view));
+
+		DrawItem item = {};
+		item.Index = i;
+		item.SortKey = FramePrep::MakeOpaqueSortKey(entity.ShaderId, entity.MaterialId, entity.MeshIndex, viewDepth, m_farClipDistance);
+		m_drawItems.push_back(item);
+	}
+	m_lastTimings.BuildDrawList = MillisecondsSince(stageStart);
+
+	stageStart = std::chrono::steady_clock::now();
+	FramePrep::SortDrawItems(m_drawItems, m_drawItemScratch);
+	m_lastTimings.Sort = MillisecondsSince(stageStart);
+
+	// Submission, with per-draw constant packing (what SimpleShader::SetMatrix4x4 + CopyAllBufferData cost)
+	stageStart = std::chrono::steady_clock::now();
+	m_device->SetConstantBuffer(ShaderStage::Vertex, 0, m_vertexConstantBuffer);
+	m_device->SetConstantBuffer(ShaderStage::Pixel, 1, m_lightingConstantBuffer);
+	VertexConstants constants = {};
+	constants.ViewMatrix = m_viewMatrix;
+	constants.ProjectionMatrix = m_projectionMatrix;
+	for (const DrawItem& item : m_drawItems) {
+		HeadlessEntity& entity = m_entities[item.Index];
+		constants.WorldTransform = entity.EntityTransform.GetWorldTransformMatrix();
+		constants.WorldInvTranspose = entity.EntityTransform.GetWorldTransformMatrixInverseTranspose();
+		m_device->UpdateBuffer(m_vertexConstantBuffer, &constants, sizeof(VertexConstants));
+
+		m_geometry[entity.MeshIndex]->Draw();
+	}
+	m_lastTimings.Submit = MillisecondsSince(stageStart);
+}
+
+//-----------------------------------------------
+// Fixed-timestep loop, equivalent to DXCore::Run
+// minus the window messages
+//-----------------------------------------------
+HeadlessReport HeadlessGame::Run(unsigned int a_frameCount, double a_fixedTimestep)
+{
+	HeadlessReport report = {};
+	report.FrameCount = a_frameCount;
+
+	m_clock.SetFixedTimestep(a_fixedTimestep);
+	m_clock.Reset();
+
+	double* averages = &report.Average.Update;
+	double* minimums = &report.Minimum.Update;
+	double* maximums = &report.Maximum.Update;
+	const int stageCount = sizeof(HeadlessStageTimings) / sizeof(double);
+	for (int stage = 0; stage < stageCount; stage++) {
+		minimums[stage] = 1e30;
+	}
+
+	for (unsigned int frame = 0; frame < a_frameCount; frame++) {
+		m_clock.Tick();
+		std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+		m_device->BeginFrame();
+
+		std::chrono::steady_clock::time_point updateStart = std::chrono::steady_clock::now();
+		Update(m_clock.GetDeltaTime(), m_clock.GetTotalTime());
+		m_lastTimings.Update = MillisecondsSince(updateStart);
+
+		Draw();
+		m_device->EndFrame();
+		m_lastTimings.Total = MillisecondsSince(frameStart);
+
+		const double* timings = &m_lastTimings.Update;
+		for (int stage = 0; stage < stageCount; stage++) {
+			averages[stage] += timings[stage];
+			if (timings[stage] < minimums[stage]) minimums[stage] = timings[stage];
+			if (timings[stage] > maximums[stage]) maximums[stage] = timings[stage];
+		}
+	}
+
+	for (int stage = 0; stage < stageCount; stage++) {
+		averages[stage] = a_frameCount > 0 ? averages[stage] / a_frameCount : 0.0;
+		if (a_frameCount == 0)
+			minimums[stage] = 0.0;
+	}
+
+	report.LastFrameStats = m_device->GetFrameStats();
+	NullRenderDevice* nullDevice = dynamic_cast<NullRenderDevice*>(m_device.get());
+	report.LastFrameCommandHash = nullDevice != nullptr ? nullDevice->GetFrameCommandHash() : 0;
+	return report;
+}
+
+//-----------------------------------------------
+// Procedural spheres of increasing density stand in
+// for the .obj meshes, so no assets are needed
+//-----------------------------------------------
+void HeadlessGame::CreateGeometry()
+{
+	for (unsigned int meshIndex = 0; meshIndex < m_sceneDesc.MeshCount; meshIndex++) {
+		const unsigned int rings = 8 + meshIndex * 8;
+		const unsigned int segments = rings * 2;
+
+		std::vector<Vertex> vertices;
+		std::vector<unsigned int> indices;
+		for (unsigned int ring = 0; ring <= rings; ring++) {
+			float phi = XM_PI * (float)ring / (float)rings;
+			for (unsigned int segment = 0; segment <= segments; segment++) {
+				float theta = XM_2PI * (float)segment / (float)segments;
+
+				Vertex vertex = {};
+				vertex.Normal = Vector3(sinf(phi) * cosf(theta), cosf(phi), sinf(phi) * sinf(theta));
+				vertex.Position = Vector3(vertex.Normal.x * 0.5f, vertex.Normal.y * 0.5f, vertex.Normal.z * 0.5f);
+				vertex.UV = Vector2((float)segment / (float)segments, (float)ring / (float)rings);
+				vertices.push_back(vertex);
+			}
+		}
+		for (unsigned int ring = 0; ring < rings; ring++) {
+			for (unsigned int segment = 0; segment < segments; segment++) {
+				unsigned int topLeft = ring * (segments + 1) + segment;
+				unsigned int bottomLeft = topLeft + segments + 1;
+				indices.push_back(topLeft);
+				indices.push_back(topLeft + 1);
+				indices.push_back(bottomLeft);
+				indices.push_back(topLeft + 1);
+				indices.push_back(bottomLeft + 1);
+				indices.push_back(bottomLeft);
+			}
+		}
+
+		m_geometry.push_back(std::make_shared<Mesh>(vertices, indices, m_device));
+	}
+}
+
+//-----------------------------------------------
+// Scatter entities through the scene with a seeded
+// generator (not rand()) so every run is identical
+//-----------------------------------------------
+void HeadlessGame::CreateEntities()
+{
+	std::mt19937 generator(m_sceneDesc.Seed);
+	std::uniform_real_distribution<float> position(-m_sceneDesc.SceneRadius, m_sceneDesc.SceneRadius);
+	std::uniform_real_distribution<float> scale(0.5f, 2.f);
+	std::uniform_real_distribution<float> spin(-XM_PI, XM_PI);
+
+	m_entities.resize(m_sceneDesc.EntityCount);
+	for (HeadlessEntity& entity : m_entities) {
+		entity.EntityTransform.SetAbsolutePosition(position(generator), position(generator) * 0.25f, position(generator));
+		float uniformScale = scale(generator);
+		entity.EntityTransform.SetAbsoluteScale(uniformScale, uniformScale, uniformScale);
+		entity.MeshIndex = generator() % m_sceneDesc.MeshCount;
+		entity.MaterialId = generator() % m_sceneDesc.MaterialCount;
+		entity.ShaderId = entity.MaterialId % m_sceneDesc.ShaderCount; // Materials own their shaders, like in Game
+		entity.SpinSpeed = spin(generator);
+	}
+}
+
+//-----------------------------------------------
+// Same light setup as Game::CreateLights, scaled to
+// the requested counts
+//-----------------------------------------------
+void HeadlessGame::CreateLights()
+{
+	std::mt19937 generator(m_sceneDesc.Seed + 1);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+	for (unsigned int i = 0; i < m_sceneDesc.DirectionalLightCount; i++) {
+		BasicLight light = {};
+		light.Type = LightType::Directional;
+		XMStoreFloat3(&light.Direction, XMVector3Normalize(XMVectorSet(unit(generator) - 0.5f, -1.f, unit(generator) - 0.5f, 0.f)));
+		light.Color = Vector3(1.f, 1.f, 1.f);
+		light.Intensity = 1.f;
+		m_lights.push_back(light);
+	}
+	for (unsigned int i = 0; i < m_sceneDesc.PointLightCount; i++) {
+		BasicLight light = {};
+		light.Type = LightType::Point;
+		light.Position = Vector3(
+			(unit(generator) * 2.f - 1.f) * m_sceneDesc.SceneRadius,
+			unit(generator) * 10.f,
+			(unit(generator) * 2.f - 1.f) * m_sceneDesc.SceneRadius);
+		light.Color = Vector3(unit(generator), unit(generator), unit(generator));
+		light.Range = 10.f;
+		light.Intensity = 1.f;
+		m_lights.push_back(light);
+	}
+}
+
+//-----------------------------------------------
+// Fixed camera matching Game's starting Camera
+// (same construction as Camera::CalculateViewMatrix/
+// CalculateProjectionMatrix, without Input)
+//-----------------------------------------------
+void HeadlessGame::UpdateCamera()
+{
+	const float nearClipDistance = 0.01f;
+	XMStoreFloat4x4(&m_viewMatrix, XMMatrixLookToLH(
+		XMVectorSet(0.f, 1.5f, -m_sceneDesc.SceneRadius * 1.5f, 1.f),
+		XMLoadFloat3(&Transform::WorldForwardVector),
+		XMLoadFloat3(&Transform::WorldUpwardVector)));
+	XMStoreFloat4x4(&m_projectionMatrix, XMMatrixPerspectiveFovLH(XM_PI / 3.f, 1280.f / 720.f, nearClipDistance, m_farClipDistance));
+}
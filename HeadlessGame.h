@@ -0,0 +1,136 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "FrameClock.h"
+#include "RenderDevice.h"
+#include "FramePrep.h"
+#include "Transform.h"
+#include "Mesh.h"
+#include "Lights.h"
+
+// Matches MAX_LIGHTS_OF_SINGLE_TYPE in PixelShader.hlsl
+#define HEADLESS_MAX_LIGHTS_OF_SINGLE_TYPE 64
+
+//-------------------------------------------------------
+// Describes the synthetic scene the headless driver builds
+//	- Ids stand in for shaders/materials so draws can be
+//	  sorted exactly like the Renderer does, without any
+//	  D3D-bound SimpleShader or Material objects
+//-------------------------------------------------------
+struct HeadlessSceneDesc {
+	unsigned int EntityCount = 1000;
+	unsigned int MeshCount = 4;
+	unsigned int MaterialCount = 16;
+	unsigned int ShaderCount = 2;
+	unsigned int DirectionalLightCount = 1;
+	unsigned int PointLightCount = 32;
+	unsigned int Seed = 1;
+	float SceneRadius = 50.f;
+};
+
+// CPU cost of each frame stage, in milliseconds
+struct HeadlessStageTimings {
+	double Update;
+	double BuildDrawList;
+	double Sort;
+	double PackLights;
+	double Submit; // Includes per-draw constant packing, same as SimpleShader does during Entity::Draw
+	double Total;
+};
+
+// Summary of a run of frames
+struct HeadlessReport {
+	unsigned int FrameCount;
+	HeadlessStageTimings Average;
+	HeadlessStageTimings Minimum;
+	HeadlessStageTimings Maximum;
+	RenderDeviceStats LastFrameStats;
+	unsigned long long LastFrameCommandHash; // Only meaningful on a NullRenderDevice, otherwise 0
+};
+
+//-------------------------------------------------------
+// Drives the CPU half of a frame without a window or GPU
+//	- Mirrors Game/Renderer: Update moves Transforms, Draw
+//	  bins lights, builds and sorts the draw list, packs
+//	  constants and submits Meshes through a RenderDevice
+//	- Uses a fixed-timestep FrameClock, so two runs with the
+//	  same scene produce identical submissions and any change
+//	  in timing is the code's fault, not the simulation's
+//	- Works with any RenderDevice, but is intended for
+//	  NullRenderDevice in CI and on non-Windows machines
+//-------------------------------------------------------
+class HeadlessGame
+{
+public:
+	HeadlessGame(std::shared_ptr<RenderDevice> a_device, const HeadlessSceneDesc& a_sceneDesc);
+	~HeadlessGame();
+
+	void Init();
+	void Update(float deltaTime, float totalTime);
+	void Draw();
+
+	// Run a_frameCount frames at a fixed timestep, timing every stage
+	HeadlessReport Run(unsigned int a_frameCount, double a_fixedTimestep);
+
+	FrameClock& GetClock() { return m_clock; }
+	const HeadlessStageTimings& GetLastFrameTimings() const { return m_lastTimings; }
+
+private:
+	// Stand-in for an Entity: a Transform plus the ids of what it is drawn with
+	struct HeadlessEntity {
+		Transform EntityTransform;
+		unsigned int MeshIndex;
+		unsigned int MaterialId;
+		unsigned int ShaderId;
+		float SpinSpeed;
+	};
+
+	// Layout of VertexConstantData in VertexShader.hlsl
+	struct VertexConstants {
+		Matrix4 WorldTransform;
+		Matrix4 WorldInvTranspose;
+		Matrix4 ViewMatrix;
+		Matrix4 ProjectionMatrix;
+	};
+
+	// Layout of PixelLightingData in PixelShader.hlsl
+	struct LightingConstants {
+		Vector4 AmbientLight;
+		BasicLight DirectionalLights[HEADLESS_MAX_LIGHTS_OF_SINGLE_TYPE];
+		BasicLight PointLights[HEADLESS_MAX_LIGHTS_OF_SINGLE_TYPE];
+		int DirectionalLightCount;
+		int PointLightCount;
+		int _padding[2];
+	};
+
+	void CreateGeometry();
+	void CreateEntities();
+	void CreateLights();
+	void UpdateCamera();
+
+	std::shared_ptr<RenderDevice> m_device;
+	HeadlessSceneDesc m_sceneDesc;
+	FrameClock m_clock;
+
+	std::vector<std::shared_ptr<Mesh>> m_geometry;
+	std::vector<HeadlessEntity> m_entities;
+	std::vector<BasicLight> m_lights;
+
+	Matrix4 m_viewMatrix;
+	Matrix4 m_projectionMatrix;
+	float m_farClipDistance;
+
+	RenderHandle m_vertexConstantBuffer;
+	RenderHandle m_lightingConstantBuffer;
+
+	// Per-frame scratch, reused between frames like the Renderer's
+	std::vector<DrawItem> m_drawItems;
+	std::vector<DrawItem> m_drawItemScratch;
+	std::vector<BasicLight> m_directionalLights;
+	std::vector<BasicLight> m_pointLights;
+	std::unique_ptr<LightingConstants> m_lightingConstants; // Large, so kept off the stack
+
+	HeadlessStageTimings m_lastTimings;
+};
@@ -0,0 +1,2784 @@
+// Entry point for the headless tool build. Only compiled in when ENGINE_HEADLESS
+// is defined, so it sits harmlessly next to Main.cpp in the Windows project
+#ifdef ENGINE_HEADLESS
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+
+#include "NullRenderDevice.h"
+#include "HeadlessGame.h"
+#include "JobSystem.h"
+#include "SSAOReference.h"
+#include "SphericalHarmonics.h"
+#include "IBLBaker.h"
+#include "DDSFile.h"
+#include "BRDFLookupTable.h"
+#include "ReflectionProbeScheduler.h"
+#include "Culling.h"
+#include "BVH.h"
+#include "OcclusionCulling.h"
+#include "MeshSimplifier.h"
+#include "Meshlets.h"
+#include "PngDecoder.h"
+#include "TextureCooker.h"
+#include "TextureStreamer.h"
+#include "AssetPool.h"
+#include "AssetFiles.h"
+#include "AssetBuilder.h"
+#include "ShaderReflection.h"
+#include "FramePrep.h"
+
+//-------------------------------------------------------
+// Each command is "name [args...]". New tools get added
+// to the table at the bottom of this file
+//-------------------------------------------------------
+typedef int (*HeadlessCommandFunction)(int argc, char* argv[]);
+
+struct HeadlessCommand {
+	const char* Name;
+	HeadlessCommandFunction Function;
+	const char* Usage;
+};
+
+// Reads "--name value" style options, falling back to a default
+static const char* FindOption(int argc, char* argv[], const char* a_name, const char* a_default)
+{
+	for (int i = 0; i < argc - 1; i++) {
+		if (std::strcmp(argv[i], a_name) == 0)
+			return argv[i + 1];
+	}
+	return a_default;
+}
+
+static unsigned int FindUIntOption(int argc, char* argv[], const char* a_name, unsigned int a_default)
+{
+	const char* value = FindOption(argc, argv, a_name, nullptr);
+	return value != nullptr ? (unsigned int)std::strtoul(value, nullptr, 10) : a_default;
+}
+
+static bool HasFlag(int argc, char* argv[], const char* a_name)
+{
+	for (int i = 0; i < argc; i++) {
+		if (std::strcmp(argv[i], a_name) == 0)
+			return true;
+	}
+	return false;
+}
+
+static void PrintStage(const char* a_name, double a_average, double a_minimum, double a_maximum)
+{
+	std::printf("  %-16s avg %8.4f ms   min %8.4f ms   max %8.4f ms\n", a_name, a_average, a_minimum, a_maximum);
+}
+
+//-------------------------------------------------------
+// Run the CPU half of the frame on the null device and
+// report per-stage timings plus submission stats
+//	- The command hash is stable for a given scene, so CI
+//	  can check it to catch accidental submission changes
+//-------------------------------------------------------
+static int RunFrameBenchmark(int argc, char* argv[])
+{
+	HeadlessSceneDesc sceneDesc;
+	sceneDesc.EntityCount = FindUIntOption(argc, argv, "--entities", sceneDesc.EntityCount);
+	sceneDesc.MeshCount = FindUIntOption(argc, argv, "--meshes", sceneDesc.MeshCount);
+	sceneDesc.MaterialCount = FindUIntOption(argc, argv, "--materials", sceneDesc.MaterialCount);
+	sceneDesc.PointLightCount = FindUIntOption(argc, argv, "--point-lights", sceneDesc.PointLightCount);
+	sceneDesc.Seed = FindUIntOption(argc, argv, "--seed", sceneDesc.Seed);
+	unsigned int frameCount = FindUIntOption(argc, argv, "--frames", 600);
+	double timestep = std::atof(FindOption(argc, argv, "--timestep", "0.0166666667"));
+
+	std::shared_ptr<NullRenderDevice> device = std::make_shared<NullRenderDevice>();
+	device->SetRecording(HasFlag(argc, argv, "--record"));
+
+	HeadlessGame game(device, sceneDesc);
+	game.Init();
+	HeadlessReport report = game.Run(frameCount, timestep);
+
+	std::printf("frame-bench: %u frames, %u entities, %u meshes, %u materials, %u point lights\n",
+		report.FrameCount, sceneDesc.EntityCount, sceneDesc.MeshCount, sceneDesc.MaterialCount, sceneDesc.PointLightCount);
+	PrintStage("update", report.Average.Update, report.Minimum.Update, report.Maximum.Update);
+	PrintStage("light packing", report.Average.PackLights, report.Minimum.PackLights, report.Maximum.PackLights);
+	PrintStage("draw list", report.Average.BuildDrawList, report.Minimum.BuildDrawList, report.Maximum.BuildDrawList);
+	PrintStage("sort", report.Average.Sort, report.Minimum.Sort, report.Maximum.Sort);
+	PrintStage("submit", report.Average.Submit, report.Minimum.Submit, report.Maximum.Submit);
+	PrintStage("total", report.Average.Total, report.Minimum.Total, report.Maximum.Total);
+
+	const RenderDeviceStats& stats = report.LastFrameStats;
+	std::printf("last frame: %u draws, %llu triangles, %u buffer updates (%llu bytes), %u VB binds, %u IB binds, %u CB binds, %u redundant binds skipped\n",
+		stats.DrawCalls + stats.IndexedDrawCalls, stats.PrimitivesSubmitted, stats.BufferUpdates, stats.BytesUploaded,
+		stats.VertexBufferBinds, stats.IndexBufferBinds, stats.ConstantBufferBinds, stats.RedundantBindsSkipped);
+	std::printf("command hash: %016llx (%zu commands recorded)\n", report.LastFrameCommandHash, device->GetRecordedCommands().size());
+	return 0;
+}
+
+// Best-of-N wall time for a piece of work, in milliseconds
+template<typename Function>
+static double TimeBestOf(unsigned int a_runs, Function a_function)
+{
+	double best = 0.0;
+	for (unsigned int i = 0; i < a_runs; i++) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		a_function();
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (i == 0 || elapsed < best)
+			best = elapsed;
+	}
+	return best;
+}
+
+static void PrintComparison(const char* a_name, const SSAOComparison& a_comparison, float a_tolerance)
+{
+	std::printf("  %-24s max %.6f   mean %.6f   %u / %u pixels over %.4f\n", a_name,
+		a_comparison.MaxError, a_comparison.MeanError, a_comparison.PixelsOverTolerance, a_comparison.PixelCount, a_tolerance);
+}
+
+//-------------------------------------------------------
+// Time the CPU SSAO reference and check its variants
+// agree with each other (and with the GPU, when given a
+// capture from the Renderer)
+//	- Returns non-zero when anything is out of tolerance,
+//	  so it can gate shader changes in CI
+//-------------------------------------------------------
+static int RunSSAOBenchmark(int argc, char* argv[])
+{
+	unsigned int runs = FindUIntOption(argc, argv, "--runs", 3);
+	float tolerance = (float)std::atof(FindOption(argc, argv, "--tolerance", "0.02"));
+	const char* captureFile = FindOption(argc, argv, "--capture", nullptr);
+
+	SSAOGBuffer gbuffer;
+	SSAOSettings settings;
+	if (captureFile != nullptr) {
+		if (!SSAOReference::LoadCapture(captureFile, gbuffer, settings)) {
+			std::printf("ssao-bench: could not load capture '%s'\n", captureFile);
+			return 1;
+		}
+	}
+	else {
+		unsigned int seed = FindUIntOption(argc, argv, "--seed", 1);
+		SSAOReference::GenerateSyntheticGBuffer(
+			FindUIntOption(argc, argv, "--width", 1280), FindUIntOption(argc, argv, "--height", 720), seed, gbuffer);
+		SSAOReference::GenerateKernel(settings.Offsets, SSAO_MAX_SAMPLES, seed);
+		SSAOReference::GenerateRandomTexture(settings.RandomTexture, seed);
+	}
+	settings.Samples = FindUIntOption(argc, argv, "--samples", settings.Samples);
+
+	std::vector<float> scalarResult;
+	std::vector<float> simdResult;
+	std::vector<float> threadedResult;
+	double scalarTime = TimeBestOf(runs, [&]() { SSAOReference::Compute(gbuffer, settings, scalarResult, false, false); });
+	double simdTime = TimeBestOf(runs, [&]() { SSAOReference::Compute(gbuffer, settings, simdResult, false, true); });
+	double threadedTime = TimeBestOf(runs, [&]() { SSAOReference::Compute(gbuffer, settings, threadedResult, true, true); });
+
+	double pixels = (double)gbuffer.Width * gbuffer.Height;
+	std::printf("ssao-bench: %ux%u %s, %u samples, radius %.2f, %u threads\n", gbuffer.Width, gbuffer.Height,
+		captureFile != nullptr ? "capture" : "synthetic", settings.Samples, settings.Radius, JobSystem::GetInstance().GetThreadCount());
+	std::printf("  %-24s %10.3f ms   %8.2f Mpix/s\n", "scalar, 1 thread", scalarTime, pixels / (scalarTime * 1000.0));
+	std::printf("  %-24s %10.3f ms   %8.2f Mpix/s\n", "SIMD, 1 thread", simdTime, pixels / (simdTime * 1000.0));
+	std::printf("  %-24s %10.3f ms   %8.2f Mpix/s\n", "SIMD, all threads", threadedTime, pixels / (threadedTime * 1000.0));
+
+	// SIMD and scalar only differ by summation order, so they get a much tighter bound than the GPU
+	float simdTolerance = 1e-4f;
+	SSAOComparison simdComparison = SSAOReference::Compare(scalarResult, simdResult, simdTolerance);
+	SSAOComparison threadedComparison = SSAOReference::Compare(simdResult, threadedResult, 0.f);
+	PrintComparison("SIMD vs scalar", simdComparison, simdTolerance);
+	PrintComparison("threaded vs SIMD", threadedComparison, 0.f);
+	bool bPassed = simdComparison.PixelsOverTolerance == 0 && threadedComparison.PixelsOverTolerance == 0;
+
+	// Blur variants. A box kernel is separable, so the two-pass blur must match the 5x5 one
+	std::vector<float> boxBlur;
+	std::vector<float> separableBlur;
+	std::vector<float> bilateralBlur;
+	std::vector<float> linearDepths;
+	SSAOReference::LinearizeDepths(gbuffer, linearDepths);
+	double boxTime = TimeBestOf(runs, [&]() { SSAOReference::BlurBox(threadedResult, boxBlur, gbuffer.Width, gbuffer.Height); });
+	double separableTime = TimeBestOf(runs, [&]() {
+		SSAOReference::BlurSeparable(threadedResult, separableBlur, gbuffer.Width, gbuffer.Height, nullptr, 0.f, false); });
+	double bilateralTime = TimeBestOf(runs, [&]() {
+		SSAOReference::BlurSeparable(threadedResult, bilateralBlur, gbuffer.Width, gbuffer.Height, &linearDepths, 0.1f, false); });
+	std::printf("  %-24s %10.3f ms\n", "5x5 box blur", boxTime);
+	std::printf("  %-24s %10.3f ms\n", "separable blur", separableTime);
+	std::printf("  %-24s %10.3f ms\n", "bilateral blur", bilateralTime);
+
+	SSAOComparison blurComparison = SSAOReference::Compare(boxBlur, separableBlur, simdTolerance);
+	PrintComparison("separable vs 5x5 blur", blurComparison, simdTolerance);
+	bPassed = bPassed && blurComparison.PixelsOverTolerance == 0;
+
+	// Reduced resolution: downsample, AO, bilateral upsample. The error against full resolution is
+	// informational only - it depends entirely on the scene
+	unsigned int factor = FindUIntOption(argc, argv, "--resolution", 2);
+	if (factor > 1) {
+		SSAOGBuffer reduced;
+		std::vector<float> reducedResult;
+		std::vector<float> upsampledResult;
+		double reducedTime = TimeBestOf(runs, [&]() {
+			SSAOReference::DownsampleGBuffer(gbuffer, factor, reduced);
+			SSAOReference::Compute(reduced, settings, reducedResult, true, true);
+			SSAOReference::UpsampleBilateral(reducedResult, reduced, gbuffer, factor, 0.05f, upsampledResult);
+		});
+		char name[32];
+		std::snprintf(name, sizeof(name), "1/%u res, all threads", factor);
+		std::printf("  %-24s %10.3f ms   %6.2fx faster\n", name, reducedTime, threadedTime / reducedTime);
+
+		// Compare after blurring, since that is what reaches the screen
+		std::vector<float> upsampledBlur;
+		SSAOReference::BlurSeparable(upsampledResult, upsampledBlur, gbuffer.Width, gbuffer.Height, nullptr, 0.f, false);
+		PrintComparison("blurred 1/N vs full", SSAOReference::Compare(separableBlur, upsampledBlur, tolerance), tolerance);
+	}
+
+	// Temporal accumulation over synthetic frames with a sliding camera. Only whole cycles of slices are
+	// resolved, so a static camera must match the full kernel once at least one cycle has run. A moving
+	// camera is informational
+	unsigned int temporalFrames = FindUIntOption(argc, argv, "--temporal", 0);
+	if (temporalFrames > 0 && captureFile == nullptr) {
+		float cameraStep = (float)std::atof(FindOption(argc, argv, "--camera-step", "0.02"));
+		unsigned int seed = FindUIntOption(argc, argv, "--seed", 1);
+		SSAOTemporalSettings temporalSettings;
+		SSAOTemporalHistory history;
+		SSAOGBuffer frame;
+		SSAOSettings frameSettings = settings;
+		frameSettings.Samples = temporalSettings.SamplesPerFrame;
+		std::vector<float> frameResult;
+		std::vector<float> accumulated;
+		double temporalTime = 0.0;
+		for (unsigned int i = 0; i < temporalFrames; i++) {
+			SSAOReference::GenerateSyntheticGBuffer(gbuffer.Width, gbuffer.Height, seed, frame, cameraStep * i);
+			frameSettings.SampleStart = (i * frameSettings.Samples) % SSAO_MAX_SAMPLES;
+			temporalTime += TimeBestOf(1, [&]() {
+				SSAOReference::Compute(frame, frameSettings, frameResult, true, true);
+				SSAOReference::TemporalResolve(frame, frameResult, temporalSettings, history, accumulated);
+			});
+		}
+		std::printf("  %-24s %10.3f ms   %6.2fx faster\n", "temporal, per frame", temporalTime / temporalFrames,
+			threadedTime * temporalFrames / temporalTime);
+
+		std::vector<float> fullResult;
+		SSAOSettings fullSettings = settings;
+		fullSettings.Samples = SSAO_MAX_SAMPLES;
+		SSAOReference::Compute(frame, fullSettings, fullResult, true, true);
+		PrintComparison("one frame vs full", SSAOReference::Compare(fullResult, frameResult, tolerance), tolerance);
+		SSAOComparison temporalComparison = SSAOReference::Compare(fullResult, accumulated, tolerance);
+		PrintComparison("accumulated vs full", temporalComparison, tolerance);
+		if (cameraStep == 0.f && temporalFrames >= SSAOReference::GetCycleFrames(temporalSettings))
+			bPassed = bPassed && temporalComparison.MaxError < simdTolerance;
+	}
+
+	// GPU filtering runs at reduced precision and output is 8 bit, so allow a small fraction of pixels through
+	if (!gbuffer.GPUResult.empty()) {
+		SSAOComparison gpuComparison = SSAOReference::Compare(gbuffer.GPUResult, scalarResult, tolerance);
+		PrintComparison("GPU vs scalar", gpuComparison, tolerance);
+		bPassed = bPassed && gpuComparison.PixelsOverTolerance <= gpuComparison.PixelCount / 1000;
+	}
+
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Time the SH9 irradiance projection and check it against
+// the brute-force integral IBLIrradianceMapPS computed
+//	- Compared on a 16x16 grid per face, relative to the
+//	  brightest reference value. SH9 can't represent sharp
+//	  lights exactly, so the default tolerance allows a few
+//	  percent of ringing
+//-------------------------------------------------------
+static int RunSHBenchmark(int argc, char* argv[])
+{
+	unsigned int runs = FindUIntOption(argc, argv, "--runs", 3);
+	unsigned int size = FindUIntOption(argc, argv, "--size", 256);
+	float step = (float)std::atof(FindOption(argc, argv, "--step", "0.05"));
+	float tolerance = (float)std::atof(FindOption(argc, argv, "--tolerance", "0.05"));
+
+	CubemapImage sky;
+	Cubemap::GenerateSyntheticSky(size, sky);
+
+	SH9Color scalarSH;
+	SH9Color simdSH;
+	SH9Color threadedSH;
+	double scalarTime = TimeBestOf(runs, [&]() { SphericalHarmonics::ProjectCubemap(sky, scalarSH, false, false); });
+	double simdTime = TimeBestOf(runs, [&]() { SphericalHarmonics::ProjectCubemap(sky, simdSH, false, true); });
+	double threadedTime = TimeBestOf(runs, [&]() { SphericalHarmonics::ProjectCubemap(sky, threadedSH, true, true); });
+
+	std::printf("sh-bench: %ux%u x6 synthetic sky, %u threads\n", size, size, JobSystem::GetInstance().GetThreadCount());
+	std::printf("  %-24s %10.3f ms\n", "scalar, 1 thread", scalarTime);
+	std::printf("  %-24s %10.3f ms\n", "SIMD, 1 thread", simdTime);
+	std::printf("  %-24s %10.3f ms\n", "SIMD, all threads", threadedTime);
+
+	// Variants only differ by float summation order within a row
+	float largestDifference = 0.f;
+	for (int i = 0; i < SH_COEFFICIENT_COUNT; i++) {
+		const float* scalar = &scalarSH.Coefficients[i].x;
+		const float* simd = &simdSH.Coefficients[i].x;
+		const float* threaded = &threadedSH.Coefficients[i].x;
+		for (int c = 0; c < 3; c++) {
+			largestDifference = std::fmax(largestDifference, std::fabs(scalar[c] - simd[c]));
+			largestDifference = std::fmax(largestDifference, std::fabs(simd[c] - threaded[c]));
+		}
+	}
+	std::printf("  %-24s max %.6f\n", "coefficient variance", largestDifference);
+	bool bPassed = largestDifference < 1e-4f;
+
+	// Brute force over the same directions the old 64x64 irradiance cube would have held, subsampled
+	const unsigned int gridSize = 16;
+	SphericalHarmonics::ConvolveIrradiance(threadedSH);
+	float largestReference = 0.f;
+	float largestError = 0.f;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int face = 0; face < CUBEMAP_FACE_COUNT; face++) {
+		for (unsigned int y = 0; y < gridSize; y++) {
+			for (unsigned int x = 0; x < gridSize; x++) {
+				Vector3 normal = Cubemap::CubeDirectionFromUV(face, (x + 0.5f) / gridSize, (y + 0.5f) / gridSize);
+				Vector3 reference = SphericalHarmonics::IntegrateIrradiance(sky, normal, step, step);
+				Vector3 approximation = SphericalHarmonics::Evaluate(threadedSH, normal);
+				largestReference = std::fmax(largestReference, std::fmax(reference.x, std::fmax(reference.y, reference.z)));
+				largestError = std::fmax(largestError, std::fabs(reference.x - approximation.x));
+				largestError = std::fmax(largestError, std::fabs(reference.y - approximation.y));
+				largestError = std::fmax(largestError, std::fabs(reference.z - approximation.z));
+			}
+		}
+	}
+	double bruteForceTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	double texelsPerCube = 64.0 * 64.0 * CUBEMAP_FACE_COUNT;
+	std::printf("  %-24s %10.3f ms   (%.1f ms estimated for a 64x64 cube)\n", "brute force, 16x16 grid", bruteForceTime,
+		bruteForceTime * texelsPerCube / (gridSize * gridSize * CUBEMAP_FACE_COUNT));
+
+	float relativeError = largestReference > 0.f ? largestError / largestReference : 0.f;
+	std::printf("  %-24s max %.6f   relative %.4f (tolerance %.4f)\n", "SH9 vs brute force", largestError, relativeError, tolerance);
+	bPassed = bPassed && relativeError <= tolerance;
+
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Bake the GGX prefiltered specular cube on the CPU and
+// write it as a DDS that Sky::LoadSpecularReflectanceMap
+// picks up instead of prefiltering at startup
+//	- Input is an uncompressed cube DDS, or a synthetic sky
+//	- --compare also runs the single threaded scalar path
+//	  and checks it matches
+//-------------------------------------------------------
+static int RunIBLBake(int argc, char* argv[])
+{
+	const char* skyFile = FindOption(argc, argv, "--sky", nullptr);
+	const char* outFile = FindOption(argc, argv, "--out", "specular.dds");
+
+	std::vector<CubemapImage> source(1);
+	if (skyFile != nullptr) {
+		if (!DDSFile::ReadCubemap(skyFile, source)) {
+			std::printf("ibl-bake: could not read an uncompressed cube from '%s'\n", skyFile);
+			return 1;
+		}
+		source.resize(1); // Mips are rebuilt below so the whole chain is available
+	}
+	else {
+		Cubemap::GenerateSyntheticSky(FindUIntOption(argc, argv, "--synthetic", 512), source[0]);
+	}
+
+	IBLBakeSettings settings;
+	settings.Size = FindUIntOption(argc, argv, "--size", source[0].Size / 8 > 0 ? source[0].Size / 8 : 1); // Sky uses 1/8 of the sky size
+	settings.MipCount = FindUIntOption(argc, argv, "--mips", 0);
+	settings.SampleCount = FindUIntOption(argc, argv, "--samples", settings.SampleCount);
+	settings.bFilteredImportanceSampling = !HasFlag(argc, argv, "--no-fis");
+
+	std::vector<CubemapImage> output;
+	double mipTime = TimeBestOf(1, [&]() { Cubemap::BuildMipChain(source, true); });
+	double bakeTime = TimeBestOf(1, [&]() { IBLBaker::PrefilterSpecular(source, settings, output, true, true); });
+	std::printf("ibl-bake: %ux%u sky -> %ux%u, %u mips, %u samples%s, %u threads\n", source[0].Size, source[0].Size,
+		settings.Size, settings.Size, IBLBaker::GetMipCount(settings), settings.SampleCount,
+		settings.bFilteredImportanceSampling ? " (filtered)" : "", JobSystem::GetInstance().GetThreadCount());
+	std::printf("  %-24s %10.3f ms\n", "source mip chain", mipTime);
+	std::printf("  %-24s %10.3f ms\n", "prefilter, all threads", bakeTime);
+
+	bool bPassed = true;
+	if (HasFlag(argc, argv, "--compare")) {
+		std::vector<CubemapImage> scalarOutput;
+		double scalarTime = TimeBestOf(1, [&]() { IBLBaker::PrefilterSpecular(source, settings, scalarOutput, false, false); });
+		float largestDifference = 0.f;
+		for (size_t mip = 0; mip < output.size(); mip++) {
+			for (size_t i = 0; i < output[mip].Texels.size(); i++) {
+				largestDifference = std::fmax(largestDifference, std::fabs(output[mip].Texels[i].x - scalarOutput[mip].Texels[i].x));
+				largestDifference = std::fmax(largestDifference, std::fabs(output[mip].Texels[i].y - scalarOutput[mip].Texels[i].y));
+				largestDifference = std::fmax(largestDifference, std::fabs(output[mip].Texels[i].z - scalarOutput[mip].Texels[i].z));
+			}
+		}
+		std::printf("  %-24s %10.3f ms   max difference %.6f\n", "prefilter, scalar", scalarTime, largestDifference);
+		bPassed = largestDifference < 1e-4f;
+	}
+
+	if (!DDSFile::WriteCubemap(outFile, output)) {
+		std::printf("ibl-bake: could not write '%s'\n", outFile);
+		return 1;
+	}
+	std::printf("  wrote %s\n", outFile);
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Generate the split-sum BRDF table on the CPU and report
+// its error against the 1024x1024 table the GPU renders
+//	- --header writes the table as a C++ array, which is
+//	  how BRDFLookupTableData.h is produced
+//	- --analytic evaluates the polynomial fit instead, to
+//	  see what dropping the table entirely would cost
+//	- --format picks the texel precision. The table is
+//	  rounded to it before being compared, so the error
+//	  is what the shader would actually read
+//-------------------------------------------------------
+static int RunBRDFLookupTable(int argc, char* argv[])
+{
+	unsigned int runs = FindUIntOption(argc, argv, "--runs", 3);
+	float tolerance = (float)std::atof(FindOption(argc, argv, "--tolerance", "0.01")); // On the 99th percentile error
+	const char* headerFile = FindOption(argc, argv, "--header", nullptr);
+
+	BRDFLookupSettings settings;
+	settings.Size = FindUIntOption(argc, argv, "--size", settings.Size);
+	settings.SampleCount = FindUIntOption(argc, argv, "--samples", settings.SampleCount);
+	settings.bAnalyticFit = HasFlag(argc, argv, "--analytic");
+	const char* formatName = FindOption(argc, argv, "--format", "unorm16");
+	if (std::strcmp(formatName, "unorm8") == 0)
+		settings.Format = BRDFLookupFormat::R8G8_UNORM;
+	else if (std::strcmp(formatName, "float16") == 0)
+		settings.Format = BRDFLookupFormat::R16G16_FLOAT;
+	else if (std::strcmp(formatName, "float32") == 0)
+		settings.Format = BRDFLookupFormat::R32G32_FLOAT;
+	else if (std::strcmp(formatName, "unorm16") != 0) {
+		std::printf("brdf-lut: unknown format '%s'\n", formatName);
+		return 1;
+	}
+	BRDFLookupSettings referenceSettings;
+	referenceSettings.Size = FindUIntOption(argc, argv, "--reference-size", BRDF_LUT_REFERENCE_SIZE);
+	referenceSettings.SampleCount = FindUIntOption(argc, argv, "--reference-samples", BRDF_LUT_DEFAULT_SAMPLES);
+	if (settings.Size == 0 || referenceSettings.Size == 0) {
+		std::printf("brdf-lut: sizes must be non-zero\n");
+		return 1;
+	}
+
+	// Variants are timed and checked unrounded, as rounding could turn a float rounding difference into a whole step
+	BRDFLookupSettings variantSettings = settings;
+	variantSettings.Format = BRDFLookupFormat::R32G32_FLOAT;
+	std::vector<Vector2> scalarTable;
+	std::vector<Vector2> simdTable;
+	std::vector<Vector2> threadedTable;
+	double scalarTime = TimeBestOf(runs, [&]() { BRDFLookupTable::Generate(variantSettings, scalarTable, false, false); });
+	double simdTime = TimeBestOf(runs, [&]() { BRDFLookupTable::Generate(variantSettings, simdTable, false, true); });
+	double threadedTime = TimeBestOf(runs, [&]() { BRDFLookupTable::Generate(variantSettings, threadedTable, true, true); });
+	std::vector<Vector2> table;
+	BRDFLookupTable::Generate(settings, table, true, true);
+
+	std::printf("brdf-lut: %ux%u%s %s, %u samples, %u threads\n", settings.Size, settings.Size,
+		settings.bAnalyticFit ? " analytic fit" : "", BRDFLookupTable::GetFormatName(settings.Format), settings.SampleCount,
+		JobSystem::GetInstance().GetThreadCount());
+	std::printf("  %-24s %10.3f ms\n", "scalar, 1 thread", scalarTime);
+	std::printf("  %-24s %10.3f ms\n", "SIMD, 1 thread", simdTime);
+	std::printf("  %-24s %10.3f ms\n", "SIMD, all threads", threadedTime);
+
+	// Variants only differ by float rounding
+	float largestDifference = 0.f;
+	for (size_t i = 0; i < threadedTable.size(); i++) {
+		largestDifference = std::fmax(largestDifference, std::fabs(scalarTable[i].x - simdTable[i].x));
+		largestDifference = std::fmax(largestDifference, std::fabs(scalarTable[i].y - simdTable[i].y));
+		largestDifference = std::fmax(largestDifference, std::fabs(simdTable[i].x - threadedTable[i].x));
+		largestDifference = std::fmax(largestDifference, std::fabs(simdTable[i].y - threadedTable[i].y));
+	}
+	std::printf("  %-24s max %.6f\n", "variant difference", largestDifference);
+	bool bPassed = largestDifference < 1e-4f;
+
+	std::vector<Vector2> reference;
+	double referenceTime = TimeBestOf(1, [&]() { BRDFLookupTable::Generate(referenceSettings, reference, true, true); });
+	BRDFLookupErrorReport report = BRDFLookupTable::Compare(table, settings.Size, reference, referenceSettings.Size);
+	std::printf("  %-24s %10.3f ms   (%ux%u, %u samples)\n", "reference", referenceTime,
+		referenceSettings.Size, referenceSettings.Size, referenceSettings.SampleCount);
+	std::printf("  %-24s max %.6f at NdotV %.3f roughness %.3f\n", "error vs reference",
+		report.MaxError, report.MaxErrorNdotV, report.MaxErrorRoughness);
+	std::printf("  %-24s p99 %.6f   mean %.6f   rms %.6f (tolerance %.4f)\n", "", report.Percentile99Error, report.MeanError, report.RMSError, tolerance);
+	std::printf("  %-24s %10u bytes   (reference %u bytes)\n", "size", settings.Size * settings.Size * BRDFLookupTable::GetBytesPerTexel(settings.Format),
+		referenceSettings.Size * referenceSettings.Size * BRDFLookupTable::GetBytesPerTexel(referenceSettings.Format));
+	bPassed = bPassed && report.Percentile99Error <= tolerance;
+
+	if (headerFile != nullptr) {
+		char comment[512];
+		std::snprintf(comment, sizeof(comment),
+			"Generated by \"headless brdf-lut --size %u --samples %u%s%s%s --header <file>\" - do not edit by hand\n"
+			"Split-sum BRDF table for IBL specular (BRDFLookupTable.h). Bilinear reads are within\n"
+			"%.4f (99th percentile) / %.6f (rms) of the %ux%u table IBLBRDFIntegrateMapPS renders",
+			settings.Size, settings.SampleCount, settings.bAnalyticFit ? " --analytic" : "",
+			settings.Format != BRDFLookupFormat::R16G16_UNORM ? " --format " : "", settings.Format != BRDFLookupFormat::R16G16_UNORM ? formatName : "",
+			report.Percentile99Error, report.RMSError, referenceSettings.Size, referenceSettings.Size);
+		if (!BRDFLookupTable::WriteHeader(headerFile, table, settings.Size, settings.Format, comment)) {
+			std::printf("brdf-lut: could not write '%s'\n", headerFile);
+			return 1;
+		}
+		std::printf("  wrote %s\n", headerFile);
+	}
+
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Simulate many reflection probes under the scheduler and
+// check what a GPU would be asked to do
+//	- No frame exceeds the face or mip budget
+//	- Every update renders all faces, then all mips, then
+//	  publishes - so nothing partial is ever shown
+//	- Reports how long scene changes take to show up, for
+//	  all probes and for the ones nearest the camera
+//-------------------------------------------------------
+static int RunProbeScheduleBenchmark(int argc, char* argv[])
+{
+	unsigned int probeCount = FindUIntOption(argc, argv, "--probes", 64);
+	unsigned int frameCount = FindUIntOption(argc, argv, "--frames", 3600);
+	unsigned int mipCount = FindUIntOption(argc, argv, "--mip-count", 5); // ReflectionProbe's 128 map without 2x2 and 4x4
+	float changeRate = (float)std::atof(FindOption(argc, argv, "--change-rate", "0.002")); // Per probe, per frame
+	unsigned int seed = FindUIntOption(argc, argv, "--seed", 1);
+
+	ReflectionProbeSchedulerSettings settings;
+	settings.FacesPerFrame = FindUIntOption(argc, argv, "--faces", settings.FacesPerFrame);
+	settings.MipsPerFrame = FindUIntOption(argc, argv, "--mips", settings.MipsPerFrame);
+	settings.RefreshInterval = FindUIntOption(argc, argv, "--refresh", settings.RefreshInterval);
+	if (probeCount == 0 || settings.FacesPerFrame == 0 || settings.MipsPerFrame == 0) {
+		std::printf("probe-sched: probes, faces and mips must be non-zero\n");
+		return 1;
+	}
+
+	// Probes scattered through a 200 unit box, camera orbiting through it
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> position(-100.f, 100.f);
+	std::uniform_real_distribution<float> radius(5.f, 15.f);
+	std::uniform_real_distribution<float> chance(0.f, 1.f);
+	ReflectionProbeScheduler scheduler(settings);
+	std::vector<Vector3> positions(probeCount);
+	for (unsigned int i = 0; i < probeCount; i++) {
+		positions[i] = Vector3(position(random), position(random) * 0.1f, position(random));
+		scheduler.AddProbe(positions[i], radius(random), mipCount);
+	}
+
+	// What the GPU side would have done for each probe's current update
+	struct SimulatedProbe {
+		unsigned int FacesDone = 0;
+		unsigned int MipsDone = 0;
+		unsigned int UpdateStartFrame = 0;
+		unsigned int SignatureCounter = 0;
+		int PendingChangeFrame = -1; // Earliest change not yet covered by a started update
+		int CoveredChangeFrame = -1; // Change the in-progress update will show
+	};
+	std::vector<SimulatedProbe> simulated(probeCount);
+
+	unsigned int violations = 0;
+	unsigned int publishCount = 0;
+	unsigned int latencyCount = 0, nearLatencyCount = 0;
+	double latencySum = 0.0, nearLatencySum = 0.0;
+	unsigned int latencyMax = 0, nearLatencyMax = 0;
+	double scheduleTime = 0.0;
+	for (unsigned int frame = 0; frame < frameCount; frame++) {
+		float angle = frame * 0.002f;
+		Vector3 camera(std::cos(angle) * 60.f, 2.f, std::sin(angle) * 60.f);
+
+		for (unsigned int i = 0; i < probeCount; i++) {
+			if (chance(random) < changeRate) {
+				scheduler.SetSceneSignature(i, ++simulated[i].SignatureCounter);
+				if (simulated[i].PendingChangeFrame < 0)
+					simulated[i].PendingChangeFrame = (int)frame;
+			}
+		}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const std::vector<ProbeUpdateStep>& steps = scheduler.Schedule(camera);
+		scheduleTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		unsigned int faces = 0, mips = 0;
+		for (const ProbeUpdateStep& step : steps) {
+			SimulatedProbe& probe = simulated[step.Probe];
+			switch (step.Type) {
+			case ProbeUpdateStepType::RenderFace:
+				faces++;
+				if (step.Index == 0) {
+					// A new update captures every change made before it started
+					probe.FacesDone = 0;
+					probe.MipsDone = 0;
+					probe.UpdateStartFrame = frame;
+					probe.CoveredChangeFrame = probe.PendingChangeFrame;
+					probe.PendingChangeFrame = -1;
+				}
+				violations += step.Index != probe.FacesDone ? 1 : 0;
+				probe.FacesDone++;
+				break;
+			case ProbeUpdateStepType::PrefilterMip:
+				mips++;
+				violations += (probe.FacesDone != PROBE_FACE_COUNT || step.Index != probe.MipsDone) ? 1 : 0;
+				probe.MipsDone++;
+				break;
+			case ProbeUpdateStepType::Publish:
+				violations += (probe.FacesDone != PROBE_FACE_COUNT || probe.MipsDone != mipCount) ? 1 : 0;
+				publishCount++;
+				if (probe.CoveredChangeFrame >= 0) {
+					unsigned int latency = frame - (unsigned int)probe.CoveredChangeFrame;
+					latencySum += latency;
+					latencyCount++;
+					latencyMax = latency > latencyMax ? latency : latencyMax;
+
+					float x = positions[step.Probe].x - camera.x, z = positions[step.Probe].z - camera.z;
+					if (x * x + z * z < 40.f * 40.f) {
+						nearLatencySum += latency;
+						nearLatencyCount++;
+						nearLatencyMax = latency > nearLatencyMax ? latency : nearLatencyMax;
+					}
+				}
+				probe.CoveredChangeFrame = -1;
+				break;
+			}
+		}
+		violations += (faces > settings.FacesPerFrame || mips > settings.MipsPerFrame) ? 1 : 0;
+	}
+
+	unsigned int readyCount = 0;
+	for (unsigned int i = 0; i < probeCount; i++) {
+		readyCount += scheduler.IsProbeReady(i) ? 1 : 0;
+	}
+
+	std::printf("probe-sched: %u probes, %u frames, budget %u faces + %u mips per frame, %u mips per probe\n",
+		probeCount, frameCount, settings.FacesPerFrame, settings.MipsPerFrame, mipCount);
+	std::printf("  %-24s %10.4f ms per frame\n", "schedule", scheduleTime / frameCount);
+	std::printf("  %-24s %10u   (%u of %u probes ready)\n", "publishes", publishCount, readyCount, probeCount);
+	std::printf("  %-24s avg %8.1f   max %6u frames   (%u changes)\n", "change latency, all",
+		latencyCount > 0 ? latencySum / latencyCount : 0.0, latencyMax, latencyCount);
+	std::printf("  %-24s avg %8.1f   max %6u frames   (%u changes)\n", "change latency, < 40u",
+		nearLatencyCount > 0 ? nearLatencySum / nearLatencyCount : 0.0, nearLatencyMax, nearLatencyCount);
+	std::printf("  %-24s %10u\n", "budget/order violations", violations);
+
+	bool bPassed = violations == 0 && readyCount == probeCount;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Compare culling each view separately against the
+// multi-view pass Game::Draw uses
+//	- Views are a camera plus 6 faces per probe, built by
+//	  hand so no DirectXMath functions are needed
+//	- The per-view path transforms bounds again for every
+//	  view, like each renderer culling for itself would.
+//	  The multi-view path transforms once, then tests all
+//	  views per sphere. Masks must match exactly
+//-------------------------------------------------------
+static Matrix4 MakeCubeFaceViewProjection(const Vector3& a_eye, unsigned int a_face, float a_near, float a_far)
+{
+	// Right, up and forward of +X, -X, +Y, -Y, +Z, -Z faces
+	static const float bases[CUBEMAP_FACE_COUNT][9] = {
+		{ 0, 0, -1,  0, 1, 0,  1, 0, 0 }, { 0, 0, 1,  0, 1, 0,  -1, 0, 0 },
+		{ 1, 0, 0,  0, 0, -1,  0, 1, 0 }, { 1, 0, 0,  0, 0, 1,  0, -1, 0 },
+		{ 1, 0, 0,  0, 1, 0,  0, 0, 1 }, { -1, 0, 0,  0, 1, 0,  0, 0, -1 },
+	};
+	const float* b = bases[a_face];
+	float depthScale = a_far / (a_far - a_near);
+	float depthOffset = -a_near * depthScale;
+	float eyeRight = -(b[0] * a_eye.x + b[1] * a_eye.y + b[2] * a_eye.z);
+	float eyeUp = -(b[3] * a_eye.x + b[4] * a_eye.y + b[5] * a_eye.z);
+	float eyeForward = -(b[6] * a_eye.x + b[7] * a_eye.y + b[8] * a_eye.z);
+
+	// LookTo * PerspectiveFov with a 90 degree square frustum
+	return Matrix4(
+		b[0], b[3], b[6] * depthScale, b[6],
+		b[1], b[4], b[7] * depthScale, b[7],
+		b[2], b[5], b[8] * depthScale, b[8],
+		eyeRight, eyeUp, eyeForward * depthScale + depthOffset, eyeForward);
+}
+
+static int RunCullBenchmark(int argc, char* argv[])
+{
+	unsigned int entityCount = FindUIntOption(argc, argv, "--entities", 10000);
+	unsigned int viewCount = FindUIntOption(argc, argv, "--views", 25); // Camera + 4 probes
+	unsigned int runs = FindUIntOption(argc, argv, "--runs", 5);
+	unsigned int seed = FindUIntOption(argc, argv, "--seed", 1);
+	if (viewCount == 0 || viewCount > CULLING_MAX_VIEWS) {
+		std::printf("cull-bench: views must be between 1 and %u\n", CULLING_MAX_VIEWS);
+		return 1;
+	}
+
+	// Unit-ish meshes scattered through a 200 unit box, scaled and placed by their world matrix
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> position(-100.f, 100.f);
+	std::uniform_real_distribution<float> scale(0.5f, 3.f);
+	std::uniform_real_distribution<float> offset(-0.25f, 0.25f);
+	std::vector<Vector4> localBounds(entityCount);
+	std::vector<Matrix4> worlds(entityCount);
+	for (unsigned int i = 0; i < entityCount; i++) {
+		localBounds[i] = Vector4(offset(random), offset(random), offset(random), 1.f);
+		float s = scale(random);
+		worlds[i] = Matrix4(s, 0, 0, 0, 0, s, 0, 0, 0, 0, s, 0, position(random), position(random), position(random), 1);
+	}
+
+	// View 0 looks down +Z from the centre, the rest are probe faces
+	std::vector<Frustum> views(viewCount);
+	Vector3 eye(0.f, 0.f, 0.f);
+	for (unsigned int view = 0; view < viewCount; view++) {
+		if (view > 0 && (view - 1) % CUBEMAP_FACE_COUNT == 0)
+			eye = Vector3(position(random), position(random), position(random));
+		unsigned int face = view == 0 ? 4 : (view - 1) % CUBEMAP_FACE_COUNT;
+		views[view] = Culling::ExtractFrustum(MakeCubeFaceViewProjection(eye, face, 0.1f, view == 0 ? 1000.f : 50.f));
+	}
+
+	std::vector<uint64_t> perViewMasks(entityCount);
+	double perViewTime = TimeBestOf(runs, [&]() {
+		std::fill(perViewMasks.begin(), perViewMasks.end(), 0ull);
+		for (unsigned int view = 0; view < viewCount; view++) {
+			for (unsigned int i = 0; i < entityCount; i++) {
+				Vector4 sphere = Culling::TransformSphere(localBounds[i], worlds[i]);
+				bool bVisible = true;
+				for (int plane = 0; plane < CULLING_PLANE_COUNT && bVisible; plane++) {
+					const Vector4& p = views[view].Planes[plane];
+					bVisible = p.x * sphere.x + p.y * sphere.y + p.z * sphere.z + p.w >= -sphere.w;
+				}
+				perViewMasks[i] |= bVisible ? (1ull << view) : 0ull;
+			}
+		}
+	});
+
+	std::vector<Vector4> worldBounds(entityCount);
+	std::vector<uint64_t> scalarMasks;
+	std::vector<uint64_t> simdMasks;
+	std::vector<uint64_t> masks;
+	double transformTime = TimeBestOf(runs, [&]() {
+		for (unsigned int i = 0; i < entityCount; i++) {
+			worldBounds[i] = Culling::TransformSphere(localBounds[i], worlds[i]);
+		}
+	});
+	double scalarTime = TimeBestOf(runs, [&]() { Culling::CullSpheres(worldBounds, views, scalarMasks, false, false); });
+	double simdTime = TimeBestOf(runs, [&]() { Culling::CullSpheres(worldBounds, views, simdMasks, false, true); });
+	double threadedTime = TimeBestOf(runs, [&]() { Culling::CullSpheres(worldBounds, views, masks, true, true); });
+
+	unsigned int mismatches = 0;
+	for (unsigned int i = 0; i < entityCount; i++) {
+		mismatches += (scalarMasks[i] != perViewMasks[i] || simdMasks[i] != perViewMasks[i] || masks[i] != perViewMasks[i]) ? 1 : 0;
+	}
+	std::vector<unsigned int> visible;
+	Culling::GatherVisible(masks, 0, visible);
+	size_t cameraVisible = visible.size();
+	size_t totalVisible = 0;
+	for (unsigned int view = 0; view < viewCount; view++) {
+		Culling::GatherVisible(masks, view, visible);
+		totalVisible += visible.size();
+	}
+
+	std::printf("cull-bench: %u entities, %u views, %u threads\n", entityCount, viewCount, JobSystem::GetInstance().GetThreadCount());
+	std::printf("  %-24s %10.3f ms\n", "per view, scalar", perViewTime);
+	std::printf("  %-24s %10.3f ms\n", "bounds transform, once", transformTime);
+	std::printf("  %-24s %10.3f ms   (%.2fx with transform)\n", "multi-view, scalar", scalarTime, perViewTime / (transformTime + scalarTime));
+	std::printf("  %-24s %10.3f ms   (%.2fx with transform)\n", "multi-view, SIMD", simdTime, perViewTime / (transformTime + simdTime));
+	std::printf("  %-24s %10.3f ms   (%.2fx with transform)\n", "multi-view, SIMD + MT", threadedTime, perViewTime / (transformTime + threadedTime));
+	std::printf("  %-24s %10zu   (%.1f per view overall)\n", "visible to camera", cameraVisible, (double)totalVisible / viewCount);
+	std::printf("  %-24s %10u\n", "mask mismatches", mismatches);
+
+	bool bPassed = mismatches == 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Build and update a BVH over random entity spheres, then
+// time its queries against walking every entity
+//	- The world grows with the entity count so density,
+//	  and so the number of results, stays about the same.
+//	  BVH times should then grow with log n while the flat
+//	  walks grow with n
+//	- Every query is checked against the flat walk over
+//	  the same fat boxes (rays against the exact spheres)
+//-------------------------------------------------------
+static int RunBVHBenchmark(int argc, char* argv[])
+{
+	unsigned int entityCount = FindUIntOption(argc, argv, "--entities", 100000);
+	unsigned int frameCount = FindUIntOption(argc, argv, "--frames", 10);
+	unsigned int queryCount = FindUIntOption(argc, argv, "--queries", 100);
+	float moveFraction = (float)std::atof(FindOption(argc, argv, "--move-fraction", "0.05"));
+	unsigned int seed = FindUIntOption(argc, argv, "--seed", 1);
+	if (entityCount == 0 || queryCount == 0) {
+		std::printf("bvh-bench: entities and queries must be non-zero\n");
+		return 1;
+	}
+
+	// About one entity per 10x10x10 cell
+	float halfExtent = 5.f * std::cbrt((float)entityCount);
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> position(-halfExtent, halfExtent);
+	std::uniform_real_distribution<float> radius(0.5f, 2.f);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	std::uniform_real_distribution<float> chance(0.f, 1.f);
+	std::vector<Vector4> spheres(entityCount);
+	for (Vector4& sphere : spheres) {
+		sphere = Vector4(position(random), position(random), position(random), radius(random));
+	}
+
+	BVH tree;
+	std::vector<int> proxies(entityCount);
+	double buildTime = TimeBestOf(1, [&]() {
+		for (unsigned int i = 0; i < entityCount; i++) {
+			proxies[i] = tree.CreateProxy(Culling::SphereToAABB(spheres[i]), i);
+		}
+	});
+
+	// Some entities drift a little each frame, like Transforms going dirty
+	unsigned int moveCount = 0;
+	unsigned int reinsertCount = 0;
+	double moveTime = 0.0;
+	for (unsigned int frame = 0; frame < frameCount; frame++) {
+		for (unsigned int i = 0; i < entityCount; i++) {
+			if (chance(random) >= moveFraction)
+				continue;
+			spheres[i].x += unit(random) * 0.5f;
+			spheres[i].y += unit(random) * 0.5f;
+			spheres[i].z += unit(random) * 0.5f;
+		}
+		moveTime += TimeBestOf(1, [&]() {
+			// The same selection is replayed each frame in a real engine from the dirty flags. Here every sphere
+			// is offered and MoveProxy's fat box check rejects the ones that barely moved
+			for (unsigned int i = 0; i < entityCount; i++) {
+				reinsertCount += tree.MoveProxy(proxies[i], Culling::SphereToAABB(spheres[i])) ? 1 : 0;
+			}
+		});
+		moveCount += entityCount;
+	}
+	bool bValid = tree.Validate();
+
+	// Query inputs. Frustums look down +Z with a fixed far plane, so visible counts don't grow with the world
+	std::vector<Frustum> frustums(queryCount);
+	std::vector<Vector3> origins(queryCount);
+	std::vector<Vector3> directions(queryCount);
+	for (unsigned int q = 0; q < queryCount; q++) {
+		origins[q] = Vector3(position(random), position(random), position(random));
+		frustums[q] = Culling::ExtractFrustum(MakeCubeFaceViewProjection(origins[q], q % CUBEMAP_FACE_COUNT, 0.1f, 100.f));
+		Vector3 direction(unit(random), unit(random), unit(random));
+		float length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+		directions[q] = length > 0.f ? Vector3(direction.x / length, direction.y / length, direction.z / length) : Vector3(0.f, 0.f, 1.f);
+	}
+	auto raySphere = [&](unsigned int a_query, unsigned int a_entity) {
+		const Vector4& s = spheres[a_entity];
+		const Vector3& o = origins[a_query];
+		const Vector3& d = directions[a_query];
+		float x = o.x - s.x, y = o.y - s.y, z = o.z - s.z;
+		float b = x * d.x + y * d.y + z * d.z;
+		float c = x * x + y * y + z * z - s.w * s.w;
+		float discriminant = b * b - c;
+		if (discriminant < 0.f)
+			return -1.f;
+		float distance = -b - std::sqrt(discriminant);
+		return distance >= 0.f ? distance : (c <= 0.f ? 0.f : -1.f);
+	};
+	const float rayLength = 200.f;
+	const float queryRadius = 10.f;
+
+	unsigned int mismatches = 0;
+	size_t frustumResults = 0;
+	std::vector<unsigned int> results;
+	std::vector<unsigned int> expected;
+	std::vector<std::vector<unsigned int>> treeResults(queryCount);
+
+	// Frustums
+	double treeFrustumTime = TimeBestOf(1, [&]() {
+		for (unsigned int q = 0; q < queryCount; q++) {
+			treeResults[q].clear();
+			tree.QueryFrustum(frustums[q], treeResults[q]);
+		}
+	});
+	for (std::vector<unsigned int>& treeResult : treeResults) {
+		std::sort(treeResult.begin(), treeResult.end());
+	}
+	double flatFrustumTime = TimeBestOf(1, [&]() {
+		for (unsigned int q = 0; q < queryCount; q++) {
+			expected.clear();
+			for (unsigned int i = 0; i < entityCount; i++) {
+				if (Culling::IntersectsBox(frustums[q], tree.GetFatAABB(proxies[i])))
+					expected.push_back(i);
+			}
+			mismatches += treeResults[q] != expected ? 1 : 0;
+			frustumResults += expected.size();
+		}
+	});
+
+	// Spheres
+	double treeSphereTime = TimeBestOf(1, [&]() {
+		for (unsigned int q = 0; q < queryCount; q++) {
+			treeResults[q].clear();
+			tree.QuerySphere(origins[q], queryRadius, treeResults[q]);
+		}
+	});
+	for (std::vector<unsigned int>& treeResult : treeResults) {
+		std::sort(treeResult.begin(), treeResult.end());
+	}
+	double flatSphereTime = TimeBestOf(1, [&]() {
+		for (unsigned int q = 0; q < queryCount; q++) {
+			expected.clear();
+			for (unsigned int i = 0; i < entityCount; i++) {
+				const AABB& box = tree.GetFatAABB(proxies[i]);
+				const Vector3& c = origins[q];
+				float x = std::fmax(box.Min.x - c.x, std::fmax(0.f, c.x - box.Max.x));
+				float y = std::fmax(box.Min.y - c.y, std::fmax(0.f, c.y - box.Max.y));
+				float z = std::fmax(box.Min.z - c.z, std::fmax(0.f, c.z - box.Max.z));
+				if (x * x + y * y + z * z <= queryRadius * queryRadius)
+					expected.push_back(i);
+			}
+			mismatches += treeResults[q] != expected ? 1 : 0;
+		}
+	});
+
+	// Rays, as mouse picking would cast them
+	std::vector<float> treeHits(queryCount);
+	double treeRayTime = TimeBestOf(1, [&]() {
+		for (unsigned int q = 0; q < queryCount; q++) {
+			float distance = -1.f;
+			unsigned int hit = tree.RayCast(origins[q], directions[q], rayLength,
+				[&](unsigned int a_entity) { return raySphere(q, a_entity); }, distance);
+			treeHits[q] = hit == BVH_NO_HIT ? -1.f : distance;
+		}
+	});
+	unsigned int rayHits = 0;
+	double flatRayTime = TimeBestOf(1, [&]() {
+		for (unsigned int q = 0; q < queryCount; q++) {
+			float closest = -1.f;
+			for (unsigned int i = 0; i < entityCount; i++) {
+				float distance = raySphere(q, i);
+				if (distance >= 0.f && distance <= rayLength && (closest < 0.f || distance < closest))
+					closest = distance;
+			}
+			mismatches += treeHits[q] != closest ? 1 : 0;
+			rayHits += closest >= 0.f ? 1 : 0;
+		}
+	});
+
+	std::printf("bvh-bench: %u entities, %u queries of each kind, height %d, area ratio %.1f\n",
+		entityCount, queryCount, tree.GetHeight(), tree.GetAreaRatio());
+	std::printf("  %-24s %10.3f ms\n", "build", buildTime);
+	std::printf("  %-24s %10.3f ms per frame   (%.2f%% of offered moves reinserted)\n", "move", moveTime / (frameCount ? frameCount : 1),
+		moveCount > 0 ? 100.0 * reinsertCount / moveCount : 0.0);
+	std::printf("  %-24s %10.4f ms   flat %10.4f ms   (%.1fx, %.1f results)\n", "frustum query", treeFrustumTime / queryCount,
+		flatFrustumTime / queryCount, flatFrustumTime / treeFrustumTime, (double)frustumResults / queryCount);
+	std::printf("  %-24s %10.4f ms   flat %10.4f ms   (%.1fx)\n", "sphere query", treeSphereTime / queryCount,
+		flatSphereTime / queryCount, flatSphereTime / treeSphereTime);
+	std::printf("  %-24s %10.4f ms   flat %10.4f ms   (%.1fx, %u of %u hit)\n", "ray cast", treeRayTime / queryCount,
+		flatRayTime / queryCount, flatRayTime / treeRayTime, rayHits, queryCount);
+	std::printf("  %-24s %10s\n", "tree valid", bValid ? "yes" : "no");
+	std::printf("  %-24s %10u\n", "query mismatches", mismatches);
+
+	bool bPassed = bValid && mismatches == 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Rasterize random wall occluders in front of a camera and
+// occlusion test many small boxes behind and between them
+//	- Scalar, SIMD and threaded paths must produce the same
+//	  depth buffer and the same results
+//	- Each box is also checked by sampling points on its
+//	  faces against the depth buffer. Any sample in front
+//	  of the buffer makes the box visible, so the test may
+//	  never hide a box a sample sees
+//-------------------------------------------------------
+static int RunOcclusionBenchmark(int argc, char* argv[])
+{
+	unsigned int occluderCount = FindUIntOption(argc, argv, "--occluders", 200);
+	unsigned int entityCount = FindUIntOption(argc, argv, "--entities", 20000);
+	unsigned int width = FindUIntOption(argc, argv, "--width", OCCLUSION_DEFAULT_WIDTH);
+	unsigned int height = FindUIntOption(argc, argv, "--height", OCCLUSION_DEFAULT_HEIGHT);
+	unsigned int runs = FindUIntOption(argc, argv, "--runs", 5);
+	unsigned int seed = FindUIntOption(argc, argv, "--seed", 1);
+	if (width == 0 || height == 0) {
+		std::printf("occlusion-bench: width and height must be non-zero\n");
+		return 1;
+	}
+
+	// A unit cube, scaled and placed into walls by each occluder's world matrix
+	const Vector3 cubePositions[8] = {
+		Vector3(-0.5f, -0.5f, -0.5f), Vector3(0.5f, -0.5f, -0.5f), Vector3(-0.5f, 0.5f, -0.5f), Vector3(0.5f, 0.5f, -0.5f),
+		Vector3(-0.5f, -0.5f, 0.5f), Vector3(0.5f, -0.5f, 0.5f), Vector3(-0.5f, 0.5f, 0.5f), Vector3(0.5f, 0.5f, 0.5f) };
+	const unsigned int cubeIndices[36] = {
+		0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5 };
+
+	// Camera at the origin looking down +Z, so world matrices go straight into clip space with one multiply
+	Matrix4 viewProjection = MakeCubeFaceViewProjection(Vector3(0.f, 0.f, 0.f), 4, 0.1f, 500.f);
+	auto multiply = [](const Matrix4& a_a, const Matrix4& a_b) {
+		Matrix4 result;
+		for (int row = 0; row < 4; row++) {
+			for (int column = 0; column < 4; column++) {
+				result.m[row][column] = a_a.m[row][0] * a_b.m[0][column] + a_a.m[row][1] * a_b.m[1][column]
+					+ a_a.m[row][2] * a_b.m[2][column] + a_a.m[row][3] * a_b.m[3][column];
+			}
+		}
+		return result;
+	};
+
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> spread(-1.f, 1.f);
+	std::uniform_real_distribution<float> wallWidth(4.f, 20.f);
+	std::uniform_real_distribution<float> wallHeight(3.f, 12.f);
+	std::uniform_real_distribution<float> depth(5.f, 300.f);
+	std::uniform_real_distribution<float> size(0.5f, 2.f);
+	std::vector<Matrix4> occluders(occluderCount);
+	for (Matrix4& occluder : occluders) {
+		float z = depth(random);
+		Matrix4 world(wallWidth(random), 0, 0, 0, 0, wallHeight(random), 0, 0, 0, 0, 1.f, 0,
+			spread(random) * z * 0.8f, spread(random) * z * 0.4f, z, 1);
+		occluder = multiply(world, viewProjection);
+	}
+	std::vector<AABB> boxes(entityCount);
+	for (AABB& box : boxes) {
+		float z = depth(random);
+		Vector3 center(spread(random) * z, spread(random) * z, z);
+		float halfSize = size(random) * 0.5f;
+		box.Min = Vector3(center.x - halfSize, center.y - halfSize, center.z - halfSize);
+		box.Max = Vector3(center.x + halfSize, center.y + halfSize, center.z + halfSize);
+	}
+
+	OcclusionBuffer scalarBuffer(width, height);
+	OcclusionBuffer simdBuffer(width, height);
+	OcclusionBuffer buffer(width, height);
+	auto addOccluders = [&](OcclusionBuffer& a_buffer) {
+		a_buffer.Clear();
+		for (const Matrix4& occluder : occluders) {
+			a_buffer.AddOccluder(cubePositions, 8, sizeof(Vector3), cubeIndices, 36, occluder);
+		}
+	};
+	double binTime = TimeBestOf(runs, [&]() { addOccluders(buffer); });
+	double scalarTime = TimeBestOf(runs, [&]() { addOccluders(scalarBuffer); scalarBuffer.Rasterize(false, false); }) - binTime;
+	double simdTime = TimeBestOf(runs, [&]() { addOccluders(simdBuffer); simdBuffer.Rasterize(false, true); }) - binTime;
+	double threadedTime = TimeBestOf(runs, [&]() { addOccluders(buffer); buffer.Rasterize(true, true); }) - binTime;
+
+	float largestDifference = 0.f;
+	for (size_t i = 0; i < buffer.GetDepth().size(); i++) {
+		largestDifference = std::fmax(largestDifference, std::fabs(buffer.GetDepth()[i] - scalarBuffer.GetDepth()[i]));
+		largestDifference = std::fmax(largestDifference, std::fabs(simdBuffer.GetDepth()[i] - scalarBuffer.GetDepth()[i]));
+	}
+
+	std::vector<unsigned char> scalarVisible;
+	std::vector<unsigned char> simdVisible;
+	std::vector<unsigned char> visible;
+	double scalarTestTime = TimeBestOf(runs, [&]() { buffer.TestBoxes(boxes, viewProjection, scalarVisible, false, false); });
+	double simdTestTime = TimeBestOf(runs, [&]() { buffer.TestBoxes(boxes, viewProjection, simdVisible, false, true); });
+	double threadedTestTime = TimeBestOf(runs, [&]() { buffer.TestBoxes(boxes, viewProjection, visible, true, true); });
+
+	// Sampled reference, 8x8 points per face
+	const unsigned int samples = 8;
+	const std::vector<float>& depthBuffer = buffer.GetDepth();
+	unsigned int mismatches = 0;
+	unsigned int falselyHidden = 0;
+	unsigned int hiddenCount = 0;
+	unsigned int referenceHiddenCount = 0;
+	for (unsigned int i = 0; i < entityCount; i++) {
+		const AABB& box = boxes[i];
+		bool bReferenceVisible = false;
+		for (int face = 0; face < 6 && !bReferenceVisible; face++) {
+			int axis = face / 2;
+			for (unsigned int u = 0; u < samples && !bReferenceVisible; u++) {
+				for (unsigned int v = 0; v < samples && !bReferenceVisible; v++) {
+					float s = (u + 0.5f) / samples, t = (v + 0.5f) / samples;
+					float fixed = face % 2 ? 1.f : 0.f;
+					float coordinates[3] = { axis == 0 ? fixed : s, axis == 1 ? fixed : (axis == 0 ? s : t), axis == 2 ? fixed : t };
+					Vector3 point(box.Min.x + (box.Max.x - box.Min.x) * coordinates[0],
+						box.Min.y + (box.Max.y - box.Min.y) * coordinates[1],
+						box.Min.z + (box.Max.z - box.Min.z) * coordinates[2]);
+					const Matrix4& m = viewProjection;
+					float x = point.x * m._11 + point.y * m._21 + point.z * m._31 + m._41;
+					float y = point.x * m._12 + point.y * m._22 + point.z * m._32 + m._42;
+					float z = point.x * m._13 + point.y * m._23 + point.z * m._33 + m._43;
+					float w = point.x * m._14 + point.y * m._24 + point.z * m._34 + m._44;
+					if (z < 0.f || w <= 0.f) {
+						bReferenceVisible = true;
+						break;
+					}
+					int pixelX = (int)std::floor((x / w * 0.5f + 0.5f) * buffer.GetWidth());
+					int pixelY = (int)std::floor((0.5f - y / w * 0.5f) * buffer.GetHeight());
+					if (pixelX < 0 || pixelY < 0 || pixelX >= (int)buffer.GetWidth() || pixelY >= (int)buffer.GetHeight())
+						continue;
+					bReferenceVisible = z / w <= depthBuffer[(size_t)pixelY * buffer.GetWidth() + pixelX];
+				}
+			}
+		}
+		mismatches += (scalarVisible[i] != visible[i] || simdVisible[i] != visible[i]) ? 1 : 0;
+		falselyHidden += (bReferenceVisible && !visible[i]) ? 1 : 0;
+		hiddenCount += visible[i] ? 0 : 1;
+		referenceHiddenCount += bReferenceVisible ? 0 : 1;
+	}
+
+	std::printf("occlusion-bench: %u occluders (%u triangles after clipping), %u boxes, %ux%u buffer, %u threads\n", occluderCount,
+		buffer.GetTriangleCount(), entityCount, buffer.GetWidth(), buffer.GetHeight(), JobSystem::GetInstance().GetThreadCount());
+	std::printf("  %-24s %10.3f ms\n", "transform, clip, bin", binTime);
+	std::printf("  %-24s %10.3f ms\n", "rasterize, scalar", scalarTime);
+	std::printf("  %-24s %10.3f ms   (%.2fx)\n", "rasterize, SIMD", simdTime, scalarTime / simdTime);
+	std::printf("  %-24s %10.3f ms   (%.2fx)\n", "rasterize, SIMD + MT", threadedTime, scalarTime / threadedTime);
+	std::printf("  %-24s %10.3f ms\n", "test, scalar", scalarTestTime);
+	std::printf("  %-24s %10.3f ms   (%.2fx)\n", "test, SIMD", simdTestTime, scalarTestTime / simdTestTime);
+	std::printf("  %-24s %10.3f ms   (%.2fx)\n", "test, SIMD + MT", threadedTestTime, scalarTestTime / threadedTestTime);
+	std::printf("  %-24s %10u   (%.1f%%, sampled reference hides %u)\n", "boxes hidden", hiddenCount,
+		entityCount > 0 ? 100.0 * hiddenCount / entityCount : 0.0, referenceHiddenCount);
+	std::printf("  %-24s %10.6f\n", "depth max difference", largestDifference);
+	std::printf("  %-24s %10u\n", "result mismatches", mismatches);
+	std::printf("  %-24s %10u\n", "hidden but seen", falselyHidden);
+
+	bool bPassed = largestDifference == 0.f && mismatches == 0 && falselyHidden == 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+// Closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5), returned as squared distance
+static float PointTriangleDistanceSquared(const Vector3& a_p, const Vector3& a_a, const Vector3& a_b, const Vector3& a_c)
+{
+	auto sub = [](const Vector3& a_x, const Vector3& a_y) { return Vector3(a_x.x - a_y.x, a_x.y - a_y.y, a_x.z - a_y.z); };
+	auto dot = [](const Vector3& a_x, const Vector3& a_y) { return a_x.x * a_y.x + a_x.y * a_y.y + a_x.z * a_y.z; };
+	auto at = [&](float a_v, float a_w) {
+		Vector3 ab = sub(a_b, a_a), ac = sub(a_c, a_a);
+		Vector3 closest(a_a.x + ab.x * a_v + ac.x * a_w, a_a.y + ab.y * a_v + ac.y * a_w, a_a.z + ab.z * a_v + ac.z * a_w);
+		Vector3 offset = sub(a_p, closest);
+		return dot(offset, offset);
+	};
+
+	Vector3 ab = sub(a_b, a_a), ac = sub(a_c, a_a), ap = sub(a_p, a_a);
+	float d1 = dot(ab, ap), d2 = dot(ac, ap);
+	if (d1 <= 0.f && d2 <= 0.f) return at(0.f, 0.f);
+	Vector3 bp = sub(a_p, a_b);
+	float d3 = dot(ab, bp), d4 = dot(ac, bp);
+	if (d3 >= 0.f && d4 <= d3) return at(1.f, 0.f);
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) return at(d1 / (d1 - d3), 0.f);
+	Vector3 cp = sub(a_p, a_c);
+	float d5 = dot(ab, cp), d6 = dot(ac, cp);
+	if (d6 >= 0.f && d5 <= d6) return at(0.f, 1.f);
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) return at(0.f, d2 / (d2 - d6));
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) {
+		float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		return at(1.f - w, w);
+	}
+	float denominator = 1.f / (va + vb + vc);
+	return at(vb * denominator, vc * denominator);
+}
+
+//-------------------------------------------------------
+// Simplify a bumpy UV sphere into a LOD chain and check
+// LOD selection
+//	- Every LOD must keep the sphere's UV seams and never
+//	  flip a triangle
+//	- An object walks away from (and back towards) the
+//	  camera, so selection and its hysteresis are checked
+//	  in both directions
+//-------------------------------------------------------
+static int RunLODBenchmark(int argc, char* argv[])
+{
+	unsigned int segments = FindUIntOption(argc, argv, "--segments", 96);
+	float bumps = (float)std::atof(FindOption(argc, argv, "--bumps", "0.03"));
+	float pixelError = (float)std::atof(FindOption(argc, argv, "--pixel-error", "1"));
+	float hysteresis = (float)std::atof(FindOption(argc, argv, "--hysteresis", "0.25"));
+	unsigned int screenHeight = FindUIntOption(argc, argv, "--height", 1080);
+	unsigned int runs = FindUIntOption(argc, argv, "--runs", 3);
+	if (segments < 4) {
+		std::printf("lod-bench: needs at least 4 segments\n");
+		return 1;
+	}
+
+	// Grid of (segments + 1) x (rings + 1) points. The last column repeats the first with u = 1, the UV seam,
+	// and every point of the top and bottom rows sits on a pole with its own UV
+	const float pi = 3.14159265f;
+	unsigned int rings = segments / 2;
+	unsigned int columns = segments + 1;
+	std::vector<Vector3> gridPositions((size_t)columns * (rings + 1));
+	std::vector<Vector3> gridNormals(gridPositions.size(), Vector3(0.f, 0.f, 0.f));
+	for (unsigned int ring = 0; ring <= rings; ring++) {
+		for (unsigned int segment = 0; segment < columns; segment++) {
+			float theta = pi * ring / rings;
+			float phi = 2.f * pi * (segment % segments) / segments;
+			float radius = 1.f + bumps * std::sin(6.f * theta) * std::sin(5.f * phi);
+			gridPositions[(size_t)ring * columns + segment] = Vector3(
+				radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi));
+			if (ring == 0 || ring == rings) // Exactly one point, as an OBJ would index it
+				gridPositions[(size_t)ring * columns + segment] = Vector3(0.f, ring == 0 ? 1.f : -1.f, 0.f);
+		}
+	}
+	auto gridIndex = [&](unsigned int a_ring, unsigned int a_segment) { return a_ring * columns + a_segment; };
+	std::vector<unsigned int> gridTriangles;
+	for (unsigned int ring = 0; ring < rings; ring++) {
+		for (unsigned int segment = 0; segment < segments; segment++) {
+			unsigned int i0 = gridIndex(ring, segment), i1 = gridIndex(ring, segment + 1);
+			unsigned int i2 = gridIndex(ring + 1, segment), i3 = gridIndex(ring + 1, segment + 1);
+			if (ring != 0)
+				gridTriangles.insert(gridTriangles.end(), { i0, i1, i2 });
+			if (ring != rings - 1)
+				gridTriangles.insert(gridTriangles.end(), { i1, i3, i2 });
+		}
+	}
+
+	// Smooth normals, shared across the seam so it is a UV seam only
+	for (size_t t = 0; t < gridTriangles.size(); t += 3) {
+		const Vector3& a = gridPositions[gridTriangles[t]];
+		const Vector3& b = gridPositions[gridTriangles[t + 1]];
+		const Vector3& c = gridPositions[gridTriangles[t + 2]];
+		Vector3 ab(b.x - a.x, b.y - a.y, b.z - a.z), ac(c.x - a.x, c.y - a.y, c.z - a.z);
+		Vector3 normal(ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z, ab.x * ac.y - ab.y * ac.x);
+		for (unsigned int corner = 0; corner < 3; corner++) {
+			unsigned int index = gridTriangles[t + corner];
+			unsigned int ring = index / columns, segment = index % columns;
+			if (segment == segments)
+				segment = 0;
+			Vector3& sum = gridNormals[gridIndex(ring, segment)];
+			sum.x += normal.x; sum.y += normal.y; sum.z += normal.z;
+		}
+	}
+	for (unsigned int ring = 0; ring <= rings; ring++) {
+		Vector3& normal = gridNormals[gridIndex(ring, 0)];
+		float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+		normal = Vector3(normal.x / length, normal.y / length, normal.z / length);
+		for (unsigned int segment = 1; segment < columns; segment++) {
+			Vector3& other = gridNormals[gridIndex(ring, segment)];
+			length = std::sqrt(other.x * other.x + other.y * other.y + other.z * other.z);
+			other = segment == segments ? normal : Vector3(other.x / length, other.y / length, other.z / length);
+		}
+	}
+
+	// Triangle soup, three vertices per triangle, like the OBJ loader produces
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	for (unsigned int index : gridTriangles) {
+		Vertex vertex = {};
+		vertex.Position = gridPositions[index];
+		vertex.Normal = gridNormals[index];
+		vertex.UV = Vector2((float)(index % columns) / segments, (float)(index / columns) / rings);
+		indices.push_back((unsigned int)vertices.size());
+		vertices.push_back(vertex);
+	}
+	unsigned int sourceTriangles = (unsigned int)indices.size() / 3;
+
+	std::vector<SimplifiedMesh> lods;
+	double simplifyTime = TimeBestOf(runs, [&]() {
+		MeshSimplifier::GenerateLODs(vertices.data(), (unsigned int)vertices.size(), indices.data(), (unsigned int)indices.size(), lods);
+	});
+
+	// Seam vertices are the grid points on the u = 0 and u = 1 columns. The poles are locked too, but a pole
+	// copy may legitimately disappear when the two ring vertices of its only triangle collapse together
+	std::vector<bool> gridUsed(gridPositions.size(), true);
+	std::vector<Vertex> seamVertices;
+	for (size_t t = 0; t < indices.size(); t++) {
+		unsigned int index = gridTriangles[t];
+		unsigned int ring = index / columns, segment = index % columns;
+		if (gridUsed[index] && (segment == 0 || segment == segments) && ring != 0 && ring != rings) {
+			seamVertices.push_back(vertices[t]);
+			gridUsed[index] = false;
+		}
+	}
+
+	// Orientation of the source triangles relative to their vertex normals, which the LODs must keep
+	auto orientation = [](const Vertex& a_a, const Vertex& a_b, const Vertex& a_c) {
+		Vector3 ab(a_b.Position.x - a_a.Position.x, a_b.Position.y - a_a.Position.y, a_b.Position.z - a_a.Position.z);
+		Vector3 ac(a_c.Position.x - a_a.Position.x, a_c.Position.y - a_a.Position.y, a_c.Position.z - a_a.Position.z);
+		Vector3 faceNormal(ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z, ab.x * ac.y - ab.y * ac.x);
+		Vector3 vertexNormal(a_a.Normal.x + a_b.Normal.x + a_c.Normal.x, a_a.Normal.y + a_b.Normal.y + a_c.Normal.y,
+			a_a.Normal.z + a_b.Normal.z + a_c.Normal.z);
+		return faceNormal.x * vertexNormal.x + faceNormal.y * vertexNormal.y + faceNormal.z * vertexNormal.z;
+	};
+	double sourceOrientation = 0.0;
+	for (size_t t = 0; t < indices.size(); t += 3) {
+		sourceOrientation += orientation(vertices[indices[t]], vertices[indices[t + 1]], vertices[indices[t + 2]]);
+	}
+	float facing = sourceOrientation < 0.0 ? -1.f : 1.f;
+	auto sameBits = [](const Vertex& a_a, const Vertex& a_b) {
+		return std::memcmp(&a_a.Position, &a_b.Position, sizeof(Vector3)) == 0 && std::memcmp(&a_a.Normal, &a_b.Normal, sizeof(Vector3)) == 0
+			&& std::memcmp(&a_a.UV, &a_b.UV, sizeof(Vector2)) == 0;
+	};
+
+	std::printf("lod-bench: %u source triangles (%zu soup vertices), %zu seam vertices, %.3f ms to build %zu LODs\n",
+		sourceTriangles, vertices.size(), seamVertices.size(), simplifyTime, lods.size());
+	std::printf("  %-6s %10s %10s %10s %14s %8s %11s %11s\n", "LOD", "triangles", "vertices", "error", "max deviation", "flipped", "open edges", "seams lost");
+
+	unsigned int totalFlipped = 0;
+	unsigned int totalOpenEdges = 0;
+	unsigned int totalSeamsLost = 0;
+	unsigned int errorsUnderstated = 0;
+	std::vector<float> errors(1, 0.f);
+	std::vector<unsigned int> lodIndexCounts(1, (unsigned int)indices.size());
+	for (size_t l = 0; l < lods.size(); l++) {
+		const SimplifiedMesh& lod = lods[l];
+		errors.push_back(lod.Error);
+		lodIndexCounts.push_back((unsigned int)lod.Indices.size());
+
+		// Triangles facing the other way to the source, relative to their own vertex normals, have flipped
+		unsigned int flipped = 0;
+		for (size_t t = 0; t < lod.Indices.size(); t += 3) {
+			if (orientation(lod.Vertices[lod.Indices[t]], lod.Vertices[lod.Indices[t + 1]], lod.Vertices[lod.Indices[t + 2]]) * facing <= 0.f)
+				flipped++;
+		}
+
+		// The sphere is closed, so every edge (by position) must still join exactly two triangles. A seam that
+		// was simplified differently on each side would leave open edges along it
+		std::map<std::pair<std::tuple<float, float, float>, std::tuple<float, float, float>>, unsigned int> edgeUses;
+		for (size_t t = 0; t < lod.Indices.size(); t += 3) {
+			for (unsigned int e = 0; e < 3; e++) {
+				const Vector3& a = lod.Vertices[lod.Indices[t + e]].Position;
+				const Vector3& b = lod.Vertices[lod.Indices[t + (e + 1) % 3]].Position;
+				std::tuple<float, float, float> keyA(a.x, a.y, a.z), keyB(b.x, b.y, b.z);
+				edgeUses[std::make_pair(std::min(keyA, keyB), std::max(keyA, keyB))]++;
+			}
+		}
+		unsigned int openEdges = 0;
+		for (const auto& edge : edgeUses) {
+			openEdges += edge.second != 2 ? 1 : 0;
+		}
+
+		unsigned int seamsLost = 0;
+		for (const Vertex& seam : seamVertices) {
+			bool bFound = false;
+			for (const Vertex& vertex : lod.Vertices) {
+				if (sameBits(seam, vertex)) {
+					bFound = true;
+					break;
+				}
+			}
+			seamsLost += bFound ? 0 : 1;
+		}
+
+		// One-sided Hausdorff distance, source grid points to the LOD surface
+		float maxDeviation = 0.f;
+		for (const Vector3& point : gridPositions) {
+			float closest = FLT_MAX;
+			for (size_t t = 0; t < lod.Indices.size(); t += 3) {
+				closest = std::fmin(closest, PointTriangleDistanceSquared(point, lod.Vertices[lod.Indices[t]].Position,
+					lod.Vertices[lod.Indices[t + 1]].Position, lod.Vertices[lod.Indices[t + 2]].Position));
+			}
+			maxDeviation = std::fmax(maxDeviation, std::sqrt(closest));
+		}
+
+		std::printf("  %-6zu %10zu %10zu %10.5f %14.5f %8u %11u %11u\n", l + 1, lod.Indices.size() / 3, lod.Vertices.size(),
+			lod.Error, maxDeviation, flipped, openEdges, seamsLost);
+		totalFlipped += flipped;
+		totalOpenEdges += openEdges;
+		totalSeamsLost += seamsLost;
+		errorsUnderstated += maxDeviation > lod.Error * 1.001f + 1e-6f ? 1 : 0;
+	}
+
+	// Walk out to 200 units and back. The LOD may only get coarser going out and finer coming back, and
+	// jittering around every switch point by less than the hysteresis band must not change it
+	float pixelsPerUnit = screenHeight / (2.f * std::tan(pi / 6.f)); // 60 degree vertical field of view
+	const unsigned int steps = 2000;
+	const float farDistance = 200.f;
+	unsigned int lod = 0;
+	unsigned int switches = 0;
+	unsigned int orderViolations = 0;
+	unsigned int jitterSwitches = 0;
+	double fullWork = 0.0;
+	double lodWork = 0.0;
+	for (unsigned int step = 0; step <= 2 * steps; step++) {
+		bool bOutwards = step <= steps;
+		float distance = farDistance * (bOutwards ? step : 2 * steps - step) / steps;
+		unsigned int next = FramePrep::SelectLOD(errors.data(), (unsigned int)errors.size(), 1.f, distance,
+			pixelsPerUnit, pixelError, hysteresis, lod);
+		if (next != lod) {
+			switches++;
+			orderViolations += (bOutwards ? next < lod : next > lod) ? 1 : 0;
+
+			// Back and forth by a tenth of the hysteresis band either side of the switch
+			for (int jitter = 0; jitter < 16; jitter++) {
+				float offset = distance * hysteresis * 0.1f * (jitter % 2 ? 1.f : -1.f);
+				unsigned int jittered = FramePrep::SelectLOD(errors.data(), (unsigned int)errors.size(), 1.f, distance + offset,
+					pixelsPerUnit, pixelError, hysteresis, next);
+				jitterSwitches += jittered != next ? 1 : 0;
+			}
+		}
+		lod = next;
+		fullWork += lodIndexCounts[0];
+		lodWork += lodIndexCounts[lod];
+	}
+
+	// Distance at which each LOD is first used, going outwards
+	std::printf("  %-24s", "LOD switch distances");
+	for (size_t l = 1; l < errors.size(); l++) {
+		std::printf(" %.2f", errors[l] * pixelsPerUnit / (pixelError * (1.f - hysteresis)));
+	}
+	std::printf("\n");
+	std::printf("  %-24s %10u   (%u out of order, %u from jitter)\n", "LOD switches", switches, orderViolations, jitterSwitches);
+	std::printf("  %-24s %10.1f%%   (of always drawing LOD 0, out to %.0f units)\n", "index work", fullWork > 0.0 ? 100.0 * lodWork / fullWork : 0.0, farDistance);
+
+	bool bPassed = lods.size() > 0 && totalFlipped == 0 && totalOpenEdges == 0 && totalSeamsLost == 0 && errorsUnderstated == 0
+		&& orderViolations == 0 && jitterSwitches == 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Split a dense torus into meshlets and cull it from many
+// cameras
+//	- The split must keep every triangle and respect the
+//	  vertex and triangle limits
+//	- Culling must never drop a front facing triangle with
+//	  a vertex inside the frustum
+//-------------------------------------------------------
+static int RunMeshletBenchmark(int argc, char* argv[])
+{
+	unsigned int segments = FindUIntOption(argc, argv, "--segments", 256);
+	unsigned int viewCount = FindUIntOption(argc, argv, "--views", 200);
+	unsigned int runs = FindUIntOption(argc, argv, "--runs", 3);
+	unsigned int seed = FindUIntOption(argc, argv, "--seed", 1);
+	if (segments < 8 || viewCount == 0) {
+		std::printf("meshlet-bench: needs at least 8 segments and 1 view\n");
+		return 1;
+	}
+
+	// Torus around Y as a triangle soup, like the OBJ loader produces. The minor circle has half the segments
+	const float pi = 3.14159265f;
+	const float majorRadius = 1.f;
+	const float minorRadius = 0.35f;
+	unsigned int minorSegments = segments / 2;
+	auto torusVertex = [&](unsigned int a_major, unsigned int a_minor) {
+		float u = 2.f * pi * (a_major % segments) / segments;
+		float v = 2.f * pi * (a_minor % minorSegments) / minorSegments;
+		Vertex vertex = {};
+		vertex.Normal = Vector3(std::cos(v) * std::cos(u), std::sin(v), std::cos(v) * std::sin(u));
+		vertex.Position = Vector3((majorRadius + minorRadius * std::cos(v)) * std::cos(u), minorRadius * std::sin(v),
+			(majorRadius + minorRadius * std::cos(v)) * std::sin(u));
+		vertex.UV = Vector2((float)a_major / segments, (float)a_minor / minorSegments);
+		return vertex;
+	};
+	std::vector<Vertex> soup;
+	for (unsigned int major = 0; major < segments; major++) {
+		for (unsigned int minor = 0; minor < minorSegments; minor++) {
+			Vertex v00 = torusVertex(major, minor), v10 = torusVertex(major + 1, minor);
+			Vertex v01 = torusVertex(major, minor + 1), v11 = torusVertex(major + 1, minor + 1);
+			soup.insert(soup.end(), { v00, v01, v10, v10, v01, v11 });
+		}
+	}
+	std::vector<unsigned int> soupIndices(soup.size());
+	for (unsigned int i = 0; i < (unsigned int)soupIndices.size(); i++) {
+		soupIndices[i] = i;
+	}
+	unsigned int triangleCount = (unsigned int)soupIndices.size() / 3;
+
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<Meshlet> meshlets;
+	std::vector<unsigned int> meshletIndices;
+	double weldTime = TimeBestOf(runs, [&]() {
+		Meshlets::WeldVertices(soup.data(), (unsigned int)soup.size(), soupIndices.data(), (unsigned int)soupIndices.size(), vertices, indices);
+	});
+	double buildTime = TimeBestOf(runs, [&]() {
+		Meshlets::Build(&vertices[0].Position, (unsigned int)vertices.size(), sizeof(Vertex), indices.data(), (unsigned int)indices.size(),
+			meshlets, meshletIndices);
+	});
+
+	// Same triangles (with the same winding) before and after, and every meshlet inside the limits
+	auto canonicalTriangles = [](const std::vector<unsigned int>& a_indices) {
+		std::vector<std::tuple<unsigned int, unsigned int, unsigned int>> triangles;
+		for (size_t t = 0; t < a_indices.size(); t += 3) {
+			unsigned int a = a_indices[t], b = a_indices[t + 1], c = a_indices[t + 2];
+			while (a > b || a > c) {
+				unsigned int first = a;
+				a = b; b = c; c = first;
+			}
+			triangles.emplace_back(a, b, c);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	};
+	bool bSameTriangles = canonicalTriangles(indices) == canonicalTriangles(meshletIndices);
+	unsigned int overLimit = 0;
+	unsigned int coveredTriangles = 0;
+	double vertexFill = 0.0;
+	double triangleFill = 0.0;
+	std::vector<unsigned int> meshletOfIndex(meshletIndices.size(), 0);
+	for (unsigned int m = 0; m < (unsigned int)meshlets.size(); m++) {
+		const Meshlet& meshlet = meshlets[m];
+		std::vector<unsigned int> unique(meshletIndices.begin() + meshlet.IndexOffset,
+			meshletIndices.begin() + meshlet.IndexOffset + meshlet.TriangleCount * 3);
+		std::sort(unique.begin(), unique.end());
+		unsigned int vertexCount = (unsigned int)(std::unique(unique.begin(), unique.end()) - unique.begin());
+		overLimit += (vertexCount != meshlet.VertexCount || vertexCount > MESHLET_MAX_VERTICES || meshlet.TriangleCount > MESHLET_MAX_TRIANGLES) ? 1 : 0;
+		coveredTriangles += meshlet.TriangleCount;
+		vertexFill += (double)vertexCount / MESHLET_MAX_VERTICES;
+		triangleFill += (double)meshlet.TriangleCount / MESHLET_MAX_TRIANGLES;
+	}
+
+	// Cameras on a shell around the torus, looking down whichever axis points closest to its centre. Half
+	// the views see the torus rotated and uniformly scaled, so the world space cone transform is covered too
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	std::uniform_real_distribution<float> distance(1.5f, 6.f);
+	struct View {
+		Matrix4 World;
+		Frustum Planes;
+		Vector3 Eye;
+		Matrix4 ViewProjection;
+	};
+	std::vector<View> views(viewCount);
+	for (unsigned int v = 0; v < viewCount; v++) {
+		Vector3 direction(unit(random), unit(random), unit(random));
+		float length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+		float radius = distance(random);
+		Vector3 eye(direction.x / length * radius, direction.y / length * radius, direction.z / length * radius);
+		float toCenter[3] = { -eye.x, -eye.y, -eye.z };
+		unsigned int axis = 0;
+		for (unsigned int a = 1; a < 3; a++) {
+			axis = std::fabs(toCenter[a]) > std::fabs(toCenter[axis]) ? a : axis;
+		}
+		View& view = views[v];
+		view.Eye = eye;
+		view.ViewProjection = MakeCubeFaceViewProjection(eye, axis * 2 + (toCenter[axis] < 0.f ? 1 : 0), 0.05f, 100.f);
+		view.Planes = Culling::ExtractFrustum(view.ViewProjection);
+		float angle = v % 2 ? unit(random) * pi : 0.f;
+		float scale = v % 2 ? 1.5f : 1.f;
+		view.World = Matrix4(std::cos(angle) * scale, 0, -std::sin(angle) * scale, 0, 0, scale, 0, 0,
+			std::sin(angle) * scale, 0, std::cos(angle) * scale, 0, 0, 0, 0, 1);
+	}
+
+	std::vector<MeshletDrawRange> ranges;
+	unsigned long long frustumTriangles = 0;
+	unsigned long long coneTriangles = 0;
+	double frustumTime = TimeBestOf(runs, [&]() {
+		frustumTriangles = 0;
+		for (const View& view : views) {
+			frustumTriangles += Meshlets::Cull(meshlets, view.World, view.Planes, view.Eye, ranges, false);
+		}
+	});
+	double coneTime = TimeBestOf(runs, [&]() {
+		coneTriangles = 0;
+		for (const View& view : views) {
+			coneTriangles += Meshlets::Cull(meshlets, view.World, view.Planes, view.Eye, ranges, true);
+		}
+	});
+
+	// Reference: a triangle must be drawn if it faces the camera and has a vertex inside the frustum
+	unsigned long long referenceTriangles = 0;
+	unsigned int falselyCulled = 0;
+	unsigned int rangeCount = 0;
+	std::vector<unsigned char> drawn(triangleCount);
+	for (const View& view : views) {
+		Meshlets::Cull(meshlets, view.World, view.Planes, view.Eye, ranges, true);
+		rangeCount += (unsigned int)ranges.size();
+		std::fill(drawn.begin(), drawn.end(), 0);
+		for (const MeshletDrawRange& range : ranges) {
+			std::fill(drawn.begin() + range.IndexOffset / 3, drawn.begin() + (range.IndexOffset + range.IndexCount) / 3, 1);
+		}
+
+		const Matrix4& m = view.World;
+		auto toWorld = [&](const Vector3& a_p) {
+			return Vector3(a_p.x * m._11 + a_p.y * m._21 + a_p.z * m._31 + m._41, a_p.x * m._12 + a_p.y * m._22 + a_p.z * m._32 + m._42,
+				a_p.x * m._13 + a_p.y * m._23 + a_p.z * m._33 + m._43);
+		};
+		for (unsigned int t = 0; t < triangleCount; t++) {
+			Vector3 p[3];
+			bool bInside = false;
+			for (unsigned int c = 0; c < 3; c++) {
+				p[c] = toWorld(vertices[meshletIndices[t * 3 + c]].Position);
+				bool bInsideAll = true;
+				for (const Vector4& plane : view.Planes.Planes) {
+					bInsideAll &= plane.x * p[c].x + plane.y * p[c].y + plane.z * p[c].z + plane.w >= 0.f;
+				}
+				bInside |= bInsideAll;
+			}
+			Vector3 e0(p[1].x - p[0].x, p[1].y - p[0].y, p[1].z - p[0].z), e1(p[2].x - p[0].x, p[2].y - p[0].y, p[2].z - p[0].z);
+			Vector3 normal(e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x);
+			bool bFrontFacing = normal.x * (p[0].x - view.Eye.x) + normal.y * (p[0].y - view.Eye.y) + normal.z * (p[0].z - view.Eye.z) < 0.f;
+			if (bInside && bFrontFacing) {
+				referenceTriangles++;
+				falselyCulled += drawn[t] ? 0 : 1;
+			}
+		}
+	}
+
+	unsigned long long allTriangles = (unsigned long long)triangleCount * viewCount;
+	std::printf("meshlet-bench: %u triangles, %zu welded vertices (from %zu), %zu meshlets, %u views\n", triangleCount,
+		vertices.size(), soup.size(), meshlets.size(), viewCount);
+	std::printf("  %-24s %10.3f ms\n", "weld", weldTime);
+	std::printf("  %-24s %10.3f ms\n", "build", buildTime);
+	std::printf("  %-24s %9.1f%% vertices, %.1f%% triangles\n", "average fill", meshlets.empty() ? 0.0 : 100.0 * vertexFill / meshlets.size(),
+		meshlets.empty() ? 0.0 : 100.0 * triangleFill / meshlets.size());
+	std::printf("  %-24s %10.3f us per view   (%.1f%% of triangles drawn)\n", "cull, frustum", 1000.0 * frustumTime / viewCount,
+		100.0 * frustumTriangles / allTriangles);
+	std::printf("  %-24s %10.3f us per view   (%.1f%% of triangles drawn, %.1f ranges per view)\n", "cull, frustum + cone",
+		1000.0 * coneTime / viewCount, 100.0 * coneTriangles / allTriangles, (double)rangeCount / viewCount);
+	std::printf("  %-24s %10.1f%%\n", "reference visible", 100.0 * referenceTriangles / allTriangles);
+	std::printf("  %-24s %10s\n", "same triangles", bSameTriangles && coveredTriangles == triangleCount ? "yes" : "NO");
+	std::printf("  %-24s %10u\n", "meshlets over limits", overLimit);
+	std::printf("  %-24s %10u\n", "visible but culled", falselyCulled);
+
+	bool bPassed = bSameTriangles && coveredTriangles == triangleCount && overLimit == 0 && falselyCulled == 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Decode every PNG under a directory (the material and
+// sky textures by default) with the portable decoder
+//	- Files are read up front, so only decoding is timed
+//	- Scalar and SIMD unfiltering must produce the same
+//	  pixels. The threaded run decodes every file at once
+//	  on the JobSystem, as TextureLoader does at startup
+//-------------------------------------------------------
+static int RunPNGBenchmark(int argc, char* argv[])
+{
+	const char* directory = FindOption(argc, argv, "--dir", "assets/materials");
+	unsigned int runs = FindUIntOption(argc, argv, "--runs", 3);
+	PngPixelFormat format = FindUIntOption(argc, argv, "--bits", 8) == 16 ? PngPixelFormat::RGBA16 : PngPixelFormat::RGBA8;
+
+	struct PngFile {
+		std::string Name;
+		std::vector<uint8_t> Data;
+		PngInfo Info;
+		size_t RowPitch;
+		std::vector<uint8_t> Storage; // Over-allocated so Pixels can be aligned
+		uint8_t* Pixels;
+	};
+	std::vector<PngFile> files;
+	std::error_code error;
+	for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+		if (!it->is_regular_file() || it->path().extension() != ".png")
+			continue;
+		PngFile file;
+		file.Name = it->path().lexically_relative(directory).generic_string();
+		std::ifstream stream(it->path(), std::ios::binary);
+		file.Data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		if (!PngDecoder::ReadInfo(file.Data.data(), file.Data.size(), file.Info)) {
+			std::printf("png-bench: %s is not a PNG this decoder reads\n", file.Name.c_str());
+			return 1;
+		}
+		file.RowPitch = PngDecoder::GetRowPitch(file.Info.Width, format);
+		file.Storage.resize(file.RowPitch * file.Info.Height + PNG_OUTPUT_ALIGNMENT);
+		size_t misalignment = (size_t)file.Storage.data() % PNG_OUTPUT_ALIGNMENT;
+		file.Pixels = file.Storage.data() + (misalignment ? PNG_OUTPUT_ALIGNMENT - misalignment : 0);
+		files.push_back(std::move(file));
+	}
+	if (files.empty()) {
+		std::printf("png-bench: no .png files under %s\n", directory);
+		return 1;
+	}
+	std::sort(files.begin(), files.end(), [](const PngFile& a_left, const PngFile& a_right) { return a_left.Name < a_right.Name; });
+
+	static const char* s_colorTypes[7] = { "gray", "?", "rgb", "palette", "gray+a", "?", "rgba" };
+	std::printf("png-bench: %zu files under %s, RGBA%u output, %u threads\n", files.size(), directory,
+		format == PngPixelFormat::RGBA8 ? 8 : 16, JobSystem::GetInstance().GetThreadCount());
+	std::printf("  %-52s %11s %-10s %9s %10s %10s %9s\n", "file", "size", "format", "input KB", "scalar ms", "simd ms", "MB/s");
+
+	unsigned int failed = 0;
+	unsigned int mismatched = 0;
+	double scalarTotal = 0.0;
+	double simdTotal = 0.0;
+	size_t inputBytes = 0;
+	size_t outputBytes = 0;
+	std::vector<uint8_t> scalarPixels;
+	for (PngFile& file : files) {
+		size_t imageSize = file.RowPitch * file.Info.Height;
+		bool bDecoded = true;
+		double scalarTime = TimeBestOf(runs, [&]() {
+			bDecoded &= PngDecoder::Decode(file.Data.data(), file.Data.size(), format, file.Pixels, file.RowPitch, false);
+		});
+		scalarPixels.assign(file.Pixels, file.Pixels + imageSize);
+		double simdTime = TimeBestOf(runs, [&]() {
+			bDecoded &= PngDecoder::Decode(file.Data.data(), file.Data.size(), format, file.Pixels, file.RowPitch, true);
+		});
+		bool bSame = std::memcmp(scalarPixels.data(), file.Pixels, imageSize) == 0;
+		failed += bDecoded ? 0 : 1;
+		mismatched += bSame ? 0 : 1;
+
+		size_t pixelBytes = (size_t)file.Info.Width * file.Info.Height * (format == PngPixelFormat::RGBA8 ? 4 : 8);
+		scalarTotal += scalarTime;
+		simdTotal += simdTime;
+		inputBytes += file.Data.size();
+		outputBytes += pixelBytes;
+		char size[32];
+		char type[32];
+		std::snprintf(size, sizeof(size), "%ux%u", file.Info.Width, file.Info.Height);
+		std::snprintf(type, sizeof(type), "%s%u%s", s_colorTypes[file.Info.ColorType < 7 ? file.Info.ColorType : 1], file.Info.BitDepth,
+			file.Info.bInterlaced ? "i" : "");
+		std::printf("  %-52s %11s %-10s %9.1f %10.3f %10.3f %9.1f%s\n", file.Name.c_str(), size, type, file.Data.size() / 1024.0,
+			scalarTime, simdTime, pixelBytes / (simdTime * 1000.0), !bDecoded ? "  FAILED" : !bSame ? "  MISMATCH" : "");
+	}
+
+	// Every file at once across the pool
+	std::atomic<unsigned int> threadedFailures{ 0 };
+	double threadedTime = TimeBestOf(runs, [&]() {
+		JobSystem::GetInstance().ParallelFor((unsigned int)files.size(), 1, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; i++) {
+				PngFile& file = files[i];
+				if (!PngDecoder::Decode(file.Data.data(), file.Data.size(), format, file.Pixels, file.RowPitch, true))
+					threadedFailures++;
+			}
+		});
+	});
+
+	std::printf("  %-24s %10.3f ms   %8.1f MB/s output   %6.1f MB/s input\n", "total, scalar", scalarTotal,
+		outputBytes / (scalarTotal * 1000.0), inputBytes / (scalarTotal * 1000.0));
+	std::printf("  %-24s %10.3f ms   %8.1f MB/s output   %6.1f MB/s input   (%.2fx)\n", "total, simd", simdTotal,
+		outputBytes / (simdTotal * 1000.0), inputBytes / (simdTotal * 1000.0), scalarTotal / simdTotal);
+	std::printf("  %-24s %10.3f ms   %8.1f MB/s output   (%.2fx over one thread)\n", "all files, threaded", threadedTime,
+		outputBytes / (threadedTime * 1000.0), simdTotal / threadedTime);
+	std::printf("  %-24s %10u\n", "failed", failed + threadedFailures.load());
+	std::printf("  %-24s %10u\n", "scalar/simd mismatch", mismatched);
+
+	bool bPassed = failed == 0 && threadedFailures.load() == 0 && mismatched == 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+static const char* s_textureFormats[5] = { "rgba8", "bc1", "bc4", "bc5", "bc7" };
+
+static bool ParseCompressionQuality(const char* a_name, CompressionQuality& a_quality)
+{
+	static const char* s_qualities[3] = { "fast", "normal", "high" };
+	for (int i = 0; i < 3; i++) {
+		if (std::strcmp(a_name, s_qualities[i]) == 0) {
+			a_quality = (CompressionQuality)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+//-------------------------------------------------------
+// Cook every PNG under a directory (the material and sky
+// textures by default) into a DDS with its mip chain,
+// beside the source where TextureLoader looks for it
+//	- Files whose cooked copy is up to date are skipped
+//	  unless --force is given
+//	- Files cook in parallel on the JobSystem, and every
+//	  cooked file is read back to check it round trips
+//	- Textures are block compressed unless --uncompressed
+//	  is given, and the top mip's PSNR is reported
+//	- Each set of maps sharing a name up to its last part
+//	  and including a roughness map is also packed into an
+//	  ORM texture, listing the channels that turned out to
+//	  be constant
+//-------------------------------------------------------
+static int RunTextureCook(int argc, char* argv[])
+{
+	const char* directory = FindOption(argc, argv, "--dir", "assets/materials");
+	const char* filterName = FindOption(argc, argv, "--filter", "kaiser");
+	const char* qualityName = FindOption(argc, argv, "--quality", "normal");
+	bool bForce = HasFlag(argc, argv, "--force");
+	if (std::strcmp(filterName, "kaiser") != 0 && std::strcmp(filterName, "box") != 0) {
+		std::printf("texture-cook: unknown filter '%s'\n", filterName);
+		return 1;
+	}
+	TextureCookSettings settings;
+	settings.Filter = std::strcmp(filterName, "box") == 0 ? MipFilter::Box : MipFilter::Kaiser;
+	settings.bCompress = !HasFlag(argc, argv, "--uncompressed");
+	settings.bPreferBC7 = HasFlag(argc, argv, "--bc7");
+	if (!ParseCompressionQuality(qualityName, settings.Quality)) {
+		std::printf("texture-cook: unknown quality '%s'\n", qualityName);
+		return 1;
+	}
+
+	struct CookFile {
+		std::filesystem::path Path; // The source, or the packed texture
+		std::string Name;
+		bool bPacked = false;
+		std::filesystem::path Sources[3]; // Packed textures only
+		ORMLayout Layout;
+		bool bSkipped = false;
+		bool bCooked = false;
+		bool bVerified = false;
+		double Time = 0.0;
+		TextureCookResult Result;
+	};
+	std::vector<CookFile> files;
+	std::error_code error;
+	for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+		if (!it->is_regular_file() || it->path().extension() != ".png")
+			continue;
+		CookFile file;
+		file.Path = it->path();
+		file.Name = it->path().lexically_relative(directory).generic_string();
+		files.push_back(file);
+	}
+	if (files.empty()) {
+		std::printf("texture-cook: no .png files under %s\n", directory);
+		return 1;
+	}
+
+	// Group occlusion, roughness and metalness maps into packed textures
+	std::vector<std::filesystem::path> sources;
+	for (const CookFile& file : files) {
+		sources.push_back(file.Path);
+	}
+	std::vector<std::array<std::filesystem::path, 3>> groups;
+	TextureCooker::GroupORMSources(sources, groups);
+	for (const std::array<std::filesystem::path, 3>& group : groups) {
+		CookFile pack;
+		pack.bPacked = true;
+		std::copy(group.begin(), group.end(), pack.Sources);
+		pack.Path = TextureCooker::GetPackedPath(pack.Sources);
+		pack.Name = pack.Path.lexically_relative(directory).generic_string();
+		files.push_back(pack);
+	}
+	std::sort(files.begin(), files.end(), [](const CookFile& a_left, const CookFile& a_right) { return a_left.Name < a_right.Name; });
+
+	double totalTime = TimeBestOf(1, [&]() {
+		JobSystem::GetInstance().ParallelFor((unsigned int)files.size(), 1, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int i = a_begin; i < a_end; i++) {
+				CookFile& file = files[i];
+				if (!bForce && (file.bPacked ? TextureCooker::IsPackedUpToDate(file.Sources) : TextureCooker::IsUpToDate(file.Path))) {
+					file.bSkipped = true;
+					continue;
+				}
+				file.Time = TimeBestOf(1, [&]() {
+					file.bCooked = file.bPacked ? TextureCooker::CookORM(file.Sources, settings, file.Result, file.Layout)
+						: TextureCooker::Cook(file.Path, settings, file.Result);
+				});
+			}
+		});
+	});
+
+	// Read every cooked file back as the runtime would, and check it describes the source
+	for (CookFile& file : files) {
+		TextureData cooked;
+		if (file.bPacked) {
+			file.bVerified = TextureCooker::ReadORM(file.Path, cooked, file.Layout) &&
+				cooked.Mips.size() == TextureMips::GetMipCount(cooked.Mips[0].Width, cooked.Mips[0].Height);
+			if (file.bSkipped && file.bVerified) {
+				file.Result.Usage = TextureUsage::Data;
+				file.Result.Format = cooked.Format;
+				file.Result.PSNR = std::numeric_limits<double>::quiet_NaN();
+				file.Result.Width = cooked.Mips[0].Width;
+				file.Result.Height = cooked.Mips[0].Height;
+				file.Result.MipCount = (unsigned int)cooked.Mips.size();
+			}
+			continue;
+		}
+
+		PngInfo info;
+		std::ifstream stream(file.Path, std::ios::binary);
+		std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		file.bVerified = PngDecoder::ReadInfo(data.data(), data.size(), info) &&
+			DDSFile::ReadTexture(TextureCooker::GetCookedPath(file.Path), cooked) &&
+			cooked.Mips[0].Width == info.Width && cooked.Mips[0].Height == info.Height &&
+			cooked.Mips.size() == TextureMips::GetMipCount(info.Width, info.Height);
+		if (file.bSkipped) {
+			file.Result.Usage = TextureCooker::Classify(file.Path);
+			file.Result.Format = cooked.Format;
+			file.Result.PSNR = std::numeric_limits<double>::quiet_NaN();
+			file.Result.Width = info.Width;
+			file.Result.Height = info.Height;
+			file.Result.MipCount = (unsigned int)cooked.Mips.size();
+		}
+	}
+
+	static const char* s_usages[3] = { "color", "data", "normal" };
+	std::printf("texture-cook: %zu files under %s, %s filter, %s, %u threads\n", files.size(), directory, filterName,
+		settings.bCompress ? qualityName : "uncompressed", JobSystem::GetInstance().GetThreadCount());
+	std::printf("  %-52s %-7s %-6s %11s %5s %10s %10s %8s\n", "file", "usage", "format", "size", "mips", "cook ms", "output KB", "psnr dB");
+
+	static const char* s_ormChannels[3] = { "occlusion", "roughness", "metalness" };
+	unsigned int cookedCount = 0;
+	unsigned int skippedCount = 0;
+	unsigned int failedCount = 0;
+	unsigned int packedCount = 0;
+	unsigned int constantCount = 0;
+	size_t outputBytes = 0;
+	for (const CookFile& file : files) {
+		char size[32];
+		std::snprintf(size, sizeof(size), "%ux%u", file.Result.Width, file.Result.Height);
+		const char* status = !file.bSkipped && !file.bCooked ? "  FAILED" : !file.bVerified ? "  UNREADABLE" : file.bSkipped ? "  up to date" : "";
+		std::string constants;
+		for (int c = 0; c < 3 && file.bPacked; c++) {
+			char constant[48];
+			std::snprintf(constant, sizeof(constant), " %s %.2f", s_ormChannels[c], file.Layout.Constants[c]);
+			constants += file.Layout.bTextured[c] ? "" : constant;
+			constantCount += file.Layout.bTextured[c] ? 0 : 1;
+		}
+		packedCount += file.bPacked ? 1 : 0;
+		std::printf("  %-52s %-7s %-6s %11s %5u %10.3f %10.1f %8.2f%s%s%s\n", file.Name.c_str(),
+			file.bPacked ? "orm" : s_usages[(int)file.Result.Usage], s_textureFormats[(int)file.Result.Format], size,
+			file.Result.MipCount, file.Time, file.Result.OutputBytes / 1024.0, file.Result.PSNR, status,
+			constants.empty() ? "" : "  constant:", constants.c_str());
+
+		cookedCount += file.bCooked ? 1 : 0;
+		skippedCount += file.bSkipped ? 1 : 0;
+		failedCount += (!file.bSkipped && !file.bCooked) || !file.bVerified ? 1 : 0;
+		outputBytes += file.Result.OutputBytes;
+	}
+	std::printf("  %-24s %10.3f ms   %8.1f MB written\n", "all files, threaded", totalTime, outputBytes / (1024.0 * 1024.0));
+	std::printf("  %-24s %10u\n", "cooked", cookedCount);
+	std::printf("  %-24s %10u (%u constant channels)\n", "orm packed", packedCount, constantCount);
+	std::printf("  %-24s %10u\n", "up to date", skippedCount);
+	std::printf("  %-24s %10u\n", "failed", failedCount);
+
+	bool bPassed = failedCount == 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Block compress every PNG under a directory (the
+// material and sky textures by default), in the format
+// the cooker would pick unless --format is given
+//	- Each file is encoded with scalar and SIMD palette
+//	  matching on one thread, then with SIMD across the
+//	  JobSystem. All three must produce the same blocks
+//	- PSNR is measured over the channels the format keeps.
+//	  The means leave out files that compressed losslessly
+//	  (flat maps), which would make them infinite
+//-------------------------------------------------------
+static int RunBCBenchmark(int argc, char* argv[])
+{
+	const char* directory = FindOption(argc, argv, "--dir", "assets/materials");
+	const char* formatName = FindOption(argc, argv, "--format", "auto");
+	const char* qualityName = FindOption(argc, argv, "--quality", "normal");
+	unsigned int runs = std::max(FindUIntOption(argc, argv, "--runs", 1), 1u);
+
+	TextureCookSettings settings;
+	if (!ParseCompressionQuality(qualityName, settings.Quality)) {
+		std::printf("bc-bench: unknown quality '%s'\n", qualityName);
+		return 1;
+	}
+	int forcedFormat = -1;
+	for (int i = 1; i < 5; i++) {
+		forcedFormat = std::strcmp(formatName, s_textureFormats[i]) == 0 ? i : forcedFormat;
+	}
+	if (forcedFormat < 0 && std::strcmp(formatName, "auto") != 0) {
+		std::printf("bc-bench: unknown format '%s'\n", formatName);
+		return 1;
+	}
+
+	std::vector<std::filesystem::path> paths;
+	std::error_code error;
+	for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+		if (it->is_regular_file() && it->path().extension() == ".png")
+			paths.push_back(it->path());
+	}
+	if (paths.empty()) {
+		std::printf("bc-bench: no .png files under %s\n", directory);
+		return 1;
+	}
+	std::sort(paths.begin(), paths.end());
+
+	std::printf("bc-bench: %zu files under %s, %s format, %s quality, best of %u, %u threads\n", paths.size(), directory, formatName,
+		qualityName, runs, JobSystem::GetInstance().GetThreadCount());
+	std::printf("  %-52s %-6s %11s %10s %10s %10s %8s %6s\n", "file", "format", "size", "scalar ms", "simd ms", "thread ms", "psnr dB", "ratio");
+
+	unsigned int failed = 0;
+	unsigned int mismatched = 0;
+	double scalarTotal = 0.0;
+	double simdTotal = 0.0;
+	double threadedTotal = 0.0;
+	size_t pixelCount = 0;
+	double psnrTotal[5] = {};
+	unsigned int lossyCounts[5] = {};
+	unsigned int losslessCounts[5] = {};
+	for (const std::filesystem::path& path : paths) {
+		std::string name = path.lexically_relative(directory).generic_string();
+		TextureData texture;
+		if (!PngDecoder::LoadFile(path, texture)) {
+			std::printf("  %-52s FAILED\n", name.c_str());
+			failed++;
+			continue;
+		}
+		const TextureMip& image = texture.Mips[0];
+		TextureFormat format = forcedFormat >= 0 ? (TextureFormat)forcedFormat : TextureCooker::ChooseFormat(texture, TextureCooker::Classify(path), settings);
+		format = format == TextureFormat::RGBA8 ? TextureFormat::BC7 : format;
+
+		size_t levelSize = BlockCompression::GetLevelSize(format, image.Width, image.Height);
+		std::vector<uint8_t> scalarBlocks(levelSize);
+		std::vector<uint8_t> simdBlocks(levelSize);
+		std::vector<uint8_t> threadedBlocks(levelSize);
+		double scalarTime = TimeBestOf(runs, [&]() {
+			BlockCompression::Compress(image.Pixels.data(), image.Width, image.Height, format, settings.Quality, scalarBlocks.data(), false, false);
+		});
+		double simdTime = TimeBestOf(runs, [&]() {
+			BlockCompression::Compress(image.Pixels.data(), image.Width, image.Height, format, settings.Quality, simdBlocks.data(), true, false);
+		});
+		double threadedTime = TimeBestOf(runs, [&]() {
+			BlockCompression::Compress(image.Pixels.data(), image.Width, image.Height, format, settings.Quality, threadedBlocks.data());
+		});
+		bool bSame = scalarBlocks == simdBlocks && simdBlocks == threadedBlocks;
+		mismatched += bSame ? 0 : 1;
+
+		std::vector<uint8_t> decoded(image.Pixels.size());
+		BlockCompression::Decompress(threadedBlocks.data(), image.Width, image.Height, format, decoded.data());
+		size_t texels = (size_t)image.Width * image.Height;
+		double psnr = BlockCompression::ComputePSNR(image.Pixels.data(), decoded.data(), texels, format);
+
+		scalarTotal += scalarTime;
+		simdTotal += simdTime;
+		threadedTotal += threadedTime;
+		pixelCount += texels;
+		bool bLossless = std::isinf(psnr);
+		psnrTotal[(int)format] += bLossless ? 0.0 : psnr;
+		lossyCounts[(int)format] += bLossless ? 0 : 1;
+		losslessCounts[(int)format] += bLossless ? 1 : 0;
+		char size[32];
+		std::snprintf(size, sizeof(size), "%ux%u", image.Width, image.Height);
+		std::printf("  %-52s %-6s %11s %10.3f %10.3f %10.3f %8.2f %5.1fx%s\n", name.c_str(), s_textureFormats[(int)format], size,
+			scalarTime, simdTime, threadedTime, psnr, image.Pixels.size() / (double)levelSize, bSame ? "" : "  MISMATCH");
+	}
+
+	std::printf("  %-24s %10.3f ms   %8.2f Mpixels/s\n", "total, scalar", scalarTotal, pixelCount / (scalarTotal * 1000.0));
+	std::printf("  %-24s %10.3f ms   %8.2f Mpixels/s   (%.2fx)\n", "total, simd", simdTotal, pixelCount / (simdTotal * 1000.0),
+		scalarTotal / simdTotal);
+	std::printf("  %-24s %10.3f ms   %8.2f Mpixels/s   (%.2fx over one thread)\n", "total, threaded", threadedTotal,
+		pixelCount / (threadedTotal * 1000.0), simdTotal / threadedTotal);
+	for (int i = 1; i < 5; i++) {
+		if (lossyCounts[i] + losslessCounts[i] > 0)
+			std::printf("  %-24s %10.2f dB over %u files, %u lossless\n", (std::string("mean psnr, ") + s_textureFormats[i]).c_str(),
+				lossyCounts[i] > 0 ? psnrTotal[i] / lossyCounts[i] : std::numeric_limits<double>::infinity(), lossyCounts[i], losslessCounts[i]);
+	}
+	std::printf("  %-24s %10u\n", "failed", failed);
+	std::printf("  %-24s %10u\n", "scalar/simd mismatch", mismatched);
+
+	bool bPassed = failed == 0 && mismatched == 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Simulate mip streaming for a large scene against the
+// TextureStreamer, with loads finishing a few frames
+// after they're asked for, as disk reads would
+//	- Materials have a color (BC7), normal (BC5) and ORM
+//	  (BC1) texture of 1K to 4K, shared by entities
+//	  scattered over a 400 unit square. The camera circles
+//	  through them, and coverage is measured the same way
+//	  Game::ReportTextureCoverage does
+//	- Every step must make sense for the texture it names
+//	  (loads directly above the resident chain, evictions
+//	  of its finest level, nothing for textures that are
+//	  loading), the streamer's byte counts must match the
+//	  simulation's, and resident + loading must stay within
+//	  the budget every frame
+//	- Reports churn and how close residency gets to what
+//	  the view wants. Passes when, after the camera stops,
+//	  every visible texture is at its wanted level or the
+//	  budget is what's holding it back
+//-------------------------------------------------------
+static int RunStreamSimulation(int argc, char* argv[])
+{
+	unsigned int materialCount = FindUIntOption(argc, argv, "--materials", 64);
+	unsigned int entityCount = FindUIntOption(argc, argv, "--entities", 600);
+	unsigned int frameCount = FindUIntOption(argc, argv, "--frames", 3600);
+	unsigned int latency = FindUIntOption(argc, argv, "--latency", 3); // Frames from asking for a level to having it
+	unsigned int seed = FindUIntOption(argc, argv, "--seed", 1);
+
+	TextureStreamerSettings settings;
+	settings.BudgetBytes = (size_t)FindUIntOption(argc, argv, "--budget", 24) << 20; // Small enough that the default scene evicts
+	settings.MaxLoadsInFlight = FindUIntOption(argc, argv, "--max-loads", settings.MaxLoadsInFlight);
+	if (materialCount == 0 || entityCount == 0 || frameCount == 0 || settings.MaxLoadsInFlight == 0) {
+		std::printf("stream-sim: materials, entities, frames and max loads must be non-zero\n");
+		return 1;
+	}
+
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> position(-200.f, 200.f);
+	std::uniform_real_distribution<float> radius(0.5f, 6.f);
+	std::uniform_int_distribution<unsigned int> sizeShift(0, 2);
+	std::uniform_int_distribution<unsigned int> pickMaterial(0, materialCount - 1);
+	static const float uvScales[] = { 0.25f, 0.5f, 1.f };
+	std::uniform_int_distribution<unsigned int> pickUVScale(0, 2);
+
+	// Three textures per material, indices material * 3 + slot
+	static const TextureFormat slotFormats[3] = { TextureFormat::BC7, TextureFormat::BC5, TextureFormat::BC1 };
+	TextureStreamer streamer(settings);
+	std::vector<unsigned int> mipCounts;
+	size_t fullBytes = 0;
+	for (unsigned int i = 0; i < materialCount; i++) {
+		unsigned int size = 1024u << sizeShift(random);
+		for (TextureFormat format : slotFormats) {
+			mipCounts.push_back(TextureMips::GetMipCount(size, size));
+			unsigned int texture = streamer.AddTexture(size, size, mipCounts.back(), format);
+			for (unsigned int mip = 0; mip < mipCounts.back(); mip++) {
+				fullBytes += streamer.GetLevelBytes(texture, mip);
+			}
+		}
+	}
+	unsigned int textureCount = streamer.GetTextureCount();
+
+	struct SimulatedEntity {
+		Vector3 Position;
+		float Radius;
+		unsigned int Material;
+		float UVScale;
+	};
+	std::vector<SimulatedEntity> entities(entityCount);
+	for (SimulatedEntity& entity : entities) {
+		entity.Radius = radius(random);
+		entity.Position = Vector3(position(random), entity.Radius, position(random)); // Resting on the ground
+		entity.Material = pickMaterial(random);
+		entity.UVScale = uvScales[pickUVScale(random)];
+	}
+
+	// What the GPU side would hold for each texture
+	struct SimulatedTexture {
+		unsigned int ResidentMip;
+		int LoadingMip = -1;
+		unsigned int LoadDoneFrame = 0;
+	};
+	std::vector<SimulatedTexture> simulated(textureCount);
+	for (unsigned int i = 0; i < textureCount; i++) {
+		simulated[i].ResidentMip = streamer.GetTailMip(i);
+	}
+
+	// 1080p with a 60 degree vertical field of view, the camera's default
+	float fieldOfView = 3.14159265f / 3.f;
+	float pixelsPerUnit = 1080.f / (2.f * std::tan(fieldOfView * 0.5f));
+	float cosHalfWidth = std::cos(std::atan(std::tan(fieldOfView * 0.5f) * 16.f / 9.f));
+	unsigned int moveFrames = frameCount - frameCount / 4; // The camera stops for the last quarter, to let streaming settle
+
+	unsigned int violations = 0, budgetViolations = 0, accountingErrors = 0;
+	unsigned long long loadCount = 0, evictionCount = 0;
+	unsigned int maxLoads = 0, maxEvictions = 0;
+	double visibleSum = 0.0, atWantedSum = 0.0, missingSum = 0.0;
+	size_t peakBytes = 0;
+	double updateTime = 0.0;
+	for (unsigned int frame = 0; frame < frameCount; frame++) {
+		float angle = std::min(frame, moveFrames) * 0.0015f;
+		Vector3 camera(std::cos(angle) * 120.f, 3.f, std::sin(angle) * 120.f);
+		Vector3 forward(-std::sin(angle), 0.f, std::cos(angle));
+
+		// Finished reads land before the streamer decides anything new, as in TextureLoader::UpdateStreaming
+		for (unsigned int i = 0; i < textureCount; i++) {
+			SimulatedTexture& texture = simulated[i];
+			if (texture.LoadingMip >= 0 && texture.LoadDoneFrame <= frame) {
+				texture.ResidentMip = (unsigned int)texture.LoadingMip;
+				texture.LoadingMip = -1;
+				streamer.CompleteLoad(i, true);
+			}
+		}
+
+		for (const SimulatedEntity& entity : entities) {
+			float x = entity.Position.x - camera.x, y = entity.Position.y - camera.y, z = entity.Position.z - camera.z;
+			float distance = std::sqrt(x * x + y * y + z * z);
+			if (distance > entity.Radius && (x * forward.x + z * forward.z) < distance * cosHalfWidth - entity.Radius)
+				continue;
+			float texels = TextureStreamer::ProjectSphereArea(entity.Radius, distance, pixelsPerUnit) * entity.UVScale * entity.UVScale;
+			for (unsigned int slot = 0; slot < 3; slot++) {
+				streamer.ReportCoverage(entity.Material * 3 + slot, texels);
+			}
+		}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const std::vector<TextureStreamStep>& steps = streamer.Update();
+		updateTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		unsigned int loads = 0, evictions = 0;
+		for (const TextureStreamStep& step : steps) {
+			SimulatedTexture& texture = simulated[step.Texture];
+			if (step.Type == TextureStreamStepType::Load) {
+				violations += (texture.LoadingMip >= 0 || step.Mip + 1 != texture.ResidentMip) ? 1 : 0;
+				texture.LoadingMip = (int)step.Mip;
+				texture.LoadDoneFrame = frame + latency;
+				loads++;
+			}
+			else {
+				violations += (texture.LoadingMip >= 0 || step.Mip != texture.ResidentMip || step.Mip >= streamer.GetTailMip(step.Texture)) ? 1 : 0;
+				texture.ResidentMip = step.Mip + 1;
+				evictions++;
+			}
+		}
+		loadCount += loads;
+		evictionCount += evictions;
+		maxLoads = std::max(maxLoads, loads);
+		maxEvictions = std::max(maxEvictions, evictions);
+
+		// The streamer's byte counts against the levels the simulation holds
+		size_t residentBytes = 0, loadingBytes = 0;
+		for (unsigned int i = 0; i < textureCount; i++) {
+			accountingErrors += streamer.GetResidentMip(i) != simulated[i].ResidentMip ? 1 : 0;
+			for (unsigned int mip = simulated[i].ResidentMip; mip < mipCounts[i]; mip++) {
+				residentBytes += streamer.GetLevelBytes(i, mip);
+			}
+			if (simulated[i].LoadingMip >= 0)
+				loadingBytes += streamer.GetLevelBytes(i, (unsigned int)simulated[i].LoadingMip);
+		}
+
+		const TextureStreamerStats& stats = streamer.GetStats();
+		accountingErrors += (stats.ResidentBytes != residentBytes || stats.LoadingBytes != loadingBytes) ? 1 : 0;
+		budgetViolations += (stats.ResidentBytes + stats.LoadingBytes > settings.BudgetBytes) ? 1 : 0;
+		peakBytes = std::max(peakBytes, stats.ResidentBytes + stats.LoadingBytes);
+		visibleSum += stats.VisibleTextures;
+		atWantedSum += stats.VisibleAtWanted;
+		missingSum += stats.MissingLevels;
+	}
+
+	const TextureStreamerStats& stats = streamer.GetStats();
+	size_t tailBytes = 0;
+	for (unsigned int i = 0; i < textureCount; i++) {
+		for (unsigned int mip = streamer.GetTailMip(i); mip < mipCounts[i]; mip++) {
+			tailBytes += streamer.GetLevelBytes(i, mip);
+		}
+	}
+	double megabyte = 1024.0 * 1024.0;
+	std::printf("stream-sim: %u textures (%.1f MB with every mip, %.1f MB of tails), %u entities, %u frames, budget %.1f MB, loads take %u frames\n",
+		textureCount, fullBytes / megabyte, tailBytes / megabyte, entityCount, frameCount, settings.BudgetBytes / megabyte, latency);
+	std::printf("  %-24s %10.4f ms per frame\n", "update", updateTime / frameCount);
+	std::printf("  %-24s avg %8.2f   max %6u per frame   (%llu total)\n", "loads", (double)loadCount / frameCount, maxLoads, loadCount);
+	std::printf("  %-24s avg %8.2f   max %6u per frame   (%llu total)\n", "evictions", (double)evictionCount / frameCount, maxEvictions, evictionCount);
+	std::printf("  %-24s %10.1f MB peak   %.1f MB at the end\n", "resident + loading", peakBytes / megabyte, (stats.ResidentBytes + stats.LoadingBytes) / megabyte);
+	std::printf("  %-24s %9.1f%%   %.2f levels missing per visible texture\n", "visible at wanted mip",
+		visibleSum > 0.0 ? 100.0 * atWantedSum / visibleSum : 100.0, visibleSum > 0.0 ? missingSum / visibleSum : 0.0);
+	std::printf("  %-24s %u of %u visible textures at their wanted mip\n", "settled", stats.VisibleAtWanted, stats.VisibleTextures);
+	std::printf("  %-24s %10u\n", "order violations", violations);
+	std::printf("  %-24s %10u\n", "accounting errors", accountingErrors);
+	std::printf("  %-24s %10u frames\n", "over budget", budgetViolations);
+
+	// Tails alone over budget can't be helped, so they only fail when there's something the budget could have done
+	bool bBudgetBound = stats.ResidentBytes + stats.LoadingBytes + (size_t)(settings.BudgetBytes * 0.1) >= settings.BudgetBytes;
+	bool bSettled = stats.VisibleAtWanted == stats.VisibleTextures || bBudgetBound;
+	bool bPassed = violations == 0 && accountingErrors == 0 && (budgetViolations == 0 || tailBytes > settings.BudgetBytes) && bSettled;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Drive an AssetPool the way a streaming world would,
+// with users acquiring and releasing files by whatever
+// path spelling they have, and check it against a model
+//	- Each file is asked for by three spellings (with
+//	  "..", "." and different case), which must all give
+//	  the same handle and never load it twice
+//	- Ref counts, bytes and live/pending counts must
+//	  match the model after every frame, unreferenced
+//	  assets must survive exactly ASSET_DESTROY_DELAY_FRAMES
+//	  Collects (and be revived if asked for meanwhile),
+//	  and handles to destroyed assets must stay invalid
+//	  after their slots are reused
+//-------------------------------------------------------
+static int RunAssetPoolCheck(int argc, char* argv[])
+{
+	unsigned int fileCount = FindUIntOption(argc, argv, "--files", 512);
+	unsigned int frameCount = FindUIntOption(argc, argv, "--frames", 2000);
+	unsigned int operationCount = FindUIntOption(argc, argv, "--operations", 256); // Acquires and releases per frame
+	unsigned int seed = FindUIntOption(argc, argv, "--seed", 1);
+	if (fileCount == 0 || frameCount == 0) {
+		std::printf("asset-pool: files and frames must be non-zero\n");
+		return 1;
+	}
+
+	// Three spellings of each file, checked up front to all give one key
+	unsigned int errors = 0;
+	std::vector<std::string> spellings;
+	for (unsigned int i = 0; i < fileCount; i++) {
+		std::string folder = "assets/set" + std::to_string(i % 16);
+		std::string name = "mesh" + std::to_string(i) + ".obj";
+		std::string upper = name;
+		std::transform(upper.begin(), upper.end(), upper.begin(), [](char a_c) { return (char)std::toupper((unsigned char)a_c); });
+		spellings.push_back(folder + "/" + name);
+		spellings.push_back("./" + folder + "/../set" + std::to_string(i % 16) + "/" + name);
+		spellings.push_back(folder + "/./" + upper);
+		std::string key = AssetKeys::FromPath(spellings[i * 3]);
+		if (AssetKeys::FromPath(spellings[i * 3 + 1]) != key || AssetKeys::FromPath(spellings[i * 3 + 2]) != key)
+			errors++;
+	}
+	std::vector<std::string> keys(spellings.size());
+	double keyTime = TimeBestOf(1, [&]() {
+		for (size_t i = 0; i < spellings.size(); i++) {
+			keys[i] = AssetKeys::FromPath(spellings[i]);
+		}
+	});
+
+	// What the pool should hold for each file
+	struct ModelFile {
+		AssetHandle<int> Handle;
+		unsigned int RefCount = 0;
+		uint64_t ReleaseFrame = 0;
+		size_t Bytes = 0;
+		int Id = -1; // -1 when not loaded
+	};
+	std::vector<ModelFile> model(fileCount);
+	std::vector<AssetHandle<int>> staleHandles;
+	unsigned int loads = 0, destroyed = 0, revived = 0, staleChecks = 0;
+	int nextId = 0;
+
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<unsigned int> pickFile(0, fileCount - 1);
+	std::uniform_int_distribution<unsigned int> pickSpelling(0, 2);
+	std::uniform_int_distribution<size_t> pickBytes(1 << 10, 1 << 20);
+
+	AssetPool<int> pool;
+	uint64_t collects = 0;
+	double operationTime = 0.0;
+	for (unsigned int frame = 0; frame < frameCount; frame++) {
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned int operation = 0; operation < operationCount; operation++) {
+			unsigned int file = pickFile(random);
+			ModelFile& expected = model[file];
+
+			// Acquire more often than release for the first quarter so the pool fills, then less so it churns
+			bool bAcquire = expected.RefCount == 0 || random() % 100 < (frame < frameCount / 4 ? 60u : 40u);
+			if (!bAcquire) {
+				pool.Release(expected.Handle);
+				if (--expected.RefCount == 0)
+					expected.ReleaseFrame = collects;
+				continue;
+			}
+
+			const std::string& key = keys[file * 3 + pickSpelling(random)];
+			AssetHandle<int> handle = pool.Acquire(key);
+			if (!pool.IsValid(handle)) {
+				if (expected.Id >= 0)
+					errors++; // Loaded twice
+				expected.Id = nextId++;
+				expected.Bytes = pickBytes(random);
+				handle = pool.Add(key, std::make_shared<int>(expected.Id), expected.Bytes);
+				expected.Handle = handle;
+				loads++;
+			}
+			else {
+				if (expected.Id < 0 || handle != expected.Handle || *pool.Get(handle) != expected.Id)
+					errors++;
+				revived += expected.RefCount == 0 ? 1 : 0;
+			}
+			expected.RefCount++;
+		}
+		destroyed += pool.Collect();
+		collects++;
+		operationTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		// The model's own collect
+		unsigned int live = 0, pending = 0;
+		size_t bytes = 0;
+		for (ModelFile& expected : model) {
+			if (expected.Id >= 0 && expected.RefCount == 0 && collects - expected.ReleaseFrame >= ASSET_DESTROY_DELAY_FRAMES) {
+				if (pool.IsValid(expected.Handle))
+					errors++; // Outlived its delay
+				staleHandles.push_back(expected.Handle);
+				expected.Id = -1;
+			}
+			if (expected.Id < 0)
+				continue;
+			if (!pool.IsValid(expected.Handle) || pool.GetRefCount(expected.Handle) != expected.RefCount
+				|| pool.GetBytes(expected.Handle) != expected.Bytes)
+				errors++;
+			live += expected.RefCount > 0 ? 1 : 0;
+			pending += expected.RefCount == 0 ? 1 : 0;
+			bytes += expected.Bytes;
+		}
+		AssetPoolStats stats = pool.GetStats();
+		if (stats.Live != live || stats.Pending != pending || stats.Bytes != bytes)
+			errors++;
+
+		// Slots get reused, so a handle from before must keep missing
+		for (size_t i = staleHandles.size() > 64 ? staleHandles.size() - 64 : 0; i < staleHandles.size(); i++) {
+			errors += pool.IsValid(staleHandles[i]) ? 1 : 0;
+			staleChecks++;
+		}
+	}
+
+	AssetPoolStats stats = pool.GetStats();
+	if (stats.Loads != loads || stats.Destroyed != destroyed || destroyed != staleHandles.size())
+		errors++;
+
+	unsigned long long operations = (unsigned long long)frameCount * operationCount;
+	std::printf("asset-pool: %u files, %u frames, %u operations per frame, seed %u\n", fileCount, frameCount, operationCount, seed);
+	std::printf("  %-24s %10.3f ms for %zu paths\n", "path keys", keyTime, spellings.size());
+	std::printf("  %-24s %10.3f ms total   %.1f ns per operation\n", "acquire/release/collect", operationTime,
+		operationTime * 1e6 / (double)std::max(operations, 1ull));
+	std::printf("  %-24s %10u   (%u reuses, %u revived while pending)\n", "loads", stats.Loads, stats.Reuses, revived);
+	std::printf("  %-24s %10u\n", "destroyed", stats.Destroyed);
+	std::printf("  %-24s %10u live, %u pending, %.1f MB\n", "at the end", stats.Live, stats.Pending, stats.Bytes / (1024.0 * 1024.0));
+	std::printf("  %-24s %10u\n", "stale handle checks", staleChecks);
+	std::printf("  %-24s %10u\n", "errors", errors);
+
+	bool bPassed = errors == 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Pack a folder (the assets folder by default) into an
+// AssetArchive, then check it against the loose files
+//	- The codec round trips a few awkward inputs first,
+//	  and must refuse truncated data
+//	- Every entry must match its hash and read back byte
+//	  for byte the same as its loose file
+//	- Times reading every file loose (an open and read
+//	  each) against the archive (one mapping, views and
+//	  decompression), then has the loaders take every
+//	  PNG, DDS and OBJ both ways, which must also match
+//-------------------------------------------------------
+static int RunAssetArchive(int argc, char* argv[])
+{
+	const char* directory = FindOption(argc, argv, "--dir", "assets");
+	const char* output = FindOption(argc, argv, "--out", "assets" ASSET_ARCHIVE_EXTENSION);
+	unsigned int runs = std::max(FindUIntOption(argc, argv, "--runs", 3), 1u);
+	AssetArchiveSettings settings;
+	settings.bCompress = !HasFlag(argc, argv, "--no-compress");
+
+	// Empty, tiny, incompressible, one long run, and repeating text
+	unsigned int codecFailures = 0;
+	std::mt19937 random(1);
+	std::vector<std::vector<uint8_t>> samples(5);
+	samples[1] = { 7 };
+	for (unsigned int i = 0; i < 100000; i++) {
+		samples[2].push_back((uint8_t)random());
+		samples[3].push_back(42);
+		samples[4].push_back((uint8_t)"v 1.0 2.0 3.0\nvt 0.5 0.5\n"[i % 25]);
+	}
+	for (const std::vector<uint8_t>& sample : samples) {
+		std::vector<uint8_t> compressed, restored(sample.size());
+		AssetArchive::Compress(sample.data(), sample.size(), compressed);
+		codecFailures += AssetArchive::Decompress(compressed.data(), compressed.size(), restored.data(), restored.size()) && restored == sample ? 0 : 1;
+		if (compressed.size() > 1)
+			codecFailures += AssetArchive::Decompress(compressed.data(), compressed.size() / 2, restored.data(), restored.size()) ? 1 : 0;
+	}
+
+	AssetArchiveBuildResult result;
+	auto start = std::chrono::steady_clock::now();
+	if (!AssetArchive::Build(directory, output, settings, result)) {
+		std::printf("archive: couldn't archive %s into %s\n", directory, output);
+		return 1;
+	}
+	double buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// The loose files, as the builder found them
+	std::vector<std::filesystem::path> files;
+	std::string outputKey = AssetKeys::FromPath(output);
+	std::error_code error;
+	for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+		if (it->is_regular_file() && AssetKeys::FromPath(it->path()) != outputKey)
+			files.push_back(it->path());
+	}
+
+	std::printf("archive: %s -> %s, %u entries, compression %s\n", directory, output, result.Entries, settings.bCompress ? "on" : "off");
+	std::printf("  %-24s %10.3f ms\n", "build", buildTime);
+	std::printf("  %-24s %10.1f MB -> %.1f MB   (%u compressed, %u duplicates)\n", "size", result.SourceBytes / (1024.0 * 1024.0),
+		result.ArchiveBytes / (1024.0 * 1024.0), result.Compressed, result.Duplicates);
+
+	// Each entry against its hash and its loose file
+	unsigned int mismatched = 0;
+	std::vector<AssetFileView> loose(files.size());
+	for (size_t i = 0; i < files.size(); i++) {
+		mismatched += AssetFiles::Read(files[i], loose[i]) ? 0 : 1;
+	}
+	if (!AssetFiles::Mount(output, directory)) {
+		std::printf("archive: couldn't open %s\n", output);
+		return 1;
+	}
+	const AssetArchive& archive = AssetFiles::GetArchive();
+	for (unsigned int i = 0; i < archive.GetEntryCount(); i++) {
+		mismatched += archive.Verify(i) ? 0 : 1;
+	}
+	for (size_t i = 0; i < files.size(); i++) {
+		AssetFileView archived;
+		if (!AssetFiles::Read(files[i], archived) || !archived.bArchived || archived.Size != loose[i].Size
+			|| (archived.Size > 0 && std::memcmp(archived.Data, loose[i].Data, archived.Size) != 0))
+			mismatched++;
+	}
+	AssetFiles::Unmount();
+	loose.clear();
+
+	// Every file's contents, loose and then archived. The archive pass includes mounting it, and every page of a
+	// view is touched, so mapped files are really read
+	size_t bytesRead = 0;
+	unsigned int touched = 0;
+	auto readAll = [&]() {
+		bytesRead = 0;
+		for (const std::filesystem::path& file : files) {
+			AssetFileView view;
+			if (!AssetFiles::Read(file, view))
+				continue;
+			for (size_t i = 0; i < view.Size; i += 4096) {
+				touched += view.Data[i];
+			}
+			bytesRead += view.Size;
+		}
+	};
+	double looseTime = TimeBestOf(runs, readAll);
+	double archiveTime = TimeBestOf(runs, [&]() {
+		AssetFiles::Mount(output, directory);
+		readAll();
+		AssetFiles::Unmount();
+	});
+
+	// What the loaders make of each, both ways
+	struct LoadedFile {
+		bool bLoaded = false;
+		TextureData Texture;
+		unsigned int VertexCount = 0;
+		unsigned int IndexCount = 0;
+	};
+	std::shared_ptr<NullRenderDevice> device = std::make_shared<NullRenderDevice>();
+	auto loadAll = [&](std::vector<LoadedFile>& a_loaded) {
+		a_loaded.assign(files.size(), LoadedFile());
+		for (size_t i = 0; i < files.size(); i++) {
+			std::filesystem::path extension = files[i].extension();
+			LoadedFile& loaded = a_loaded[i];
+			if (extension == ".png")
+				loaded.bLoaded = PngDecoder::LoadFile(files[i], loaded.Texture);
+			else if (extension == ".dds")
+				loaded.bLoaded = DDSFile::ReadTexture(files[i], loaded.Texture);
+			else if (extension == ".obj") {
+				Mesh mesh(files[i].wstring().c_str(), device);
+				loaded.bLoaded = mesh.GetLODCount() > 0;
+				loaded.VertexCount = loaded.bLoaded ? mesh.GetLOD(0).VertexCount : 0;
+				loaded.IndexCount = mesh.GetIndexCount();
+			}
+		}
+	};
+	std::vector<LoadedFile> looseLoads, archiveLoads;
+	double looseLoadTime = TimeBestOf(1, [&]() { loadAll(looseLoads); });
+	AssetFiles::Mount(output, directory);
+	double archiveLoadTime = TimeBestOf(1, [&]() { loadAll(archiveLoads); });
+	AssetFiles::Unmount();
+	unsigned int loadCount = 0, loadMismatches = 0;
+	for (size_t i = 0; i < files.size(); i++) {
+		const LoadedFile& loose = looseLoads[i];
+		const LoadedFile& packed = archiveLoads[i];
+		loadCount += loose.bLoaded ? 1 : 0;
+		bool bSame = loose.bLoaded == packed.bLoaded && loose.VertexCount == packed.VertexCount && loose.IndexCount == packed.IndexCount
+			&& loose.Texture.Format == packed.Texture.Format && loose.Texture.Mips.size() == packed.Texture.Mips.size();
+		for (size_t mip = 0; bSame && mip < loose.Texture.Mips.size(); mip++) {
+			bSame = loose.Texture.Mips[mip].Pixels == packed.Texture.Mips[mip].Pixels;
+		}
+		loadMismatches += bSame ? 0 : 1;
+	}
+
+	std::printf("  %-24s %10.3f ms   %8.1f MB/s\n", "read all, loose", looseTime, bytesRead / (looseTime * 1000.0));
+	std::printf("  %-24s %10.3f ms   %8.1f MB/s   (%.2fx)\n", "read all, archive", archiveTime, bytesRead / (archiveTime * 1000.0),
+		looseTime / archiveTime);
+	std::printf("  %-24s %10.3f ms   (%u files)\n", "load all, loose", looseLoadTime, loadCount);
+	std::printf("  %-24s %10.3f ms   (%.2fx)\n", "load all, archive", archiveLoadTime, looseLoadTime / archiveLoadTime);
+	std::printf("  %-24s %10u\n", "codec failures", codecFailures);
+	std::printf("  %-24s %10u\n", "mismatched entries", mismatched);
+	std::printf("  %-24s %10u\n", "mismatched loads", loadMismatches);
+
+	bool bPassed = codecFailures == 0 && mismatched == 0 && loadMismatches == 0 && result.Entries == files.size();
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Build a folder's assets (the assets folder by default)
+// with an AssetBuilder, then check that it's incremental
+//	- A second build straight after must build nothing
+//	  and hash nothing, as the manifest knows every file
+//	- --touch FILE bumps a file's write time without
+//	  changing it. It must be hashed again, alone, and
+//	  still nothing rebuilds
+//-------------------------------------------------------
+static int RunAssetBuild(int argc, char* argv[])
+{
+	const char* directory = FindOption(argc, argv, "--dir", "assets");
+	const char* manifest = FindOption(argc, argv, "--manifest", "assets.manifest");
+	const char* archive = FindOption(argc, argv, "--archive", nullptr);
+	const char* touchFile = FindOption(argc, argv, "--touch", nullptr);
+	const char* qualityName = FindOption(argc, argv, "--quality", "normal");
+	AssetBuildSettings settings;
+	settings.SpecularSamples = FindUIntOption(argc, argv, "--samples", settings.SpecularSamples);
+	settings.ArchiveFile = archive != nullptr ? archive : "";
+	settings.bForce = HasFlag(argc, argv, "--force");
+	if (!ParseCompressionQuality(qualityName, settings.Texture.Quality)) {
+		std::printf("asset-build: unknown quality '%s'\n", qualityName);
+		return 1;
+	}
+
+	static const char* s_types[4] = { "texture", "orm", "specular", "archive" };
+	AssetBuilder builder(directory, manifest);
+	auto build = [&](const char* a_label, AssetBuildResult& a_result) {
+		bool bSucceeded = false;
+		double time = TimeBestOf(1, [&]() { bSucceeded = builder.Build(settings, a_result); });
+		std::printf("  %-24s %10.3f ms   %u built, %u up to date, %u failed, %u files hashed (%.1f MB)\n", a_label, time,
+			a_result.Built, a_result.UpToDate, a_result.Failed, a_result.HashedFiles, a_result.HashedBytes / (1024.0 * 1024.0));
+		return bSucceeded;
+	};
+
+	std::printf("asset-build: %s, manifest %s%s%s, %u threads\n", directory, manifest, archive != nullptr ? ", archive " : "",
+		archive != nullptr ? archive : "", JobSystem::GetInstance().GetThreadCount());
+	AssetBuildResult result;
+	bool bBuilt = build(settings.bForce ? "forced build" : "build", result);
+	for (const AssetBuildStep& step : builder.GetSteps()) {
+		if (step.bBuilt || step.bFailed)
+			std::printf("    %-8s %s%s\n", s_types[(int)step.Type], builder.GetName(step.Output).c_str(), step.bFailed ? "   FAILED" : "");
+	}
+
+	settings.bForce = false;
+	AssetBuildResult nullResult;
+	bool bNullBuilt = build("null build", nullResult) && nullResult.Built == 0 && nullResult.HashedFiles == 0;
+
+	bool bTouchBuilt = true;
+	if (touchFile != nullptr) {
+		std::error_code error;
+		std::filesystem::last_write_time(touchFile, std::filesystem::file_time_type::clock::now(), error);
+		AssetBuildResult touchResult;
+		bTouchBuilt = !error && build("after touch", touchResult) && touchResult.Built == 0 && touchResult.HashedFiles == 1;
+	}
+
+	bool bPassed = bBuilt && bNullBuilt && bTouchBuilt && result.Steps > 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Check ShaderReflection blobs and print what's in them
+//	- A synthetic blob must round-trip through a file, and
+//	  a wrong bytecode hash, a truncated blob and a flipped
+//	  byte must all be refused
+//	- Then every .refl under --dir whose .cso sits beside
+//	  it is loaded against that .cso and printed. The light
+//	  arrays are checked against BasicLight, as HeadlessGame
+//	  assumes they match
+//-------------------------------------------------------
+static int RunShaderReflection(int argc, char* argv[])
+{
+	const char* directory = FindOption(argc, argv, "--dir", ".");
+	bool bVerbose = HasFlag(argc, argv, "--verbose");
+
+	// Laid out like PixelShader's lighting buffer, with a texture, a sampler and two inputs
+	const uint32_t lightsSize = (uint32_t)sizeof(BasicLight) * HEADLESS_MAX_LIGHTS_OF_SINGLE_TYPE;
+	ShaderReflection synthetic;
+	synthetic.Begin(0x1234);
+	synthetic.AddBuffer("PixelLightingData", 0, 16 + lightsSize * 2, 1);
+	synthetic.AddVariable("c_lightCounts", 0, 8);
+	synthetic.AddVariable("c_directionalLights", 16, lightsSize);
+	synthetic.AddVariable("c_pointLights", 16 + lightsSize, lightsSize);
+	synthetic.AddResource("t_albedo", ShaderResourceKind::Texture, 0);
+	synthetic.AddResource("s_sampler", ShaderResourceKind::Sampler, 0);
+	synthetic.AddInput("POSITION", 0, 3, 0x7);
+	synthetic.AddInput("TEXCOORD", 0, 3, 0x3);
+	synthetic.SetThreadGroupSize(8, 8, 1);
+	synthetic.End();
+
+	unsigned int selfTestFailures = 0;
+	std::filesystem::path testFile = std::filesystem::temp_directory_path() / "headless-test" SHADER_REFLECTION_EXTENSION;
+	ShaderReflection loaded;
+	if (!synthetic.Save(testFile) || !loaded.Load(testFile, 0x1234) || loaded.GetData() != synthetic.GetData())
+		selfTestFailures++;
+	else {
+		int pointLights = loaded.FindVariable("c_pointLights");
+		if (loaded.GetBufferCount() != 1 || pointLights != 2 || loaded.GetVariable(2).ByteOffset != 16 + lightsSize ||
+			std::strcmp(loaded.GetName(loaded.GetResource(1).Name), "s_sampler") != 0 || loaded.GetInput(1).Mask != 0x3 ||
+			loaded.GetHeader().ThreadGroupSize[0] != 8 || loaded.FindBuffer("Missing") != -1)
+			selfTestFailures++;
+	}
+	std::error_code error;
+	std::filesystem::remove(testFile, error);
+
+	ShaderReflection refused;
+	std::vector<uint8_t> data = synthetic.GetData();
+	selfTestFailures += refused.SetData(data, 0x1235) ? 1 : 0;
+	selfTestFailures += refused.SetData(std::vector<uint8_t>(data.begin(), data.end() - 1), 0x1234) ? 1 : 0;
+	for (size_t i = 0; i < data.size(); i++) {
+		std::vector<uint8_t> damaged = data;
+		damaged[i] ^= 0x40;
+		selfTestFailures += refused.SetData(std::move(damaged), 0x1234) ? 1 : 0;
+	}
+	selfTestFailures += refused.IsValid() ? 1 : 0;
+
+	std::printf("shader-reflection: %zu byte synthetic blob, %u self-test failures\n", data.size(), selfTestFailures);
+
+	// Blobs the game wrote beside its shaders
+	static const char* s_kinds[4] = { "texture", "sampler", "uav", "other" };
+	unsigned int blobCount = 0, staleCount = 0, layoutMismatches = 0;
+	for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+		if (!it->is_regular_file() || it->path().extension() != SHADER_REFLECTION_EXTENSION)
+			continue;
+		std::filesystem::path shaderFile = it->path();
+		shaderFile.replace_extension(".cso");
+		std::vector<uint8_t> bytecode;
+		std::ifstream file(shaderFile, std::ios::binary);
+		if (!file)
+			continue;
+		bytecode.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		ShaderReflection reflection;
+		auto start = std::chrono::steady_clock::now();
+		bool bLoaded = reflection.Load(it->path(), ShaderReflection::HashBytecode(bytecode.data(), bytecode.size()));
+		double loadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (!bLoaded) {
+			std::printf("  %-32s stale or damaged\n", shaderFile.filename().string().c_str());
+			staleCount++;
+			continue;
+		}
+		blobCount++;
+		std::printf("  %-32s %6zu bytes  %7.3f ms   %u buffers, %u variables, %u resources, %u inputs\n",
+			shaderFile.filename().string().c_str(), reflection.GetData().size(), loadTime, reflection.GetBufferCount(),
+			reflection.GetVariableCount(), reflection.GetResourceCount(), reflection.GetInputCount());
+
+		for (unsigned int b = 0; bVerbose && b < reflection.GetBufferCount(); b++) {
+			const ShaderReflectionBuffer& buffer = reflection.GetBuffer(b);
+			std::printf("    cbuffer %s : b%u, %u bytes\n", reflection.GetName(buffer.Name), buffer.BindIndex, buffer.Size);
+			for (unsigned int v = buffer.FirstVariable; v < buffer.FirstVariable + buffer.VariableCount; v++) {
+				const ShaderReflectionVariable& variable = reflection.GetVariable(v);
+				std::printf("      %-28s offset %5u  size %5u\n", reflection.GetName(variable.Name), variable.ByteOffset, variable.Size);
+			}
+		}
+		for (unsigned int r = 0; bVerbose && r < reflection.GetResourceCount(); r++) {
+			const ShaderReflectionResource& resource = reflection.GetResource(r);
+			std::printf("    %-7s %s : %u\n", s_kinds[(int)resource.Kind], reflection.GetName(resource.Name), resource.BindIndex);
+		}
+		for (unsigned int i = 0; bVerbose && i < reflection.GetInputCount(); i++) {
+			const ShaderReflectionInput& input = reflection.GetInput(i);
+			std::printf("    input   %s%u, mask 0x%x\n", reflection.GetName(input.SemanticName), input.SemanticIndex, input.Mask);
+		}
+
+		for (const char* name : { "c_directionalLights", "c_pointLights" }) {
+			int index = reflection.FindVariable(name);
+			if (index >= 0 && reflection.GetVariable(index).Size != lightsSize) {
+				std::printf("    %s is %u bytes, BasicLight array is %u\n", name, reflection.GetVariable(index).Size, lightsSize);
+				layoutMismatches++;
+			}
+		}
+	}
+
+	std::printf("  %-24s %10u\n", "blobs loaded", blobCount);
+	std::printf("  %-24s %10u\n", "stale blobs", staleCount);
+	std::printf("  %-24s %10u\n", "layout mismatches", layoutMismatches);
+
+	bool bPassed = selfTestFailures == 0 && layoutMismatches == 0;
+	std::printf("%s\n", bPassed ? "PASS" : "FAIL");
+	return bPassed ? 0 : 1;
+}
+
+static const HeadlessCommand s_commands[] = {
+	{ "frame-bench", RunFrameBenchmark, "[--frames N] [--entities N] [--meshes N] [--materials N] [--point-lights N] [--seed N] [--timestep S] [--record]" },
+	{ "ssao-bench", RunSSAOBenchmark, "[--capture FILE | --width N --height N --seed N] [--samples N] [--resolution 1|2|4] [--temporal FRAMES [--camera-step F]] [--runs N] [--tolerance F]" },
+	{ "sh-bench", RunSHBenchmark, "[--size N] [--step RADIANS] [--runs N] [--tolerance F]" },
+	{ "ibl-bake", RunIBLBake, "[--sky FILE.dds | --synthetic N] [--out FILE.dds] [--size N] [--mips N] [--samples N] [--no-fis] [--compare]" },
+	{ "brdf-lut", RunBRDFLookupTable, "[--size N] [--samples N] [--analytic] [--format unorm16|unorm8|float16|float32] [--reference-size N] [--reference-samples N] [--header FILE] [--runs N] [--tolerance F]" },
+	{ "probe-sched", RunProbeScheduleBenchmark, "[--probes N] [--frames N] [--faces N] [--mips N] [--mip-count N] [--refresh N] [--change-rate F] [--seed N]" },
+	{ "cull-bench", RunCullBenchmark, "[--entities N] [--views N] [--runs N] [--seed N]" },
+	{ "bvh-bench", RunBVHBenchmark, "[--entities N] [--frames N] [--move-fraction F] [--queries N] [--seed N]" },
+	{ "occlusion-bench", RunOcclusionBenchmark, "[--occluders N] [--entities N] [--width N] [--height N] [--runs N] [--seed N]" },
+	{ "lod-bench", RunLODBenchmark, "[--segments N] [--bumps F] [--pixel-error F] [--hysteresis F] [--height N] [--runs N]" },
+	{ "meshlet-bench", RunMeshletBenchmark, "[--segments N] [--views N] [--runs N] [--seed N]" },
+	{ "png-bench", RunPNGBenchmark, "[--dir DIRECTORY] [--bits 8|16] [--runs N]" },
+	{ "texture-cook", RunTextureCook, "[--dir DIRECTORY] [--filter kaiser|box] [--quality fast|normal|high] [--bc7] [--uncompressed] [--force]" },
+	{ "bc-bench", RunBCBenchmark, "[--dir DIRECTORY] [--format auto|bc1|bc4|bc5|bc7] [--quality fast|normal|high] [--runs N]" },
+	{ "stream-sim", RunStreamSimulation, "[--materials N] [--entities N] [--frames N] [--budget MB] [--max-loads N] [--latency FRAMES] [--seed N]" },
+	{ "asset-pool", RunAssetPoolCheck, "[--files N] [--frames N] [--operations N] [--seed N]" },
+	{ "archive", RunAssetArchive, "[--dir DIRECTORY] [--out FILE] [--no-compress] [--runs N]" },
+	{ "asset-build", RunAssetBuild, "[--dir DIRECTORY] [--manifest FILE] [--archive FILE] [--quality fast|normal|high] [--samples N] [--force] [--touch FILE]" },
+	{ "shader-reflection", RunShaderReflection, "[--dir DIRECTORY] [--verbose]" },
+};
+
+static void PrintUsage(const char* a_exeName)
+{
+	std::printf("usage: %s <command> [options]\n", a_exeName);
+	for (const HeadlessCommand& command : s_commands) {
+		std::printf("  %s %s\n", command.Name, command.Usage);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	for (const HeadlessCommand& command : s_commands) {
+		if (std::strcmp(argv[1], command.Name) == 0)
+			return command.Function(argc - 2, argv + 2);
+	}
+
+	std::printf("unknown command '%s'\n", argv[1]);
+	PrintUsage(argv[0]);
+	return 1;
+}
+
+#endif
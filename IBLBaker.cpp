@@ -0,0 +1,338 @@
+#include "IBLBaker.h"
+#include "JobSystem.h"
+
+#include <cmath>
+
+// SSE is baseline on every x64 target, and on x86 when building with /arch:SSE2 or -msse2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IBL_BAKER_SSE 1
+#include <emmintrin.h>
+#else
+#define IBL_BAKER_SSE 0
+#endif
+
+#define IBL_PI 3.14159265358979f
+
+namespace
+{
+	//---------------------------------------------------
+	// One GGX sample around +Z, shared by every texel of
+	// a mip. Direction is the light vector L for N = V = Z
+	//---------------------------------------------------
+	struct GGXSample {
+		float X;
+		float Y;
+		float Z;
+		float Level; // Source mip to read
+	};
+
+	// Hammersley.hlsli radicalInverse_VdC
+	float RadicalInverse(unsigned int a_bits)
+	{
+		a_bits = (a_bits << 16u) | (a_bits >> 16u);
+		a_bits = ((a_bits & 0x55555555u) << 1u) | ((a_bits & 0xAAAAAAAAu) >> 1u);
+		a_bits = ((a_bits & 0x33333333u) << 2u) | ((a_bits & 0xCCCCCCCCu) >> 2u);
+		a_bits = ((a_bits & 0x0F0F0F0Fu) << 4u) | ((a_bits & 0xF0F0F0F0u) >> 4u);
+		a_bits = ((a_bits & 0x00FF00FFu) << 8u) | ((a_bits & 0xFF00FF00u) >> 8u);
+		return (float)a_bits * 2.3283064365386963e-10f;
+	}
+
+	//---------------------------------------------------
+	// ImportanceSampleGGX over the Hammersley set, keeping
+	// only samples above the horizon (NdotL > 0), which
+	// are the only ones the shader accumulated
+	//---------------------------------------------------
+	void BuildSamples(float a_roughness, unsigned int a_sampleCount, unsigned int a_sourceSize, unsigned int a_sourceMips,
+		bool a_bFiltered, std::vector<GGXSample>& a_samples)
+	{
+		float alpha = a_roughness * a_roughness;
+		float alphaSquared = alpha * alpha;
+		float texelSolidAngle = 4.f * IBL_PI / (6.f * a_sourceSize * a_sourceSize);
+		float maxLevel = (float)(a_sourceMips - 1);
+
+		a_samples.clear();
+		for (unsigned int i = 0; i < a_sampleCount; i++) {
+			float phi = 2.f * IBL_PI * ((float)i / a_sampleCount);
+			float xi = RadicalInverse(i);
+			float cosTheta = std::sqrt((1.f - xi) / (1.f + (alphaSquared - 1.f) * xi));
+			float sinTheta = std::sqrt(1.f - cosTheta * cosTheta);
+			float hx = sinTheta * std::cos(phi);
+			float hy = sinTheta * std::sin(phi);
+			float hz = cosTheta;
+
+			// L = 2 * dot(V, H) * H - V, with V = (0, 0, 1)
+			GGXSample sample;
+			sample.X = 2.f * hz * hx;
+			sample.Y = 2.f * hz * hy;
+			sample.Z = 2.f * hz * hz - 1.f;
+			if (sample.Z <= 0.f)
+				continue;
+
+			sample.Level = 0.f;
+			if (a_bFiltered) {
+				// pdf(L) = D * NdotH / (4 * VdotH), and NdotH == VdotH here
+				float denominator = hz * hz * (alphaSquared - 1.f) + 1.f;
+				float distribution = alphaSquared / (IBL_PI * denominator * denominator);
+				float pdf = distribution * 0.25f;
+				float sampleSolidAngle = 1.f / (a_sampleCount * pdf + 1e-6f);
+				float level = 0.5f * std::log2(sampleSolidAngle / texelSolidAngle) + 1.f; // +1 biases slightly blurrier, as recommended
+				sample.Level = level < 0.f ? 0.f : (level > maxLevel ? maxLevel : level);
+			}
+			a_samples.push_back(sample);
+		}
+	}
+
+	//---------------------------------------------------
+	// Same frame as ImportanceSampleGGX in ShaderHelpers
+	//---------------------------------------------------
+	void BuildTangentFrame(const Vector3& a_normal, Vector3& a_tangent, Vector3& a_bitangent)
+	{
+		Vector3 up = std::fabs(a_normal.z) < 0.999f ? Vector3(0.f, 0.f, 1.f) : Vector3(1.f, 0.f, 0.f);
+		Vector3 tangent(up.y * a_normal.z - up.z * a_normal.y, up.z * a_normal.x - up.x * a_normal.z, up.x * a_normal.y - up.y * a_normal.x);
+		float inverseLength = 1.f / std::sqrt(tangent.x * tangent.x + tangent.y * tangent.y + tangent.z * tangent.z);
+		a_tangent = Vector3(tangent.x * inverseLength, tangent.y * inverseLength, tangent.z * inverseLength);
+		a_bitangent = Vector3(
+			a_normal.y * a_tangent.z - a_normal.z * a_tangent.y,
+			a_normal.z * a_tangent.x - a_normal.x * a_tangent.z,
+			a_normal.x * a_tangent.y - a_normal.y * a_tangent.x);
+	}
+
+	//---------------------------------------------------
+	// Bilinear fetch from a known face, u and v in [-1, 1]
+	// (Cubemap::Sample after the face lookup)
+	//---------------------------------------------------
+	inline void SampleFace(const CubemapImage& a_cube, unsigned int a_face, float a_u, float a_v, float& a_r, float& a_g, float& a_b)
+	{
+		float maxCoordinate = (float)(a_cube.Size - 1);
+		float texelX = (a_u * 0.5f + 0.5f) * a_cube.Size - 0.5f;
+		float texelY = (a_v * 0.5f + 0.5f) * a_cube.Size - 0.5f;
+		texelX = texelX < 0.f ? 0.f : (texelX > maxCoordinate ? maxCoordinate : texelX);
+		texelY = texelY < 0.f ? 0.f : (texelY > maxCoordinate ? maxCoordinate : texelY);
+
+		unsigned int x0 = (unsigned int)texelX;
+		unsigned int y0 = (unsigned int)texelY;
+		unsigned int x1 = x0 + 1 < a_cube.Size ? x0 + 1 : x0;
+		unsigned int y1 = y0 + 1 < a_cube.Size ? y0 + 1 : y0;
+		float fractionX = texelX - x0;
+		float fractionY = texelY - y0;
+
+		const Vector4* texels = &a_cube.Texels[(size_t)a_face * a_cube.Size * a_cube.Size];
+		const Vector4& t00 = texels[(size_t)y0 * a_cube.Size + x0];
+		const Vector4& t10 = texels[(size_t)y0 * a_cube.Size + x1];
+		const Vector4& t01 = texels[(size_t)y1 * a_cube.Size + x0];
+		const Vector4& t11 = texels[(size_t)y1 * a_cube.Size + x1];
+		float w00 = (1.f - fractionX) * (1.f - fractionY);
+		float w10 = fractionX * (1.f - fractionY);
+		float w01 = (1.f - fractionX) * fractionY;
+		float w11 = fractionX * fractionY;
+		a_r = t00.x * w00 + t10.x * w10 + t01.x * w01 + t11.x * w11;
+		a_g = t00.y * w00 + t10.y * w10 + t01.y * w01 + t11.y * w11;
+		a_b = t00.z * w00 + t10.z * w10 + t01.z * w01 + t11.z * w11;
+	}
+
+	// Trilinear fetch from a known face
+	inline void SampleFaceLevel(const std::vector<CubemapImage>& a_mips, unsigned int a_face, float a_u, float a_v, float a_level,
+		float& a_r, float& a_g, float& a_b)
+	{
+		unsigned int level0 = (unsigned int)a_level;
+		float fraction = a_level - level0;
+		SampleFace(a_mips[level0], a_face, a_u, a_v, a_r, a_g, a_b);
+		if (fraction > 0.f && level0 + 1 < a_mips.size()) {
+			float r, g, b;
+			SampleFace(a_mips[level0 + 1], a_face, a_u, a_v, r, g, b);
+			a_r += (r - a_r) * fraction;
+			a_g += (g - a_g) * fraction;
+			a_b += (b - a_b) * fraction;
+		}
+	}
+
+	//---------------------------------------------------
+	// Prefilter one texel: NdotL weighted average of the
+	// samples rotated around a_normal
+	//---------------------------------------------------
+	Vector4 PrefilterTexel(const std::vector<CubemapImage>& a_sourceMips, const std::vector<GGXSample>& a_samples,
+		const Vector3& a_normal, bool a_bUseSIMD)
+	{
+		Vector3 tangent, bitangent;
+		BuildTangentFrame(a_normal, tangent, bitangent);
+
+		float totalR = 0.f, totalG = 0.f, totalB = 0.f, totalWeight = 0.f;
+		size_t i = 0;
+
+#if IBL_BAKER_SSE
+		if (a_bUseSIMD) {
+			const __m128 signMask = _mm_set1_ps(-0.f);
+			const __m128 one = _mm_set1_ps(1.f);
+			alignas(16) float lanesU[4], lanesV[4], lanesFace[4];
+
+			for (; i + 4 <= a_samples.size(); i += 4) {
+				// Rotate 4 samples into world space
+				__m128 sx = _mm_set_ps(a_samples[i + 3].X, a_samples[i + 2].X, a_samples[i + 1].X, a_samples[i].X);
+				__m128 sy = _mm_set_ps(a_samples[i + 3].Y, a_samples[i + 2].Y, a_samples[i + 1].Y, a_samples[i].Y);
+				__m128 sz = _mm_set_ps(a_samples[i + 3].Z, a_samples[i + 2].Z, a_samples[i + 1].Z, a_samples[i].Z);
+				__m128 dx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, _mm_set1_ps(tangent.x)), _mm_mul_ps(sy, _mm_set1_ps(bitangent.x))), _mm_mul_ps(sz, _mm_set1_ps(a_normal.x)));
+				__m128 dy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, _mm_set1_ps(tangent.y)), _mm_mul_ps(sy, _mm_set1_ps(bitangent.y))), _mm_mul_ps(sz, _mm_set1_ps(a_normal.y)));
+				__m128 dz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, _mm_set1_ps(tangent.z)), _mm_mul_ps(sy, _mm_set1_ps(bitangent.z))), _mm_mul_ps(sz, _mm_set1_ps(a_normal.z)));
+
+				// Major axis selection, same tie breaking as Cubemap::DirectionToFace
+				__m128 ax = _mm_andnot_ps(signMask, dx);
+				__m128 ay = _mm_andnot_ps(signMask, dy);
+				__m128 az = _mm_andnot_ps(signMask, dz);
+				__m128 isX = _mm_and_ps(_mm_cmpge_ps(ax, ay), _mm_cmpge_ps(ax, az));
+				__m128 isY = _mm_andnot_ps(isX, _mm_cmpge_ps(ay, az));
+				__m128 isZ = _mm_andnot_ps(_mm_or_ps(isX, isY), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+				// Face coordinates per case (see Cubemap's face axes)
+				//	+-X: u = -sign(x) * z, v = -y     +-Y: u = x, v = sign(y) * z     +-Z: u = sign(z) * x, v = -y
+				__m128 signX = _mm_or_ps(_mm_and_ps(dx, signMask), one);
+				__m128 signY = _mm_or_ps(_mm_and_ps(dy, signMask), one);
+				__m128 signZ = _mm_or_ps(_mm_and_ps(dz, signMask), one);
+				__m128 negativeY = _mm_xor_ps(dy, signMask);
+				__m128 u = _mm_or_ps(_mm_or_ps(
+					_mm_and_ps(isX, _mm_xor_ps(_mm_mul_ps(signX, dz), signMask)),
+					_mm_and_ps(isY, dx)),
+					_mm_and_ps(isZ, _mm_mul_ps(signZ, dx)));
+				__m128 v = _mm_or_ps(_mm_or_ps(
+					_mm_and_ps(isX, negativeY),
+					_mm_and_ps(isY, _mm_mul_ps(signY, dz))),
+					_mm_and_ps(isZ, negativeY));
+				__m128 major = _mm_or_ps(_mm_or_ps(_mm_and_ps(isX, ax), _mm_and_ps(isY, ay)), _mm_and_ps(isZ, az));
+				u = _mm_div_ps(u, major);
+				v = _mm_div_ps(v, major);
+
+				// Face index: 0 / 2 / 4 for the axis, plus 1 when negative
+				__m128 negative = _mm_or_ps(_mm_or_ps(
+					_mm_and_ps(isX, _mm_cmplt_ps(dx, _mm_setzero_ps())),
+					_mm_and_ps(isY, _mm_cmplt_ps(dy, _mm_setzero_ps()))),
+					_mm_and_ps(isZ, _mm_cmplt_ps(dz, _mm_setzero_ps())));
+				__m128 face = _mm_add_ps(
+					_mm_or_ps(_mm_and_ps(isY, _mm_set1_ps(2.f)), _mm_and_ps(isZ, _mm_set1_ps(4.f))),
+					_mm_and_ps(negative, one));
+
+				_mm_store_ps(lanesU, u);
+				_mm_store_ps(lanesV, v);
+				_mm_store_ps(lanesFace, face);
+				for (int lane = 0; lane < 4; lane++) {
+					const GGXSample& sample = a_samples[i + lane];
+					float r, g, b;
+					SampleFaceLevel(a_sourceMips, (unsigned int)lanesFace[lane], lanesU[lane], lanesV[lane], sample.Level, r, g, b);
+					totalR += r * sample.Z;
+					totalG += g * sample.Z;
+					totalB += b * sample.Z;
+					totalWeight += sample.Z;
+				}
+			}
+		}
+#else
+		(void)a_bUseSIMD;
+#endif
+
+		// Scalar path, and the remainder of the SIMD loop
+		for (; i < a_samples.size(); i++) {
+			const GGXSample& sample = a_samples[i];
+			Vector3 direction(
+				sample.X * tangent.x + sample.Y * bitangent.x + sample.Z * a_normal.x,
+				sample.X * tangent.y + sample.Y * bitangent.y + sample.Z * a_normal.y,
+				sample.X * tangent.z + sample.Y * bitangent.z + sample.Z * a_normal.z);
+			unsigned int face;
+			float u, v, r, g, b;
+			Cubemap::DirectionToFace(direction, face, u, v);
+			SampleFaceLevel(a_sourceMips, face, u, v, sample.Level, r, g, b);
+			totalR += r * sample.Z;
+			totalG += g * sample.Z;
+			totalB += b * sample.Z;
+			totalWeight += sample.Z;
+		}
+
+		float inverseWeight = totalWeight > 0.f ? 1.f / totalWeight : 0.f;
+		return Vector4(totalR * inverseWeight, totalG * inverseWeight, totalB * inverseWeight, 1.f);
+	}
+
+	// One job's worth of work
+	struct BakeTile {
+		unsigned int Mip;
+		unsigned int Face;
+		unsigned int X;
+		unsigned int Y;
+	};
+}
+
+//-------------------------------------------------------
+// Sky drops the smallest mips, but always keeps one
+//-------------------------------------------------------
+unsigned int IBLBaker::GetMipCount(const IBLBakeSettings& a_settings)
+{
+	unsigned int maxMips = 1;
+	while ((a_settings.Size >> maxMips) > 0) {
+		maxMips++;
+	}
+
+	unsigned int mipCount = a_settings.MipCount;
+	if (mipCount == 0)
+		mipCount = maxMips > IBL_BAKE_IGNORED_SMALL_MIPS + 1 ? maxMips - 1 - IBL_BAKE_IGNORED_SMALL_MIPS : 1;
+	return mipCount < maxMips ? mipCount : maxMips;
+}
+
+//-------------------------------------------------------
+// Bake every mip of the prefiltered cube
+//	- Roughness 0 is a straight (filtered) copy of the
+//	  source, since every GGX sample would land on R
+//-------------------------------------------------------
+void IBLBaker::PrefilterSpecular(const std::vector<CubemapImage>& a_sourceMips, const IBLBakeSettings& a_settings,
+	std::vector<CubemapImage>& a_output, bool a_bMultithreaded, bool a_bUseSIMD)
+{
+	unsigned int mipCount = GetMipCount(a_settings);
+	unsigned int sourceSize = a_sourceMips[0].Size;
+	unsigned int sourceMips = (unsigned int)a_sourceMips.size();
+
+	// Sample sets per mip, and the tile list covering every face of every mip
+	std::vector<std::vector<GGXSample>> samples(mipCount);
+	std::vector<BakeTile> tiles;
+	a_output.resize(mipCount);
+	for (unsigned int mip = 0; mip < mipCount; mip++) {
+		CubemapImage& image = a_output[mip];
+		image.Size = a_settings.Size >> mip;
+		image.Texels.resize((size_t)CUBEMAP_FACE_COUNT * image.Size * image.Size);
+
+		float roughness = mipCount > 1 ? mip / (float)(mipCount - 1) : 0.f;
+		if (roughness > 0.f) {
+			BuildSamples(roughness, a_settings.SampleCount, sourceSize, sourceMips, a_settings.bFilteredImportanceSampling, samples[mip]);
+		}
+		else {
+			// Single sample along R, from the source mip closest to the output resolution
+			float level = std::log2((float)sourceSize / image.Size);
+			float maxLevel = (float)(sourceMips - 1);
+			GGXSample sample = { 0.f, 0.f, 1.f, level < 0.f ? 0.f : (level > maxLevel ? maxLevel : level) };
+			samples[mip].push_back(sample);
+		}
+
+		for (unsigned int face = 0; face < CUBEMAP_FACE_COUNT; face++) {
+			for (unsigned int y = 0; y < image.Size; y += IBL_BAKE_TILE_SIZE) {
+				for (unsigned int x = 0; x < image.Size; x += IBL_BAKE_TILE_SIZE) {
+					tiles.push_back({ mip, face, x, y });
+				}
+			}
+		}
+	}
+
+	auto bakeTiles = [&](unsigned int a_begin, unsigned int a_end) {
+		for (unsigned int t = a_begin; t < a_end; t++) {
+			const BakeTile& tile = tiles[t];
+			CubemapImage& image = a_output[tile.Mip];
+			unsigned int x1 = tile.X + IBL_BAKE_TILE_SIZE < image.Size ? tile.X + IBL_BAKE_TILE_SIZE : image.Size;
+			unsigned int y1 = tile.Y + IBL_BAKE_TILE_SIZE < image.Size ? tile.Y + IBL_BAKE_TILE_SIZE : image.Size;
+			for (unsigned int y = tile.Y; y < y1; y++) {
+				for (unsigned int x = tile.X; x < x1; x++) {
+					Vector3 normal = Cubemap::CubeDirectionFromUV(tile.Face, (x + 0.5f) / image.Size, (y + 0.5f) / image.Size);
+					image.Texels[((size_t)tile.Face * image.Size + y) * image.Size + x] =
+						PrefilterTexel(a_sourceMips, samples[tile.Mip], normal, a_bUseSIMD);
+				}
+			}
+		}
+	};
+
+	if (a_bMultithreaded)
+		JobSystem::GetInstance().ParallelFor((unsigned int)tiles.size(), 1, bakeTiles);
+	else
+		bakeTiles(0, (unsigned int)tiles.size());
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include "Cubemap.h"
+
+#define IBL_BAKE_DEFAULT_SAMPLES 1024 // MAX_IBL_SAMPLES in ShaderHelpers.hlsli
+#define IBL_BAKE_IGNORED_SMALL_MIPS 2 // Sky::CreateSpecularReflectanceMap leaves out the 2x2 and 4x4 levels
+#define IBL_BAKE_TILE_SIZE 32 // Texels per side of one job
+
+//-------------------------------------------------------
+// Options for a specular prefilter bake
+//	- Defaults produce the same layout as the GPU path in
+//	  Sky::CreateSpecularReflectanceMap for a 1024 sky
+//-------------------------------------------------------
+struct IBLBakeSettings {
+	unsigned int Size = 128; // Face size of the top mip
+	unsigned int MipCount = 0; // 0 picks log2(Size) - IBL_BAKE_IGNORED_SMALL_MIPS, like Sky
+	unsigned int SampleCount = IBL_BAKE_DEFAULT_SAMPLES; // GGX samples per texel
+	bool bFilteredImportanceSampling = true; // Read a blurrier source mip for low probability samples
+};
+
+//-------------------------------------------------------
+// CPU version of IBLSpecularPrefilterPS, for baking the
+// split-sum prefiltered cube offline
+//	- Output mip m holds roughness m / (MipCount - 1)
+//	- Filtered importance sampling (GPU Gems 3, ch. 20)
+//	  picks the source mip whose texel solid angle matches
+//	  each sample's share of the lobe, which removes the
+//	  fireflies the fixed top-mip sampling produces and
+//	  allows far fewer samples for the same quality
+//	- Work is split into tiles of every face and mip and
+//	  spread over the JobSystem. With SSE, 4 samples are
+//	  rotated and mapped to faces at a time
+//-------------------------------------------------------
+namespace IBLBaker
+{
+	// Number of output mips the settings produce
+	unsigned int GetMipCount(const IBLBakeSettings& a_settings);
+
+	// Prefilter a_sourceMips (a full chain from Cubemap::BuildMipChain) into a_output, one CubemapImage per mip
+	void PrefilterSpecular(const std::vector<CubemapImage>& a_sourceMips, const IBLBakeSettings& a_settings,
+		std::vector<CubemapImage>& a_output, bool a_bMultithreaded, bool a_bUseSIMD);
+}
@@ -0,0 +1,280 @@
+#include "IBLCache.h"
+#include "Hashing.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#define IBL_CACHE_MAGIC "IBLCACHE"
+#define IBL_CACHE_MAGIC_SIZE 8
+#define IBL_CACHE_MAX_TEXTURES 8 // Sanity limits so a corrupt file can't request gigabytes
+#define IBL_CACHE_MAX_DIMENSION 16384
+
+// DXGI_FORMAT values, so this file doesn't need dxgiformat.h
+#define IBL_CACHE_DXGI_R32G32B32A32_FLOAT 2u
+#define IBL_CACHE_DXGI_R16G16B16A16_FLOAT 10u
+#define IBL_CACHE_DXGI_R8G8B8A8_UNORM 28u
+#define IBL_CACHE_DXGI_R8G8B8A8_UNORM_SRGB 29u
+#define IBL_CACHE_DXGI_R32G32_FLOAT 16u
+#define IBL_CACHE_DXGI_R16G16_UNORM 35u
+#define IBL_CACHE_DXGI_R16G16_FLOAT 34u
+#define IBL_CACHE_DXGI_R32_FLOAT 41u
+#define IBL_CACHE_DXGI_R8G8_UNORM 49u
+#define IBL_CACHE_DXGI_B8G8R8A8_UNORM 87u
+#define IBL_CACHE_DXGI_B8G8R8A8_UNORM_SRGB 91u
+
+namespace
+{
+	//-------------------------------------------------------
+	// Appends fixed size values to a byte buffer. Written
+	// field by field so struct padding never reaches disk
+	//-------------------------------------------------------
+	class Writer
+	{
+	public:
+		template<typename T>
+		void Write(const T& a_value)
+		{
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&a_value);
+			m_bytes.insert(m_bytes.end(), bytes, bytes + sizeof(T));
+		}
+
+		void WriteBytes(const void* a_data, size_t a_size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(a_data);
+			m_bytes.insert(m_bytes.end(), bytes, bytes + a_size);
+		}
+
+		std::vector<unsigned char>& GetBytes() { return m_bytes; }
+
+	private:
+		std::vector<unsigned char> m_bytes;
+	};
+
+	//-------------------------------------------------------
+	// Bounds checked reads from a loaded file. Any read
+	// past the end fails and every later read fails too
+	//-------------------------------------------------------
+	class Reader
+	{
+	public:
+		Reader(const std::vector<unsigned char>& a_bytes, size_t a_size) : m_bytes(a_bytes), m_size(a_size) {}
+
+		template<typename T>
+		bool Read(T& a_value)
+		{
+			return ReadBytes(&a_value, sizeof(T));
+		}
+
+		bool ReadBytes(void* a_data, size_t a_size)
+		{
+			if (!m_bOk || a_size > m_size - m_offset) {
+				m_bOk = false;
+				return false;
+			}
+			memcpy(a_data, m_bytes.data() + m_offset, a_size);
+			m_offset += a_size;
+			return true;
+		}
+
+		bool IsAtEnd() const { return m_bOk && m_offset == m_size; }
+
+	private:
+		const std::vector<unsigned char>& m_bytes;
+		size_t m_size;
+		size_t m_offset = 0;
+		bool m_bOk = true;
+	};
+}
+
+//-------------------------------------------------------
+// Bytes per texel of the formats the IBL passes produce
+//	- Block compressed and planar formats aren't cached
+//-------------------------------------------------------
+uint32_t IBLCache::GetBytesPerTexel(uint32_t a_format)
+{
+	switch (a_format) {
+	case IBL_CACHE_DXGI_R32G32B32A32_FLOAT:
+		return 16;
+	case IBL_CACHE_DXGI_R16G16B16A16_FLOAT:
+	case IBL_CACHE_DXGI_R32G32_FLOAT:
+		return 8;
+	case IBL_CACHE_DXGI_R8G8B8A8_UNORM:
+	case IBL_CACHE_DXGI_R8G8B8A8_UNORM_SRGB:
+	case IBL_CACHE_DXGI_B8G8R8A8_UNORM:
+	case IBL_CACHE_DXGI_B8G8R8A8_UNORM_SRGB:
+	case IBL_CACHE_DXGI_R16G16_UNORM:
+	case IBL_CACHE_DXGI_R16G16_FLOAT:
+	case IBL_CACHE_DXGI_R32_FLOAT:
+		return 4;
+	case IBL_CACHE_DXGI_R8G8_UNORM:
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+//-------------------------------------------------------
+// Total size of every subresource, rows tightly packed
+//-------------------------------------------------------
+size_t IBLCache::GetExpectedDataSize(const IBLCacheTexture& a_texture)
+{
+	uint32_t bytesPerTexel = GetBytesPerTexel(a_texture.Format);
+	if (bytesPerTexel == 0)
+		return 0;
+
+	size_t sliceSize = 0;
+	for (uint32_t mip = 0; mip < a_texture.MipLevels; mip++) {
+		size_t width = a_texture.Width >> mip;
+		size_t height = a_texture.Height >> mip;
+		sliceSize += (width > 0 ? width : 1) * (height > 0 ? height : 1) * bytesPerTexel;
+	}
+	return sliceSize * a_texture.ArraySize;
+}
+
+//-------------------------------------------------------
+// File name of a product in the cache directory
+//-------------------------------------------------------
+std::string IBLCache::GetFileName(const std::string& a_directory, const std::string& a_product, uint64_t a_key)
+{
+	char keyText[17];
+	snprintf(keyText, sizeof(keyText), "%016llx", (unsigned long long)a_key);
+	std::filesystem::path path = std::filesystem::path(a_directory) / (a_product + "_" + keyText + IBL_CACHE_EXTENSION);
+	return path.string();
+}
+
+//-------------------------------------------------------
+// Reads and validates a cache file
+//	- a_entry is only written when everything checks out
+//-------------------------------------------------------
+bool IBLCache::Load(const std::string& a_fileName, uint64_t a_expectedKey, IBLCacheEntry& a_entry)
+{
+	std::ifstream file(a_fileName, std::ios::binary);
+	if (!file.is_open())
+		return false;
+	std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (bytes.size() < IBL_CACHE_MAGIC_SIZE + sizeof(uint64_t))
+		return false;
+
+	// Trailing checksum covers everything before it
+	size_t contentSize = bytes.size() - sizeof(uint64_t);
+	uint64_t storedChecksum = 0;
+	memcpy(&storedChecksum, bytes.data() + contentSize, sizeof(uint64_t));
+	if (storedChecksum != Hashing::Bytes(bytes.data(), contentSize))
+		return false;
+
+	Reader reader(bytes, contentSize);
+	char magic[IBL_CACHE_MAGIC_SIZE];
+	uint32_t version = 0, textureCount = 0, bHasIrradianceSH = 0;
+	uint64_t key = 0;
+	reader.ReadBytes(magic, sizeof(magic));
+	reader.Read(version);
+	reader.Read(key);
+	reader.Read(bHasIrradianceSH);
+	reader.Read(textureCount);
+	if (memcmp(magic, IBL_CACHE_MAGIC, IBL_CACHE_MAGIC_SIZE) != 0 || version != IBL_CACHE_VERSION || key != a_expectedKey)
+		return false;
+	if (textureCount > IBL_CACHE_MAX_TEXTURES)
+		return false;
+
+	IBLCacheEntry entry;
+	entry.Key = key;
+	entry.bHasIrradianceSH = bHasIrradianceSH != 0;
+	if (!reader.ReadBytes(entry.IrradianceSH.Coefficients, sizeof(entry.IrradianceSH.Coefficients)))
+		return false;
+
+	entry.Textures.resize(textureCount);
+	for (IBLCacheTexture& texture : entry.Textures) {
+		uint32_t bIsCube = 0;
+		uint64_t dataSize = 0;
+		reader.Read(texture.Format);
+		reader.Read(texture.Width);
+		reader.Read(texture.Height);
+		reader.Read(texture.MipLevels);
+		reader.Read(texture.ArraySize);
+		reader.Read(bIsCube);
+		if (!reader.Read(dataSize))
+			return false;
+		texture.bIsCube = bIsCube != 0;
+
+		if (texture.Width == 0 || texture.Width > IBL_CACHE_MAX_DIMENSION || texture.Height == 0 || texture.Height > IBL_CACHE_MAX_DIMENSION)
+			return false;
+		if (texture.MipLevels == 0 || texture.MipLevels > 32 || texture.ArraySize == 0 || (texture.bIsCube && texture.ArraySize % 6 != 0))
+			return false;
+		size_t expectedSize = GetExpectedDataSize(texture);
+		if (expectedSize == 0 || dataSize != expectedSize)
+			return false;
+
+		texture.Data.resize(expectedSize);
+		if (!reader.ReadBytes(texture.Data.data(), expectedSize))
+			return false;
+	}
+	if (!reader.IsAtEnd())
+		return false;
+
+	a_entry = std::move(entry);
+	return true;
+}
+
+//-------------------------------------------------------
+// Writes a cache file next to its final name, then
+// renames it into place
+//-------------------------------------------------------
+bool IBLCache::Save(const std::string& a_fileName, const IBLCacheEntry& a_entry)
+{
+	if (a_entry.Textures.size() > IBL_CACHE_MAX_TEXTURES)
+		return false;
+
+	Writer writer;
+	writer.WriteBytes(IBL_CACHE_MAGIC, IBL_CACHE_MAGIC_SIZE);
+	writer.Write((uint32_t)IBL_CACHE_VERSION);
+	writer.Write(a_entry.Key);
+	writer.Write((uint32_t)(a_entry.bHasIrradianceSH ? 1 : 0));
+	writer.Write((uint32_t)a_entry.Textures.size());
+	writer.WriteBytes(a_entry.IrradianceSH.Coefficients, sizeof(a_entry.IrradianceSH.Coefficients));
+	for (const IBLCacheTexture& texture : a_entry.Textures) {
+		if (texture.Data.size() != GetExpectedDataSize(texture) || texture.Data.empty())
+			return false;
+
+		writer.Write(texture.Format);
+		writer.Write(texture.Width);
+		writer.Write(texture.Height);
+		writer.Write(texture.MipLevels);
+		writer.Write(texture.ArraySize);
+		writer.Write((uint32_t)(texture.bIsCube ? 1 : 0));
+		writer.Write((uint64_t)texture.Data.size());
+		writer.WriteBytes(texture.Data.data(), texture.Data.size());
+	}
+	std::vector<unsigned char>& bytes = writer.GetBytes();
+	writer.Write(Hashing::Bytes(bytes.data(), bytes.size()));
+
+	std::error_code error;
+	std::filesystem::path path(a_fileName);
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path(), error);
+
+	// Unique per writer, so concurrent saves of the same key don't collide before the rename
+	std::filesystem::path temporaryPath = path;
+	uint64_t unique = Hashing::Value((uint64_t)std::chrono::steady_clock::now().time_since_epoch().count());
+	unique = Hashing::Value((uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id()), unique);
+	temporaryPath += ".tmp" + std::to_string(unique);
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return false;
+		file.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+		if (!file)
+			return false;
+	}
+
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error) {
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
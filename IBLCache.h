@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SphericalHarmonics.h"
+
+#define IBL_CACHE_VERSION 1 // Bump whenever generation changes in a way the keys can't see
+#define IBL_CACHE_EXTENSION ".iblcache"
+
+//-------------------------------------------------------
+// Raw contents of one texture, as the GPU produced it
+//	- Format is the DXGI_FORMAT value, kept as an int so
+//	  this file builds without D3D headers
+//	- Data holds every subresource in D3D11CalcSubresource
+//	  order (mips of slice 0, then slice 1, ...) with
+//	  tightly packed rows
+//-------------------------------------------------------
+struct IBLCacheTexture {
+	uint32_t Format = 0;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t MipLevels = 0;
+	uint32_t ArraySize = 0;
+	bool bIsCube = false;
+	std::vector<unsigned char> Data;
+};
+
+//-------------------------------------------------------
+// Everything one cache file stores
+//	- Key is the content hash the products were made
+//	  from, and must match on load
+//-------------------------------------------------------
+struct IBLCacheEntry {
+	uint64_t Key = 0;
+	bool bHasIrradianceSH = false;
+	SH9Color IrradianceSH;
+	std::vector<IBLCacheTexture> Textures;
+};
+
+//-------------------------------------------------------
+// Content-addressed on-disk cache for IBL products (SH
+// irradiance, prefiltered specular cube, BRDF LUT)
+//	- Files are named after their key, so a changed sky,
+//	  shader or parameter simply misses and regenerates
+//	- Load checks magic, version, key, texture sizes and a
+//	  checksum over the whole file, and fails on anything
+//	  unexpected so callers fall back to generating
+//	- Save writes a temporary file and renames it over the
+//	  target, so workers sharing a cache directory never
+//	  see a half-written file
+//-------------------------------------------------------
+namespace IBLCache
+{
+	// Bytes per texel of the formats the IBL passes produce, 0 for anything else
+	uint32_t GetBytesPerTexel(uint32_t a_format);
+
+	// Size Data must have for the texture's dimensions and format, 0 if the format is unsupported
+	size_t GetExpectedDataSize(const IBLCacheTexture& a_texture);
+
+	// a_directory/a_product_<key in hex>.iblcache
+	std::string GetFileName(const std::string& a_directory, const std::string& a_product, uint64_t a_key);
+
+	bool Load(const std::string& a_fileName, uint64_t a_expectedKey, IBLCacheEntry& a_entry);
+
+	// Creates the directory if needed
+	bool Save(const std::string& a_fileName, const IBLCacheEntry& a_entry);
+}
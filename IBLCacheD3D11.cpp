@@ -0,0 +1,145 @@
+#include "IBLCacheD3D11.h"
+
+#include <cstring>
+
+//-------------------------------------------------------
+// Copies a texture to a staging resource and packs its
+// rows into a_texture.Data
+//	- Stalls until the GPU has finished the copy, which is
+//	  fine for the one-off IBL products this is used for
+//-------------------------------------------------------
+bool IBLCacheD3D11::ReadBackTexture(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context,
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> a_source, IBLCacheTexture& a_texture, UINT a_mipLevels)
+{
+	D3D11_TEXTURE2D_DESC desc = {};
+	a_source->GetDesc(&desc);
+	UINT bytesPerTexel = IBLCache::GetBytesPerTexel((uint32_t)desc.Format);
+	if (bytesPerTexel == 0 || desc.SampleDesc.Count != 1)
+		return false;
+
+	UINT sourceMips = desc.MipLevels;
+	UINT mipLevels = (a_mipLevels == 0 || a_mipLevels > sourceMips) ? sourceMips : a_mipLevels;
+
+	// Staging copy of the requested mips of each slice
+	desc.MipLevels = mipLevels;
+	desc.BindFlags = 0;
+	desc.MiscFlags = 0;
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> staging;
+	if (FAILED(a_device->CreateTexture2D(&desc, nullptr, staging.GetAddressOf())))
+		return false;
+	for (UINT slice = 0; slice < desc.ArraySize; slice++) {
+		for (UINT mip = 0; mip < mipLevels; mip++) {
+			a_context->CopySubresourceRegion(staging.Get(), D3D11CalcSubresource(mip, slice, mipLevels), 0, 0, 0,
+				a_source.Get(), D3D11CalcSubresource(mip, slice, sourceMips), nullptr);
+		}
+	}
+
+	D3D11_TEXTURE2D_DESC sourceDesc = {};
+	a_source->GetDesc(&sourceDesc);
+	IBLCacheTexture texture;
+	texture.Format = (uint32_t)desc.Format;
+	texture.Width = desc.Width;
+	texture.Height = desc.Height;
+	texture.MipLevels = mipLevels;
+	texture.ArraySize = desc.ArraySize;
+	texture.bIsCube = (sourceDesc.MiscFlags & D3D11_RESOURCE_MISC_TEXTURECUBE) != 0;
+	texture.Data.resize(IBLCache::GetExpectedDataSize(texture));
+
+	unsigned char* destination = texture.Data.data();
+	for (UINT slice = 0; slice < desc.ArraySize; slice++) {
+		for (UINT mip = 0; mip < mipLevels; mip++) {
+			UINT subresource = D3D11CalcSubresource(mip, slice, mipLevels);
+			D3D11_MAPPED_SUBRESOURCE mapped = {};
+			if (FAILED(a_context->Map(staging.Get(), subresource, D3D11_MAP_READ, 0, &mapped)))
+				return false;
+
+			UINT width = max(desc.Width >> mip, 1u);
+			UINT height = max(desc.Height >> mip, 1u);
+			size_t rowSize = (size_t)width * bytesPerTexel;
+			for (UINT y = 0; y < height; y++) {
+				memcpy(destination, static_cast<const unsigned char*>(mapped.pData) + (size_t)y * mapped.RowPitch, rowSize);
+				destination += rowSize;
+			}
+			a_context->Unmap(staging.Get(), subresource);
+		}
+	}
+
+	a_texture = std::move(texture);
+	return true;
+}
+
+//-------------------------------------------------------
+// Reads back the texture an SRV views
+//-------------------------------------------------------
+bool IBLCacheD3D11::ReadBackTexture(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context,
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_source, IBLCacheTexture& a_texture, UINT a_mipLevels)
+{
+	if (!a_source)
+		return false;
+
+	Microsoft::WRL::ComPtr<ID3D11Resource> resource;
+	a_source->GetResource(resource.GetAddressOf());
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+	if (FAILED(resource.As(&texture)))
+		return false;
+	return ReadBackTexture(a_device, a_context, texture, a_texture, a_mipLevels);
+}
+
+//-------------------------------------------------------
+// Uploads cached contents as an immutable texture
+//-------------------------------------------------------
+bool IBLCacheD3D11::CreateShaderResourceView(Microsoft::WRL::ComPtr<ID3D11Device> a_device, const IBLCacheTexture& a_texture,
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& a_srv)
+{
+	UINT bytesPerTexel = IBLCache::GetBytesPerTexel(a_texture.Format);
+	if (bytesPerTexel == 0 || a_texture.Data.size() != IBLCache::GetExpectedDataSize(a_texture))
+		return false;
+
+	D3D11_TEXTURE2D_DESC desc = {};
+	desc.Width = a_texture.Width;
+	desc.Height = a_texture.Height;
+	desc.MipLevels = a_texture.MipLevels;
+	desc.ArraySize = a_texture.ArraySize;
+	desc.Format = (DXGI_FORMAT)a_texture.Format;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_IMMUTABLE;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	desc.MiscFlags = a_texture.bIsCube ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+
+	// Point each subresource at its slice of the packed data
+	std::vector<D3D11_SUBRESOURCE_DATA> initialData((size_t)a_texture.MipLevels * a_texture.ArraySize);
+	const unsigned char* source = a_texture.Data.data();
+	for (UINT slice = 0; slice < a_texture.ArraySize; slice++) {
+		for (UINT mip = 0; mip < a_texture.MipLevels; mip++) {
+			UINT width = max(a_texture.Width >> mip, 1u);
+			UINT height = max(a_texture.Height >> mip, 1u);
+			D3D11_SUBRESOURCE_DATA& data = initialData[D3D11CalcSubresource(mip, slice, a_texture.MipLevels)];
+			data.pSysMem = source;
+			data.SysMemPitch = width * bytesPerTexel;
+			source += (size_t)data.SysMemPitch * height;
+		}
+	}
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+	if (FAILED(a_device->CreateTexture2D(&desc, initialData.data(), texture.GetAddressOf())))
+		return false;
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = desc.Format;
+	if (a_texture.bIsCube && a_texture.ArraySize == 6) {
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+		srvDesc.TextureCube.MipLevels = desc.MipLevels;
+	}
+	else if (a_texture.ArraySize > 1) {
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		srvDesc.Texture2DArray.MipLevels = desc.MipLevels;
+		srvDesc.Texture2DArray.ArraySize = desc.ArraySize;
+	}
+	else {
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels = desc.MipLevels;
+	}
+	return SUCCEEDED(a_device->CreateShaderResourceView(texture.Get(), &srvDesc, a_srv.ReleaseAndGetAddressOf()));
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h> // Used for ComPtr - a smart pointer for COM objects
+
+#include "IBLCache.h"
+
+//-------------------------------------------------------
+// Moves IBLCacheTextures between the GPU and the CPU
+//	- Kept apart from IBLCache so the container itself
+//	  stays portable (and usable by the headless tool)
+//-------------------------------------------------------
+namespace IBLCacheD3D11
+{
+	// Copies a_mipLevels mips (0 for all) of every array slice into a_texture. Fails for formats IBLCache can't store
+	bool ReadBackTexture(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context,
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> a_source, IBLCacheTexture& a_texture, UINT a_mipLevels = 0);
+
+	// Same as above, for the texture behind an SRV
+	bool ReadBackTexture(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context,
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_source, IBLCacheTexture& a_texture, UINT a_mipLevels = 0);
+
+	// Immutable texture and SRV (TextureCube when bIsCube) holding the cached contents
+	bool CreateShaderResourceView(Microsoft::WRL::ComPtr<ID3D11Device> a_device, const IBLCacheTexture& a_texture,
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& a_srv);
+}
@@ -0,0 +1,151 @@
+#include "JobSystem.h"
+
+// Singleton requirement
+JobSystem* JobSystem::instance;
+
+//-----------------------------------------------
+// Spin up one worker per spare hardware thread
+//-----------------------------------------------
+JobSystem::JobSystem()
+	: m_backgroundRunning(0)
+	, m_bShuttingDown(false)
+{
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	unsigned int workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	m_maxBackgroundRunning = workerCount > 1 ? workerCount - 1 : 1;
+	for (unsigned int i = 0; i < workerCount; i++) {
+		m_workers.emplace_back(&JobSystem::WorkerLoop, this);
+	}
+}
+
+//-----------------------------------------------
+// Let workers drain out and join them
+//-----------------------------------------------
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_bShuttingDown = true;
+	}
+	m_queueSignal.notify_all();
+	for (std::thread& worker : m_workers) {
+		worker.join();
+	}
+}
+
+//-----------------------------------------------
+// Push a job and wake a worker for it
+//-----------------------------------------------
+void JobSystem::Execute(std::function<void()> a_job, JobGroup& a_group, JobPriority a_priority)
+{
+	a_group.Remaining.fetch_add(1);
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		std::deque<QueuedJob>& queue = a_priority == JobPriority::Background ? m_backgroundQueue : m_queue;
+		queue.push_back({ std::move(a_job), &a_group });
+	}
+	m_queueSignal.notify_one();
+}
+
+//-----------------------------------------------
+// Help out until the group is finished
+//	- Only the group's own jobs are run. Anything
+//	  else could take far longer than the wait,
+//	  and the group's jobs never need it to finish
+//-----------------------------------------------
+void JobSystem::Wait(JobGroup& a_group)
+{
+	while (a_group.Remaining.load() > 0) {
+		if (!TryRunGroupJob(a_group))
+			std::this_thread::yield();
+	}
+}
+
+//-----------------------------------------------
+// Chunk a range across the pool
+//-----------------------------------------------
+void JobSystem::ParallelFor(unsigned int a_count, unsigned int a_grainSize, const std::function<void(unsigned int, unsigned int)>& a_job)
+{
+	if (a_count == 0)
+		return;
+	if (a_grainSize == 0)
+		a_grainSize = 1;
+
+	if (a_count <= a_grainSize) {
+		a_job(0, a_count);
+		return;
+	}
+
+	JobGroup group;
+	for (unsigned int begin = 0; begin < a_count; begin += a_grainSize) {
+		unsigned int end = (a_count - begin > a_grainSize) ? begin + a_grainSize : a_count;
+		Execute([&a_job, begin, end]() { a_job(begin, end); }, group);
+	}
+	Wait(group);
+}
+
+//-----------------------------------------------
+// Worker threads sleep until there is a job,
+// taking normal jobs before background ones
+//-----------------------------------------------
+void JobSystem::WorkerLoop()
+{
+	while (true) {
+		QueuedJob job;
+		bool bBackground = false;
+		{
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			m_queueSignal.wait(lock, [this]() { return m_bShuttingDown || !m_queue.empty() || CanRunBackgroundJob(); });
+			if (!m_queue.empty()) {
+				job = std::move(m_queue.front());
+				m_queue.pop_front();
+			}
+			else if (CanRunBackgroundJob()) {
+				job = std::move(m_backgroundQueue.front());
+				m_backgroundQueue.pop_front();
+				m_backgroundRunning++;
+				bBackground = true;
+			}
+			else
+				return; // Only reached when shutting down
+		}
+
+		job.Job();
+		job.Group->Remaining.fetch_sub(1);
+		if (bBackground) {
+			{
+				std::lock_guard<std::mutex> lock(m_queueMutex);
+				m_backgroundRunning--;
+			}
+			m_queueSignal.notify_one(); // A worker may be sleeping on the background limit
+		}
+	}
+}
+
+//-----------------------------------------------
+// Pop and run a single queued job of a_group, if
+// there is one
+//-----------------------------------------------
+bool JobSystem::TryRunGroupJob(JobGroup& a_group)
+{
+	QueuedJob job;
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		auto takeFrom = [&](std::deque<QueuedJob>& a_queue) {
+			for (auto it = a_queue.begin(); it != a_queue.end(); ++it) {
+				if (it->Group == &a_group) {
+					job = std::move(*it);
+					a_queue.erase(it);
+					return true;
+				}
+			}
+			return false;
+		};
+		if (!takeFrom(m_queue) && !takeFrom(m_backgroundQueue))
+			return false;
+	}
+
+	job.Job();
+	job.Group->Remaining.fetch_sub(1);
+	return true;
+}
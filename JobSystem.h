@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-------------------------------------------------------
+// Tracks a set of submitted jobs so a caller can wait on
+// just the work it cares about
+//-------------------------------------------------------
+struct JobGroup {
+	std::atomic<unsigned int> Remaining{ 0 };
+};
+
+// Background jobs (asset loads and the like) only run when no normal job is queued
+enum class JobPriority {
+	Normal,
+	Background
+};
+
+//-------------------------------------------------------
+// Small shared thread pool for CPU-heavy work (reference
+// implementations, baking, asset processing)
+//	- One worker per hardware thread, minus one for the
+//	  calling thread, which helps execute its jobs while it waits
+//	- Waiting threads run queued jobs of the group they wait
+//	  on instead of blocking, so jobs may safely submit and
+//	  wait on nested work, and a frame's ParallelFor never
+//	  ends up running someone else's long job
+//	- Background jobs wait for the normal queue to empty and
+//	  never take every worker, so per-frame work isn't stuck
+//	  behind a backlog of texture loads
+//	- Portable (std::thread only), so it works in headless builds
+//-------------------------------------------------------
+class JobSystem
+{
+#pragma region Singleton
+public:
+	// Gets the one and only instance of this class
+	static JobSystem& GetInstance()
+	{
+		if (!instance)
+		{
+			instance = new JobSystem();
+		}
+
+		return *instance;
+	}
+
+	// Remove these functions (C++ 11 version)
+	JobSystem(JobSystem const&) = delete;
+	void operator=(JobSystem const&) = delete;
+
+private:
+	static JobSystem* instance;
+	JobSystem();
+#pragma endregion
+
+public:
+	~JobSystem();
+
+	// Number of threads that execute jobs, including a waiting caller
+	unsigned int GetThreadCount() const { return (unsigned int)m_workers.size() + 1; }
+
+	// Queue a job as part of a_group
+	void Execute(std::function<void()> a_job, JobGroup& a_group, JobPriority a_priority = JobPriority::Normal);
+
+	// Block until every job in a_group has finished, running its queued jobs meanwhile
+	void Wait(JobGroup& a_group);
+
+	// Split [0, a_count) into ranges of at most a_grainSize and run a_job(begin, end) on each
+	//	- Returns once all ranges are done
+	//	- Small counts (a single range) run inline without touching the queue
+	void ParallelFor(unsigned int a_count, unsigned int a_grainSize, const std::function<void(unsigned int, unsigned int)>& a_job);
+
+private:
+	struct QueuedJob {
+		std::function<void()> Job;
+		JobGroup* Group;
+	};
+
+	void WorkerLoop();
+	bool TryRunGroupJob(JobGroup& a_group);
+	bool CanRunBackgroundJob() const { return !m_backgroundQueue.empty() && m_backgroundRunning < m_maxBackgroundRunning; }
+
+	std::vector<std::thread> m_workers;
+	std::deque<QueuedJob> m_queue;
+	std::deque<QueuedJob> m_backgroundQueue;
+	unsigned int m_backgroundRunning; // By workers. Guarded by m_queueMutex
+	unsigned int m_maxBackgroundRunning; // One short of the workers (when there are two or more), so one is always free for normal jobs
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueSignal;
+	bool m_bShuttingDown;
+};
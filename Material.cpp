@@ -18,6 +18,8 @@ Material::Material(std::shared_ptr<SimpleVertexShader> a_vertexShader, std::shar
 	, m_roughness(a_roughness)
 	, m_uvOffset(0.f, 0.f)
 	, m_uvScale(1.f)
+	, m_ormConstants(1.f, 1.f, 0.f)
+	, m_ormTextured(0.f, 0.f, 0.f)
 {
 	// Bound roughness
 	if (m_roughness > 1.f) m_roughness = 1.f;
@@ -42,10 +44,10 @@ Material::~Material()
 // ----------------------------------------------------------
 void Material::PrepareMaterial()
 {
-	// Set all stored texture Resource Views
+	// Set all stored texture Resource Views. Empty ones are never sampled, so aren't worth binding
 	for (auto& t : m_textureSRVs) {
 		const char* name = t.first.c_str();
-		if (m_pixelShader->HasShaderResourceView(name)) {
+		if (t.second && m_pixelShader->HasShaderResourceView(name)) {
 			m_pixelShader->SetShaderResourceView(name, t.second);
 		}
 	}
@@ -69,6 +71,10 @@ void Material::PrepareMaterial()
 		m_pixelShader->SetFloat4("c_color", m_colorTint);
 	if (m_pixelShader->HasVariable("c_roughnessScale"))
 		m_pixelShader->SetFloat("c_roughnessScale", m_roughness);
+	if (m_pixelShader->HasVariable("c_ormConstants"))
+		m_pixelShader->SetFloat3("c_ormConstants", m_ormConstants);
+	if (m_pixelShader->HasVariable("c_ormTextured"))
+		m_pixelShader->SetFloat3("c_ormTextured", m_ormTextured);
 }
 
 // ----------------------------------------------------------
@@ -107,6 +113,16 @@ void Material::SetUVScale(float a_scale)
 	m_uvScale = a_scale;
 }
 
+// ----------------------------------------------------------
+// Sets the occlusion, roughness and metalness constants, and
+// which of them ORMTexture overrides
+// ----------------------------------------------------------
+void Material::SetORMChannels(Vector3 a_constants, Vector3 a_textured)
+{
+	m_ormConstants = a_constants;
+	m_ormTextured = a_textured;
+}
+
 // ----------------------------------------------------------
 // Sets the Vertex Shader used by this Material
 // ----------------------------------------------------------
@@ -155,6 +171,22 @@ float Material::GetUVScale()
 	return m_uvScale;
 }
 
+// ----------------------------------------------------------
+// Gets the occlusion, roughness and metalness constants
+// ----------------------------------------------------------
+Vector3 Material::GetORMConstants()
+{
+	return m_ormConstants;
+}
+
+// ----------------------------------------------------------
+// Gets which of the ORM channels come from ORMTexture
+// ----------------------------------------------------------
+Vector3 Material::GetORMTextured()
+{
+	return m_ormTextured;
+}
+
 // ----------------------------------------------------------
 // Get a reference the Vertex Shader used by this Material
 // ----------------------------------------------------------
@@ -179,6 +211,15 @@ void Material::AddTextureSRV(std::string a_name, Microsoft::WRL::ComPtr<ID3D11Sh
 	m_textureSRVs.insert({ a_name, a_srv });
 }
 
+// ----------------------------------------------------------
+// Add a Texture Resource View to the Material, replacing
+// any already stored under the same name
+// ----------------------------------------------------------
+void Material::SetTextureSRV(std::string a_name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_srv)
+{
+	m_textureSRVs[a_name] = a_srv;
+}
+
 // ----------------------------------------------------------
 // Add a texture Sampler State to the Material
 // ----------------------------------------------------------
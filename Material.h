@@ -24,6 +24,7 @@ public:
 	void SetRoughness(float a_roughness);
 	void SetUVOffset(Vector2 a_offset);
 	void SetUVScale(float a_scale);
+	void SetORMChannels(Vector3 a_constants, Vector3 a_textured); // a_textured is 1 for channels ORMTexture holds, else 0
 	void SetVertexShader(std::shared_ptr<SimpleVertexShader> a_vertexShader);
 	void SetPixelShader(std::shared_ptr<SimplePixelShader> a_pixelShader);
 
@@ -32,11 +33,14 @@ public:
 	float GetRoughness();
 	Vector2 GetUVOffset();
 	float GetUVScale();
+	Vector3 GetORMConstants();
+	Vector3 GetORMTextured();
 	std::shared_ptr<SimpleVertexShader> GetVertexShader();
 	std::shared_ptr<SimplePixelShader> GetPixelShader();
 
 	// Textures
 	void AddTextureSRV(std::string a_name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_srv);
+	void SetTextureSRV(std::string a_name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_srv); // Adds or replaces
 	void AddSampler(std::string a_name, Microsoft::WRL::ComPtr<ID3D11SamplerState> a_sampler);
 
 protected:
@@ -46,6 +50,10 @@ protected:
 	Vector2 m_uvOffset;
 	float m_uvScale;
 
+	// Occlusion, roughness and metalness, for the channels not sampled from ORMTexture
+	Vector3 m_ormConstants;
+	Vector3 m_ormTextured;
+
 	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> m_textureSRVs;
 	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11SamplerState>> m_samplers;
 
@@ -1,40 +1,49 @@
 #include "Mesh.h"
+#include "Culling.h"
+#include "AssetFiles.h"
 
 #include <DirectXMath.h>
 #include <fstream>
+#include <filesystem>
 
-template<class T>
-using ComPtr = Microsoft::WRL::ComPtr<T>;
+// The .obj loader only reads numbers, which need no extra buffer size
+// arguments, so the plain version is equivalent off of MSVC
+#ifndef _MSC_VER
+#define sscanf_s sscanf
+#endif
 
 //-----------------------------------------------
 // Construct a Mesh from raw array information
 //-----------------------------------------------
-Mesh::Mesh(Vertex* a_vertices, UINT a_vertexCount, UINT* a_indices, UINT a_indexCount, ComPtr<ID3D11Device> a_device, ComPtr<ID3D11DeviceContext> a_context)
-	: m_vertexBuffer(nullptr)
-	, m_indexBuffer(nullptr)
-	, m_deviceContext(a_context)
+Mesh::Mesh(Vertex* a_vertices, unsigned int a_vertexCount, unsigned int* a_indices, unsigned int a_indexCount, std::shared_ptr<RenderDevice> a_device,
+	bool a_bBuildMeshlets)
+	: m_vertexBuffer(INVALID_RENDER_HANDLE)
+	, m_indexBuffer(INVALID_RENDER_HANDLE)
+	, m_device(a_device)
 	, m_indexCount(a_indexCount)
+	, m_bBuildMeshlets(a_bBuildMeshlets)
 {
-	CreateMesh(a_vertices, a_vertexCount, a_indices, a_indexCount, a_device, a_context);
+	CreateMesh(a_vertices, a_vertexCount, a_indices, a_indexCount);
 }
 
 //-----------------------------------------------
 // Construct a Mesh using std::vector Vertex
 // storage instead of raw arrays
 //-----------------------------------------------
-Mesh::Mesh(std::vector<Vertex> a_vertices, std::vector<UINT> a_indices, ComPtr<ID3D11Device> a_device, ComPtr<ID3D11DeviceContext> a_context)
-	: Mesh(&a_vertices[0], (UINT)a_vertices.size(), &a_indices[0], (UINT)a_indices.size(), a_device, a_context)
+Mesh::Mesh(std::vector<Vertex> a_vertices, std::vector<unsigned int> a_indices, std::shared_ptr<RenderDevice> a_device, bool a_bBuildMeshlets)
+	: Mesh(&a_vertices[0], (unsigned int)a_vertices.size(), &a_indices[0], (unsigned int)a_indices.size(), a_device, a_bBuildMeshlets)
 {
 }
 
 //-----------------------------------------------
 // Construct a Mesh from a .obj file
 //-----------------------------------------------
-Mesh::Mesh(const wchar_t* a_fileName, ComPtr<ID3D11Device> a_device, ComPtr<ID3D11DeviceContext> a_context)
-	: m_vertexBuffer(nullptr)
-	, m_indexBuffer(nullptr)
-	, m_deviceContext(a_context)
+Mesh::Mesh(const wchar_t* a_fileName, std::shared_ptr<RenderDevice> a_device, bool a_bBuildMeshlets)
+	: m_vertexBuffer(INVALID_RENDER_HANDLE)
+	, m_indexBuffer(INVALID_RENDER_HANDLE)
+	, m_device(a_device)
 	, m_indexCount(0)
+	, m_bBuildMeshlets(a_bBuildMeshlets)
 {
 	// Author: Chris Cascioli
 	// Purpose: Basic .OBJ 3D model loading, supporting positions, uvs and normals
@@ -47,7 +56,10 @@ Mesh::Mesh(const wchar_t* a_fileName, ComPtr<ID3D11Device> a_device, ComPtr<ID3D
 	
 	
 	// File input object
-	std::ifstream obj(a_fileName);
+	//	- Opened through a path, since only MSVC accepts a wide string directly
+	//	- AssetFiles serves it from the mounted archive when there is one
+	std::filesystem::path filePath(a_fileName);
+	AssetFileStream obj(filePath);
 
 	// Check for successful open
 	if (!obj.is_open())
@@ -58,7 +70,7 @@ Mesh::Mesh(const wchar_t* a_fileName, ComPtr<ID3D11Device> a_device, ComPtr<ID3D
 	std::vector<DirectX::XMFLOAT3> normals;		// Normals from the file
 	std::vector<DirectX::XMFLOAT2> uvs;		// UVs from the file
 	std::vector<Vertex> verts;		// Verts we're assembling
-	std::vector<UINT> indices;		// Indices of these verts
+	std::vector<unsigned int> indices;		// Indices of these verts
 	int vertCounter = 0;			// Count of vertices
 	int indexCounter = 0;			// Count of indices
 	char chars[100];			// String for line reading
@@ -246,7 +258,7 @@ Mesh::Mesh(const wchar_t* a_fileName, ComPtr<ID3D11Device> a_device, ComPtr<ID3D
 
 	/************************* Begin Custom Code *******************************/
 	m_indexCount = indexCounter;
-	CreateMesh(&verts[0], vertCounter, &indices[0], indexCounter, a_device, a_context);
+	CreateMesh(&verts[0], vertCounter, &indices[0], indexCounter);
 }
 
 //-----------------------------------------------
@@ -254,27 +266,35 @@ Mesh::Mesh(const wchar_t* a_fileName, ComPtr<ID3D11Device> a_device, ComPtr<ID3D
 //-----------------------------------------------
 Mesh::~Mesh()
 {
-	// Empty because ComPtr smart pointers take care of Releasing D3D pointers
+	// Buffers belong to the device, so hand them back
+	m_device->ReleaseBuffer(m_vertexBuffer);
+	m_device->ReleaseBuffer(m_indexBuffer);
+	for (size_t i = 1; i < m_lods.size(); i++) {
+		m_device->ReleaseBuffer(m_lods[i].VertexBuffer);
+		m_device->ReleaseBuffer(m_lods[i].IndexBuffer);
+	}
 }
 
 //-----------------------------------------------
 // Set the Mesh's data and draw this Mesh
+//	- a_lod picks which level of detail's buffers
+//	  are bound
 //-----------------------------------------------
-void Mesh::Draw()
+void Mesh::Draw(unsigned int a_lod)
 {
+	const MeshLOD& lod = m_lods[a_lod < m_lods.size() ? a_lod : m_lods.size() - 1];
+
 	// DRAW geometry
 	// - These steps are generally repeated for EACH object you draw
 	// - Other Direct3D calls will also be necessary to do more complex things
-	UINT stride = sizeof(Vertex);
-	UINT offset = 0;
-
 	// Set buffers in the input assembler (IA) stage
 	//  - Do this ONCE PER OBJECT, since each object may have different geometry
-	//  - For this demo, this step *could* simply be done once during Init()
 	//  - However, this needs to be done between EACH DrawIndexed() call
-	//     when drawing different geometry, so it's here as an example
-	m_deviceContext->IASetVertexBuffers(0, 1, m_vertexBuffer.GetAddressOf(), &stride, &offset);
-	m_deviceContext->IASetIndexBuffer(m_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+	//     when drawing different geometry. The device skips the bind if
+	//     this Mesh's buffers are already set (sorted draws of one Mesh)
+	m_device->SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+	m_device->SetVertexBuffer(lod.VertexBuffer, sizeof(Vertex));
+	m_device->SetIndexBuffer(lod.IndexBuffer);
 
 	// Tell Direct3D to draw
 	//  - Begins the rendering pipeline on the GPU
@@ -282,13 +302,28 @@ void Mesh::Draw()
 	//  - This will use all currently set Direct3D resources (shaders, buffers, etc)
 	//  - DrawIndexed() uses the currently set INDEX BUFFER to look up corresponding
 	//     vertices in the currently set VERTEX BUFFER
-	m_deviceContext->DrawIndexed(m_indexCount, 0, 0);
+	m_device->DrawIndexed(lod.IndexCount, 0, 0);
+}
+
+//-----------------------------------------------
+// Draw only some index ranges of LOD 0
+//	- Buffers are bound once, then each range is its
+//	  own DrawIndexed
+//-----------------------------------------------
+void Mesh::DrawRanges(const std::vector<MeshletDrawRange>& a_ranges)
+{
+	m_device->SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+	m_device->SetVertexBuffer(m_vertexBuffer, sizeof(Vertex));
+	m_device->SetIndexBuffer(m_indexBuffer);
+	for (const MeshletDrawRange& range : a_ranges) {
+		m_device->DrawIndexed(range.IndexCount, range.IndexOffset, 0);
+	}
 }
 
 //-----------------------------------------------
 // get this Mesh's vertices
 //-----------------------------------------------
-ComPtr<ID3D11Buffer> Mesh::GetVertexBuffer()
+RenderHandle Mesh::GetVertexBuffer()
 {
 	return m_vertexBuffer;
 }
@@ -296,7 +331,7 @@ ComPtr<ID3D11Buffer> Mesh::GetVertexBuffer()
 //-----------------------------------------------
 // Get this Mesh's indices
 //-----------------------------------------------
-ComPtr<ID3D11Buffer> Mesh::GetIndexBuffer()
+RenderHandle Mesh::GetIndexBuffer()
 {
 	return m_indexBuffer;
 }
@@ -304,11 +339,19 @@ ComPtr<ID3D11Buffer> Mesh::GetIndexBuffer()
 //-----------------------------------------------
 // Get the count of this Mesh's indices
 //-----------------------------------------------
-UINT Mesh::GetIndexCount()
+unsigned int Mesh::GetIndexCount()
 {
 	return m_indexCount;
 }
 
+//-----------------------------------------------
+// Get the local space sphere around every vertex
+//-----------------------------------------------
+Vector4 Mesh::GetBoundingSphere()
+{
+	return m_boundingSphere;
+}
+
 
 // --------------------------------------------------------
 // Calculates the tangents of the vertices in a mesh
@@ -322,14 +365,14 @@ UINT Mesh::GetIndexCount()
 //
 // - Be sure to call this BEFORE creating your D3D vertex/index buffers
 // --------------------------------------------------------
-void Mesh::CalculateTangents(Vertex* a_vertices, UINT a_vertexCount, UINT* a_indices, UINT a_indexCount)
+void Mesh::CalculateTangents(Vertex* a_vertices, unsigned int a_vertexCount, unsigned int* a_indices, unsigned int a_indexCount)
 {
 	// Reset tangents
-	for (UINT i = 0; i < a_vertexCount; i++) {
+	for (unsigned int i = 0; i < a_vertexCount; i++) {
 		a_vertices[i].Tangent = DirectX::XMFLOAT3(0, 0, 0);
 	}
 	// Calculate tangents one whole triangle at a time
-	for (UINT i = 0; i < a_indexCount;) {
+	for (unsigned int i = 0; i < a_indexCount;) {
 		// Grab indices and vertices of first triangle
 		unsigned int i1 = a_indices[i++];
 		unsigned int i2 = a_indices[i++];
@@ -366,7 +409,7 @@ void Mesh::CalculateTangents(Vertex* a_vertices, UINT a_vertexCount, UINT* a_ind
 		v3->Tangent.z += tz;
 	}
 	// Ensure all of the tangents are orthogonal to the normals
-	for (UINT i = 0; i < a_vertexCount; i++) {
+	for (unsigned int i = 0; i < a_vertexCount; i++) {
 		// Grab the two vectors
 		DirectX::XMVECTOR normal = DirectX::XMLoadFloat3(&a_vertices[i].Normal);
 		DirectX::XMVECTOR tangent = DirectX::XMLoadFloat3(&a_vertices[i].Tangent);
@@ -384,60 +427,76 @@ void Mesh::CalculateTangents(Vertex* a_vertices, UINT a_vertexCount, UINT* a_ind
 // Mesh using data output from that construction
 // method
 //	- Members must already be assigned
-//	- Buffer arrays are ideally nullptr before
+//	- Buffer handles are ideally invalid before
 //	  calling
 //-----------------------------------------------
-void Mesh::CreateMesh(Vertex* a_vertices, UINT a_vertexCount, UINT* a_indices, UINT a_indexCount, ComPtr<ID3D11Device> a_device, ComPtr<ID3D11DeviceContext> a_context)
+void Mesh::CreateMesh(Vertex* a_vertices, unsigned int a_vertexCount, unsigned int* a_indices, unsigned int a_indexCount)
 {
-	// Calculate Tangents before creating the D3D objects
+	// Meshlets need shared vertices, so weld first, then reorder the triangles meshlet by meshlet. Everything
+	// below (tangents, bounds, LODs, buffers) then works from the welded copy
+	std::vector<Vertex> weldedVertices;
+	std::vector<unsigned int> weldedIndices;
+	std::vector<unsigned int> meshletIndices;
+	m_meshlets.clear();
+	if (m_bBuildMeshlets && a_indexCount / 3 >= MESHLET_MIN_TRIANGLES) {
+		Meshlets::WeldVertices(a_vertices, a_vertexCount, a_indices, a_indexCount, weldedVertices, weldedIndices);
+		Meshlets::Build(&weldedVertices[0].Position, (unsigned int)weldedVertices.size(), sizeof(Vertex),
+			&weldedIndices[0], (unsigned int)weldedIndices.size(), m_meshlets, meshletIndices);
+		a_vertices = &weldedVertices[0];
+		a_vertexCount = (unsigned int)weldedVertices.size();
+		a_indices = &meshletIndices[0];
+		a_indexCount = (unsigned int)meshletIndices.size();
+		m_indexCount = a_indexCount;
+	}
+
+	// Calculate Tangents before creating the GPU objects
 	CalculateTangents(a_vertices, a_vertexCount, a_indices, a_indexCount);
 
+	// Bounds for culling, computed once here rather than per frame
+	m_boundingSphere = Culling::ComputeBoundingSphere(&a_vertices[0].Position, a_vertexCount, sizeof(Vertex));
+
+	// Keep positions and indices for CPU work after the GPU copies are made
+	m_positions.resize(a_vertexCount);
+	for (unsigned int i = 0; i < a_vertexCount; i++) {
+		m_positions[i] = a_vertices[i].Position;
+	}
+	m_indices.assign(a_indices, a_indices + a_indexCount);
+
 	// Create a VERTEX BUFFER
 	// - This holds the vertex data of triangles for a single object
 	// - This buffer is created on the GPU, which is where the data needs to
 	//    be if we want the GPU to act on it (as in: draw it to the screen)
-	// First, we need to describe the buffer we want Direct3D to make on the GPU
-	//  - Note that this variable is created on the stack since we only need it once
-	//  - After the buffer is created, this description variable is unnecessary
-	D3D11_BUFFER_DESC vbd = {};
-	vbd.Usage = D3D11_USAGE_IMMUTABLE;
-	vbd.ByteWidth = sizeof(Vertex) * a_vertexCount;
-	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vbd.CPUAccessFlags = 0; // Do not include ability to access data from CPU
-	vbd.MiscFlags = 0;
-	vbd.StructureByteStride = 0;
-
-	// Create the proper struct to hold the initial vertex data
-	// - This is how we initially fill the buffer with data
-	// - Essentially, we're specifying a pointer to the data to copy
-	D3D11_SUBRESOURCE_DATA vertexData = {};
-	vertexData.pSysMem = a_vertices; // Pointer to CPU memory to copy
-
-	// Actually create the buffer on the GPU with the initial data
-	// - Once we do this, we'll NEVER CHANGE DATA IN THE BUFFER AGAIN
-	a_device->CreateBuffer(&vbd, &vertexData, m_vertexBuffer.GetAddressOf());
+	// - Immutable: once we do this, we'll NEVER CHANGE DATA IN THE BUFFER AGAIN
+	m_vertexBuffer = m_device->CreateBuffer(BufferType::Vertex, BufferUsage::Immutable, a_vertices, sizeof(Vertex) * a_vertexCount);
 
 	// Create an INDEX BUFFER
 	// - This holds indices to elements in the vertex buffer
 	// - This is most useful when vertices are shared among neighboring triangles
-	// - This buffer is created on the GPU, which is where the data needs to
-	//    be if we want the GPU to act on it (as in: draw it to the screen)
-	// Describe the buffer, as we did above, with two major differences
-	//  - Byte Width (3 unsigned integers vs. 3 whole vertices)
-	//  - Bind Flag (used as an index buffer instead of a vertex buffer) 
-	D3D11_BUFFER_DESC ibd = {};
-	ibd.Usage = D3D11_USAGE_IMMUTABLE;
-	ibd.ByteWidth = sizeof(UINT) * a_indexCount;
-	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	ibd.CPUAccessFlags = 0;
-	ibd.MiscFlags = 0;
-	ibd.StructureByteStride = 0;
-
-	// Specify the initial data for this buffer, similar to above
-	D3D11_SUBRESOURCE_DATA indexData = {};
-	indexData.pSysMem = a_indices;
-
-	// Actually create the buffer with the initial data
-	// - Once we do this, we'll NEVER CHANGE THE BUFFER AGAIN
-	a_device->CreateBuffer(&ibd, &indexData, m_indexBuffer.GetAddressOf());
+	m_indexBuffer = m_device->CreateBuffer(BufferType::Index, BufferUsage::Immutable, a_indices, sizeof(unsigned int) * a_indexCount);
+
+	m_lods.clear();
+	m_lods.push_back({ m_vertexBuffer, m_indexBuffer, a_vertexCount, a_indexCount, 0.f });
+
+	// Simplified LODs get their own compacted buffers. Tangents are recomputed because
+	// collapses move triangles, and the UV gradients across them change
+	std::vector<SimplifiedMesh> simplified;
+	MeshSimplifier::GenerateLODs(a_vertices, a_vertexCount, a_indices, a_indexCount, simplified);
+	for (SimplifiedMesh& level : simplified) {
+		unsigned int vertexCount = (unsigned int)level.Vertices.size();
+		unsigned int indexCount = (unsigned int)level.Indices.size();
+		CalculateTangents(&level.Vertices[0], vertexCount, &level.Indices[0], indexCount);
+
+		MeshLOD lod = {};
+		lod.VertexBuffer = m_device->CreateBuffer(BufferType::Vertex, BufferUsage::Immutable, &level.Vertices[0], sizeof(Vertex) * vertexCount);
+		lod.IndexBuffer = m_device->CreateBuffer(BufferType::Index, BufferUsage::Immutable, &level.Indices[0], sizeof(unsigned int) * indexCount);
+		lod.VertexCount = vertexCount;
+		lod.IndexCount = indexCount;
+		lod.Error = level.Error;
+		m_lods.push_back(lod);
+	}
+
+	m_lodErrors.clear();
+	for (const MeshLOD& lod : m_lods) {
+		m_lodErrors.push_back(lod.Error);
+	}
 }
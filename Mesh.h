@@ -1,37 +1,77 @@
 #pragma once
 
-#include <d3d11.h>
-#include <wrl/client.h>
 #include <vector>
+#include <memory>
 
 #include "Vertex.h"
+#include "RenderDevice.h"
+#include "Types.h"
+#include "MeshSimplifier.h"
+#include "Meshlets.h"
+
+//-------------------------------------------------------
+// GPU buffers for one level of detail
+//	- LOD 0 is the Mesh as loaded and uses the Mesh's own
+//	  buffers, so it always has an Error of 0
+//-------------------------------------------------------
+struct MeshLOD {
+	RenderHandle VertexBuffer;
+	RenderHandle IndexBuffer;
+	unsigned int VertexCount;
+	unsigned int IndexCount;
+	float Error; // Object space, from MeshSimplifier
+};
 
 /// <summary>
 /// The Mesh class wraps drawing functionality (as well as Vertex and Index storage) into a self-contained data structure that
 /// can be used to scale with many different types of geometry.
+/// Buffers are created and drawn through a RenderDevice, so a Mesh works the same on the D3D11 and headless backends.
+/// Simplified LODs are generated on creation (see MeshSimplifier), and whoever draws the Mesh picks which one to use.
+/// Large Meshes can also be split into Meshlets, so LOD 0 can be drawn as the index ranges Meshlets::Cull leaves.
 /// </summary>
 class Mesh
 {
 public:
-	Mesh(Vertex* a_vertices, UINT a_vertexCount, UINT* a_indices, UINT a_indexCount, Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context);
-	Mesh(std::vector<Vertex> a_vertices, std::vector<UINT> a_indices, Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context);
-	Mesh(const wchar_t* a_fileName, Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context);
+	// a_bBuildMeshlets welds and reorders LOD 0 into Meshlets, if it has at least MESHLET_MIN_TRIANGLES
+	Mesh(Vertex* a_vertices, unsigned int a_vertexCount, unsigned int* a_indices, unsigned int a_indexCount, std::shared_ptr<RenderDevice> a_device,
+		bool a_bBuildMeshlets = false);
+	Mesh(std::vector<Vertex> a_vertices, std::vector<unsigned int> a_indices, std::shared_ptr<RenderDevice> a_device, bool a_bBuildMeshlets = false);
+	Mesh(const wchar_t* a_fileName, std::shared_ptr<RenderDevice> a_device, bool a_bBuildMeshlets = false);
 	~Mesh();
 
-	void Draw();
+	void Draw(unsigned int a_lod = 0); // Out of range LODs draw the coarsest one
+	void DrawRanges(const std::vector<MeshletDrawRange>& a_ranges); // Parts of LOD 0, from Meshlets::Cull
 
-	Microsoft::WRL::ComPtr<ID3D11Buffer> GetVertexBuffer();
-	Microsoft::WRL::ComPtr<ID3D11Buffer> GetIndexBuffer();
-	UINT GetIndexCount();
+	RenderHandle GetVertexBuffer();
+	RenderHandle GetIndexBuffer();
+	unsigned int GetIndexCount();
+	unsigned int GetLODCount() { return (unsigned int)m_lods.size(); }
+	const MeshLOD& GetLOD(unsigned int a_lod) { return m_lods[a_lod]; }
+	const float* GetLODErrors() { return m_lodErrors.data(); } // One per LOD, for FramePrep::SelectLOD
+	const std::vector<Meshlet>& GetMeshlets() { return m_meshlets; } // Empty unless built on construction
+	Vector4 GetBoundingSphere();
+	const std::vector<Vector3>& GetPositions() { return m_positions; }
+	const std::vector<unsigned int>& GetIndices() { return m_indices; }
 
 private:
-	void CalculateTangents(Vertex* a_vertices, UINT a_vertexCount, UINT* a_indices, UINT a_indexCount);
-	void CreateMesh(Vertex* a_vertices, UINT a_vertexCount, UINT* a_indices, UINT a_indexCount, Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context);
+	void CalculateTangents(Vertex* a_vertices, unsigned int a_vertexCount, unsigned int* a_indices, unsigned int a_indexCount);
+	void CreateMesh(Vertex* a_vertices, unsigned int a_vertexCount, unsigned int* a_indices, unsigned int a_indexCount);
+
+	RenderHandle m_vertexBuffer;
+	RenderHandle m_indexBuffer;
+
+	std::shared_ptr<RenderDevice> m_device;
+
+	unsigned int m_indexCount;
+	Vector4 m_boundingSphere; // Local space, xyz centre and w radius
 
-	Microsoft::WRL::ComPtr<ID3D11Buffer> m_vertexBuffer;
-	Microsoft::WRL::ComPtr<ID3D11Buffer> m_indexBuffer;
+	std::vector<MeshLOD> m_lods; // Always holds LOD 0
+	std::vector<float> m_lodErrors;
 
-	Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_deviceContext;
+	bool m_bBuildMeshlets;
+	std::vector<Meshlet> m_meshlets; // Over LOD 0's index buffer
 
-	UINT m_indexCount;
+	// CPU copies for CPU-side consumers such as occlusion rasterization. Positions only, to keep the copy small
+	std::vector<Vector3> m_positions;
+	std::vector<unsigned int> m_indices;
 };
@@ -0,0 +1,459 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#define SIMPLIFY_NO_VERTEX 0xFFFFFFFF
+#define SIMPLIFY_MAX_NORMAL_COS 0.25 // A collapse may turn a triangle's normal by up to ~75 degrees. More is a (near) flip
+
+namespace
+{
+	// Symmetric 4x4 plane quadric (a, b, c, d)^T (a, b, c, d), summed over planes and scaled by triangle area
+	struct Quadric {
+		double A2 = 0, AB = 0, AC = 0, AD = 0;
+		double B2 = 0, BC = 0, BD = 0;
+		double C2 = 0, CD = 0;
+		double D2 = 0;
+		double Weight = 0;
+
+		void Add(const Quadric& a_other)
+		{
+			A2 += a_other.A2; AB += a_other.AB; AC += a_other.AC; AD += a_other.AD;
+			B2 += a_other.B2; BC += a_other.BC; BD += a_other.BD;
+			C2 += a_other.C2; CD += a_other.CD;
+			D2 += a_other.D2;
+			Weight += a_other.Weight;
+		}
+
+		// Weighted sum of squared plane distances at a point
+		double Evaluate(const DirectX::XMFLOAT3& a_p) const
+		{
+			double x = a_p.x, y = a_p.y, z = a_p.z;
+			return A2 * x * x + B2 * y * y + C2 * z * z
+				+ 2.0 * (AB * x * y + AC * x * z + BC * y * z)
+				+ 2.0 * (AD * x + BD * y + CD * z)
+				+ D2;
+		}
+	};
+
+	struct Collapse {
+		double Cost;
+		unsigned int From;
+		unsigned int To;
+	};
+
+	struct Vec3d {
+		double x, y, z;
+	};
+
+	Vec3d Sub(const DirectX::XMFLOAT3& a_a, const DirectX::XMFLOAT3& a_b)
+	{
+		return { (double)a_a.x - a_b.x, (double)a_a.y - a_b.y, (double)a_a.z - a_b.z };
+	}
+
+	Vec3d Cross(const Vec3d& a_a, const Vec3d& a_b)
+	{
+		return { a_a.y * a_b.z - a_a.z * a_b.y, a_a.z * a_b.x - a_a.x * a_b.z, a_a.x * a_b.y - a_a.y * a_b.x };
+	}
+
+	double Dot(const Vec3d& a_a, const Vec3d& a_b)
+	{
+		return a_a.x * a_b.x + a_a.y * a_b.y + a_a.z * a_b.z;
+	}
+
+	// Squared distance from p to triangle abc (Ericson, Real-Time Collision Detection 5.1.5)
+	double PointTriangleDistanceSquared(const DirectX::XMFLOAT3& a_p,
+		const DirectX::XMFLOAT3& a_a, const DirectX::XMFLOAT3& a_b, const DirectX::XMFLOAT3& a_c)
+	{
+		Vec3d ab = Sub(a_b, a_a), ac = Sub(a_c, a_a), ap = Sub(a_p, a_a);
+		double v = 0.0, w = 0.0;
+		double d1 = Dot(ab, ap), d2 = Dot(ac, ap);
+		Vec3d bp = Sub(a_p, a_b);
+		double d3 = Dot(ab, bp), d4 = Dot(ac, bp);
+		Vec3d cp = Sub(a_p, a_c);
+		double d5 = Dot(ab, cp), d6 = Dot(ac, cp);
+		double va = d3 * d6 - d5 * d4, vb = d5 * d2 - d1 * d6, vc = d1 * d4 - d3 * d2;
+		if (d1 <= 0.0 && d2 <= 0.0) { v = 0.0; w = 0.0; }
+		else if (d3 >= 0.0 && d4 <= d3) { v = 1.0; w = 0.0; }
+		else if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) { v = d1 / (d1 - d3); w = 0.0; }
+		else if (d6 >= 0.0 && d5 <= d6) { v = 0.0; w = 1.0; }
+		else if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) { v = 0.0; w = d2 / (d2 - d6); }
+		else if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) { w = (d4 - d3) / ((d4 - d3) + (d5 - d6)); v = 1.0 - w; }
+		else { double denominator = 1.0 / (va + vb + vc); v = vb * denominator; w = vc * denominator; }
+
+		Vec3d offset = { ap.x - ab.x * v - ac.x * w, ap.y - ab.y * v - ac.y * w, ap.z - ab.z * v - ac.z * w };
+		return Dot(offset, offset);
+	}
+
+	// Bitwise key for welding. Tangents are ignored, the Mesh recomputes them per LOD
+	struct VertexKey {
+		float Values[8];
+		bool operator==(const VertexKey& a_other) const { return std::memcmp(Values, a_other.Values, sizeof(Values)) == 0; }
+	};
+
+	struct PositionKey {
+		float Values[3];
+		bool operator==(const PositionKey& a_other) const { return std::memcmp(Values, a_other.Values, sizeof(Values)) == 0; }
+	};
+
+	template<typename T>
+	struct BitwiseHash {
+		size_t operator()(const T& a_key) const
+		{
+			// FNV-1a over the raw bytes, so -0 and 0 stay distinct like the equality test
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&a_key);
+			size_t hash = 2166136261u;
+			for (size_t i = 0; i < sizeof(T); i++) {
+				hash = (hash ^ bytes[i]) * 16777619u;
+			}
+			return hash;
+		}
+	};
+}
+
+//----------------------------------------------------
+// Edge collapse simplification
+//	- Vertices with identical position, normal and UV
+//	  are treated as one (OBJ loading never shares them)
+//	- Seams, borders and non-manifold edges are locked
+//	- Each pass sorts every legal collapse by cost, then
+//	  applies them in order, touching each vertex at most
+//	  once so costs stay valid for the pass
+//----------------------------------------------------
+float MeshSimplifier::Simplify(const Vertex* a_vertices, unsigned int a_vertexCount, const unsigned int* a_indices, unsigned int a_indexCount,
+	unsigned int a_targetIndexCount, float a_maxError, std::vector<unsigned int>& a_outIndices)
+{
+	a_outIndices.clear();
+	unsigned int triangleCount = a_indexCount / 3;
+	if (triangleCount == 0)
+		return 0.f;
+
+	// Weld identical vertices, then group the welded vertices by position
+	std::vector<unsigned int> canonical(a_vertexCount);
+	std::vector<unsigned int> positionId(a_vertexCount);
+	std::vector<unsigned int> positionVertexCount;
+	std::vector<DirectX::XMFLOAT3> positions;
+	{
+		std::unordered_map<VertexKey, unsigned int, BitwiseHash<VertexKey>> vertexMap;
+		std::unordered_map<PositionKey, unsigned int, BitwiseHash<PositionKey>> positionMap;
+		vertexMap.reserve(a_vertexCount);
+		positionMap.reserve(a_vertexCount);
+		for (unsigned int i = 0; i < a_vertexCount; i++) {
+			const Vertex& v = a_vertices[i];
+			VertexKey key = { { v.Position.x, v.Position.y, v.Position.z, v.Normal.x, v.Normal.y, v.Normal.z, v.UV.x, v.UV.y } };
+			auto vertexEntry = vertexMap.emplace(key, i);
+			canonical[i] = vertexEntry.first->second;
+			if (!vertexEntry.second) {
+				positionId[i] = positionId[canonical[i]];
+				continue;
+			}
+
+			PositionKey positionKey = { { v.Position.x, v.Position.y, v.Position.z } };
+			auto positionEntry = positionMap.emplace(positionKey, (unsigned int)positions.size());
+			if (positionEntry.second) {
+				positions.push_back(v.Position);
+				positionVertexCount.push_back(0);
+			}
+			positionId[i] = positionEntry.first->second;
+			positionVertexCount[positionId[i]]++;
+		}
+	}
+	unsigned int positionCount = (unsigned int)positions.size();
+
+	// Welded triangles. Triangles that are already degenerate are dropped
+	std::vector<unsigned int> triangles;
+	triangles.reserve(a_indexCount);
+	for (unsigned int t = 0; t < triangleCount; t++) {
+		unsigned int v0 = canonical[a_indices[t * 3 + 0]];
+		unsigned int v1 = canonical[a_indices[t * 3 + 1]];
+		unsigned int v2 = canonical[a_indices[t * 3 + 2]];
+		if (positionId[v0] == positionId[v1] || positionId[v1] == positionId[v2] || positionId[v0] == positionId[v2])
+			continue;
+		triangles.push_back(v0);
+		triangles.push_back(v1);
+		triangles.push_back(v2);
+	}
+	triangleCount = (unsigned int)triangles.size() / 3;
+	std::vector<bool> triangleAlive(triangleCount, true);
+
+	// Positions on a seam (several welded vertices) or next to an edge without exactly 2 triangles are locked
+	std::vector<bool> locked(positionCount, false);
+	for (unsigned int p = 0; p < positionCount; p++) {
+		locked[p] = positionVertexCount[p] > 1;
+	}
+	{
+		std::unordered_map<unsigned long long, unsigned int> edgeUses;
+		edgeUses.reserve(triangles.size());
+		for (unsigned int t = 0; t < triangleCount; t++) {
+			for (unsigned int e = 0; e < 3; e++) {
+				unsigned int p0 = positionId[triangles[t * 3 + e]];
+				unsigned int p1 = positionId[triangles[t * 3 + (e + 1) % 3]];
+				unsigned long long key = ((unsigned long long)std::min(p0, p1) << 32) | std::max(p0, p1);
+				edgeUses[key]++;
+			}
+		}
+		for (const auto& edge : edgeUses) {
+			if (edge.second != 2) {
+				locked[(unsigned int)(edge.first >> 32)] = true;
+				locked[(unsigned int)(edge.first & 0xFFFFFFFF)] = true;
+			}
+		}
+	}
+
+	// Triangles around each position, and each position's plane quadric
+	std::vector<std::vector<unsigned int>> positionTriangles(positionCount);
+	std::vector<Quadric> quadrics(positionCount);
+	for (unsigned int t = 0; t < triangleCount; t++) {
+		const DirectX::XMFLOAT3& p0 = a_vertices[triangles[t * 3 + 0]].Position;
+		const DirectX::XMFLOAT3& p1 = a_vertices[triangles[t * 3 + 1]].Position;
+		const DirectX::XMFLOAT3& p2 = a_vertices[triangles[t * 3 + 2]].Position;
+		Vec3d normal = Cross(Sub(p1, p0), Sub(p2, p0));
+		double length = std::sqrt(Dot(normal, normal));
+
+		Quadric q;
+		if (length > 0.0) {
+			double a = normal.x / length, b = normal.y / length, c = normal.z / length;
+			double d = -(a * p0.x + b * p0.y + c * p0.z);
+			double area = length * 0.5;
+			q.A2 = a * a * area; q.AB = a * b * area; q.AC = a * c * area; q.AD = a * d * area;
+			q.B2 = b * b * area; q.BC = b * c * area; q.BD = b * d * area;
+			q.C2 = c * c * area; q.CD = c * d * area;
+			q.D2 = d * d * area;
+			q.Weight = area;
+		}
+		for (unsigned int c = 0; c < 3; c++) {
+			unsigned int p = positionId[triangles[t * 3 + c]];
+			positionTriangles[p].push_back(t);
+			quadrics[p].Add(q);
+		}
+	}
+
+	// Neighbouring positions of one position, from its live triangles
+	auto gatherNeighbours = [&](unsigned int a_position, std::vector<unsigned int>& a_neighbours) {
+		a_neighbours.clear();
+		for (unsigned int t : positionTriangles[a_position]) {
+			if (!triangleAlive[t])
+				continue;
+			for (unsigned int c = 0; c < 3; c++) {
+				unsigned int p = positionId[triangles[t * 3 + c]];
+				if (p != a_position)
+					a_neighbours.push_back(p);
+			}
+		}
+		std::sort(a_neighbours.begin(), a_neighbours.end());
+		a_neighbours.erase(std::unique(a_neighbours.begin(), a_neighbours.end()), a_neighbours.end());
+	};
+
+	unsigned int liveTriangles = triangleCount;
+	unsigned int targetTriangles = a_targetIndexCount / 3;
+	double maxCost = (double)a_maxError * (double)a_maxError;
+	double reachedCost = 0.0;
+
+	std::vector<bool> removed(positionCount, false);
+	std::vector<unsigned int> collapsedInto(positionCount, SIMPLIFY_NO_VERTEX);
+	std::vector<unsigned int> touchedPass(positionCount, 0);
+	std::vector<Collapse> collapses;
+	std::vector<unsigned int> fromNeighbours;
+	std::vector<unsigned int> toNeighbours;
+
+	for (unsigned int pass = 1; liveTriangles > targetTriangles; pass++) {
+		// Every collapse of an unlocked vertex into a neighbour across a live edge
+		collapses.clear();
+		for (unsigned int t = 0; t < triangleCount; t++) {
+			if (!triangleAlive[t])
+				continue;
+			for (unsigned int e = 0; e < 3; e++) {
+				unsigned int from = triangles[t * 3 + e];
+				unsigned int to = triangles[t * 3 + (e + 1) % 3];
+				for (unsigned int direction = 0; direction < 2; direction++) {
+					unsigned int fromPosition = positionId[from];
+					if (!locked[fromPosition]) {
+						Quadric q = quadrics[fromPosition];
+						q.Add(quadrics[positionId[to]]);
+						double cost = q.Weight > 0.0 ? std::max(q.Evaluate(a_vertices[to].Position) / q.Weight, 0.0) : 0.0;
+						collapses.push_back({ cost, from, to });
+					}
+					std::swap(from, to);
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a_a, const Collapse& a_b) {
+			return a_a.Cost < a_b.Cost;
+		});
+
+		unsigned int collapsed = 0;
+		for (const Collapse& collapse : collapses) {
+			if (liveTriangles <= targetTriangles || collapse.Cost > maxCost)
+				break;
+
+			unsigned int fromPosition = positionId[collapse.From];
+			unsigned int toPosition = positionId[collapse.To];
+			if (removed[fromPosition] || removed[toPosition] || touchedPass[fromPosition] == pass || touchedPass[toPosition] == pass)
+				continue;
+
+			// Link condition: the two positions may only share the 2 vertices opposite their edge,
+			// anything else would pinch the surface into a non-manifold fold
+			gatherNeighbours(fromPosition, fromNeighbours);
+			gatherNeighbours(toPosition, toNeighbours);
+			unsigned int shared = 0;
+			for (size_t i = 0, j = 0; i < fromNeighbours.size() && j < toNeighbours.size();) {
+				if (fromNeighbours[i] < toNeighbours[j]) i++;
+				else if (fromNeighbours[i] > toNeighbours[j]) j++;
+				else { shared++; i++; j++; }
+			}
+			if (shared != 2)
+				continue;
+
+			// Reject the collapse if any surviving triangle would flip, turn so far it folds into a sliver, or end up
+			// facing the other way to its vertex normals (which would shade it inside out)
+			bool bFlips = false;
+			const DirectX::XMFLOAT3& target = a_vertices[collapse.To].Position;
+			for (unsigned int t : positionTriangles[fromPosition]) {
+				if (!triangleAlive[t])
+					continue;
+				const unsigned int* corners = &triangles[t * 3];
+				if (positionId[corners[0]] == toPosition || positionId[corners[1]] == toPosition || positionId[corners[2]] == toPosition)
+					continue;
+
+				DirectX::XMFLOAT3 p[3] = { a_vertices[corners[0]].Position, a_vertices[corners[1]].Position, a_vertices[corners[2]].Position };
+				Vec3d before = Cross(Sub(p[1], p[0]), Sub(p[2], p[0]));
+				Vec3d normalsBefore = { 0.0, 0.0, 0.0 };
+				Vec3d normalsAfter = { 0.0, 0.0, 0.0 };
+				for (unsigned int c = 0; c < 3; c++) {
+					const DirectX::XMFLOAT3& normal = a_vertices[corners[c]].Normal;
+					normalsBefore = { normalsBefore.x + normal.x, normalsBefore.y + normal.y, normalsBefore.z + normal.z };
+					const DirectX::XMFLOAT3& normalAfter = corners[c] == collapse.From ? a_vertices[collapse.To].Normal : normal;
+					normalsAfter = { normalsAfter.x + normalAfter.x, normalsAfter.y + normalAfter.y, normalsAfter.z + normalAfter.z };
+					if (corners[c] == collapse.From)
+						p[c] = target;
+				}
+				Vec3d after = Cross(Sub(p[1], p[0]), Sub(p[2], p[0]));
+				if (Dot(before, after) <= SIMPLIFY_MAX_NORMAL_COS * std::sqrt(Dot(before, before) * Dot(after, after))
+					|| Dot(before, normalsBefore) * Dot(after, normalsAfter) <= 0.0) {
+					bFlips = true;
+					break;
+				}
+			}
+			if (bFlips)
+				continue;
+
+			// Move the triangles over, dropping the ones that span the collapsed edge
+			for (unsigned int t : positionTriangles[fromPosition]) {
+				if (!triangleAlive[t])
+					continue;
+				unsigned int* corners = &triangles[t * 3];
+				if (positionId[corners[0]] == toPosition || positionId[corners[1]] == toPosition || positionId[corners[2]] == toPosition) {
+					triangleAlive[t] = false;
+					liveTriangles--;
+					continue;
+				}
+				for (unsigned int c = 0; c < 3; c++) {
+					if (corners[c] == collapse.From)
+						corners[c] = collapse.To;
+				}
+				positionTriangles[toPosition].push_back(t);
+			}
+			positionTriangles[fromPosition].clear();
+			quadrics[toPosition].Add(quadrics[fromPosition]);
+			removed[fromPosition] = true;
+			collapsedInto[fromPosition] = toPosition;
+			touchedPass[fromPosition] = pass;
+			touchedPass[toPosition] = pass;
+			reachedCost = std::max(reachedCost, collapse.Cost);
+			collapsed++;
+		}
+
+		if (collapsed == 0)
+			break;
+	}
+
+	a_outIndices.reserve(liveTriangles * 3);
+	for (unsigned int t = 0; t < triangleCount; t++) {
+		if (triangleAlive[t])
+			a_outIndices.insert(a_outIndices.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+	}
+
+	// Quadric costs average over planes, so they understate the worst case. Measure each removed position
+	// against the triangles around the position it finally collapsed into instead. Nearer triangles elsewhere
+	// can only make the true distance smaller, so this stays an upper bound for the removed vertices
+	double error = reachedCost;
+	for (unsigned int p = 0; p < positionCount; p++) {
+		if (!removed[p])
+			continue;
+		unsigned int survivor = collapsedInto[p];
+		while (removed[survivor]) {
+			survivor = collapsedInto[survivor];
+		}
+
+		// Triangles within two rings of the survivor, as later collapses can move the surface p was on out of
+		// the survivor's own fan
+		double closest = DBL_MAX;
+		gatherNeighbours(survivor, fromNeighbours);
+		fromNeighbours.push_back(survivor);
+		for (unsigned int neighbour : fromNeighbours) {
+			for (unsigned int t : positionTriangles[neighbour]) {
+				if (triangleAlive[t]) {
+					closest = std::min(closest, PointTriangleDistanceSquared(positions[p], a_vertices[triangles[t * 3 + 0]].Position,
+						a_vertices[triangles[t * 3 + 1]].Position, a_vertices[triangles[t * 3 + 2]].Position));
+				}
+			}
+		}
+		if (closest != DBL_MAX)
+			error = std::max(error, closest);
+	}
+	return (float)std::sqrt(error);
+}
+
+//----------------------------------------------------
+// Keep referenced vertices in first use order, which
+// also keeps them roughly in index order for the
+// vertex cache
+//----------------------------------------------------
+void MeshSimplifier::Compact(const Vertex* a_vertices, const std::vector<unsigned int>& a_indices, SimplifiedMesh& a_output)
+{
+	a_output.Vertices.clear();
+	a_output.Indices.resize(a_indices.size());
+
+	unsigned int maxIndex = 0;
+	for (unsigned int index : a_indices) {
+		maxIndex = std::max(maxIndex, index);
+	}
+	std::vector<unsigned int> remap(a_indices.empty() ? 0 : maxIndex + 1, SIMPLIFY_NO_VERTEX);
+	for (size_t i = 0; i < a_indices.size(); i++) {
+		unsigned int& newIndex = remap[a_indices[i]];
+		if (newIndex == SIMPLIFY_NO_VERTEX) {
+			newIndex = (unsigned int)a_output.Vertices.size();
+			a_output.Vertices.push_back(a_vertices[a_indices[i]]);
+		}
+		a_output.Indices[i] = newIndex;
+	}
+}
+
+//----------------------------------------------------
+// Build the chain from the source every time, so each
+// level's error is measured against full resolution
+//----------------------------------------------------
+void MeshSimplifier::GenerateLODs(const Vertex* a_vertices, unsigned int a_vertexCount, const unsigned int* a_indices, unsigned int a_indexCount,
+	std::vector<SimplifiedMesh>& a_lods)
+{
+	a_lods.clear();
+	unsigned int previousTriangles = a_indexCount / 3;
+	float previousError = 0.f;
+	std::vector<unsigned int> indices;
+	for (unsigned int lod = 1; lod < MESH_LOD_MAX_COUNT && previousTriangles > MESH_LOD_MIN_TRIANGLES; lod++) {
+		unsigned int targetTriangles = std::max((unsigned int)(previousTriangles * MESH_LOD_REDUCTION), (unsigned int)MESH_LOD_MIN_TRIANGLES);
+		float error = Simplify(a_vertices, a_vertexCount, a_indices, a_indexCount, targetTriangles * 3, FLT_MAX, indices);
+
+		unsigned int triangles = (unsigned int)indices.size() / 3;
+		if (triangles == 0 || triangles > previousTriangles * MESH_LOD_MIN_PROGRESS)
+			break;
+
+		a_lods.emplace_back();
+		Compact(a_vertices, indices, a_lods.back());
+		a_lods.back().Error = previousError = std::max(error, previousError);
+		previousTriangles = triangles;
+	}
+}
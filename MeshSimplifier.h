@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "Vertex.h"
+
+#define MESH_LOD_MAX_COUNT 4 // Including the full resolution Mesh
+#define MESH_LOD_REDUCTION 0.5f // Each LOD targets this fraction of the previous LOD's triangles
+#define MESH_LOD_MIN_TRIANGLES 64 // Meshes (and LODs) at or below this many triangles are not simplified further
+#define MESH_LOD_MIN_PROGRESS 0.85f // A LOD keeping more than this fraction of the previous triangles is dropped
+
+//-------------------------------------------------------
+// One generated level of detail, with its own compacted
+// vertices (tangents are left for the Mesh to recompute)
+//-------------------------------------------------------
+struct SimplifiedMesh {
+	std::vector<Vertex> Vertices;
+	std::vector<unsigned int> Indices;
+	float Error = 0.f; // Approximate object space deviation from the source Mesh
+};
+
+//-------------------------------------------------------
+// Offline quadric error metric simplification (Garland
+// and Heckbert, 1997) for building Mesh LOD chains
+//	- Vertices are welded by position first. A position
+//	  shared by vertices with different normals or UVs is
+//	  a seam, and is locked along with open borders and
+//	  non-manifold edges, so seams never crack or smear
+//	- Every other vertex can collapse into a neighbour,
+//	  keeping the neighbour's attributes. Collapses are
+//	  done cheapest first in passes, skipping any that
+//	  would flip a triangle
+//	- Only indices change, so the source vertex array is
+//	  shared by every level until Compact drops the
+//	  vertices a level no longer uses
+//-------------------------------------------------------
+namespace MeshSimplifier
+{
+	// Collapse edges until at most a_targetIndexCount indices remain or the next collapse's quadric error is over a_maxError
+	//	- Returns the larger of the quadric error and the farthest any removed vertex ended up from the simplified
+	//	  surface, in the units of the vertex positions. This is what LOD selection projects to the screen
+	float Simplify(const Vertex* a_vertices, unsigned int a_vertexCount, const unsigned int* a_indices, unsigned int a_indexCount,
+		unsigned int a_targetIndexCount, float a_maxError, std::vector<unsigned int>& a_outIndices);
+
+	// Copy out only the vertices a_indices references, remapping the indices to match
+	void Compact(const Vertex* a_vertices, const std::vector<unsigned int>& a_indices, SimplifiedMesh& a_output);
+
+	// LODs 1 and up, each simplified from the source with MESH_LOD_REDUCTION of the previous triangle count
+	//	- Output can be empty if the Mesh is already small or can't be reduced around its seams
+	void GenerateLODs(const Vertex* a_vertices, unsigned int a_vertexCount, const unsigned int* a_indices, unsigned int a_indexCount,
+		std::vector<SimplifiedMesh>& a_lods);
+}
@@ -0,0 +1,293 @@
+#include "Meshlets.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#define MESHLET_NONE 0xFFFFFFFF
+#define MESHLET_UNIFORM_SCALE_TOLERANCE 1e-3f // Relative difference in axis scales still treated as uniform
+
+namespace
+{
+	// Bitwise position, normal and UV of a vertex. Tangents are recomputed after welding
+	struct WeldKey {
+		float Values[8];
+		bool operator==(const WeldKey& a_other) const { return std::memcmp(Values, a_other.Values, sizeof(Values)) == 0; }
+	};
+
+	struct WeldKeyHash {
+		size_t operator()(const WeldKey& a_key) const
+		{
+			// FNV-1a over the raw bytes, matching the bitwise equality test
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(a_key.Values);
+			size_t hash = 2166136261u;
+			for (size_t i = 0; i < sizeof(a_key.Values); i++) {
+				hash = (hash ^ bytes[i]) * 16777619u;
+			}
+			return hash;
+		}
+	};
+
+	const Vector3& PositionAt(const Vector3* a_positions, unsigned int a_stride, unsigned int a_index)
+	{
+		return *reinterpret_cast<const Vector3*>(reinterpret_cast<const unsigned char*>(a_positions) + (size_t)a_index * a_stride);
+	}
+
+	// Bounding sphere and normal cone of the triangles in a_indices
+	void ComputeMeshletBounds(const Vector3* a_positions, unsigned int a_stride, const unsigned int* a_indices, unsigned int a_triangleCount,
+		std::vector<Vector3>& a_scratch, Meshlet& a_meshlet)
+	{
+		a_scratch.clear();
+		for (unsigned int i = 0; i < a_triangleCount * 3; i++) {
+			a_scratch.push_back(PositionAt(a_positions, a_stride, a_indices[i]));
+		}
+		a_meshlet.BoundingSphere = Culling::ComputeBoundingSphere(a_scratch.data(), (unsigned int)a_scratch.size(), sizeof(Vector3));
+
+		// Unit normals of every triangle, replacing the positions in scratch. Degenerate triangles face nowhere
+		unsigned int normalCount = 0;
+		Vector3 axis(0.f, 0.f, 0.f);
+		for (unsigned int t = 0; t < a_triangleCount; t++) {
+			const Vector3& p0 = a_scratch[t * 3 + 0];
+			const Vector3& p1 = a_scratch[t * 3 + 1];
+			const Vector3& p2 = a_scratch[t * 3 + 2];
+			Vector3 e0(p1.x - p0.x, p1.y - p0.y, p1.z - p0.z);
+			Vector3 e1(p2.x - p0.x, p2.y - p0.y, p2.z - p0.z);
+			Vector3 normal(e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x);
+			float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+			if (length <= 0.f)
+				continue;
+			normal = Vector3(normal.x / length, normal.y / length, normal.z / length);
+			a_scratch[normalCount++] = normal;
+			axis = Vector3(axis.x + normal.x, axis.y + normal.y, axis.z + normal.z);
+		}
+
+		// The cone is disabled (cutoff 1) unless every normal is less than 90 degrees from the axis
+		a_meshlet.ConeAxis = Vector3(0.f, 0.f, 1.f);
+		a_meshlet.ConeCutoff = 1.f;
+		float axisLength = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+		if (normalCount == 0 || axisLength <= FLT_EPSILON)
+			return;
+		axis = Vector3(axis.x / axisLength, axis.y / axisLength, axis.z / axisLength);
+
+		float minimumDot = 1.f;
+		for (unsigned int i = 0; i < normalCount; i++) {
+			minimumDot = std::fmin(minimumDot, axis.x * a_scratch[i].x + axis.y * a_scratch[i].y + axis.z * a_scratch[i].z);
+		}
+		a_meshlet.ConeAxis = axis;
+		if (minimumDot > 0.f)
+			a_meshlet.ConeCutoff = std::sqrt(1.f - minimumDot * minimumDot);
+	}
+}
+
+//-------------------------------------------------------
+// First occurrence of each distinct vertex is kept, so
+// the welded order follows the original
+//-------------------------------------------------------
+void Meshlets::WeldVertices(const Vertex* a_vertices, unsigned int a_vertexCount, const unsigned int* a_indices, unsigned int a_indexCount,
+	std::vector<Vertex>& a_outVertices, std::vector<unsigned int>& a_outIndices)
+{
+	a_outVertices.clear();
+	a_outIndices.resize(a_indexCount);
+
+	std::unordered_map<WeldKey, unsigned int, WeldKeyHash> welded;
+	welded.reserve(a_vertexCount);
+	std::vector<unsigned int> remap(a_vertexCount, MESHLET_NONE);
+	for (unsigned int i = 0; i < a_indexCount; i++) {
+		unsigned int index = a_indices[i];
+		if (remap[index] == MESHLET_NONE) {
+			const Vertex& v = a_vertices[index];
+			WeldKey key = { { v.Position.x, v.Position.y, v.Position.z, v.Normal.x, v.Normal.y, v.Normal.z, v.UV.x, v.UV.y } };
+			auto entry = welded.emplace(key, (unsigned int)a_outVertices.size());
+			if (entry.second)
+				a_outVertices.push_back(v);
+			remap[index] = entry.first->second;
+		}
+		a_outIndices[i] = remap[index];
+	}
+}
+
+//-------------------------------------------------------
+// Greedy growth over triangle adjacency
+//	- Candidates are the unused triangles touching the
+//	  current meshlet's vertices, so each step only
+//	  looks at the meshlet's border
+//	- When the best candidate no longer fits it seeds
+//	  the next meshlet. Only when a meshlet has no
+//	  border left does the search jump to the next
+//	  unused triangle in index order
+//-------------------------------------------------------
+void Meshlets::Build(const Vector3* a_positions, unsigned int a_vertexCount, unsigned int a_stride, const unsigned int* a_indices, unsigned int a_indexCount,
+	std::vector<Meshlet>& a_meshlets, std::vector<unsigned int>& a_outIndices)
+{
+	a_meshlets.clear();
+	a_outIndices.clear();
+	unsigned int triangleCount = a_indexCount / 3;
+	if (triangleCount == 0)
+		return;
+	a_outIndices.reserve((size_t)triangleCount * 3);
+
+	// Triangles around each vertex, as offsets into one shared list
+	std::vector<unsigned int> adjacencyOffsets(a_vertexCount + 1, 0);
+	for (unsigned int i = 0; i < triangleCount * 3; i++) {
+		adjacencyOffsets[a_indices[i] + 1]++;
+	}
+	for (unsigned int v = 0; v < a_vertexCount; v++) {
+		adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+	}
+	std::vector<unsigned int> adjacency(triangleCount * 3);
+	{
+		std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (unsigned int i = 0; i < triangleCount * 3; i++) {
+			adjacency[fill[a_indices[i]]++] = i / 3;
+		}
+	}
+
+	std::vector<Vector3> centroids(triangleCount);
+	for (unsigned int t = 0; t < triangleCount; t++) {
+		const Vector3& p0 = PositionAt(a_positions, a_stride, a_indices[t * 3 + 0]);
+		const Vector3& p1 = PositionAt(a_positions, a_stride, a_indices[t * 3 + 1]);
+		const Vector3& p2 = PositionAt(a_positions, a_stride, a_indices[t * 3 + 2]);
+		centroids[t] = Vector3((p0.x + p1.x + p2.x) / 3.f, (p0.y + p1.y + p2.y) / 3.f, (p0.z + p1.z + p2.z) / 3.f);
+	}
+
+	std::vector<bool> used(triangleCount, false);
+	std::vector<unsigned int> vertexMeshlet(a_vertexCount, MESHLET_NONE); // Meshlet a vertex was last added to
+	std::vector<unsigned int> candidateMeshlet(triangleCount, MESHLET_NONE); // Meshlet whose candidate list holds the triangle
+	std::vector<unsigned int> candidates;
+	std::vector<Vector3> scratch;
+
+	Meshlet current = {};
+	Vector3 centroidSum(0.f, 0.f, 0.f);
+	unsigned int meshletId = 0;
+	unsigned int scan = 0;
+
+	auto finishMeshlet = [&]() {
+		ComputeMeshletBounds(a_positions, a_stride, &a_outIndices[current.IndexOffset], current.TriangleCount, scratch, current);
+		a_meshlets.push_back(current);
+		current = {};
+		current.IndexOffset = (unsigned int)a_outIndices.size();
+		centroidSum = Vector3(0.f, 0.f, 0.f);
+		meshletId++;
+	};
+
+	for (unsigned int emitted = 0; emitted < triangleCount; emitted++) {
+		// Cheapest neighbouring triangle, by new vertices then distance to the meshlet's centre
+		unsigned int best = MESHLET_NONE;
+		unsigned int bestNewVertices = 4;
+		float bestDistance = FLT_MAX;
+		Vector3 center(0.f, 0.f, 0.f);
+		if (current.TriangleCount > 0) {
+			float scale = 1.f / current.TriangleCount;
+			center = Vector3(centroidSum.x * scale, centroidSum.y * scale, centroidSum.z * scale);
+		}
+		for (size_t c = 0; c < candidates.size();) {
+			unsigned int t = candidates[c];
+			if (used[t]) {
+				candidates[c] = candidates.back();
+				candidates.pop_back();
+				continue;
+			}
+			unsigned int newVertices = 0;
+			for (unsigned int corner = 0; corner < 3; corner++) {
+				newVertices += vertexMeshlet[a_indices[t * 3 + corner]] == meshletId ? 0 : 1;
+			}
+			float x = centroids[t].x - center.x, y = centroids[t].y - center.y, z = centroids[t].z - center.z;
+			float distance = x * x + y * y + z * z;
+			if (newVertices < bestNewVertices || (newVertices == bestNewVertices && distance < bestDistance)) {
+				best = t;
+				bestNewVertices = newVertices;
+				bestDistance = distance;
+			}
+			c++;
+		}
+		if (best == MESHLET_NONE) {
+			while (used[scan]) {
+				scan++;
+			}
+			best = scan;
+			bestNewVertices = 3;
+		}
+
+		// Start a new meshlet if this one can't take the triangle. The old border seeds the new one
+		if (current.TriangleCount > 0 &&
+			(current.VertexCount + bestNewVertices > MESHLET_MAX_VERTICES || current.TriangleCount + 1 > MESHLET_MAX_TRIANGLES)) {
+			finishMeshlet();
+			candidates.clear();
+		}
+
+		used[best] = true;
+		current.TriangleCount++;
+		centroidSum = Vector3(centroidSum.x + centroids[best].x, centroidSum.y + centroids[best].y, centroidSum.z + centroids[best].z);
+		for (unsigned int corner = 0; corner < 3; corner++) {
+			unsigned int vertex = a_indices[best * 3 + corner];
+			a_outIndices.push_back(vertex);
+			if (vertexMeshlet[vertex] != meshletId) {
+				vertexMeshlet[vertex] = meshletId;
+				current.VertexCount++;
+			}
+			for (unsigned int a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++) {
+				unsigned int neighbour = adjacency[a];
+				if (!used[neighbour] && candidateMeshlet[neighbour] != meshletId) {
+					candidateMeshlet[neighbour] = meshletId;
+					candidates.push_back(neighbour);
+				}
+			}
+		}
+	}
+	finishMeshlet();
+}
+
+//-------------------------------------------------------
+// Meshlets are tested in index order, so a visible run
+// extends the previous range instead of starting one
+//-------------------------------------------------------
+unsigned int Meshlets::Cull(const std::vector<Meshlet>& a_meshlets, const Matrix4& a_world, const Frustum& a_frustum,
+	const Vector3& a_cameraPosition, std::vector<MeshletDrawRange>& a_ranges, bool a_bConeCulling)
+{
+	a_ranges.clear();
+	const Matrix4& m = a_world;
+
+	// Cones only survive rotation and uniform scale
+	float scaleX = m._11 * m._11 + m._12 * m._12 + m._13 * m._13;
+	float scaleY = m._21 * m._21 + m._22 * m._22 + m._23 * m._23;
+	float scaleZ = m._31 * m._31 + m._32 * m._32 + m._33 * m._33;
+	float largest = std::fmax(scaleX, std::fmax(scaleY, scaleZ));
+	float smallest = std::fmin(scaleX, std::fmin(scaleY, scaleZ));
+	float determinant = m._11 * (m._22 * m._33 - m._23 * m._32) - m._12 * (m._21 * m._33 - m._23 * m._31) + m._13 * (m._21 * m._32 - m._22 * m._31);
+	bool bConeCulling = a_bConeCulling && determinant > 0.f && largest - smallest <= largest * MESHLET_UNIFORM_SCALE_TOLERANCE;
+	float axisScale = largest > 0.f ? 1.f / std::sqrt(largest) : 0.f;
+
+	unsigned int triangles = 0;
+	for (const Meshlet& meshlet : a_meshlets) {
+		Vector4 sphere = Culling::TransformSphere(meshlet.BoundingSphere, a_world);
+
+		bool bVisible = true;
+		for (unsigned int p = 0; p < CULLING_PLANE_COUNT && bVisible; p++) {
+			const Vector4& plane = a_frustum.Planes[p];
+			bVisible = plane.x * sphere.x + plane.y * sphere.y + plane.z * sphere.z + plane.w >= -sphere.w;
+		}
+
+		// Every triangle faces away when the camera sees the sphere from within the cone's back side:
+		// dot(centre - camera, axis) >= sin(half angle) * |centre - camera| + radius
+		if (bVisible && bConeCulling && meshlet.ConeCutoff < 1.f) {
+			const Vector3& a = meshlet.ConeAxis;
+			float axisX = (a.x * m._11 + a.y * m._21 + a.z * m._31) * axisScale;
+			float axisY = (a.x * m._12 + a.y * m._22 + a.z * m._32) * axisScale;
+			float axisZ = (a.x * m._13 + a.y * m._23 + a.z * m._33) * axisScale;
+			float x = sphere.x - a_cameraPosition.x, y = sphere.y - a_cameraPosition.y, z = sphere.z - a_cameraPosition.z;
+			float distance = std::sqrt(x * x + y * y + z * z);
+			bVisible = x * axisX + y * axisY + z * axisZ < meshlet.ConeCutoff * distance + sphere.w;
+		}
+		if (!bVisible)
+			continue;
+
+		unsigned int indexCount = meshlet.TriangleCount * 3;
+		if (!a_ranges.empty() && a_ranges.back().IndexOffset + a_ranges.back().IndexCount == meshlet.IndexOffset)
+			a_ranges.back().IndexCount += indexCount;
+		else
+			a_ranges.push_back({ meshlet.IndexOffset, indexCount });
+		triangles += meshlet.TriangleCount;
+	}
+	return triangles;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include "Types.h"
+#include "Vertex.h"
+#include "Culling.h"
+
+#define MESHLET_MAX_VERTICES 64 // Unique vertices per meshlet
+#define MESHLET_MAX_TRIANGLES 124 // Triangles per meshlet
+#define MESHLET_MIN_TRIANGLES 512 // Meshes smaller than this draw whole, as culling them in pieces costs more than it saves
+
+//-------------------------------------------------------
+// One cluster of a Mesh's triangles, stored contiguously
+// in its (reordered) index buffer
+//-------------------------------------------------------
+struct Meshlet {
+	unsigned int IndexOffset; // First index in the Mesh's LOD 0 index buffer
+	unsigned int TriangleCount;
+	unsigned int VertexCount; // Unique vertices referenced, at most MESHLET_MAX_VERTICES
+	Vector4 BoundingSphere; // Local space, xyz centre and w radius
+	Vector3 ConeAxis; // Average facing of the triangles, unit length
+	float ConeCutoff; // Sine of the normal cone's half angle. 1 when the cone is too wide to ever cull
+};
+
+// A run of indices to draw, merged across consecutive visible meshlets
+struct MeshletDrawRange {
+	unsigned int IndexOffset;
+	unsigned int IndexCount;
+};
+
+//-------------------------------------------------------
+// Meshlet (cluster) decomposition and culling, so large
+// Meshes only draw the parts that can be seen
+//	- Build grows each meshlet one triangle at a time,
+//	  picking the neighbouring triangle that adds the
+//	  fewest new vertices (then the one nearest the
+//	  meshlet's centre), so meshlets stay compact and
+//	  fill both limits. The next meshlet starts next to
+//	  the last one, keeping the index order local too
+//	- Each meshlet stores a bounding sphere for frustum
+//	  tests and a normal cone for backface tests. When
+//	  the camera is inside the "back" side of the cone,
+//	  every triangle in the meshlet faces away
+//	- Cull tests every meshlet against a world space
+//	  frustum and camera, and merges the survivors into
+//	  as few index ranges as possible
+//-------------------------------------------------------
+namespace Meshlets
+{
+	// Merge vertices with identical position, normal and UV, so triangles share them. Meshlet vertex limits count
+	// shared vertices, which OBJ triangle soups don't have
+	void WeldVertices(const Vertex* a_vertices, unsigned int a_vertexCount, const unsigned int* a_indices, unsigned int a_indexCount,
+		std::vector<Vertex>& a_outVertices, std::vector<unsigned int>& a_outIndices);
+
+	// Split a triangle list into meshlets. a_outIndices holds the same triangles, reordered meshlet by meshlet
+	void Build(const Vector3* a_positions, unsigned int a_vertexCount, unsigned int a_stride, const unsigned int* a_indices, unsigned int a_indexCount,
+		std::vector<Meshlet>& a_meshlets, std::vector<unsigned int>& a_outIndices);
+
+	// Frustum and normal cone test every meshlet of one instance, writing the index ranges left to draw
+	//	- Returns the number of triangles in a_ranges
+	//	- The cone test is skipped for non-uniform or mirroring world matrices, which don't preserve the cone
+	unsigned int Cull(const std::vector<Meshlet>& a_meshlets, const Matrix4& a_world, const Frustum& a_frustum,
+		const Vector3& a_cameraPosition, std::vector<MeshletDrawRange>& a_ranges, bool a_bConeCulling = true);
+}
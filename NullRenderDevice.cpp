@@ -0,0 +1,224 @@
+#include "NullRenderDevice.h"
+
+// FNV-1a constants, used to fold each recorded command into the frame hash
+#define NULL_DEVICE_HASH_OFFSET 14695981039346656037ull
+#define NULL_DEVICE_HASH_PRIME 1099511628211ull
+
+//-----------------------------------------------
+// Starts empty, with recording disabled
+//-----------------------------------------------
+NullRenderDevice::NullRenderDevice()
+	: m_frameHash(NULL_DEVICE_HASH_OFFSET)
+	, m_liveBytes(0)
+	, m_bRecording(false)
+	, m_bKeepContents(false)
+	, m_boundVertexBuffer(INVALID_RENDER_HANDLE)
+	, m_boundIndexBuffer(INVALID_RENDER_HANDLE)
+	, m_boundTopology(PrimitiveTopology::TriangleList)
+	, m_bTopologyKnown(false)
+{
+}
+
+//-----------------------------------------------
+// Nothing to release
+//-----------------------------------------------
+NullRenderDevice::~NullRenderDevice()
+{
+}
+
+//-----------------------------------------------
+// "Create" a buffer - just bookkeeping
+//	- Validation matches D3D11RenderDevice, so code that
+//	  works headless does not fail on the real device
+//-----------------------------------------------
+RenderHandle NullRenderDevice::CreateBuffer(BufferType a_type, BufferUsage a_usage, const void* a_data, unsigned int a_byteSize)
+{
+	if (a_byteSize == 0 || (a_usage == BufferUsage::Immutable && a_data == nullptr))
+		return INVALID_RENDER_HANDLE;
+
+	RenderHandle handle;
+	if (!m_freeHandles.empty()) {
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+	else {
+		m_buffers.push_back(NullBuffer());
+		handle = (RenderHandle)m_buffers.size();
+	}
+
+	NullBuffer& buffer = m_buffers[handle - 1];
+	buffer.Type = a_type;
+	buffer.Usage = a_usage;
+	buffer.ByteSize = a_byteSize;
+	buffer.bIsLive = true;
+	buffer.Contents.clear();
+	if (m_bKeepContents && a_data != nullptr)
+		buffer.Contents.assign((const unsigned char*)a_data, (const unsigned char*)a_data + a_byteSize);
+
+	m_liveBytes += a_byteSize;
+	m_frameStats.BuffersCreated++;
+	Record(CommandType::CreateBuffer, handle, (unsigned int)a_type, a_byteSize);
+	return handle;
+}
+
+//-----------------------------------------------
+// Count the upload. Only Dynamic buffers may be
+// updated, same as on the GPU
+//-----------------------------------------------
+void NullRenderDevice::UpdateBuffer(RenderHandle a_buffer, const void* a_data, unsigned int a_byteSize)
+{
+	NullBuffer* buffer = GetBuffer(a_buffer);
+	if (buffer == nullptr || buffer->Usage != BufferUsage::Dynamic)
+		return;
+
+	if (m_bKeepContents)
+		buffer->Contents.assign((const unsigned char*)a_data, (const unsigned char*)a_data + a_byteSize);
+
+	m_frameStats.BufferUpdates++;
+	m_frameStats.BytesUploaded += a_byteSize;
+	Record(CommandType::UpdateBuffer, a_buffer, a_byteSize);
+}
+
+//-----------------------------------------------
+// Free the slot for reuse
+//-----------------------------------------------
+void NullRenderDevice::ReleaseBuffer(RenderHandle a_buffer)
+{
+	NullBuffer* buffer = GetBuffer(a_buffer);
+	if (buffer == nullptr)
+		return;
+
+	m_liveBytes -= buffer->ByteSize;
+	buffer->bIsLive = false;
+	buffer->Contents.clear();
+	m_freeHandles.push_back(a_buffer);
+	if (m_boundVertexBuffer == a_buffer)
+		m_boundVertexBuffer = INVALID_RENDER_HANDLE;
+	if (m_boundIndexBuffer == a_buffer)
+		m_boundIndexBuffer = INVALID_RENDER_HANDLE;
+
+	m_frameStats.BuffersReleased++;
+	Record(CommandType::ReleaseBuffer, a_buffer);
+}
+
+//-----------------------------------------------
+// Bind calls - only the cache and stats change
+//-----------------------------------------------
+void NullRenderDevice::SetVertexBuffer(RenderHandle a_buffer, unsigned int a_stride)
+{
+	if (a_buffer == m_boundVertexBuffer) {
+		m_frameStats.RedundantBindsSkipped++;
+		return;
+	}
+	m_boundVertexBuffer = a_buffer;
+	m_frameStats.VertexBufferBinds++;
+	Record(CommandType::SetVertexBuffer, a_buffer, a_stride);
+}
+
+void NullRenderDevice::SetIndexBuffer(RenderHandle a_buffer)
+{
+	if (a_buffer == m_boundIndexBuffer) {
+		m_frameStats.RedundantBindsSkipped++;
+		return;
+	}
+	m_boundIndexBuffer = a_buffer;
+	m_frameStats.IndexBufferBinds++;
+	Record(CommandType::SetIndexBuffer, a_buffer);
+}
+
+void NullRenderDevice::SetPrimitiveTopology(PrimitiveTopology a_topology)
+{
+	if (m_bTopologyKnown && a_topology == m_boundTopology) {
+		m_frameStats.RedundantBindsSkipped++;
+		return;
+	}
+	m_boundTopology = a_topology;
+	m_bTopologyKnown = true;
+	Record(CommandType::SetPrimitiveTopology, (unsigned int)a_topology);
+}
+
+void NullRenderDevice::SetConstantBuffer(ShaderStage a_stage, unsigned int a_slot, RenderHandle a_buffer)
+{
+	m_frameStats.ConstantBufferBinds++;
+	Record(CommandType::SetConstantBuffer, (unsigned int)a_stage, a_slot, a_buffer);
+}
+
+//-----------------------------------------------
+// Submission calls
+//-----------------------------------------------
+void NullRenderDevice::Draw(unsigned int a_vertexCount, unsigned int a_startVertex)
+{
+	m_frameStats.DrawCalls++;
+	m_frameStats.PrimitivesSubmitted += CountPrimitives(m_boundTopology, a_vertexCount);
+	Record(CommandType::Draw, a_vertexCount, a_startVertex);
+}
+
+void NullRenderDevice::DrawIndexed(unsigned int a_indexCount, unsigned int a_startIndex, int a_baseVertex)
+{
+	m_frameStats.IndexedDrawCalls++;
+	m_frameStats.PrimitivesSubmitted += CountPrimitives(m_boundTopology, a_indexCount);
+	Record(CommandType::DrawIndexed, a_indexCount, a_startIndex, (unsigned int)a_baseVertex);
+}
+
+void NullRenderDevice::Dispatch(unsigned int a_groupsX, unsigned int a_groupsY, unsigned int a_groupsZ)
+{
+	m_frameStats.Dispatches++;
+	Record(CommandType::Dispatch, a_groupsX, a_groupsY, a_groupsZ);
+}
+
+//-----------------------------------------------
+// New frame - drop last frame's commands and hash
+//-----------------------------------------------
+void NullRenderDevice::BeginFrame()
+{
+	RenderDevice::BeginFrame();
+	m_commands.clear();
+	m_frameHash = NULL_DEVICE_HASH_OFFSET;
+}
+
+void NullRenderDevice::InvalidateState()
+{
+	m_boundVertexBuffer = INVALID_RENDER_HANDLE;
+	m_boundIndexBuffer = INVALID_RENDER_HANDLE;
+	m_bTopologyKnown = false;
+}
+
+//-----------------------------------------------
+// CPU copy of a buffer, or nullptr if contents are
+// not being kept (or the handle is bad)
+//-----------------------------------------------
+const std::vector<unsigned char>* NullRenderDevice::GetBufferContents(RenderHandle a_buffer) const
+{
+	if (a_buffer == INVALID_RENDER_HANDLE || a_buffer > m_buffers.size() || !m_buffers[a_buffer - 1].bIsLive)
+		return nullptr;
+	return &m_buffers[a_buffer - 1].Contents;
+}
+
+//-----------------------------------------------
+// Hash every command (recording or not) and store
+// it if recording is on
+//-----------------------------------------------
+void NullRenderDevice::Record(CommandType a_type, unsigned int a_arg0, unsigned int a_arg1, unsigned int a_arg2)
+{
+	RecordedCommand command = { a_type, { a_arg0, a_arg1, a_arg2 } };
+
+	unsigned int words[4] = { (unsigned int)a_type, a_arg0, a_arg1, a_arg2 };
+	const unsigned char* bytes = (const unsigned char*)words;
+	for (unsigned int i = 0; i < sizeof(words); i++) {
+		m_frameHash ^= bytes[i];
+		m_frameHash *= NULL_DEVICE_HASH_PRIME;
+	}
+
+	if (m_bRecording)
+		m_commands.push_back(command);
+}
+
+//-----------------------------------------------
+// Handle lookup, nullptr if invalid or released
+//-----------------------------------------------
+NullRenderDevice::NullBuffer* NullRenderDevice::GetBuffer(RenderHandle a_buffer)
+{
+	if (a_buffer == INVALID_RENDER_HANDLE || a_buffer > m_buffers.size() || !m_buffers[a_buffer - 1].bIsLive)
+		return nullptr;
+	return &m_buffers[a_buffer - 1];
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+
+#include "RenderDevice.h"
+
+//-------------------------------------------------------
+// RenderDevice backend that does no GPU work at all
+//	- Buffers only exist as sizes (and optionally a CPU copy
+//	  of their contents), so meshes and constant uploads can be
+//	  created and submitted on machines without a GPU
+//	- Every call can be recorded into a command list, and a
+//	  running hash of the frame's commands is kept so that two
+//	  runs can be compared for identical submission cheaply
+//-------------------------------------------------------
+class NullRenderDevice : public RenderDevice
+{
+public:
+	// Every call that reaches the device
+	enum class CommandType {
+		CreateBuffer = 0,
+		UpdateBuffer,
+		ReleaseBuffer,
+		SetVertexBuffer,
+		SetIndexBuffer,
+		SetPrimitiveTopology,
+		SetConstantBuffer,
+		Draw,
+		DrawIndexed,
+		Dispatch
+	};
+
+	// A recorded call with up to 3 integer arguments (meaning depends on Type)
+	struct RecordedCommand {
+		CommandType Type;
+		unsigned int Args[3];
+	};
+
+	NullRenderDevice();
+	~NullRenderDevice();
+
+	const char* GetName() const override { return "Null"; }
+
+	RenderHandle CreateBuffer(BufferType a_type, BufferUsage a_usage, const void* a_data, unsigned int a_byteSize) override;
+	void UpdateBuffer(RenderHandle a_buffer, const void* a_data, unsigned int a_byteSize) override;
+	void ReleaseBuffer(RenderHandle a_buffer) override;
+
+	void SetVertexBuffer(RenderHandle a_buffer, unsigned int a_stride) override;
+	void SetIndexBuffer(RenderHandle a_buffer) override;
+	void SetPrimitiveTopology(PrimitiveTopology a_topology) override;
+	void SetConstantBuffer(ShaderStage a_stage, unsigned int a_slot, RenderHandle a_buffer) override;
+
+	void Draw(unsigned int a_vertexCount, unsigned int a_startVertex) override;
+	void DrawIndexed(unsigned int a_indexCount, unsigned int a_startIndex, int a_baseVertex) override;
+	void Dispatch(unsigned int a_groupsX, unsigned int a_groupsY, unsigned int a_groupsZ) override;
+
+	void BeginFrame() override;
+	void InvalidateState() override;
+
+	// Recording options. Recording is off by default, since it allocates per call
+	void SetRecording(bool a_bRecord) { m_bRecording = a_bRecord; }
+	void SetKeepBufferContents(bool a_bKeep) { m_bKeepContents = a_bKeep; }
+
+	const std::vector<RecordedCommand>& GetRecordedCommands() const { return m_commands; }
+	unsigned long long GetFrameCommandHash() const { return m_frameHash; }
+	unsigned long long GetLiveBufferBytes() const { return m_liveBytes; }
+	const std::vector<unsigned char>* GetBufferContents(RenderHandle a_buffer) const;
+
+private:
+	struct NullBuffer {
+		BufferType Type;
+		BufferUsage Usage;
+		unsigned int ByteSize;
+		bool bIsLive;
+		std::vector<unsigned char> Contents; // Only filled with SetKeepBufferContents(true)
+	};
+
+	void Record(CommandType a_type, unsigned int a_arg0 = 0, unsigned int a_arg1 = 0, unsigned int a_arg2 = 0);
+	NullBuffer* GetBuffer(RenderHandle a_buffer);
+
+	std::vector<NullBuffer> m_buffers; // Handle N lives at index N - 1
+	std::vector<RenderHandle> m_freeHandles;
+	std::vector<RecordedCommand> m_commands;
+	unsigned long long m_frameHash;
+	unsigned long long m_liveBytes;
+	bool m_bRecording;
+	bool m_bKeepContents;
+
+	// Bind caching mirrors D3D11RenderDevice, so stats match between the two backends
+	RenderHandle m_boundVertexBuffer;
+	RenderHandle m_boundIndexBuffer;
+	PrimitiveTopology m_boundTopology;
+	bool m_bTopologyKnown;
+};
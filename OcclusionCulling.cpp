@@ -0,0 +1,379 @@
+#include "OcclusionCulling.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+// SSE is baseline on every x64 target, and on x86 when building with /arch:SSE2 or -msse2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SSE 1
+#include <emmintrin.h>
+#else
+#define OCCLUSION_SSE 0
+#endif
+
+#define OCCLUSION_MIN_AREA 1e-6f // Twice the pixel area below which triangles are skipped
+#define OCCLUSION_TEST_GRAIN 64 // Boxes per job
+
+namespace
+{
+	// Intersection of a clip space edge with the z = 0 (D3D near) plane
+	Vector4 ClipToNearPlane(const Vector4& a_inside, const Vector4& a_outside)
+	{
+		float t = a_inside.z / (a_inside.z - a_outside.z);
+		return Vector4(
+			a_inside.x + (a_outside.x - a_inside.x) * t,
+			a_inside.y + (a_outside.y - a_inside.y) * t,
+			0.f,
+			a_inside.w + (a_outside.w - a_inside.w) * t);
+	}
+
+	Vector4 TransformPoint(float a_x, float a_y, float a_z, const Matrix4& a_m)
+	{
+		return Vector4(
+			a_x * a_m._11 + a_y * a_m._21 + a_z * a_m._31 + a_m._41,
+			a_x * a_m._12 + a_y * a_m._22 + a_z * a_m._32 + a_m._42,
+			a_x * a_m._13 + a_y * a_m._23 + a_z * a_m._33 + a_m._43,
+			a_x * a_m._14 + a_y * a_m._24 + a_z * a_m._34 + a_m._44);
+	}
+
+	// Edge and depth functions of a counter-clockwise (in pixel space) triangle, as A * x + B * y + C
+	struct TriangleSetup {
+		float EdgeA[3];
+		float EdgeB[3];
+		float EdgeC[3];
+		float DepthA;
+		float DepthB;
+		float DepthC;
+		int MinX;
+		int MaxX;
+		int MinY;
+		int MaxY;
+	};
+
+	bool SetupTriangle(const OcclusionTriangle& a_triangle, int a_width, int a_rowBegin, int a_rowEnd, TriangleSetup& a_setup)
+	{
+		float x[3] = { a_triangle.X[0], a_triangle.X[1], a_triangle.X[2] };
+		float y[3] = { a_triangle.Y[0], a_triangle.Y[1], a_triangle.Y[2] };
+		float z[3] = { a_triangle.Z[0], a_triangle.Z[1], a_triangle.Z[2] };
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (std::fabs(area) < OCCLUSION_MIN_AREA)
+			return false;
+		if (area < 0.f) {
+			// Occluders are double sided, so flip to a consistent winding
+			std::swap(x[1], x[2]);
+			std::swap(y[1], y[2]);
+			std::swap(z[1], z[2]);
+			area = -area;
+		}
+
+		// Edge i is opposite vertex i, so its value over the area is that vertex's barycentric weight
+		for (int i = 0; i < 3; i++) {
+			int a = (i + 1) % 3;
+			int b = (i + 2) % 3;
+			a_setup.EdgeA[i] = -(y[b] - y[a]);
+			a_setup.EdgeB[i] = x[b] - x[a];
+			a_setup.EdgeC[i] = -(a_setup.EdgeA[i] * x[a] + a_setup.EdgeB[i] * y[a]);
+		}
+		float inverseArea = 1.f / area;
+		a_setup.DepthA = (a_setup.EdgeA[0] * z[0] + a_setup.EdgeA[1] * z[1] + a_setup.EdgeA[2] * z[2]) * inverseArea;
+		a_setup.DepthB = (a_setup.EdgeB[0] * z[0] + a_setup.EdgeB[1] * z[1] + a_setup.EdgeB[2] * z[2]) * inverseArea;
+		a_setup.DepthC = (a_setup.EdgeC[0] * z[0] + a_setup.EdgeC[1] * z[1] + a_setup.EdgeC[2] * z[2]) * inverseArea;
+
+		a_setup.MinX = std::max(0, (int)std::floor(std::min(x[0], std::min(x[1], x[2]))));
+		a_setup.MaxX = std::min(a_width - 1, (int)std::ceil(std::max(x[0], std::max(x[1], x[2]))));
+		a_setup.MinY = std::max(a_rowBegin, (int)std::floor(std::min(y[0], std::min(y[1], y[2]))));
+		a_setup.MaxY = std::min(a_rowEnd - 1, (int)std::ceil(std::max(y[0], std::max(y[1], y[2]))));
+		return a_setup.MinX <= a_setup.MaxX && a_setup.MinY <= a_setup.MaxY;
+	}
+}
+
+OcclusionBuffer::OcclusionBuffer(unsigned int a_width, unsigned int a_height)
+	: m_width(0)
+	, m_height(0)
+	, m_tilesX(0)
+	, m_tilesY(0)
+	, m_triangleCount(0)
+{
+	Resize(a_width, a_height);
+}
+
+void OcclusionBuffer::Resize(unsigned int a_width, unsigned int a_height)
+{
+	m_tilesX = (a_width + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE;
+	m_tilesY = (a_height + OCCLUSION_TILE_SIZE - 1) / OCCLUSION_TILE_SIZE;
+	m_tilesX = m_tilesX > 0 ? m_tilesX : 1;
+	m_tilesY = m_tilesY > 0 ? m_tilesY : 1;
+	m_width = m_tilesX * OCCLUSION_TILE_SIZE;
+	m_height = m_tilesY * OCCLUSION_TILE_SIZE;
+	m_depth.resize((size_t)m_width * m_height);
+	m_tileMaxDepth.resize((size_t)m_tilesX * m_tilesY);
+	m_bins.resize(m_tilesY);
+	Clear();
+}
+
+void OcclusionBuffer::Clear()
+{
+	std::fill(m_depth.begin(), m_depth.end(), 1.f);
+	std::fill(m_tileMaxDepth.begin(), m_tileMaxDepth.end(), 1.f);
+	for (std::vector<OcclusionTriangle>& bin : m_bins) {
+		bin.clear();
+	}
+	m_triangleCount = 0;
+}
+
+//-------------------------------------------------------
+// Transforms every vertex once, then clips, projects and
+// bins each triangle
+//-------------------------------------------------------
+void OcclusionBuffer::AddOccluder(const Vector3* a_positions, unsigned int a_positionCount, unsigned int a_stride,
+	const unsigned int* a_indices, unsigned int a_indexCount, const Matrix4& a_worldViewProjection)
+{
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(a_positions);
+	m_clipScratch.resize(a_positionCount);
+	for (unsigned int i = 0; i < a_positionCount; i++) {
+		const Vector3& position = *reinterpret_cast<const Vector3*>(bytes + (size_t)i * a_stride);
+		m_clipScratch[i] = TransformPoint(position.x, position.y, position.z, a_worldViewProjection);
+	}
+
+	for (unsigned int i = 0; i + 2 < a_indexCount; i += 3) {
+		const Vector4& v0 = m_clipScratch[a_indices[i]];
+		const Vector4& v1 = m_clipScratch[a_indices[i + 1]];
+		const Vector4& v2 = m_clipScratch[a_indices[i + 2]];
+
+		// Trivially outside one of the frustum planes
+		if ((v0.x > v0.w && v1.x > v1.w && v2.x > v2.w) || (v0.x < -v0.w && v1.x < -v1.w && v2.x < -v2.w)
+			|| (v0.y > v0.w && v1.y > v1.w && v2.y > v2.w) || (v0.y < -v0.w && v1.y < -v1.w && v2.y < -v2.w)
+			|| (v0.z > v0.w && v1.z > v1.w && v2.z > v2.w) || (v0.z < 0.f && v1.z < 0.f && v2.z < 0.f))
+			continue;
+
+		if (v0.z >= 0.f && v1.z >= 0.f && v2.z >= 0.f) {
+			BinTriangle(v0, v1, v2);
+			continue;
+		}
+
+		// Sutherland-Hodgman against the near plane only, giving 3 or 4 vertices. The other planes are
+		// handled by clamping to the screen while rasterizing
+		const Vector4* input[3] = { &v0, &v1, &v2 };
+		Vector4 polygon[4];
+		int polygonCount = 0;
+		for (int edge = 0; edge < 3; edge++) {
+			const Vector4& a = *input[edge];
+			const Vector4& b = *input[(edge + 1) % 3];
+			bool bAInside = a.z >= 0.f;
+			bool bBInside = b.z >= 0.f;
+			if (bAInside != bBInside)
+				polygon[polygonCount++] = bAInside ? ClipToNearPlane(a, b) : ClipToNearPlane(b, a);
+			if (bBInside)
+				polygon[polygonCount++] = b;
+		}
+		for (int vertex = 2; vertex < polygonCount; vertex++) {
+			BinTriangle(polygon[0], polygon[vertex - 1], polygon[vertex]);
+		}
+	}
+}
+
+void OcclusionBuffer::BinTriangle(const Vector4& a_v0, const Vector4& a_v1, const Vector4& a_v2)
+{
+	const Vector4* vertices[3] = { &a_v0, &a_v1, &a_v2 };
+	OcclusionTriangle triangle;
+	float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f;
+	for (int i = 0; i < 3; i++) {
+		const Vector4& v = *vertices[i];
+		if (v.w <= 1e-7f)
+			return;
+		float inverseW = 1.f / v.w;
+		triangle.X[i] = (v.x * inverseW * 0.5f + 0.5f) * m_width;
+		triangle.Y[i] = (0.5f - v.y * inverseW * 0.5f) * m_height;
+		triangle.Z[i] = v.z * inverseW;
+		minX = std::fmin(minX, triangle.X[i]);
+		maxX = std::fmax(maxX, triangle.X[i]);
+		minY = std::fmin(minY, triangle.Y[i]);
+		maxY = std::fmax(maxY, triangle.Y[i]);
+	}
+	if (maxX < 0.f || maxY < 0.f || minX >= (float)m_width || minY >= (float)m_height)
+		return;
+
+	int firstBin = std::max(0, (int)std::floor(minY)) / OCCLUSION_TILE_SIZE;
+	int lastBin = std::min((int)m_height - 1, (int)std::ceil(maxY)) / OCCLUSION_TILE_SIZE;
+	for (int bin = firstBin; bin <= lastBin; bin++) {
+		m_bins[bin].push_back(triangle);
+	}
+	m_triangleCount++;
+}
+
+//-------------------------------------------------------
+// Bins are independent rows of the buffer, so each runs
+// as a separate job
+//-------------------------------------------------------
+void OcclusionBuffer::Rasterize(bool a_bMultithreaded, bool a_bUseSIMD)
+{
+	if (a_bMultithreaded) {
+		JobSystem::GetInstance().ParallelFor(m_tilesY, 1, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int bin = a_begin; bin < a_end; bin++) {
+				RasterizeBin(bin, a_bUseSIMD);
+			}
+		});
+	}
+	else {
+		for (unsigned int bin = 0; bin < m_tilesY; bin++) {
+			RasterizeBin(bin, a_bUseSIMD);
+		}
+	}
+}
+
+//-------------------------------------------------------
+// Pixel centres inside all three edges (edges included,
+// so shared edges are covered twice rather than missed)
+// keep the nearer depth. Depth is affine in screen space
+// after the divide, so it is a plane like the edges
+//-------------------------------------------------------
+void OcclusionBuffer::RasterizeBin(unsigned int a_bin, bool a_bUseSIMD)
+{
+	int rowBegin = a_bin * OCCLUSION_TILE_SIZE;
+	int rowEnd = rowBegin + OCCLUSION_TILE_SIZE;
+	for (const OcclusionTriangle& triangle : m_bins[a_bin]) {
+		TriangleSetup setup;
+		if (!SetupTriangle(triangle, (int)m_width, rowBegin, rowEnd, setup))
+			continue;
+
+		for (int y = setup.MinY; y <= setup.MaxY; y++) {
+			float pixelY = y + 0.5f;
+			float rowEdge[3];
+			for (int i = 0; i < 3; i++) {
+				rowEdge[i] = setup.EdgeB[i] * pixelY + setup.EdgeC[i];
+			}
+			float rowDepth = setup.DepthB * pixelY + setup.DepthC;
+			float* depthRow = &m_depth[(size_t)y * m_width];
+			int x = setup.MinX;
+#if OCCLUSION_SSE
+			if (a_bUseSIMD) {
+				// Width is a multiple of the tile size, so 4 aligned pixels never run past the row
+				x &= ~3;
+				__m128 edgeA0 = _mm_set1_ps(setup.EdgeA[0]), edgeA1 = _mm_set1_ps(setup.EdgeA[1]), edgeA2 = _mm_set1_ps(setup.EdgeA[2]);
+				__m128 rowEdge0 = _mm_set1_ps(rowEdge[0]), rowEdge1 = _mm_set1_ps(rowEdge[1]), rowEdge2 = _mm_set1_ps(rowEdge[2]);
+				__m128 depthA = _mm_set1_ps(setup.DepthA), depthRow4 = _mm_set1_ps(rowDepth);
+				__m128 zero = _mm_setzero_ps();
+				for (; x <= setup.MaxX; x += 4) {
+					__m128 pixelX = _mm_add_ps(_mm_set1_ps(x + 0.5f), _mm_set_ps(3.f, 2.f, 1.f, 0.f));
+					__m128 e0 = _mm_add_ps(_mm_mul_ps(edgeA0, pixelX), rowEdge0);
+					__m128 e1 = _mm_add_ps(_mm_mul_ps(edgeA1, pixelX), rowEdge1);
+					__m128 e2 = _mm_add_ps(_mm_mul_ps(edgeA2, pixelX), rowEdge2);
+					__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+					if (_mm_movemask_ps(inside) == 0)
+						continue;
+
+					__m128 depth = _mm_add_ps(_mm_mul_ps(depthA, pixelX), depthRow4);
+					__m128 current = _mm_loadu_ps(depthRow + x);
+					__m128 nearest = _mm_min_ps(current, depth);
+					_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+				}
+				continue;
+			}
+#endif
+			for (; x <= setup.MaxX; x++) {
+				float pixelX = x + 0.5f;
+				if (setup.EdgeA[0] * pixelX + rowEdge[0] >= 0.f && setup.EdgeA[1] * pixelX + rowEdge[1] >= 0.f
+					&& setup.EdgeA[2] * pixelX + rowEdge[2] >= 0.f) {
+					float depth = setup.DepthA * pixelX + rowDepth;
+					depthRow[x] = std::min(depthRow[x], depth);
+				}
+			}
+		}
+	}
+
+	// Farthest depth of each tile in this row
+	for (unsigned int tileX = 0; tileX < m_tilesX; tileX++) {
+		float farthest = 0.f;
+		for (int y = rowBegin; y < rowEnd; y++) {
+			const float* depthRow = &m_depth[(size_t)y * m_width + tileX * OCCLUSION_TILE_SIZE];
+			for (int x = 0; x < OCCLUSION_TILE_SIZE; x++) {
+				farthest = std::max(farthest, depthRow[x]);
+			}
+		}
+		m_tileMaxDepth[a_bin * m_tilesX + tileX] = farthest;
+	}
+}
+
+void OcclusionBuffer::TestBoxes(const std::vector<AABB>& a_boxes, const Matrix4& a_viewProjection, std::vector<unsigned char>& a_visible,
+	bool a_bMultithreaded, bool a_bUseSIMD) const
+{
+	a_visible.resize(a_boxes.size());
+	auto testRange = [&](unsigned int a_begin, unsigned int a_end) {
+		for (unsigned int i = a_begin; i < a_end; i++) {
+			a_visible[i] = IsVisible(a_boxes[i], a_viewProjection, a_bUseSIMD) ? 1 : 0;
+		}
+	};
+	if (a_bMultithreaded)
+		JobSystem::GetInstance().ParallelFor((unsigned int)a_boxes.size(), OCCLUSION_TEST_GRAIN, testRange);
+	else
+		testRange(0, (unsigned int)a_boxes.size());
+}
+
+//-------------------------------------------------------
+// The box's screen rect at its nearest depth is compared
+// against the tiles, then the pixels of undecided tiles
+//-------------------------------------------------------
+bool OcclusionBuffer::IsVisible(const AABB& a_box, const Matrix4& a_viewProjection, bool a_bUseSIMD) const
+{
+	float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f, minZ = 1e30f;
+	for (int corner = 0; corner < 8; corner++) {
+		Vector4 clip = TransformPoint(
+			(corner & 1) ? a_box.Max.x : a_box.Min.x,
+			(corner & 2) ? a_box.Max.y : a_box.Min.y,
+			(corner & 4) ? a_box.Max.z : a_box.Min.z,
+			a_viewProjection);
+		if (clip.z < 0.f || clip.w <= 1e-7f)
+			return true; // Crosses the near plane
+
+		float inverseW = 1.f / clip.w;
+		float x = (clip.x * inverseW * 0.5f + 0.5f) * m_width;
+		float y = (0.5f - clip.y * inverseW * 0.5f) * m_height;
+		minX = std::fmin(minX, x);
+		maxX = std::fmax(maxX, x);
+		minY = std::fmin(minY, y);
+		maxY = std::fmax(maxY, y);
+		minZ = std::fmin(minZ, clip.z * inverseW);
+	}
+	if (maxX <= 0.f || maxY <= 0.f || minX >= (float)m_width || minY >= (float)m_height)
+		return true; // Off screen is the frustum test's decision, not this one's
+
+	// Every pixel the rect touches
+	int x0 = std::max(0, (int)std::floor(minX));
+	int y0 = std::max(0, (int)std::floor(minY));
+	int x1 = std::min((int)m_width - 1, std::max(x0, (int)std::ceil(maxX) - 1));
+	int y1 = std::min((int)m_height - 1, std::max(y0, (int)std::ceil(maxY) - 1));
+
+	for (int tileY = y0 / OCCLUSION_TILE_SIZE; tileY <= y1 / OCCLUSION_TILE_SIZE; tileY++) {
+		for (int tileX = x0 / OCCLUSION_TILE_SIZE; tileX <= x1 / OCCLUSION_TILE_SIZE; tileX++) {
+			if (minZ > m_tileMaxDepth[tileY * m_tilesX + tileX])
+				continue; // Behind everything in the tile
+
+			int pixelX0 = std::max(x0, tileX * OCCLUSION_TILE_SIZE);
+			int pixelX1 = std::min(x1, tileX * OCCLUSION_TILE_SIZE + OCCLUSION_TILE_SIZE - 1);
+			int pixelY0 = std::max(y0, tileY * OCCLUSION_TILE_SIZE);
+			int pixelY1 = std::min(y1, tileY * OCCLUSION_TILE_SIZE + OCCLUSION_TILE_SIZE - 1);
+			if (pixelX1 - pixelX0 == OCCLUSION_TILE_SIZE - 1 && pixelY1 - pixelY0 == OCCLUSION_TILE_SIZE - 1)
+				return true; // Whole tile covered, and its farthest pixel is behind the box
+
+			for (int y = pixelY0; y <= pixelY1; y++) {
+				const float* depthRow = &m_depth[(size_t)y * m_width];
+				int x = pixelX0;
+#if OCCLUSION_SSE
+				if (a_bUseSIMD) {
+					__m128 boxDepth = _mm_set1_ps(minZ);
+					for (; x + 3 <= pixelX1; x += 4) {
+						if (_mm_movemask_ps(_mm_cmple_ps(boxDepth, _mm_loadu_ps(depthRow + x))) != 0)
+							return true;
+					}
+				}
+#endif
+				for (; x <= pixelX1; x++) {
+					if (minZ <= depthRow[x])
+						return true;
+				}
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+
+#include "Types.h"
+#include "Culling.h"
+
+#define OCCLUSION_DEFAULT_WIDTH 256 // Depth buffer width. Height follows the window's aspect ratio
+#define OCCLUSION_DEFAULT_HEIGHT 128
+#define OCCLUSION_TILE_SIZE 8 // Pixels per side of a hierarchical depth tile. Each row of tiles is one job bin
+
+//-------------------------------------------------------
+// Screen space occluder triangle, binned by tile row
+//-------------------------------------------------------
+struct OcclusionTriangle {
+	float X[3];
+	float Y[3];
+	float Z[3]; // Post-projection depth, 0 near 1 far
+};
+
+//-------------------------------------------------------
+// Software occlusion culling on a small CPU depth buffer
+//	- AddOccluder transforms, near-clips and projects an
+//	  occluder's triangles, then bins them into every tile
+//	  row they touch
+//	- Rasterize fills each bin as its own job (rows never
+//	  overlap, so no locking), keeping the nearest depth
+//	  per pixel, 4 pixels per SSE edge/depth evaluation.
+//	  Each bin then records the farthest depth of every
+//	  8x8 tile, the hierarchical level tests start from
+//	- TestBoxes projects world boxes and reports a box
+//	  hidden only if its nearest depth is behind the
+//	  buffer at every pixel its screen rect covers. Tiles
+//	  are rejected with one compare, and pixels are only
+//	  read for tiles that can't be decided
+//	- Conservative: anything crossing the near plane, and
+//	  pixels no occluder covers, count as visible
+//-------------------------------------------------------
+class OcclusionBuffer
+{
+public:
+	OcclusionBuffer(unsigned int a_width = OCCLUSION_DEFAULT_WIDTH, unsigned int a_height = OCCLUSION_DEFAULT_HEIGHT);
+
+	// Sizes are rounded up to whole tiles
+	void Resize(unsigned int a_width, unsigned int a_height);
+
+	// Far depth everywhere, and no binned triangles
+	void Clear();
+
+	// a_positions are a_stride bytes apart (so Vertex arrays work directly). Matrix is World * View * Projection
+	void AddOccluder(const Vector3* a_positions, unsigned int a_positionCount, unsigned int a_stride,
+		const unsigned int* a_indices, unsigned int a_indexCount, const Matrix4& a_worldViewProjection);
+
+	// Rasterize every binned triangle and rebuild the tile depths
+	void Rasterize(bool a_bMultithreaded, bool a_bUseSIMD);
+
+	// a_visible[i] is 1 unless a_boxes[i] is fully hidden. Boxes are world space, matrix is View * Projection
+	void TestBoxes(const std::vector<AABB>& a_boxes, const Matrix4& a_viewProjection, std::vector<unsigned char>& a_visible,
+		bool a_bMultithreaded, bool a_bUseSIMD) const;
+	bool IsVisible(const AABB& a_box, const Matrix4& a_viewProjection, bool a_bUseSIMD) const;
+
+	// Getters
+	unsigned int GetWidth() const { return m_width; }
+	unsigned int GetHeight() const { return m_height; }
+	unsigned int GetTriangleCount() const { return m_triangleCount; } // Since the last Clear, after clipping
+	const std::vector<float>& GetDepth() const { return m_depth; } // Row major, m_width per row
+	const std::vector<float>& GetTileDepth() const { return m_tileMaxDepth; }
+
+private:
+	unsigned int m_width;
+	unsigned int m_height;
+	unsigned int m_tilesX;
+	unsigned int m_tilesY;
+	unsigned int m_triangleCount;
+	std::vector<float> m_depth;
+	std::vector<float> m_tileMaxDepth; // Farthest depth in each tile
+	std::vector<std::vector<OcclusionTriangle>> m_bins; // One per tile row
+	std::vector<Vector4> m_clipScratch; // Clip space positions of the occluder being added
+
+	void BinTriangle(const Vector4& a_v0, const Vector4& a_v1, const Vector4& a_v2);
+	void RasterizeBin(unsigned int a_bin, bool a_bUseSIMD);
+};
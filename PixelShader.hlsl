@@ -19,6 +19,8 @@ cbuffer PixelConstantData : register(b0)
 	float  c_roughnessScale; // Inverse shininess of the object
 	float2 c_uvOffset; // Universal Offset for the UVs
 	float  c_uvScale; // Universal Scale for the UVs
+	float3 c_ormConstants; // Occlusion, roughness and metalness for the channels ORMTexture doesn't hold
+	float3 c_ormTextured; // 1 for each channel ORMTexture holds, else 0
 }
 
 // Struct representing constant lighting data (ambient color and generic light) for all pixels
@@ -29,15 +31,14 @@ cbuffer PixelLightingData : register(b1)
 	Light c_pointLights[MAX_LIGHTS_OF_SINGLE_TYPE]; // Sample point lights
 	int c_directionalLightCount; // 4-bytes from boundary
 	int c_pointLightCount; // 8-bytes
+	float4 c_irradianceSH[9]; // IBL diffuse irradiance as SH coefficients (rgb), see Sky::CreateIrradianceSH
 }
 
 // Textures and Samplers
 Texture2D AlbedoTexture : register(t0); // PBR Albedo
 Texture2D NormalTexture : register(t1); // Normal Map
-Texture2D RoughnessTexture : register(t2); // PBR Roughness Map
-Texture2D MetalnessTexture : register(t3); // PBR Metalness Map
+Texture2D ORMTexture : register(t2); // PBR Occlusion, Roughness and Metalness in R, G and B
 
-TextureCube IrradianceMap : register(t4); // IBL Irradiance Map for Diffuse Light
 TextureCube ReflectionMap : register(t5); // IBL Specular Reflection Map (1/2 Split Sum Approximation)
 Texture2D BRDFIntegrationMap : register(t6); // IBL Specular Reflection BRDF Lookup Table
 
@@ -98,15 +99,23 @@ float4 main(VertexToPixel input) : SV_TARGET
 	float3 albedoColor = AlbedoTexture.Sample(BasicSampler, input.uv).rgb; // Alpha channel is unused here
 	albedoColor = pow(albedoColor, 2.2f) * c_color.rgb; // Reverse embedded image Gamma Correction before lighting is applied (only done for surface color texture)
 
-	float roughnessValue = RoughnessTexture.Sample(BasicSampler, input.uv).r; // Possibly should be saturated
+	// Constant channels come from the Material, so a Material without any textured channel skips the fetch entirely
+	float3 orm = c_ormConstants;
+	[branch] if (any(c_ormTextured))
+		orm = lerp(orm, ORMTexture.Sample(BasicSampler, input.uv).rgb, c_ormTextured);
+	float occlusionValue = orm.r; // Only shadows indirect light, as direct light has its own visibility
+	float roughnessValue = orm.g; // Possibly should be saturated
 	roughnessValue *= 1.f - c_roughnessScale; // This is in place to make demoing IBL textures easier, removing the need for a material/texture per roughness level
-	float metalnessValue = MetalnessTexture.Sample(BasicSampler, input.uv).r; // Probably should be saturated
+	float metalnessValue = orm.b; // Probably should be saturated
 
 	// For metals, specular is actually just the albedo. Lerp is used because filtering the texture can result in Metalness Values of not 0 or 1
 	float3 specularColor = lerp(F0_NON_METAL.rrr, albedoColor, metalnessValue); // F0_NON_METAL defined in ShaderHelpers.h
 
 	// Calculate Normal modifier, and assign to input value for ease of lighting
-	float3 unpackedNormal = NormalTexture.Sample(BasicSampler, input.uv).rgb * 2 - 1; // [0, 1] -> [-1, 1]
+	// Only x and y are read, as BC5 normal maps store nothing else, and z is rebuilt from them (always facing out)
+	float3 unpackedNormal;
+	unpackedNormal.xy = NormalTexture.Sample(BasicSampler, input.uv).rg * 2 - 1; // [0, 1] -> [-1, 1]
+	unpackedNormal.z = sqrt(saturate(1 - dot(unpackedNormal.xy, unpackedNormal.xy)));
 	float3 biTangent = cross(input.normal, input.tangent);
 	float3x3 TBN = float3x3(input.tangent, biTangent, input.normal);
 	input.normal = mul(normalize(unpackedNormal), TBN);
@@ -128,13 +137,15 @@ float4 main(VertexToPixel input) : SV_TARGET
 	}
 
 	// Calculate IBL Light
-	float3 indirectDiffuse = pow(abs(IrradianceMap.Sample(BasicSampler, input.normal).rgb), 2.2f);
+	float3 indirectDiffuse = EvaluateIrradianceSH(c_irradianceSH, input.normal);
 	//indirectDiffuse = ConserveDiffuseEnergy(indirectDiffuse, specularColor, metalnessValue);
 
 	//return ReflectionMap.SampleLevel(BasicSampler, input.normal, roughnessValue * 5); // TESTING to display IBLSpecMap
 	float3 indirectSpecular = SpecularIBLApproximation(specularColor, roughnessValue, input.normal, cameraVector);
 	//return float4(indirectSpecular, 1); TESTING - display only indirect specular
 	indirectDiffuse = ConserveDiffuseEnergy(indirectDiffuse, indirectSpecular, metalnessValue);
+	indirectDiffuse *= occlusionValue;
+	indirectSpecular *= occlusionValue;
 
 	float3 indirectSum = indirectSpecular + (indirectDiffuse * albedoColor);
 
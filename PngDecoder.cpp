@@ -0,0 +1,931 @@
+#include "PngDecoder.h"
+#include "AssetFiles.h"
+
+#include <cstring>
+#include <memory>
+
+// SSE is baseline on every x64 target, and on x86 when building with /arch:SSE2 or -msse2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PNG_SSE 1
+#include <emmintrin.h>
+#else
+#define PNG_SSE 0
+#endif
+
+#define INFLATE_FAST_BITS 10 // Codes up to this long resolve with a single table lookup
+#define INFLATE_MAX_BITS 15
+
+// Chunk types, as big endian integers
+#define PNG_CHUNK_IHDR 0x49484452u
+#define PNG_CHUNK_PLTE 0x504C5445u
+#define PNG_CHUNK_TRNS 0x74524E53u
+#define PNG_CHUNK_IDAT 0x49444154u
+#define PNG_CHUNK_IEND 0x49454E44u
+
+namespace
+{
+	const uint8_t s_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	// Adam7 pass origins and steps
+	const unsigned int s_adam7X[7] = { 0, 4, 0, 2, 0, 1, 0 };
+	const unsigned int s_adam7Y[7] = { 0, 0, 4, 0, 2, 0, 1 };
+	const unsigned int s_adam7StepX[7] = { 8, 8, 4, 4, 2, 2, 1 };
+	const unsigned int s_adam7StepY[7] = { 8, 8, 8, 4, 4, 2, 2 };
+
+	// Deflate length and distance symbol bases and extra bits
+	const uint16_t s_lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t s_lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t s_distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+		4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t s_distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	const uint8_t s_codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	uint32_t ReadBigEndian32(const uint8_t* a_data)
+	{
+		return ((uint32_t)a_data[0] << 24) | ((uint32_t)a_data[1] << 16) | ((uint32_t)a_data[2] << 8) | a_data[3];
+	}
+
+	//-------------------------------------------
+	// Canonical Huffman decoding table
+	//	- Fast is indexed by the next FAST_BITS
+	//	  bits of the stream and holds
+	//	  (length << 9) | symbol, or 0 when the
+	//	  code is longer
+	//	- Longer codes are found by comparing the
+	//	  bit-reversed stream against each
+	//	  length's largest code
+	//-------------------------------------------
+	struct Huffman {
+		uint16_t Fast[1 << INFLATE_FAST_BITS];
+		uint32_t MaxCode[INFLATE_MAX_BITS + 2]; // Left aligned to 16 bits, exclusive
+		uint16_t FirstCode[INFLATE_MAX_BITS + 1];
+		uint16_t FirstSymbol[INFLATE_MAX_BITS + 1];
+		uint8_t Lengths[288]; // Sorted by code
+		uint16_t Symbols[288];
+	};
+
+	unsigned int ReverseBits(unsigned int a_value, unsigned int a_bits)
+	{
+		unsigned int reversed = 0;
+		for (unsigned int i = 0; i < a_bits; i++) {
+			reversed = (reversed << 1) | (a_value & 1);
+			a_value >>= 1;
+		}
+		return reversed;
+	}
+
+	bool BuildHuffman(Huffman& a_table, const uint8_t* a_lengths, unsigned int a_count)
+	{
+		unsigned int lengthCounts[INFLATE_MAX_BITS + 1] = {};
+		for (unsigned int i = 0; i < a_count; i++) {
+			lengthCounts[a_lengths[i]]++;
+		}
+		lengthCounts[0] = 0;
+		std::memset(a_table.Fast, 0, sizeof(a_table.Fast));
+
+		unsigned int nextCode[INFLATE_MAX_BITS + 1] = {};
+		unsigned int code = 0;
+		unsigned int symbol = 0;
+		for (unsigned int length = 1; length <= INFLATE_MAX_BITS; length++) {
+			nextCode[length] = code;
+			a_table.FirstCode[length] = (uint16_t)code;
+			a_table.FirstSymbol[length] = (uint16_t)symbol;
+			code += lengthCounts[length];
+			if (lengthCounts[length] != 0 && code - 1 >= (1u << length))
+				return false; // Over-subscribed
+			a_table.MaxCode[length] = code << (16 - length);
+			code <<= 1;
+			symbol += lengthCounts[length];
+		}
+		a_table.MaxCode[INFLATE_MAX_BITS + 1] = 0x10000;
+
+		for (unsigned int i = 0; i < a_count; i++) {
+			unsigned int length = a_lengths[i];
+			if (length == 0)
+				continue;
+			unsigned int slot = nextCode[length] - a_table.FirstCode[length] + a_table.FirstSymbol[length];
+			a_table.Lengths[slot] = (uint8_t)length;
+			a_table.Symbols[slot] = (uint16_t)i;
+			if (length <= INFLATE_FAST_BITS) {
+				uint16_t entry = (uint16_t)((length << 9) | i);
+				for (unsigned int fill = ReverseBits(nextCode[length], length); fill < (1u << INFLATE_FAST_BITS); fill += (1u << length)) {
+					a_table.Fast[fill] = entry;
+				}
+			}
+			nextCode[length]++;
+		}
+		return true;
+	}
+
+	//-------------------------------------------
+	// Little endian bit stream over the zlib
+	// data, kept topped up to at least 56 bits.
+	// Reads past the end produce zeros, which
+	// Overran() then reports
+	//-------------------------------------------
+	struct BitReader {
+		const uint8_t* Data;
+		size_t Size;
+		size_t Position = 0; // Next byte to load, can run past Size
+		uint64_t Bits = 0;
+		unsigned int Count = 0;
+
+		void Refill()
+		{
+			if (Position + 8 <= Size) {
+				uint64_t word;
+				std::memcpy(&word, Data + Position, 8); // Assumes a little endian host, as every D3D target is
+				Bits |= word << Count;
+				Position += (63 - Count) >> 3;
+				Count |= 56;
+				return;
+			}
+			while (Count <= 56) {
+				uint64_t byte = Position < Size ? Data[Position] : 0;
+				Bits |= byte << Count;
+				Position++;
+				Count += 8;
+			}
+		}
+
+		unsigned int Read(unsigned int a_bits)
+		{
+			unsigned int value = (unsigned int)(Bits & ((1ull << a_bits) - 1));
+			Bits >>= a_bits;
+			Count -= a_bits;
+			return value;
+		}
+
+		// True once more bits were consumed than the input holds
+		bool Overran() const
+		{
+			return Position * 8 - Count > Size * 8;
+		}
+	};
+
+	// Decode one symbol. Needs at least 15 bits buffered. Returns -1 on an invalid code
+	int DecodeSymbol(BitReader& a_reader, const Huffman& a_table)
+	{
+		uint16_t entry = a_table.Fast[a_reader.Bits & ((1u << INFLATE_FAST_BITS) - 1)];
+		if (entry != 0) {
+			a_reader.Read(entry >> 9);
+			return entry & 511;
+		}
+
+		unsigned int reversed = ReverseBits((unsigned int)(a_reader.Bits & 0xFFFF), 16);
+		unsigned int length = INFLATE_FAST_BITS + 1;
+		while (length <= INFLATE_MAX_BITS && reversed >= a_table.MaxCode[length]) {
+			length++;
+		}
+		if (length > INFLATE_MAX_BITS)
+			return -1;
+		unsigned int slot = (reversed >> (16 - length)) - a_table.FirstCode[length] + a_table.FirstSymbol[length];
+		if (slot >= 288 || a_table.Lengths[slot] != length)
+			return -1;
+		a_reader.Read(length);
+		return a_table.Symbols[slot];
+	}
+
+	// The fixed tables of block type 1 never change, so they are built once
+	const Huffman* GetFixedTables()
+	{
+		static Huffman s_tables[2];
+		static bool s_bBuilt = [] {
+			uint8_t lengths[288];
+			std::memset(lengths, 8, 144);
+			std::memset(lengths + 144, 9, 112);
+			std::memset(lengths + 256, 7, 24);
+			std::memset(lengths + 280, 8, 8);
+			BuildHuffman(s_tables[0], lengths, 288);
+			std::memset(lengths, 5, 30);
+			BuildHuffman(s_tables[1], lengths, 30);
+			return true;
+		}();
+		(void)s_bBuilt;
+		return s_tables;
+	}
+
+	bool ReadDynamicTables(BitReader& a_reader, Huffman& a_literals, Huffman& a_distances)
+	{
+		a_reader.Refill();
+		unsigned int literalCount = a_reader.Read(5) + 257;
+		unsigned int distanceCount = a_reader.Read(5) + 1;
+		unsigned int codeLengthCount = a_reader.Read(4) + 4;
+		if (literalCount > 286 || distanceCount > 30)
+			return false;
+
+		uint8_t codeLengths[19] = {};
+		for (unsigned int i = 0; i < codeLengthCount; i++) {
+			a_reader.Refill();
+			codeLengths[s_codeLengthOrder[i]] = (uint8_t)a_reader.Read(3);
+		}
+		Huffman codeLengthTable;
+		if (!BuildHuffman(codeLengthTable, codeLengths, 19))
+			return false;
+
+		// Both tables' lengths are one run-length coded sequence, and repeats may cross between them
+		uint8_t lengths[286 + 30] = {};
+		unsigned int total = literalCount + distanceCount;
+		unsigned int filled = 0;
+		while (filled < total) {
+			a_reader.Refill();
+			int symbol = DecodeSymbol(a_reader, codeLengthTable);
+			if (symbol < 0)
+				return false;
+			if (symbol < 16) {
+				lengths[filled++] = (uint8_t)symbol;
+				continue;
+			}
+
+			unsigned int repeat = 0;
+			uint8_t value = 0;
+			if (symbol == 16) {
+				if (filled == 0)
+					return false;
+				repeat = 3 + a_reader.Read(2);
+				value = lengths[filled - 1];
+			}
+			else if (symbol == 17)
+				repeat = 3 + a_reader.Read(3);
+			else
+				repeat = 11 + a_reader.Read(7);
+			if (filled + repeat > total)
+				return false;
+			std::memset(lengths + filled, value, repeat);
+			filled += repeat;
+		}
+		if (lengths[256] == 0)
+			return false; // No end of block code
+
+		return BuildHuffman(a_literals, lengths, literalCount) && BuildHuffman(a_distances, lengths + literalCount, distanceCount);
+	}
+
+	//-------------------------------------------
+	// Scanline unfiltering. a_row is unfiltered
+	// in place, a_prior is the row above (zeros
+	// for the first row), a_bpp is the filter's
+	// byte distance (bytes per pixel, at least 1)
+	//-------------------------------------------
+	void UnfilterScalar(unsigned int a_filter, uint8_t* a_row, const uint8_t* a_prior, size_t a_length, unsigned int a_bpp)
+	{
+		switch (a_filter) {
+		case 1: // Sub
+			for (size_t i = a_bpp; i < a_length; i++) {
+				a_row[i] = (uint8_t)(a_row[i] + a_row[i - a_bpp]);
+			}
+			break;
+		case 2: // Up
+			for (size_t i = 0; i < a_length; i++) {
+				a_row[i] = (uint8_t)(a_row[i] + a_prior[i]);
+			}
+			break;
+		case 3: // Avg
+			for (size_t i = 0; i < a_length; i++) {
+				unsigned int left = (i >= a_bpp) ? a_row[i - a_bpp] : 0;
+				a_row[i] = (uint8_t)(a_row[i] + ((left + a_prior[i]) >> 1));
+			}
+			break;
+		case 4: // Paeth
+			for (size_t i = 0; i < a_length; i++) {
+				int left = (i >= a_bpp) ? a_row[i - a_bpp] : 0;
+				int up = a_prior[i];
+				int upLeft = (i >= a_bpp) ? a_prior[i - a_bpp] : 0;
+				int distanceLeft = up - upLeft; // |p - left| where p = left + up - upLeft
+				int distanceUp = left - upLeft;
+				int distanceUpLeft = distanceLeft + distanceUp;
+				distanceLeft = distanceLeft < 0 ? -distanceLeft : distanceLeft;
+				distanceUp = distanceUp < 0 ? -distanceUp : distanceUp;
+				distanceUpLeft = distanceUpLeft < 0 ? -distanceUpLeft : distanceUpLeft;
+				int predictor = (distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft) ? left : (distanceUp <= distanceUpLeft) ? up : upLeft;
+				a_row[i] = (uint8_t)(a_row[i] + predictor);
+			}
+			break;
+		default: // None
+			break;
+		}
+	}
+
+#if PNG_SSE
+	// One pixel in the low bytes of a register
+	//	- 3 and 6 byte pixels are moved as 4 and 8 bytes, picking up the start of the next pixel, which comes back
+	//	  out unchanged since every predictor lane past BPP is kept zero. A row's last pixel is moved exactly
+	//	  (EXACT), as there is nothing after it to borrow
+	template <unsigned int BPP, bool EXACT>
+	__m128i LoadPixel(const uint8_t* a_source)
+	{
+		if (BPP <= 4) {
+			uint32_t value = 0;
+			std::memcpy(&value, a_source, EXACT ? BPP : 4);
+			return _mm_cvtsi32_si128((int)value);
+		}
+		uint64_t value = 0;
+		std::memcpy(&value, a_source, EXACT ? BPP : 8);
+		return _mm_loadl_epi64((const __m128i*)&value);
+	}
+
+	template <unsigned int BPP, bool EXACT>
+	void StorePixel(uint8_t* a_destination, __m128i a_pixel)
+	{
+		if (BPP <= 4) {
+			uint32_t value = (uint32_t)_mm_cvtsi128_si32(a_pixel);
+			std::memcpy(a_destination, &value, EXACT ? BPP : 4);
+			return;
+		}
+		uint64_t value;
+		_mm_storel_epi64((__m128i*)&value, a_pixel);
+		std::memcpy(a_destination, &value, EXACT ? BPP : 8);
+	}
+
+	__m128i Absolute16(__m128i a_value)
+	{
+		return _mm_max_epi16(a_value, _mm_sub_epi16(_mm_setzero_si128(), a_value));
+	}
+
+	__m128i Select(__m128i a_mask, __m128i a_ifSet, __m128i a_ifClear)
+	{
+		return _mm_or_si128(_mm_and_si128(a_mask, a_ifSet), _mm_andnot_si128(a_mask, a_ifClear));
+	}
+
+	//-------------------------------------------
+	// Sub, Avg and Paeth for one pixel, from its
+	// filtered bytes and the pixel above. The
+	// left and upper left pixels are carried in
+	// registers (Paeth's widened to 16 bits so
+	// its distances can't overflow)
+	//-------------------------------------------
+	template <unsigned int BPP>
+	struct PixelFilters {
+		__m128i PixelMask;
+		__m128i Left; // Sub and Avg: 8 bit, Paeth: 16 bit
+		__m128i UpLeft; // Paeth only, 16 bit
+
+		PixelFilters()
+		{
+			const uint64_t pixelBits = (BPP == 8) ? ~0ull : (1ull << (BPP * 8)) - 1;
+			PixelMask = _mm_loadl_epi64((const __m128i*)&pixelBits);
+			Left = _mm_setzero_si128();
+			UpLeft = _mm_setzero_si128();
+		}
+
+		__m128i Sub(__m128i a_raw, __m128i)
+		{
+			__m128i pixel = _mm_add_epi8(a_raw, Left);
+			Left = _mm_and_si128(pixel, PixelMask);
+			return pixel;
+		}
+
+		__m128i Average(__m128i a_raw, __m128i a_up)
+		{
+			__m128i up = _mm_and_si128(a_up, PixelMask);
+			// avg_epu8 rounds up, the filter rounds down
+			__m128i average = _mm_sub_epi8(_mm_avg_epu8(Left, up), _mm_and_si128(_mm_xor_si128(Left, up), _mm_set1_epi8(1)));
+			__m128i pixel = _mm_add_epi8(a_raw, average);
+			Left = _mm_and_si128(pixel, PixelMask);
+			return pixel;
+		}
+
+		__m128i Paeth(__m128i a_raw, __m128i a_up)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			__m128i up = _mm_unpacklo_epi8(_mm_and_si128(a_up, PixelMask), zero);
+			__m128i signedLeft = _mm_sub_epi16(up, UpLeft);
+			__m128i signedUp = _mm_sub_epi16(Left, UpLeft);
+			__m128i distanceLeft = Absolute16(signedLeft);
+			__m128i distanceUp = Absolute16(signedUp);
+			__m128i distanceUpLeft = Absolute16(_mm_add_epi16(signedLeft, signedUp));
+
+			__m128i predictor = Select(_mm_cmpgt_epi16(distanceUp, distanceUpLeft), UpLeft, up);
+			__m128i nearest = _mm_min_epi16(distanceUp, distanceUpLeft);
+			predictor = Select(_mm_cmpgt_epi16(distanceLeft, nearest), predictor, Left);
+
+			__m128i pixel = _mm_add_epi8(a_raw, _mm_packus_epi16(predictor, predictor));
+			Left = _mm_unpacklo_epi8(_mm_and_si128(pixel, PixelMask), zero);
+			UpLeft = up;
+			return pixel;
+		}
+	};
+
+	// Run one filter along a row. Each pixel's bytes are loaded before the previous pixel is stored, so a
+	// widened load never waits on the overlapping store before it
+	template <unsigned int BPP, typename Filter>
+	void UnfilterRow(uint8_t* a_row, const uint8_t* a_prior, size_t a_length, Filter a_filter)
+	{
+		size_t last = a_length - BPP;
+		__m128i raw = (last == 0) ? LoadPixel<BPP, true>(a_row) : LoadPixel<BPP, false>(a_row);
+		for (size_t i = 0; i < last; i += BPP) {
+			__m128i pixel = a_filter(raw, LoadPixel<BPP, false>(a_prior + i));
+			size_t next = i + BPP;
+			raw = (next == last) ? LoadPixel<BPP, true>(a_row + next) : LoadPixel<BPP, false>(a_row + next);
+			StorePixel<BPP, false>(a_row + i, pixel);
+		}
+		StorePixel<BPP, true>(a_row + last, a_filter(raw, LoadPixel<BPP, true>(a_prior + last)));
+	}
+
+	template <unsigned int BPP>
+	void UnfilterPixelsSSE(unsigned int a_filter, uint8_t* a_row, const uint8_t* a_prior, size_t a_length)
+	{
+		PixelFilters<BPP> filters;
+		if (a_filter == 1)
+			UnfilterRow<BPP>(a_row, a_prior, a_length, [&](__m128i a_raw, __m128i a_up) { return filters.Sub(a_raw, a_up); });
+		else if (a_filter == 3)
+			UnfilterRow<BPP>(a_row, a_prior, a_length, [&](__m128i a_raw, __m128i a_up) { return filters.Average(a_raw, a_up); });
+		else if (a_filter == 4)
+			UnfilterRow<BPP>(a_row, a_prior, a_length, [&](__m128i a_raw, __m128i a_up) { return filters.Paeth(a_raw, a_up); });
+	}
+#endif
+
+	void Unfilter(unsigned int a_filter, uint8_t* a_row, const uint8_t* a_prior, size_t a_length, unsigned int a_bpp, bool a_bUseSIMD)
+	{
+#if PNG_SSE
+		if (a_bUseSIMD) {
+			if (a_filter == 2) {
+				size_t i = 0;
+				for (; i + 16 <= a_length; i += 16) {
+					__m128i row = _mm_loadu_si128((const __m128i*)(a_row + i));
+					__m128i prior = _mm_loadu_si128((const __m128i*)(a_prior + i));
+					_mm_storeu_si128((__m128i*)(a_row + i), _mm_add_epi8(row, prior));
+				}
+				UnfilterScalar(a_filter, a_row + i, a_prior + i, a_length - i, a_bpp);
+				return;
+			}
+			if (a_filter != 0 && a_length % a_bpp == 0) {
+				switch (a_bpp) {
+				case 3: UnfilterPixelsSSE<3>(a_filter, a_row, a_prior, a_length); return;
+				case 4: UnfilterPixelsSSE<4>(a_filter, a_row, a_prior, a_length); return;
+				case 6: UnfilterPixelsSSE<6>(a_filter, a_row, a_prior, a_length); return;
+				case 8: UnfilterPixelsSSE<8>(a_filter, a_row, a_prior, a_length); return;
+				default: break; // 1 and 2 byte pixels gain nothing from a register per pixel
+				}
+			}
+		}
+#else
+		(void)a_bUseSIMD;
+#endif
+		UnfilterScalar(a_filter, a_row, a_prior, a_length, a_bpp);
+	}
+
+	//-------------------------------------------
+	// Everything needed to turn unfiltered rows
+	// into output pixels
+	//-------------------------------------------
+	struct DecodeState {
+		PngInfo Info;
+		unsigned int Channels = 0;
+		uint8_t Palette[256][4] = {}; // RGBA8, alpha from tRNS
+		unsigned int PaletteSize = 0;
+		bool bHasColorKey = false; // tRNS on gray or RGB images
+		uint16_t ColorKey[3] = {}; // At the image's bit depth
+	};
+
+	unsigned int ReadSample(const uint8_t* a_row, size_t a_index, unsigned int a_bitDepth)
+	{
+		if (a_bitDepth == 8)
+			return a_row[a_index];
+		if (a_bitDepth == 16)
+			return ((unsigned int)a_row[a_index * 2] << 8) | a_row[a_index * 2 + 1];
+		size_t bit = a_index * a_bitDepth;
+		return (a_row[bit >> 3] >> (8 - a_bitDepth - (bit & 7))) & ((1u << a_bitDepth) - 1);
+	}
+
+	// Gray8 -> RGBA8, four pixels per byte of input replicated
+	void ExpandGray8(const uint8_t* a_source, unsigned int a_width, uint8_t* a_output, bool a_bUseSIMD)
+	{
+		unsigned int x = 0;
+#if PNG_SSE
+		if (a_bUseSIMD) {
+			const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+			for (; x + 16 <= a_width; x += 16) {
+				__m128i gray = _mm_loadu_si128((const __m128i*)(a_source + x));
+				__m128i pairsLow = _mm_unpacklo_epi8(gray, gray);
+				__m128i pairsHigh = _mm_unpackhi_epi8(gray, gray);
+				_mm_storeu_si128((__m128i*)(a_output + x * 4), _mm_or_si128(_mm_unpacklo_epi16(pairsLow, pairsLow), alpha));
+				_mm_storeu_si128((__m128i*)(a_output + x * 4 + 16), _mm_or_si128(_mm_unpackhi_epi16(pairsLow, pairsLow), alpha));
+				_mm_storeu_si128((__m128i*)(a_output + x * 4 + 32), _mm_or_si128(_mm_unpacklo_epi16(pairsHigh, pairsHigh), alpha));
+				_mm_storeu_si128((__m128i*)(a_output + x * 4 + 48), _mm_or_si128(_mm_unpackhi_epi16(pairsHigh, pairsHigh), alpha));
+			}
+		}
+#else
+		(void)a_bUseSIMD;
+#endif
+		for (; x < a_width; x++) {
+			uint8_t* pixel = a_output + x * 4;
+			pixel[0] = pixel[1] = pixel[2] = a_source[x];
+			pixel[3] = 255;
+		}
+	}
+
+	//-------------------------------------------
+	// Convert one unfiltered row of a_width
+	// pixels to the output format
+	//	- 8 bit RGBA, RGB, gray and gray + alpha
+	//	  (the formats real assets use) have
+	//	  direct paths. Everything else reads
+	//	  samples one at a time and rescales
+	//-------------------------------------------
+	void ConvertRow(const DecodeState& a_state, const uint8_t* a_source, unsigned int a_width, PngPixelFormat a_format, uint8_t* a_output, bool a_bUseSIMD)
+	{
+		const PngInfo& info = a_state.Info;
+		if (a_format == PngPixelFormat::RGBA8 && info.BitDepth == 8 && !a_state.bHasColorKey) {
+			switch (info.ColorType) {
+			case 6:
+				std::memcpy(a_output, a_source, (size_t)a_width * 4);
+				return;
+			case 2:
+				for (unsigned int x = 0; x < a_width; x++) {
+					a_output[x * 4 + 0] = a_source[x * 3 + 0];
+					a_output[x * 4 + 1] = a_source[x * 3 + 1];
+					a_output[x * 4 + 2] = a_source[x * 3 + 2];
+					a_output[x * 4 + 3] = 255;
+				}
+				return;
+			case 0:
+				ExpandGray8(a_source, a_width, a_output, a_bUseSIMD);
+				return;
+			case 4:
+				for (unsigned int x = 0; x < a_width; x++) {
+					a_output[x * 4 + 0] = a_output[x * 4 + 1] = a_output[x * 4 + 2] = a_source[x * 2];
+					a_output[x * 4 + 3] = a_source[x * 2 + 1];
+				}
+				return;
+			default:
+				break;
+			}
+		}
+
+		unsigned int maximum = (1u << info.BitDepth) - 1;
+		uint16_t* output16 = (uint16_t*)a_output;
+		for (unsigned int x = 0; x < a_width; x++) {
+			// Gather RGBA at the source bit depth (palette entries are always 8 bit)
+			unsigned int rgba[4];
+			unsigned int sourceMaximum = maximum;
+			if (info.ColorType == 3) {
+				unsigned int index = ReadSample(a_source, x, info.BitDepth);
+				const uint8_t* entry = a_state.Palette[index < a_state.PaletteSize ? index : 0];
+				rgba[0] = entry[0]; rgba[1] = entry[1]; rgba[2] = entry[2]; rgba[3] = entry[3];
+				sourceMaximum = 255;
+			}
+			else {
+				size_t first = (size_t)x * a_state.Channels;
+				bool bColor = (info.ColorType == 2 || info.ColorType == 6);
+				rgba[0] = ReadSample(a_source, first, info.BitDepth);
+				rgba[1] = bColor ? ReadSample(a_source, first + 1, info.BitDepth) : rgba[0];
+				rgba[2] = bColor ? ReadSample(a_source, first + 2, info.BitDepth) : rgba[0];
+				if (info.ColorType == 4 || info.ColorType == 6)
+					rgba[3] = ReadSample(a_source, first + a_state.Channels - 1, info.BitDepth);
+				else if (a_state.bHasColorKey && rgba[0] == a_state.ColorKey[0] && rgba[1] == a_state.ColorKey[1] && rgba[2] == a_state.ColorKey[2])
+					rgba[3] = 0;
+				else
+					rgba[3] = maximum;
+			}
+
+			for (unsigned int c = 0; c < 4; c++) {
+				if (a_format == PngPixelFormat::RGBA8)
+					a_output[x * 4 + c] = (uint8_t)((rgba[c] * 255 + sourceMaximum / 2) / sourceMaximum);
+				else
+					output16[x * 4 + c] = (uint16_t)((rgba[c] * 65535 + sourceMaximum / 2) / sourceMaximum);
+			}
+		}
+	}
+
+	unsigned int GetChannelCount(unsigned int a_colorType)
+	{
+		switch (a_colorType) {
+		case 0: return 1;
+		case 2: return 3;
+		case 3: return 1;
+		case 4: return 2;
+		case 6: return 4;
+		default: return 0;
+		}
+	}
+
+	// Bytes of one filtered row of a_width pixels, not counting the filter type byte
+	size_t GetFilteredRowSize(const DecodeState& a_state, unsigned int a_width)
+	{
+		return ((size_t)a_width * a_state.Channels * a_state.Info.BitDepth + 7) / 8;
+	}
+
+	// Adam7 pass size. Either can be 0, in which case the pass holds no data at all
+	void GetPassSize(const PngInfo& a_info, unsigned int a_pass, unsigned int& a_width, unsigned int& a_height)
+	{
+		a_width = (a_info.Width > s_adam7X[a_pass]) ? (a_info.Width - s_adam7X[a_pass] + s_adam7StepX[a_pass] - 1) / s_adam7StepX[a_pass] : 0;
+		a_height = (a_info.Height > s_adam7Y[a_pass]) ? (a_info.Height - s_adam7Y[a_pass] + s_adam7StepY[a_pass] - 1) / s_adam7StepY[a_pass] : 0;
+		if (a_width == 0 || a_height == 0)
+			a_width = a_height = 0;
+	}
+}
+
+// --------------------------------------------------------
+// Signature, then IHDR, which must be the first chunk
+// --------------------------------------------------------
+bool PngDecoder::ReadInfo(const uint8_t* a_data, size_t a_size, PngInfo& a_info)
+{
+	if (a_size < 8 + 8 + 13 || std::memcmp(a_data, s_signature, 8) != 0)
+		return false;
+	if (ReadBigEndian32(a_data + 8) != 13 || ReadBigEndian32(a_data + 12) != PNG_CHUNK_IHDR)
+		return false;
+
+	const uint8_t* header = a_data + 16;
+	a_info.Width = ReadBigEndian32(header);
+	a_info.Height = ReadBigEndian32(header + 4);
+	a_info.BitDepth = header[8];
+	a_info.ColorType = header[9];
+	a_info.bInterlaced = (header[12] == 1);
+	if (a_info.Width == 0 || a_info.Height == 0 || a_info.Width > PNG_MAX_DIMENSION || a_info.Height > PNG_MAX_DIMENSION)
+		return false;
+	if (header[10] != 0 || header[11] != 0 || header[12] > 1)
+		return false; // Unknown compression, filter or interlace method
+
+	// Allowed bit depths per color type
+	switch (a_info.ColorType) {
+	case 0: return a_info.BitDepth == 1 || a_info.BitDepth == 2 || a_info.BitDepth == 4 || a_info.BitDepth == 8 || a_info.BitDepth == 16;
+	case 3: return a_info.BitDepth == 1 || a_info.BitDepth == 2 || a_info.BitDepth == 4 || a_info.BitDepth == 8;
+	case 2:
+	case 4:
+	case 6: return a_info.BitDepth == 8 || a_info.BitDepth == 16;
+	default: return false;
+	}
+}
+
+// --------------------------------------------------------
+// Tightly packed pixels, padded to the alignment
+// --------------------------------------------------------
+size_t PngDecoder::GetRowPitch(unsigned int a_width, PngPixelFormat a_format)
+{
+	size_t bytes = (size_t)a_width * (a_format == PngPixelFormat::RGBA8 ? 4 : 8);
+	return (bytes + PNG_OUTPUT_ALIGNMENT - 1) / PNG_OUTPUT_ALIGNMENT * PNG_OUTPUT_ALIGNMENT;
+}
+
+// --------------------------------------------------------
+// zlib header, then deflate blocks until the final one
+//	- Output must come out at exactly a_outputSize, which
+//	  the PNG header already determines
+// --------------------------------------------------------
+bool PngDecoder::Inflate(const uint8_t* a_data, size_t a_size, uint8_t* a_output, size_t a_outputSize)
+{
+	if (a_size < 2)
+		return false;
+	unsigned int method = a_data[0];
+	unsigned int flags = a_data[1];
+	if ((method & 15) != 8 || (method >> 4) > 7 || ((method << 8) | flags) % 31 != 0 || (flags & 32) != 0)
+		return false; // Not deflate, bad check bits, or a preset dictionary
+
+	BitReader reader;
+	reader.Data = a_data + 2;
+	reader.Size = a_size - 2;
+	size_t written = 0;
+	Huffman dynamicTables[2];
+	bool bFinal = false;
+	while (!bFinal) {
+		reader.Refill();
+		bFinal = reader.Read(1) != 0;
+		unsigned int type = reader.Read(2);
+
+		if (type == 0) {
+			// Stored block. Drop to the byte boundary and copy straight from the input
+			reader.Read(reader.Count & 7);
+			size_t position = reader.Position - reader.Count / 8;
+			reader.Bits = 0;
+			reader.Count = 0;
+			if (position + 4 > reader.Size)
+				return false;
+			unsigned int length = reader.Data[position] | (reader.Data[position + 1] << 8);
+			unsigned int inverse = reader.Data[position + 2] | (reader.Data[position + 3] << 8);
+			position += 4;
+			if ((length ^ 0xFFFF) != inverse || position + length > reader.Size || written + length > a_outputSize)
+				return false;
+			std::memcpy(a_output + written, reader.Data + position, length);
+			written += length;
+			reader.Position = position + length;
+			continue;
+		}
+
+		const Huffman* literals = nullptr;
+		const Huffman* distances = nullptr;
+		if (type == 1) {
+			literals = &GetFixedTables()[0];
+			distances = &GetFixedTables()[1];
+		}
+		else if (type == 2) {
+			if (!ReadDynamicTables(reader, dynamicTables[0], dynamicTables[1]))
+				return false;
+			literals = &dynamicTables[0];
+			distances = &dynamicTables[1];
+		}
+		else
+			return false;
+
+		while (true) {
+			// 56 bits covers a literal/length code, its extra bits, a distance code and its extra bits
+			reader.Refill();
+			int symbol = DecodeSymbol(reader, *literals);
+			if (symbol < 0)
+				return false;
+			if (symbol < 256) {
+				if (written >= a_outputSize)
+					return false;
+				a_output[written++] = (uint8_t)symbol;
+				continue;
+			}
+			if (symbol == 256)
+				break;
+
+			symbol -= 257;
+			if (symbol >= 29)
+				return false;
+			size_t length = s_lengthBase[symbol] + reader.Read(s_lengthExtra[symbol]);
+			int distanceSymbol = DecodeSymbol(reader, *distances);
+			if (distanceSymbol < 0 || distanceSymbol >= 30)
+				return false;
+			size_t distance = s_distanceBase[distanceSymbol] + reader.Read(s_distanceExtra[distanceSymbol]);
+			if (distance > written || written + length > a_outputSize)
+				return false;
+
+			uint8_t* destination = a_output + written;
+			const uint8_t* source = destination - distance;
+			if (distance == 1)
+				std::memset(destination, *source, length);
+			else if (distance >= 8 && written + length + 8 <= a_outputSize) {
+				// 8 bytes at a time, overshooting into output that hasn't been written yet. Each step only reads
+				// bytes at least 8 back, which are already final
+				for (size_t i = 0; i < length; i += 8) {
+					uint64_t chunk;
+					std::memcpy(&chunk, source + i, 8);
+					std::memcpy(destination + i, &chunk, 8);
+				}
+			}
+			else if (distance >= length)
+				std::memcpy(destination, source, length);
+			else {
+				// Overlapping copies repeat the last 'distance' bytes
+				for (size_t i = 0; i < length; i++) {
+					destination[i] = source[i];
+				}
+			}
+			written += length;
+		}
+		if (reader.Overran())
+			return false;
+	}
+	return written == a_outputSize && !reader.Overran();
+}
+
+// --------------------------------------------------------
+// Walk the chunks, inflate the joined IDAT data, then
+// unfilter and convert row by row
+// --------------------------------------------------------
+bool PngDecoder::Decode(const uint8_t* a_data, size_t a_size, PngPixelFormat a_format, void* a_output, size_t a_rowPitch, bool a_bUseSIMD)
+{
+	DecodeState state;
+	if (!ReadInfo(a_data, a_size, state.Info))
+		return false;
+	const PngInfo& info = state.Info;
+	state.Channels = GetChannelCount(info.ColorType);
+	size_t pixelSize = (a_format == PngPixelFormat::RGBA8) ? 4 : 8;
+	if (a_rowPitch < (size_t)info.Width * pixelSize)
+		return false;
+
+	// Gather the chunks that matter. IDAT data only needs copying when it's split over several chunks
+	std::vector<uint8_t> joinedData;
+	const uint8_t* compressed = nullptr;
+	size_t compressedSize = 0;
+	unsigned int idatCount = 0;
+	size_t offset = 8;
+	bool bEnded = false;
+	while (!bEnded && offset + 12 <= a_size) {
+		uint32_t length = ReadBigEndian32(a_data + offset);
+		uint32_t type = ReadBigEndian32(a_data + offset + 4);
+		if (length > a_size - offset - 12)
+			return false;
+		const uint8_t* chunk = a_data + offset + 8;
+
+		switch (type) {
+		case PNG_CHUNK_PLTE:
+			if (length % 3 != 0 || length / 3 > 256)
+				return false;
+			state.PaletteSize = length / 3;
+			for (unsigned int i = 0; i < state.PaletteSize; i++) {
+				state.Palette[i][0] = chunk[i * 3];
+				state.Palette[i][1] = chunk[i * 3 + 1];
+				state.Palette[i][2] = chunk[i * 3 + 2];
+				state.Palette[i][3] = 255;
+			}
+			break;
+		case PNG_CHUNK_TRNS:
+			if (info.ColorType == 3) {
+				for (unsigned int i = 0; i < length && i < 256; i++) {
+					state.Palette[i][3] = chunk[i];
+				}
+			}
+			else if (info.ColorType == 0 && length >= 2) {
+				state.bHasColorKey = true;
+				state.ColorKey[0] = state.ColorKey[1] = state.ColorKey[2] = (uint16_t)((chunk[0] << 8) | chunk[1]);
+			}
+			else if (info.ColorType == 2 && length >= 6) {
+				state.bHasColorKey = true;
+				for (unsigned int c = 0; c < 3; c++) {
+					state.ColorKey[c] = (uint16_t)((chunk[c * 2] << 8) | chunk[c * 2 + 1]);
+				}
+			}
+			break;
+		case PNG_CHUNK_IDAT:
+			if (idatCount == 0) {
+				compressed = chunk;
+				compressedSize = length;
+			}
+			else {
+				if (idatCount == 1)
+					joinedData.assign(compressed, compressed + compressedSize);
+				joinedData.insert(joinedData.end(), chunk, chunk + length);
+			}
+			idatCount++;
+			break;
+		case PNG_CHUNK_IEND:
+			bEnded = true;
+			break;
+		default:
+			break;
+		}
+		offset += 12 + (size_t)length;
+	}
+	if (idatCount == 0 || (info.ColorType == 3 && state.PaletteSize == 0))
+		return false;
+	if (idatCount > 1) {
+		compressed = joinedData.data();
+		compressedSize = joinedData.size();
+	}
+
+	// The filtered size of every pass is known up front, so inflate writes it all in one go
+	unsigned int passCount = info.bInterlaced ? 7 : 1;
+	size_t filteredSize = 0;
+	for (unsigned int pass = 0; pass < passCount; pass++) {
+		unsigned int width = info.Width;
+		unsigned int height = info.Height;
+		if (info.bInterlaced)
+			GetPassSize(info, pass, width, height);
+		filteredSize += (GetFilteredRowSize(state, width) + 1) * height;
+	}
+	std::unique_ptr<uint8_t[]> filtered(new uint8_t[filteredSize]); // Not value initialized - inflate fills every byte
+	if (!Inflate(compressed, compressedSize, filtered.get(), filteredSize))
+		return false;
+
+	unsigned int bpp = (state.Channels * info.BitDepth + 7) / 8;
+	std::vector<uint8_t> zeroRow(GetFilteredRowSize(state, info.Width), 0);
+	std::vector<uint8_t> passRow;
+	if (info.bInterlaced)
+		passRow.resize((size_t)info.Width * pixelSize);
+
+	uint8_t* output = (uint8_t*)a_output;
+	uint8_t* cursor = filtered.get();
+	for (unsigned int pass = 0; pass < passCount; pass++) {
+		unsigned int width = info.Width;
+		unsigned int height = info.Height;
+		if (info.bInterlaced)
+			GetPassSize(info, pass, width, height);
+		size_t rowSize = GetFilteredRowSize(state, width);
+
+		const uint8_t* prior = zeroRow.data();
+		for (unsigned int y = 0; y < height; y++) {
+			unsigned int filter = cursor[0];
+			uint8_t* row = cursor + 1;
+			if (filter > 4)
+				return false;
+			Unfilter(filter, row, prior, rowSize, bpp, a_bUseSIMD);
+
+			if (!info.bInterlaced)
+				ConvertRow(state, row, width, a_format, output + y * a_rowPitch, a_bUseSIMD);
+			else {
+				// Convert the pass's row, then scatter its pixels to their places in the image
+				ConvertRow(state, row, width, a_format, passRow.data(), a_bUseSIMD);
+				uint8_t* destination = output + (size_t)(s_adam7Y[pass] + y * s_adam7StepY[pass]) * a_rowPitch;
+				for (unsigned int x = 0; x < width; x++) {
+					std::memcpy(destination + (size_t)(s_adam7X[pass] + x * s_adam7StepX[pass]) * pixelSize, passRow.data() + x * pixelSize, pixelSize);
+				}
+			}
+			prior = row;
+			cursor += rowSize + 1;
+		}
+	}
+	return true;
+}
+
+// --------------------------------------------------------
+// Whole file into memory (or straight from a mounted
+// archive, see AssetFiles), then decode at tight pitch
+// --------------------------------------------------------
+bool PngDecoder::LoadFile(const std::filesystem::path& a_fileName, TextureData& a_output)
+{
+	AssetFileView data;
+	if (!AssetFiles::Read(a_fileName, data))
+		return false;
+
+	PngInfo info;
+	if (!ReadInfo(data.Data, data.Size, info))
+		return false;
+	a_output.Mips.resize(1);
+	TextureMip& top = a_output.Mips[0];
+	top.Width = info.Width;
+	top.Height = info.Height;
+	top.Pixels.resize((size_t)info.Width * info.Height * 4);
+	return Decode(data.Data, data.Size, PngPixelFormat::RGBA8, top.Pixels.data(), (size_t)info.Width * 4);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "TextureMips.h"
+
+#define PNG_OUTPUT_ALIGNMENT 16 // GetRowPitch rounds rows up to this, so every row starts aligned in an aligned buffer
+#define PNG_MAX_DIMENSION 16384 // Sanity limit so a corrupt header can't request gigabytes
+
+enum class PngPixelFormat {
+	RGBA8, // 4 bytes per pixel
+	RGBA16 // 8 bytes per pixel, native (little) endian
+};
+
+//-------------------------------------------------------
+// The parts of a PNG's header the decoder cares about
+//-------------------------------------------------------
+struct PngInfo {
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+	unsigned int BitDepth = 0; // Bits per channel (or per palette index): 1, 2, 4, 8 or 16
+	unsigned int ColorType = 0; // 0 gray, 2 RGB, 3 palette, 4 gray + alpha, 6 RGBA
+	bool bInterlaced = false; // Adam7
+};
+
+//-------------------------------------------------------
+// Self-contained PNG decoding, so image loading works
+// the same on every platform and can be profiled
+//	- Inflate is a table driven zlib decoder, resolving
+//	  most codes with one lookup
+//	- Scanlines are unfiltered in place. Sub, Avg and
+//	  Paeth depend on the pixel to the left, so SSE2 runs
+//	  one whole pixel (3, 4, 6 or 8 bytes) per step; Up
+//	  has no such dependency and runs 16 bytes per step
+//	- Every color type, bit depth, palette and tRNS
+//	  transparency is converted to RGBA8 or RGBA16 as
+//	  each row is finished, straight into the caller's
+//	  buffer. Interlaced images are supported too
+//	- Chunk CRCs and the zlib checksum aren't verified.
+//	  Damaged data still fails on its structure, with
+//	  every read bounds checked
+//-------------------------------------------------------
+namespace PngDecoder
+{
+	// Parse just the signature and IHDR chunk
+	bool ReadInfo(const uint8_t* a_data, size_t a_size, PngInfo& a_info);
+
+	// Bytes per output row, rounded up to PNG_OUTPUT_ALIGNMENT
+	size_t GetRowPitch(unsigned int a_width, PngPixelFormat a_format);
+
+	// Decode the whole image into a_output, which must hold Height rows of a_rowPitch bytes
+	//	- a_bUseSIMD = false forces the scalar unfilters, for comparison
+	bool Decode(const uint8_t* a_data, size_t a_size, PngPixelFormat a_format, void* a_output, size_t a_rowPitch, bool a_bUseSIMD = true);
+
+	// Inflate a zlib stream into exactly a_outputSize bytes
+	bool Inflate(const uint8_t* a_data, size_t a_size, uint8_t* a_output, size_t a_outputSize);
+
+	// Read and decode a file to RGBA8, as the single level of a_output
+	bool LoadFile(const std::filesystem::path& a_fileName, TextureData& a_output);
+}
@@ -29,8 +29,24 @@ ReflectionProbe::ReflectionProbe(float a_radius, Vector3 a_position, std::shared
 //	- Scene data would be vastly simplified by having a
 //	  unified Scnee class - pass in the instance instead of
 //	  tons of individual vectors
+//	- Does a whole update at once. Use the individual steps
+//	  through a ReflectionProbeScheduler to spread the cost
 //---------------------------------------------------------
-void ReflectionProbe::Draw(Microsoft::WRL::ComPtr<ID3D11Device> a_d3dDevice, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, const std::vector<std::shared_ptr<Entity>>& a_entities, const std::vector<BasicLight>& a_directionalLights, const std::vector<BasicLight>& a_pointLights, const std::shared_ptr<Sky> a_sky, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_brdfLookUp)
+void ReflectionProbe::Draw(Microsoft::WRL::ComPtr<ID3D11Device> a_d3dDevice, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, std::shared_ptr<RenderDevice> a_renderDevice, const std::vector<std::shared_ptr<Entity>>& a_entities, const std::vector<BasicLight>& a_directionalLights, const std::vector<BasicLight>& a_pointLights, const std::shared_ptr<Sky> a_sky, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_brdfLookUp)
+{
+	for (unsigned int face = 0; face < 6; face++) {
+		RenderFace(a_d3dDevice, a_d3dContext, a_renderDevice, face, a_entities, a_directionalLights, a_pointLights, a_sky, a_brdfLookUp);
+	}
+	for (unsigned int mip = 0; mip < m_mipCount; mip++) {
+		PrefilterMip(a_d3dDevice, a_d3dContext, a_renderDevice, mip, a_sky->GetSamplerState());
+	}
+	Publish();
+}
+
+//---------------------------------------------------------
+// Renders the Scene into one face of the Scene Cubemap
+//---------------------------------------------------------
+void ReflectionProbe::RenderFace(Microsoft::WRL::ComPtr<ID3D11Device> a_d3dDevice, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, std::shared_ptr<RenderDevice> a_renderDevice, unsigned int a_face, const std::vector<std::shared_ptr<Entity>>& a_entities, const std::vector<BasicLight>& a_directionalLights, const std::vector<BasicLight>& a_pointLights, const std::shared_ptr<Sky> a_sky, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_brdfLookUp, const std::vector<uint64_t>* a_visibilityMasks, unsigned int a_viewIndex)
 {
 	// Store/destroy currently active Render Targets and Input buffers
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> cachedRTV;
@@ -44,67 +60,114 @@ void ReflectionProbe::Draw(Microsoft::WRL::ComPtr<ID3D11Device> a_d3dDevice, Mic
 	UINT offset = 0;
 	ID3D11Buffer* nullBuffer = nullptr; // Must pass address of nullptr to clear, not nullptr itself
 	a_d3dContext->IASetVertexBuffers(0, 1, &nullBuffer, &stride, &offset);
+	a_renderDevice->InvalidateState(); // So the first Mesh drawn into the face rebinds, even if it was the last one bound
+
+	D3D11_VIEWPORT faceViewport = {};
+	faceViewport.MaxDepth = 1.f;
+	faceViewport.Width = (FLOAT)SCENE_MAP_SIZE;
+	faceViewport.Height = (FLOAT)SCENE_MAP_SIZE;
+	a_d3dContext->RSSetViewports(1, &faceViewport);
 
 	// Prepare a Camera through which to render the Scene
-	Transform t = Transform::ZeroTransform;
-	t.SetAbsolutePosition(m_position);
-	std::shared_ptr<Camera> cam = std::make_shared<Camera>(t, DirectX::XMINT2(SCENE_MAP_SIZE, SCENE_MAP_SIZE));
+	std::shared_ptr<Camera> cam = CreateFaceCamera(a_face);
 
 	// Set Shaders
 	m_sceneVertexShader->SetShader();
 	m_scenePixelShader->SetShader();
 
-	// Render the scene 6 times
-	//	- This does not fully work - camera is not actually rotated for each face
-	for (int i = 0; i < 6; i++) {
-		// Adjust Camera
-		//	- This fails - it renders facing forward for all sides
-		switch (i) {
-		case 0: cam->SetCameraRotation(0.f, DirectX::XM_PIDIV2, 0.f); break;
-		case 1: cam->SetCameraRotation(0.f, -DirectX::XM_PIDIV2, 0.f); break;
-		case 2: cam->SetCameraRotation(-DirectX::XM_PIDIV2, 0.f, 0.f); break;
-		case 3: cam->SetCameraRotation(DirectX::XM_PIDIV2, 0.f, 0.f); break;
-		case 4: cam->SetCameraRotation(0.f, 0.f, 0.f); break;
-		case 5: cam->SetCameraRotation(0.f, DirectX::XM_PI, 0.f); break;
-		}
-
-		// Create RTV
-		D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
-		rtvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
-		rtvDesc.Texture2DArray.MipSlice = 0;
-		rtvDesc.Texture2DArray.FirstArraySlice = i; // +X -> -X -> +Y -> -Y -> +Z -> -Z
-		rtvDesc.Texture2DArray.ArraySize = 1;
-		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> faceRTV;
-		a_d3dDevice->CreateRenderTargetView(m_sceneMapTexture.Get(), &rtvDesc, faceRTV.GetAddressOf());
-		a_d3dContext->OMSetRenderTargets(1, faceRTV.GetAddressOf(), cachedDSV.Get());
+	// Create RTV
+	D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+	rtvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
+	rtvDesc.Texture2DArray.MipSlice = 0;
+	rtvDesc.Texture2DArray.FirstArraySlice = a_face; // +X -> -X -> +Y -> -Y -> +Z -> -Z
+	rtvDesc.Texture2DArray.ArraySize = 1;
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> faceRTV;
+	a_d3dDevice->CreateRenderTargetView(m_sceneMapTexture.Get(), &rtvDesc, faceRTV.GetAddressOf());
+	a_d3dContext->OMSetRenderTargets(1, faceRTV.GetAddressOf(), m_sceneDepthDSV.Get());
+
+	// Clear newly set targets	
+	const float bgColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	a_d3dContext->ClearRenderTargetView(faceRTV.Get(), bgColor);
+	a_d3dContext->ClearDepthStencilView(m_sceneDepthDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+	// Actually Render Scene to this section of the cubemap
+	RenderScene(faceRTV, a_d3dContext, a_entities, a_directionalLights, a_pointLights, a_sky, cam, a_brdfLookUp, a_visibilityMasks, a_viewIndex);
 
-		// Clear newly set targets	
-		const float bgColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
-		a_d3dContext->ClearRenderTargetView(faceRTV.Get(), bgColor);
-		a_d3dContext->ClearDepthStencilView(cachedDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+	// Restore cached viewport, RTV, and DSV (Input buffers are the next object's responsibility
+	a_d3dContext->OMSetRenderTargets(1, cachedRTV.GetAddressOf(), cachedDSV.Get());
+	a_d3dContext->RSSetViewports(1, &cachedViewport);
+}
 
-		// Actually Render Scene to this section of the cubemap
-		RenderScene(faceRTV, a_d3dContext, a_entities, a_directionalLights, a_pointLights, a_sky, cam, a_brdfLookUp);
+//---------------------------------------------------------
+// Prefilters one mip (all 6 faces) of the back Reflection
+// Map from the Scene Cubemap, the same way the Sky builds
+// its reflectance map
+//---------------------------------------------------------
+void ReflectionProbe::PrefilterMip(Microsoft::WRL::ComPtr<ID3D11Device> a_d3dDevice, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, std::shared_ptr<RenderDevice> a_renderDevice, unsigned int a_mip, Microsoft::WRL::ComPtr<ID3D11SamplerState> a_sampler)
+{
+	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> cachedRTV;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> cachedDSV;
+	a_d3dContext->OMGetRenderTargets(1, cachedRTV.GetAddressOf(), cachedDSV.GetAddressOf());
+	UINT viewportCount = 1;
+	D3D11_VIEWPORT cachedViewport;
+	a_d3dContext->RSGetViewports(&viewportCount, &cachedViewport);
+	a_d3dContext->IASetIndexBuffer(nullptr, DXGI_FORMAT_R32_UINT, 0);
+	UINT stride = sizeof(Vertex);
+	UINT offset = 0;
+	ID3D11Buffer* nullBuffer = nullptr;
+	a_d3dContext->IASetVertexBuffers(0, 1, &nullBuffer, &stride, &offset);
+	a_renderDevice->InvalidateState();
+
+	D3D11_VIEWPORT mipViewport = {};
+	mipViewport.MaxDepth = 1.f;
+	mipViewport.Width = (FLOAT)max(REFLECTION_MAP_SIZE >> a_mip, 1);
+	mipViewport.Height = mipViewport.Width;
+	a_d3dContext->RSSetViewports(1, &mipViewport);
+
+	m_reflectionVertexShader->SetShader();
+	m_reflectionPixelShader->SetShader();
+	m_reflectionPixelShader->SetShaderResourceView("EnvMap", m_sceneCubeMap);
+	m_reflectionPixelShader->SetSamplerState("Sampler", a_sampler);
+
+	ID3D11Texture2D* backTexture = m_reflectionMapTextures[1 - m_frontIndex].Get();
+	for (int face = 0; face < 6; face++) {
+		D3D11_RENDER_TARGET_VIEW_DESC viewDesc = {};
+		viewDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		viewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
+		viewDesc.Texture2DArray.MipSlice = a_mip;
+		viewDesc.Texture2DArray.FirstArraySlice = face;
+		viewDesc.Texture2DArray.ArraySize = 1;
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> faceRTV;
+		a_d3dDevice->CreateRenderTargetView(backTexture, &viewDesc, faceRTV.GetAddressOf());
+		a_d3dContext->OMSetRenderTargets(1, faceRTV.GetAddressOf(), nullptr);
+
+		m_reflectionPixelShader->SetInt("c_face", face);
+		m_reflectionPixelShader->SetFloat("c_roughness", m_mipCount > 1 ? a_mip / (float)(m_mipCount - 1) : 0.f);
+		m_reflectionPixelShader->CopyAllBufferData();
+		a_d3dContext->Draw(3, 0); // Full-screen triangle
 	}
 
-	// TODO: Render Convolved Reflection Map using the newly rendered out Scene Map as the Environment to convolve
+	// Unbind the Scene Cubemap so the next RenderFace can write to it
+	ID3D11ShaderResourceView* nullSRV = nullptr;
+	a_d3dContext->PSSetShaderResources(0, 1, &nullSRV);
 
-	// Restore cached viewport, RTV, and DSV (Input buffers are the next object's responsibility
 	a_d3dContext->OMSetRenderTargets(1, cachedRTV.GetAddressOf(), cachedDSV.Get());
 	a_d3dContext->RSSetViewports(1, &cachedViewport);
 }
 
 //---------------------------------------------------------
-// Builds the two cubemaps on the GPU. Textures must also be
-// stored, since the underlying resource will need to be
-// quickly extracted to generate RTVs every frame
+// Builds the cubemaps on the GPU (two reflection maps and
+// the scene map). Textures must also be stored, since the
+// underlying resource will need to be quickly extracted to
+// generate RTVs every frame
 //---------------------------------------------------------
 void ReflectionProbe::BuildResources(Microsoft::WRL::ComPtr<ID3D11Device> a_d3dDevice)
 {
-	// Create reflection map texture
+	// Create reflection map textures
 	int ignoredSmallMips = 2; // 2x2 and 4x4 are irrelevant
 	int mipLevels = max((int)(log2(REFLECTION_MAP_SIZE) - ignoredSmallMips), 1); // Subtract ignored Mip levels from the total count
+	m_mipCount = (unsigned int)mipLevels;
 	D3D11_TEXTURE2D_DESC texDesc = {};
 	texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
 	texDesc.Width = REFLECTION_MAP_SIZE;
@@ -114,7 +177,9 @@ void ReflectionProbe::BuildResources(Microsoft::WRL::ComPtr<ID3D11Device> a_d3dD
 	texDesc.ArraySize = 6; // TextureCube
 	texDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
 	texDesc.SampleDesc.Count = 1;
-	a_d3dDevice->CreateTexture2D(&texDesc, nullptr, m_reflectionMapTexture.GetAddressOf());
+	for (int i = 0; i < 2; i++) {
+		a_d3dDevice->CreateTexture2D(&texDesc, nullptr, m_reflectionMapTextures[i].GetAddressOf());
+	}
 
 	// Create scene cube texture
 	texDesc.Width = SCENE_MAP_SIZE;
@@ -122,27 +187,78 @@ void ReflectionProbe::BuildResources(Microsoft::WRL::ComPtr<ID3D11Device> a_d3dD
 	texDesc.MipLevels = 1;
 	a_d3dDevice->CreateTexture2D(&texDesc, nullptr, m_sceneMapTexture.GetAddressOf());
 
-	// Create SRV for Reflection Map
+	// Depth for rendering scene faces, one face at a time
+	D3D11_TEXTURE2D_DESC depthDesc = {};
+	depthDesc.Width = SCENE_MAP_SIZE;
+	depthDesc.Height = SCENE_MAP_SIZE;
+	depthDesc.MipLevels = 1;
+	depthDesc.ArraySize = 1;
+	depthDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+	depthDesc.SampleDesc.Count = 1;
+	depthDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+	a_d3dDevice->CreateTexture2D(&depthDesc, nullptr, m_sceneDepthTexture.GetAddressOf());
+	a_d3dDevice->CreateDepthStencilView(m_sceneDepthTexture.Get(), nullptr, m_sceneDepthDSV.GetAddressOf());
+
+	// Create SRVs for Reflection Maps
 	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Format = texDesc.Format;
 	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
 	srvDesc.TextureCube.MipLevels = mipLevels;
 	srvDesc.TextureCube.MostDetailedMip = 0;
-	a_d3dDevice->CreateShaderResourceView(m_reflectionMapTexture.Get(), &srvDesc, m_reflectionMap.GetAddressOf());
+	for (int i = 0; i < 2; i++) {
+		a_d3dDevice->CreateShaderResourceView(m_reflectionMapTextures[i].Get(), &srvDesc, m_reflectionMaps[i].GetAddressOf());
+	}
 
 	// Create SRV for Scene Map
 	srvDesc.TextureCube.MipLevels = 1;
 	a_d3dDevice->CreateShaderResourceView(m_sceneMapTexture.Get(), &srvDesc, m_sceneCubeMap.GetAddressOf());
 }
 
+//---------------------------------------------------------
+// View * Projection of one face, for culling the face
+// before RenderFace is called
+//---------------------------------------------------------
+Matrix4 ReflectionProbe::GetFaceViewProjectionMatrix(unsigned int a_face)
+{
+	return CreateFaceCamera(a_face)->GetViewProjectionMatrix();
+}
+
+//---------------------------------------------------------
+// Camera at the probe's position looking down one face
+//	- This does not fully work - camera is not actually
+//	  rotated for each face
+//---------------------------------------------------------
+std::shared_ptr<Camera> ReflectionProbe::CreateFaceCamera(unsigned int a_face)
+{
+	Transform t = Transform::ZeroTransform;
+	t.SetAbsolutePosition(m_position);
+	std::shared_ptr<Camera> cam = std::make_shared<Camera>(t, DirectX::XMINT2(SCENE_MAP_SIZE, SCENE_MAP_SIZE));
+
+	switch (a_face) {
+	case 0: cam->SetCameraRotation(0.f, DirectX::XM_PIDIV2, 0.f); break;
+	case 1: cam->SetCameraRotation(0.f, -DirectX::XM_PIDIV2, 0.f); break;
+	case 2: cam->SetCameraRotation(-DirectX::XM_PIDIV2, 0.f, 0.f); break;
+	case 3: cam->SetCameraRotation(DirectX::XM_PIDIV2, 0.f, 0.f); break;
+	case 4: cam->SetCameraRotation(0.f, 0.f, 0.f); break;
+	case 5: cam->SetCameraRotation(0.f, DirectX::XM_PI, 0.f); break;
+	}
+	return cam;
+}
+
 //---------------------------------------------------------
 // Takes care of the actual Render Loop for a single RTV
 //	- One face of the Scene Cubemap
 //	- Render loop is taken directly from Game::Draw()
+//	- Entities whose bit a_viewIndex is clear in
+//	  a_visibilityMasks are skipped
 //---------------------------------------------------------
-void ReflectionProbe::RenderScene(Microsoft::WRL::ComPtr<ID3D11RenderTargetView> a_rtv, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, const std::vector<std::shared_ptr<Entity>>& a_entities, const std::vector<BasicLight>& a_directionalLights, const std::vector<BasicLight>& a_pointLights, const std::shared_ptr<Sky> a_sky, std::shared_ptr<Camera> a_camera, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_brdfLookUp)
+void ReflectionProbe::RenderScene(Microsoft::WRL::ComPtr<ID3D11RenderTargetView> a_rtv, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, const std::vector<std::shared_ptr<Entity>>& a_entities, const std::vector<BasicLight>& a_directionalLights, const std::vector<BasicLight>& a_pointLights, const std::shared_ptr<Sky> a_sky, std::shared_ptr<Camera> a_camera, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_brdfLookUp, const std::vector<uint64_t>* a_visibilityMasks, unsigned int a_viewIndex)
 {
-	for (std::shared_ptr<Entity> entity : a_entities) {
+	for (unsigned int i = 0; i < (unsigned int)a_entities.size(); i++) {
+		if (a_visibilityMasks && !((*a_visibilityMasks)[i] & (1ull << a_viewIndex)))
+			continue;
+
+		const std::shared_ptr<Entity>& entity = a_entities[i];
 		std::shared_ptr<SimplePixelShader> pixelShader = entity->GetMaterial()->GetPixelShader();
 		int directionalLightCount = (int)a_directionalLights.size();
 		int pointLightCount = (int)a_pointLights.size();
@@ -155,8 +271,8 @@ void ReflectionProbe::RenderScene(Microsoft::WRL::ComPtr<ID3D11RenderTargetView>
 			pixelShader->SetData("c_pointLights", &a_pointLights[0], sizeof(BasicLight) * pointLightCount);
 		if (pixelShader->HasVariable("c_pointLightCount"))
 			pixelShader->SetInt("c_pointLightCount", pointLightCount);
-		if (pixelShader->HasShaderResourceView("IrradianceMap"))
-			pixelShader->SetShaderResourceView("IrradianceMap", a_sky->GetEnvironmentMap());
+		if (pixelShader->HasVariable("c_irradianceSH"))
+			pixelShader->SetData("c_irradianceSH", a_sky->GetIrradianceSH().Coefficients, sizeof(SH9Color));
 		if (pixelShader->HasShaderResourceView("ReflectionMap"))
 			pixelShader->SetShaderResourceView("ReflectionMap", a_sky->GetReflectanceMap());
 		if (pixelShader->HasShaderResourceView("BRDFIntegrationMap"))
@@ -8,6 +8,7 @@
 #include "Entity.h"
 #include "Lights.h"
 #include "Sky.h"
+#include "RenderDevice.h"
 
 //-------------------------------------------------------
 // A ReflectionProbe represents a spherical volume of
@@ -22,6 +23,11 @@
 //	- This probe is real-time for interesting effects, but
 //	  could be abstracted out to a base class or set up
 //	  with a flag to toggle updating on/off
+//	- Updates can be split across frames with RenderFace,
+//	  PrefilterMip and Publish (see ReflectionProbeScheduler).
+//	  The reflection map is double buffered, and only the
+//	  front one is ever returned, so partial updates never
+//	  show
 //-------------------------------------------------------
 class ReflectionProbe
 {
@@ -41,6 +47,7 @@ public:
 	void Draw(
 		Microsoft::WRL::ComPtr<ID3D11Device> a_device,
 		Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext,
+		std::shared_ptr<RenderDevice> a_renderDevice, // Its cached bindings are dropped after the buffers are unbound around it
 		const std::vector<std::shared_ptr<Entity>>& a_entities,
 		const std::vector<BasicLight>& a_directionalLights,
 		const std::vector<BasicLight>& a_pointLights,
@@ -48,34 +55,65 @@ public:
 		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_brdfLookUp
 	);
 
+	// Time-sliced update steps. Every face must be rendered before any mip is prefiltered
+	void RenderFace(
+		Microsoft::WRL::ComPtr<ID3D11Device> a_device,
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext,
+		std::shared_ptr<RenderDevice> a_renderDevice,
+		unsigned int a_face,
+		const std::vector<std::shared_ptr<Entity>>& a_entities,
+		const std::vector<BasicLight>& a_directionalLights,
+		const std::vector<BasicLight>& a_pointLights,
+		const std::shared_ptr<Sky> a_sky,
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_brdfLookUp,
+		const std::vector<uint64_t>* a_visibilityMasks = nullptr, // Culling::CullSpheres output, nullptr draws everything
+		unsigned int a_viewIndex = 0
+	);
+	void PrefilterMip(
+		Microsoft::WRL::ComPtr<ID3D11Device> a_device,
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext,
+		std::shared_ptr<RenderDevice> a_renderDevice,
+		unsigned int a_mip,
+		Microsoft::WRL::ComPtr<ID3D11SamplerState> a_sampler
+	);
+	void Publish() { m_frontIndex = 1 - m_frontIndex; }
+
 	// Setters
 	void SetRadius(float a_radius) { m_radius = a_radius; }
 	void SetPosition(Vector3 a_position) { m_position = a_position; }
 
 	// Getters - use shorthand in header since they are so simple
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetReflectionMap() { return m_reflectionMap; }
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetReflectionMap() { return m_reflectionMaps[m_frontIndex]; }
+	unsigned int GetMipCount() { return m_mipCount; }
+	Matrix4 GetFaceViewProjectionMatrix(unsigned int a_face);
 	float GetRadius() { return m_radius; }
 	Vector3 GetPostiion() { return m_position; }
 
 protected:
 	// The core reflection map itself, created with dimensions equal to the
 	// box formed by the radius. Anytime the radius is changed this must be
-	// re-created
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_reflectionMap;
+	// re-created. Front and back, m_frontIndex is the one shown
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_reflectionMaps[2];
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_sceneCubeMap; // Used for pre-rendering for the reflection map
-	Microsoft::WRL::ComPtr<ID3D11Texture2D> m_reflectionMapTexture; // Stored to create Render Target Views
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> m_reflectionMapTextures[2]; // Stored to create Render Target Views
 	Microsoft::WRL::ComPtr<ID3D11Texture2D> m_sceneMapTexture;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> m_sceneDepthTexture; // Scene map sized, so faces don't depend on the back buffer's depth
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> m_sceneDepthDSV;
+	unsigned int m_frontIndex = 0;
+	unsigned int m_mipCount = 1;
 	float m_radius;
 	//Transform m_transform; Full Transform not required - no Scale or Rotation
 	Vector3 m_position;
 
-	// Storing shader references is icky. An AssetManager will help with that (and in several places in the Sky class)
+	// Resolved from Game's AssetManager handles when the probe is made. Game holds those for its lifetime, and the shared
+	// pointers keep the shaders alive after that, so there's nothing to gain from a lookup every face
 	std::shared_ptr<SimpleVertexShader> m_sceneVertexShader; // Unused or not necessary
 	std::shared_ptr<SimpleVertexShader> m_reflectionVertexShader;
 	std::shared_ptr<SimplePixelShader> m_scenePixelShader; // Unused or not necessary
 	std::shared_ptr<SimplePixelShader> m_reflectionPixelShader;
 
 	void BuildResources(Microsoft::WRL::ComPtr<ID3D11Device> a_d3dDevice);
+	std::shared_ptr<Camera> CreateFaceCamera(unsigned int a_face);
 	void RenderScene(
 		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> a_rtv,
 		Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext,
@@ -84,6 +122,8 @@ protected:
 		const std::vector<BasicLight>& a_pointLights,
 		const std::shared_ptr<Sky> a_sky,
 		std::shared_ptr<Camera> a_camera,
-		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_brdfLookUp
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_brdfLookUp,
+		const std::vector<uint64_t>* a_visibilityMasks,
+		unsigned int a_viewIndex
 	);
 };
@@ -0,0 +1,184 @@
+#include "ReflectionProbeScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+//-------------------------------------------------------
+// Starts with no probes
+//-------------------------------------------------------
+ReflectionProbeScheduler::ReflectionProbeScheduler(const ReflectionProbeSchedulerSettings& a_settings)
+	: m_settings(a_settings)
+{
+}
+
+//-------------------------------------------------------
+// Registers a probe. Indices are stable and never reused
+//-------------------------------------------------------
+unsigned int ReflectionProbeScheduler::AddProbe(const Vector3& a_position, float a_radius, unsigned int a_mipCount)
+{
+	ProbeState probe;
+	probe.Position = a_position;
+	probe.Radius = a_radius;
+	probe.MipCount = a_mipCount > 0 ? a_mipCount : 1;
+	m_probes.push_back(probe);
+	return (unsigned int)m_probes.size() - 1;
+}
+
+//-------------------------------------------------------
+// Moves or resizes a probe
+//-------------------------------------------------------
+void ReflectionProbeScheduler::SetProbeBounds(unsigned int a_probe, const Vector3& a_position, float a_radius)
+{
+	ProbeState& probe = m_probes[a_probe];
+	if (probe.Position.x != a_position.x || probe.Position.y != a_position.y || probe.Position.z != a_position.z || probe.Radius != a_radius)
+		probe.bChanged = true;
+	probe.Position = a_position;
+	probe.Radius = a_radius;
+}
+
+//-------------------------------------------------------
+// Scene change detection. Changes during an update let it
+// finish (so something close is shown) and queue another
+//-------------------------------------------------------
+void ReflectionProbeScheduler::SetSceneSignature(unsigned int a_probe, uint64_t a_signature)
+{
+	ProbeState& probe = m_probes[a_probe];
+	if (probe.Signature != a_signature)
+		probe.bChanged = true;
+	probe.Signature = a_signature;
+}
+
+void ReflectionProbeScheduler::MarkChanged(unsigned int a_probe)
+{
+	m_probes[a_probe].bChanged = true;
+}
+
+//-------------------------------------------------------
+// Hands out this frame's budget
+//	- In-progress probes first (highest priority first),
+//	  so updates finish quickly and few are ever in flight
+//	- Then probes that need an update, by priority, while
+//	  any face budget is left to start them with
+//	- Mips only run once all 6 faces of that probe are
+//	  rendered, since they prefilter the whole scene cube
+//-------------------------------------------------------
+const std::vector<ProbeUpdateStep>& ReflectionProbeScheduler::Schedule(const Vector3& a_cameraPosition)
+{
+	m_steps.clear();
+	for (ProbeState& probe : m_probes) {
+		probe.FramesSincePublish++;
+	}
+
+	m_candidates.clear();
+	for (unsigned int i = 0; i < m_probes.size(); i++) {
+		const ProbeState& probe = m_probes[i];
+		if (probe.bUpdating || NeedsUpdate(probe))
+			m_candidates.push_back(std::make_pair(GetPriority(probe, a_cameraPosition), i));
+	}
+	std::sort(m_candidates.begin(), m_candidates.end(), [this](const std::pair<float, unsigned int>& a_left, const std::pair<float, unsigned int>& a_right) {
+		bool bLeftUpdating = m_probes[a_left.second].bUpdating;
+		if (bLeftUpdating != m_probes[a_right.second].bUpdating)
+			return bLeftUpdating;
+		return a_left.first != a_right.first ? a_left.first > a_right.first : a_left.second < a_right.second;
+	});
+
+	unsigned int faceBudget = m_settings.FacesPerFrame;
+	unsigned int mipBudget = m_settings.MipsPerFrame;
+	for (const std::pair<float, unsigned int>& candidate : m_candidates) {
+		if (faceBudget == 0 && mipBudget == 0)
+			break;
+
+		ProbeState& probe = m_probes[candidate.second];
+		if (!probe.bUpdating) {
+			if (faceBudget == 0)
+				continue; // Nothing to start it with, but in-progress probes may still have mips to run
+			probe.bUpdating = true;
+			probe.bChanged = false;
+			probe.NextFace = 0;
+			probe.NextMip = 0;
+		}
+
+		while (probe.NextFace < PROBE_FACE_COUNT && faceBudget > 0) {
+			m_steps.push_back({ ProbeUpdateStepType::RenderFace, candidate.second, probe.NextFace });
+			probe.NextFace++;
+			faceBudget--;
+		}
+		if (probe.NextFace < PROBE_FACE_COUNT)
+			continue;
+
+		while (probe.NextMip < probe.MipCount && mipBudget > 0) {
+			m_steps.push_back({ ProbeUpdateStepType::PrefilterMip, candidate.second, probe.NextMip });
+			probe.NextMip++;
+			mipBudget--;
+		}
+		if (probe.NextMip < probe.MipCount)
+			continue;
+
+		m_steps.push_back({ ProbeUpdateStepType::Publish, candidate.second, 0 });
+		probe.bUpdating = false;
+		probe.bReady = true;
+		probe.FramesSincePublish = 0;
+	}
+	return m_steps;
+}
+
+//-------------------------------------------------------
+// Getters
+//-------------------------------------------------------
+bool ReflectionProbeScheduler::IsProbeReady(unsigned int a_probe) const
+{
+	return m_probes[a_probe].bReady;
+}
+
+bool ReflectionProbeScheduler::IsProbeUpdating(unsigned int a_probe) const
+{
+	return m_probes[a_probe].bUpdating;
+}
+
+unsigned int ReflectionProbeScheduler::GetFramesSincePublish(unsigned int a_probe) const
+{
+	return m_probes[a_probe].FramesSincePublish;
+}
+
+unsigned int ReflectionProbeScheduler::GetProbeCount() const
+{
+	return (unsigned int)m_probes.size();
+}
+
+void ReflectionProbeScheduler::SetSettings(const ReflectionProbeSchedulerSettings& a_settings)
+{
+	m_settings = a_settings;
+}
+
+const ReflectionProbeSchedulerSettings& ReflectionProbeScheduler::GetSettings() const
+{
+	return m_settings;
+}
+
+//-------------------------------------------------------
+// Changed, never drawn, or due for a periodic refresh
+//-------------------------------------------------------
+bool ReflectionProbeScheduler::NeedsUpdate(const ProbeState& a_probe) const
+{
+	if (a_probe.bChanged || !a_probe.bReady)
+		return true;
+	return m_settings.RefreshInterval > 0 && a_probe.FramesSincePublish >= m_settings.RefreshInterval;
+}
+
+//-------------------------------------------------------
+// Higher runs sooner. The camera inside a probe counts as
+// distance 0, and every frame waited adds a little so far
+// probes are never starved
+//-------------------------------------------------------
+float ReflectionProbeScheduler::GetPriority(const ProbeState& a_probe, const Vector3& a_cameraPosition) const
+{
+	float x = a_probe.Position.x - a_cameraPosition.x;
+	float y = a_probe.Position.y - a_cameraPosition.y;
+	float z = a_probe.Position.z - a_cameraPosition.z;
+	float distance = std::fmax(std::sqrt(x * x + y * y + z * z) - a_probe.Radius, 0.f);
+
+	float priority = (1.f + a_probe.FramesSincePublish * 0.01f) / (1.f + distance * m_settings.DistanceFalloff);
+	if (a_probe.bChanged || !a_probe.bReady)
+		priority *= m_settings.ChangeBoost;
+	return priority;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Types.h"
+
+#define PROBE_FACE_COUNT 6
+
+//-------------------------------------------------------
+// Per-frame budgets and priority weights for probe updates
+//-------------------------------------------------------
+struct ReflectionProbeSchedulerSettings {
+	unsigned int FacesPerFrame = 1; // Scene cube faces rendered per frame, over all probes
+	unsigned int MipsPerFrame = 2; // Reflection map mips prefiltered per frame (all 6 faces of one mip each)
+	unsigned int RefreshInterval = 0; // Frames after which an unchanged probe is redrawn anyway. 0 never redraws
+	float DistanceFalloff = 0.1f; // Priority is divided by 1 + distance outside the probe * this
+	float ChangeBoost = 8.f; // Priority multiplier for probes whose surroundings changed
+};
+
+enum class ProbeUpdateStepType {
+	RenderFace, // Render one face of the probe's scene cube
+	PrefilterMip, // Prefilter one mip of the probe's back reflection map from the scene cube
+	Publish // Every face and mip is done - swap the back reflection map to the front
+};
+
+struct ProbeUpdateStep {
+	ProbeUpdateStepType Type;
+	unsigned int Probe; // Index returned by AddProbe
+	unsigned int Index; // Face or mip, unused by Publish
+};
+
+//-------------------------------------------------------
+// Decides which reflection probe work runs each frame, so
+// any number of live probes costs at most FacesPerFrame
+// face renders and MipsPerFrame prefilter passes
+//	- A probe update is its 6 faces, then its mips, then a
+//	  Publish. Probes keep a front and back reflection map
+//	  and only swap on Publish, so a half updated probe is
+//	  never visible
+//	- Updates already in progress always continue first.
+//	  New ones start in priority order: probes whose scene
+//	  signature changed are boosted, nearby probes beat far
+//	  ones, and waiting probes slowly gain priority
+//	- Pure bookkeeping without D3D, so the headless
+//	  "probe-sched" command can check the budgets and
+//	  latencies with thousands of simulated probes
+//-------------------------------------------------------
+class ReflectionProbeScheduler
+{
+public:
+	ReflectionProbeScheduler(const ReflectionProbeSchedulerSettings& a_settings = ReflectionProbeSchedulerSettings());
+
+	// New probes need a first update before they are ready
+	unsigned int AddProbe(const Vector3& a_position, float a_radius, unsigned int a_mipCount);
+	void SetProbeBounds(unsigned int a_probe, const Vector3& a_position, float a_radius); // Marks the probe changed if it moved
+
+	// Anything hashed from what the probe sees (entities in range, lights...). A new value marks the probe changed
+	void SetSceneSignature(unsigned int a_probe, uint64_t a_signature);
+	void MarkChanged(unsigned int a_probe);
+
+	// Work for this frame, in execution order. Valid until the next call
+	const std::vector<ProbeUpdateStep>& Schedule(const Vector3& a_cameraPosition);
+
+	bool IsProbeReady(unsigned int a_probe) const; // Published at least once
+	bool IsProbeUpdating(unsigned int a_probe) const;
+	unsigned int GetFramesSincePublish(unsigned int a_probe) const;
+	unsigned int GetProbeCount() const;
+
+	void SetSettings(const ReflectionProbeSchedulerSettings& a_settings);
+	const ReflectionProbeSchedulerSettings& GetSettings() const;
+
+private:
+	struct ProbeState {
+		Vector3 Position;
+		float Radius = 0.f;
+		unsigned int MipCount = 1;
+		uint64_t Signature = 0;
+		bool bChanged = true; // Needs an update, set by changes arriving at any time
+		bool bUpdating = false;
+		bool bReady = false;
+		unsigned int NextFace = 0;
+		unsigned int NextMip = 0;
+		unsigned int FramesSincePublish = 0;
+	};
+
+	bool NeedsUpdate(const ProbeState& a_probe) const;
+	float GetPriority(const ProbeState& a_probe, const Vector3& a_cameraPosition) const;
+
+	ReflectionProbeSchedulerSettings m_settings;
+	std::vector<ProbeState> m_probes;
+	std::vector<ProbeUpdateStep> m_steps;
+	std::vector<std::pair<float, unsigned int>> m_candidates; // Priority, probe. Kept to avoid reallocating every frame
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+//-------------------------------------------------------
+// Abstract device/context interface for the parts of a
+// frame that are pure submission: geometry buffers,
+// constant uploads, binds and draw/dispatch calls.
+//	- Deliberately free of any D3D or Windows headers, so
+//	  that Mesh (and anything that only submits through this)
+//	  compiles and runs headless on any platform
+//	- D3D11RenderDevice is the real backend, NullRenderDevice
+//	  records commands and statistics without a GPU
+//	- Resources are referenced by opaque integer handles
+//	  rather than COM pointers. A handle of 0 is always invalid
+//	- SimpleShader creates, uploads and binds its constant
+//	  buffers through this. Shader objects, SRV/sampler/UAV
+//	  binds, Sky's IBL passes and the post process stack still
+//	  talk to D3D directly, behind
+//	  D3D11RenderDevice::GetD3DDevice/GetD3DContext
+//-------------------------------------------------------
+
+typedef unsigned int RenderHandle;
+#define INVALID_RENDER_HANDLE 0
+
+// What a buffer will be bound as
+enum class BufferType {
+	Vertex = 0,
+	Index,
+	Constant
+};
+
+// Immutable buffers are written once at creation, Dynamic ones can be updated every frame
+enum class BufferUsage {
+	Immutable = 0,
+	Dynamic
+};
+
+// Pipeline stages a constant buffer can be bound to
+enum class ShaderStage {
+	Vertex = 0,
+	Pixel,
+	Domain,
+	Hull,
+	Geometry,
+	Compute
+};
+
+enum class PrimitiveTopology {
+	TriangleList = 0,
+	TriangleStrip,
+	LineList,
+	PointList
+};
+
+// Number of primitives a draw of a_vertexCount vertices (or indices) produces
+inline unsigned long long CountPrimitives(PrimitiveTopology a_topology, unsigned int a_vertexCount)
+{
+	switch (a_topology) {
+	case PrimitiveTopology::TriangleList: return a_vertexCount / 3;
+	case PrimitiveTopology::TriangleStrip: return a_vertexCount > 2 ? a_vertexCount - 2 : 0;
+	case PrimitiveTopology::LineList: return a_vertexCount / 2;
+	default: return a_vertexCount;
+	}
+}
+
+// Counters for everything submitted through a device during one frame
+//	- Reset by BeginFrame(), so read them after EndFrame() for the last full frame
+struct RenderDeviceStats {
+	unsigned int DrawCalls;
+	unsigned int IndexedDrawCalls;
+	unsigned int Dispatches;
+	unsigned long long PrimitivesSubmitted;	// Triangles for list topologies
+	unsigned int BufferUpdates;
+	unsigned long long BytesUploaded;
+	unsigned int VertexBufferBinds;
+	unsigned int IndexBufferBinds;
+	unsigned int ConstantBufferBinds;
+	unsigned int RedundantBindsSkipped;		// Binds filtered because the same handle was already bound
+	unsigned int BuffersCreated;
+	unsigned int BuffersReleased;
+
+	void Reset() { *this = RenderDeviceStats(); }
+};
+
+class RenderDevice
+{
+public:
+	RenderDevice() : m_frameStats() {}
+	virtual ~RenderDevice() {}
+
+	virtual const char* GetName() const = 0;
+
+	// Resource creation and updating
+	//	- a_data may be nullptr for Dynamic buffers that are filled later
+	virtual RenderHandle CreateBuffer(BufferType a_type, BufferUsage a_usage, const void* a_data, unsigned int a_byteSize) = 0;
+	virtual void UpdateBuffer(RenderHandle a_buffer, const void* a_data, unsigned int a_byteSize) = 0;
+	virtual void ReleaseBuffer(RenderHandle a_buffer) = 0;
+
+	// Input assembler state
+	virtual void SetVertexBuffer(RenderHandle a_buffer, unsigned int a_stride) = 0;
+	virtual void SetIndexBuffer(RenderHandle a_buffer) = 0;
+	virtual void SetPrimitiveTopology(PrimitiveTopology a_topology) = 0;
+
+	// Shader constants. Not cached, since SimpleShader rebinds its buffers with every SetShader and
+	// ImGui binds its own straight through the context
+	virtual void SetConstantBuffer(ShaderStage a_stage, unsigned int a_slot, RenderHandle a_buffer) = 0;
+
+	// Work submission
+	virtual void Draw(unsigned int a_vertexCount, unsigned int a_startVertex) = 0;
+	virtual void DrawIndexed(unsigned int a_indexCount, unsigned int a_startIndex, int a_baseVertex) = 0;
+	virtual void Dispatch(unsigned int a_groupsX, unsigned int a_groupsY, unsigned int a_groupsZ) = 0;
+
+	// Frame bracketing. Presenting is left to whoever owns the swap chain (if there is one)
+	virtual void BeginFrame() { m_frameStats.Reset(); InvalidateState(); }
+	virtual void EndFrame() { InvalidateState(); }
+
+	// Forget any cached bindings, for when something outside the device (ImGui, SimpleShader, etc.)
+	// may have touched the same pipeline state
+	virtual void InvalidateState() = 0;
+
+	const RenderDeviceStats& GetFrameStats() const { return m_frameStats; }
+
+protected:
+	RenderDeviceStats m_frameStats;
+};
@@ -1,5 +1,6 @@
 #include "Renderer.h"
 #include "Helpers.h"
+#include "Culling.h"
 
 // Possibly not all of the imgui headers are necessary, since no setup is being done here
 #include "imgui/imgui.h"
@@ -8,6 +9,9 @@
 
 #include "simpleshader/SimpleShader.h"
 
+#include <cstring>
+#include <cmath>
+
 using namespace DirectX;
 
 //----------------------------------------------------
@@ -19,6 +23,7 @@ using namespace DirectX;
 Renderer::Renderer(
 	Microsoft::WRL::ComPtr<ID3D11Device> a_device,
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context,
+	std::shared_ptr<RenderDevice> a_renderDevice,
 	Microsoft::WRL::ComPtr<IDXGISwapChain> a_swapChain,
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> a_backBufferRTV,
 	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> a_depthBufferDSV,
@@ -28,6 +33,7 @@ Renderer::Renderer(
 )
 	: m_device(a_device)
 	, m_context(a_context)
+	, m_renderDevice(a_renderDevice)
 	, m_swapChain(a_swapChain)
 	, m_backBufferRTV(a_backBufferRTV)
 	, m_depthBufferDSV(a_depthBufferDSV)
@@ -35,6 +41,18 @@ Renderer::Renderer(
 	, m_postProcessVS(a_fullscreenVS)
 	, m_windowWidth(a_windowWidth)
 	, m_windowHeight(a_windowHeight)
+	, m_ssaoBlurMode(SSAO_BLUR_SEPARABLE)
+	, m_ssaoBlurDepthSigma(0.1f)
+	, m_ssaoResolution(SSAO_RESOLUTION_FULL)
+	, m_ssaoReducedFactor(0)
+	, m_lodPixelError(RENDERER_LOD_PIXEL_ERROR)
+	, m_bMeshletCulling(true)
+	, m_bSSAOTemporal(false)
+	, m_bSSAOHistoryValid(false)
+	, m_ssaoHistoryCamera(nullptr)
+	, m_ssaoHistoryResolution(SSAO_RESOLUTION_FULL)
+	, m_ssaoHistoryIndex(0)
+	, m_ssaoFrameIndex(0)
 {
 	// Build Resources, RTVs, and SRVs for multiple render targets
 	//	- Targets needed is pretty narrowed in to the specific post-process (in this case SSAO),
@@ -45,19 +63,22 @@ Renderer::Renderer(
 	PostResize(m_windowWidth, m_windowHeight, m_backBufferRTV, m_depthBufferDSV);
 
 	// Create SSAO-related resources
-	m_ssaoCoreCS = std::make_shared<SimpleComputeShader>(m_device, m_context, FixPath(L"ScreenSpaceAmbientOcclusionCS.cso").c_str());
-	m_ssaoBlurCS = std::make_shared<SimpleComputeShader>(m_device, m_context, FixPath(L"FiveByFiveBlurCS.cso").c_str());
-	m_ssaoCombinePS = std::make_shared<SimplePixelShader>(m_device, m_context, FixPath(L"SSAOCombinePS.cso").c_str());
-
-	const int offsetTextureSize = 4, totalPixels = offsetTextureSize * offsetTextureSize;
-	Color randomPixels[totalPixels] = {};
-	for (int i = 0; i < totalPixels; i++) {
-		XMVECTOR randVec = XMVectorSet(
-			GenerateRandomFloat(-1.f, 1.f),
-			GenerateRandomFloat(-1.f, 1.f),
-			0.f, 0.f);
-		XMStoreFloat4(&randomPixels[i], XMVector3Normalize(randVec));
-	}
+	m_ssaoCoreCS = std::make_shared<SimpleComputeShader>(m_device, m_context, m_renderDevice, FixPath(L"ScreenSpaceAmbientOcclusionCS.cso").c_str());
+	m_ssaoBlurCS = std::make_shared<SimpleComputeShader>(m_device, m_context, m_renderDevice, FixPath(L"FiveByFiveBlurCS.cso").c_str());
+	m_ssaoBlurHorizontalCS = std::make_shared<SimpleComputeShader>(m_device, m_context, m_renderDevice, FixPath(L"SeparableBlurHorizontalCS.cso").c_str());
+	m_ssaoBlurVerticalCS = std::make_shared<SimpleComputeShader>(m_device, m_context, m_renderDevice, FixPath(L"SeparableBlurVerticalCS.cso").c_str());
+	m_ssaoDownsampleCS = std::make_shared<SimpleComputeShader>(m_device, m_context, m_renderDevice, FixPath(L"SSAODownsampleCS.cso").c_str());
+	m_ssaoUpsampleCS = std::make_shared<SimpleComputeShader>(m_device, m_context, m_renderDevice, FixPath(L"SSAOUpsampleCS.cso").c_str());
+	m_ssaoTemporalCS = std::make_shared<SimpleComputeShader>(m_device, m_context, m_renderDevice, FixPath(L"SSAOTemporalCS.cso").c_str());
+	m_ssaoCombinePS = std::make_shared<SimplePixelShader>(m_device, m_context, m_renderDevice, FixPath(L"SSAOCombinePS.cso").c_str());
+
+	// Kernel and random rotations come from the CPU reference so captures can be replayed exactly
+	SSAOReference::GenerateRandomTexture(m_ssaoSettings.RandomTexture, SSAO_KERNEL_SEED);
+	SSAOReference::GenerateKernel(m_ssaoSettings.Offsets, SSAO_MAX_SAMPLES, SSAO_KERNEL_SEED); // Max size of array in shader cbuffer
+	m_ssaoSettings.Radius = 1.f;
+	m_ssaoSettings.Samples = SSAO_MAX_SAMPLES;
+
+	const int offsetTextureSize = SSAO_RANDOM_TEXTURE_SIZE;
 	// Create Texture and SRV
 	D3D11_TEXTURE2D_DESC randDesc = {};
 	randDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT; // Store raw float data (should pack in, but a 4x4 texture is fine)
@@ -71,7 +92,7 @@ Renderer::Renderer(
 
 	D3D11_SUBRESOURCE_DATA data = {};
 	data.SysMemPitch = offsetTextureSize * sizeof(Color);
-	data.pSysMem = &randomPixels[0];
+	data.pSysMem = &m_ssaoSettings.RandomTexture[0];
 
 	Microsoft::WRL::ComPtr<ID3D11Texture2D> tex;
 	m_device->CreateTexture2D(&randDesc, &data, tex.GetAddressOf());
@@ -83,26 +104,6 @@ Renderer::Renderer(
 	srvDesc.Texture2D.MostDetailedMip = 0;
 	m_device->CreateShaderResourceView(tex.Get(), &srvDesc, m_ssaoRandomOffsets.GetAddressOf());
 
-	// Generate vector of offset values
-	const int offsetVectorCount = 64; // Max size of array in shader cbuffer
-	Vector4 ssaoOffsets[offsetVectorCount] = {};
-	for (int i = 0; i < offsetVectorCount; i++) {
-		ssaoOffsets[i] = Vector4(
-			GenerateRandomFloat(-1.f, 1.f),
-			GenerateRandomFloat(-1.f, 1.f),
-			GenerateRandomFloat(), 0.f);
-		XMVECTOR offset = XMVector3Normalize(XMLoadFloat4(&ssaoOffsets[i]));
-
-		// Scale over array size such that more values are closer to the minimum than maximum - why?
-		float scale = (float)i / 64.f;
-		XMVECTOR accelerateScale = XMVectorLerp(
-			XMVectorSet(0.1f, 0.1f, 0.1f, 1.f),
-			XMVectorSet(1.f, 1.f, 1.f, 1.f), scale * scale); // Why scale * scale?
-		XMStoreFloat4(&ssaoOffsets[i], XMVectorMultiply(offset, accelerateScale));
-	}
-	m_ssaoOffsets = std::vector<Vector4>();
-	m_ssaoOffsets.insert(m_ssaoOffsets.begin(), ssaoOffsets, ssaoOffsets + offsetVectorCount);
-
 	// Fill out sampler states
 	D3D11_SAMPLER_DESC sampleDesc = {};
 	sampleDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
@@ -151,6 +152,28 @@ void Renderer::PreResize()
 	for (Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& srv : m_ppSRVs) {
 		srv.Reset();
 	}
+
+	// Clear reduced resolution SSAO Views. They are rebuilt on demand by PostProcess
+	for (Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView>& uav : m_reducedUAVs) {
+		uav.Reset();
+	}
+	for (Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& srv : m_reducedSRVs) {
+		srv.Reset();
+	}
+	m_ssaoReducedFactor = 0;
+
+	// Clear temporal SSAO history - it no longer lines up with the screen
+	for (Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView>& uav : m_historyUAVs) {
+		uav.Reset();
+	}
+	for (Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& srv : m_historySRVs) {
+		srv.Reset();
+	}
+	m_previousDepthTexture.Reset();
+	m_previousNormalTexture.Reset();
+	m_previousDepthSRV.Reset();
+	m_previousNormalSRV.Reset();
+	m_bSSAOHistoryValid = false;
 }
 
 //----------------------------------------------------
@@ -225,6 +248,31 @@ void Renderer::PostResize(unsigned int a_windowWidth, unsigned int a_windowHeigh
 		m_device->CreateUnorderedAccessView(tex.Get(), &uavDesc, m_ppUAVs[i].GetAddressOf());
 		m_device->CreateShaderResourceView(tex.Get(), &srvDesc, m_ppSRVs[i].GetAddressOf());
 	}
+
+	// Temporal SSAO history. The resolved and partial cycle AO and their counts ping-pong between two targets,
+	// and last frame's depth and normals are copied aside so disocclusion can be detected
+	rtDesc.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+	srvDesc.Format = rtDesc.Format;
+	uavDesc.Format = rtDesc.Format;
+	for (int i = 0; i < 2; i++) {
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> tex;
+		m_device->CreateTexture2D(&rtDesc, nullptr, tex.GetAddressOf());
+
+		m_device->CreateUnorderedAccessView(tex.Get(), &uavDesc, m_historyUAVs[i].GetAddressOf());
+		m_device->CreateShaderResourceView(tex.Get(), &srvDesc, m_historySRVs[i].GetAddressOf());
+	}
+
+	rtDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE; // Only ever written by CopyResource
+	rtDesc.Format = DXGI_FORMAT_R32_FLOAT;
+	srvDesc.Format = rtDesc.Format;
+	m_device->CreateTexture2D(&rtDesc, nullptr, m_previousDepthTexture.GetAddressOf());
+	m_device->CreateShaderResourceView(m_previousDepthTexture.Get(), &srvDesc, m_previousDepthSRV.GetAddressOf());
+
+	rtDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	srvDesc.Format = rtDesc.Format;
+	m_device->CreateTexture2D(&rtDesc, nullptr, m_previousNormalTexture.GetAddressOf());
+	m_device->CreateShaderResourceView(m_previousNormalTexture.Get(), &srvDesc, m_previousNormalSRV.GetAddressOf());
+	m_bSSAOHistoryValid = false;
 }
 
 //----------------------------------------------------
@@ -233,6 +281,8 @@ void Renderer::PostResize(unsigned int a_windowWidth, unsigned int a_windowHeigh
 //----------------------------------------------------
 void Renderer::FrameStart()
 {
+	m_renderDevice->BeginFrame();
+
 	// Clear the back buffer (erases what's on the screen)
 	float bgColor[4] = { 0.4f, 0.6f, 0.75f, 1.0f }; // Cornflower Blue
 	m_context->ClearRenderTargetView(m_backBufferRTV.Get(), bgColor);
@@ -290,6 +340,8 @@ void Renderer::FrameEnd(bool a_vsync)
 
 	// Must re-bind buffers after presenting, as they become unbound
 	m_context->OMSetRenderTargets(1, m_backBufferRTV.GetAddressOf(), m_depthBufferDSV.Get());
+
+	m_renderDevice->EndFrame();
 }
 
 //----------------------------------------------------
@@ -302,60 +354,112 @@ void Renderer::FrameEnd(bool a_vsync)
 //	- Could be optimized by passing in a single Scene
 //	  object (also a const reference or ptr, since
 //	  internally it would store lots of data)
-//	- Many optimizations could be done in this step,
-//	  including entity culling and sorting by Material
-//	  to minimize data transfers
-//		- For now is just a basic, brute force simple
-//		  operation
+//	- Entities are drawn sorted by shader, Material, and
+//	  Mesh (then front to back) to minimize state changes
+//	- Entities whose bit a_viewIndex is clear in
+//	  a_visibilityMasks are culled before sorting
 //----------------------------------------------------
 void Renderer::Render(
 	const std::vector<std::shared_ptr<Entity>>& a_entities, 
 	const std::vector<BasicLight>& a_allLights, 
 	const std::shared_ptr<Camera>& a_camera, 
-	const std::shared_ptr<Sky>& a_sky)
+	const std::shared_ptr<Sky>& a_sky,
+	const std::vector<uint64_t>* a_visibilityMasks,
+	unsigned int a_viewIndex)
 {
 	// First sort Lights by type (passed in as a single array to minimize parameters)
 	//	- Will be fixed by adding a Scene type
-	std::vector<BasicLight> directionalLights;
-	std::vector<BasicLight> pointLights;
-	for (const BasicLight& light : a_allLights) {
-		if (light.Type == LightType::Directional) {
-			directionalLights.push_back(light);
+	FramePrep::BinLightsByType(a_allLights, m_directionalLights, m_pointLights);
+
+	// Build and sort the draw list
+	Matrix4 viewMatrix = a_camera->GetViewMatrix();
+	XMMATRIX view = XMLoadFloat4x4(&viewMatrix);
+	float farPlane = a_camera->GetFarClipDistance();
+	Vector3 cameraPosition = a_camera->GetTransform()->GetPosition();
+	float pixelsPerUnit = (float)m_windowHeight / (2.f * tanf(a_camera->GetFieldOfView() * 0.5f));
+	Frustum frustum = Culling::ExtractFrustum(a_camera->GetViewProjectionMatrix());
+	m_meshletRanges.resize(a_entities.size());
+	m_drawItems.clear();
+	for (unsigned int i = 0; i < (unsigned int)a_entities.size(); i++) {
+		if (a_visibilityMasks && !((*a_visibilityMasks)[i] & (1ull << a_viewIndex)))
+			continue;
+
+		const std::shared_ptr<Entity>& entity = a_entities[i];
+		std::shared_ptr<Material> material = entity->GetMaterial();
+
+		Vector3 position = entity->GetTransform()->GetPosition();
+		float viewDepth = XMVectorGetZ(XMVector3Transform(XMLoadFloat3(&position), view));
+
+		DrawItem item = {};
+		item.Index = i;
+
+		// LOD from how large the Mesh's simplification error would be on screen. The distance is to
+		// the bounding sphere rather than its centre, so large objects refine as soon as any part is close
+		std::shared_ptr<Mesh> mesh = entity->GetMesh();
+		Matrix4 world = entity->GetTransform()->GetWorldTransformMatrix();
+		if (mesh->GetLODCount() > 1 && m_lodPixelError > 0.f) {
+			Vector4 localSphere = mesh->GetBoundingSphere();
+			Vector4 worldSphere = Culling::TransformSphere(localSphere, world);
+			float worldScale = localSphere.w > 0.f ? worldSphere.w / localSphere.w : 1.f;
+			float dx = worldSphere.x - cameraPosition.x;
+			float dy = worldSphere.y - cameraPosition.y;
+			float dz = worldSphere.z - cameraPosition.z;
+			float distance = sqrtf(dx * dx + dy * dy + dz * dz) - worldSphere.w;
+			entity->SetLOD(FramePrep::SelectLOD(mesh->GetLODErrors(), mesh->GetLODCount(), worldScale, distance,
+				pixelsPerUnit, m_lodPixelError, RENDERER_LOD_HYSTERESIS, entity->GetLOD()));
+		}
+		else {
+			entity->SetLOD(0);
 		}
-		else if (light.Type == LightType::Point) {
-			pointLights.push_back(light);
+
+		// Meshes drawn at full detail with Meshlets only draw the ones facing the camera inside the frustum.
+		// An Entity with none left is dropped from the draw list
+		std::vector<MeshletDrawRange>& ranges = m_meshletRanges[i];
+		ranges.clear();
+		if (m_bMeshletCulling && entity->GetLOD() == 0 && !mesh->GetMeshlets().empty()) {
+			if (Meshlets::Cull(mesh->GetMeshlets(), world, frustum, cameraPosition, ranges) == 0)
+				continue;
 		}
-		// else do nothing (all other types) - no spot lights have been implemented YET
+
+		item.SortKey = FramePrep::MakeOpaqueSortKey(
+			GetSortId(material->GetPixelShader().get()),
+			GetSortId(material.get()),
+			GetSortId(mesh.get()),
+			viewDepth, farPlane);
+		m_drawItems.push_back(item);
 	}
+	FramePrep::SortDrawItems(m_drawItems, m_drawItemScratch);
 
 	// Render all opaque entities (transparent entities don't exist, so opaque is everything)
-	for (std::shared_ptr<Entity> entity : a_entities) {
+	for (const DrawItem& item : m_drawItems) {
+		const std::shared_ptr<Entity>& entity = a_entities[item.Index];
 		std::shared_ptr<SimplePixelShader> pixelShader = entity->GetMaterial()->GetPixelShader();
 
 		// Set Light Data
-		int directionalLightCount = (int)directionalLights.size();
-		int pointLightCount = (int)pointLights.size();
+		int directionalLightCount = (int)m_directionalLights.size();
+		int pointLightCount = (int)m_pointLights.size();
 		// Directionals
 		if (pixelShader->HasVariable("c_directionalLights") && directionalLightCount > 0)
-			pixelShader->SetData("c_directionalLights", &directionalLights[0], sizeof(BasicLight) * directionalLightCount);
+			pixelShader->SetData("c_directionalLights", &m_directionalLights[0], sizeof(BasicLight) * directionalLightCount);
 		if (pixelShader->HasVariable("c_directionalLightCount"))
 			pixelShader->SetInt("c_directionalLightCount", directionalLightCount);
 		// Points
 		if (pixelShader->HasVariable("c_pointLights") && pointLightCount > 1)
-			pixelShader->SetData("c_pointLights", &pointLights[0], sizeof(BasicLight) * pointLightCount);
+			pixelShader->SetData("c_pointLights", &m_pointLights[0], sizeof(BasicLight) * pointLightCount);
 		if (pixelShader->HasVariable("c_pointLightCount"))
 			pixelShader->SetInt("c_pointLightCount", pointLightCount);
 
 		// Set IBL Maps
-		if (pixelShader->HasShaderResourceView("IrradianceMap"))
-			pixelShader->SetShaderResourceView("IrradianceMap", a_sky->GetEnvironmentMap());
+		if (pixelShader->HasVariable("c_irradianceSH"))
+			pixelShader->SetData("c_irradianceSH", a_sky->GetIrradianceSH().Coefficients, sizeof(SH9Color));
 		if (pixelShader->HasShaderResourceView("ReflectionMap"))
 			pixelShader->SetShaderResourceView("ReflectionMap", a_sky->GetReflectanceMap());
 		if (pixelShader->HasShaderResourceView("BRDFIntegrationMap"))
 			pixelShader->SetShaderResourceView("BRDFIntegrationMap", m_iblBRDFLookupTexture);
 
 		// Draw Entity
-		entity->Draw(m_context, a_camera);
+		const std::vector<MeshletDrawRange>& ranges = m_meshletRanges[item.Index];
+		entity->Draw(m_context, a_camera, ranges.empty() ? nullptr : &ranges);
 	}
 
 	// Draw Sky after all Entities
@@ -377,6 +481,67 @@ void Renderer::PostProcess(std::shared_ptr<Camera> a_camera)
 {
 	DisplayRenderTextures({ RT_SCENE_COLOR, RT_SCENE_AMBIENT, RT_SCENE_NORMAL, RT_SCENE_DEPTH }, {});
 
+	ImGui::Begin("MRT Displays");
+	bool bCaptureSSAO = ImGui::Button("Capture SSAO G-Buffer"); // Saved after the SSAO pass so the GPU result is included
+	const char* blurModes[] = { "5x5 Box", "Separable", "Separable Bilateral" };
+	ImGui::Combo("SSAO Blur", &m_ssaoBlurMode, blurModes, SSAO_BLUR_COUNT);
+	const char* resolutions[] = { "Full", "Half", "Quarter" };
+	ImGui::Combo("SSAO Resolution", &m_ssaoResolution, resolutions, SSAO_RESOLUTION_COUNT);
+	ImGui::Checkbox("Temporal SSAO", &m_bSSAOTemporal);
+	if (m_ssaoBlurMode == SSAO_BLUR_BILATERAL)
+		ImGui::SliderFloat("Blur Depth Sigma", &m_ssaoBlurDepthSigma, 0.01f, 0.5f);
+	ImGui::End();
+
+	// Temporal SSAO evaluates a rotating slice of the kernel each frame. History is only usable when the
+	// previous frame was also temporal, from the same Camera, at the same SSAO resolution
+	bool bIsHistoryValid = m_bSSAOHistoryValid && m_ssaoHistoryCamera == a_camera.get() && m_ssaoHistoryResolution == m_ssaoResolution;
+	unsigned int ssaoSamples = m_ssaoSettings.Samples;
+	unsigned int ssaoSampleStart = 0;
+	if (m_bSSAOTemporal) {
+		ssaoSamples = m_ssaoTemporalSettings.SamplesPerFrame;
+		ssaoSampleStart = (m_ssaoFrameIndex * ssaoSamples) % SSAO_MAX_SAMPLES;
+		m_ssaoFrameIndex++;
+	}
+
+	// Reduced resolution SSAO runs the core pass on downsampled depth/normals, then upsamples into
+	// PPT_PASS_ZERO so everything after it is unchanged
+	unsigned int ssaoFactor = 1u << m_ssaoResolution;
+	bool bIsReduced = ssaoFactor > 1;
+	if (bIsReduced && ssaoFactor != m_ssaoReducedFactor)
+		CreateReducedTargets(ssaoFactor);
+	unsigned int ssaoWidth = (m_windowWidth + ssaoFactor - 1) / ssaoFactor;
+	unsigned int ssaoHeight = (m_windowHeight + ssaoFactor - 1) / ssaoFactor;
+
+	if (bIsReduced) {
+		m_ssaoDownsampleCS->SetShader();
+
+		DirectX::XMINT2 fullDimensions(m_windowWidth, m_windowHeight);
+		DirectX::XMINT2 reducedDimensions(ssaoWidth, ssaoHeight);
+		if (m_ssaoDownsampleCS->HasVariable("c_fullDimensions"))
+			m_ssaoDownsampleCS->SetData("c_fullDimensions", &fullDimensions, sizeof(DirectX::XMINT2));
+		if (m_ssaoDownsampleCS->HasVariable("c_reducedDimensions"))
+			m_ssaoDownsampleCS->SetData("c_reducedDimensions", &reducedDimensions, sizeof(DirectX::XMINT2));
+		if (m_ssaoDownsampleCS->HasVariable("c_factor"))
+			m_ssaoDownsampleCS->SetInt("c_factor", (int)ssaoFactor);
+		if (m_ssaoDownsampleCS->HasShaderResourceView("SceneDepths"))
+			m_ssaoDownsampleCS->SetShaderResourceView("SceneDepths", m_mrtSRVs[RT_SCENE_DEPTH]);
+		if (m_ssaoDownsampleCS->HasShaderResourceView("SceneNormals"))
+			m_ssaoDownsampleCS->SetShaderResourceView("SceneNormals", m_mrtSRVs[RT_SCENE_NORMAL]);
+		if (m_ssaoDownsampleCS->HasUnorderedAccessView("ReducedDepths"))
+			m_ssaoDownsampleCS->SetUnorderedAccessView("ReducedDepths", m_reducedUAVs[RDT_DEPTH]);
+		if (m_ssaoDownsampleCS->HasUnorderedAccessView("ReducedNormals"))
+			m_ssaoDownsampleCS->SetUnorderedAccessView("ReducedNormals", m_reducedUAVs[RDT_NORMAL]);
+
+		m_ssaoDownsampleCS->CopyAllBufferData();
+		const int threadgroupSize = 8;
+		m_ssaoDownsampleCS->DispatchByGroups((ssaoWidth + threadgroupSize - 1) / threadgroupSize, (ssaoHeight + threadgroupSize - 1) / threadgroupSize, 1);
+
+		// Both outputs are read by the core pass
+		ID3D11UnorderedAccessView* nullUAVs[2] = { };
+		UINT initialCounts[2] = { };
+		m_context->CSSetUnorderedAccessViews(0, 2, nullUAVs, initialCounts);
+	}
+
 	// Perform initial SSAO pass
 	{
 		m_ssaoCoreCS->SetShader();
@@ -386,7 +551,7 @@ void Renderer::PostProcess(std::shared_ptr<Camera> a_camera)
 		Matrix4 invProj;
 		XMStoreFloat4x4(&invProj, XMMatrixInverse(nullptr, XMLoadFloat4x4(&projMatrix)));
 
-		DirectX::XMINT2 windowDimensions(m_windowWidth, m_windowHeight);
+		DirectX::XMINT2 windowDimensions(ssaoWidth, ssaoHeight);
 
 		if (m_ssaoCoreCS->HasVariable("c_viewMatrix"))
 			m_ssaoCoreCS->SetMatrix4x4("c_viewMatrix", a_camera->GetViewMatrix());
@@ -395,15 +560,17 @@ void Renderer::PostProcess(std::shared_ptr<Camera> a_camera)
 		if (m_ssaoCoreCS->HasVariable("c_inverseProjMatrix"))
 			m_ssaoCoreCS->SetMatrix4x4("c_inverseProjMatrix", invProj);
 		if (m_ssaoCoreCS->HasVariable("c_offsets"))
-			m_ssaoCoreCS->SetData("c_offsets", &m_ssaoOffsets[0], (int)m_ssaoOffsets.size() * sizeof(Vector4));
+			m_ssaoCoreCS->SetData("c_offsets", &m_ssaoSettings.Offsets[0], (int)m_ssaoSettings.Offsets.size() * sizeof(Vector4));
 		if (m_ssaoCoreCS->HasVariable("c_radius"))
-			m_ssaoCoreCS->SetFloat("c_radius", 1.f);
+			m_ssaoCoreCS->SetFloat("c_radius", m_ssaoSettings.Radius);
 		if (m_ssaoCoreCS->HasVariable("c_samples"))
-			m_ssaoCoreCS->SetInt("c_samples", (int)m_ssaoOffsets.size()); // CANNOT exceed 64
+			m_ssaoCoreCS->SetInt("c_samples", (int)ssaoSamples); // CANNOT exceed 64
+		if (m_ssaoCoreCS->HasVariable("c_sampleStart"))
+			m_ssaoCoreCS->SetInt("c_sampleStart", (int)ssaoSampleStart);
 		if (m_ssaoCoreCS->HasVariable("c_windowDimensions"))
 			m_ssaoCoreCS->SetData("c_windowDimensions", &windowDimensions, sizeof(DirectX::XMINT2)); // Why no SetInt2? :(
 		if (m_ssaoCoreCS->HasVariable("c_randomSampleScreenScale"))
-			m_ssaoCoreCS->SetFloat2("c_randomSampleScreenScale", Vector2((float)m_windowWidth / 4.f, (float)m_windowHeight / 4.f));
+			m_ssaoCoreCS->SetFloat2("c_randomSampleScreenScale", Vector2((float)ssaoWidth / 4.f, (float)ssaoHeight / 4.f));
 			// The random texture has a size of 4 in each dimension - not worth saving in class but may be worth a #define
 
 		// Set Samplers (no need to store these, since they'll remain bound and are functionally the same?
@@ -417,19 +584,19 @@ void Renderer::PostProcess(std::shared_ptr<Camera> a_camera)
 		if (m_ssaoCoreCS->HasShaderResourceView("Random"))
 			m_ssaoCoreCS->SetShaderResourceView("Random", m_ssaoRandomOffsets);
 		if (m_ssaoCoreCS->HasShaderResourceView("SceneNormals"))
-			m_ssaoCoreCS->SetShaderResourceView("SceneNormals", m_mrtSRVs[RT_SCENE_NORMAL]);
+			m_ssaoCoreCS->SetShaderResourceView("SceneNormals", bIsReduced ? m_reducedSRVs[RDT_NORMAL] : m_mrtSRVs[RT_SCENE_NORMAL]);
 		if (m_ssaoCoreCS->HasShaderResourceView("SceneDepths"))
-			m_ssaoCoreCS->SetShaderResourceView("SceneDepths", m_mrtSRVs[RT_SCENE_DEPTH]);
+			m_ssaoCoreCS->SetShaderResourceView("SceneDepths", bIsReduced ? m_reducedSRVs[RDT_DEPTH] : m_mrtSRVs[RT_SCENE_DEPTH]);
 
 		// Set output UAV
 		if (m_ssaoCoreCS->HasUnorderedAccessView("SSAO"))
-			m_ssaoCoreCS->SetUnorderedAccessView("SSAO", m_ppUAVs[PPT_PASS_ZERO]);
+			m_ssaoCoreCS->SetUnorderedAccessView("SSAO", bIsReduced ? m_reducedUAVs[RDT_SSAO] : m_ppUAVs[PPT_PASS_ZERO]);
 
 		m_ssaoCoreCS->CopyAllBufferData();
 
 		// Dispatch enough groups to fill the window (round up to the next level to handle truncation)
 		const int threadgroupSize = 32;
-		m_ssaoCoreCS->DispatchByGroups((m_windowWidth + threadgroupSize - 1) / threadgroupSize, (m_windowHeight + threadgroupSize - 1) / threadgroupSize, 1);
+		m_ssaoCoreCS->DispatchByGroups((ssaoWidth + threadgroupSize - 1) / threadgroupSize, (ssaoHeight + threadgroupSize - 1) / threadgroupSize, 1);
 
 		// Reset view so it can be used as a resource
 		ID3D11UnorderedAccessView* nullUAV[1] = { };
@@ -437,10 +604,63 @@ void Renderer::PostProcess(std::shared_ptr<Camera> a_camera)
 		m_context->CSSetUnorderedAccessViews(0, 1, nullUAV, &initialCount);
 	}
 
+	// Captures hold full resolution inputs and the whole kernel, so they only match the GPU result in that mode
+	if (bCaptureSSAO && !bIsReduced && !m_bSSAOTemporal)
+		CaptureSSAO(a_camera, SSAO_CAPTURE_FILE);
+
+	if (bIsReduced) {
+		m_ssaoUpsampleCS->SetShader();
+
+		DirectX::XMINT2 fullDimensions(m_windowWidth, m_windowHeight);
+		DirectX::XMINT2 reducedDimensions(ssaoWidth, ssaoHeight);
+		Matrix4 projMatrix = a_camera->GetProjectionMatrix();
+		if (m_ssaoUpsampleCS->HasVariable("c_fullDimensions"))
+			m_ssaoUpsampleCS->SetData("c_fullDimensions", &fullDimensions, sizeof(DirectX::XMINT2));
+		if (m_ssaoUpsampleCS->HasVariable("c_reducedDimensions"))
+			m_ssaoUpsampleCS->SetData("c_reducedDimensions", &reducedDimensions, sizeof(DirectX::XMINT2));
+		if (m_ssaoUpsampleCS->HasVariable("c_depthLinearize"))
+			m_ssaoUpsampleCS->SetFloat2("c_depthLinearize", Vector2(projMatrix._33, projMatrix._43));
+		if (m_ssaoUpsampleCS->HasVariable("c_depthSigma"))
+			m_ssaoUpsampleCS->SetFloat("c_depthSigma", SSAO_UPSAMPLE_DEPTH_SIGMA);
+		if (m_ssaoUpsampleCS->HasVariable("c_factor"))
+			m_ssaoUpsampleCS->SetInt("c_factor", (int)ssaoFactor);
+		if (m_ssaoUpsampleCS->HasShaderResourceView("SceneDepths"))
+			m_ssaoUpsampleCS->SetShaderResourceView("SceneDepths", m_mrtSRVs[RT_SCENE_DEPTH]);
+		if (m_ssaoUpsampleCS->HasShaderResourceView("ReducedDepths"))
+			m_ssaoUpsampleCS->SetShaderResourceView("ReducedDepths", m_reducedSRVs[RDT_DEPTH]);
+		if (m_ssaoUpsampleCS->HasShaderResourceView("ReducedSSAO"))
+			m_ssaoUpsampleCS->SetShaderResourceView("ReducedSSAO", m_reducedSRVs[RDT_SSAO]);
+		if (m_ssaoUpsampleCS->HasUnorderedAccessView("SSAO"))
+			m_ssaoUpsampleCS->SetUnorderedAccessView("SSAO", m_ppUAVs[PPT_PASS_ZERO]);
+
+		m_ssaoUpsampleCS->CopyAllBufferData();
+		const int threadgroupSize = 8;
+		m_ssaoUpsampleCS->DispatchByGroups((m_windowWidth + threadgroupSize - 1) / threadgroupSize, (m_windowHeight + threadgroupSize - 1) / threadgroupSize, 1);
+
+		ID3D11UnorderedAccessView* nullUAV[1] = { };
+		UINT initialCount = 0;
+		m_context->CSSetUnorderedAccessViews(0, 1, nullUAV, &initialCount);
+		ID3D11ShaderResourceView* nullSRVs[3] = { };
+		m_context->CSSetShaderResources(0, 3, nullSRVs);
+	}
+
 	DisplayRenderTextures({},  { PPT_PASS_ZERO }); // Display in debugger the newly rendered SSAO texture
 
+	// Accumulate with reprojected history. Reads ZERO, writes the result to ONE
+	PostProcessTarget aoTarget = PPT_PASS_ZERO;
+	if (m_bSSAOTemporal) {
+		RunTemporalSSAOPass(a_camera, bIsHistoryValid);
+		aoTarget = PPT_PASS_ONE;
+	}
+	m_bSSAOHistoryValid = m_bSSAOTemporal;
+	m_ssaoHistoryCamera = a_camera.get();
+	m_ssaoHistoryResolution = m_ssaoResolution;
+
 	// Perform Blur pass to reduce pattern
-	{
+	//	- The box blur reads the AO target and writes the other one. The separable blur goes there and back
+	PostProcessTarget otherTarget = (aoTarget == PPT_PASS_ZERO) ? PPT_PASS_ONE : PPT_PASS_ZERO;
+	PostProcessTarget blurredTarget = otherTarget;
+	if (m_ssaoBlurMode == SSAO_BLUR_BOX) {
 		m_ssaoBlurCS->SetShader();
 
 		DirectX::XMINT2 windowDimensions(m_windowWidth, m_windowHeight);
@@ -451,24 +671,32 @@ void Renderer::PostProcess(std::shared_ptr<Camera> a_camera)
 		if (m_ssaoBlurCS->HasSamplerState("ClampSampler"))
 			m_ssaoBlurCS->SetSamplerState("ClampSampler", m_clampSampler);
 		if (m_ssaoBlurCS->HasShaderResourceView("BlurTarget"))
-			m_ssaoBlurCS->SetShaderResourceView("BlurTarget", m_ppSRVs[PPT_PASS_ZERO]);
+			m_ssaoBlurCS->SetShaderResourceView("BlurTarget", m_ppSRVs[aoTarget]);
 
 		// Set output texture to next post process UAV
 		if (m_ssaoBlurCS->HasUnorderedAccessView("BlurResult"))
-			m_ssaoBlurCS->SetUnorderedAccessView("BlurResult", m_ppUAVs[PPT_PASS_ONE]);
+			m_ssaoBlurCS->SetUnorderedAccessView("BlurResult", m_ppUAVs[otherTarget]);
 
 		// Copy data over and Dispatch
 		m_ssaoBlurCS->CopyAllBufferData();
 		const int threadgroupSize = 32;
-		m_ssaoCoreCS->DispatchByGroups((m_windowWidth + threadgroupSize - 1) / threadgroupSize, (m_windowHeight + threadgroupSize - 1) / threadgroupSize, 1);
+		m_ssaoBlurCS->DispatchByGroups((m_windowWidth + threadgroupSize - 1) / threadgroupSize, (m_windowHeight + threadgroupSize - 1) / threadgroupSize, 1);
 
 		// Reset view so it can be used as a resource
 		ID3D11UnorderedAccessView* nullUAV[1] = { };
 		UINT initialCount = 0;
 		m_context->CSSetUnorderedAccessViews(0, 1, nullUAV, &initialCount);
 	}
+	else {
+		const unsigned int groupSize = 256; // BLUR_GROUP_SIZE in SeparableBlur.hlsli
+		RunSeparableBlurPass(m_ssaoBlurHorizontalCS, aoTarget, otherTarget, a_camera,
+			(m_windowWidth + groupSize - 1) / groupSize, m_windowHeight);
+		RunSeparableBlurPass(m_ssaoBlurVerticalCS, otherTarget, aoTarget, a_camera,
+			m_windowWidth, (m_windowHeight + groupSize - 1) / groupSize);
+		blurredTarget = aoTarget;
+	}
 
-	DisplayRenderTextures({},  { PPT_PASS_ONE }); // Display blurred result
+	DisplayRenderTextures({},  { blurredTarget }); // Display blurred result
 
 	// Perform final combination pass to occlude ambient light
 	{
@@ -485,12 +713,12 @@ void Renderer::PostProcess(std::shared_ptr<Camera> a_camera)
 		if (m_ssaoCombinePS->HasShaderResourceView("SceneDepths"))
 			m_ssaoCombinePS->SetShaderResourceView("SceneDepths", m_mrtSRVs[RT_SCENE_DEPTH]);
 		if (m_ssaoCombinePS->HasShaderResourceView("SSAO"))
-			m_ssaoCombinePS->SetShaderResourceView("SSAO", m_ppSRVs[PPT_PASS_ONE]);
+			m_ssaoCombinePS->SetShaderResourceView("SSAO", m_ppSRVs[blurredTarget]);
 		if (m_ssaoCombinePS->HasSamplerState("ClampSampler"))
 			m_ssaoCombinePS->SetSamplerState("ClampSampler", m_clampSampler);
 
 		// No data to copy in cbuffers, so just Draw
-		m_context->Draw(3, 0);
+		m_renderDevice->Draw(3, 0);
 	}
 
 	// Rebind Back Buffer and unbind all possible SRV slots (so they can be rebound as inputs next frame)
@@ -519,3 +747,269 @@ void Renderer::DisplayRenderTextures(std::vector<RenderTarget> a_rtIndices, std:
 	}
 	ImGui::End();
 }
+
+
+//----------------------------------------------------
+// (Re)build the reduced resolution SSAO targets for a
+// given downsample factor
+//	- Called lazily when the SSAO resolution changes,
+//	  and after a resize
+//----------------------------------------------------
+void Renderer::CreateReducedTargets(unsigned int a_factor)
+{
+	m_ssaoReducedFactor = a_factor;
+
+	D3D11_TEXTURE2D_DESC texDesc = {};
+	texDesc.Width = (m_windowWidth + a_factor - 1) / a_factor;
+	texDesc.Height = (m_windowHeight + a_factor - 1) / a_factor;
+	texDesc.ArraySize = 1;
+	texDesc.MipLevels = 1;
+	texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
+	texDesc.Usage = D3D11_USAGE_DEFAULT;
+	texDesc.SampleDesc.Count = 1;
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MipLevels = 1;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+
+	D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+	uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
+	uavDesc.Texture2D.MipSlice = 0;
+
+	for (int i = 0; i < ReducedTarget::RDT_COUNT; i++) {
+		// Depth keeps full precision like RT_SCENE_DEPTH, the rest match their full resolution counterparts
+		texDesc.Format = (i == ReducedTarget::RDT_DEPTH) ? DXGI_FORMAT_R32_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+		srvDesc.Format = texDesc.Format;
+		uavDesc.Format = texDesc.Format;
+
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> tex;
+		m_device->CreateTexture2D(&texDesc, nullptr, tex.GetAddressOf());
+
+		m_reducedUAVs[i].Reset();
+		m_reducedSRVs[i].Reset();
+		m_device->CreateUnorderedAccessView(tex.Get(), &uavDesc, m_reducedUAVs[i].GetAddressOf());
+		m_device->CreateShaderResourceView(tex.Get(), &srvDesc, m_reducedSRVs[i].GetAddressOf());
+	}
+}
+
+//----------------------------------------------------
+// Blend this frame's partial-kernel SSAO (PPT_PASS_ZERO)
+// with reprojected history into PPT_PASS_ONE, then save
+// this frame's depth and normals as next frame's history
+//	- Previous depth is linearized with the current
+//	  projection, which assumes the projection itself
+//	  doesn't change between frames
+//----------------------------------------------------
+void Renderer::RunTemporalSSAOPass(std::shared_ptr<Camera> a_camera, bool a_bIsHistoryValid)
+{
+	m_ssaoTemporalCS->SetShader();
+
+	unsigned int readIndex = m_ssaoHistoryIndex;
+	unsigned int writeIndex = 1 - m_ssaoHistoryIndex;
+
+	Matrix4 projMatrix = a_camera->GetProjectionMatrix();
+	Matrix4 viewProjection = a_camera->GetViewProjectionMatrix();
+	Matrix4 inverseViewProjection;
+	XMStoreFloat4x4(&inverseViewProjection, XMMatrixInverse(nullptr, XMLoadFloat4x4(&viewProjection)));
+	DirectX::XMINT2 windowDimensions(m_windowWidth, m_windowHeight);
+
+	if (m_ssaoTemporalCS->HasVariable("c_inverseViewProjection"))
+		m_ssaoTemporalCS->SetMatrix4x4("c_inverseViewProjection", inverseViewProjection);
+	if (m_ssaoTemporalCS->HasVariable("c_previousViewProjection"))
+		m_ssaoTemporalCS->SetMatrix4x4("c_previousViewProjection", a_camera->GetPreviousViewProjectionMatrix());
+	if (m_ssaoTemporalCS->HasVariable("c_windowDimensions"))
+		m_ssaoTemporalCS->SetData("c_windowDimensions", &windowDimensions, sizeof(DirectX::XMINT2));
+	if (m_ssaoTemporalCS->HasVariable("c_depthLinearize"))
+		m_ssaoTemporalCS->SetFloat2("c_depthLinearize", Vector2(projMatrix._33, projMatrix._43));
+	if (m_ssaoTemporalCS->HasVariable("c_depthThreshold"))
+		m_ssaoTemporalCS->SetFloat("c_depthThreshold", m_ssaoTemporalSettings.DepthThreshold);
+	if (m_ssaoTemporalCS->HasVariable("c_normalThreshold"))
+		m_ssaoTemporalCS->SetFloat("c_normalThreshold", m_ssaoTemporalSettings.NormalThreshold);
+	if (m_ssaoTemporalCS->HasVariable("c_cycleFrames"))
+		m_ssaoTemporalCS->SetInt("c_cycleFrames", (int)SSAOReference::GetCycleFrames(m_ssaoTemporalSettings));
+	if (m_ssaoTemporalCS->HasVariable("c_maxCycles"))
+		m_ssaoTemporalCS->SetInt("c_maxCycles", (int)SSAOReference::GetMaxCycles(m_ssaoTemporalSettings));
+	if (m_ssaoTemporalCS->HasVariable("c_historyValid"))
+		m_ssaoTemporalCS->SetInt("c_historyValid", a_bIsHistoryValid ? 1 : 0);
+
+	if (m_ssaoTemporalCS->HasShaderResourceView("CurrentSSAO"))
+		m_ssaoTemporalCS->SetShaderResourceView("CurrentSSAO", m_ppSRVs[PPT_PASS_ZERO]);
+	if (m_ssaoTemporalCS->HasShaderResourceView("SceneDepths"))
+		m_ssaoTemporalCS->SetShaderResourceView("SceneDepths", m_mrtSRVs[RT_SCENE_DEPTH]);
+	if (m_ssaoTemporalCS->HasShaderResourceView("SceneNormals"))
+		m_ssaoTemporalCS->SetShaderResourceView("SceneNormals", m_mrtSRVs[RT_SCENE_NORMAL]);
+	if (m_ssaoTemporalCS->HasShaderResourceView("HistorySSAO"))
+		m_ssaoTemporalCS->SetShaderResourceView("HistorySSAO", m_historySRVs[readIndex]);
+	if (m_ssaoTemporalCS->HasShaderResourceView("PreviousDepths"))
+		m_ssaoTemporalCS->SetShaderResourceView("PreviousDepths", m_previousDepthSRV);
+	if (m_ssaoTemporalCS->HasShaderResourceView("PreviousNormals"))
+		m_ssaoTemporalCS->SetShaderResourceView("PreviousNormals", m_previousNormalSRV);
+	if (m_ssaoTemporalCS->HasUnorderedAccessView("HistoryResult"))
+		m_ssaoTemporalCS->SetUnorderedAccessView("HistoryResult", m_historyUAVs[writeIndex]);
+	if (m_ssaoTemporalCS->HasUnorderedAccessView("SSAOResult"))
+		m_ssaoTemporalCS->SetUnorderedAccessView("SSAOResult", m_ppUAVs[PPT_PASS_ONE]);
+
+	m_ssaoTemporalCS->CopyAllBufferData();
+	const int threadgroupSize = 8;
+	m_ssaoTemporalCS->DispatchByGroups((m_windowWidth + threadgroupSize - 1) / threadgroupSize, (m_windowHeight + threadgroupSize - 1) / threadgroupSize, 1);
+
+	ID3D11UnorderedAccessView* nullUAVs[2] = { };
+	UINT initialCounts[2] = { };
+	m_context->CSSetUnorderedAccessViews(0, 2, nullUAVs, initialCounts);
+	ID3D11ShaderResourceView* nullSRVs[6] = { };
+	m_context->CSSetShaderResources(0, 6, nullSRVs);
+
+	// This frame's G-buffer becomes next frame's history
+	Microsoft::WRL::ComPtr<ID3D11Resource> depthResource;
+	Microsoft::WRL::ComPtr<ID3D11Resource> normalResource;
+	m_mrtSRVs[RT_SCENE_DEPTH]->GetResource(depthResource.GetAddressOf());
+	m_mrtSRVs[RT_SCENE_NORMAL]->GetResource(normalResource.GetAddressOf());
+	m_context->CopyResource(m_previousDepthTexture.Get(), depthResource.Get());
+	m_context->CopyResource(m_previousNormalTexture.Get(), normalResource.Get());
+
+	m_ssaoHistoryIndex = writeIndex;
+}
+
+//----------------------------------------------------
+// Run one direction of the separable SSAO blur from
+// one post process target into another
+//	- The bilateral variant also reads scene depth, which
+//	  it linearizes with the Camera's projection
+//----------------------------------------------------
+void Renderer::RunSeparableBlurPass(std::shared_ptr<SimpleComputeShader> a_shader,
+	PostProcessTarget a_source, PostProcessTarget a_destination, std::shared_ptr<Camera> a_camera,
+	unsigned int a_groupsX, unsigned int a_groupsY)
+{
+	a_shader->SetShader();
+
+	DirectX::XMINT2 windowDimensions(m_windowWidth, m_windowHeight);
+	Matrix4 projMatrix = a_camera->GetProjectionMatrix();
+
+	if (a_shader->HasVariable("c_windowDimensions"))
+		a_shader->SetData("c_windowDimensions", &windowDimensions, sizeof(DirectX::XMINT2));
+	if (a_shader->HasVariable("c_depthLinearize"))
+		a_shader->SetFloat2("c_depthLinearize", Vector2(projMatrix._33, projMatrix._43));
+	if (a_shader->HasVariable("c_depthSigma"))
+		a_shader->SetFloat("c_depthSigma", m_ssaoBlurDepthSigma);
+	if (a_shader->HasVariable("c_bilateral"))
+		a_shader->SetInt("c_bilateral", m_ssaoBlurMode == SSAO_BLUR_BILATERAL ? 1 : 0);
+	if (a_shader->HasShaderResourceView("BlurTarget"))
+		a_shader->SetShaderResourceView("BlurTarget", m_ppSRVs[a_source]);
+	if (a_shader->HasShaderResourceView("SceneDepths"))
+		a_shader->SetShaderResourceView("SceneDepths", m_mrtSRVs[RT_SCENE_DEPTH]);
+	if (a_shader->HasUnorderedAccessView("BlurResult"))
+		a_shader->SetUnorderedAccessView("BlurResult", m_ppUAVs[a_destination]);
+
+	a_shader->CopyAllBufferData();
+	a_shader->DispatchByGroups(a_groupsX, a_groupsY, 1);
+
+	// Unbind both views - the next pass reads this destination and writes this source
+	ID3D11UnorderedAccessView* nullUAV[1] = { };
+	UINT initialCount = 0;
+	m_context->CSSetUnorderedAccessViews(0, 1, nullUAV, &initialCount);
+	ID3D11ShaderResourceView* nullSRVs[2] = { };
+	m_context->CSSetShaderResources(0, 2, nullSRVs);
+}
+
+//----------------------------------------------------
+// Save the SSAO pass inputs and output for the CPU
+// reference (see the headless ssao-bench command)
+//	- Stalls on GPU readback, so this is strictly a
+//	  debugging tool
+//----------------------------------------------------
+void Renderer::CaptureSSAO(std::shared_ptr<Camera> a_camera, const std::string& a_fileName)
+{
+	SSAOGBuffer gbuffer;
+	gbuffer.Width = m_windowWidth;
+	gbuffer.Height = m_windowHeight;
+	gbuffer.ViewMatrix = a_camera->GetViewMatrix();
+	gbuffer.ProjectionMatrix = a_camera->GetProjectionMatrix();
+	XMStoreFloat4x4(&gbuffer.InverseProjectionMatrix, XMMatrixInverse(nullptr, XMLoadFloat4x4(&gbuffer.ProjectionMatrix)));
+
+	std::vector<float> normals;
+	std::vector<float> ssao;
+	if (!ReadBackTexture(m_mrtSRVs[RT_SCENE_DEPTH], gbuffer.Depths) ||
+		!ReadBackTexture(m_mrtSRVs[RT_SCENE_NORMAL], normals) ||
+		!ReadBackTexture(m_ppSRVs[PPT_PASS_ZERO], ssao))
+		return;
+
+	// Normals come back as 4 channels, SSAO only needs the first of its 4
+	size_t pixelCount = (size_t)m_windowWidth * m_windowHeight;
+	gbuffer.Normals.resize(pixelCount);
+	gbuffer.GPUResult.resize(pixelCount);
+	for (size_t i = 0; i < pixelCount; i++) {
+		gbuffer.Normals[i] = Vector4(normals[i * 4], normals[i * 4 + 1], normals[i * 4 + 2], normals[i * 4 + 3]);
+		gbuffer.GPUResult[i] = ssao[i * 4];
+	}
+
+	SSAOReference::SaveCapture(a_fileName, gbuffer, m_ssaoSettings);
+}
+
+//----------------------------------------------------
+// Copy a texture to the CPU as floats, channel by
+// channel. Only the two formats the SSAO targets use
+// are supported (R32_FLOAT and R8G8B8A8_UNORM)
+//----------------------------------------------------
+bool Renderer::ReadBackTexture(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_srv, std::vector<float>& a_values)
+{
+	Microsoft::WRL::ComPtr<ID3D11Resource> resource;
+	a_srv->GetResource(resource.GetAddressOf());
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+	if (FAILED(resource.As(&texture)))
+		return false;
+
+	D3D11_TEXTURE2D_DESC desc = {};
+	texture->GetDesc(&desc);
+	if (desc.Format != DXGI_FORMAT_R32_FLOAT && desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM)
+		return false;
+
+	desc.BindFlags = 0;
+	desc.MiscFlags = 0;
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> staging;
+	if (FAILED(m_device->CreateTexture2D(&desc, nullptr, staging.GetAddressOf())))
+		return false;
+	m_context->CopyResource(staging.Get(), texture.Get());
+
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (FAILED(m_context->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped)))
+		return false;
+
+	bool bIsFloat = desc.Format == DXGI_FORMAT_R32_FLOAT;
+	unsigned int channels = bIsFloat ? 1 : 4;
+	a_values.resize((size_t)desc.Width * desc.Height * channels);
+	for (unsigned int y = 0; y < desc.Height; y++) {
+		const unsigned char* row = static_cast<const unsigned char*>(mapped.pData) + (size_t)y * mapped.RowPitch;
+		float* destination = &a_values[(size_t)y * desc.Width * channels];
+		if (bIsFloat) {
+			memcpy(destination, row, desc.Width * sizeof(float));
+		}
+		else {
+			for (unsigned int i = 0; i < desc.Width * channels; i++) {
+				destination[i] = row[i] / 255.f;
+			}
+		}
+	}
+
+	m_context->Unmap(staging.Get(), 0);
+	return true;
+}
+
+//----------------------------------------------------
+// Hand out small integer ids for objects used in draw
+// sort keys. Ids are stable for the Renderer's lifetime
+//	- Objects are never removed, which is fine while
+//	  scenes are built once at startup
+//----------------------------------------------------
+unsigned int Renderer::GetSortId(const void* a_object)
+{
+	std::unordered_map<const void*, unsigned int>::iterator found = m_sortIds.find(a_object);
+	if (found != m_sortIds.end())
+		return found->second;
+
+	unsigned int id = (unsigned int)m_sortIds.size();
+	m_sortIds[a_object] = id;
+	return id;
+}
\ No newline at end of file
@@ -4,12 +4,23 @@
 #include <d3d11.h>
 #include <vector>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 // These should be replaced with a single Scene
 #include "Entity.h"
 #include "Camera.h"
 #include "Sky.h"
 #include "Lights.h"
+#include "RenderDevice.h"
+#include "FramePrep.h"
+#include "SSAOReference.h"
+
+#define SSAO_KERNEL_SEED 1337 // Fixed so frames (and captures) are reproducible
+#define SSAO_CAPTURE_FILE "SSAOCapture.bin" // Written next to the executable's working directory
+#define SSAO_UPSAMPLE_DEPTH_SIGMA 0.05f // Bilateral upsample falloff, as a fraction of view depth
+#define RENDERER_LOD_PIXEL_ERROR 1.f // Default screen space error, in pixels, a Mesh LOD may show
+#define RENDERER_LOD_HYSTERESIS 0.25f // Fraction of the pixel error an object must move past before its LOD changes
 
 //----------------------------------------------------
 // Contains very basic implementation of a Renderer
@@ -50,13 +61,44 @@ public:
 		PPT_COUNT // Always last, internal integer representation marks the number of RTs AT COMPILE TIME!
 	};
 
+	// Intermediate targets for reduced resolution SSAO. Same idea as PostProcessTarget, but sized
+	// by the SSAO resolution factor instead of the window
+	enum ReducedTarget {
+		RDT_DEPTH = 0, // Checkerboard min/max reduced RT_SCENE_DEPTH
+		RDT_NORMAL, // RT_SCENE_NORMAL texels matching RDT_DEPTH
+		RDT_SSAO, // Core SSAO output before upsampling
+
+		RDT_COUNT
+	};
+
+	// Resolution the core SSAO pass runs at. Value is log2 of the downsample factor
+	//	- Stored as an int so ImGui::Combo can edit it directly
+	enum SSAOResolution {
+		SSAO_RESOLUTION_FULL = 0,
+		SSAO_RESOLUTION_HALF,
+		SSAO_RESOLUTION_QUARTER,
+
+		SSAO_RESOLUTION_COUNT
+	};
+
+	// How the raw SSAO result is smoothed before being combined with the scene
+	//	- Stored as an int so ImGui::Combo can edit it directly
+	enum SSAOBlurMode {
+		SSAO_BLUR_BOX = 0, // Original 5x5 blur - 25 texture loads per pixel
+		SSAO_BLUR_SEPARABLE, // Two groupshared 5-tap passes - 10 loads per pixel
+		SSAO_BLUR_BILATERAL, // Separable, with taps weighted by depth similarity to avoid bleeding across edges
+
+		SSAO_BLUR_COUNT
+	};
+
 	Renderer(
 		Microsoft::WRL::ComPtr<ID3D11Device> a_device, // Should be stored in DXCore and retrieved as needed
 		Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, // Likewise ^
+		std::shared_ptr<RenderDevice> a_renderDevice, // Submission backend wrapping the above two
 		Microsoft::WRL::ComPtr<IDXGISwapChain> a_swapChain,
 		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> a_backBufferRTV,
 		Microsoft::WRL::ComPtr<ID3D11DepthStencilView> a_depthBufferDSV,
-		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_iblBRDFLookupTexture, // Should live in AssetManager
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_iblBRDFLookupTexture, // Generated by Game, not loaded, so it isn't an AssetManager asset
 		std::shared_ptr<SimpleVertexShader> a_fullscreenVS, // Just pass it in, since Game already loads it
 		unsigned int a_windowWidth,
 		unsigned int a_windowHeight
@@ -75,21 +117,33 @@ public:
 		const std::vector<std::shared_ptr<Entity>>& a_entities,
 		const std::vector<BasicLight>& a_allLights,
 		const std::shared_ptr<Camera>& a_camera,
-		const std::shared_ptr<Sky>& a_sky
+		const std::shared_ptr<Sky>& a_sky,
+		const std::vector<uint64_t>* a_visibilityMasks = nullptr, // Culling::CullSpheres output, nullptr draws everything
+		unsigned int a_viewIndex = 0
 	);
 	
 	void PostProcess(std::shared_ptr<Camera> a_camera);
 
+	// Screen space error allowed when picking Mesh LODs. 0 always draws full detail
+	void SetLODPixelError(float a_pixels) { m_lodPixelError = a_pixels; }
+	float GetLODPixelError() { return m_lodPixelError; }
+
+	// Per-Meshlet frustum and backface culling for Meshes built with Meshlets
+	void SetMeshletCulling(bool a_bEnabled) { m_bMeshletCulling = a_bEnabled; }
+	bool GetMeshletCulling() { return m_bMeshletCulling; }
+
 	void DisplayRenderTextures(std::vector<RenderTarget> a_rtIndices, std::vector<PostProcessTarget> a_pptIndices);
 
 protected:
 	// Some or all of these do not need duplicate references stored here. They should be
 	// able to query DXCore for some basic information to prevent it changing in multiple
 	// places (device, back buffer, context(?), window dimensions)
-	//	- IBL Lookup Texture should exist in an AssetManager, but for now Game is in charge
-	//	  of all shader and universal resource loading and storing
+	//	- The IBL Lookup Texture is generated rather than loaded, and the SSAO shaders below
+	//	  are only ever used here, so neither goes through the AssetManager. The fullscreen
+	//	  VS comes resolved from Game, which keeps its handle for the Renderer's lifetime
 	Microsoft::WRL::ComPtr<ID3D11Device> m_device; 
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_context;
+	std::shared_ptr<RenderDevice> m_renderDevice;
 	Microsoft::WRL::ComPtr<IDXGISwapChain> m_swapChain;
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> m_backBufferRTV;
 	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> m_depthBufferDSV;
@@ -127,10 +181,59 @@ protected:
 	std::shared_ptr<SimpleVertexShader> m_postProcessVS;
 	std::shared_ptr<SimpleComputeShader> m_ssaoCoreCS;
 	std::shared_ptr<SimpleComputeShader> m_ssaoBlurCS;
+	std::shared_ptr<SimpleComputeShader> m_ssaoBlurHorizontalCS;
+	std::shared_ptr<SimpleComputeShader> m_ssaoBlurVerticalCS;
+	std::shared_ptr<SimpleComputeShader> m_ssaoDownsampleCS;
+	std::shared_ptr<SimpleComputeShader> m_ssaoUpsampleCS;
+	std::shared_ptr<SimpleComputeShader> m_ssaoTemporalCS;
+	Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> m_reducedUAVs[ReducedTarget::RDT_COUNT];
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_reducedSRVs[ReducedTarget::RDT_COUNT];
 	std::shared_ptr<SimplePixelShader> m_ssaoCombinePS; // Remains a pixel shader to Draw to Back Buffer
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_ssaoRandomOffsets;
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> m_standardSampler;
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> m_clampSampler;
-	std::vector<Vector4> m_ssaoOffsets;
+	int m_ssaoBlurMode; // SSAOBlurMode
+	float m_ssaoBlurDepthSigma; // Bilateral falloff as a fraction of view depth
+	int m_ssaoResolution; // SSAOResolution
+	unsigned int m_ssaoReducedFactor; // Factor the reduced targets were built for, 0 if they don't exist
+	float m_lodPixelError;
+	bool m_bMeshletCulling;
+
+	// Temporal SSAO state. History ping-pongs between two targets (R = resolved AO, G = partial cycle AO,
+	// B = frames in the partial cycle, A = whole cycles resolved)
+	bool m_bSSAOTemporal;
+	bool m_bSSAOHistoryValid; // Whether last frame wrote history at all
+	const Camera* m_ssaoHistoryCamera; // Camera the history was built from. Compared only, never dereferenced
+	int m_ssaoHistoryResolution; // SSAOResolution the history was built at
+	unsigned int m_ssaoHistoryIndex; // History target holding last frame's result
+	unsigned int m_ssaoFrameIndex; // Picks the slice of the kernel used this frame
+	SSAOTemporalSettings m_ssaoTemporalSettings;
+	Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> m_historyUAVs[2];
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_historySRVs[2];
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> m_previousDepthTexture;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> m_previousNormalTexture;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_previousDepthSRV;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_previousNormalSRV;
+	SSAOSettings m_ssaoSettings; // Kernel, random texture contents, radius and sample count - shared with the CPU reference
+
+	// Per-frame scratch storage for draw sorting and light binning, kept to avoid reallocating every frame
+	std::vector<DrawItem> m_drawItems;
+	std::vector<DrawItem> m_drawItemScratch;
+	std::vector<std::vector<MeshletDrawRange>> m_meshletRanges; // Per Entity, empty when the whole Mesh is drawn
+	std::unordered_map<const void*, unsigned int> m_sortIds; // Small stable ids for shaders/materials/meshes in sort keys
+	std::vector<BasicLight> m_directionalLights;
+	std::vector<BasicLight> m_pointLights;
+
+	unsigned int GetSortId(const void* a_object);
+
+	void CreateReducedTargets(unsigned int a_factor);
+	void RunTemporalSSAOPass(std::shared_ptr<Camera> a_camera, bool a_bIsHistoryValid);
+	void RunSeparableBlurPass(std::shared_ptr<SimpleComputeShader> a_shader,
+		PostProcessTarget a_source, PostProcessTarget a_destination, std::shared_ptr<Camera> a_camera,
+		unsigned int a_groupsX, unsigned int a_groupsY);
+
+	// SSAO capture for the CPU reference
+	void CaptureSSAO(std::shared_ptr<Camera> a_camera, const std::string& a_fileName);
+	bool ReadBackTexture(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_srv, std::vector<float>& a_values);
 };
 
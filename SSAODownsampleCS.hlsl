@@ -0,0 +1,47 @@
+/**
+* Reduce the scene depth and normal targets for reduced resolution SSAO. Each output texel covers a
+* factor x factor block of the full resolution targets and keeps ONE of those texels (depth and normal
+* from the same texel, so they always describe a real surface)
+*	- Which texel is kept alternates in a checkerboard: even texels keep the closest depth, odd texels
+*	  the farthest. Both the foreground and background of an edge survive the reduction, which gives the
+*	  bilateral upsample something to match against on either side
+*	- Must match SSAOReference::DownsampleGBuffer in C++
+*/
+
+cbuffer DownsampleData : register(b0)
+{
+	int2 c_fullDimensions;
+	int2 c_reducedDimensions;
+	int c_factor; // 2 or 4
+};
+
+Texture2D SceneDepths : register(t0);
+Texture2D SceneNormals : register(t1);
+
+RWTexture2D<float> ReducedDepths : register(u0);
+RWTexture2D<unorm float4> ReducedNormals : register(u1);
+
+[numthreads(8, 8, 1)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+	if ((int)DTid.x >= c_reducedDimensions.x || (int)DTid.y >= c_reducedDimensions.y) return;
+
+	bool bKeepMax = ((DTid.x + DTid.y) & 1) != 0;
+	int2 blockStart = int2(DTid.xy) * c_factor;
+
+	int2 chosen = min(blockStart, c_fullDimensions - 1);
+	float chosenDepth = SceneDepths[chosen].r;
+	for (int y = 0; y < c_factor; y++) {
+		for (int x = 0; x < c_factor; x++) {
+			int2 coord = min(blockStart + int2(x, y), c_fullDimensions - 1); // Edge blocks repeat the last row/column
+			float depth = SceneDepths[coord].r;
+			if (bKeepMax ? (depth > chosenDepth) : (depth < chosenDepth)) {
+				chosen = coord;
+				chosenDepth = depth;
+			}
+		}
+	}
+
+	ReducedDepths[DTid.xy] = chosenDepth;
+	ReducedNormals[DTid.xy] = SceneNormals[chosen];
+}
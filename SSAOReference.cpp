@@ -0,0 +1,1048 @@
+#include "SSAOReference.h"
+#include "JobSystem.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+// SSE is baseline on every x64 target, and on x86 when building with /arch:SSE2 or -msse2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SSAO_REFERENCE_SSE 1
+#include <emmintrin.h>
+#else
+#define SSAO_REFERENCE_SSE 0
+#endif
+
+#define SSAO_CAPTURE_MAGIC "SSAOCAP1"
+#define SSAO_CAPTURE_MAX_DIMENSION 16384 // Sanity limit so a corrupt header can't request gigabytes
+
+namespace
+{
+	// HLSL saturate. NaN goes to 0, which is also what the SSE min/max ordering below produces
+	inline float Saturate(float a_value)
+	{
+		return a_value > 0.f ? (a_value < 1.f ? a_value : 1.f) : 0.f;
+	}
+
+	// HLSL smoothstep(0, 1, x)
+	inline float SmoothStep01(float a_value)
+	{
+		float t = Saturate(a_value);
+		return t * t * (3.f - 2.f * t);
+	}
+
+	inline Vector3 Normalize(const Vector3& a_vector)
+	{
+		float inverseLength = 1.f / std::sqrt(a_vector.x * a_vector.x + a_vector.y * a_vector.y + a_vector.z * a_vector.z);
+		return Vector3(a_vector.x * inverseLength, a_vector.y * inverseLength, a_vector.z * inverseLength);
+	}
+
+	//-----------------------------------------------
+	// Matches ViewSpaceFromDepth in the shader
+	//	- HLSL reads matrices column major, so the shader's
+	//	  mul(M, v) is v * M with the stored (row major) layout
+	//-----------------------------------------------
+	inline Vector3 ViewSpaceFromDepth(const Matrix4& a_inverseProjection, float a_depth, float a_u, float a_v)
+	{
+		float ndcX = a_u * 2.f - 1.f;
+		float ndcY = -(a_v * 2.f - 1.f);
+
+		const float(&m)[4][4] = a_inverseProjection.m;
+		float x = ndcX * m[0][0] + ndcY * m[1][0] + a_depth * m[2][0] + m[3][0];
+		float y = ndcX * m[0][1] + ndcY * m[1][1] + a_depth * m[2][1] + m[3][1];
+		float z = ndcX * m[0][2] + ndcY * m[1][2] + a_depth * m[2][2] + m[3][2];
+		float w = ndcX * m[0][3] + ndcY * m[1][3] + a_depth * m[2][3] + m[3][3];
+		return Vector3(x / w, y / w, z / w);
+	}
+
+	// Bilinear fetch with the ClampSampler's addressing, in texel space (uv * size - 0.5)
+	inline float SampleDepthClamped(const SSAOGBuffer& a_gbuffer, float a_u, float a_v)
+	{
+		float texelX = a_u * (float)a_gbuffer.Width - 0.5f;
+		float texelY = a_v * (float)a_gbuffer.Height - 0.5f;
+		float floorX = std::floor(texelX);
+		float floorY = std::floor(texelY);
+		float fracX = texelX - floorX;
+		float fracY = texelY - floorY;
+
+		// Clamp in float first so far off-screen (or NaN) samples can't overflow the int conversion
+		float maxX = (float)(a_gbuffer.Width - 1);
+		float maxY = (float)(a_gbuffer.Height - 1);
+		int x0 = (int)(floorX > 0.f ? (floorX < maxX ? floorX : maxX) : 0.f);
+		int y0 = (int)(floorY > 0.f ? (floorY < maxY ? floorY : maxY) : 0.f);
+		int x1 = (int)(floorX + 1.f > 0.f ? (floorX + 1.f < maxX ? floorX + 1.f : maxX) : 0.f);
+		int y1 = (int)(floorY + 1.f > 0.f ? (floorY + 1.f < maxY ? floorY + 1.f : maxY) : 0.f);
+		if (!(fracX == fracX)) fracX = 0.f;
+		if (!(fracY == fracY)) fracY = 0.f;
+
+		const float* depths = &a_gbuffer.Depths[0];
+		unsigned int width = a_gbuffer.Width;
+		float top = depths[y0 * width + x0] + (depths[y0 * width + x1] - depths[y0 * width + x0]) * fracX;
+		float bottom = depths[y1 * width + x0] + (depths[y1 * width + x1] - depths[y1 * width + x0]) * fracX;
+		return top + (bottom - top) * fracY;
+	}
+
+	// Bilinear fetch with the BasicSampler's wrap addressing from the small random texture
+	inline Vector3 SampleRandomWrapped(const SSAOSettings& a_settings, float a_u, float a_v)
+	{
+		const int size = SSAO_RANDOM_TEXTURE_SIZE;
+		float texelX = a_u * (float)size - 0.5f;
+		float texelY = a_v * (float)size - 0.5f;
+		float floorX = std::floor(texelX);
+		float floorY = std::floor(texelY);
+		float fracX = texelX - floorX;
+		float fracY = texelY - floorY;
+
+		int x0 = ((int)std::fmod(floorX, (float)size) + size) % size;
+		int y0 = ((int)std::fmod(floorY, (float)size) + size) % size;
+		int x1 = (x0 + 1) % size;
+		int y1 = (y0 + 1) % size;
+
+		const Vector4& a = a_settings.RandomTexture[y0 * size + x0];
+		const Vector4& b = a_settings.RandomTexture[y0 * size + x1];
+		const Vector4& c = a_settings.RandomTexture[y1 * size + x0];
+		const Vector4& d = a_settings.RandomTexture[y1 * size + x1];
+		float weightA = (1.f - fracX) * (1.f - fracY);
+		float weightB = fracX * (1.f - fracY);
+		float weightC = (1.f - fracX) * fracY;
+		float weightD = fracX * fracY;
+		return Vector3(
+			a.x * weightA + b.x * weightB + c.x * weightC + d.x * weightD,
+			a.y * weightA + b.y * weightB + c.y * weightC + d.y * weightD,
+			a.z * weightA + b.z * weightB + c.z * weightC + d.z * weightD);
+	}
+
+	//-----------------------------------------------
+	// Per-pixel setup shared by both sample loops -
+	// the view position and TBN basis from main()
+	//-----------------------------------------------
+	struct PixelBasis {
+		Vector3 Position;
+		Vector3 Tangent;
+		Vector3 BiTangent;
+		Vector3 Normal;
+	};
+
+	inline PixelBasis BuildPixelBasis(const SSAOGBuffer& a_gbuffer, const SSAOSettings& a_settings,
+		unsigned int a_x, unsigned int a_y, float a_depth)
+	{
+		PixelBasis basis;
+		float u = (float)a_x / (float)a_gbuffer.Width;
+		float v = (float)a_y / (float)a_gbuffer.Height;
+		basis.Position = ViewSpaceFromDepth(a_gbuffer.InverseProjectionMatrix, a_depth, u, v);
+
+		// uv * (dimensions / random size), just like c_randomSampleScreenScale
+		float randomScaleX = (float)a_gbuffer.Width / (float)SSAO_RANDOM_TEXTURE_SIZE;
+		float randomScaleY = (float)a_gbuffer.Height / (float)SSAO_RANDOM_TEXTURE_SIZE;
+		Vector3 randomDir = SampleRandomWrapped(a_settings, u * randomScaleX, v * randomScaleY);
+
+		// Unpack and rotate into view space (n * view3x3, see ViewSpaceFromDepth)
+		const Vector4& packed = a_gbuffer.Normals[a_y * a_gbuffer.Width + a_x];
+		Vector3 n(packed.x * 2.f - 1.f, packed.y * 2.f - 1.f, packed.z * 2.f - 1.f);
+		const float(&view)[4][4] = a_gbuffer.ViewMatrix.m;
+		Vector3 normal = Normalize(Vector3(
+			n.x * view[0][0] + n.y * view[1][0] + n.z * view[2][0],
+			n.x * view[0][1] + n.y * view[1][1] + n.z * view[2][1],
+			n.x * view[0][2] + n.y * view[1][2] + n.z * view[2][2]));
+
+		float projection = randomDir.x * normal.x + randomDir.y * normal.y + randomDir.z * normal.z;
+		Vector3 tangent = Normalize(Vector3(
+			randomDir.x - normal.x * projection,
+			randomDir.y - normal.y * projection,
+			randomDir.z - normal.z * projection));
+		Vector3 biTangent(
+			tangent.y * normal.z - tangent.z * normal.y,
+			tangent.z * normal.x - tangent.x * normal.z,
+			tangent.x * normal.y - tangent.y * normal.x);
+
+		basis.Tangent = tangent;
+		basis.BiTangent = biTangent;
+		basis.Normal = normal;
+		return basis;
+	}
+
+	//-----------------------------------------------
+	// Straight port of the shader's sample loop
+	//-----------------------------------------------
+	float AccumulateScalar(const SSAOGBuffer& a_gbuffer, const SSAOSettings& a_settings, const PixelBasis& a_basis, unsigned int a_samples)
+	{
+		const float(&proj)[4][4] = a_gbuffer.ProjectionMatrix.m;
+		float radius = a_settings.Radius;
+		unsigned int offsetCount = (unsigned int)a_settings.Offsets.size();
+		float totalAO = 0.f;
+		for (unsigned int i = 0; i < a_samples; i++) {
+			const Vector4& o = a_settings.Offsets[(a_settings.SampleStart + i) % offsetCount];
+
+			// mul(offset, TBN) - rows of TBN are tangent, bitangent, normal
+			Vector3 sample(
+				a_basis.Position.x + (o.x * a_basis.Tangent.x + o.y * a_basis.BiTangent.x + o.z * a_basis.Normal.x) * radius,
+				a_basis.Position.y + (o.x * a_basis.Tangent.y + o.y * a_basis.BiTangent.y + o.z * a_basis.Normal.y) * radius,
+				a_basis.Position.z + (o.x * a_basis.Tangent.z + o.y * a_basis.BiTangent.z + o.z * a_basis.Normal.z) * radius);
+
+			// UVFromViewSpacePosition
+			float clipX = sample.x * proj[0][0] + sample.y * proj[1][0] + sample.z * proj[2][0] + proj[3][0];
+			float clipY = sample.x * proj[0][1] + sample.y * proj[1][1] + sample.z * proj[2][1] + proj[3][1];
+			float clipW = sample.x * proj[0][3] + sample.y * proj[1][3] + sample.z * proj[2][3] + proj[3][3];
+			float sampleU = (clipX / clipW) * 0.5f + 0.5f;
+			float sampleV = 1.f - ((clipY / clipW) * 0.5f + 0.5f);
+
+			float sampleDepth = SampleDepthClamped(a_gbuffer, sampleU, sampleV);
+			float sampleZ = ViewSpaceFromDepth(a_gbuffer.InverseProjectionMatrix, sampleDepth, sampleU, sampleV).z;
+
+			float rangeCheck = SmoothStep01(radius / std::fabs(a_basis.Position.z - sampleZ));
+			totalAO += (sampleZ < sample.z) ? rangeCheck : 0.f;
+		}
+		return totalAO;
+	}
+
+#if SSAO_REFERENCE_SSE
+	//-----------------------------------------------
+	// Kernel offsets in SoA form, padded to a multiple
+	// of 4 so the SIMD loop never reads past the end
+	//-----------------------------------------------
+	struct KernelSoA {
+		float X[SSAO_MAX_SAMPLES];
+		float Y[SSAO_MAX_SAMPLES];
+		float Z[SSAO_MAX_SAMPLES];
+	};
+
+	//-----------------------------------------------
+	// Same loop as AccumulateScalar, 4 samples per
+	// iteration. Depth fetches stay scalar (gathers),
+	// everything else is done 4-wide
+	//	- Lanes past a_samples are masked out of the sum
+	//-----------------------------------------------
+	float AccumulateSSE(const SSAOGBuffer& a_gbuffer, const SSAOSettings& a_settings, const KernelSoA& a_kernel,
+		const PixelBasis& a_basis, unsigned int a_samples)
+	{
+		const float(&proj)[4][4] = a_gbuffer.ProjectionMatrix.m;
+		const float(&inv)[4][4] = a_gbuffer.InverseProjectionMatrix.m;
+
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 two = _mm_set1_ps(2.f);
+		const __m128 three = _mm_set1_ps(3.f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		const __m128 radius = _mm_set1_ps(a_settings.Radius);
+		const __m128 laneIndex = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+		const __m128 sampleCount = _mm_set1_ps((float)a_samples);
+
+		// Scale the basis by radius once, instead of per sample
+		const __m128 tX = _mm_set1_ps(a_basis.Tangent.x * a_settings.Radius);
+		const __m128 tY = _mm_set1_ps(a_basis.Tangent.y * a_settings.Radius);
+		const __m128 tZ = _mm_set1_ps(a_basis.Tangent.z * a_settings.Radius);
+		const __m128 bX = _mm_set1_ps(a_basis.BiTangent.x * a_settings.Radius);
+		const __m128 bY = _mm_set1_ps(a_basis.BiTangent.y * a_settings.Radius);
+		const __m128 bZ = _mm_set1_ps(a_basis.BiTangent.z * a_settings.Radius);
+		const __m128 nX = _mm_set1_ps(a_basis.Normal.x * a_settings.Radius);
+		const __m128 nY = _mm_set1_ps(a_basis.Normal.y * a_settings.Radius);
+		const __m128 nZ = _mm_set1_ps(a_basis.Normal.z * a_settings.Radius);
+		const __m128 pX = _mm_set1_ps(a_basis.Position.x);
+		const __m128 pY = _mm_set1_ps(a_basis.Position.y);
+		const __m128 pZ = _mm_set1_ps(a_basis.Position.z);
+
+		__m128 totalAO = zero;
+		alignas(16) float sampleU[4];
+		alignas(16) float sampleV[4];
+		alignas(16) float sampleDepth[4];
+		for (unsigned int i = 0; i < a_samples; i += 4) {
+			__m128 oX = _mm_loadu_ps(&a_kernel.X[i]);
+			__m128 oY = _mm_loadu_ps(&a_kernel.Y[i]);
+			__m128 oZ = _mm_loadu_ps(&a_kernel.Z[i]);
+
+			__m128 sX = _mm_add_ps(pX, _mm_add_ps(_mm_add_ps(_mm_mul_ps(oX, tX), _mm_mul_ps(oY, bX)), _mm_mul_ps(oZ, nX)));
+			__m128 sY = _mm_add_ps(pY, _mm_add_ps(_mm_add_ps(_mm_mul_ps(oX, tY), _mm_mul_ps(oY, bY)), _mm_mul_ps(oZ, nY)));
+			__m128 sZ = _mm_add_ps(pZ, _mm_add_ps(_mm_add_ps(_mm_mul_ps(oX, tZ), _mm_mul_ps(oY, bZ)), _mm_mul_ps(oZ, nZ)));
+
+			// Project to UV
+			__m128 clipX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sX, _mm_set1_ps(proj[0][0])), _mm_mul_ps(sY, _mm_set1_ps(proj[1][0]))),
+				_mm_add_ps(_mm_mul_ps(sZ, _mm_set1_ps(proj[2][0])), _mm_set1_ps(proj[3][0])));
+			__m128 clipY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sX, _mm_set1_ps(proj[0][1])), _mm_mul_ps(sY, _mm_set1_ps(proj[1][1]))),
+				_mm_add_ps(_mm_mul_ps(sZ, _mm_set1_ps(proj[2][1])), _mm_set1_ps(proj[3][1])));
+			__m128 clipW = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sX, _mm_set1_ps(proj[0][3])), _mm_mul_ps(sY, _mm_set1_ps(proj[1][3]))),
+				_mm_add_ps(_mm_mul_ps(sZ, _mm_set1_ps(proj[2][3])), _mm_set1_ps(proj[3][3])));
+			__m128 u = _mm_add_ps(_mm_mul_ps(_mm_div_ps(clipX, clipW), half), half);
+			__m128 v = _mm_sub_ps(one, _mm_add_ps(_mm_mul_ps(_mm_div_ps(clipY, clipW), half), half));
+
+			// Gather depths
+			_mm_store_ps(sampleU, u);
+			_mm_store_ps(sampleV, v);
+			for (int lane = 0; lane < 4; lane++) {
+				sampleDepth[lane] = SampleDepthClamped(a_gbuffer, sampleU[lane], sampleV[lane]);
+			}
+			__m128 depth = _mm_load_ps(sampleDepth);
+
+			// Only z / w of the unprojected position is needed
+			__m128 ndcX = _mm_sub_ps(_mm_mul_ps(u, two), one);
+			__m128 ndcY = _mm_sub_ps(one, _mm_mul_ps(v, two));
+			__m128 viewZ = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ndcX, _mm_set1_ps(inv[0][2])), _mm_mul_ps(ndcY, _mm_set1_ps(inv[1][2]))),
+				_mm_add_ps(_mm_mul_ps(depth, _mm_set1_ps(inv[2][2])), _mm_set1_ps(inv[3][2])));
+			__m128 viewW = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ndcX, _mm_set1_ps(inv[0][3])), _mm_mul_ps(ndcY, _mm_set1_ps(inv[1][3]))),
+				_mm_add_ps(_mm_mul_ps(depth, _mm_set1_ps(inv[2][3])), _mm_set1_ps(inv[3][3])));
+			__m128 sampleZ = _mm_div_ps(viewZ, viewW);
+
+			// Range check. max(x, 0) first so a NaN ratio becomes 0, like Saturate()
+			__m128 ratio = _mm_div_ps(radius, _mm_and_ps(_mm_sub_ps(pZ, sampleZ), absMask));
+			__m128 t = _mm_min_ps(_mm_max_ps(ratio, zero), one);
+			__m128 range = _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(three, _mm_mul_ps(two, t)));
+
+			__m128 occluded = _mm_cmplt_ps(sampleZ, sZ);
+			__m128 inRange = _mm_cmplt_ps(_mm_add_ps(_mm_set1_ps((float)i), laneIndex), sampleCount);
+			totalAO = _mm_add_ps(totalAO, _mm_and_ps(range, _mm_and_ps(occluded, inRange)));
+		}
+
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, totalAO);
+		return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	}
+#endif
+
+	//-----------------------------------------------
+	// One direction of the separable blur, matching
+	// SeparableBlur() in SeparableBlur.hlsli
+	//-----------------------------------------------
+	void BlurPass(const std::vector<float>& a_input, std::vector<float>& a_output, unsigned int a_width, unsigned int a_height,
+		int a_stepX, int a_stepY, const std::vector<float>* a_linearDepths, float a_depthSigma, bool a_bQuantize)
+	{
+		JobSystem::GetInstance().ParallelFor(a_height, 16, [&](unsigned int a_begin, unsigned int a_end) {
+			for (unsigned int y = a_begin; y < a_end; y++) {
+				for (unsigned int x = 0; x < a_width; x++) {
+					float centerDepth = a_linearDepths != nullptr ? (*a_linearDepths)[y * a_width + x] : 0.f;
+					float total = 0.f;
+					float totalWeight = 0.f;
+					for (int i = -SSAO_BLUR_RADIUS; i <= SSAO_BLUR_RADIUS; i++) {
+						int sampleX = (int)x + i * a_stepX;
+						int sampleY = (int)y + i * a_stepY;
+						if (sampleX < 0 || sampleY < 0 || sampleX >= (int)a_width || sampleY >= (int)a_height)
+							continue;
+
+						unsigned int index = sampleY * a_width + sampleX;
+						float weight = 1.f;
+						if (a_linearDepths != nullptr) {
+							float difference = ((*a_linearDepths)[index] - centerDepth) / (a_depthSigma * centerDepth);
+							weight = std::exp(-0.5f * difference * difference);
+						}
+						total += a_input[index] * weight;
+						totalWeight += weight;
+					}
+
+					float blur = total / totalWeight;
+					a_output[y * a_width + x] = a_bQuantize ? std::floor(blur * 255.f + 0.5f) / 255.f : blur;
+				}
+			}
+		});
+	}
+
+	// Row-vector matrix product, a * b
+	Matrix4 Multiply(const Matrix4& a_first, const Matrix4& a_second)
+	{
+		Matrix4 result;
+		for (int row = 0; row < 4; row++) {
+			for (int column = 0; column < 4; column++) {
+				result.m[row][column] =
+					a_first.m[row][0] * a_second.m[0][column] + a_first.m[row][1] * a_second.m[1][column] +
+					a_first.m[row][2] * a_second.m[2][column] + a_first.m[row][3] * a_second.m[3][column];
+			}
+		}
+		return result;
+	}
+
+	// General 4x4 inverse by cofactors, in double so the reference doesn't add its own error
+	Matrix4 Invert(const Matrix4& a_matrix)
+	{
+		double m[16];
+		for (int i = 0; i < 16; i++) {
+			m[i] = a_matrix.m[i / 4][i % 4];
+		}
+
+		double inverse[16];
+		inverse[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+		inverse[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+		inverse[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+		inverse[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+		inverse[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+		inverse[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+		inverse[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+		inverse[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+		inverse[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+		inverse[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+		inverse[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+		inverse[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+		inverse[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+		inverse[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+		inverse[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+		inverse[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+		double determinant = m[0] * inverse[0] + m[1] * inverse[4] + m[2] * inverse[8] + m[3] * inverse[12];
+		double inverseDeterminant = determinant != 0.0 ? 1.0 / determinant : 0.0;
+
+		Matrix4 result;
+		for (int i = 0; i < 16; i++) {
+			result.m[i / 4][i % 4] = (float)(inverse[i] * inverseDeterminant);
+		}
+		return result;
+	}
+
+	// Little helpers for the capture format
+	template<typename T>
+	void WriteValues(std::ofstream& a_file, const T* a_values, size_t a_count)
+	{
+		a_file.write(reinterpret_cast<const char*>(a_values), sizeof(T) * a_count);
+	}
+
+	template<typename T>
+	bool ReadValues(std::ifstream& a_file, T* a_values, size_t a_count)
+	{
+		a_file.read(reinterpret_cast<char*>(a_values), sizeof(T) * a_count);
+		return a_file.good();
+	}
+}
+
+//-----------------------------------------------
+// Hemisphere kernel, biased towards the center
+// so nearby geometry counts more
+//-----------------------------------------------
+void SSAOReference::GenerateKernel(std::vector<Vector4>& a_offsets, unsigned int a_count, unsigned int a_seed)
+{
+	std::mt19937 generator(a_seed);
+	std::uniform_real_distribution<float> signedDistribution(-1.f, 1.f);
+	std::uniform_real_distribution<float> unsignedDistribution(0.f, 1.f);
+
+	a_offsets.resize(a_count);
+	for (unsigned int i = 0; i < a_count; i++) {
+		Vector3 offset = Normalize(Vector3(
+			signedDistribution(generator),
+			signedDistribution(generator),
+			unsignedDistribution(generator)));
+
+		// Quadratic falloff puts more samples close to the pixel than at the edge of the radius
+		float scale = (float)i / (float)a_count;
+		scale = 0.1f + (1.f - 0.1f) * scale * scale;
+		a_offsets[i] = Vector4(offset.x * scale, offset.y * scale, offset.z * scale, 0.f);
+	}
+}
+
+//-----------------------------------------------
+// Random rotations around Z (the TBN normal axis)
+//-----------------------------------------------
+void SSAOReference::GenerateRandomTexture(Vector4 a_pixels[SSAO_RANDOM_TEXTURE_SIZE * SSAO_RANDOM_TEXTURE_SIZE], unsigned int a_seed)
+{
+	std::mt19937 generator(a_seed);
+	std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+	for (int i = 0; i < SSAO_RANDOM_TEXTURE_SIZE * SSAO_RANDOM_TEXTURE_SIZE; i++) {
+		float x = distribution(generator);
+		float y = distribution(generator);
+		float inverseLength = 1.f / std::sqrt(x * x + y * y);
+		a_pixels[i] = Vector4(x * inverseLength, y * inverseLength, 0.f, 0.f);
+	}
+}
+
+//-----------------------------------------------
+// Evaluate one rectangle of the image
+//-----------------------------------------------
+void SSAOReference::ComputeTile(const SSAOGBuffer& a_gbuffer, const SSAOSettings& a_settings,
+	unsigned int a_x0, unsigned int a_y0, unsigned int a_x1, unsigned int a_y1,
+	std::vector<float>& a_output, bool a_bUseSIMD)
+{
+	unsigned int samples = a_settings.Samples;
+	if (samples > (unsigned int)a_settings.Offsets.size())
+		samples = (unsigned int)a_settings.Offsets.size();
+	if (samples > SSAO_MAX_SAMPLES)
+		samples = SSAO_MAX_SAMPLES;
+
+#if SSAO_REFERENCE_SSE
+	KernelSoA kernel = {};
+	for (unsigned int i = 0; i < samples; i++) {
+		const Vector4& offset = a_settings.Offsets[(a_settings.SampleStart + i) % a_settings.Offsets.size()];
+		kernel.X[i] = offset.x;
+		kernel.Y[i] = offset.y;
+		kernel.Z[i] = offset.z;
+	}
+#else
+	a_bUseSIMD = false;
+#endif
+
+	for (unsigned int y = a_y0; y < a_y1; y++) {
+		for (unsigned int x = a_x0; x < a_x1; x++) {
+			unsigned int index = y * a_gbuffer.Width + x;
+			float depth = a_gbuffer.Depths[index];
+
+			// Sky/Background is not occluded at all. No samples also means nothing to occlude with
+			if (depth == 1.f || samples == 0) {
+				a_output[index] = 1.f;
+				continue;
+			}
+
+			PixelBasis basis = BuildPixelBasis(a_gbuffer, a_settings, x, y, depth);
+
+			float totalAO;
+#if SSAO_REFERENCE_SSE
+			if (a_bUseSIMD)
+				totalAO = AccumulateSSE(a_gbuffer, a_settings, kernel, basis, samples);
+			else
+#endif
+				totalAO = AccumulateScalar(a_gbuffer, a_settings, basis, samples);
+
+			a_output[index] = 1.f - totalAO / (float)samples;
+		}
+	}
+}
+
+//-----------------------------------------------
+// Evaluate the whole image in compute-shader sized
+// tiles, one job per tile
+//-----------------------------------------------
+void SSAOReference::Compute(const SSAOGBuffer& a_gbuffer, const SSAOSettings& a_settings, std::vector<float>& a_output,
+	bool a_bMultithreaded, bool a_bUseSIMD)
+{
+	a_output.resize((size_t)a_gbuffer.Width * a_gbuffer.Height);
+	if (a_gbuffer.Width == 0 || a_gbuffer.Height == 0)
+		return;
+
+	unsigned int tilesX = (a_gbuffer.Width + SSAO_TILE_SIZE - 1) / SSAO_TILE_SIZE;
+	unsigned int tilesY = (a_gbuffer.Height + SSAO_TILE_SIZE - 1) / SSAO_TILE_SIZE;
+	std::function<void(unsigned int, unsigned int)> runTiles = [&](unsigned int a_begin, unsigned int a_end) {
+		for (unsigned int tile = a_begin; tile < a_end; tile++) {
+			unsigned int x0 = (tile % tilesX) * SSAO_TILE_SIZE;
+			unsigned int y0 = (tile / tilesX) * SSAO_TILE_SIZE;
+			unsigned int x1 = (x0 + SSAO_TILE_SIZE < a_gbuffer.Width) ? x0 + SSAO_TILE_SIZE : a_gbuffer.Width;
+			unsigned int y1 = (y0 + SSAO_TILE_SIZE < a_gbuffer.Height) ? y0 + SSAO_TILE_SIZE : a_gbuffer.Height;
+			ComputeTile(a_gbuffer, a_settings, x0, y0, x1, y1, a_output, a_bUseSIMD);
+		}
+	};
+
+	if (a_bMultithreaded)
+		JobSystem::GetInstance().ParallelFor(tilesX * tilesY, 1, runTiles);
+	else
+		runTiles(0, tilesX * tilesY);
+}
+
+//-----------------------------------------------
+// Checkerboard min/max depth reduction
+//-----------------------------------------------
+void SSAOReference::DownsampleGBuffer(const SSAOGBuffer& a_full, unsigned int a_factor, SSAOGBuffer& a_reduced)
+{
+	if (a_factor == 0)
+		a_factor = 1;
+
+	a_reduced.Width = (a_full.Width + a_factor - 1) / a_factor;
+	a_reduced.Height = (a_full.Height + a_factor - 1) / a_factor;
+	a_reduced.ViewMatrix = a_full.ViewMatrix;
+	a_reduced.ProjectionMatrix = a_full.ProjectionMatrix;
+	a_reduced.InverseProjectionMatrix = a_full.InverseProjectionMatrix;
+	a_reduced.Depths.resize((size_t)a_reduced.Width * a_reduced.Height);
+	a_reduced.Normals.resize((size_t)a_reduced.Width * a_reduced.Height);
+	a_reduced.GPUResult.clear();
+
+	for (unsigned int y = 0; y < a_reduced.Height; y++) {
+		for (unsigned int x = 0; x < a_reduced.Width; x++) {
+			bool bKeepMax = ((x + y) & 1) != 0;
+			unsigned int startX = x * a_factor;
+			unsigned int startY = y * a_factor;
+
+			unsigned int chosen = startY * a_full.Width + startX;
+			float chosenDepth = a_full.Depths[chosen];
+			for (unsigned int blockY = 0; blockY < a_factor; blockY++) {
+				for (unsigned int blockX = 0; blockX < a_factor; blockX++) {
+					// Edge blocks repeat the last row/column, same as the shader's min()
+					unsigned int fullX = (startX + blockX < a_full.Width) ? startX + blockX : a_full.Width - 1;
+					unsigned int fullY = (startY + blockY < a_full.Height) ? startY + blockY : a_full.Height - 1;
+					unsigned int index = fullY * a_full.Width + fullX;
+					float depth = a_full.Depths[index];
+					if (bKeepMax ? (depth > chosenDepth) : (depth < chosenDepth)) {
+						chosen = index;
+						chosenDepth = depth;
+					}
+				}
+			}
+
+			a_reduced.Depths[y * a_reduced.Width + x] = chosenDepth;
+			a_reduced.Normals[y * a_reduced.Width + x] = a_full.Normals[chosen];
+		}
+	}
+}
+
+//-----------------------------------------------
+// Bilinear weights from the 4 nearest reduced
+// texels, scaled by view depth similarity
+//-----------------------------------------------
+void SSAOReference::UpsampleBilateral(const std::vector<float>& a_reducedAO, const SSAOGBuffer& a_reduced, const SSAOGBuffer& a_full,
+	unsigned int a_factor, float a_depthSigma, std::vector<float>& a_output)
+{
+	if (a_factor == 0)
+		a_factor = 1;
+
+	std::vector<float> fullDepths;
+	std::vector<float> reducedDepths;
+	LinearizeDepths(a_full, fullDepths);
+	LinearizeDepths(a_reduced, reducedDepths);
+	a_output.resize((size_t)a_full.Width * a_full.Height);
+
+	JobSystem::GetInstance().ParallelFor(a_full.Height, 16, [&](unsigned int a_begin, unsigned int a_end) {
+		for (unsigned int y = a_begin; y < a_end; y++) {
+			for (unsigned int x = 0; x < a_full.Width; x++) {
+				float centerDepth = fullDepths[y * a_full.Width + x];
+
+				float reducedX = ((float)x + 0.5f) / (float)a_factor - 0.5f;
+				float reducedY = ((float)y + 0.5f) / (float)a_factor - 0.5f;
+				float baseX = std::floor(reducedX);
+				float baseY = std::floor(reducedY);
+				float fractionX = reducedX - baseX;
+				float fractionY = reducedY - baseY;
+
+				float total = 0.f;
+				float totalWeight = 0.f;
+				float closestDifference = 1e30f;
+				float closestAO = 1.f;
+				for (int i = 0; i < 4; i++) {
+					int offsetX = i & 1;
+					int offsetY = i >> 1;
+					int coordX = (int)baseX + offsetX;
+					int coordY = (int)baseY + offsetY;
+					coordX = coordX < 0 ? 0 : (coordX >= (int)a_reduced.Width ? (int)a_reduced.Width - 1 : coordX);
+					coordY = coordY < 0 ? 0 : (coordY >= (int)a_reduced.Height ? (int)a_reduced.Height - 1 : coordY);
+					unsigned int index = coordY * a_reduced.Width + coordX;
+
+					float ao = a_reducedAO[index];
+					float difference = std::fabs(reducedDepths[index] - centerDepth);
+					float relative = difference / (a_depthSigma * centerDepth);
+
+					float bilinear = (offsetX != 0 ? fractionX : 1.f - fractionX) * (offsetY != 0 ? fractionY : 1.f - fractionY);
+					float weight = bilinear * std::exp(-0.5f * relative * relative);
+					total += ao * weight;
+					totalWeight += weight;
+
+					if (difference < closestDifference) {
+						closestDifference = difference;
+						closestAO = ao;
+					}
+				}
+
+				a_output[y * a_full.Width + x] = (totalWeight > 0.0001f) ? total / totalWeight : closestAO;
+			}
+		}
+	});
+}
+
+//-----------------------------------------------
+// SamplesPerFrame should divide SSAO_MAX_SAMPLES,
+// otherwise a cycle's slices overlap and it's
+// only close to the full kernel
+//-----------------------------------------------
+unsigned int SSAOReference::GetCycleFrames(const SSAOTemporalSettings& a_settings)
+{
+	unsigned int samples = a_settings.SamplesPerFrame > 0 ? a_settings.SamplesPerFrame : 1;
+	return (SSAO_MAX_SAMPLES + samples - 1) / samples;
+}
+
+unsigned int SSAOReference::GetMaxCycles(const SSAOTemporalSettings& a_settings)
+{
+	unsigned int cycles = a_settings.MaxHistory / GetCycleFrames(a_settings);
+	return cycles > 0 ? cycles : 1;
+}
+
+//-----------------------------------------------
+// Reproject, reject on disocclusion, accumulate
+//	- Frames are averaged into a partial cycle.
+//	  Once it holds a whole cycle, every kernel
+//	  slice once, it's blended into the resolved
+//	  AO with 1 / cycles, capped at GetMaxCycles
+//	- The resolved AO is output once a pixel has
+//	  a whole cycle, the partial one before that.
+//	  So a still camera matches the full kernel
+//	  exactly from its first whole cycle on
+//-----------------------------------------------
+void SSAOReference::TemporalResolve(const SSAOGBuffer& a_current, const std::vector<float>& a_currentAO, const SSAOTemporalSettings& a_settings,
+	SSAOTemporalHistory& a_history, std::vector<float>& a_output)
+{
+	unsigned int width = a_current.Width;
+	unsigned int height = a_current.Height;
+	size_t pixelCount = (size_t)width * height;
+	bool bHistoryUsable = a_history.bIsValid && a_history.Width == width && a_history.Height == height;
+
+	Matrix4 inverseViewProjection = Invert(Multiply(a_current.ViewMatrix, a_current.ProjectionMatrix));
+	Matrix4 previousViewProjection = Multiply(a_history.ViewMatrix, a_history.ProjectionMatrix);
+	const float(&inv)[4][4] = inverseViewProjection.m;
+	const float(&prev)[4][4] = previousViewProjection.m;
+	float linearScale = a_current.ProjectionMatrix.m[3][2];
+	float linearOffset = a_current.ProjectionMatrix.m[2][2];
+	float cycleFrames = (float)GetCycleFrames(a_settings);
+	float maxCycles = (float)GetMaxCycles(a_settings);
+
+	std::vector<float> newAO(pixelCount);
+	std::vector<float> newPartialAO(pixelCount);
+	std::vector<float> newFrames(pixelCount);
+	std::vector<float> newCycles(pixelCount);
+	a_output.resize(pixelCount);
+
+	JobSystem::GetInstance().ParallelFor(height, 16, [&](unsigned int a_begin, unsigned int a_end) {
+		for (unsigned int y = a_begin; y < a_end; y++) {
+			for (unsigned int x = 0; x < width; x++) {
+				unsigned int index = y * width + x;
+				float depth = a_current.Depths[index];
+				if (depth == 1.f) {
+					newAO[index] = 1.f;
+					newPartialAO[index] = 1.f;
+					newFrames[index] = 0.f;
+					newCycles[index] = 0.f;
+					a_output[index] = 1.f;
+					continue;
+				}
+
+				// Pixel center to world, world to last frame's clip space
+				float ndcX = ((float)x + 0.5f) / (float)width * 2.f - 1.f;
+				float ndcY = 1.f - ((float)y + 0.5f) / (float)height * 2.f;
+				float world[4];
+				for (int column = 0; column < 4; column++) {
+					world[column] = ndcX * inv[0][column] + ndcY * inv[1][column] + depth * inv[2][column] + inv[3][column];
+				}
+				float worldX = world[0] / world[3];
+				float worldY = world[1] / world[3];
+				float worldZ = world[2] / world[3];
+				float clipX = worldX * prev[0][0] + worldY * prev[1][0] + worldZ * prev[2][0] + prev[3][0];
+				float clipY = worldX * prev[0][1] + worldY * prev[1][1] + worldZ * prev[2][1] + prev[3][1];
+				float clipW = worldX * prev[0][3] + worldY * prev[1][3] + worldZ * prev[2][3] + prev[3][3];
+				float previousU = clipX / clipW * 0.5f + 0.5f;
+				float previousV = 0.5f - clipY / clipW * 0.5f;
+
+				float historyAO = 1.f;
+				float historyPartialAO = 1.f;
+				float historyFrames = 0.f;
+				float historyCycles = 0.f;
+				bool bIsValid = bHistoryUsable && clipW > 0.f &&
+					previousU >= 0.f && previousU < 1.f && previousV >= 0.f && previousV < 1.f;
+				if (bIsValid) {
+					unsigned int previousX = (unsigned int)(previousU * (float)width);
+					unsigned int previousY = (unsigned int)(previousV * (float)height);
+					previousX = previousX < width ? previousX : width - 1;
+					previousY = previousY < height ? previousY : height - 1;
+					unsigned int previousIndex = previousY * width + previousX;
+
+					float previousDepth = linearScale / (a_history.Depths[previousIndex] - linearOffset);
+					bIsValid = std::fabs(previousDepth - clipW) < a_settings.DepthThreshold * clipW;
+
+					const Vector4& packed = a_current.Normals[index];
+					const Vector4& previousPacked = a_history.Normals[previousIndex];
+					Vector3 normal = Normalize(Vector3(packed.x * 2.f - 1.f, packed.y * 2.f - 1.f, packed.z * 2.f - 1.f));
+					Vector3 previousNormal = Normalize(Vector3(previousPacked.x * 2.f - 1.f, previousPacked.y * 2.f - 1.f, previousPacked.z * 2.f - 1.f));
+					float similarity = normal.x * previousNormal.x + normal.y * previousNormal.y + normal.z * previousNormal.z;
+					bIsValid = bIsValid && similarity > a_settings.NormalThreshold;
+
+					if (bIsValid) {
+						historyAO = a_history.AO[previousIndex];
+						historyPartialAO = a_history.PartialAO[previousIndex];
+						historyFrames = a_history.Frames[previousIndex];
+						historyCycles = a_history.Cycles[previousIndex];
+					}
+				}
+
+				float frames = historyFrames + 1.f;
+				float partialAO = historyPartialAO + (a_currentAO[index] - historyPartialAO) * (1.f / frames);
+				float ao = historyAO;
+				float cycles = historyCycles;
+				if (frames >= cycleFrames) {
+					cycles = cycles + 1.f < maxCycles ? cycles + 1.f : maxCycles;
+					ao = historyAO + (partialAO - historyAO) * (1.f / cycles);
+					frames = 0.f;
+				}
+				newAO[index] = ao;
+				newPartialAO[index] = partialAO;
+				newFrames[index] = frames;
+				newCycles[index] = cycles;
+				a_output[index] = cycles > 0.f ? ao : partialAO;
+			}
+		}
+	});
+
+	// This frame becomes the history for the next one
+	a_history.bIsValid = true;
+	a_history.Width = width;
+	a_history.Height = height;
+	a_history.ViewMatrix = a_current.ViewMatrix;
+	a_history.ProjectionMatrix = a_current.ProjectionMatrix;
+	a_history.Depths = a_current.Depths;
+	a_history.Normals = a_current.Normals;
+	a_history.AO.swap(newAO);
+	a_history.PartialAO.swap(newPartialAO);
+	a_history.Frames.swap(newFrames);
+	a_history.Cycles.swap(newCycles);
+}
+
+//-----------------------------------------------
+// view z = _43 / (depth - _33) for a perspective
+// projection
+//-----------------------------------------------
+void SSAOReference::LinearizeDepths(const SSAOGBuffer& a_gbuffer, std::vector<float>& a_linearDepths)
+{
+	float scale = a_gbuffer.ProjectionMatrix.m[3][2];
+	float offset = a_gbuffer.ProjectionMatrix.m[2][2];
+	a_linearDepths.resize(a_gbuffer.Depths.size());
+	for (size_t i = 0; i < a_gbuffer.Depths.size(); i++) {
+		a_linearDepths[i] = scale / (a_gbuffer.Depths[i] - offset);
+	}
+}
+
+//-----------------------------------------------
+// Direct 25 texel box blur, kept as the baseline
+// the separable version is measured against
+//-----------------------------------------------
+void SSAOReference::BlurBox(const std::vector<float>& a_input, std::vector<float>& a_output, unsigned int a_width, unsigned int a_height)
+{
+	a_output.resize(a_input.size());
+	JobSystem::GetInstance().ParallelFor(a_height, 16, [&](unsigned int a_begin, unsigned int a_end) {
+		for (unsigned int y = a_begin; y < a_end; y++) {
+			for (unsigned int x = 0; x < a_width; x++) {
+				float total = 0.f;
+				float sampleCount = 0.f;
+				for (int sampleY = (int)y - SSAO_BLUR_RADIUS; sampleY <= (int)y + SSAO_BLUR_RADIUS; sampleY++) {
+					if (sampleY < 0 || sampleY >= (int)a_height) continue;
+					for (int sampleX = (int)x - SSAO_BLUR_RADIUS; sampleX <= (int)x + SSAO_BLUR_RADIUS; sampleX++) {
+						if (sampleX < 0 || sampleX >= (int)a_width) continue;
+						total += a_input[sampleY * a_width + sampleX];
+						sampleCount += 1.f;
+					}
+				}
+				a_output[y * a_width + x] = total / sampleCount;
+			}
+		}
+	});
+}
+
+//-----------------------------------------------
+// Horizontal pass into scratch, then vertical
+//	- Without depths this is exactly the box blur
+//	  (up to float rounding), since a box kernel is
+//	  separable and both skip out-of-bounds texels
+//-----------------------------------------------
+void SSAOReference::BlurSeparable(const std::vector<float>& a_input, std::vector<float>& a_output, unsigned int a_width, unsigned int a_height,
+	const std::vector<float>* a_linearDepths, float a_depthSigma, bool a_bQuantizeIntermediate)
+{
+	std::vector<float> horizontal(a_input.size());
+	a_output.resize(a_input.size());
+	BlurPass(a_input, horizontal, a_width, a_height, 1, 0, a_linearDepths, a_depthSigma, a_bQuantizeIntermediate);
+	BlurPass(horizontal, a_output, a_width, a_height, 0, 1, a_linearDepths, a_depthSigma, false);
+}
+
+//-----------------------------------------------
+// Absolute difference stats between two AO images
+//-----------------------------------------------
+SSAOComparison SSAOReference::Compare(const std::vector<float>& a_first, const std::vector<float>& a_second, float a_tolerance)
+{
+	SSAOComparison comparison;
+	size_t count = a_first.size() < a_second.size() ? a_first.size() : a_second.size();
+	double totalError = 0.0;
+	for (size_t i = 0; i < count; i++) {
+		float error = std::fabs(a_first[i] - a_second[i]);
+		if (!(error <= a_tolerance)) // Also catches NaN
+			comparison.PixelsOverTolerance++;
+		if (error > comparison.MaxError)
+			comparison.MaxError = error;
+		totalError += error;
+	}
+	comparison.PixelCount = (unsigned int)count;
+	comparison.MeanError = count > 0 ? (float)(totalError / (double)count) : 0.f;
+	return comparison;
+}
+
+//-----------------------------------------------
+// Ground plane with spheres resting on it, seen by
+// a camera pitched slightly down - lots of contact
+// creases for the AO to find
+//	- Matrices follow XMMatrixPerspectiveFovLH and
+//	  a LookTo view, built by hand so no math library
+//	  calls are needed
+//-----------------------------------------------
+void SSAOReference::GenerateSyntheticGBuffer(unsigned int a_width, unsigned int a_height, unsigned int a_seed, SSAOGBuffer& a_gbuffer,
+	float a_cameraShift)
+{
+	const float fieldOfView = 3.14159265f / 3.f;
+	const float nearPlane = 0.1f;
+	const float farPlane = 100.f;
+	const float pitch = 0.3f;
+	const Vector3 cameraPosition(a_cameraShift, 2.5f, -7.f);
+
+	a_gbuffer.Width = a_width;
+	a_gbuffer.Height = a_height;
+
+	// Camera basis
+	Vector3 right(1.f, 0.f, 0.f);
+	Vector3 up(0.f, std::cos(pitch), std::sin(pitch));
+	Vector3 forward(0.f, -std::sin(pitch), std::cos(pitch));
+	a_gbuffer.ViewMatrix = Matrix4(
+		right.x, up.x, forward.x, 0.f,
+		right.y, up.y, forward.y, 0.f,
+		right.z, up.z, forward.z, 0.f,
+		-(cameraPosition.x * right.x + cameraPosition.y * right.y + cameraPosition.z * right.z),
+		-(cameraPosition.x * up.x + cameraPosition.y * up.y + cameraPosition.z * up.z),
+		-(cameraPosition.x * forward.x + cameraPosition.y * forward.y + cameraPosition.z * forward.z), 1.f);
+
+	float yScale = 1.f / std::tan(fieldOfView * 0.5f);
+	float xScale = yScale / ((float)a_width / (float)a_height);
+	float range = farPlane / (farPlane - nearPlane);
+	a_gbuffer.ProjectionMatrix = Matrix4(
+		xScale, 0.f, 0.f, 0.f,
+		0.f, yScale, 0.f, 0.f,
+		0.f, 0.f, range, 1.f,
+		0.f, 0.f, -range * nearPlane, 0.f);
+	a_gbuffer.InverseProjectionMatrix = Matrix4(
+		1.f / xScale, 0.f, 0.f, 0.f,
+		0.f, 1.f / yScale, 0.f, 0.f,
+		0.f, 0.f, 0.f, -1.f / (range * nearPlane),
+		0.f, 0.f, 1.f, 1.f / nearPlane);
+
+	// Spheres sitting on the ground
+	struct Sphere { Vector3 Center; float Radius; };
+	std::vector<Sphere> spheres;
+	std::mt19937 generator(a_seed);
+	std::uniform_real_distribution<float> xDistribution(-4.f, 4.f);
+	std::uniform_real_distribution<float> zDistribution(0.f, 8.f);
+	std::uniform_real_distribution<float> radiusDistribution(0.4f, 1.2f);
+	for (int i = 0; i < 8; i++) {
+		float radius = radiusDistribution(generator);
+		spheres.push_back({ Vector3(xDistribution(generator), radius, zDistribution(generator)), radius });
+	}
+
+	a_gbuffer.Depths.assign((size_t)a_width * a_height, 1.f);
+	a_gbuffer.Normals.assign((size_t)a_width * a_height, Vector4(0.5f, 0.5f, 0.5f, 0.f));
+	a_gbuffer.GPUResult.clear();
+
+	std::function<void(unsigned int, unsigned int)> castRows = [&](unsigned int a_begin, unsigned int a_end) {
+		for (unsigned int y = a_begin; y < a_end; y++) {
+			for (unsigned int x = 0; x < a_width; x++) {
+				// View space ray through the pixel center with z = 1, so the hit distance IS view z
+				float ndcX = ((float)x + 0.5f) / (float)a_width * 2.f - 1.f;
+				float ndcY = 1.f - ((float)y + 0.5f) / (float)a_height * 2.f;
+				float viewX = ndcX / xScale;
+				float viewY = ndcY / yScale;
+				Vector3 direction(
+					viewX * right.x + viewY * up.x + forward.x,
+					viewX * right.y + viewY * up.y + forward.y,
+					viewX * right.z + viewY * up.z + forward.z);
+
+				float closest = farPlane;
+				Vector3 normal(0.f, 0.f, 0.f);
+
+				// Ground plane at y = 0
+				if (direction.y < 0.f) {
+					float t = -cameraPosition.y / direction.y;
+					if (t < closest) {
+						closest = t;
+						normal = Vector3(0.f, 1.f, 0.f);
+					}
+				}
+
+				for (const Sphere& sphere : spheres) {
+					Vector3 toCamera(cameraPosition.x - sphere.Center.x, cameraPosition.y - sphere.Center.y, cameraPosition.z - sphere.Center.z);
+					float a = direction.x * direction.x + direction.y * direction.y + direction.z * direction.z;
+					float b = 2.f * (toCamera.x * direction.x + toCamera.y * direction.y + toCamera.z * direction.z);
+					float c = toCamera.x * toCamera.x + toCamera.y * toCamera.y + toCamera.z * toCamera.z - sphere.Radius * sphere.Radius;
+					float discriminant = b * b - 4.f * a * c;
+					if (discriminant < 0.f)
+						continue;
+					float t = (-b - std::sqrt(discriminant)) / (2.f * a);
+					if (t > nearPlane && t < closest) {
+						closest = t;
+						normal = Vector3(
+							(cameraPosition.x + direction.x * t - sphere.Center.x) / sphere.Radius,
+							(cameraPosition.y + direction.y * t - sphere.Center.y) / sphere.Radius,
+							(cameraPosition.z + direction.z * t - sphere.Center.z) / sphere.Radius);
+					}
+				}
+
+				if (closest >= farPlane)
+					continue;
+
+				unsigned int index = y * a_width + x;
+				a_gbuffer.Depths[index] = range - range * nearPlane / closest; // (z * range - range * near) / z
+				a_gbuffer.Normals[index] = Vector4(normal.x * 0.5f + 0.5f, normal.y * 0.5f + 0.5f, normal.z * 0.5f + 0.5f, 1.f);
+			}
+		}
+	};
+	JobSystem::GetInstance().ParallelFor(a_height, 16, castRows);
+}
+
+//-----------------------------------------------
+// Write a capture file. Layout is raw little-endian
+// values in the order of the struct members
+//-----------------------------------------------
+bool SSAOReference::SaveCapture(const std::string& a_fileName, const SSAOGBuffer& a_gbuffer, const SSAOSettings& a_settings)
+{
+	std::ofstream file(a_fileName, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	size_t pixelCount = (size_t)a_gbuffer.Width * a_gbuffer.Height;
+	if (a_gbuffer.Depths.size() != pixelCount || a_gbuffer.Normals.size() != pixelCount)
+		return false;
+
+	unsigned int offsetCount = (unsigned int)a_settings.Offsets.size();
+	unsigned int hasGPUResult = a_gbuffer.GPUResult.size() == pixelCount ? 1 : 0;
+
+	file.write(SSAO_CAPTURE_MAGIC, 8);
+	WriteValues(file, &a_gbuffer.Width, 1);
+	WriteValues(file, &a_gbuffer.Height, 1);
+	WriteValues(file, &a_gbuffer.ViewMatrix, 1);
+	WriteValues(file, &a_gbuffer.ProjectionMatrix, 1);
+	WriteValues(file, &a_gbuffer.InverseProjectionMatrix, 1);
+	WriteValues(file, &a_settings.Radius, 1);
+	WriteValues(file, &a_settings.Samples, 1);
+	WriteValues(file, &offsetCount, 1);
+	if (offsetCount > 0)
+		WriteValues(file, &a_settings.Offsets[0], offsetCount);
+	WriteValues(file, &a_settings.RandomTexture[0], SSAO_RANDOM_TEXTURE_SIZE * SSAO_RANDOM_TEXTURE_SIZE);
+	WriteValues(file, &a_gbuffer.Depths[0], pixelCount);
+	WriteValues(file, &a_gbuffer.Normals[0], pixelCount);
+	WriteValues(file, &hasGPUResult, 1);
+	if (hasGPUResult)
+		WriteValues(file, &a_gbuffer.GPUResult[0], pixelCount);
+
+	return file.good();
+}
+
+//-----------------------------------------------
+// Read a capture written by SaveCapture
+//-----------------------------------------------
+bool SSAOReference::LoadCapture(const std::string& a_fileName, SSAOGBuffer& a_gbuffer, SSAOSettings& a_settings)
+{
+	std::ifstream file(a_fileName, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	char magic[8] = {};
+	if (!ReadValues(file, magic, 8) || std::memcmp(magic, SSAO_CAPTURE_MAGIC, 8) != 0)
+		return false;
+
+	unsigned int offsetCount = 0;
+	if (!ReadValues(file, &a_gbuffer.Width, 1) || !ReadValues(file, &a_gbuffer.Height, 1) ||
+		!ReadValues(file, &a_gbuffer.ViewMatrix, 1) || !ReadValues(file, &a_gbuffer.ProjectionMatrix, 1) ||
+		!ReadValues(file, &a_gbuffer.InverseProjectionMatrix, 1) || !ReadValues(file, &a_settings.Radius, 1) ||
+		!ReadValues(file, &a_settings.Samples, 1) || !ReadValues(file, &offsetCount, 1))
+		return false;
+
+	if (a_gbuffer.Width == 0 || a_gbuffer.Width > SSAO_CAPTURE_MAX_DIMENSION ||
+		a_gbuffer.Height == 0 || a_gbuffer.Height > SSAO_CAPTURE_MAX_DIMENSION || offsetCount > SSAO_MAX_SAMPLES)
+		return false;
+
+	size_t pixelCount = (size_t)a_gbuffer.Width * a_gbuffer.Height;
+	a_settings.Offsets.resize(offsetCount);
+	a_gbuffer.Depths.resize(pixelCount);
+	a_gbuffer.Normals.resize(pixelCount);
+	if ((offsetCount > 0 && !ReadValues(file, &a_settings.Offsets[0], offsetCount)) ||
+		!ReadValues(file, &a_settings.RandomTexture[0], SSAO_RANDOM_TEXTURE_SIZE * SSAO_RANDOM_TEXTURE_SIZE) ||
+		!ReadValues(file, &a_gbuffer.Depths[0], pixelCount) ||
+		!ReadValues(file, &a_gbuffer.Normals[0], pixelCount))
+		return false;
+
+	unsigned int hasGPUResult = 0;
+	if (!ReadValues(file, &hasGPUResult, 1))
+		return false;
+	a_gbuffer.GPUResult.clear();
+	if (hasGPUResult) {
+		a_gbuffer.GPUResult.resize(pixelCount);
+		if (!ReadValues(file, &a_gbuffer.GPUResult[0], pixelCount))
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Types.h"
+
+#define SSAO_MAX_SAMPLES 64 // Size of c_offsets in ScreenSpaceAmbientOcclusionCS
+#define SSAO_RANDOM_TEXTURE_SIZE 4 // Width and height of the random rotation texture
+#define SSAO_TILE_SIZE 32 // Matches the compute shader's [numthreads(32, 32, 1)]
+#define SSAO_BLUR_RADIUS 2 // Matches BLUR_RADIUS in SeparableBlur.hlsli and the 5x5 box blur
+
+//-------------------------------------------------------
+// Everything the SSAO compute pass reads from the scene,
+// as flat CPU arrays
+//	- Depths are post-projection depth (0-1, 1 is sky),
+//	  exactly what RT_SCENE_DEPTH holds
+//	- Normals are world space packed into 0-1, exactly
+//	  what RT_SCENE_NORMAL holds (w is ignored)
+//	- GPUResult is optional - filled when loaded from a
+//	  capture taken by the Renderer, for comparisons
+//-------------------------------------------------------
+struct SSAOGBuffer {
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+	Matrix4 ViewMatrix = {};
+	Matrix4 ProjectionMatrix = {};
+	Matrix4 InverseProjectionMatrix = {};
+	std::vector<float> Depths;
+	std::vector<Vector4> Normals;
+	std::vector<float> GPUResult;
+};
+
+//-------------------------------------------------------
+// The cbuffer and random texture contents for the pass
+//-------------------------------------------------------
+struct SSAOSettings {
+	std::vector<Vector4> Offsets; // Hemisphere kernel, at most SSAO_MAX_SAMPLES
+	Vector4 RandomTexture[SSAO_RANDOM_TEXTURE_SIZE * SSAO_RANDOM_TEXTURE_SIZE] = {};
+	float Radius = 1.f;
+	unsigned int Samples = SSAO_MAX_SAMPLES; // Clamped to Offsets.size()
+	unsigned int SampleStart = 0; // First offset used, wrapping around the kernel (c_sampleStart)
+};
+
+//-------------------------------------------------------
+// Tuning for temporal accumulation, see TemporalResolve
+//-------------------------------------------------------
+struct SSAOTemporalSettings {
+	unsigned int SamplesPerFrame = 8; // Kernel offsets evaluated each frame
+	unsigned int MaxHistory = 16; // Frames of history, as whole kernel cycles (rounded down, at least one)
+	float DepthThreshold = 0.05f; // Allowed relative view depth change before history is rejected
+	float NormalThreshold = 0.9f; // Minimum dot product between current and previous normals
+};
+
+//-------------------------------------------------------
+// Everything carried between frames for temporal SSAO
+//	- Depths and Normals are the previous frame's G-buffer
+//	  (same packing as SSAOGBuffer)
+//	- AO averages the whole kernel cycles a pixel has seen
+//	  (Cycles of them), PartialAO the Frames of the cycle
+//	  still being accumulated
+//-------------------------------------------------------
+struct SSAOTemporalHistory {
+	bool bIsValid = false;
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+	Matrix4 ViewMatrix = {};
+	Matrix4 ProjectionMatrix = {};
+	std::vector<float> Depths;
+	std::vector<Vector4> Normals;
+	std::vector<float> AO;
+	std::vector<float> PartialAO;
+	std::vector<float> Frames;
+	std::vector<float> Cycles;
+};
+
+//-------------------------------------------------------
+// Result of comparing two AO images
+//-------------------------------------------------------
+struct SSAOComparison {
+	float MaxError = 0.f;
+	float MeanError = 0.f;
+	unsigned int PixelsOverTolerance = 0;
+	unsigned int PixelCount = 0;
+};
+
+//-------------------------------------------------------
+// CPU implementation of ScreenSpaceAmbientOcclusionCS
+//	- Follows the shader step for step (view position from
+//	  depth, TBN from the wrapped random texture, clamped
+//	  bilinear depth fetches, range check) so output matches
+//	  the GPU within filtering precision
+//	- Works on 32x32 tiles, spread over the JobSystem, and
+//	  evaluates 4 kernel samples at a time with SSE when the
+//	  target supports it
+//	- Used as a correctness oracle for shader changes and as
+//	  the AO source on headless nodes with no GPU
+//-------------------------------------------------------
+namespace SSAOReference
+{
+	// Kernel and random texture generation, shared with the Renderer so both sides use identical data
+	void GenerateKernel(std::vector<Vector4>& a_offsets, unsigned int a_count, unsigned int a_seed);
+	void GenerateRandomTexture(Vector4 a_pixels[SSAO_RANDOM_TEXTURE_SIZE * SSAO_RANDOM_TEXTURE_SIZE], unsigned int a_seed);
+
+	// Compute AO for pixels [a_x0, a_x1) x [a_y0, a_y1). a_output must hold Width * Height values
+	void ComputeTile(const SSAOGBuffer& a_gbuffer, const SSAOSettings& a_settings,
+		unsigned int a_x0, unsigned int a_y0, unsigned int a_x1, unsigned int a_y1,
+		std::vector<float>& a_output, bool a_bUseSIMD);
+
+	// Compute AO for the whole buffer, optionally tiled across the JobSystem
+	void Compute(const SSAOGBuffer& a_gbuffer, const SSAOSettings& a_settings, std::vector<float>& a_output,
+		bool a_bMultithreaded, bool a_bUseSIMD);
+
+	// SSAODownsampleCS - keep one texel per a_factor x a_factor block, alternating closest / farthest
+	// depth in a checkerboard. Matrices are copied over unchanged
+	void DownsampleGBuffer(const SSAOGBuffer& a_full, unsigned int a_factor, SSAOGBuffer& a_reduced);
+
+	// SSAOUpsampleCS - joint bilateral upsample of AO computed on a DownsampleGBuffer result
+	void UpsampleBilateral(const std::vector<float>& a_reducedAO, const SSAOGBuffer& a_reduced, const SSAOGBuffer& a_full,
+		unsigned int a_factor, float a_depthSigma, std::vector<float>& a_output);
+
+	// Post-projection depth to positive view z, as the bilateral blur uses it
+	void LinearizeDepths(const SSAOGBuffer& a_gbuffer, std::vector<float>& a_linearDepths);
+
+	// FiveByFiveBlurCS - 5x5 average of the in-bounds texels
+	void BlurBox(const std::vector<float>& a_input, std::vector<float>& a_output, unsigned int a_width, unsigned int a_height);
+
+	// SeparableBlurHorizontalCS followed by SeparableBlurVerticalCS
+	//	- a_linearDepths enables the bilateral weights (nullptr for a plain box)
+	//	- a_bQuantizeIntermediate rounds the first pass to 8 bits, like the UNORM target between GPU passes
+	void BlurSeparable(const std::vector<float>& a_input, std::vector<float>& a_output, unsigned int a_width, unsigned int a_height,
+		const std::vector<float>* a_linearDepths, float a_depthSigma, bool a_bQuantizeIntermediate);
+
+	// Per-pixel absolute difference stats. Sizes must match
+	SSAOComparison Compare(const std::vector<float>& a_first, const std::vector<float>& a_second, float a_tolerance);
+
+	// Frames it takes SamplesPerFrame to cover the kernel once, and how many such cycles the history averages
+	unsigned int GetCycleFrames(const SSAOTemporalSettings& a_settings);
+	unsigned int GetMaxCycles(const SSAOTemporalSettings& a_settings);
+
+	// SSAOTemporalCS - blend this frame's partial-kernel AO with reprojected history
+	//	- a_history is read as last frame's state and replaced with this frame's
+	//	- a_output receives the accumulated AO that moves on to the blur
+	void TemporalResolve(const SSAOGBuffer& a_current, const std::vector<float>& a_currentAO, const SSAOTemporalSettings& a_settings,
+		SSAOTemporalHistory& a_history, std::vector<float>& a_output);
+
+	// Ray cast a ground plane and a handful of spheres into a G-buffer, for benchmarks without a capture
+	//	- a_cameraShift slides the camera along X, to simulate motion for temporal tests
+	void GenerateSyntheticGBuffer(unsigned int a_width, unsigned int a_height, unsigned int a_seed, SSAOGBuffer& a_gbuffer,
+		float a_cameraShift = 0.f);
+
+	// Binary captures hold the G-buffer, camera matrices, settings and (optionally) the GPU result
+	bool SaveCapture(const std::string& a_fileName, const SSAOGBuffer& a_gbuffer, const SSAOSettings& a_settings);
+	bool LoadCapture(const std::string& a_fileName, SSAOGBuffer& a_gbuffer, SSAOSettings& a_settings);
+}
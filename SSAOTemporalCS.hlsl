@@ -0,0 +1,97 @@
+/**
+* Temporal accumulation for SSAO. The core pass only evaluates a rotating subset of the kernel each frame
+* (c_sampleStart / c_samples), and this pass blends that noisy result with the reprojected history
+*	- Each pixel is unprojected to world space with this frame's matrices, then projected with last frame's
+*	  View * Projection to find where it was on screen
+*	- History is thrown away when that position is off screen, or when the previous frame's depth or normal
+*	  there doesn't match (disocclusion)
+*	- History holds two averages. Frames are averaged into a partial cycle, and once that covers the whole
+*	  kernel (c_cycleFrames frames, every slice once) it's blended into the resolved AO with 1 / cycles, up
+*	  to c_maxCycles. Only whole cycles reach the resolved AO, so a still camera matches the full kernel
+*	  exactly from its first whole cycle on, however long it stays still
+*	- Output is the resolved AO, or the partial cycle until a pixel has a whole one
+*	- Must match SSAOReference::TemporalResolve in C++
+*/
+
+cbuffer TemporalData : register(b0)
+{
+	matrix c_inverseViewProjection; // This frame
+	matrix c_previousViewProjection; // Last frame
+	int2 c_windowDimensions;
+	float2 c_depthLinearize; // Projection _33 and _43 - view z = _43 / (depth - _33)
+	float c_depthThreshold; // Relative view depth change allowed before rejecting history
+	float c_normalThreshold; // Minimum dot between current and previous normals
+	int c_cycleFrames; // Frames to cover the kernel once
+	int c_maxCycles; // Whole cycles the resolved AO averages
+	int c_historyValid; // 0 after resizes, camera switches and mode changes
+};
+
+Texture2D CurrentSSAO : register(t0);
+Texture2D SceneDepths : register(t1);
+Texture2D SceneNormals : register(t2);
+Texture2D HistorySSAO : register(t3); // x = resolved AO, y = partial cycle AO, z = frames in the partial cycle, w = whole cycles
+Texture2D PreviousDepths : register(t4);
+Texture2D PreviousNormals : register(t5);
+
+RWTexture2D<float4> HistoryResult : register(u0);
+RWTexture2D<unorm float4> SSAOResult : register(u1);
+
+float LinearDepth(float a_depth)
+{
+	return c_depthLinearize.y / (a_depth - c_depthLinearize.x);
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+	if ((int)DTid.x >= c_windowDimensions.x || (int)DTid.y >= c_windowDimensions.y) return;
+
+	float current = CurrentSSAO[DTid.xy].r;
+	float depth = SceneDepths[DTid.xy].r;
+
+	// Sky has nothing to accumulate
+	if (depth == 1.f) {
+		HistoryResult[DTid.xy] = float4(1.f, 1.f, 0.f, 0.f);
+		SSAOResult[DTid.xy] = float4(1.f, 1.f, 1.f, 1.f);
+		return;
+	}
+
+	// Reproject the pixel center into last frame
+	float2 uv = (float2(DTid.xy) + 0.5f) / float2(c_windowDimensions);
+	float4 world = mul(c_inverseViewProjection, float4(uv.x * 2.f - 1.f, 1.f - uv.y * 2.f, depth, 1.f));
+	world /= world.w;
+	float4 previousClip = mul(c_previousViewProjection, float4(world.xyz, 1.f));
+	float2 previousUV = float2(previousClip.x / previousClip.w * 0.5f + 0.5f, 0.5f - previousClip.y / previousClip.w * 0.5f);
+
+	float4 history = float4(1.f, 1.f, 0.f, 0.f);
+	bool bIsValid = c_historyValid != 0 && previousClip.w > 0.f &&
+		all(previousUV >= 0.f) && all(previousUV < 1.f);
+	if (bIsValid) {
+		int2 previousCoord = min(int2(previousUV * float2(c_windowDimensions)), c_windowDimensions - 1);
+
+		// Clip w is view depth, so it can be compared directly against last frame's linearized depth
+		float previousDepth = LinearDepth(PreviousDepths[previousCoord].r);
+		bIsValid = abs(previousDepth - previousClip.w) < c_depthThreshold * previousClip.w;
+
+		float3 normal = normalize(SceneNormals[DTid.xy].xyz * 2.f - 1.f);
+		float3 previousNormal = normalize(PreviousNormals[previousCoord].xyz * 2.f - 1.f);
+		bIsValid = bIsValid && dot(normal, previousNormal) > c_normalThreshold;
+
+		if (bIsValid)
+			history = HistorySSAO[previousCoord];
+	}
+
+	float frames = history.z + 1.f;
+	float partialAO = lerp(history.y, current, 1.f / frames);
+	float ao = history.x;
+	float cycles = history.w;
+	if (frames >= (float)c_cycleFrames) {
+		cycles = min(cycles + 1.f, (float)c_maxCycles);
+		ao = lerp(history.x, partialAO, 1.f / cycles);
+		frames = 0.f;
+	}
+	float result = cycles > 0.f ? ao : partialAO;
+
+	HistoryResult[DTid.xy] = float4(ao, partialAO, frames, cycles);
+	SSAOResult[DTid.xy] = float4(result.rrr, 1.f);
+}
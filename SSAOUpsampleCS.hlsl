@@ -0,0 +1,67 @@
+/**
+* Joint bilateral upsample of reduced resolution SSAO back to full resolution. Each full resolution pixel
+* blends the 4 nearest reduced texels with bilinear weights, scaled down by how different each texel's view
+* depth is from the pixel's own - so AO from a background surface isn't smeared onto the foreground edge
+*	- When every texel is rejected, the one with the closest depth is used on its own
+*	- Must match SSAOReference::UpsampleBilateral in C++
+*/
+
+cbuffer UpsampleData : register(b0)
+{
+	int2 c_fullDimensions;
+	int2 c_reducedDimensions;
+	float2 c_depthLinearize; // Projection _33 and _43 - view z = _43 / (depth - _33)
+	float c_depthSigma; // Falloff as a fraction of the pixel's view depth
+	int c_factor;
+};
+
+Texture2D SceneDepths : register(t0); // Full resolution
+Texture2D ReducedDepths : register(t1);
+Texture2D ReducedSSAO : register(t2);
+
+RWTexture2D<unorm float4> SSAO : register(u0);
+
+float LinearDepth(float a_depth)
+{
+	return c_depthLinearize.y / (a_depth - c_depthLinearize.x);
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 DTid : SV_DispatchThreadID)
+{
+	if ((int)DTid.x >= c_fullDimensions.x || (int)DTid.y >= c_fullDimensions.y) return;
+
+	float centerDepth = LinearDepth(SceneDepths[DTid.xy].r);
+
+	// Position of this pixel in reduced texel space (texel centers at integers)
+	float2 reducedPos = (float2(DTid.xy) + 0.5f) / (float)c_factor - 0.5f;
+	float2 base = floor(reducedPos);
+	float2 fraction = reducedPos - base;
+
+	float total = 0.f;
+	float totalWeight = 0.f;
+	float closestDifference = 1e30f;
+	float closestAO = 1.f;
+	[unroll]
+	for (int i = 0; i < 4; i++) {
+		int2 offset = int2(i & 1, i >> 1);
+		int2 coord = clamp(int2(base) + offset, int2(0, 0), c_reducedDimensions - 1);
+
+		float ao = ReducedSSAO[coord].r;
+		float difference = abs(LinearDepth(ReducedDepths[coord].r) - centerDepth);
+		float relative = difference / (c_depthSigma * centerDepth);
+
+		float bilinear = (offset.x != 0 ? fraction.x : 1.f - fraction.x) * (offset.y != 0 ? fraction.y : 1.f - fraction.y);
+		float weight = bilinear * exp(-0.5f * relative * relative);
+		total += ao * weight;
+		totalWeight += weight;
+
+		if (difference < closestDifference) {
+			closestDifference = difference;
+			closestAO = ao;
+		}
+	}
+
+	float result = (totalWeight > 0.0001f) ? total / totalWeight : closestAO;
+	SSAO[DTid.xy] = float4(result.rrr, 1.f);
+}
@@ -21,6 +21,7 @@ cbuffer SSAOData : register(b0)
 	int c_samples; // No more than size of c_offsets
 	int2 c_windowDimensions;
 	float2 c_randomSampleScreenScale; // window dimensions / randomTexture dimensions
+	int c_sampleStart; // First offset used this frame. Temporal SSAO rotates through the kernel c_samples at a time
 };
 
 // Read-in textures from scene
@@ -119,7 +120,7 @@ void main( uint3 DTid : SV_DispatchThreadID )
 
 	float totalAO = 0.f;
 	for (int i = 0; i < c_samples; i++) {
-		float3 samplePosView = pixelPosViewSpace + mul(c_offsets[i].xyz, TBN) * c_radius; // Trying to do simple GPU random values looks quite bad
+		float3 samplePosView = pixelPosViewSpace + mul(c_offsets[(c_sampleStart + i) % 64].xyz, TBN) * c_radius; // Trying to do simple GPU random values looks quite bad
 		float2 sampleUV = UVFromViewSpacePosition(samplePosView);
 
 		float sampleDepth = SceneDepths.SampleLevel(ClampSampler, sampleUV, 0).r;
@@ -0,0 +1,91 @@
+#ifndef _SEPARABLE_BLUR_INCLUDES_
+#define _SEPARABLE_BLUR_INCLUDES_
+
+/**
+* One direction of a separable 5-tap blur, shared by SeparableBlurHorizontalCS and SeparableBlurVerticalCS.
+* Each threadgroup handles a 256 texel line segment. Every thread loads its own texel into groupshared memory
+* and the first few threads also load the apron on either side, so the 5 taps per pixel come from groupshared
+* memory instead of 5 texture reads. Two passes make 10 loads per pixel instead of the 5x5 blur's 25
+*	- BLUR_DIRECTION must be defined as int2(1, 0) or int2(0, 1) before including this file
+*	- Out-of-bounds taps are skipped and the result is normalized by the weights actually used, matching
+*	  SSAOReference::BlurSeparable in C++
+*	- With c_bilateral set, taps are also weighted by how close their view depth is to the center pixel,
+*	  so AO doesn't bleed across silhouettes
+*/
+
+#define BLUR_RADIUS 2 // 5 taps, same footprint as FiveByFiveBlurCS
+#define BLUR_GROUP_SIZE 256
+#define BLUR_CACHE_SIZE (BLUR_GROUP_SIZE + 2 * BLUR_RADIUS)
+
+cbuffer BlurData : register(b0)
+{
+	int2 c_windowDimensions;
+	float2 c_depthLinearize; // Projection _33 and _43 - view z = _43 / (depth - _33)
+	float c_depthSigma; // Bilateral falloff, as a fraction of the center pixel's view depth
+	int c_bilateral; // 0 = plain box, 1 = depth-aware
+};
+
+Texture2D BlurTarget : register(t0);
+Texture2D SceneDepths : register(t1); // Only read when c_bilateral is set
+RWTexture2D<unorm float4> BlurResult : register(u0);
+
+// Line of texels (plus apron) for this group. Depth is stored as linear view z
+groupshared float s_values[BLUR_CACHE_SIZE];
+groupshared float s_depths[BLUR_CACHE_SIZE];
+groupshared bool s_valid[BLUR_CACHE_SIZE];
+
+float LinearDepth(float a_depth)
+{
+	return c_depthLinearize.y / (a_depth - c_depthLinearize.x);
+}
+
+// Fill one cache slot from a texel coordinate, flagging coordinates outside the texture
+void CacheTexel(int a_slot, int2 a_coord)
+{
+	bool bIsValid = all(a_coord >= 0) && all(a_coord < c_windowDimensions);
+	int2 clamped = clamp(a_coord, int2(0, 0), c_windowDimensions - 1);
+
+	s_valid[a_slot] = bIsValid;
+	s_values[a_slot] = BlurTarget[clamped].r;
+	s_depths[a_slot] = (c_bilateral != 0) ? LinearDepth(SceneDepths[clamped].r) : 0.f;
+}
+
+void SeparableBlur(uint3 a_groupID, uint a_groupIndex)
+{
+	// Position along the blur line and the coordinate of this thread's texel
+	int2 lineStart = (BLUR_DIRECTION.x != 0)
+		? int2(a_groupID.x * BLUR_GROUP_SIZE, a_groupID.y)
+		: int2(a_groupID.x, a_groupID.y * BLUR_GROUP_SIZE);
+	int2 coord = lineStart + BLUR_DIRECTION * (int)a_groupIndex;
+
+	// Own texel, then the apron on both ends
+	CacheTexel(a_groupIndex + BLUR_RADIUS, coord);
+	if (a_groupIndex < 2 * BLUR_RADIUS) {
+		int apronIndex = (a_groupIndex < BLUR_RADIUS) ? (int)a_groupIndex - BLUR_RADIUS : BLUR_GROUP_SIZE + (int)a_groupIndex - BLUR_RADIUS;
+		CacheTexel(apronIndex + BLUR_RADIUS, lineStart + BLUR_DIRECTION * apronIndex);
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	if (any(coord >= c_windowDimensions)) return;
+
+	int center = a_groupIndex + BLUR_RADIUS;
+	float centerDepth = s_depths[center];
+	float total = 0.f;
+	float totalWeight = 0.f;
+	[unroll]
+	for (int i = -BLUR_RADIUS; i <= BLUR_RADIUS; i++) {
+		int slot = center + i;
+		float weight = s_valid[slot] ? 1.f : 0.f;
+		if (c_bilateral != 0) {
+			float difference = (s_depths[slot] - centerDepth) / (c_depthSigma * centerDepth);
+			weight *= exp(-0.5f * difference * difference);
+		}
+		total += s_values[slot] * weight;
+		totalWeight += weight;
+	}
+
+	float blur = total / totalWeight; // The center tap is always valid, so this is never 0
+	BlurResult[coord] = float4(blur.rrr, 1.f);
+}
+
+#endif
@@ -0,0 +1,11 @@
+/**
+* Horizontal half of the separable SSAO blur. See SeparableBlur.hlsli
+*/
+#define BLUR_DIRECTION int2(1, 0)
+#include "SeparableBlur.hlsli"
+
+[numthreads(BLUR_GROUP_SIZE, 1, 1)]
+void main(uint3 GroupID : SV_GroupID, uint GroupIndex : SV_GroupIndex)
+{
+	SeparableBlur(GroupID, GroupIndex);
+}
@@ -0,0 +1,11 @@
+/**
+* Vertical half of the separable SSAO blur. See SeparableBlur.hlsli
+*/
+#define BLUR_DIRECTION int2(0, 1)
+#include "SeparableBlur.hlsli"
+
+[numthreads(1, BLUR_GROUP_SIZE, 1)]
+void main(uint3 GroupID : SV_GroupID, uint GroupIndex : SV_GroupIndex)
+{
+	SeparableBlur(GroupID, GroupIndex);
+}
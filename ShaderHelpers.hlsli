@@ -300,4 +300,23 @@ float3 ImportanceSampleGGX(float2 Xi, float roughness, float3 N)
 	return tangentX * H.x + tangentY * H.y + N * H.z;
 }
 
+// Evaluates 9 spherical harmonic coefficients (bands 0-2) in a direction. Used for diffuse IBL, where
+// the coefficients are already convolved with the cosine lobe on the CPU (SphericalHarmonics.h), so
+// this returns linear irradiance / PI - the same value the old irradiance cubemap held
+//	- sh - RGB coefficients in xyz, ordered Y00, Y1-1, Y10, Y11, Y2-2, Y2-1, Y20, Y21, Y22
+//	- n - normalized direction
+float3 EvaluateIrradianceSH(float4 sh[9], float3 n)
+{
+	float3 result = sh[0].rgb * 0.282095f;
+	result += sh[1].rgb * (0.488603f * n.y);
+	result += sh[2].rgb * (0.488603f * n.z);
+	result += sh[3].rgb * (0.488603f * n.x);
+	result += sh[4].rgb * (1.092548f * n.x * n.y);
+	result += sh[5].rgb * (1.092548f * n.y * n.z);
+	result += sh[6].rgb * (0.315392f * (3.f * n.z * n.z - 1.f));
+	result += sh[7].rgb * (1.092548f * n.x * n.z);
+	result += sh[8].rgb * (0.546274f * (n.x * n.x - n.y * n.y));
+	return max(result, 0.f); // Ringing can dip slightly negative opposite bright lights
+}
+
 #endif
\ No newline at end of file
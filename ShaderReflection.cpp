@@ -0,0 +1,269 @@
+#include "ShaderReflection.h"
+#include "Hashing.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	// Byte offsets of each table, and the blob's size
+	struct BlobLayout {
+		uint64_t Buffers = 0;
+		uint64_t Variables = 0;
+		uint64_t Resources = 0;
+		uint64_t Inputs = 0;
+		uint64_t Names = 0;
+		uint64_t End = 0;
+	};
+
+	// 64 bit, so counts from a damaged header can't wrap
+	BlobLayout GetLayout(const ShaderReflectionHeader& a_header)
+	{
+		BlobLayout layout;
+		layout.Buffers = sizeof(ShaderReflectionHeader);
+		layout.Variables = layout.Buffers + (uint64_t)a_header.BufferCount * sizeof(ShaderReflectionBuffer);
+		layout.Resources = layout.Variables + (uint64_t)a_header.VariableCount * sizeof(ShaderReflectionVariable);
+		layout.Inputs = layout.Resources + (uint64_t)a_header.ResourceCount * sizeof(ShaderReflectionResource);
+		layout.Names = layout.Inputs + (uint64_t)a_header.InputCount * sizeof(ShaderReflectionInput);
+		layout.End = layout.Names + a_header.NamesSize;
+		return layout;
+	}
+
+	bool IsValidName(const ShaderReflectionName& a_name, const char* a_names, uint32_t a_namesSize)
+	{
+		return (uint64_t)a_name.Offset + a_name.Length < a_namesSize && a_names[a_name.Offset + a_name.Length] == '\0';
+	}
+
+	// What DataHash must be. a_data starts with a whole header
+	uint64_t HashBlob(const std::vector<uint8_t>& a_data)
+	{
+		ShaderReflectionHeader header;
+		std::memcpy(&header, a_data.data(), sizeof(header));
+		header.DataHash = 0;
+		uint64_t hash = Hashing::Value(header);
+		return Hashing::Bytes(a_data.data() + sizeof(header), a_data.size() - sizeof(header), hash);
+	}
+
+	// Appends a_name and its terminator
+	ShaderReflectionName AddName(std::string& a_names, const std::string& a_name)
+	{
+		ShaderReflectionName name;
+		name.Offset = (uint32_t)a_names.size();
+		name.Length = (uint32_t)a_name.size();
+		a_names.append(a_name);
+		a_names.push_back('\0');
+		return name;
+	}
+}
+
+std::filesystem::path ShaderReflection::GetFileName(const std::filesystem::path& a_shaderFile)
+{
+	std::filesystem::path fileName(a_shaderFile);
+	return fileName.replace_extension(SHADER_REFLECTION_EXTENSION);
+}
+
+uint64_t ShaderReflection::HashBytecode(const void* a_bytecode, size_t a_size)
+{
+	return Hashing::Bytes(a_bytecode, a_size);
+}
+
+void ShaderReflection::Begin(uint64_t a_bytecodeHash)
+{
+	m_building = ShaderReflectionHeader();
+	m_building.BytecodeHash = a_bytecodeHash;
+	m_newBuffers.clear();
+	m_newVariables.clear();
+	m_newResources.clear();
+	m_newInputs.clear();
+	m_newNames.clear();
+}
+
+void ShaderReflection::AddBuffer(const std::string& a_name, uint32_t a_type, uint32_t a_size, uint32_t a_bindIndex)
+{
+	ShaderReflectionBuffer buffer;
+	buffer.Name = AddName(m_newNames, a_name);
+	buffer.Type = a_type;
+	buffer.Size = a_size;
+	buffer.BindIndex = a_bindIndex;
+	buffer.FirstVariable = (uint32_t)m_newVariables.size();
+	m_newBuffers.push_back(buffer);
+}
+
+void ShaderReflection::AddVariable(const std::string& a_name, uint32_t a_byteOffset, uint32_t a_size)
+{
+	if (m_newBuffers.empty())
+		return;
+	ShaderReflectionVariable variable;
+	variable.Name = AddName(m_newNames, a_name);
+	variable.ByteOffset = a_byteOffset;
+	variable.Size = a_size;
+	variable.BufferIndex = (uint32_t)m_newBuffers.size() - 1;
+	m_newVariables.push_back(variable);
+	m_newBuffers.back().VariableCount++;
+}
+
+void ShaderReflection::AddResource(const std::string& a_name, ShaderResourceKind a_kind, uint32_t a_bindIndex)
+{
+	ShaderReflectionResource resource;
+	resource.Name = AddName(m_newNames, a_name);
+	resource.Kind = a_kind;
+	resource.BindIndex = a_bindIndex;
+	m_newResources.push_back(resource);
+}
+
+void ShaderReflection::AddInput(const std::string& a_semanticName, uint32_t a_semanticIndex, uint32_t a_componentType, uint32_t a_mask)
+{
+	ShaderReflectionInput input;
+	input.SemanticName = AddName(m_newNames, a_semanticName);
+	input.SemanticIndex = a_semanticIndex;
+	input.ComponentType = a_componentType;
+	input.Mask = a_mask;
+	m_newInputs.push_back(input);
+}
+
+void ShaderReflection::SetThreadGroupSize(uint32_t a_x, uint32_t a_y, uint32_t a_z)
+{
+	m_building.ThreadGroupSize[0] = a_x;
+	m_building.ThreadGroupSize[1] = a_y;
+	m_building.ThreadGroupSize[2] = a_z;
+}
+
+void ShaderReflection::End()
+{
+	m_building.BufferCount = (uint32_t)m_newBuffers.size();
+	m_building.VariableCount = (uint32_t)m_newVariables.size();
+	m_building.ResourceCount = (uint32_t)m_newResources.size();
+	m_building.InputCount = (uint32_t)m_newInputs.size();
+	m_building.NamesSize = (uint32_t)m_newNames.size();
+	BlobLayout layout = GetLayout(m_building);
+
+	m_data.assign((size_t)layout.End, 0);
+	if (!m_newBuffers.empty())
+		std::memcpy(m_data.data() + layout.Buffers, m_newBuffers.data(), m_newBuffers.size() * sizeof(ShaderReflectionBuffer));
+	if (!m_newVariables.empty())
+		std::memcpy(m_data.data() + layout.Variables, m_newVariables.data(), m_newVariables.size() * sizeof(ShaderReflectionVariable));
+	if (!m_newResources.empty())
+		std::memcpy(m_data.data() + layout.Resources, m_newResources.data(), m_newResources.size() * sizeof(ShaderReflectionResource));
+	if (!m_newInputs.empty())
+		std::memcpy(m_data.data() + layout.Inputs, m_newInputs.data(), m_newInputs.size() * sizeof(ShaderReflectionInput));
+	if (!m_newNames.empty())
+		std::memcpy(m_data.data() + layout.Names, m_newNames.data(), m_newNames.size());
+	std::memcpy(m_data.data(), &m_building, sizeof(ShaderReflectionHeader));
+	m_building.DataHash = HashBlob(m_data);
+	std::memcpy(m_data.data(), &m_building, sizeof(ShaderReflectionHeader));
+	Attach();
+	Begin(0);
+}
+
+//-------------------------------------------------------
+// Everything a reader indexes with is checked here, so
+// the getters can trust the tables: every name is in
+// range and terminated, and every variable lies inside
+// its buffer
+//-------------------------------------------------------
+bool ShaderReflection::SetData(std::vector<uint8_t> a_data, uint64_t a_bytecodeHash)
+{
+	if (a_data.size() < sizeof(ShaderReflectionHeader))
+		return false;
+	ShaderReflectionHeader header;
+	std::memcpy(&header, a_data.data(), sizeof(header));
+	BlobLayout layout = GetLayout(header);
+	if (header.Magic != SHADER_REFLECTION_MAGIC || header.Version != SHADER_REFLECTION_VERSION || header.BytecodeHash != a_bytecodeHash ||
+		layout.End != a_data.size())
+		return false;
+	if (header.DataHash != HashBlob(a_data))
+		return false;
+
+	const ShaderReflectionBuffer* buffers = reinterpret_cast<const ShaderReflectionBuffer*>(a_data.data() + layout.Buffers);
+	const ShaderReflectionVariable* variables = reinterpret_cast<const ShaderReflectionVariable*>(a_data.data() + layout.Variables);
+	const ShaderReflectionResource* resources = reinterpret_cast<const ShaderReflectionResource*>(a_data.data() + layout.Resources);
+	const ShaderReflectionInput* inputs = reinterpret_cast<const ShaderReflectionInput*>(a_data.data() + layout.Inputs);
+	const char* names = reinterpret_cast<const char*>(a_data.data() + layout.Names);
+	for (uint32_t i = 0; i < header.BufferCount; i++) {
+		if (!IsValidName(buffers[i].Name, names, header.NamesSize) ||
+			(uint64_t)buffers[i].FirstVariable + buffers[i].VariableCount > header.VariableCount)
+			return false;
+	}
+	for (uint32_t i = 0; i < header.VariableCount; i++) {
+		if (!IsValidName(variables[i].Name, names, header.NamesSize) || variables[i].BufferIndex >= header.BufferCount ||
+			(uint64_t)variables[i].ByteOffset + variables[i].Size > buffers[variables[i].BufferIndex].Size)
+			return false;
+	}
+	for (uint32_t i = 0; i < header.ResourceCount; i++) {
+		if (!IsValidName(resources[i].Name, names, header.NamesSize) || resources[i].Kind > ShaderResourceKind::Other)
+			return false;
+	}
+	for (uint32_t i = 0; i < header.InputCount; i++) {
+		if (!IsValidName(inputs[i].SemanticName, names, header.NamesSize))
+			return false;
+	}
+
+	m_data = std::move(a_data);
+	Attach();
+	return true;
+}
+
+bool ShaderReflection::Load(const std::filesystem::path& a_fileName, uint64_t a_bytecodeHash)
+{
+	std::ifstream file(a_fileName, std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+	std::vector<uint8_t> data((size_t)file.tellg());
+	file.seekg(0);
+	if (!file.read(reinterpret_cast<char*>(data.data()), (std::streamsize)data.size()))
+		return false;
+	return SetData(std::move(data), a_bytecodeHash);
+}
+
+bool ShaderReflection::Save(const std::filesystem::path& a_fileName) const
+{
+	if (!IsValid())
+		return false;
+	std::filesystem::path temporaryPath = a_fileName;
+	temporaryPath += ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return false;
+		file.write(reinterpret_cast<const char*>(m_data.data()), (std::streamsize)m_data.size());
+		if (!file)
+			return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, a_fileName, error);
+	if (error) {
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	return true;
+}
+
+int ShaderReflection::FindBuffer(const std::string& a_name) const
+{
+	for (unsigned int i = 0; i < GetBufferCount(); i++) {
+		if (a_name == GetName(m_buffers[i].Name))
+			return (int)i;
+	}
+	return -1;
+}
+
+int ShaderReflection::FindVariable(const std::string& a_name) const
+{
+	for (unsigned int i = 0; i < GetVariableCount(); i++) {
+		if (a_name == GetName(m_variables[i].Name))
+			return (int)i;
+	}
+	return -1;
+}
+
+void ShaderReflection::Attach()
+{
+	m_header = reinterpret_cast<const ShaderReflectionHeader*>(m_data.data());
+	BlobLayout layout = GetLayout(*m_header);
+	m_buffers = reinterpret_cast<const ShaderReflectionBuffer*>(m_data.data() + layout.Buffers);
+	m_variables = reinterpret_cast<const ShaderReflectionVariable*>(m_data.data() + layout.Variables);
+	m_resources = reinterpret_cast<const ShaderReflectionResource*>(m_data.data() + layout.Resources);
+	m_inputs = reinterpret_cast<const ShaderReflectionInput*>(m_data.data() + layout.Inputs);
+	m_names = reinterpret_cast<const char*>(m_data.data() + layout.Names);
+}
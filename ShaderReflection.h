@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#define SHADER_REFLECTION_MAGIC 0x4C464552 // "REFL"
+#define SHADER_REFLECTION_VERSION 1
+#define SHADER_REFLECTION_EXTENSION ".refl" // Written beside the .cso it describes
+
+// Start of the blob. The record tables follow in this order, then the names
+struct ShaderReflectionHeader {
+	uint32_t Magic = SHADER_REFLECTION_MAGIC;
+	uint32_t Version = SHADER_REFLECTION_VERSION;
+	uint64_t BytecodeHash = 0; // FNV-1a of the .cso, so a recompiled shader never picks up a stale blob
+	uint64_t DataHash = 0; // Of the whole blob, with this field zeroed
+	uint32_t BufferCount = 0;
+	uint32_t VariableCount = 0;
+	uint32_t ResourceCount = 0;
+	uint32_t InputCount = 0;
+	uint32_t NamesSize = 0;
+	uint32_t ThreadGroupSize[3] = {}; // Compute shaders only
+	uint32_t Reserved[2] = {};
+};
+
+// What a bound resource is, as SimpleShader groups them
+enum class ShaderResourceKind : uint8_t {
+	Texture, // Textures and structured buffers
+	Sampler,
+	UnorderedAccess, // Any UAV type
+	Other // Constant buffers and anything else, which have their own table
+};
+
+// A name in the names block. Always followed by a terminator, so it can be used as a C string in place
+struct ShaderReflectionName {
+	uint32_t Offset = 0;
+	uint32_t Length = 0;
+};
+
+// One constant buffer. Its variables are VariableCount records from FirstVariable
+struct ShaderReflectionBuffer {
+	ShaderReflectionName Name;
+	uint32_t Type = 0; // D3D_CBUFFER_TYPE
+	uint32_t Size = 0; // In bytes, as declared (not rounded up to 16)
+	uint32_t BindIndex = 0; // Register
+	uint32_t FirstVariable = 0;
+	uint32_t VariableCount = 0;
+};
+
+struct ShaderReflectionVariable {
+	ShaderReflectionName Name;
+	uint32_t ByteOffset = 0; // From the start of its buffer
+	uint32_t Size = 0;
+	uint32_t BufferIndex = 0;
+};
+
+// One bound resource, in D3D's binding order
+struct ShaderReflectionResource {
+	ShaderReflectionName Name;
+	ShaderResourceKind Kind = ShaderResourceKind::Other;
+	uint8_t Padding[3] = {};
+	uint32_t BindIndex = 0; // Register
+};
+
+// One vertex shader input, enough to build the input layout SimpleVertexShader derives from reflection
+struct ShaderReflectionInput {
+	ShaderReflectionName SemanticName;
+	uint32_t SemanticIndex = 0;
+	uint32_t ComponentType = 0; // D3D_REGISTER_COMPONENT_TYPE
+	uint32_t Mask = 0; // Components used, one bit each
+};
+
+static_assert(sizeof(ShaderReflectionHeader) == 64, "The header is written as-is");
+static_assert(sizeof(ShaderReflectionBuffer) == 28 && sizeof(ShaderReflectionVariable) == 20 &&
+	sizeof(ShaderReflectionResource) == 16 && sizeof(ShaderReflectionInput) == 20, "Records are written as-is");
+
+//-------------------------------------------------------
+// A shader's reflection (constant buffer layouts, bound
+// resource slots and vertex inputs) as one compact blob,
+// so SimpleShader can skip D3DReflect on later launches
+//	- The blob is the header, fixed size record tables
+//	  and the names, read in place with nothing to parse.
+//	  Loading is a file read, a size check per table and
+//	  two hashes
+//	- It's tied to the bytecode by hash, so a recompiled
+//	  shader misses and is reflected again
+//	- Portable, so the headless tools can read layouts
+//	  written by the game on Windows.
+//	  ShaderReflectionD3D11 fills one from D3DReflect
+//-------------------------------------------------------
+class ShaderReflection
+{
+public:
+	ShaderReflection() = default;
+	ShaderReflection(const ShaderReflection&) = delete; // The tables point into m_data
+	ShaderReflection& operator=(const ShaderReflection&) = delete;
+
+	// a_shaderFile with SHADER_REFLECTION_EXTENSION in place of its own
+	static std::filesystem::path GetFileName(const std::filesystem::path& a_shaderFile);
+
+	// What a blob's BytecodeHash must match
+	static uint64_t HashBytecode(const void* a_bytecode, size_t a_size);
+
+	// Building. Begin clears everything, variables go to the last buffer added, and End lays out the blob
+	void Begin(uint64_t a_bytecodeHash);
+	void AddBuffer(const std::string& a_name, uint32_t a_type, uint32_t a_size, uint32_t a_bindIndex);
+	void AddVariable(const std::string& a_name, uint32_t a_byteOffset, uint32_t a_size);
+	void AddResource(const std::string& a_name, ShaderResourceKind a_kind, uint32_t a_bindIndex);
+	void AddInput(const std::string& a_semanticName, uint32_t a_semanticIndex, uint32_t a_componentType, uint32_t a_mask);
+	void SetThreadGroupSize(uint32_t a_x, uint32_t a_y, uint32_t a_z);
+	void End();
+
+	// Take a blob, checking its structure and that it was written for a_bytecodeHash. Fails without changing anything
+	bool SetData(std::vector<uint8_t> a_data, uint64_t a_bytecodeHash);
+
+	bool Load(const std::filesystem::path& a_fileName, uint64_t a_bytecodeHash);
+	bool Save(const std::filesystem::path& a_fileName) const; // Through a temporary file, so readers never see half a blob
+
+	// Getters. Only valid after End or a successful SetData/Load
+	bool IsValid() const { return m_header != nullptr; }
+	const std::vector<uint8_t>& GetData() const { return m_data; }
+	const ShaderReflectionHeader& GetHeader() const { return *m_header; }
+	unsigned int GetBufferCount() const { return m_header ? m_header->BufferCount : 0; }
+	unsigned int GetVariableCount() const { return m_header ? m_header->VariableCount : 0; }
+	unsigned int GetResourceCount() const { return m_header ? m_header->ResourceCount : 0; }
+	unsigned int GetInputCount() const { return m_header ? m_header->InputCount : 0; }
+	const ShaderReflectionBuffer& GetBuffer(unsigned int a_index) const { return m_buffers[a_index]; }
+	const ShaderReflectionVariable& GetVariable(unsigned int a_index) const { return m_variables[a_index]; }
+	const ShaderReflectionResource& GetResource(unsigned int a_index) const { return m_resources[a_index]; }
+	const ShaderReflectionInput& GetInput(unsigned int a_index) const { return m_inputs[a_index]; }
+	const char* GetName(const ShaderReflectionName& a_name) const { return m_names + a_name.Offset; }
+
+	// Index of the buffer or variable named a_name, or -1
+	int FindBuffer(const std::string& a_name) const;
+	int FindVariable(const std::string& a_name) const;
+
+private:
+	void Attach(); // Point the tables into m_data, once it's been checked
+
+	std::vector<uint8_t> m_data;
+	const ShaderReflectionHeader* m_header = nullptr;
+	const ShaderReflectionBuffer* m_buffers = nullptr;
+	const ShaderReflectionVariable* m_variables = nullptr;
+	const ShaderReflectionResource* m_resources = nullptr;
+	const ShaderReflectionInput* m_inputs = nullptr;
+	const char* m_names = nullptr;
+
+	// Between Begin and End
+	ShaderReflectionHeader m_building;
+	std::vector<ShaderReflectionBuffer> m_newBuffers;
+	std::vector<ShaderReflectionVariable> m_newVariables;
+	std::vector<ShaderReflectionResource> m_newResources;
+	std::vector<ShaderReflectionInput> m_newInputs;
+	std::string m_newNames;
+};
@@ -0,0 +1,75 @@
+#include "ShaderReflectionD3D11.h"
+
+#include <d3d11.h>
+#include <d3dcompiler.h>
+#include <wrl/client.h> // Used for ComPtr - a smart pointer for COM objects
+
+//-------------------------------------------------------
+// Records everything ISimpleShader and its derived
+// classes used to reflect on every load: resources in
+// binding order, each constant buffer with its register
+// and variables, vertex inputs and the thread group size
+//-------------------------------------------------------
+bool ShaderReflectionD3D11::Reflect(const void* a_bytecode, size_t a_size, ShaderReflection& a_reflection)
+{
+	Microsoft::WRL::ComPtr<ID3D11ShaderReflection> reflection;
+	if (FAILED(D3DReflect(a_bytecode, a_size, IID_ID3D11ShaderReflection, (void**)reflection.GetAddressOf())))
+		return false;
+	D3D11_SHADER_DESC shaderDesc;
+	if (FAILED(reflection->GetDesc(&shaderDesc)))
+		return false;
+
+	a_reflection.Begin(ShaderReflection::HashBytecode(a_bytecode, a_size));
+	for (UINT r = 0; r < shaderDesc.BoundResources; r++) {
+		D3D11_SHADER_INPUT_BIND_DESC resourceDesc;
+		reflection->GetResourceBindingDesc(r, &resourceDesc);
+		ShaderResourceKind kind = ShaderResourceKind::Other;
+		switch (resourceDesc.Type) {
+		case D3D_SIT_STRUCTURED: // SimpleShader treats structured buffers as textures
+		case D3D_SIT_TEXTURE:
+			kind = ShaderResourceKind::Texture;
+			break;
+		case D3D_SIT_SAMPLER:
+			kind = ShaderResourceKind::Sampler;
+			break;
+		case D3D_SIT_UAV_APPEND_STRUCTURED:
+		case D3D_SIT_UAV_CONSUME_STRUCTURED:
+		case D3D_SIT_UAV_RWBYTEADDRESS:
+		case D3D_SIT_UAV_RWSTRUCTURED:
+		case D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER:
+		case D3D_SIT_UAV_RWTYPED:
+			kind = ShaderResourceKind::UnorderedAccess;
+			break;
+		default:
+			break;
+		}
+		a_reflection.AddResource(resourceDesc.Name, kind, resourceDesc.BindPoint);
+	}
+
+	for (UINT b = 0; b < shaderDesc.ConstantBuffers; b++) {
+		ID3D11ShaderReflectionConstantBuffer* buffer = reflection->GetConstantBufferByIndex(b);
+		D3D11_SHADER_BUFFER_DESC bufferDesc;
+		buffer->GetDesc(&bufferDesc);
+		D3D11_SHADER_INPUT_BIND_DESC bindDesc = {};
+		reflection->GetResourceBindingDescByName(bufferDesc.Name, &bindDesc);
+		a_reflection.AddBuffer(bufferDesc.Name, (uint32_t)bufferDesc.Type, bufferDesc.Size, bindDesc.BindPoint);
+
+		for (UINT v = 0; v < bufferDesc.Variables; v++) {
+			D3D11_SHADER_VARIABLE_DESC variableDesc;
+			buffer->GetVariableByIndex(v)->GetDesc(&variableDesc);
+			a_reflection.AddVariable(variableDesc.Name, variableDesc.StartOffset, variableDesc.Size);
+		}
+	}
+
+	for (UINT i = 0; i < shaderDesc.InputParameters; i++) {
+		D3D11_SIGNATURE_PARAMETER_DESC parameterDesc;
+		reflection->GetInputParameterDesc(i, &parameterDesc);
+		a_reflection.AddInput(parameterDesc.SemanticName, parameterDesc.SemanticIndex, (uint32_t)parameterDesc.ComponentType, parameterDesc.Mask);
+	}
+
+	UINT threadsX = 0, threadsY = 0, threadsZ = 0;
+	reflection->GetThreadGroupSize(&threadsX, &threadsY, &threadsZ);
+	a_reflection.SetThreadGroupSize(threadsX, threadsY, threadsZ);
+	a_reflection.End();
+	return true;
+}
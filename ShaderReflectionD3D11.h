@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+#include "ShaderReflection.h"
+
+//-------------------------------------------------------
+// Fills a ShaderReflection from D3DReflect
+//	- Kept apart from ShaderReflection so the blob itself
+//	  stays portable (and usable by the headless tool)
+//-------------------------------------------------------
+namespace ShaderReflectionD3D11
+{
+	// Reflect a_bytecode into a_reflection, keyed to its hash. False if the bytecode can't be reflected
+	bool Reflect(const void* a_bytecode, size_t a_size, ShaderReflection& a_reflection);
+}
@@ -1,4 +1,37 @@
 #include "Sky.h"
+#include "DDSTextureLoader.h"
+#include "IBLCacheD3D11.h"
+#include "Hashing.h"
+#include "AssetFiles.h"
+#include "BlockCompression.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	// The block format BlockCompression decodes a_format with, or RGBA8 for formats that aren't block compressed
+	TextureFormat GetBlockFormat(DXGI_FORMAT a_format)
+	{
+		switch (a_format) {
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB: return TextureFormat::BC1;
+		case DXGI_FORMAT_BC4_UNORM: return TextureFormat::BC4;
+		case DXGI_FORMAT_BC5_UNORM: return TextureFormat::BC5;
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB: return TextureFormat::BC7;
+		default: return TextureFormat::RGBA8;
+		}
+	}
+
+	// Format of a render target made to match a sky of a_format. Block compressed formats can't be rendered to
+	DXGI_FORMAT GetRenderTargetFormat(DXGI_FORMAT a_format)
+	{
+		if (a_format == DXGI_FORMAT_BC1_UNORM_SRGB || a_format == DXGI_FORMAT_BC7_UNORM_SRGB)
+			return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+		return GetBlockFormat(a_format) == TextureFormat::RGBA8 ? a_format : DXGI_FORMAT_R8G8B8A8_UNORM;
+	}
+}
 
 //-------------------------------------------------------
 // Construct a Sky with passed in assets. Sky is not
@@ -66,24 +99,59 @@ void Sky::Draw(Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, std::sh
 	a_d3dContext->OMSetDepthStencilState(nullptr, 0);
 }
 
+//-------------------------------------------------------
+// Projects the Sky Cube into spherical harmonics for
+// diffuse IBL, replacing the irradiance cubemap
+//	- Reads the sky back to the CPU and integrates it on
+//	  the JobSystem, which takes milliseconds instead of
+//	  the brute-force GPU pass
+//	- Block compressed skies are decoded on the CPU. Only
+//	  formats ReadBackCube can't read at all fall back
+//	  to CreateEnvironmentMap, and the resulting
+//	  irradiance cube is projected without convolution
+//-------------------------------------------------------
+void Sky::CreateIrradianceSH(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, std::shared_ptr<SimpleVertexShader> a_irradianceVS, std::shared_ptr<SimplePixelShader> a_irradiancePS)
+{
+	CubemapImage image;
+	if (ReadBackCube(a_device, a_context, m_cubeMap, image)) {
+		SphericalHarmonics::ProjectCubemap(image, m_irradianceSH, true, true);
+		SphericalHarmonics::ConvolveIrradiance(m_irradianceSH);
+		return;
+	}
+
+	CreateEnvironmentMap(a_device, a_context, a_irradianceVS, a_irradiancePS);
+	if (m_envMap && ReadBackCube(a_device, a_context, m_envMap, image))
+		SphericalHarmonics::ProjectCubemap(image, m_irradianceSH, true, true);
+	else
+		m_irradianceSH = SH9Color(); // No IBL diffuse rather than garbage
+}
+
 //-------------------------------------------------------
 // Creates a texture cube resource and dispatches Draw Calls
 // to generate an Irradiance Map from the Sky Cube
+//	- Brute-force fallback for CreateIrradianceSH
+//	- Leaves m_envMap empty if the cube can't be created
 //-------------------------------------------------------
 void Sky::CreateEnvironmentMap(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, std::shared_ptr<SimpleVertexShader> a_irradianceVS, std::shared_ptr<SimplePixelShader> a_irradiancePS)
 {
+	if (!m_cubeMap)
+		return;
+
 	// Create Texture Cube Resources. Copy directly from Sky Cube (since it is an irradiance map for that)
 	D3D11_SHADER_RESOURCE_VIEW_DESC skyCubeDesc = GetCubeSRVDescription();
 	D3D11_TEXTURE2D_DESC skyTextureDesc = GetTextureCubeDescription();
 
 	// Adjust Texture Settings
-	skyTextureDesc.Width /= 16;  // Width and height can be massively reduced, because there is very little detail in the 
-	skyTextureDesc.Height /= 16; // irradiance map. Assuming a minimum Skybox dimension of 1024x1024, the result will be 64x64
+	skyTextureDesc.Width /= SKY_IRRADIANCE_SIZE_DIVISOR;  // Width and height can be massively reduced, because there is very little detail in the 
+	skyTextureDesc.Height /= SKY_IRRADIANCE_SIZE_DIVISOR; // irradiance map. Assuming a minimum Skybox dimension of 1024x1024, the result will be 64x64
 	skyTextureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	skyTextureDesc.Format = GetRenderTargetFormat(skyTextureDesc.Format);
+	skyCubeDesc.Format = skyTextureDesc.Format;
 
 	// Create Irradiance Cube
 	Microsoft::WRL::ComPtr<ID3D11Texture2D> irrMap;
-	a_device->CreateTexture2D(&skyTextureDesc, nullptr, irrMap.GetAddressOf());
+	if (FAILED(a_device->CreateTexture2D(&skyTextureDesc, nullptr, irrMap.GetAddressOf())))
+		return;
 
 	// Save back buffer Render Target and Viewport so that it can be replaced after Textures are drawn
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> backBufferRTV;
@@ -123,7 +191,7 @@ void Sky::CreateEnvironmentMap(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Mi
 		a_context->OMSetRenderTargets(1, faceRTV.GetAddressOf(), nullptr);
 
 		// Set shaders and data
-		float phiStep = 0.05f /*0.025f*/, thetaStep = 0.05f /*0.025f*/; // Adjust for hardware, or alternatively adjust dimensions
+		float phiStep = SKY_IRRADIANCE_PHI_STEP, thetaStep = SKY_IRRADIANCE_THETA_STEP; // Adjust for hardware, or alternatively adjust dimensions
 		a_irradianceVS->SetShader();
 		a_irradiancePS->SetShader();
 		a_irradiancePS->SetShaderResourceView("EnvMap", m_cubeMap); // Environment is this Sky
@@ -144,6 +212,31 @@ void Sky::CreateEnvironmentMap(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Mi
 	a_context->RSSetViewports(1, &cachedViewport);
 }
 
+//-------------------------------------------------------
+// Loads a prefiltered reflectance map baked offline
+// (headless "ibl-bake"), skipping the GPU prefilter
+//	- Read through AssetFiles, like the IBL cache key
+//	  hashes it, so both see the archived copy when an
+//	  archive is mounted and the loose file otherwise
+//	- Returns false if the file is missing or unreadable,
+//	  in which case CreateSpecularReflectanceMap should be
+//	  used instead
+//-------------------------------------------------------
+bool Sky::LoadSpecularReflectanceMap(Microsoft::WRL::ComPtr<ID3D11Device> a_device, const std::wstring& a_fileName)
+{
+	AssetFileView view;
+	if (!AssetFiles::Read(a_fileName, view))
+		return false;
+
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> specMap;
+	HRESULT result = DirectX::CreateDDSTextureFromMemory(a_device.Get(), view.Data, view.Size, nullptr, specMap.GetAddressOf());
+	if (FAILED(result))
+		return false;
+
+	m_specMap = specMap;
+	return true;
+}
+
 //-------------------------------------------------------
 // Creates a texture cube resource and dispatches Draw Calls
 // to prefilter the Sky into a reflectance map for multiple
@@ -156,20 +249,23 @@ void Sky::CreateSpecularReflectanceMap(Microsoft::WRL::ComPtr<ID3D11Device> a_de
 	D3D11_TEXTURE2D_DESC skyTextureDesc = GetTextureCubeDescription();
 
 	// Adjust texture settings. Must add Mip Levels
-	int ignoredSmallMips = 2; // ignore mips 2x2 and 4x4 (1x1 is so useless as to not even be relevant) 
-	skyTextureDesc.Width /= 8;  // Width and height can be massively reduced, because there is very little detail in the 
-	skyTextureDesc.Height /= 8; // irradiance map. Assuming a minimum Skybox dimension of 1024x1024, the result will be 128x128
+	int ignoredSmallMips = SKY_SPECULAR_IGNORED_MIPS; // ignore mips 2x2 and 4x4 (1x1 is so useless as to not even be relevant) 
+	skyTextureDesc.Width /= SKY_SPECULAR_SIZE_DIVISOR;  // Width and height can be massively reduced, because there is very little detail in the 
+	skyTextureDesc.Height /= SKY_SPECULAR_SIZE_DIVISOR; // irradiance map. Assuming a minimum Skybox dimension of 1024x1024, the result will be 128x128
 	skyTextureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	skyTextureDesc.Format = GetRenderTargetFormat(skyTextureDesc.Format); // Block compressed skies are prefiltered into RGBA8
 	// MipLevels is the power of 2 of the size (this ignores 0-indexing, which is just the 1x1 level, which is unnecessary)
 	skyTextureDesc.MipLevels = max((int)(log2(skyTextureDesc.Width) - ignoredSmallMips), 1); // Subtract ignored Mip levels from the total count
 
 	// Adjust SRV for the new CubeMap to account for multiple Mips
 	skyCubeDesc.TextureCube.MipLevels = skyTextureDesc.MipLevels; // Match the Texture Mips
 	skyCubeDesc.TextureCube.MostDetailedMip = 0; // Highest mip = most detailed
+	skyCubeDesc.Format = skyTextureDesc.Format;
 
 	// Create Reflection Map
 	Microsoft::WRL::ComPtr<ID3D11Texture2D> refMap;
-	a_device->CreateTexture2D(&skyTextureDesc, nullptr, refMap.GetAddressOf());
+	if (FAILED(a_device->CreateTexture2D(&skyTextureDesc, nullptr, refMap.GetAddressOf())))
+		return;
 
 	// Create viewport for rasterizing
 	D3D11_VIEWPORT textureViewport = {};
@@ -237,6 +333,90 @@ void Sky::CreateSpecularReflectanceMap(Microsoft::WRL::ComPtr<ID3D11Device> a_de
 	a_context->RSSetViewports(1, &cachedViewport);
 }
 
+//-------------------------------------------------------
+// Builds the IBL cache key for this Sky
+//	- Hashes the raw bytes of the top mip of every face,
+//	  the generation parameters, and the contents of each
+//	  file in a_dependencies (the IBL shaders, an offline
+//	  bake...) so editing any of them misses the cache
+//	- Dependencies are read through AssetFiles, as
+//	  LoadSpecularReflectanceMap reads the offline bake,
+//	  so the key covers the same bytes the Sky loads
+//	- a_bIsCacheable is false when the sky can't be read
+//	  back, in which case the key is meaningless
+//-------------------------------------------------------
+uint64_t Sky::ComputeIBLCacheKey(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, const std::vector<std::string>& a_dependencies, bool& a_bIsCacheable)
+{
+	IBLCacheTexture source;
+	a_bIsCacheable = IBLCacheD3D11::ReadBackTexture(a_device, a_context, m_cubeMap, source, 1);
+	if (!a_bIsCacheable)
+		return 0;
+
+	uint64_t key = Hashing::String("sky");
+	key = Hashing::Value(source.Format, key);
+	key = Hashing::Value(source.Width, key);
+	key = Hashing::Value(source.Height, key);
+	key = Hashing::Value(source.ArraySize, key);
+	key = Hashing::Bytes(source.Data.data(), source.Data.size(), key);
+
+	key = Hashing::Value(GetTextureCubeDescription().MipLevels, key); // Picks the SH readback mip
+	key = Hashing::Value(SKY_SH_READBACK_SIZE, key);
+	key = Hashing::Value(SKY_IRRADIANCE_SIZE_DIVISOR, key);
+	key = Hashing::Value(SKY_IRRADIANCE_PHI_STEP, key);
+	key = Hashing::Value(SKY_IRRADIANCE_THETA_STEP, key);
+	key = Hashing::Value(SKY_SPECULAR_SIZE_DIVISOR, key);
+	key = Hashing::Value(SKY_SPECULAR_IGNORED_MIPS, key);
+
+	for (const std::string& dependency : a_dependencies) {
+		AssetFileView view;
+		bool bFound = AssetFiles::Read(dependency, view);
+		key = Hashing::String(dependency, key);
+		if (bFound)
+			key = Hashing::Bytes(view.Data, view.Size, key);
+		key = Hashing::Value(bFound, key); // A file appearing or disappearing changes the key too
+	}
+	return key;
+}
+
+//-------------------------------------------------------
+// Restores the irradiance SH and reflectance map from a
+// cache file written by SaveIBLCache
+//	- Returns false on a missing, stale or corrupt file,
+//	  leaving the Sky untouched so it can be regenerated
+//-------------------------------------------------------
+bool Sky::LoadIBLCache(Microsoft::WRL::ComPtr<ID3D11Device> a_device, const std::string& a_fileName, uint64_t a_key)
+{
+	IBLCacheEntry entry;
+	if (!IBLCache::Load(a_fileName, a_key, entry))
+		return false;
+	if (!entry.bHasIrradianceSH || entry.Textures.size() != 1 || !entry.Textures[0].bIsCube)
+		return false;
+
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> specMap;
+	if (!IBLCacheD3D11::CreateShaderResourceView(a_device, entry.Textures[0], specMap))
+		return false;
+
+	m_irradianceSH = entry.IrradianceSH;
+	m_specMap = specMap;
+	return true;
+}
+
+//-------------------------------------------------------
+// Writes the current irradiance SH and reflectance map to
+// a cache file, after they have been created
+//-------------------------------------------------------
+bool Sky::SaveIBLCache(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, const std::string& a_fileName, uint64_t a_key)
+{
+	IBLCacheEntry entry;
+	entry.Key = a_key;
+	entry.bHasIrradianceSH = true;
+	entry.IrradianceSH = m_irradianceSH;
+	entry.Textures.resize(1);
+	if (!IBLCacheD3D11::ReadBackTexture(a_device, a_context, m_specMap, entry.Textures[0]))
+		return false;
+	return IBLCache::Save(a_fileName, entry);
+}
+
 //-------------------------------------------------------
 // Sets the Texture Sampler State used by the Sky
 //-------------------------------------------------------
@@ -365,6 +545,14 @@ Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> Sky::GetReflectanceMap()
 	return m_specMap;
 }
 
+//-------------------------------------------------------
+// Retrieves the Sky's diffuse irradiance coefficients
+//-------------------------------------------------------
+const SH9Color& Sky::GetIrradianceSH() const
+{
+	return m_irradianceSH;
+}
+
 //-------------------------------------------------------
 // Retrieves the Texture Description of the Sky Texture Cube
 //-------------------------------------------------------
@@ -389,3 +577,109 @@ D3D11_SHADER_RESOURCE_VIEW_DESC Sky::GetCubeSRVDescription()
 	m_cubeMap->GetDesc(&srvDesc);
 	return srvDesc;
 }
+
+//-------------------------------------------------------
+// Copies all 6 faces of a cube to the CPU as linear
+// radiance, the way IBLIrradianceMapPS sampled them
+// (pow 2.2 on whatever the texture returns)
+//	- Uses the largest mip no bigger than
+//	  SKY_SH_READBACK_SIZE when the cube has mips
+//	- RGBA8 / BGRA8 / RGBA32F are read as they are, and
+//	  BC1 / BC4 / BC5 / BC7 are decoded with
+//	  BlockCompression. Anything else, or no cube at all,
+//	  returns false
+//-------------------------------------------------------
+bool Sky::ReadBackCube(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_cube, CubemapImage& a_image)
+{
+	if (!a_cube)
+		return false;
+	Microsoft::WRL::ComPtr<ID3D11Resource> resource;
+	a_cube->GetResource(resource.GetAddressOf());
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+	if (FAILED(resource.As(&texture)))
+		return false;
+
+	D3D11_TEXTURE2D_DESC desc = {};
+	texture->GetDesc(&desc);
+	bool bIsFloat = desc.Format == DXGI_FORMAT_R32G32B32A32_FLOAT;
+	bool bIsBGRA = desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM;
+	TextureFormat blockFormat = GetBlockFormat(desc.Format);
+	bool bIsBlock = blockFormat != TextureFormat::RGBA8;
+	if (!bIsFloat && !bIsBGRA && !bIsBlock && desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM)
+		return false;
+	if (desc.ArraySize < 6)
+		return false;
+
+	UINT mip = 0;
+	while (mip + 1 < desc.MipLevels && (desc.Width >> mip) > SKY_SH_READBACK_SIZE) {
+		mip++;
+	}
+	UINT sourceMips = desc.MipLevels;
+	UINT size = desc.Width >> mip;
+	if (bIsBlock && size % 4 != 0)
+		return false;
+
+	// Staging copy of just the chosen mip of each face
+	desc.Width = size;
+	desc.Height = size;
+	desc.MipLevels = 1;
+	desc.ArraySize = 6;
+	desc.BindFlags = 0;
+	desc.MiscFlags = 0;
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> staging;
+	if (FAILED(a_device->CreateTexture2D(&desc, nullptr, staging.GetAddressOf())))
+		return false;
+	for (UINT face = 0; face < 6; face++) {
+		a_context->CopySubresourceRegion(staging.Get(), face, 0, 0, 0, texture.Get(), D3D11CalcSubresource(mip, face, sourceMips), nullptr);
+	}
+
+	a_image.Size = size;
+	a_image.Texels.resize((size_t)CUBEMAP_FACE_COUNT * size * size);
+	std::vector<uint8_t> blocks, decoded;
+	for (UINT face = 0; face < 6; face++) {
+		D3D11_MAPPED_SUBRESOURCE mapped = {};
+		if (FAILED(a_context->Map(staging.Get(), face, D3D11_MAP_READ, 0, &mapped)))
+			return false;
+
+		// Block rows are packed tightly and decoded to RGBA8, which is then read like any other RGBA8 face
+		const unsigned char* pixels = static_cast<const unsigned char*>(mapped.pData);
+		size_t rowPitch = mapped.RowPitch;
+		if (bIsBlock) {
+			size_t blockRowBytes = BlockCompression::GetRowPitch(blockFormat, size);
+			unsigned int blockRows = BlockCompression::GetRowCount(blockFormat, size);
+			blocks.resize(blockRowBytes * blockRows);
+			for (unsigned int blockRow = 0; blockRow < blockRows; blockRow++) {
+				std::memcpy(&blocks[blockRow * blockRowBytes], pixels + (size_t)blockRow * mapped.RowPitch, blockRowBytes);
+			}
+			decoded.resize((size_t)size * size * 4);
+			BlockCompression::Decompress(blocks.data(), size, size, blockFormat, decoded.data());
+			pixels = decoded.data();
+			rowPitch = (size_t)size * 4;
+		}
+
+		for (UINT y = 0; y < size; y++) {
+			const unsigned char* row = pixels + (size_t)y * rowPitch;
+			Vector4* destination = &a_image.Texels[((size_t)face * size + y) * size];
+			for (UINT x = 0; x < size; x++) {
+				float r, g, b;
+				if (bIsFloat) {
+					const float* texel = reinterpret_cast<const float*>(row) + x * 4;
+					r = texel[0];
+					g = texel[1];
+					b = texel[2];
+				}
+				else {
+					const unsigned char* texel = row + x * 4;
+					r = texel[bIsBGRA ? 2 : 0] / 255.f;
+					g = texel[1] / 255.f;
+					b = texel[bIsBGRA ? 0 : 2] / 255.f;
+				}
+				destination[x] = Vector4(std::pow(std::fabs(r), 2.2f), std::pow(std::fabs(g), 2.2f), std::pow(std::fabs(b), 2.2f), 1.f);
+			}
+		}
+		a_context->Unmap(staging.Get(), face);
+	}
+	return true;
+}
@@ -2,11 +2,23 @@
 
 #include <wrl/client.h> // Used for ComPtr - a smart pointer for COM objects
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "Mesh.h"
 #include "Camera.h"
+#include "SphericalHarmonics.h"
+#include "IBLCache.h"
 #include "simpleshader/SimpleShader.h"
 
+// IBL generation parameters. All of them feed the IBL cache key, so changing any regenerates the products
+#define SKY_SH_READBACK_SIZE 256 // Largest cube face read back for SH projection, when the sky has smaller mips
+#define SKY_IRRADIANCE_SIZE_DIVISOR 16 // Irradiance cube face size relative to the sky
+#define SKY_IRRADIANCE_PHI_STEP 0.05f // Hemisphere walk of IBLIrradianceMapPS, in radians. Adjust for hardware
+#define SKY_IRRADIANCE_THETA_STEP 0.05f
+#define SKY_SPECULAR_SIZE_DIVISOR 8 // Reflectance cube face size relative to the sky
+#define SKY_SPECULAR_IGNORED_MIPS 2 // Reflectance mips left out at the small end (2x2 and 4x4)
+
 //-------------------------------------------------------
 // A Sky represents the unmoving backdrop of the scene,
 // rendered using its own shaders
@@ -20,9 +32,16 @@ public:
 
 	void Draw(Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_d3dContext, std::shared_ptr<Camera> a_mainCamera);
 
+	void CreateIrradianceSH(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, std::shared_ptr<SimpleVertexShader> a_irradianceVS, std::shared_ptr<SimplePixelShader> a_irradiancePS);
 	void CreateEnvironmentMap(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, std::shared_ptr<SimpleVertexShader> a_irradianceVS, std::shared_ptr<SimplePixelShader> a_irradiancePS);
+	bool LoadSpecularReflectanceMap(Microsoft::WRL::ComPtr<ID3D11Device> a_device, const std::wstring& a_fileName);
 	void CreateSpecularReflectanceMap(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, std::shared_ptr<SimpleVertexShader> a_vertShader, std::shared_ptr<SimplePixelShader> a_prefilterPS);
 
+	// IBL cache (irradiance SH and reflectance map)
+	uint64_t ComputeIBLCacheKey(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, const std::vector<std::string>& a_dependencies, bool& a_bIsCacheable);
+	bool LoadIBLCache(Microsoft::WRL::ComPtr<ID3D11Device> a_device, const std::string& a_fileName, uint64_t a_key);
+	bool SaveIBLCache(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, const std::string& a_fileName, uint64_t a_key);
+
 	// Setters
 	void SetSamplerState(Microsoft::WRL::ComPtr<ID3D11SamplerState> a_samplerState);
 	void SetCubeMap(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_cubeMap);
@@ -43,10 +62,12 @@ public:
 
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetEnvironmentMap();
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetReflectanceMap();
+	const SH9Color& GetIrradianceSH() const;
 
 protected:
 	D3D11_TEXTURE2D_DESC GetTextureCubeDescription();
 	D3D11_SHADER_RESOURCE_VIEW_DESC GetCubeSRVDescription();
+	bool ReadBackCube(Microsoft::WRL::ComPtr<ID3D11Device> a_device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> a_context, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_cube, CubemapImage& a_image);
 
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> m_samplerState; // Texture Sampler
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_cubeMap; // Texture Cube
@@ -56,7 +77,8 @@ protected:
 	std::shared_ptr<SimpleVertexShader> m_vertexShader; // Sky-specific shader
 	std::shared_ptr<SimplePixelShader> m_pixelShader; // Sky-specific shader
 
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_envMap; // Texture Cube holding the Sky's irradiance map
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_envMap; // Texture Cube holding the Sky's irradiance map. Only built as a fallback, see CreateIrradianceSH
+	SH9Color m_irradianceSH; // Sky's diffuse irradiance / PI, linear, as spherical harmonics
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_specMap; // Texture Cube holding the Sky's prefiltered reflectance map
 };
 
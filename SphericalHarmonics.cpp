@@ -0,0 +1,326 @@
+#include "SphericalHarmonics.h"
+#include "JobSystem.h"
+
+#include <array>
+#include <cmath>
+
+// SSE is baseline on every x64 target, and on x86 when building with /arch:SSE2 or -msse2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPHERICAL_HARMONICS_SSE 1
+#include <xmmintrin.h>
+#else
+#define SPHERICAL_HARMONICS_SSE 0
+#endif
+
+#define SH_PI 3.14159265358979f
+#define SH_ROWS_PER_JOB 16
+
+// Basis normalization constants
+#define SH_Y0 0.282095f // 1 / (2 sqrt(pi))
+#define SH_Y1 0.488603f // sqrt(3 / (4 pi))
+#define SH_Y2 1.092548f // sqrt(15 / (4 pi))
+#define SH_Y20 0.315392f // sqrt(5 / (16 pi))
+#define SH_Y22 0.546274f // sqrt(15 / (16 pi))
+
+namespace
+{
+	inline Vector3 Normalize(const Vector3& a_vector)
+	{
+		float inverseLength = 1.f / std::sqrt(a_vector.x * a_vector.x + a_vector.y * a_vector.y + a_vector.z * a_vector.z);
+		return Vector3(a_vector.x * inverseLength, a_vector.y * inverseLength, a_vector.z * inverseLength);
+	}
+
+	inline Vector3 Cross(const Vector3& a_first, const Vector3& a_second)
+	{
+		return Vector3(
+			a_first.y * a_second.z - a_first.z * a_second.y,
+			a_first.z * a_second.x - a_first.x * a_second.z,
+			a_first.x * a_second.y - a_first.y * a_second.x);
+	}
+
+	// Integral of the projected area of the face from the center to (a_x, a_y), used for exact texel solid angles
+	inline double AreaElement(double a_x, double a_y)
+	{
+		return std::atan2(a_x * a_y, std::sqrt(a_x * a_x + a_y * a_y + 1.0));
+	}
+
+	//---------------------------------------------------
+	// Per-texel values shared by all six faces. A texel's
+	// unit direction is U * ScaledU + V * ScaledV + N * InverseLength
+	//---------------------------------------------------
+	struct FaceTables {
+		std::vector<float> Weights; // Solid angle
+		std::vector<float> ScaledU;
+		std::vector<float> ScaledV;
+		std::vector<float> InverseLengths;
+	};
+
+	void BuildFaceTables(unsigned int a_size, FaceTables& a_tables)
+	{
+		size_t texelCount = (size_t)a_size * a_size;
+		a_tables.Weights.resize(texelCount);
+		a_tables.ScaledU.resize(texelCount);
+		a_tables.ScaledV.resize(texelCount);
+		a_tables.InverseLengths.resize(texelCount);
+
+		double texelSize = 2.0 / a_size;
+		for (unsigned int y = 0; y < a_size; y++) {
+			double y0 = y * texelSize - 1.0;
+			double y1 = y0 + texelSize;
+			for (unsigned int x = 0; x < a_size; x++) {
+				double x0 = x * texelSize - 1.0;
+				double x1 = x0 + texelSize;
+				double u = x0 + texelSize * 0.5;
+				double v = y0 + texelSize * 0.5;
+				double inverseLength = 1.0 / std::sqrt(u * u + v * v + 1.0);
+
+				size_t index = (size_t)y * a_size + x;
+				a_tables.Weights[index] = (float)(AreaElement(x0, y0) - AreaElement(x0, y1) - AreaElement(x1, y0) + AreaElement(x1, y1));
+				a_tables.ScaledU[index] = (float)(u * inverseLength);
+				a_tables.ScaledV[index] = (float)(v * inverseLength);
+				a_tables.InverseLengths[index] = (float)inverseLength;
+			}
+		}
+	}
+
+	// Coefficient i, channel c lives at [i * 3 + c]
+	typedef std::array<double, SH_COEFFICIENT_COUNT * 3> SHAccumulator;
+
+	//---------------------------------------------------
+	// Accumulate one row of one face into a_sum
+	//	- Row sums are kept in float and folded into the
+	//	  double total per row, so precision doesn't depend
+	//	  on cube size
+	//---------------------------------------------------
+	void ProjectRow(const CubemapImage& a_cube, const FaceTables& a_tables, unsigned int a_face, unsigned int a_y,
+		bool a_bUseSIMD, SHAccumulator& a_sum)
+	{
+		const CubemapFaceAxes& axes = Cubemap::GetFaceAxes(a_face);
+		unsigned int size = a_cube.Size;
+		size_t tableRow = (size_t)a_y * size;
+		const Vector4* texels = &a_cube.Texels[(size_t)a_face * size * size + tableRow];
+		const float* weights = &a_tables.Weights[tableRow];
+		const float* scaledU = &a_tables.ScaledU[tableRow];
+		const float* scaledV = &a_tables.ScaledV[tableRow];
+		const float* inverseLengths = &a_tables.InverseLengths[tableRow];
+
+		float rowSum[SH_COEFFICIENT_COUNT * 3] = {};
+		unsigned int x = 0;
+
+#if SPHERICAL_HARMONICS_SSE
+		if (a_bUseSIMD) {
+			__m128 sums[SH_COEFFICIENT_COUNT * 3];
+			for (__m128& sum : sums) {
+				sum = _mm_setzero_ps();
+			}
+
+			const __m128 ux = _mm_set1_ps(axes.U.x), uy = _mm_set1_ps(axes.U.y), uz = _mm_set1_ps(axes.U.z);
+			const __m128 vx = _mm_set1_ps(axes.V.x), vy = _mm_set1_ps(axes.V.y), vz = _mm_set1_ps(axes.V.z);
+			const __m128 nx = _mm_set1_ps(axes.N.x), ny = _mm_set1_ps(axes.N.y), nz = _mm_set1_ps(axes.N.z);
+			const __m128 three = _mm_set1_ps(3.f);
+			const __m128 one = _mm_set1_ps(1.f);
+
+			for (; x + 4 <= size; x += 4) {
+				// Directions of 4 texels
+				__m128 su = _mm_loadu_ps(scaledU + x);
+				__m128 sv = _mm_loadu_ps(scaledV + x);
+				__m128 il = _mm_loadu_ps(inverseLengths + x);
+				__m128 dx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ux, su), _mm_mul_ps(vx, sv)), _mm_mul_ps(nx, il));
+				__m128 dy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(uy, su), _mm_mul_ps(vy, sv)), _mm_mul_ps(ny, il));
+				__m128 dz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(uz, su), _mm_mul_ps(vz, sv)), _mm_mul_ps(nz, il));
+
+				__m128 basis[SH_COEFFICIENT_COUNT];
+				basis[0] = _mm_set1_ps(SH_Y0);
+				basis[1] = _mm_mul_ps(_mm_set1_ps(SH_Y1), dy);
+				basis[2] = _mm_mul_ps(_mm_set1_ps(SH_Y1), dz);
+				basis[3] = _mm_mul_ps(_mm_set1_ps(SH_Y1), dx);
+				basis[4] = _mm_mul_ps(_mm_set1_ps(SH_Y2), _mm_mul_ps(dx, dy));
+				basis[5] = _mm_mul_ps(_mm_set1_ps(SH_Y2), _mm_mul_ps(dy, dz));
+				basis[6] = _mm_mul_ps(_mm_set1_ps(SH_Y20), _mm_sub_ps(_mm_mul_ps(three, _mm_mul_ps(dz, dz)), one));
+				basis[7] = _mm_mul_ps(_mm_set1_ps(SH_Y2), _mm_mul_ps(dx, dz));
+				basis[8] = _mm_mul_ps(_mm_set1_ps(SH_Y22), _mm_sub_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+
+				// Transpose 4 RGBA texels into R, G, B lanes, pre-scaled by solid angle
+				__m128 r = _mm_loadu_ps(&texels[x].x);
+				__m128 g = _mm_loadu_ps(&texels[x + 1].x);
+				__m128 b = _mm_loadu_ps(&texels[x + 2].x);
+				__m128 a = _mm_loadu_ps(&texels[x + 3].x);
+				_MM_TRANSPOSE4_PS(r, g, b, a);
+				__m128 w = _mm_loadu_ps(weights + x);
+				r = _mm_mul_ps(r, w);
+				g = _mm_mul_ps(g, w);
+				b = _mm_mul_ps(b, w);
+
+				for (int i = 0; i < SH_COEFFICIENT_COUNT; i++) {
+					sums[i * 3] = _mm_add_ps(sums[i * 3], _mm_mul_ps(basis[i], r));
+					sums[i * 3 + 1] = _mm_add_ps(sums[i * 3 + 1], _mm_mul_ps(basis[i], g));
+					sums[i * 3 + 2] = _mm_add_ps(sums[i * 3 + 2], _mm_mul_ps(basis[i], b));
+				}
+			}
+
+			for (int i = 0; i < SH_COEFFICIENT_COUNT * 3; i++) {
+				alignas(16) float lanes[4];
+				_mm_store_ps(lanes, sums[i]);
+				rowSum[i] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+			}
+		}
+#else
+		(void)a_bUseSIMD;
+#endif
+
+		// Scalar path, and the remainder of a SIMD row
+		for (; x < size; x++) {
+			Vector3 direction(
+				axes.U.x * scaledU[x] + axes.V.x * scaledV[x] + axes.N.x * inverseLengths[x],
+				axes.U.y * scaledU[x] + axes.V.y * scaledV[x] + axes.N.y * inverseLengths[x],
+				axes.U.z * scaledU[x] + axes.V.z * scaledV[x] + axes.N.z * inverseLengths[x]);
+			float basis[SH_COEFFICIENT_COUNT];
+			SphericalHarmonics::EvaluateBasis(direction, basis);
+
+			float r = texels[x].x * weights[x];
+			float g = texels[x].y * weights[x];
+			float b = texels[x].z * weights[x];
+			for (int i = 0; i < SH_COEFFICIENT_COUNT; i++) {
+				rowSum[i * 3] += basis[i] * r;
+				rowSum[i * 3 + 1] += basis[i] * g;
+				rowSum[i * 3 + 2] += basis[i] * b;
+			}
+		}
+
+		for (int i = 0; i < SH_COEFFICIENT_COUNT * 3; i++) {
+			a_sum[i] += rowSum[i];
+		}
+	}
+}
+
+//-------------------------------------------------------
+// Real SH basis, bands 0-2
+//-------------------------------------------------------
+void SphericalHarmonics::EvaluateBasis(const Vector3& a_direction, float a_basis[SH_COEFFICIENT_COUNT])
+{
+	float x = a_direction.x, y = a_direction.y, z = a_direction.z;
+	a_basis[0] = SH_Y0;
+	a_basis[1] = SH_Y1 * y;
+	a_basis[2] = SH_Y1 * z;
+	a_basis[3] = SH_Y1 * x;
+	a_basis[4] = SH_Y2 * (x * y);
+	a_basis[5] = SH_Y2 * (y * z);
+	a_basis[6] = SH_Y20 * (3.f * (z * z) - 1.f);
+	a_basis[7] = SH_Y2 * (x * z);
+	a_basis[8] = SH_Y22 * (x * x - y * y);
+}
+
+//-------------------------------------------------------
+// Integrate radiance * basis over the sphere
+//	- Work is split into fixed blocks of rows whose sums
+//	  are combined in order afterwards, so the result is
+//	  identical with and without threading
+//-------------------------------------------------------
+void SphericalHarmonics::ProjectCubemap(const CubemapImage& a_cube, SH9Color& a_sh, bool a_bMultithreaded, bool a_bUseSIMD)
+{
+	FaceTables tables;
+	BuildFaceTables(a_cube.Size, tables);
+
+	unsigned int rowCount = a_cube.Size * CUBEMAP_FACE_COUNT;
+	unsigned int blockCount = (rowCount + SH_ROWS_PER_JOB - 1) / SH_ROWS_PER_JOB;
+	std::vector<SHAccumulator> blockSums(blockCount);
+
+	auto projectRows = [&](unsigned int a_begin, unsigned int a_end) {
+		for (unsigned int block = a_begin; block < a_end; block++) {
+			SHAccumulator& sum = blockSums[block];
+			sum.fill(0.0);
+
+			unsigned int lastRow = (block + 1) * SH_ROWS_PER_JOB < rowCount ? (block + 1) * SH_ROWS_PER_JOB : rowCount;
+			for (unsigned int row = block * SH_ROWS_PER_JOB; row < lastRow; row++) {
+				ProjectRow(a_cube, tables, row / a_cube.Size, row % a_cube.Size, a_bUseSIMD, sum);
+			}
+		}
+	};
+
+	if (a_bMultithreaded)
+		JobSystem::GetInstance().ParallelFor(blockCount, 1, projectRows);
+	else
+		projectRows(0, blockCount);
+
+	SHAccumulator total = {};
+	for (const SHAccumulator& sum : blockSums) {
+		for (int i = 0; i < SH_COEFFICIENT_COUNT * 3; i++) {
+			total[i] += sum[i];
+		}
+	}
+	for (int i = 0; i < SH_COEFFICIENT_COUNT; i++) {
+		a_sh.Coefficients[i] = Vector4((float)total[i * 3], (float)total[i * 3 + 1], (float)total[i * 3 + 2], 0.f);
+	}
+}
+
+//-------------------------------------------------------
+// Scale each band by the clamped cosine lobe's SH
+// coefficients (PI, 2PI/3, PI/4), divided by PI to match
+// what the irradiance cubemap stored
+//-------------------------------------------------------
+void SphericalHarmonics::ConvolveIrradiance(SH9Color& a_sh)
+{
+	const float bandScales[3] = { 1.f, 2.f / 3.f, 1.f / 4.f };
+	for (int i = 0; i < SH_COEFFICIENT_COUNT; i++) {
+		float scale = bandScales[i == 0 ? 0 : (i < 4 ? 1 : 2)];
+		a_sh.Coefficients[i].x *= scale;
+		a_sh.Coefficients[i].y *= scale;
+		a_sh.Coefficients[i].z *= scale;
+	}
+}
+
+//-------------------------------------------------------
+// Sum of coefficients times basis
+//-------------------------------------------------------
+Vector3 SphericalHarmonics::Evaluate(const SH9Color& a_sh, const Vector3& a_direction)
+{
+	float basis[SH_COEFFICIENT_COUNT];
+	EvaluateBasis(a_direction, basis);
+
+	Vector3 result(0.f, 0.f, 0.f);
+	for (int i = 0; i < SH_COEFFICIENT_COUNT; i++) {
+		result.x += a_sh.Coefficients[i].x * basis[i];
+		result.y += a_sh.Coefficients[i].y * basis[i];
+		result.z += a_sh.Coefficients[i].z * basis[i];
+	}
+	return result;
+}
+
+//-------------------------------------------------------
+// Same loops and weighting as IBLIrradianceMapPS, without
+// the final gamma encode
+//	- The tangent is normalized here; the shader assumed
+//	  cross(up, N) was already unit length
+//-------------------------------------------------------
+Vector3 SphericalHarmonics::IntegrateIrradiance(const CubemapImage& a_cube, const Vector3& a_normal, float a_thetaStep, float a_phiStep)
+{
+	Vector3 tangent = Cross(Vector3(0.f, 1.f, 0.f), a_normal);
+	if (tangent.x * tangent.x + tangent.y * tangent.y + tangent.z * tangent.z < 1e-8f)
+		tangent = Vector3(1.f, 0.f, 0.f); // Normal is straight up or down
+	tangent = Normalize(tangent);
+	Vector3 bitangent = Cross(a_normal, tangent);
+
+	double total[3] = {};
+	unsigned int samples = 0;
+	for (float theta = 0.f; theta < 2.f * SH_PI; theta += a_thetaStep) {
+		float sinTheta = std::sin(theta), cosTheta = std::cos(theta);
+		for (float phi = 0.f; phi < SH_PI * 0.5f; phi += a_phiStep) {
+			float sinPhi = std::sin(phi), cosPhi = std::cos(phi);
+			float hx = cosTheta * sinPhi, hy = sinTheta * sinPhi, hz = cosPhi;
+			Vector3 direction(
+				hx * tangent.x + hy * bitangent.x + hz * a_normal.x,
+				hx * tangent.y + hy * bitangent.y + hz * a_normal.y,
+				hx * tangent.z + hy * bitangent.z + hz * a_normal.z);
+
+			Vector3 radiance = Cubemap::Sample(a_cube, direction);
+			float weight = cosPhi * sinPhi;
+			total[0] += radiance.x * weight;
+			total[1] += radiance.y * weight;
+			total[2] += radiance.z * weight;
+			samples++;
+		}
+	}
+
+	double scale = SH_PI / samples;
+	return Vector3((float)(total[0] * scale), (float)(total[1] * scale), (float)(total[2] * scale));
+}
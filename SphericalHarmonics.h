@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Cubemap.h"
+
+#define SH_COEFFICIENT_COUNT 9 // Bands 0-2
+
+//-------------------------------------------------------
+// Nine RGB spherical harmonic coefficients
+//	- Stored as Vector4 so they upload directly into a
+//	  float4[9] cbuffer array (w is unused)
+//-------------------------------------------------------
+struct SH9Color {
+	Vector4 Coefficients[SH_COEFFICIENT_COUNT] = {};
+};
+
+//-------------------------------------------------------
+// Order 3 spherical harmonic lighting, replacing the
+// brute-force irradiance cubemap (IBLIrradianceMapPS)
+//	- ProjectCubemap integrates every texel with its exact
+//	  solid angle, 4 texels at a time with SSE and spread
+//	  over the JobSystem
+//	- ConvolveIrradiance applies the clamped cosine lobe,
+//	  after which Evaluate returns the same quantity the
+//	  irradiance cubemap stored (irradiance / PI, linear)
+//	- IntegrateIrradiance is the brute-force integral the
+//	  pixel shader ran, kept as a reference
+//-------------------------------------------------------
+namespace SphericalHarmonics
+{
+	// Real SH basis functions Y00, Y1-1, Y10, Y11, Y2-2, Y2-1, Y20, Y21, Y22 for a unit direction
+	void EvaluateBasis(const Vector3& a_direction, float a_basis[SH_COEFFICIENT_COUNT]);
+
+	// Project radiance into SH. a_cube must be non-empty
+	void ProjectCubemap(const CubemapImage& a_cube, SH9Color& a_sh, bool a_bMultithreaded, bool a_bUseSIMD);
+
+	// Radiance SH -> Lambertian irradiance / PI SH
+	void ConvolveIrradiance(SH9Color& a_sh);
+
+	// Reconstruct the function in a_direction (unit length)
+	Vector3 Evaluate(const SH9Color& a_sh, const Vector3& a_direction);
+
+	// IBLIrradianceMapPS - hemisphere walk in a_thetaStep / a_phiStep radian steps around a_normal
+	Vector3 IntegrateIrradiance(const CubemapImage& a_cube, const Vector3& a_normal, float a_thetaStep, float a_phiStep);
+}
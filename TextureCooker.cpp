@@ -0,0 +1,368 @@
+#include "TextureCooker.h"
+#include "DDSFile.h"
+#include "PngDecoder.h"
+#include "AssetFiles.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+	// A file name's parts, split on '_', '-' and spaces and lower cased
+	std::vector<std::string> SplitName(const std::filesystem::path& a_source)
+	{
+		std::string name = a_source.stem().string();
+		std::vector<std::string> parts;
+		size_t start = 0;
+		while (start < name.size()) {
+			size_t end = name.find_first_of("_- ", start);
+			end = (end == std::string::npos) ? name.size() : end;
+			std::string part = name.substr(start, end - start);
+			for (char& character : part) {
+				character = (char)std::tolower((unsigned char)character);
+			}
+			parts.push_back(part);
+			start = end + 1;
+		}
+		return parts;
+	}
+
+	bool StartsWith(const std::string& a_part, const char* a_prefix)
+	{
+		return a_part.compare(0, std::char_traits<char>::length(a_prefix), a_prefix) == 0;
+	}
+
+	// Compress every level of a_texture unless a_format is RGBA8, and write it. a_result gets everything but Usage
+	bool CompressAndWrite(const std::filesystem::path& a_fileName, TextureData& a_texture, TextureFormat a_format,
+		CompressionQuality a_quality, const uint32_t* a_userData, TextureCookResult& a_result)
+	{
+		// Keep the top level's pixels to measure what compression cost
+		a_result.PSNR = std::numeric_limits<double>::infinity();
+		if (a_format != TextureFormat::RGBA8) {
+			std::vector<uint8_t> reference = a_texture.Mips[0].Pixels;
+			BlockCompression::CompressTexture(a_texture, a_format, a_quality);
+
+			const TextureMip& top = a_texture.Mips[0];
+			std::vector<uint8_t> decoded((size_t)top.Width * top.Height * 4);
+			BlockCompression::Decompress(top.Pixels.data(), top.Width, top.Height, a_format, decoded.data());
+			a_result.PSNR = BlockCompression::ComputePSNR(reference.data(), decoded.data(), (size_t)top.Width * top.Height, a_format);
+		}
+		if (!DDSFile::WriteTexture(a_fileName, a_texture, a_userData))
+			return false;
+
+		a_result.Format = a_format;
+		a_result.Width = a_texture.Mips[0].Width;
+		a_result.Height = a_texture.Mips[0].Height;
+		a_result.MipCount = (unsigned int)a_texture.Mips.size();
+		a_result.OutputBytes = 0;
+		for (const TextureMip& mip : a_texture.Mips) {
+			a_result.OutputBytes += mip.Pixels.size();
+		}
+		return true;
+	}
+
+	// Bilinear sample of an RGBA8 image's red channel at texel centers, stretched to a_width x a_height
+	uint8_t SampleStretched(const TextureMip& a_image, unsigned int a_x, unsigned int a_y, unsigned int a_width, unsigned int a_height)
+	{
+		float u = std::clamp((a_x + .5f) * a_image.Width / a_width - .5f, 0.f, (float)(a_image.Width - 1));
+		float v = std::clamp((a_y + .5f) * a_image.Height / a_height - .5f, 0.f, (float)(a_image.Height - 1));
+		unsigned int x0 = (unsigned int)u;
+		unsigned int y0 = (unsigned int)v;
+		unsigned int x1 = std::min(x0 + 1, a_image.Width - 1);
+		unsigned int y1 = std::min(y0 + 1, a_image.Height - 1);
+		float fx = u - x0;
+		float fy = v - y0;
+		auto texel = [&](unsigned int a_texelX, unsigned int a_texelY) {
+			return (float)a_image.Pixels[((size_t)a_texelY * a_image.Width + a_texelX) * 4];
+		};
+		float top = texel(x0, y0) + (texel(x1, y0) - texel(x0, y0)) * fx;
+		float bottom = texel(x0, y1) + (texel(x1, y1) - texel(x0, y1)) * fx;
+		return (uint8_t)(top + (bottom - top) * fy + .5f);
+	}
+}
+
+//-----------------------------------------------
+// Name parts are matched by prefix, so
+// "NormalDX", "normals" and "Roughness" all
+// count. The last part that means something
+// wins, as the material name comes first
+// ("Metal032_1K_Color")
+//-----------------------------------------------
+TextureUsage TextureCooker::Classify(const std::filesystem::path& a_source)
+{
+	static const char* s_colorPrefixes[] = { "color", "albedo", "diffuse", "basecolor" };
+	static const char* s_dataPrefixes[] = { "rough", "metal", "occlusion", "ao", "height", "displacement", "orm" };
+
+	TextureUsage usage = TextureUsage::Color;
+	for (const std::string& part : SplitName(a_source)) {
+		if (StartsWith(part, "normal"))
+			usage = TextureUsage::Normal;
+		for (const char* prefix : s_colorPrefixes) {
+			if (StartsWith(part, prefix))
+				usage = TextureUsage::Color;
+		}
+		for (const char* prefix : s_dataPrefixes) {
+			if (StartsWith(part, prefix))
+				usage = TextureUsage::Data;
+		}
+	}
+	return usage;
+}
+
+bool TextureCooker::IsCubeFace(const std::filesystem::path& a_source)
+{
+	static const char* s_faceNames[] = { "right.png", "left.png", "up.png", "down.png", "front.png", "back.png" };
+	std::string name = a_source.filename().string();
+	for (const char* face : s_faceNames) {
+		if (name == face)
+			return true;
+	}
+	return false;
+}
+
+std::filesystem::path TextureCooker::GetCookedPath(const std::filesystem::path& a_source)
+{
+	std::filesystem::path cooked(a_source);
+	return cooked.replace_extension(TEXTURE_COOKED_EXTENSION);
+}
+
+//-----------------------------------------------
+// Missing files and filesystem errors both count
+// as out of date. Archived files compare by the
+// times recorded when the archive was built
+//-----------------------------------------------
+bool TextureCooker::IsUpToDate(const std::filesystem::path& a_source)
+{
+	std::filesystem::file_time_type cookedTime, sourceTime;
+	return AssetFiles::GetWriteTime(GetCookedPath(a_source), cookedTime) && AssetFiles::GetWriteTime(a_source, sourceTime)
+		&& cookedTime >= sourceTime;
+}
+
+//-----------------------------------------------
+// D3D11 only creates block compressed textures
+// whose top level is a whole number of blocks
+// (smaller mips are padded by the runtime), and
+// BC1 has no proper alpha
+//-----------------------------------------------
+TextureFormat TextureCooker::ChooseFormat(const TextureData& a_texture, TextureUsage a_usage, const TextureCookSettings& a_settings)
+{
+	if (!a_settings.bCompress || a_texture.Mips.empty() || a_texture.Format != TextureFormat::RGBA8)
+		return TextureFormat::RGBA8;
+	const TextureMip& top = a_texture.Mips[0];
+	if (top.Width % 4 != 0 || top.Height % 4 != 0)
+		return TextureFormat::RGBA8;
+
+	if (a_usage == TextureUsage::Normal)
+		return TextureFormat::BC5;
+	if (a_usage == TextureUsage::Data)
+		return TextureFormat::BC4;
+	if (a_settings.bPreferBC7)
+		return TextureFormat::BC7;
+	for (size_t i = 3; i < top.Pixels.size(); i += 4) {
+		if (top.Pixels[i] != 255)
+			return TextureFormat::BC7;
+	}
+	return TextureFormat::BC1;
+}
+
+//-----------------------------------------------
+// Decode, filter, compress and write one texture
+//	- Cube faces are written as RGBA8. A block
+//	  compressed sky can't be a render target
+//	  for the IBL passes
+//-----------------------------------------------
+bool TextureCooker::Cook(const std::filesystem::path& a_source, const TextureCookSettings& a_settings, TextureCookResult& a_result)
+{
+	TextureData texture;
+	if (!PngDecoder::LoadFile(a_source, texture))
+		return false;
+
+	MipSettings settings;
+	settings.Filter = a_settings.Filter;
+	settings.Usage = Classify(a_source);
+	TextureMips::Generate(texture, settings);
+
+	TextureFormat format = IsCubeFace(a_source) ? TextureFormat::RGBA8 : ChooseFormat(texture, settings.Usage, a_settings);
+	a_result.Usage = settings.Usage;
+	return CompressAndWrite(GetCookedPath(a_source), texture, format, a_settings.Quality, nullptr, a_result);
+}
+
+//-----------------------------------------------
+// Only the last name part counts, as material
+// names can look like channels too
+// ("Metal032_1K_Color")
+//-----------------------------------------------
+ORMChannel TextureCooker::GetORMChannel(const std::filesystem::path& a_source)
+{
+	std::vector<std::string> parts = SplitName(a_source);
+	const std::string& part = parts.empty() ? std::string() : parts.back();
+	if (StartsWith(part, "occlusion") || StartsWith(part, "ambientocclusion") || part == "ao")
+		return ORMChannel::Occlusion;
+	if (StartsWith(part, "rough"))
+		return ORMChannel::Roughness;
+	if (StartsWith(part, "metal"))
+		return ORMChannel::Metalness;
+	return ORMChannel::None;
+}
+
+std::filesystem::path TextureCooker::GetPackedPath(const std::filesystem::path a_sources[3])
+{
+	for (int i = 0; i < 3; i++) {
+		if (a_sources[i].empty())
+			continue;
+		std::string stem = a_sources[i].stem().string();
+		size_t lastPart = stem.find_last_of('_');
+		std::filesystem::path packed(a_sources[i]);
+		packed.replace_filename(stem.substr(0, lastPart) + ORM_PACKED_SUFFIX + TEXTURE_COOKED_EXTENSION);
+		return packed;
+	}
+	return std::filesystem::path();
+}
+
+void TextureCooker::GroupORMSources(const std::vector<std::filesystem::path>& a_files, std::vector<std::array<std::filesystem::path, 3>>& a_groups)
+{
+	std::map<std::string, std::array<std::filesystem::path, 3>> groups;
+	std::map<std::string, bool> bConflicted;
+	for (const std::filesystem::path& file : a_files) {
+		ORMChannel channel = GetORMChannel(file);
+		if (channel == ORMChannel::None)
+			continue;
+		std::string stem = file.stem().string();
+		std::string key = (file.parent_path() / stem.substr(0, stem.find_last_of('_'))).generic_string();
+		std::array<std::filesystem::path, 3>& group = groups[key];
+		bConflicted[key] = bConflicted[key] || !group[(int)channel].empty();
+		group[(int)channel] = file;
+	}
+	a_groups.clear();
+	for (const std::pair<const std::string, std::array<std::filesystem::path, 3>>& group : groups) {
+		if (!bConflicted[group.first] && !group.second[(int)ORMChannel::Roughness].empty())
+			a_groups.push_back(group.second);
+	}
+}
+
+//-----------------------------------------------
+// A source that doesn't exist can't be newer, so
+// channels without a map don't force a repack
+//-----------------------------------------------
+bool TextureCooker::IsPackedUpToDate(const std::filesystem::path a_sources[3])
+{
+	std::filesystem::file_time_type packedTime;
+	if (!AssetFiles::GetWriteTime(GetPackedPath(a_sources), packedTime))
+		return false;
+	for (int i = 0; i < 3; i++) {
+		if (a_sources[i].empty() || !AssetFiles::Exists(a_sources[i]))
+			continue;
+		std::filesystem::file_time_type sourceTime;
+		if (!AssetFiles::GetWriteTime(a_sources[i], sourceTime) || sourceTime > packedTime)
+			return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------
+// Each source's red channel is its value (gray
+// PNGs decode to equal R, G and B). A channel
+// whose texels all sit within ORM_CONSTANT_RANGE
+// becomes its mean instead
+//-----------------------------------------------
+bool TextureCooker::PackORM(const std::filesystem::path a_sources[3], TextureData& a_packed, ORMLayout& a_layout)
+{
+	a_layout = ORMLayout();
+	TextureData images[3];
+	unsigned int width = 1;
+	unsigned int height = 1;
+	for (int c = 0; c < 3; c++) {
+		if (a_sources[c].empty() || !AssetFiles::Exists(a_sources[c]))
+			continue;
+		if (!PngDecoder::LoadFile(a_sources[c], images[c]))
+			return false;
+
+		const TextureMip& image = images[c].Mips[0];
+		uint8_t lowest = 255;
+		uint8_t highest = 0;
+		uint64_t sum = 0;
+		for (size_t i = 0; i < image.Pixels.size(); i += 4) {
+			lowest = std::min(lowest, image.Pixels[i]);
+			highest = std::max(highest, image.Pixels[i]);
+			sum += image.Pixels[i];
+		}
+		if (highest - lowest <= ORM_CONSTANT_RANGE) {
+			a_layout.Constants[c] = (float)std::round((double)sum / ((double)image.Width * image.Height)) / 255.f; // Whole 8 bit steps, as cooked files store them
+			continue;
+		}
+		a_layout.bTextured[c] = true;
+		width = std::max(width, image.Width);
+		height = std::max(height, image.Height);
+	}
+
+	a_packed = TextureData();
+	a_packed.Mips.resize(1);
+	TextureMip& packed = a_packed.Mips[0];
+	packed.Width = width;
+	packed.Height = height;
+	packed.Pixels.resize((size_t)width * height * 4);
+	for (int c = 0; c < 3; c++) {
+		const TextureMip* image = a_layout.bTextured[c] ? &images[c].Mips[0] : nullptr;
+		bool bSameSize = image != nullptr && image->Width == width && image->Height == height;
+		uint8_t constant = (uint8_t)(a_layout.Constants[c] * 255.f + .5f);
+		for (unsigned int y = 0; y < height; y++) {
+			for (unsigned int x = 0; x < width; x++) {
+				size_t index = ((size_t)y * width + x) * 4;
+				packed.Pixels[index + c] = image == nullptr ? constant
+					: bSameSize ? image->Pixels[index]
+					: SampleStretched(*image, x, y, width, height);
+			}
+		}
+	}
+	for (size_t i = 3; i < packed.Pixels.size(); i += 4) {
+		packed.Pixels[i] = 255;
+	}
+	return true;
+}
+
+//-----------------------------------------------
+// The layout goes in the file's user data: the
+// tag, a bit per textured channel, and the
+// constants as bytes
+//-----------------------------------------------
+bool TextureCooker::CookORM(const std::filesystem::path a_sources[3], const TextureCookSettings& a_settings, TextureCookResult& a_result, ORMLayout& a_layout)
+{
+	TextureData packed;
+	if (!PackORM(a_sources, packed, a_layout))
+		return false;
+
+	MipSettings settings;
+	settings.Filter = a_settings.Filter;
+	settings.Usage = TextureUsage::Data;
+	TextureMips::Generate(packed, settings);
+
+	bool bTextured = a_layout.bTextured[0] || a_layout.bTextured[1] || a_layout.bTextured[2];
+	bool bWholeBlocks = packed.Mips[0].Width % 4 == 0 && packed.Mips[0].Height % 4 == 0;
+	TextureFormat format = a_settings.bCompress && bTextured && bWholeBlocks ? TextureFormat::BC7 : TextureFormat::RGBA8;
+
+	uint32_t userData[DDS_USER_DATA_COUNT] = { ORM_USER_DATA_TAG };
+	for (int c = 0; c < 3; c++) {
+		userData[1] |= a_layout.bTextured[c] ? 1u << c : 0u;
+		userData[2] |= (uint32_t)(a_layout.Constants[c] * 255.f + .5f) << (c * 8);
+	}
+	a_result.Usage = TextureUsage::Data;
+	return CompressAndWrite(GetPackedPath(a_sources), packed, format, a_settings.Quality, userData, a_result);
+}
+
+bool TextureCooker::ReadORM(const std::filesystem::path& a_fileName, TextureData& a_packed, ORMLayout& a_layout)
+{
+	uint32_t userData[DDS_USER_DATA_COUNT] = {};
+	if (!DDSFile::ReadTexture(a_fileName, a_packed, userData) || userData[0] != ORM_USER_DATA_TAG)
+		return false;
+	for (int c = 0; c < 3; c++) {
+		a_layout.bTextured[c] = (userData[1] >> c) & 1u;
+		a_layout.Constants[c] = ((userData[2] >> (c * 8)) & 0xFF) / 255.f;
+	}
+	return true;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+#include "BlockCompression.h"
+#include "TextureMips.h"
+
+#define TEXTURE_COOKED_EXTENSION ".dds" // Cooked copies sit beside their source with this extension
+#define ORM_PACKED_SUFFIX "_ORM" // Replaces the last name part of a packed texture's first source
+#define ORM_CONSTANT_RANGE 2 // Channels whose texels all lie within this many 8 bit steps become a constant
+#define ORM_USER_DATA_TAG 0x314D524F // "ORM1", marks the packed layout in the cooked file's user data
+
+// Channels of a packed occlusion/roughness/metalness texture, in R, G, B order
+enum class ORMChannel {
+	Occlusion,
+	Roughness,
+	Metalness,
+	None
+};
+
+//-------------------------------------------------------
+// How textures are cooked
+//-------------------------------------------------------
+struct TextureCookSettings {
+	MipFilter Filter = MipFilter::Kaiser;
+	bool bCompress = true; // Block compress, otherwise write RGBA8
+	CompressionQuality Quality = CompressionQuality::Normal;
+	bool bPreferBC7 = false; // Color textures use BC7 even when opaque, instead of BC1
+};
+
+//-------------------------------------------------------
+// What one cook produced
+//-------------------------------------------------------
+struct TextureCookResult {
+	TextureUsage Usage = TextureUsage::Color;
+	TextureFormat Format = TextureFormat::RGBA8;
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+	unsigned int MipCount = 0;
+	size_t OutputBytes = 0; // Pixel data written, every mip
+	double PSNR = 0.0; // Of the top mip against its uncompressed pixels, in dB. Infinite for RGBA8
+};
+
+//-------------------------------------------------------
+// How a packed occlusion/roughness/metalness texture is
+// laid out. Channels whose source is missing or holds a
+// single value are constants, for the material to hold
+// as scalars, and the texture is only sampled at all
+// when some channel is textured
+//-------------------------------------------------------
+struct ORMLayout {
+	float Constants[3] = { 1.f, 1.f, 0.f }; // Untextured channels' values, by default unoccluded, fully rough and non-metal
+	bool bTextured[3] = {}; // Channels the texture holds
+};
+
+//-------------------------------------------------------
+// Offline texture cooking, so runtime loads are a single
+// read instead of a decode and a mip build
+//	- Each PNG becomes a DDS holding its full mip chain,
+//	  built with TextureMips' quality path (gamma correct,
+//	  Kaiser or box, normal maps renormalized). DDSTexture-
+//	  Loader and TextureLoader both take the file without
+//	  any conversion
+//	- What a texture holds is worked out from its name,
+//	  following the material folders' conventions, and
+//	  picks its block format: BC1 for opaque color (BC7
+//	  with alpha or when asked), BC4 for single channel
+//	  data and BC5 for normals, whose z the shaders rebuild.
+//	  Textures whose size isn't a multiple of 4 stay RGBA8,
+//	  as do cube faces, which Sky renders from and reads
+//	  back on the CPU
+//	- Occlusion, roughness and metalness maps can also be
+//	  packed into one texture's R, G and B, so materials
+//	  sample and bind one texture instead of three
+//	- TextureLoader picks up a cooked copy whenever it's
+//	  at least as new as its PNG, so stale cooks are never
+//	  used and cooking stays optional
+//-------------------------------------------------------
+namespace TextureCooker
+{
+	// Normal for "normal" name parts (e.g. "_NormalDX"), Data for roughness, metalness, occlusion and height,
+	// otherwise Color. The last name part that matches decides
+	TextureUsage Classify(const std::filesystem::path& a_source);
+
+	// True for the six face names TextureLoader::LoadCube reads ("right.png", "left.png", "up.png"...)
+	bool IsCubeFace(const std::filesystem::path& a_source);
+
+	// Where the cooked copy of a_source goes
+	std::filesystem::path GetCookedPath(const std::filesystem::path& a_source);
+
+	// True when the cooked copy exists and isn't older than a_source
+	bool IsUpToDate(const std::filesystem::path& a_source);
+
+	// The format a texture of a_usage is cooked to. a_texture must still be RGBA8
+	TextureFormat ChooseFormat(const TextureData& a_texture, TextureUsage a_usage, const TextureCookSettings& a_settings);
+
+	// Decode a_source, build its mips, compress them and write the cooked copy
+	bool Cook(const std::filesystem::path& a_source, const TextureCookSettings& a_settings, TextureCookResult& a_result);
+
+	// Which packed channel a texture feeds, from its last name part: "occlusion"/"ao", "rough" or "metal"
+	ORMChannel GetORMChannel(const std::filesystem::path& a_source);
+
+	// Where the packed texture of a_sources (occlusion, roughness, metalness, any of them empty) goes: beside the
+	// first source, with its last name part replaced ("bronze_roughness.png" -> "bronze_ORM.dds")
+	std::filesystem::path GetPackedPath(const std::filesystem::path a_sources[3]);
+
+	// Group a_files' occlusion, roughness and metalness maps by everything before their last name part, into the
+	// sources of packed textures. Groups without a roughness map, or with two maps for one channel, aren't packed
+	void GroupORMSources(const std::vector<std::filesystem::path>& a_files, std::vector<std::array<std::filesystem::path, 3>>& a_groups);
+
+	// True when the packed texture exists and isn't older than any source that exists
+	bool IsPackedUpToDate(const std::filesystem::path a_sources[3]);
+
+	// Decode the sources and pack them into a single RGBA8 level (1x1 when nothing is textured)
+	//	- Missing sources keep their default constant. Smaller sources are stretched to the largest
+	bool PackORM(const std::filesystem::path a_sources[3], TextureData& a_packed, ORMLayout& a_layout);
+
+	// Pack, build mips, compress (BC7, as the channels are unrelated) and write the packed texture
+	bool CookORM(const std::filesystem::path a_sources[3], const TextureCookSettings& a_settings, TextureCookResult& a_result, ORMLayout& a_layout);
+
+	// Read a packed texture written by CookORM
+	bool ReadORM(const std::filesystem::path& a_fileName, TextureData& a_packed, ORMLayout& a_layout);
+}
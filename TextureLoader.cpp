@@ -0,0 +1,625 @@
+#include "TextureLoader.h"
+#include "Helpers.h"
+#include "PngDecoder.h"
+#include "TextureCooker.h"
+#include "DDSFile.h"
+#include "BlockCompression.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Every thread that decodes needs COM. Workers live as long as the process, so it is never uninitialized
+	void EnsureCOMInitialized()
+	{
+		thread_local bool bInitialized = false;
+		if (!bInitialized) {
+			// Fails harmlessly with RPC_E_CHANGED_MODE on a thread that already picked an apartment
+			CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+			bInitialized = true;
+		}
+	}
+
+	// Uncompressed data matches what CreateWICTextureFromFile picked for these files. Block formats are UNORM too, as
+	// the shaders already decode gamma themselves
+	DXGI_FORMAT GetDXGIFormat(TextureFormat a_format)
+	{
+		switch (a_format) {
+		case TextureFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+		case TextureFormat::BC4: return DXGI_FORMAT_BC4_UNORM;
+		case TextureFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+		case TextureFormat::BC7: return DXGI_FORMAT_BC7_UNORM;
+		default: return DXGI_FORMAT_R8G8B8A8_UNORM;
+		}
+	}
+
+	// Streaming only pays off with levels above the tail, and every texture it builds must be a valid size for its
+	// format - block compressed textures need a multiple of 4 at their finest level
+	bool CanStream(const DDSTextureInfo& a_info)
+	{
+		unsigned int tail = TextureStreamer::ComputeTailMip(a_info.Width, a_info.Height, a_info.MipCount);
+		if (tail == 0)
+			return false;
+		if (a_info.Format == TextureFormat::RGBA8)
+			return true;
+		for (unsigned int mip = 0; mip <= tail; mip++) {
+			if (((a_info.Width >> mip) & 3) != 0 || ((a_info.Height >> mip) & 3) != 0)
+				return false;
+		}
+		return true;
+	}
+
+	// Hand a packed texture's layout to a Material, as its scalars and which channels to sample instead
+	void ApplyORMLayout(Material& a_material, const ORMLayout& a_layout)
+	{
+		a_material.SetORMChannels(
+			Vector3(a_layout.Constants[0], a_layout.Constants[1], a_layout.Constants[2]),
+			Vector3(a_layout.bTextured[0] ? 1.f : 0.f, a_layout.bTextured[1] ? 1.f : 0.f, a_layout.bTextured[2] ? 1.f : 0.f));
+	}
+
+	// Read and decode one image file into 8 bit RGBA. Grayscale, RGB and 16 bit files are all converted
+	//	- PNGs go through the portable decoder. WIC handles every other format, and any PNG it rejects
+	bool DecodeImage(IWICImagingFactory* a_factory, const std::wstring& a_filePath, TextureData& a_output)
+	{
+		std::filesystem::path path(a_filePath);
+		if (path.extension() == L".png" && PngDecoder::LoadFile(path, a_output))
+			return true;
+		if (a_factory == nullptr)
+			return false;
+
+		Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
+		if (FAILED(a_factory->CreateDecoderFromFilename(a_filePath.c_str(), nullptr, GENERIC_READ,
+			WICDecodeMetadataCacheOnDemand, decoder.GetAddressOf())))
+			return false;
+
+		Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
+		if (FAILED(decoder->GetFrame(0, frame.GetAddressOf())))
+			return false;
+
+		UINT width = 0;
+		UINT height = 0;
+		if (FAILED(frame->GetSize(&width, &height)) || width == 0 || height == 0 ||
+			width > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION || height > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION)
+			return false;
+
+		Microsoft::WRL::ComPtr<IWICFormatConverter> converter;
+		if (FAILED(a_factory->CreateFormatConverter(converter.GetAddressOf())) ||
+			FAILED(converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom)))
+			return false;
+
+		a_output.Mips.resize(1);
+		TextureMip& top = a_output.Mips[0];
+		top.Width = width;
+		top.Height = height;
+		top.Pixels.resize((size_t)width * height * 4);
+		return SUCCEEDED(converter->CopyPixels(nullptr, width * 4, (UINT)top.Pixels.size(), top.Pixels.data()));
+	}
+}
+
+// --------------------------------------------------------
+// Create the WIC factory the decode jobs share
+// --------------------------------------------------------
+TextureLoader::TextureLoader(Microsoft::WRL::ComPtr<ID3D11Device> a_device)
+	: m_device(a_device)
+{
+	EnsureCOMInitialized();
+	CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(m_wicFactory.GetAddressOf()));
+}
+
+// --------------------------------------------------------
+// Jobs write into the Requests, so they have to finish
+// before the Requests go away
+// --------------------------------------------------------
+TextureLoader::~TextureLoader()
+{
+	WaitAll();
+	for (unsigned int handle : m_streamLoads) {
+		JobSystem::GetInstance().Wait(m_requests[m_streamed[handle]]->StreamGroup);
+	}
+}
+
+// --------------------------------------------------------
+// Queue a single 2D texture
+// --------------------------------------------------------
+TextureRequest TextureLoader::Load(const std::wstring& a_filePath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_placeholder)
+{
+	return Queue({ FixPath(a_filePath) }, a_placeholder);
+}
+
+// --------------------------------------------------------
+// Queue the six faces of a cube map
+//	- Order matters here! +X, -X, +Y, -Y, +Z, -Z
+// --------------------------------------------------------
+TextureRequest TextureLoader::LoadCube(const std::wstring& a_folderPath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_placeholder)
+{
+	return Queue({
+		FixPath(a_folderPath + L"/right.png"),
+		FixPath(a_folderPath + L"/left.png"),
+		FixPath(a_folderPath + L"/up.png"),
+		FixPath(a_folderPath + L"/down.png"),
+		FixPath(a_folderPath + L"/front.png"),
+		FixPath(a_folderPath + L"/back.png") }, a_placeholder);
+}
+
+// --------------------------------------------------------
+// Start a decode job per file of a new Request
+// --------------------------------------------------------
+TextureRequest TextureLoader::Queue(std::vector<std::wstring> a_files, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_placeholder)
+{
+	TextureRequest handle = 0;
+	Request* request = &AddRequest(std::move(a_files), a_placeholder, handle);
+
+	// Only single textures get mips - cube faces are copied in as they are
+	bool bGenerateMips = (request->Files.size() == 1);
+	bool bStream = m_bStreaming && bGenerateMips;
+	IWICImagingFactory* factory = m_wicFactory.Get();
+	for (size_t i = 0; i < request->Files.size(); i++) {
+		JobSystem::GetInstance().Execute([request, i, bGenerateMips, bStream, factory]() {
+			EnsureCOMInitialized();
+			TextureData& image = request->Images[i];
+
+			// A cooked copy already holds every mip, so it's just read in. Streamed textures start with their tail.
+			// Cube faces only take uncompressed cooks, as older cooks block compressed them
+			std::filesystem::path file(request->Files[i]);
+			if (TextureCooker::IsUpToDate(file)) {
+				std::filesystem::path cooked = TextureCooker::GetCookedPath(file);
+				DDSTextureInfo& info = request->StreamInfo;
+				if (bStream && DDSFile::ReadTextureInfo(cooked, info) && CanStream(info)) {
+					unsigned int tail = TextureStreamer::ComputeTailMip(info.Width, info.Height, info.MipCount);
+					if (DDSFile::ReadTextureMips(cooked, tail, info.MipCount - tail, image)) {
+						request->FirstMip = tail;
+						request->bStreamed = true;
+						return;
+					}
+				}
+				if (DDSFile::ReadTexture(cooked, image) && (bGenerateMips || image.Format == TextureFormat::RGBA8)) {
+					if (!bGenerateMips)
+						image.Mips.resize(1);
+					return;
+				}
+				image = TextureData();
+			}
+
+			if (!DecodeImage(factory, request->Files[i], image)) {
+				request->bFailed = true;
+				image.Mips.clear();
+				return;
+			}
+			if (bGenerateMips)
+				TextureMips::Generate(image);
+		}, request->Group, JobPriority::Background);
+	}
+	return handle;
+}
+
+// --------------------------------------------------------
+// Queue the three maps of a packed texture as one job,
+// as they're only useful together
+// --------------------------------------------------------
+TextureRequest TextureLoader::LoadORM(const std::wstring& a_occlusionPath, const std::wstring& a_roughnessPath, const std::wstring& a_metalnessPath)
+{
+	std::vector<std::wstring> files;
+	for (const std::wstring* path : { &a_occlusionPath, &a_roughnessPath, &a_metalnessPath }) {
+		files.push_back(path->empty() ? std::wstring() : FixPath(*path));
+	}
+	TextureRequest handle = 0;
+	Request* request = &AddRequest(std::move(files), nullptr, handle);
+	request->Images.resize(1);
+	request->bPacked = true;
+
+	JobSystem::GetInstance().Execute([request]() {
+		std::filesystem::path sources[3] = { request->Files[0], request->Files[1], request->Files[2] };
+		TextureData& image = request->Images[0];
+		if (TextureCooker::IsPackedUpToDate(sources) && TextureCooker::ReadORM(TextureCooker::GetPackedPath(sources), image, request->Layout))
+			return;
+
+		if (!TextureCooker::PackORM(sources, image, request->Layout)) {
+			request->bFailed = true;
+			image.Mips.clear();
+			return;
+		}
+		TextureMips::Generate(image);
+	}, request->Group, JobPriority::Background);
+	return handle;
+}
+
+// --------------------------------------------------------
+// Register a new Request as pending
+// --------------------------------------------------------
+TextureLoader::Request& TextureLoader::AddRequest(std::vector<std::wstring> a_files, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_placeholder,
+	TextureRequest& a_handle)
+{
+	a_handle = (TextureRequest)m_requests.size();
+	m_requests.push_back(std::make_unique<Request>());
+	Request& request = *m_requests.back();
+	request.Files = std::move(a_files);
+	request.Images.resize(request.Files.size());
+	request.SRV = a_placeholder;
+	m_pending.push_back(a_handle);
+	return request;
+}
+
+// --------------------------------------------------------
+// Point a Material slot at the request's texture now and
+// after its upload
+// --------------------------------------------------------
+void TextureLoader::Bind(TextureRequest a_request, std::shared_ptr<Material> a_material, const std::string& a_name)
+{
+	Request& request = *m_requests[a_request];
+	a_material->SetTextureSRV(a_name, request.SRV);
+	if (!request.bUploaded || request.bStreamed)
+		request.Bindings.push_back({ a_material, a_name });
+	if (request.bUploaded && request.bStreamed)
+		m_materialStreams[a_material.get()].push_back(request.StreamHandle);
+}
+
+// --------------------------------------------------------
+// Bind a packed texture along with the constants for the
+// channels it doesn't hold
+// --------------------------------------------------------
+void TextureLoader::BindORM(TextureRequest a_request, std::shared_ptr<Material> a_material)
+{
+	Request& request = *m_requests[a_request];
+	Bind(a_request, a_material, "ORMTexture");
+	ApplyORMLayout(*a_material, request.bUploaded ? request.Layout : ORMLayout());
+}
+
+// --------------------------------------------------------
+// Drop a request's GPU and CPU data. It counts as
+// finished afterwards, with no SRV
+// --------------------------------------------------------
+void TextureLoader::Unload(TextureRequest a_request)
+{
+	Request& request = *m_requests[a_request];
+	JobSystem::GetInstance().Wait(request.Group);
+	m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), a_request), m_pending.end());
+
+	if (request.bStreamed) {
+		JobSystem::GetInstance().Wait(request.StreamGroup);
+		m_streamLoads.erase(std::remove(m_streamLoads.begin(), m_streamLoads.end(), request.StreamHandle), m_streamLoads.end());
+		m_streamer.RemoveTexture(request.StreamHandle);
+		for (auto& streams : m_materialStreams) {
+			std::vector<unsigned int>& handles = streams.second;
+			handles.erase(std::remove(handles.begin(), handles.end(), request.StreamHandle), handles.end());
+		}
+	}
+
+	request.bUploaded = true;
+	request.bStreamed = false;
+	request.SRV = nullptr;
+	request.Texture = nullptr;
+	request.Bytes = 0;
+	request.Bindings.clear();
+	request.Images.clear();
+	request.Images.shrink_to_fit();
+	request.StreamedLevel.Mips.clear();
+}
+
+// --------------------------------------------------------
+// Wait on just one request's decode jobs
+// --------------------------------------------------------
+void TextureLoader::Wait(TextureRequest a_request)
+{
+	JobSystem::GetInstance().Wait(m_requests[a_request]->Group);
+}
+
+// --------------------------------------------------------
+// Wait on every request still decoding
+// --------------------------------------------------------
+void TextureLoader::WaitAll()
+{
+	for (TextureRequest handle : m_pending) {
+		JobSystem::GetInstance().Wait(m_requests[handle]->Group);
+	}
+}
+
+// --------------------------------------------------------
+// Upload every request whose decodes have finished and
+// swap its SRV into the bound Materials
+//	- Requests still decoding stay pending for a later call
+// --------------------------------------------------------
+unsigned int TextureLoader::ProcessUploads()
+{
+	unsigned int uploaded = 0;
+	size_t kept = 0;
+	for (size_t i = 0; i < m_pending.size(); i++) {
+		Request& request = *m_requests[m_pending[i]];
+		if (request.Group.Remaining.load() > 0) {
+			m_pending[kept++] = m_pending[i];
+			continue;
+		}
+
+		if (!request.bFailed && Upload(request)) {
+			for (MaterialBinding& binding : request.Bindings) {
+				binding.Target->SetTextureSRV(binding.Name, request.SRV);
+				if (request.bPacked)
+					ApplyORMLayout(*binding.Target, request.Layout);
+			}
+			uploaded++;
+		}
+		else
+			request.bStreamed = false;
+
+		// Streamed textures keep their bindings, to patch every time a level comes or goes
+		if (request.bStreamed) {
+			const DDSTextureInfo& info = request.StreamInfo;
+			request.StreamHandle = m_streamer.AddTexture(info.Width, info.Height, info.MipCount, info.Format);
+			m_streamed.push_back(m_pending[i]);
+			for (MaterialBinding& binding : request.Bindings) {
+				m_materialStreams[binding.Target.get()].push_back(request.StreamHandle);
+			}
+		}
+		else
+			request.Bindings.clear();
+		request.bUploaded = true; // Failed requests are finished too, just with their placeholder
+		request.Images.clear();
+		request.Images.shrink_to_fit();
+	}
+	m_pending.resize(kept);
+	return uploaded;
+}
+
+// --------------------------------------------------------
+// Turn on streaming for every Load after this. Textures
+// already queued stay fully resident
+// --------------------------------------------------------
+void TextureLoader::EnableStreaming(const TextureStreamerSettings& a_settings)
+{
+	m_bStreaming = true;
+	m_streamer.SetSettings(a_settings);
+}
+
+// --------------------------------------------------------
+// Pass a Material's coverage on to every streamed texture
+// bound to it
+// --------------------------------------------------------
+void TextureLoader::ReportCoverage(const Material* a_material, float a_texels)
+{
+	auto streams = m_materialStreams.find(a_material);
+	if (streams == m_materialStreams.end())
+		return;
+	for (unsigned int handle : streams->second) {
+		m_streamer.ReportCoverage(handle, a_texels);
+	}
+}
+
+// --------------------------------------------------------
+// One frame of streaming
+//	- Levels that finished reading are added first, so the
+//	  streamer counts them before deciding anything new
+//	- Loads each read a single level on a worker. Evicted
+//	  textures are rebuilt once at the end, however many
+//	  levels they lost
+// --------------------------------------------------------
+void TextureLoader::UpdateStreaming()
+{
+	if (!m_bStreaming)
+		return;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	m_device->GetImmediateContext(context.GetAddressOf());
+
+	size_t kept = 0;
+	for (unsigned int handle : m_streamLoads) {
+		Request& request = *m_requests[m_streamed[handle]];
+		if (request.StreamGroup.Remaining.load() > 0) {
+			m_streamLoads[kept++] = handle;
+			continue;
+		}
+		bool bLoaded = !request.bStreamFailed && Restream(request, request.FirstMip - 1, context.Get());
+		m_streamer.CompleteLoad(handle, bLoaded);
+		request.StreamedLevel.Mips.clear();
+		request.StreamedLevel.Mips.shrink_to_fit();
+	}
+	m_streamLoads.resize(kept);
+
+	std::vector<unsigned int> evicted;
+	for (const TextureStreamStep& step : m_streamer.Update()) {
+		Request* request = m_requests[m_streamed[step.Texture]].get();
+		if (step.Type == TextureStreamStepType::Evict) {
+			if (std::find(evicted.begin(), evicted.end(), step.Texture) == evicted.end())
+				evicted.push_back(step.Texture);
+			continue;
+		}
+
+		unsigned int mip = step.Mip;
+		JobSystem::GetInstance().Execute([request, mip]() {
+			std::filesystem::path cooked = TextureCooker::GetCookedPath(std::filesystem::path(request->Files[0]));
+			if (!DDSFile::ReadTextureMips(cooked, mip, 1, request->StreamedLevel))
+				request->bStreamFailed = true;
+		}, request->StreamGroup, JobPriority::Background);
+		m_streamLoads.push_back(step.Texture);
+	}
+
+	// A rebuild that fails leaves the old texture bound, just using more memory than the streamer counts
+	for (unsigned int handle : evicted) {
+		Restream(*m_requests[m_streamed[handle]], m_streamer.GetResidentMip(handle), context.Get());
+	}
+}
+
+// --------------------------------------------------------
+// Create the immutable texture and SRV for one decoded
+// request. Replaces the placeholder SRV on success
+// --------------------------------------------------------
+bool TextureLoader::Upload(Request& a_request)
+{
+	// A packed texture whose channels are all constant is never sampled, so it isn't worth a texture
+	const ORMLayout& layout = a_request.Layout;
+	if (a_request.bPacked && !layout.bTextured[0] && !layout.bTextured[1] && !layout.bTextured[2]) {
+		a_request.SRV = nullptr;
+		return true;
+	}
+
+	const TextureData& first = a_request.Images[0];
+	bool bIsCube = (a_request.Images.size() == 6);
+	unsigned int mipCount = (unsigned int)first.Mips.size();
+
+	// All faces of a cube must match the first
+	for (const TextureData& image : a_request.Images) {
+		if (image.Mips.size() != mipCount || image.Format != first.Format ||
+			image.Mips[0].Width != first.Mips[0].Width || image.Mips[0].Height != first.Mips[0].Height)
+			return false;
+	}
+
+	// Initial data is ordered by array slice, then mip
+	std::vector<D3D11_SUBRESOURCE_DATA> initialData;
+	size_t bytes = 0;
+	for (const TextureData& image : a_request.Images) {
+		for (const TextureMip& mip : image.Mips) {
+			D3D11_SUBRESOURCE_DATA data = {};
+			data.pSysMem = mip.Pixels.data();
+			data.SysMemPitch = (UINT)BlockCompression::GetRowPitch(image.Format, mip.Width);
+			initialData.push_back(data);
+			bytes += mip.Pixels.size();
+		}
+	}
+
+	D3D11_TEXTURE2D_DESC desc = {};
+	desc.Width = first.Mips[0].Width;
+	desc.Height = first.Mips[0].Height;
+	desc.MipLevels = mipCount;
+	desc.ArraySize = (UINT)a_request.Images.size();
+	desc.Format = GetDXGIFormat(first.Format);
+	desc.SampleDesc.Count = 1;
+	desc.Usage = a_request.bStreamed ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE; // Streamed levels are copied out later
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	desc.MiscFlags = bIsCube ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+	if (FAILED(m_device->CreateTexture2D(&desc, initialData.data(), texture.GetAddressOf())))
+		return false;
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = desc.Format;
+	if (bIsCube) {
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+		srvDesc.TextureCube.MipLevels = mipCount;
+	}
+	else {
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels = mipCount;
+	}
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+	if (FAILED(m_device->CreateShaderResourceView(texture.Get(), &srvDesc, srv.GetAddressOf())))
+		return false;
+
+	a_request.SRV = srv;
+	a_request.Bytes = bytes;
+	if (a_request.bStreamed)
+		a_request.Texture = texture;
+	return true;
+}
+
+// --------------------------------------------------------
+// Replace a streamed texture with one holding the levels
+// from a_firstMip on
+//	- Levels both textures have are copied on the GPU
+//	- Growing by one level takes it from StreamedLevel
+//	- Bound Materials get the new SRV
+// --------------------------------------------------------
+bool TextureLoader::Restream(Request& a_request, unsigned int a_firstMip, ID3D11DeviceContext* a_context)
+{
+	const DDSTextureInfo& info = a_request.StreamInfo;
+	if (a_firstMip >= info.MipCount || a_firstMip == a_request.FirstMip)
+		return a_firstMip == a_request.FirstMip;
+
+	D3D11_TEXTURE2D_DESC desc = {};
+	desc.Width = std::max(info.Width >> a_firstMip, 1u);
+	desc.Height = std::max(info.Height >> a_firstMip, 1u);
+	desc.MipLevels = info.MipCount - a_firstMip;
+	desc.ArraySize = 1;
+	desc.Format = GetDXGIFormat(info.Format);
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_DEFAULT;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	const TextureMip* newLevel = nullptr;
+	if (a_firstMip < a_request.FirstMip) {
+		const TextureData& level = a_request.StreamedLevel;
+		if (a_firstMip + 1 != a_request.FirstMip || level.Mips.size() != 1 || level.Format != info.Format ||
+			level.Mips[0].Width != desc.Width || level.Mips[0].Height != desc.Height)
+			return false;
+		newLevel = &level.Mips[0];
+	}
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+	if (FAILED(m_device->CreateTexture2D(&desc, nullptr, texture.GetAddressOf())))
+		return false;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+	if (FAILED(m_device->CreateShaderResourceView(texture.Get(), nullptr, srv.GetAddressOf())))
+		return false;
+
+	for (unsigned int mip = std::max(a_firstMip, a_request.FirstMip); mip < info.MipCount; mip++) {
+		a_context->CopySubresourceRegion(texture.Get(), mip - a_firstMip, 0, 0, 0, a_request.Texture.Get(), mip - a_request.FirstMip, nullptr);
+	}
+	if (newLevel != nullptr)
+		a_context->UpdateSubresource(texture.Get(), 0, nullptr, newLevel->Pixels.data(), (UINT)BlockCompression::GetRowPitch(info.Format, newLevel->Width), 0);
+
+	a_request.Texture = texture;
+	a_request.SRV = srv;
+	a_request.FirstMip = a_firstMip;
+	for (MaterialBinding& binding : a_request.Bindings) {
+		binding.Target->SetTextureSRV(binding.Name, srv);
+	}
+	return true;
+}
+
+// --------------------------------------------------------
+// Make a 1x1 texture of a single color
+// --------------------------------------------------------
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> TextureLoader::CreateSolidColor(Color a_color)
+{
+	auto toByte = [](float a_value) {
+		a_value = (a_value < 0.f) ? 0.f : (a_value > 1.f) ? 1.f : a_value;
+		return (uint8_t)(a_value * 255.f + 0.5f);
+	};
+	uint8_t pixel[4] = { toByte(a_color.x), toByte(a_color.y), toByte(a_color.z), toByte(a_color.w) };
+
+	D3D11_TEXTURE2D_DESC desc = {};
+	desc.Width = 1;
+	desc.Height = 1;
+	desc.MipLevels = 1;
+	desc.ArraySize = 1;
+	desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	desc.SampleDesc.Count = 1;
+	desc.Usage = D3D11_USAGE_IMMUTABLE;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	D3D11_SUBRESOURCE_DATA data = {};
+	data.pSysMem = pixel;
+	data.SysMemPitch = 4;
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+	if (SUCCEEDED(m_device->CreateTexture2D(&desc, &data, texture.GetAddressOf())))
+		m_device->CreateShaderResourceView(texture.Get(), nullptr, srv.GetAddressOf());
+	return srv;
+}
+
+// --------------------------------------------------------
+// Getters
+// --------------------------------------------------------
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> TextureLoader::GetSRV(TextureRequest a_request)
+{
+	return m_requests[a_request]->SRV;
+}
+
+bool TextureLoader::IsFinished(TextureRequest a_request)
+{
+	return m_requests[a_request]->bUploaded;
+}
+
+unsigned int TextureLoader::GetPendingCount()
+{
+	return (unsigned int)m_pending.size();
+}
+
+size_t TextureLoader::GetGPUBytes(TextureRequest a_request)
+{
+	const Request& request = *m_requests[a_request];
+	if (!request.bUploaded)
+		return 0;
+	return request.bStreamed ? m_streamer.GetResidentBytes(request.StreamHandle) : request.Bytes;
+}
+
+const TextureStreamer& TextureLoader::GetStreamer()
+{
+	return m_streamer;
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <wrl/client.h>
+#include <d3d11.h>
+#include <wincodec.h>
+
+#include "JobSystem.h"
+#include "DDSFile.h"
+#include "TextureCooker.h"
+#include "TextureMips.h"
+#include "TextureStreamer.h"
+#include "Material.h"
+#include "Types.h"
+
+// Identifies one queued texture. Stays valid for the lifetime of the TextureLoader
+typedef unsigned int TextureRequest;
+
+//-------------------------------------------------------
+// Loads textures in the background, so startup is bound
+// by the number of cores rather than the number of files
+//	- Load and LoadCube return immediately. Files are read
+//	  and decoded on the JobSystem's workers (PngDecoder,
+//	  or WIC for anything else), and 2D textures get their
+//	  mip chain built there as well. These are background
+//	  jobs, so a frame's own jobs never queue behind them
+//	- When a file has an up to date cooked copy (see
+//	  TextureCooker) that is read instead, mips and all,
+//	  and uploaded in whatever block format it was cooked
+//	- LoadORM packs occlusion, roughness and metalness
+//	  maps into one texture, or reads the cooker's packed
+//	  copy. BindORM gives Materials its constant channels
+//	  as scalars, and no texture at all when every
+//	  channel is constant
+//	- ProcessUploads runs on the render thread, creating
+//	  immutable GPU textures (all mips as initial data) for
+//	  every finished decode in one go
+//	- Until then, GetSRV and every Bind target hold the
+//	  request's placeholder, which is swapped for the real
+//	  SRV on upload. A file that fails to load keeps its
+//	  placeholder for good
+//	- With streaming enabled, 2D textures with an up to
+//	  date cooked copy upload just their mip tail. Each
+//	  frame, ReportCoverage says how much of each Material
+//	  is on screen, and UpdateStreaming reads the levels a
+//	  TextureStreamer asks for on workers, rebuilding the
+//	  texture with one more (or fewer) levels and patching
+//	  its bindings. Uncooked textures can't be read a level
+//	  at a time, so they stay fully resident
+//-------------------------------------------------------
+class TextureLoader
+{
+public:
+	TextureLoader(Microsoft::WRL::ComPtr<ID3D11Device> a_device);
+	~TextureLoader(); // Waits for any decodes still running
+
+	// Queue a 2D texture. a_filePath is fixed using FixPath()
+	TextureRequest Load(const std::wstring& a_filePath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_placeholder);
+
+	// Queue a cube map from a folder containing "right", "left", "up", "down", "front" and "back" .pngs
+	//	- Faces decode in parallel and keep a single mip, as the sky doesn't need more
+	TextureRequest LoadCube(const std::wstring& a_folderPath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_placeholder);
+
+	// Queue occlusion, roughness and metalness maps packed into one texture (see TextureCooker::PackORM). Paths are
+	// fixed using FixPath(), and may be empty or missing to keep that channel's default
+	//	- A packed copy written by the cooker is read when up to date, otherwise the maps are packed on a worker
+	//	- Until upload there's no SRV at all, and the default constants stand in for every channel
+	TextureRequest LoadORM(const std::wstring& a_occlusionPath, const std::wstring& a_roughnessPath, const std::wstring& a_metalnessPath);
+
+	// Set a_name on a_material to the request's current SRV, and again when the texture is uploaded
+	void Bind(TextureRequest a_request, std::shared_ptr<Material> a_material, const std::string& a_name);
+
+	// Bind a LoadORM request's texture as "ORMTexture", and its constant channels as a_material's scalars
+	void BindORM(TextureRequest a_request, std::shared_ptr<Material> a_material);
+
+	// Free a request's texture, after finishing any work on it. Materials keep whatever SRV they were last given
+	void Unload(TextureRequest a_request);
+
+	// Block until a request has decoded (running its own queued jobs meanwhile). It still needs ProcessUploads
+	void Wait(TextureRequest a_request);
+	void WaitAll();
+
+	// Create the GPU textures for finished decodes and patch their bindings. Render thread only
+	//	- Returns the number of textures uploaded
+	unsigned int ProcessUploads();
+
+	// Stream the mips of textures loaded from now on, within a_settings.BudgetBytes
+	void EnableStreaming(const TextureStreamerSettings& a_settings);
+
+	// Texels one visible use of a_material needs this frame (see TextureStreamer::ReportCoverage)
+	void ReportCoverage(const Material* a_material, float a_texels);
+
+	// Swap in streamed levels that finished reading, then start this frame's loads and evictions. Render thread only
+	void UpdateStreaming();
+
+	// 1x1 texture for placeholders and constant material channels
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> CreateSolidColor(Color a_color);
+
+	// Getters
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> GetSRV(TextureRequest a_request); // Placeholder until uploaded
+	bool IsFinished(TextureRequest a_request); // Uploaded, or failed and keeping its placeholder
+	unsigned int GetPendingCount(); // Queued or decoded but not yet uploaded
+	size_t GetGPUBytes(TextureRequest a_request); // Texture memory it holds now, or 0 before upload
+	const TextureStreamer& GetStreamer(); // Residency and budget, for stats
+
+private:
+	struct MaterialBinding {
+		std::shared_ptr<Material> Target;
+		std::string Name;
+	};
+
+	struct Request {
+		std::vector<std::wstring> Files; // One, six cube faces in D3D order, or the three sources of a packed texture
+		std::vector<TextureData> Images; // Matches Files. Freed after upload
+		std::atomic<bool> bFailed{ false };
+		JobGroup Group; // Finished decoding once empty
+		bool bUploaded = false;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> SRV;
+		size_t Bytes = 0; // Of the uploaded texture. Streamed ones ask m_streamer instead
+		std::vector<MaterialBinding> Bindings;
+		bool bPacked = false; // From LoadORM, so Images holds the single packed texture
+		ORMLayout Layout; // Packed requests only. Written by the job
+
+		// Streaming. Images holds levels from FirstMip on, and Bindings are kept so the SRV can change again
+		bool bStreamed = false; // Written by the job
+		DDSTextureInfo StreamInfo; // The whole cooked file
+		unsigned int FirstMip = 0; // Finest level in Texture
+		unsigned int StreamHandle = 0; // Index into m_streamer
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> Texture;
+		TextureData StreamedLevel; // Level FirstMip - 1 while a load is running
+		std::atomic<bool> bStreamFailed{ false };
+		JobGroup StreamGroup;
+	};
+
+	Request& AddRequest(std::vector<std::wstring> a_files, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_placeholder, TextureRequest& a_handle);
+	TextureRequest Queue(std::vector<std::wstring> a_files, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_placeholder);
+	bool Upload(Request& a_request);
+	bool Restream(Request& a_request, unsigned int a_firstMip, ID3D11DeviceContext* a_context);
+
+	Microsoft::WRL::ComPtr<ID3D11Device> m_device;
+	Microsoft::WRL::ComPtr<IWICImagingFactory> m_wicFactory; // Free threaded, shared by every non-PNG decode job
+
+	std::vector<std::unique_ptr<Request>> m_requests; // Indexed by TextureRequest, so jobs can hold a stable pointer
+	std::vector<TextureRequest> m_pending; // Not yet uploaded, in submission order
+
+	bool m_bStreaming = false;
+	TextureStreamer m_streamer;
+	std::vector<TextureRequest> m_streamed; // Indexed by stream handle
+	std::vector<unsigned int> m_streamLoads; // Stream handles with a level being read
+	std::unordered_map<const Material*, std::vector<unsigned int>> m_materialStreams; // Stream handles each Material samples
+};
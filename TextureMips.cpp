@@ -0,0 +1,270 @@
+#include "TextureMips.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	//-------------------------------------------
+	// Separable resampling of float RGBA images
+	//-------------------------------------------
+
+	// The source texels and weights that make up each destination texel along one axis
+	struct AxisFilter {
+		std::vector<unsigned int> Offsets; // Destination texel i uses taps Offsets[i] to Offsets[i + 1]
+		std::vector<unsigned int> Indices; // Source texel per tap, already wrapped or clamped
+		std::vector<float> Weights; // Normalized per destination texel
+	};
+
+	// Modified Bessel function of the first kind, order 0, by its power series
+	float Bessel0(float a_x)
+	{
+		float half = a_x * 0.5f;
+		float sum = 1.f;
+		float term = 1.f;
+		for (int k = 1; k < 32 && term > sum * 1e-8f; k++) {
+			float factor = half / (float)k;
+			term *= factor * factor;
+			sum += term;
+		}
+		return sum;
+	}
+
+	// Kaiser windowed sinc, a_x in destination texels
+	float Kaiser(float a_x)
+	{
+		if (std::fabs(a_x) >= MIP_KAISER_WIDTH)
+			return 0.f;
+		const float pi = 3.14159265358979f;
+		float sinc = (a_x == 0.f) ? 1.f : std::sin(pi * a_x) / (pi * a_x);
+		float t = a_x / MIP_KAISER_WIDTH;
+		return sinc * Bessel0(MIP_KAISER_ALPHA * std::sqrt(1.f - t * t)) / Bessel0(MIP_KAISER_ALPHA);
+	}
+
+	AxisFilter BuildAxisFilter(unsigned int a_sourceSize, unsigned int a_size, MipFilter a_filter, bool a_bWrap)
+	{
+		AxisFilter axis;
+		auto addTap = [&](int a_index, float a_weight) {
+			unsigned int size = a_sourceSize;
+			unsigned int index = a_bWrap ? (unsigned int)(((a_index % (int)size) + (int)size) % (int)size)
+				: (unsigned int)std::min(std::max(a_index, 0), (int)size - 1);
+			axis.Indices.push_back(index);
+			axis.Weights.push_back(a_weight);
+		};
+
+		for (unsigned int x = 0; x < a_size; x++) {
+			axis.Offsets.push_back((unsigned int)axis.Weights.size());
+			if (a_sourceSize == a_size) {
+				addTap((int)x, 1.f); // A 1 texel side stays as it is
+			}
+			else if (a_filter == MipFilter::Box) {
+				// The same texels the 8 bit Generate averages, repeating the last one past an odd edge
+				addTap((int)x * 2, 0.5f);
+				addTap((int)std::min(x * 2 + 1, a_sourceSize - 1), 0.5f);
+			}
+			else {
+				// Every source texel whose centre falls within the kernel's radius, scaled into source texels
+				float scale = (float)a_sourceSize / (float)a_size;
+				float centre = ((float)x + 0.5f) * scale;
+				float radius = MIP_KAISER_WIDTH * scale;
+				int first = (int)std::ceil(centre - radius - 0.5f);
+				int last = (int)std::floor(centre + radius - 0.5f);
+				size_t start = axis.Weights.size();
+				float total = 0.f;
+				for (int i = first; i <= last; i++) {
+					float weight = Kaiser(((float)i + 0.5f - centre) / scale);
+					addTap(i, weight);
+					total += weight;
+				}
+				for (size_t i = start; i < axis.Weights.size(); i++) {
+					axis.Weights[i] /= total;
+				}
+			}
+		}
+		axis.Offsets.push_back((unsigned int)axis.Weights.size());
+		return axis;
+	}
+
+	// Resample a_source (a_width x a_height RGBA floats) to a_destination, rows first and then columns
+	void Resample(const std::vector<float>& a_source, unsigned int a_width, unsigned int a_height,
+		const AxisFilter& a_horizontal, const AxisFilter& a_vertical, std::vector<float>& a_scratch, std::vector<float>& a_destination)
+	{
+		unsigned int width = (unsigned int)a_horizontal.Offsets.size() - 1;
+		unsigned int height = (unsigned int)a_vertical.Offsets.size() - 1;
+
+		a_scratch.assign((size_t)width * a_height * 4, 0.f);
+		for (unsigned int y = 0; y < a_height; y++) {
+			const float* row = &a_source[(size_t)y * a_width * 4];
+			float* out = &a_scratch[(size_t)y * width * 4];
+			for (unsigned int x = 0; x < width; x++) {
+				for (unsigned int tap = a_horizontal.Offsets[x]; tap < a_horizontal.Offsets[x + 1]; tap++) {
+					const float* texel = row + (size_t)a_horizontal.Indices[tap] * 4;
+					float weight = a_horizontal.Weights[tap];
+					out[x * 4] += texel[0] * weight;
+					out[x * 4 + 1] += texel[1] * weight;
+					out[x * 4 + 2] += texel[2] * weight;
+					out[x * 4 + 3] += texel[3] * weight;
+				}
+			}
+		}
+
+		// Whole rows at a time, so both images are walked in order
+		a_destination.assign((size_t)width * height * 4, 0.f);
+		for (unsigned int y = 0; y < height; y++) {
+			float* out = &a_destination[(size_t)y * width * 4];
+			for (unsigned int tap = a_vertical.Offsets[y]; tap < a_vertical.Offsets[y + 1]; tap++) {
+				const float* row = &a_scratch[(size_t)a_vertical.Indices[tap] * width * 4];
+				float weight = a_vertical.Weights[tap];
+				for (unsigned int i = 0; i < width * 4; i++) {
+					out[i] += row[i] * weight;
+				}
+			}
+		}
+	}
+
+	//-------------------------------------------
+	// Conversion between stored bytes and values
+	// that can be averaged
+	//-------------------------------------------
+
+	void DecodeLevel(const TextureMip& a_mip, TextureUsage a_usage, std::vector<float>& a_output)
+	{
+		static const std::vector<float> s_gammaToLinear = []() {
+			std::vector<float> table(256);
+			for (unsigned int i = 0; i < 256; i++) {
+				table[i] = std::pow((float)i / 255.f, 2.2f);
+			}
+			return table;
+		}();
+
+		a_output.resize(a_mip.Pixels.size());
+		for (size_t i = 0; i < a_mip.Pixels.size(); i += 4) {
+			for (size_t c = 0; c < 3; c++) {
+				uint8_t value = a_mip.Pixels[i + c];
+				a_output[i + c] = (a_usage == TextureUsage::Color) ? s_gammaToLinear[value]
+					: (a_usage == TextureUsage::Normal) ? (float)value / 127.5f - 1.f
+					: (float)value / 255.f;
+			}
+			a_output[i + 3] = (float)a_mip.Pixels[i + 3] / 255.f;
+		}
+	}
+
+	uint8_t ToByte(float a_value)
+	{
+		a_value = (a_value < 0.f) ? 0.f : (a_value > 1.f) ? 1.f : a_value; // Kaiser's negative lobes can overshoot
+		return (uint8_t)(a_value * 255.f + 0.5f);
+	}
+
+	void EncodeLevel(const std::vector<float>& a_values, TextureUsage a_usage, TextureMip& a_mip)
+	{
+		a_mip.Pixels.resize(a_values.size());
+		for (size_t i = 0; i < a_values.size(); i += 4) {
+			const float* texel = &a_values[i];
+			uint8_t* out = &a_mip.Pixels[i];
+			if (a_usage == TextureUsage::Normal) {
+				// Averaged normals get shorter where they disagree. Point straight out if they cancel entirely
+				float length = std::sqrt(texel[0] * texel[0] + texel[1] * texel[1] + texel[2] * texel[2]);
+				float normal[3] = { 0.f, 0.f, 1.f };
+				if (length > 1e-6f) {
+					normal[0] = texel[0] / length;
+					normal[1] = texel[1] / length;
+					normal[2] = texel[2] / length;
+				}
+				for (size_t c = 0; c < 3; c++) {
+					out[c] = ToByte(normal[c] * 0.5f + 0.5f);
+				}
+			}
+			else if (a_usage == TextureUsage::Color) {
+				for (size_t c = 0; c < 3; c++) {
+					out[c] = ToByte(std::pow(texel[c] > 0.f ? texel[c] : 0.f, 1.f / 2.2f));
+				}
+			}
+			else {
+				for (size_t c = 0; c < 3; c++) {
+					out[c] = ToByte(texel[c]);
+				}
+			}
+			out[3] = ToByte(texel[3]);
+		}
+	}
+}
+
+//-----------------------------------------------
+// Halve the larger side until both reach 1
+//-----------------------------------------------
+unsigned int TextureMips::GetMipCount(unsigned int a_width, unsigned int a_height)
+{
+	unsigned int count = 1;
+	while (a_width > 1 || a_height > 1) {
+		a_width = (a_width > 1) ? a_width / 2 : 1;
+		a_height = (a_height > 1) ? a_height / 2 : 1;
+		count++;
+	}
+	return count;
+}
+
+//-----------------------------------------------
+// Box filter each level from the previous one
+//-----------------------------------------------
+void TextureMips::Generate(TextureData& a_texture)
+{
+	if (a_texture.Mips.empty() || a_texture.Format != TextureFormat::RGBA8)
+		return;
+
+	unsigned int count = GetMipCount(a_texture.Mips[0].Width, a_texture.Mips[0].Height);
+	a_texture.Mips.resize(count);
+	for (unsigned int level = 1; level < count; level++) {
+		const TextureMip& source = a_texture.Mips[level - 1];
+		TextureMip& mip = a_texture.Mips[level];
+		mip.Width = (source.Width > 1) ? source.Width / 2 : 1;
+		mip.Height = (source.Height > 1) ? source.Height / 2 : 1;
+		mip.Pixels.resize((size_t)mip.Width * mip.Height * 4);
+
+		for (unsigned int y = 0; y < mip.Height; y++) {
+			// Clamp the second row/column for 1 texel wide sources
+			unsigned int top = y * 2;
+			unsigned int bottom = (top + 1 < source.Height) ? top + 1 : top;
+			const uint8_t* row0 = &source.Pixels[(size_t)top * source.Width * 4];
+			const uint8_t* row1 = &source.Pixels[(size_t)bottom * source.Width * 4];
+			uint8_t* out = &mip.Pixels[(size_t)y * mip.Width * 4];
+			for (unsigned int x = 0; x < mip.Width; x++) {
+				unsigned int left = x * 2 * 4;
+				unsigned int right = (x * 2 + 1 < source.Width) ? left + 4 : left;
+				for (unsigned int c = 0; c < 4; c++) {
+					unsigned int sum = row0[left + c] + row0[right + c] + row1[left + c] + row1[right + c];
+					out[x * 4 + c] = (uint8_t)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+}
+
+//-----------------------------------------------
+// Filter each level from the float values of the
+// previous one, only rounding to bytes for output
+//-----------------------------------------------
+void TextureMips::Generate(TextureData& a_texture, const MipSettings& a_settings)
+{
+	if (a_texture.Mips.empty() || a_texture.Format != TextureFormat::RGBA8)
+		return;
+
+	unsigned int count = GetMipCount(a_texture.Mips[0].Width, a_texture.Mips[0].Height);
+	a_texture.Mips.resize(count);
+
+	std::vector<float> current;
+	std::vector<float> next;
+	std::vector<float> scratch;
+	DecodeLevel(a_texture.Mips[0], a_settings.Usage, current);
+	for (unsigned int level = 1; level < count; level++) {
+		const TextureMip& source = a_texture.Mips[level - 1];
+		TextureMip& mip = a_texture.Mips[level];
+		mip.Width = (source.Width > 1) ? source.Width / 2 : 1;
+		mip.Height = (source.Height > 1) ? source.Height / 2 : 1;
+
+		AxisFilter horizontal = BuildAxisFilter(source.Width, mip.Width, a_settings.Filter, a_settings.bWrap);
+		AxisFilter vertical = BuildAxisFilter(source.Height, mip.Height, a_settings.Filter, a_settings.bWrap);
+		Resample(current, source.Width, source.Height, horizontal, vertical, scratch, next);
+		EncodeLevel(next, a_settings.Usage, mip);
+		current.swap(next);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define MIP_KAISER_WIDTH 3.f // Kaiser filter radius, in destination texels
+#define MIP_KAISER_ALPHA 4.f // Kaiser window shape. Higher trades sharpness for less ringing
+
+// How a TextureData's levels are stored
+enum class TextureFormat {
+	RGBA8, // 4 bytes per texel
+	BC1, // 8 bytes per 4x4 block, opaque RGB
+	BC4, // 8 bytes per 4x4 block, R only
+	BC5, // 16 bytes per 4x4 block, R and G
+	BC7 // 16 bytes per 4x4 block, RGBA
+};
+
+//-------------------------------------------------------
+// One level of an image, rows tightly packed
+//-------------------------------------------------------
+struct TextureMip {
+	unsigned int Width = 0; // In texels, even for block compressed levels
+	unsigned int Height = 0;
+	std::vector<uint8_t> Pixels; // Width * Height * 4 bytes for RGBA8, otherwise whole blocks (see BlockCompression)
+};
+
+//-------------------------------------------------------
+// An image held on the CPU, either just its top level or
+// its full mip chain, ready to be uploaded as the
+// initial data of a texture
+//-------------------------------------------------------
+struct TextureData {
+	TextureFormat Format = TextureFormat::RGBA8;
+	std::vector<TextureMip> Mips;
+};
+
+// How a texture's mips are filtered
+enum class MipFilter {
+	Box, // 2x2 average, as GenerateMips does
+	Kaiser // Kaiser windowed sinc, sharper mips with little aliasing
+};
+
+// What a texture's channels hold, which decides how they are averaged
+enum class TextureUsage {
+	Color, // Gamma encoded RGB (pow 2.2, as PixelShader decodes albedo) with linear alpha
+	Data, // Linear values such as roughness and metalness
+	Normal // Tangent space normals packed to [0, 1], renormalized in every mip
+};
+
+//-------------------------------------------------------
+// Options for the offline quality path of TextureMips
+//-------------------------------------------------------
+struct MipSettings {
+	MipFilter Filter = MipFilter::Kaiser;
+	TextureUsage Usage = TextureUsage::Color;
+	bool bWrap = true; // Filter across edges as a tiling texture, matching the Wrap samplers
+};
+
+//-------------------------------------------------------
+// CPU mip chain generation, so mips can be built on the
+// thread that decoded the image instead of by the GPU
+// after upload
+//	- Each level averages 2x2 blocks of the one above it
+//	  (odd edges repeat their last row or column), which
+//	  is what GenerateMips does for UNORM formats
+//	- The MipSettings overload is the slower offline path
+//	  the texture cooker uses. It filters in linear space
+//	  (decoding gamma first), keeps every level in float
+//	  so rounding doesn't build up down the chain, and
+//	  renormalizes normal maps after filtering
+//-------------------------------------------------------
+namespace TextureMips
+{
+	// Levels in a full chain down to 1x1
+	unsigned int GetMipCount(unsigned int a_width, unsigned int a_height);
+
+	// Replace everything below Mips[0] with a full chain. RGBA8 textures only
+	void Generate(TextureData& a_texture);
+	void Generate(TextureData& a_texture, const MipSettings& a_settings);
+}
@@ -0,0 +1,325 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "BlockCompression.h"
+
+namespace
+{
+	// Heap order putting the level to evict first on top: least useful, then least recently seen
+	struct EvictLater {
+		template<typename T>
+		bool operator()(const T& a_left, const T& a_right) const
+		{
+			if (a_left.Usefulness != a_right.Usefulness)
+				return a_left.Usefulness > a_right.Usefulness;
+			return a_left.LastVisibleFrame > a_right.LastVisibleFrame;
+		}
+	};
+}
+
+//-------------------------------------------------------
+// Starts with no textures
+//-------------------------------------------------------
+TextureStreamer::TextureStreamer(const TextureStreamerSettings& a_settings)
+	: m_settings(a_settings)
+{
+}
+
+//-------------------------------------------------------
+// Registers a texture. Indices are stable and never
+// reused. The tail counts against the budget like any
+// other resident level
+//-------------------------------------------------------
+unsigned int TextureStreamer::AddTexture(unsigned int a_width, unsigned int a_height, unsigned int a_mipCount, TextureFormat a_format)
+{
+	TextureState texture;
+	texture.Width = std::max(a_width, 1u);
+	texture.Height = std::max(a_height, 1u);
+	texture.MipCount = std::max(a_mipCount, 1u);
+	texture.Format = a_format;
+	texture.TailMip = ComputeTailMip(texture.Width, texture.Height, texture.MipCount);
+	texture.ResidentMip = texture.TailMip;
+	texture.WantedMip = texture.TailMip;
+	m_textures.push_back(texture);
+
+	unsigned int index = (unsigned int)m_textures.size() - 1;
+	m_residentBytes += GetResidentBytes(index);
+	return index;
+}
+
+unsigned int TextureStreamer::GetTailMip(unsigned int a_texture) const
+{
+	return m_textures[a_texture].TailMip;
+}
+
+unsigned int TextureStreamer::GetResidentMip(unsigned int a_texture) const
+{
+	return m_textures[a_texture].ResidentMip;
+}
+
+unsigned int TextureStreamer::GetWantedMip(unsigned int a_texture) const
+{
+	return m_textures[a_texture].WantedMip;
+}
+
+//-------------------------------------------------------
+// The largest use picks the level, since that's where
+// detail would be missed. Every use adds to priority
+//-------------------------------------------------------
+void TextureStreamer::ReportCoverage(unsigned int a_texture, float a_texels)
+{
+	TextureState& texture = m_textures[a_texture];
+	if (!(a_texels > 0.f) || texture.ResidentMip >= texture.MipCount)
+		return;
+	texture.MaxTexels = std::max(texture.MaxTexels, a_texels);
+	texture.Priority += a_texels;
+}
+
+//-------------------------------------------------------
+// Picks this frame's loads and evictions
+//	- Wanted levels come from the reports since the last
+//	  update. Unreported textures want only their tail
+//	- While over budget (after a budget change, say) the
+//	  least useful levels go regardless
+//	- Each texture not already loading offers the level
+//	  above its finest resident one, most useful first.
+//	  Where there isn't room, strictly less useful levels
+//	  are evicted for it, but only if that frees enough -
+//	  otherwise nothing is touched, so levels aren't
+//	  dropped for a load that can't happen
+//	- Textures with a load in flight keep their levels,
+//	  and loads in flight already count against the budget
+//-------------------------------------------------------
+const std::vector<TextureStreamStep>& TextureStreamer::Update()
+{
+	m_steps.clear();
+	m_frame++;
+	m_stats = TextureStreamerStats();
+
+	for (TextureState& texture : m_textures) {
+		if (texture.Priority > 0.f) {
+			double levels = 0.5 * std::log2((double)texture.Width * texture.Height / texture.MaxTexels) + m_settings.MipBias;
+			texture.WantedMip = (unsigned int)std::min(std::max(std::floor(levels), 0.0), (double)texture.TailMip);
+			texture.LastVisibleFrame = m_frame;
+		}
+		else
+			texture.WantedMip = texture.TailMip;
+	}
+
+	m_evictions.clear();
+	for (unsigned int i = 0; i < m_textures.size(); i++) {
+		PushEviction(i);
+	}
+
+	// Pops the next valid eviction candidate, skipping entries made stale by loads or earlier evictions
+	auto popEviction = [this](Candidate& a_candidate) {
+		while (!m_evictions.empty()) {
+			std::pop_heap(m_evictions.begin(), m_evictions.end(), EvictLater());
+			a_candidate = m_evictions.back();
+			m_evictions.pop_back();
+			const TextureState& texture = m_textures[a_candidate.Texture];
+			if (!texture.bLoading && texture.ResidentMip == a_candidate.Mip)
+				return true;
+		}
+		return false;
+	};
+	auto evict = [this](const Candidate& a_candidate) {
+		TextureState& texture = m_textures[a_candidate.Texture];
+		m_residentBytes -= GetLevelBytes(a_candidate.Texture, texture.ResidentMip);
+		m_steps.push_back({ TextureStreamStepType::Evict, a_candidate.Texture, texture.ResidentMip });
+		texture.ResidentMip++;
+		m_stats.Evictions++;
+		PushEviction(a_candidate.Texture);
+	};
+
+	Candidate candidate;
+	while (m_residentBytes + m_loadingBytes > m_settings.BudgetBytes && popEviction(candidate)) {
+		evict(candidate);
+	}
+
+	m_loads.clear();
+	for (unsigned int i = 0; i < m_textures.size(); i++) {
+		const TextureState& texture = m_textures[i];
+		if (texture.bLoading || texture.bFailed || texture.ResidentMip <= texture.WantedMip)
+			continue;
+		float usefulness = GetUsefulness(texture, texture.ResidentMip - 1);
+		if (usefulness > 0.f)
+			m_loads.push_back({ usefulness, texture.LastVisibleFrame, i, texture.ResidentMip - 1 });
+	}
+	std::sort(m_loads.begin(), m_loads.end(), [](const Candidate& a_left, const Candidate& a_right) {
+		return a_left.Usefulness > a_right.Usefulness;
+	});
+
+	std::vector<Candidate> freed;
+	for (const Candidate& load : m_loads) {
+		if (m_loadsInFlight >= m_settings.MaxLoadsInFlight)
+			break;
+		TextureState& texture = m_textures[load.Texture];
+		if (texture.ResidentMip != load.Mip + 1)
+			continue;
+
+		size_t bytes = GetLevelBytes(load.Texture, load.Mip);
+		size_t used = m_residentBytes + m_loadingBytes + bytes;
+		freed.clear();
+		while (used > m_settings.BudgetBytes && popEviction(candidate)) {
+			if (candidate.Usefulness >= load.Usefulness) {
+				m_evictions.push_back(candidate);
+				std::push_heap(m_evictions.begin(), m_evictions.end(), EvictLater());
+				break;
+			}
+			freed.push_back(candidate);
+			size_t levelBytes = GetLevelBytes(candidate.Texture, candidate.Mip);
+			used = used > levelBytes ? used - levelBytes : 0;
+		}
+
+		if (used > m_settings.BudgetBytes) {
+			for (const Candidate& restore : freed) {
+				m_evictions.push_back(restore);
+				std::push_heap(m_evictions.begin(), m_evictions.end(), EvictLater());
+			}
+			continue;
+		}
+		for (const Candidate& victim : freed) {
+			evict(victim);
+		}
+
+		texture.bLoading = true;
+		m_loadingBytes += bytes;
+		m_loadsInFlight++;
+		m_steps.push_back({ TextureStreamStepType::Load, load.Texture, load.Mip });
+		m_stats.Loads++;
+	}
+
+	for (TextureState& texture : m_textures) {
+		if (texture.Priority > 0.f) {
+			m_stats.VisibleTextures++;
+			if (texture.ResidentMip <= texture.WantedMip)
+				m_stats.VisibleAtWanted++;
+			else
+				m_stats.MissingLevels += texture.ResidentMip - texture.WantedMip;
+		}
+		texture.MaxTexels = 0.f;
+		texture.Priority = 0.f;
+	}
+	m_stats.ResidentBytes = m_residentBytes;
+	m_stats.LoadingBytes = m_loadingBytes;
+	return m_steps;
+}
+
+//-------------------------------------------------------
+// Moves a level from loading to resident. A failed read
+// keeps whatever is resident for good, rather than
+// retrying it every frame
+//-------------------------------------------------------
+void TextureStreamer::CompleteLoad(unsigned int a_texture, bool a_bSucceeded)
+{
+	TextureState& texture = m_textures[a_texture];
+	if (!texture.bLoading)
+		return;
+	size_t bytes = GetLevelBytes(a_texture, texture.ResidentMip - 1);
+	texture.bLoading = false;
+	m_loadingBytes -= bytes;
+	m_loadsInFlight--;
+	if (a_bSucceeded) {
+		texture.ResidentMip--;
+		m_residentBytes += bytes;
+	}
+	else
+		texture.bFailed = true;
+}
+
+//-------------------------------------------------------
+// Removed textures have nothing resident, which keeps
+// them out of every load and eviction
+//-------------------------------------------------------
+void TextureStreamer::RemoveTexture(unsigned int a_texture)
+{
+	CompleteLoad(a_texture, false);
+	TextureState& texture = m_textures[a_texture];
+	m_residentBytes -= GetResidentBytes(a_texture);
+	texture.ResidentMip = texture.MipCount;
+	texture.WantedMip = texture.TailMip;
+	texture.bFailed = true;
+}
+
+size_t TextureStreamer::GetLevelBytes(unsigned int a_texture, unsigned int a_mip) const
+{
+	const TextureState& texture = m_textures[a_texture];
+	return BlockCompression::GetLevelSize(texture.Format, std::max(texture.Width >> a_mip, 1u), std::max(texture.Height >> a_mip, 1u));
+}
+
+size_t TextureStreamer::GetResidentBytes(unsigned int a_texture) const
+{
+	const TextureState& texture = m_textures[a_texture];
+	size_t bytes = 0;
+	for (unsigned int mip = texture.ResidentMip; mip < texture.MipCount; mip++) {
+		bytes += GetLevelBytes(a_texture, mip);
+	}
+	return bytes;
+}
+
+const TextureStreamerStats& TextureStreamer::GetStats() const
+{
+	return m_stats;
+}
+
+unsigned int TextureStreamer::GetTextureCount() const
+{
+	return (unsigned int)m_textures.size();
+}
+
+void TextureStreamer::SetSettings(const TextureStreamerSettings& a_settings)
+{
+	m_settings = a_settings;
+}
+
+const TextureStreamerSettings& TextureStreamer::GetSettings() const
+{
+	return m_settings;
+}
+
+unsigned int TextureStreamer::ComputeTailMip(unsigned int a_width, unsigned int a_height, unsigned int a_mipCount)
+{
+	unsigned int mip = 0;
+	while (mip + 1 < a_mipCount && ((a_width >> mip) > TEXTURE_STREAM_TAIL_SIZE || (a_height >> mip) > TEXTURE_STREAM_TAIL_SIZE))
+		mip++;
+	return mip;
+}
+
+//-------------------------------------------------------
+// Projected disc area. Inside the sphere it covers about
+// the whole screen height
+//-------------------------------------------------------
+float TextureStreamer::ProjectSphereArea(float a_radius, float a_distance, float a_pixelsPerUnit)
+{
+	float projectedRadius = a_radius * a_pixelsPerUnit / std::max(a_distance, a_radius);
+	return 3.14159265f * projectedRadius * projectedRadius;
+}
+
+//-------------------------------------------------------
+// Coverage per byte, so a cheap coarse level of a big
+// texture comes before an expensive fine one. Levels the
+// view can't resolve are worth nothing
+//-------------------------------------------------------
+float TextureStreamer::GetUsefulness(const TextureState& a_texture, unsigned int a_mip) const
+{
+	if (a_texture.Priority <= 0.f || a_mip < a_texture.WantedMip)
+		return 0.f;
+	size_t bytes = BlockCompression::GetLevelSize(a_texture.Format, std::max(a_texture.Width >> a_mip, 1u), std::max(a_texture.Height >> a_mip, 1u));
+	return a_texture.Priority / (float)bytes;
+}
+
+//-------------------------------------------------------
+// Offers a texture's finest level for eviction, unless
+// only the tail is left or a load depends on it
+//-------------------------------------------------------
+void TextureStreamer::PushEviction(unsigned int a_texture)
+{
+	const TextureState& texture = m_textures[a_texture];
+	if (texture.bLoading || texture.ResidentMip >= texture.TailMip)
+		return;
+	m_evictions.push_back({ GetUsefulness(texture, texture.ResidentMip), texture.LastVisibleFrame, a_texture, texture.ResidentMip });
+	std::push_heap(m_evictions.begin(), m_evictions.end(), EvictLater());
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TextureMips.h"
+
+#define TEXTURE_STREAM_TAIL_SIZE 64 // Levels no larger than this on either side are always resident
+
+//-------------------------------------------------------
+// Memory budget and per-frame limits for mip streaming
+//-------------------------------------------------------
+struct TextureStreamerSettings {
+	size_t BudgetBytes = 256ull << 20; // Resident levels plus levels being loaded, over every streamed texture
+	unsigned int MaxLoadsInFlight = 16; // Level loads waiting on the caller at once
+	float MipBias = 0.f; // Added to every texture's wanted level. Positive values ask for blurrier mips
+};
+
+enum class TextureStreamStepType {
+	Load, // Read this level and call CompleteLoad once it's resident
+	Evict // The level is already dropped from the bookkeeping - release it
+};
+
+struct TextureStreamStep {
+	TextureStreamStepType Type;
+	unsigned int Texture; // Index returned by AddTexture
+	unsigned int Mip;
+};
+
+//-------------------------------------------------------
+// What the last Update decided and how close residency
+// is to what the view wants
+//-------------------------------------------------------
+struct TextureStreamerStats {
+	size_t ResidentBytes = 0;
+	size_t LoadingBytes = 0;
+	unsigned int Loads = 0; // Started by the last Update
+	unsigned int Evictions = 0;
+	unsigned int VisibleTextures = 0; // Reported this frame
+	unsigned int VisibleAtWanted = 0; // Of those, resident down to their wanted level
+	unsigned int MissingLevels = 0; // Over visible textures, levels between the resident and wanted ones
+};
+
+//-------------------------------------------------------
+// Decides which texture mips are resident, so any number
+// of textures fits in a fixed memory budget
+//	- Textures start with just their tail (the levels up
+//	  to TEXTURE_STREAM_TAIL_SIZE), which never leaves.
+//	  Finer levels stream in one at a time, each directly
+//	  above the finest resident one, so a texture is
+//	  always one contiguous mip chain
+//	- Each frame, callers report how many texels every
+//	  visible texture would need: its screen coverage in
+//	  pixels, scaled by how often the texture repeats. The
+//	  wanted level is the one with about that many texels,
+//	  and the summed coverage is the texture's priority
+//	- A level's usefulness is its texture's priority per
+//	  byte of the level, so coarse levels of well covered
+//	  textures come first. Levels finer than wanted, and
+//	  textures out of view, are worth nothing. Loads go in
+//	  order of usefulness, evicting less useful levels
+//	  when over budget, so memory only churns when
+//	  something better needs it
+//	- Pure bookkeeping without D3D, so the headless
+//	  "stream-sim" command can check the policy with
+//	  thousands of simulated textures
+//-------------------------------------------------------
+class TextureStreamer
+{
+public:
+	TextureStreamer(const TextureStreamerSettings& a_settings = TextureStreamerSettings());
+
+	// Register a texture whose tail is already resident. Returns its index
+	unsigned int AddTexture(unsigned int a_width, unsigned int a_height, unsigned int a_mipCount, TextureFormat a_format);
+
+	// First level that's always resident, and the finest one resident now
+	unsigned int GetTailMip(unsigned int a_texture) const;
+	unsigned int GetResidentMip(unsigned int a_texture) const;
+	unsigned int GetWantedMip(unsigned int a_texture) const; // As of the last Update
+
+	// Texels a texture needs for one visible use, this frame. Reports accumulate until the next Update
+	void ReportCoverage(unsigned int a_texture, float a_texels);
+
+	// Decide this frame's loads and evictions, in order. Valid until the next call
+	const std::vector<TextureStreamStep>& Update();
+
+	// A Load step's level arrived (or couldn't be read, in which case the texture stops streaming)
+	void CompleteLoad(unsigned int a_texture, bool a_bSucceeded);
+
+	// Stop tracking a texture that was freed, tail and any load in flight included. Its index isn't reused
+	void RemoveTexture(unsigned int a_texture);
+
+	// Bytes every level of a texture takes, and its levels from the tail down to a_mip
+	size_t GetLevelBytes(unsigned int a_texture, unsigned int a_mip) const;
+	size_t GetResidentBytes(unsigned int a_texture) const;
+
+	const TextureStreamerStats& GetStats() const;
+	unsigned int GetTextureCount() const;
+
+	void SetSettings(const TextureStreamerSettings& a_settings); // A smaller budget evicts on the next Update
+	const TextureStreamerSettings& GetSettings() const;
+
+	// The first level no larger than TEXTURE_STREAM_TAIL_SIZE on either side (or the last level), which AddTexture
+	// expects to be resident along with every coarser one
+	static unsigned int ComputeTailMip(unsigned int a_width, unsigned int a_height, unsigned int a_mipCount);
+
+	// Screen pixels covered by a sphere, a_pixelsPerUnit being screen height / (2 * tan(fov / 2))
+	static float ProjectSphereArea(float a_radius, float a_distance, float a_pixelsPerUnit);
+
+private:
+	struct TextureState {
+		unsigned int Width = 0;
+		unsigned int Height = 0;
+		unsigned int MipCount = 1;
+		TextureFormat Format = TextureFormat::RGBA8;
+		unsigned int TailMip = 0;
+		unsigned int ResidentMip = 0;
+		unsigned int WantedMip = 0;
+		bool bLoading = false; // ResidentMip - 1 is on its way
+		bool bFailed = false; // Or removed. Keeps what's resident, but loads nothing more
+		float MaxTexels = 0.f; // Largest single report this frame
+		float Priority = 0.f; // Summed reports this frame
+		uint64_t LastVisibleFrame = 0;
+	};
+
+	struct Candidate {
+		float Usefulness;
+		uint64_t LastVisibleFrame; // Breaks ties, least recently seen goes first
+		unsigned int Texture;
+		unsigned int Mip;
+	};
+
+	float GetUsefulness(const TextureState& a_texture, unsigned int a_mip) const;
+	void PushEviction(unsigned int a_texture);
+
+	TextureStreamerSettings m_settings;
+	std::vector<TextureState> m_textures;
+	std::vector<TextureStreamStep> m_steps;
+	std::vector<Candidate> m_loads; // Kept to avoid reallocating every frame
+	std::vector<Candidate> m_evictions; // Min-heap on usefulness
+	TextureStreamerStats m_stats;
+	size_t m_residentBytes = 0;
+	size_t m_loadingBytes = 0;
+	unsigned int m_loadsInFlight = 0;
+	uint64_t m_frame = 0;
+};
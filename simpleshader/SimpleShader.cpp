@@ -1,4 +1,5 @@
 #include "SimpleShader.h"
+#include "../ShaderReflectionD3D11.h"
 
 // Default error reporting state
 bool ISimpleShader::ReportErrors = false;
@@ -17,13 +18,15 @@ bool ISimpleShader::ReportWarnings = false;
 ///////////////////////////////////////////////////////////////////////////////
 
 // --------------------------------------------------------
-// Constructor accepts Direct3D device & context
+// Constructor accepts Direct3D device & context, and the
+// RenderDevice that constant buffers go through
 // --------------------------------------------------------
-ISimpleShader::ISimpleShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context)
+ISimpleShader::ISimpleShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, std::shared_ptr<RenderDevice> renderDevice)
 {
 	// Save the device
 	this->device = device;
 	this->deviceContext = context;
+	this->renderDevice = renderDevice;
 
 	// Set up fields
 	this->constantBufferCount = 0;
@@ -48,6 +51,7 @@ void ISimpleShader::CleanUp()
 	// Handle constant buffers and local data buffers
 	for (unsigned int i = 0; i < constantBufferCount; i++)
 	{
+		renderDevice->ReleaseBuffer(constantBuffers[i].ConstantBuffer);
 		delete[] constantBuffers[i].LocalDataBuffer;
 	}
 
@@ -74,6 +78,11 @@ void ISimpleShader::CleanUp()
 // Loads the specified shader and builds the variable table 
 // using shader reflection.
 //
+// The reflection is read from the blob saved beside the
+// .cso (see ShaderReflection) when it was written for
+// this exact bytecode. Otherwise the shader is reflected
+// and the blob saved, so later launches skip D3DReflect
+//
 // shaderFile - A "wide string" specifying the compiled shader to load
 // 
 // Returns true if shader is loaded properly, false otherwise
@@ -94,6 +103,28 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 		return false;
 	}
 
+	// Get the reflection before creating the shader, as the
+	// child classes' CreateShader methods use it too
+	uint64_t bytecodeHash = ShaderReflection::HashBytecode(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize());
+	std::filesystem::path reflectionFile = ShaderReflection::GetFileName(shaderFile);
+	if (!reflection.Load(reflectionFile, bytecodeHash))
+	{
+		if (!ShaderReflectionD3D11::Reflect(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), reflection))
+		{
+			if (ReportErrors)
+			{
+				LogError("SimpleShader::LoadShaderFile() - Error reflecting shader file '");
+				LogW(shaderFile);
+				LogError("'.\n");
+			}
+
+			return false;
+		}
+
+		// Failing to save (a read-only folder, say) just means reflecting again next time
+		reflection.Save(reflectionFile);
+	}
+
 	// Create the shader - Calls an overloaded version of this abstract
 	// method in the appropriate child class
 	shaderValid = CreateShader(shaderBlob);
@@ -109,94 +140,68 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 		return false;
 	}
 
-	// Set up shader reflection to get information about
-	// this shader and its variables,  buffers, etc.
-	Microsoft::WRL::ComPtr<ID3D11ShaderReflection> refl;
-	D3DReflect(
-		shaderBlob->GetBufferPointer(),
-		shaderBlob->GetBufferSize(),
-		IID_ID3D11ShaderReflection,
-		(void**)refl.GetAddressOf());
-	
-	// Get the description of the shader
-	D3D11_SHADER_DESC shaderDesc;
-	refl->GetDesc(&shaderDesc);
-
 	// Create resource arrays
-	constantBufferCount = shaderDesc.ConstantBuffers;
+	constantBufferCount = reflection.GetBufferCount();
 	constantBuffers = new SimpleConstantBuffer[constantBufferCount];
 	
 	// Handle bound resources (like shaders and samplers)
-	unsigned int resourceCount = shaderDesc.BoundResources;
+	unsigned int resourceCount = reflection.GetResourceCount();
 	for (unsigned int r = 0; r < resourceCount; r++)
 	{
 		// Get this resource's description
-		D3D11_SHADER_INPUT_BIND_DESC resourceDesc;
-		refl->GetResourceBindingDesc(r, &resourceDesc);
+		const ShaderReflectionResource& resourceDesc = reflection.GetResource(r);
+		const char* resourceName = reflection.GetName(resourceDesc.Name);
 
 		// Check the type
-		switch (resourceDesc.Type)
+		switch (resourceDesc.Kind)
 		{
-		case D3D_SIT_STRUCTURED: // Treat structured buffers as texture resources
-		case D3D_SIT_TEXTURE: // A texture resource
+		case ShaderResourceKind::Texture: // A texture resource, or a structured buffer treated as one
 		{
 			// Create the SRV wrapper
 			SimpleSRV* srv = new SimpleSRV();
-			srv->BindIndex = resourceDesc.BindPoint;				// Shader bind point
+			srv->BindIndex = resourceDesc.BindIndex;				// Shader bind point
 			srv->Index = (unsigned int)shaderResourceViews.size();	// Raw index
 
-			textureTable.insert(std::pair<std::string, SimpleSRV*>(resourceDesc.Name, srv));
+			textureTable.insert(std::pair<std::string, SimpleSRV*>(resourceName, srv));
 			shaderResourceViews.push_back(srv);
 		}
 			break;
 
-		case D3D_SIT_SAMPLER: // A sampler resource
+		case ShaderResourceKind::Sampler: // A sampler resource
 		{
 			// Create the sampler wrapper
 			SimpleSampler* samp = new SimpleSampler();
-			samp->BindIndex = resourceDesc.BindPoint;			// Shader bind point
+			samp->BindIndex = resourceDesc.BindIndex;			// Shader bind point
 			samp->Index = (unsigned int)samplerStates.size();	// Raw index
 
-			samplerTable.insert(std::pair<std::string, SimpleSampler*>(resourceDesc.Name, samp));
+			samplerTable.insert(std::pair<std::string, SimpleSampler*>(resourceName, samp));
 			samplerStates.push_back(samp);
 		}
 			break;
+
+		default:
+			break;
 		}
 	}
 
 	// Loop through all constant buffers
 	for (unsigned int b = 0; b < constantBufferCount; b++)
 	{
-		// Get this buffer
-		ID3D11ShaderReflectionConstantBuffer* cb =
-			refl->GetConstantBufferByIndex(b);
-		
 		// Get the description of this buffer
-		D3D11_SHADER_BUFFER_DESC bufferDesc;
-		cb->GetDesc(&bufferDesc);
+		const ShaderReflectionBuffer& bufferDesc = reflection.GetBuffer(b);
+		const char* bufferName = reflection.GetName(bufferDesc.Name);
 
 		// Save the type, which we reference when setting these buffers
-		constantBuffers[b].Type = bufferDesc.Type;
-		
-		// Get the description of the resource binding, so
-		// we know exactly how it's bound in the shader
-		D3D11_SHADER_INPUT_BIND_DESC bindDesc;
-		refl->GetResourceBindingDescByName(bufferDesc.Name, &bindDesc);
+		constantBuffers[b].Type = (D3D_CBUFFER_TYPE)bufferDesc.Type;
 		
 		// Set up the buffer and put its pointer in the table
-		constantBuffers[b].BindIndex = bindDesc.BindPoint;
-		constantBuffers[b].Name = bufferDesc.Name;
-		cbTable.insert(std::pair<std::string, SimpleConstantBuffer*>(bufferDesc.Name, &constantBuffers[b]));
-
-		// Create this constant buffer
-		D3D11_BUFFER_DESC newBuffDesc = {};
-		newBuffDesc.Usage = D3D11_USAGE_DEFAULT;
-		newBuffDesc.ByteWidth = ((bufferDesc.Size + 15) / 16) * 16; // Quick and dirty 16-byte alignment using integer division
-		newBuffDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		newBuffDesc.CPUAccessFlags = 0;
-		newBuffDesc.MiscFlags = 0;
-		newBuffDesc.StructureByteStride = 0;
-		device->CreateBuffer(&newBuffDesc, 0, constantBuffers[b].ConstantBuffer.GetAddressOf());
+		constantBuffers[b].BindIndex = bufferDesc.BindIndex;
+		constantBuffers[b].Name = bufferName;
+		cbTable.insert(std::pair<std::string, SimpleConstantBuffer*>(bufferName, &constantBuffers[b]));
+
+		// Create this constant buffer - The device handles the 16-byte alignment,
+		// and Dynamic lets every copy overwrite it without stalling
+		constantBuffers[b].ConstantBuffer = renderDevice->CreateBuffer(BufferType::Constant, BufferUsage::Dynamic, nullptr, bufferDesc.Size);
 
 		// Set up the data buffer for this constant buffer
 		constantBuffers[b].Size = bufferDesc.Size;
@@ -204,24 +209,19 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 		ZeroMemory(constantBuffers[b].LocalDataBuffer, bufferDesc.Size);
 
 		// Loop through all variables in this buffer
-		for (unsigned int v = 0; v < bufferDesc.Variables; v++)
+		for (unsigned int v = 0; v < bufferDesc.VariableCount; v++)
 		{
-			// Get this variable
-			ID3D11ShaderReflectionVariable* var =
-				cb->GetVariableByIndex(v);
-			
-			// Get the description of the variable and its type
-			D3D11_SHADER_VARIABLE_DESC varDesc;
-			var->GetDesc(&varDesc);
+			// Get the description of this variable
+			const ShaderReflectionVariable& varDesc = reflection.GetVariable(bufferDesc.FirstVariable + v);
 
 			// Create the variable struct
 			SimpleShaderVariable varStruct = {};
 			varStruct.ConstantBufferIndex = b;
-			varStruct.ByteOffset = varDesc.StartOffset;
+			varStruct.ByteOffset = varDesc.ByteOffset;
 			varStruct.Size = varDesc.Size;
 			
 			// Get a string version
-			std::string varName(varDesc.Name);
+			std::string varName(reflection.GetName(varDesc.Name));
 
 			// Add this variable to the table and the constant buffer
 			varTable.insert(std::pair<std::string, SimpleShaderVariable>(varName, varStruct));
@@ -335,6 +335,23 @@ void ISimpleShader::SetShader()
 	SetShaderAndCBs();
 }
 
+// --------------------------------------------------------
+// Binds this shader's constant buffers to the given stage
+// through the RenderDevice
+// --------------------------------------------------------
+void ISimpleShader::BindConstantBuffers(ShaderStage stage)
+{
+	for (unsigned int i = 0; i < constantBufferCount; i++)
+	{
+		// Skip "buffers" that aren't true constant buffers
+		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
+			continue;
+
+		// This is a real constant buffer, so set it
+		renderDevice->SetConstantBuffer(stage, constantBuffers[i].BindIndex, constantBuffers[i].ConstantBuffer);
+	}
+}
+
 // --------------------------------------------------------
 // Copies the relevant data to the all of this 
 // shader's constant buffers.  To just copy one
@@ -349,9 +366,10 @@ void ISimpleShader::CopyAllBufferData()
 	for (unsigned int i = 0; i < constantBufferCount; i++)
 	{
 		// Copy the entire local data buffer
-		deviceContext->UpdateSubresource(
-			constantBuffers[i].ConstantBuffer.Get(), 0, 0,
-			constantBuffers[i].LocalDataBuffer, 0, 0);
+		renderDevice->UpdateBuffer(
+			constantBuffers[i].ConstantBuffer,
+			constantBuffers[i].LocalDataBuffer,
+			constantBuffers[i].Size);
 	}
 }
 
@@ -380,9 +398,7 @@ void ISimpleShader::CopyBufferData(unsigned int index)
 	if (!cb) return;
 
 	// Copy the data and get out
-	deviceContext->UpdateSubresource(
-		cb->ConstantBuffer.Get(), 0, 0, 
-		cb->LocalDataBuffer, 0, 0);
+	renderDevice->UpdateBuffer(cb->ConstantBuffer, cb->LocalDataBuffer, cb->Size);
 }
 
 // --------------------------------------------------------
@@ -402,9 +418,7 @@ void ISimpleShader::CopyBufferData(std::string bufferName)
 	if (!cb) return;
 
 	// Copy the data and get out
-	deviceContext->UpdateSubresource(
-		cb->ConstantBuffer.Get(), 0, 0, 
-		cb->LocalDataBuffer, 0, 0);
+	renderDevice->UpdateBuffer(cb->ConstantBuffer, cb->LocalDataBuffer, cb->Size);
 }
 
 
@@ -691,8 +705,8 @@ const SimpleConstantBuffer * ISimpleShader::GetBufferInfo(unsigned int index)
 // --------------------------------------------------------
 // Constructor just calls the base
 // --------------------------------------------------------
-SimpleVertexShader::SimpleVertexShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, LPCWSTR shaderFile)
-	: ISimpleShader(device, context) 
+SimpleVertexShader::SimpleVertexShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, std::shared_ptr<RenderDevice> renderDevice, LPCWSTR shaderFile)
+	: ISimpleShader(device, context, renderDevice) 
 { 
 	// Ensure we set to zero to successfully trigger
 	// the Input Layout creation during LoadShaderFile()
@@ -708,8 +722,8 @@ SimpleVertexShader::SimpleVertexShader(Microsoft::WRL::ComPtr<ID3D11Device> devi
 // Passing in a valid input layout will stop LoadShaderFile()
 // from creating an input layout from shader reflection
 // --------------------------------------------------------
-SimpleVertexShader::SimpleVertexShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, LPCWSTR shaderFile, Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout, bool perInstanceCompatible)
-	: ISimpleShader(device, context)
+SimpleVertexShader::SimpleVertexShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, std::shared_ptr<RenderDevice> renderDevice, LPCWSTR shaderFile, Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout, bool perInstanceCompatible)
+	: ISimpleShader(device, context, renderDevice)
 {
 	// Save the custom input layout
 	this->inputLayout = inputLayout;
@@ -767,28 +781,21 @@ bool SimpleVertexShader::CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlo
 		return true;
 
 	// Vertex shader was created successfully, so we now use the
-	// shader code to re-reflect and create an input layout that 
+	// shader's reflected inputs to create an input layout that 
 	// matches what the vertex shader expects.  Code adapted from:
 	// https://takinginitiative.wordpress.com/2011/12/11/directx-1011-basic-shader-reflection-automatic-input-layout-creation/
 
-	// Reflect shader info
-	Microsoft::WRL::ComPtr<ID3D11ShaderReflection> refl;
-	D3DReflect(
-		shaderBlob->GetBufferPointer(),
-		shaderBlob->GetBufferSize(),
-		IID_ID3D11ShaderReflection,
-		(void**)refl.GetAddressOf());
-	
-	// Get shader info
-	D3D11_SHADER_DESC shaderDesc;
-	refl->GetDesc(&shaderDesc);
-
-	// Read input layout description from shader info
+	// Read input layout description from the reflection. Semantic
+	// names point into its blob, which outlives the layout creation
 	std::vector<D3D11_INPUT_ELEMENT_DESC> inputLayoutDesc;
-	for (unsigned int i = 0; i< shaderDesc.InputParameters; i++)
+	for (unsigned int i = 0; i < reflection.GetInputCount(); i++)
 	{
-		D3D11_SIGNATURE_PARAMETER_DESC paramDesc;
-		refl->GetInputParameterDesc(i, &paramDesc);
+		const ShaderReflectionInput& input = reflection.GetInput(i);
+		D3D11_SIGNATURE_PARAMETER_DESC paramDesc = {};
+		paramDesc.SemanticName = reflection.GetName(input.SemanticName);
+		paramDesc.SemanticIndex = input.SemanticIndex;
+		paramDesc.ComponentType = (D3D_REGISTER_COMPONENT_TYPE)input.ComponentType;
+		paramDesc.Mask = (BYTE)input.Mask;
 
 		// Check the semantic name for "_PER_INSTANCE"
 		std::string perInstanceStr = "_PER_INSTANCE";
@@ -873,18 +880,7 @@ void SimpleVertexShader::SetShaderAndCBs()
 	deviceContext->VSSetShader(shader.Get(), 0, 0);
 
 	// Set the constant buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
-
-		// This is a real constant buffer, so set it
-		deviceContext->VSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+	BindConstantBuffers(ShaderStage::Vertex);
 }
 
 // --------------------------------------------------------
@@ -955,8 +951,8 @@ bool SimpleVertexShader::SetSamplerState(std::string name, Microsoft::WRL::ComPt
 // --------------------------------------------------------
 // Constructor just calls the base
 // --------------------------------------------------------
-SimplePixelShader::SimplePixelShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, LPCWSTR shaderFile)
-	: ISimpleShader(device, context) 
+SimplePixelShader::SimplePixelShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, std::shared_ptr<RenderDevice> renderDevice, LPCWSTR shaderFile)
+	: ISimpleShader(device, context, renderDevice) 
 { 
 	// Load the actual compiled shader file
 	this->LoadShaderFile(shaderFile);
@@ -1015,18 +1011,7 @@ void SimplePixelShader::SetShaderAndCBs()
 	deviceContext->PSSetShader(shader.Get(), 0, 0);
 
 	// Set the constant buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
-
-		// This is a real constant buffer, so set it
-		deviceContext->PSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+	BindConstantBuffers(ShaderStage::Pixel);
 }
 
 // --------------------------------------------------------
@@ -1099,8 +1084,8 @@ bool SimplePixelShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr
 // --------------------------------------------------------
 // Constructor just calls the base
 // --------------------------------------------------------
-SimpleDomainShader::SimpleDomainShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, LPCWSTR shaderFile)
-	: ISimpleShader(device, context) 
+SimpleDomainShader::SimpleDomainShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, std::shared_ptr<RenderDevice> renderDevice, LPCWSTR shaderFile)
+	: ISimpleShader(device, context, renderDevice) 
 { 
 	// Load the actual compiled shader file
 	this->LoadShaderFile(shaderFile);
@@ -1159,18 +1144,7 @@ void SimpleDomainShader::SetShaderAndCBs()
 	deviceContext->DSSetShader(shader.Get(), 0, 0);
 
 	// Set the constant buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
-
-		// This is a real constant buffer, so set it
-		deviceContext->DSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+	BindConstantBuffers(ShaderStage::Domain);
 }
 
 // --------------------------------------------------------
@@ -1242,8 +1216,8 @@ bool SimpleDomainShader::SetSamplerState(std::string name, Microsoft::WRL::ComPt
 // --------------------------------------------------------
 // Constructor just calls the base
 // --------------------------------------------------------
-SimpleHullShader::SimpleHullShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, LPCWSTR shaderFile)
-	: ISimpleShader(device, context) 
+SimpleHullShader::SimpleHullShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, std::shared_ptr<RenderDevice> renderDevice, LPCWSTR shaderFile)
+	: ISimpleShader(device, context, renderDevice) 
 { 
 	// Load the actual compiled shader file
 	this->LoadShaderFile(shaderFile);
@@ -1301,19 +1275,8 @@ void SimpleHullShader::SetShaderAndCBs()
 	// Set the shader
 	deviceContext->HSSetShader(shader.Get(), 0, 0);
 
-	// Set the constant buffers?
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
-
-		// This is a real constant buffer, so set it
-		deviceContext->HSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+	// Set the constant buffers
+	BindConstantBuffers(ShaderStage::Hull);
 }
 
 // --------------------------------------------------------
@@ -1386,8 +1349,8 @@ bool SimpleHullShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<
 // --------------------------------------------------------
 // Constructor calls the base and sets up potential stream-out options
 // --------------------------------------------------------
-SimpleGeometryShader::SimpleGeometryShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, LPCWSTR shaderFile, bool useStreamOut, bool allowStreamOutRasterization)
-	: ISimpleShader(device, context) 
+SimpleGeometryShader::SimpleGeometryShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, std::shared_ptr<RenderDevice> renderDevice, LPCWSTR shaderFile, bool useStreamOut, bool allowStreamOutRasterization)
+	: ISimpleShader(device, context, renderDevice) 
 { 
 	this->streamOutVertexSize = 0;
 	this->useStreamOut = useStreamOut;
@@ -1575,19 +1538,8 @@ void SimpleGeometryShader::SetShaderAndCBs()
 	// Set the shader
 	deviceContext->GSSetShader(shader.Get(), 0, 0);
 
-	// Set the constant buffers?
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
-
-		// This is a real constant buffer, so set it
-		deviceContext->GSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+	// Set the constant buffers
+	BindConstantBuffers(ShaderStage::Geometry);
 }
 
 // --------------------------------------------------------
@@ -1676,8 +1628,8 @@ unsigned int SimpleGeometryShader::CalcComponentCount(unsigned int mask)
 // --------------------------------------------------------
 // Constructor just calls the base
 // --------------------------------------------------------
-SimpleComputeShader::SimpleComputeShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, LPCWSTR shaderFile)
-	: ISimpleShader(device, context) 
+SimpleComputeShader::SimpleComputeShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, std::shared_ptr<RenderDevice> renderDevice, LPCWSTR shaderFile)
+	: ISimpleShader(device, context, renderDevice) 
 { 
 	this->threadsTotal = 0;
 	this->threadsX = 0;
@@ -1730,43 +1682,22 @@ bool SimpleComputeShader::CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBl
 	if (result != S_OK)
 		return false;
 
-	// Set up shader reflection to get information about UAV's
-	Microsoft::WRL::ComPtr<ID3D11ShaderReflection> refl;
-	D3DReflect(
-		shaderBlob->GetBufferPointer(),
-		shaderBlob->GetBufferSize(),
-		IID_ID3D11ShaderReflection,
-		(void**)refl.GetAddressOf());
-
-	// Get the description of the shader
-	D3D11_SHADER_DESC shaderDesc;
-	refl->GetDesc(&shaderDesc);
-	
-	// Grab the thread info
-	threadsTotal = refl->GetThreadGroupSize(
-		&threadsX,
-		&threadsY,
-		&threadsZ);
+	// Grab the thread info from the reflection
+	threadsX = reflection.GetHeader().ThreadGroupSize[0];
+	threadsY = reflection.GetHeader().ThreadGroupSize[1];
+	threadsZ = reflection.GetHeader().ThreadGroupSize[2];
+	threadsTotal = threadsX * threadsY * threadsZ;
 
 	// Loop and get all UAV resources
-	unsigned int resourceCount = shaderDesc.BoundResources;
+	unsigned int resourceCount = reflection.GetResourceCount();
 	for (unsigned int r = 0; r < resourceCount; r++)
 	{
 		// Get this resource's description
-		D3D11_SHADER_INPUT_BIND_DESC resourceDesc;
-		refl->GetResourceBindingDesc(r, &resourceDesc);
+		const ShaderReflectionResource& resourceDesc = reflection.GetResource(r);
 
 		// Check the type, looking for any kind of UAV
-		switch (resourceDesc.Type)
-		{
-		case D3D_SIT_UAV_APPEND_STRUCTURED:
-		case D3D_SIT_UAV_CONSUME_STRUCTURED:
-		case D3D_SIT_UAV_RWBYTEADDRESS:
-		case D3D_SIT_UAV_RWSTRUCTURED:
-		case D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER:
-		case D3D_SIT_UAV_RWTYPED:
-			uavTable.insert(std::pair<std::string, unsigned int>(resourceDesc.Name, resourceDesc.BindPoint));
-		}
+		if (resourceDesc.Kind == ShaderResourceKind::UnorderedAccess)
+			uavTable.insert(std::pair<std::string, unsigned int>(reflection.GetName(resourceDesc.Name), resourceDesc.BindIndex));
 	}
 
 	// All set
@@ -1785,19 +1716,8 @@ void SimpleComputeShader::SetShaderAndCBs()
 	// Set the shader
 	deviceContext->CSSetShader(shader.Get(), 0, 0);
 
-	// Set the constant buffers?
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
-
-		// This is a real constant buffer, so set it
-		deviceContext->CSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+	// Set the constant buffers
+	BindConstantBuffers(ShaderStage::Compute);
 }
 
 // --------------------------------------------------------